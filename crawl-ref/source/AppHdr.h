@@ -167,6 +167,16 @@ static inline double pow(int x, double y) { return std::pow((double)x, y); }
     //
     #define DGL_CLEAR_SCREEN "\033[2J"
 
+    // Each DGL_CLEAR_SCREEN makes the whole screen be sent again, and with
+    // a clear on every menu and prompt, that's most of what's in a ttyrec.
+    // If this is set to a number of seconds, the terminal is only really
+    // cleared once in that long, or on Ctrl-R, which is all ttyplay needs
+    // to find a starting point; other clears only send what changed. 0
+    // really clears it every time.
+    #ifndef DGL_CLEAR_INTERVAL
+    #define DGL_CLEAR_INTERVAL 0
+    #endif
+
     // Create .des and database cache files in a directory named with the
     // game version so that multiple save-compatible Crawl versions can
     // share the same savedir.
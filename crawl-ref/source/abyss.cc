@@ -10,6 +10,8 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <list>
+#include <map>
 #include <queue>
 
 #include "act-iter.h"
@@ -858,8 +860,7 @@ static void _abyss_identify_area_to_shift(coord_def source, int radius,
 
 static void _abyss_invert_mask(map_bitmask *mask)
 {
-    for (rectangle_iterator ri(0); ri; ++ri)
-        mask->set(*ri, !mask->get(*ri));
+    mask->flip();
 }
 
 // Moves everything in the given radius around the player (where radius=0 =>
@@ -1054,6 +1055,124 @@ const static RiverLayout rivers(1800, baseLayout);
 // This one is not fixed: [0] is a level pulled from the current game
 static vector<const ProceduralLayout*> complex_vec(2);
 
+// Layout samples for recently generated abyss coordinates, in tiles of
+// SAMPLE_TILE_SIZE squares, least recently used first. A sample taken at
+// one depth stands until its changepoint, so shifting back to an area or
+// morphing it again only samples what may have changed.
+static const int SAMPLE_TILE_SIZE = 16;
+static const size_t SAMPLE_TILES = 96;
+
+struct abyss_sample_tile
+{
+    abyss_sample_tile()
+        : samples(SAMPLE_TILE_SIZE * SAMPLE_TILE_SIZE,
+                  ProceduralSample(coord_def(), DNGN_FLOOR, 0)),
+          taken(SAMPLE_TILE_SIZE * SAMPLE_TILE_SIZE, false),
+          depth(SAMPLE_TILE_SIZE * SAMPLE_TILE_SIZE, 0)
+    {
+    }
+
+    vector<ProceduralSample> samples;
+    vector<bool> taken;
+    vector<uint32_t> depth; // when each sample was taken
+};
+
+typedef list<pair<coord_def, abyss_sample_tile>> abyss_sample_tiles;
+static abyss_sample_tiles sample_tiles;
+static map<coord_def, abyss_sample_tiles::iterator> sample_tile_index;
+
+static void _clear_abyss_samples()
+{
+    sample_tiles.clear();
+    sample_tile_index.clear();
+}
+
+static int _sample_tile_div(int v)
+{
+    return v >= 0 ? v / SAMPLE_TILE_SIZE
+                  : -((-v - 1) / SAMPLE_TILE_SIZE) - 1;
+}
+
+// The tile for abyss coordinate pt, and pt's index in it.
+static abyss_sample_tile &_abyss_sample_tile(const coord_def &pt, int &index)
+{
+    const coord_def tile(_sample_tile_div(pt.x), _sample_tile_div(pt.y));
+    index = (pt.y - tile.y * SAMPLE_TILE_SIZE) * SAMPLE_TILE_SIZE
+            + pt.x - tile.x * SAMPLE_TILE_SIZE;
+
+    auto found = sample_tile_index.find(tile);
+    if (found != sample_tile_index.end())
+    {
+        sample_tiles.splice(sample_tiles.end(), sample_tiles, found->second);
+        return found->second->second;
+    }
+
+    if (sample_tiles.size() >= SAMPLE_TILES)
+    {
+        sample_tile_index.erase(sample_tiles.front().first);
+        sample_tiles.pop_front();
+    }
+    sample_tiles.emplace_back(tile, abyss_sample_tile());
+    sample_tile_index[tile] = prev(sample_tiles.end());
+    return sample_tiles.back().second;
+}
+
+static bool _find_abyss_sample(const coord_def &pt, ProceduralSample &sample)
+{
+    int i;
+    const abyss_sample_tile &tile = _abyss_sample_tile(pt, i);
+    const uint32_t depth = abyssal_state.depth;
+    if (!tile.taken[i] || depth < tile.depth[i]
+        || depth >= tile.samples[i].changepoint())
+    {
+        return false;
+    }
+    sample = tile.samples[i];
+    return true;
+}
+
+static void _store_abyss_sample(const ProceduralSample &sample)
+{
+    int i;
+    abyss_sample_tile &tile = _abyss_sample_tile(sample.coord(), i);
+    tile.samples[i] = sample;
+    tile.taken[i] = true;
+    tile.depth[i] = abyssal_state.depth;
+}
+
+static ProceduralSample _abyss_layout_sample(const coord_def &pt)
+{
+    ProceduralSample sample(pt, DNGN_FLOOR, 0);
+    if (!_find_abyss_sample(pt, sample))
+    {
+        sample = (*abyssLayout)(pt, abyssal_state.depth);
+        _store_abyss_sample(sample);
+    }
+    return sample;
+}
+
+// While _abyss_apply_terrain() is going over the whole area, whatever isn't
+// already known is sampled a row at a time.
+static bool abyss_sample_rows = false;
+static int abyss_sample_row = -1;
+
+static void _sample_abyss_row(int y)
+{
+    vector<coord_def> pts;
+    ProceduralSample known(coord_def(), DNGN_FLOOR, 0);
+    for (int x = MAPGEN_BORDER; x < GXM - MAPGEN_BORDER; ++x)
+    {
+        const coord_def pt = coord_def(x, y) + abyssal_state.major_coord;
+        if (!_in_wastes(pt) && !_find_abyss_sample(pt, known))
+            pts.push_back(pt);
+    }
+    vector<ProceduralSample> samples;
+    abyssLayout->sample(pts, abyssal_state.depth, samples);
+    for (const ProceduralSample &sample : samples)
+        _store_abyss_sample(sample);
+    abyss_sample_row = y;
+}
+
 static ProceduralSample _abyss_grid(const coord_def &p)
 {
     const coord_def pt = p + abyssal_state.major_coord;
@@ -1072,6 +1191,7 @@ static ProceduralSample _abyss_grid(const coord_def &p)
         complex_vec[0] = levelLayout;
         complex_vec[1] = &rivers; // const
         abyssLayout = new WorleyLayout(23571113, complex_vec, 6.1);
+        _clear_abyss_samples();
         if (is_existing_level(lid))
         {
             auto &vault_list =  you.vault_list[level_id::current()];
@@ -1079,7 +1199,9 @@ static ProceduralSample _abyss_grid(const coord_def &p)
         }
     }
 
-    const ProceduralSample sample = (*abyssLayout)(pt, abyssal_state.depth);
+    if (abyss_sample_rows && p.y != abyss_sample_row)
+        _sample_abyss_row(p.y);
+    const ProceduralSample sample = _abyss_layout_sample(pt);
     ASSERT(sample.feat() > DNGN_UNSEEN);
 
     abyss_sample_queue.push(sample);
@@ -1267,6 +1389,10 @@ static void _abyss_apply_terrain(const map_bitmask &abyss_genlevel_mask,
 
     int ii = 0;
     int delta = you.time_taken * (you.abyss_speed + 40) / 200;
+    // Without the queue nearly every cell gets resampled, so fetch them a
+    // row at a time.
+    unwind_bool sample_rows(abyss_sample_rows, !used_queue);
+    abyss_sample_row = -1;
     for (rectangle_iterator ri(MAPGEN_BORDER); ri; ++ri)
     {
         const coord_def p(*ri);
@@ -1309,6 +1435,7 @@ static void _abyss_apply_terrain(const map_bitmask &abyss_genlevel_mask,
     _ensure_player_habitable(false);
     for (rectangle_iterator ri(MAPGEN_BORDER); ri; ++ri)
         ASSERT_RANGE(env.grid(*ri), DNGN_UNSEEN + 1, NUM_FEATURES);
+    clear_pathfind_flow_fields();
 }
 
 static int _abyss_place_vaults(const map_bitmask &abyss_genlevel_mask, bool placed_abyssal_rune)
@@ -1470,6 +1597,7 @@ void destroy_abyss()
         delete levelLayout;
         levelLayout = nullptr;
     }
+    _clear_abyss_samples();
 }
 
 static colour_t _roll_abyss_floor_colour()
@@ -2,18 +2,53 @@
 
 #include "act-iter.h"
 
+#include "coord.h"
 #include "env.h"
 #include "losglobal.h"
 
+/**
+ * Collect the monster slots that might be in LOS of c, by reading the
+ * monster grid over the box that bounds any LOS from c. Iterating the slots
+ * still goes in index order, so callers see monsters in the same order as a
+ * full scan, but dead and far-off slots are skipped without touching them.
+ *
+ * @param c    The centre of the query.
+ * @param los  The LOS type; LOS_NONE reaches the whole level.
+ * @param near Filled with the candidate slots.
+ * @return     false if every slot must be considered instead.
+ */
+static bool _find_near_mons(const coord_def &c, los_type los,
+                            FixedBitVector<MAX_MONSTERS> &near)
+{
+    if (los == LOS_NONE || !in_bounds(c))
+        return false;
+
+    near.reset();
+    const int x0 = max(c.x - LOS_MAX_RANGE, 0);
+    const int x1 = min(c.x + LOS_MAX_RANGE, GXM - 1);
+    const int y0 = max(c.y - LOS_MAX_RANGE, 0);
+    const int y1 = min(c.y + LOS_MAX_RANGE, GYM - 1);
+    for (int x = x0; x <= x1; ++x)
+        for (int y = y0; y <= y1; ++y)
+        {
+            const int mid = env.mgrid[x][y];
+            if (mid < MAX_MONSTERS)
+                near.set(mid);
+        }
+    return true;
+}
+
 actor_near_iterator::actor_near_iterator(coord_def c, los_type los)
-    : center(c), _los(los), viewer(nullptr), i(-1)
+    : center(c), _los(los), viewer(nullptr), i(-1),
+      all_mons(!_find_near_mons(c, los, near_mons))
 {
     if (!valid(&you))
         advance();
 }
 
 actor_near_iterator::actor_near_iterator(const actor* a, los_type los)
-    : center(a->pos()), _los(los), viewer(a), i(-1)
+    : center(a->pos()), _los(los), viewer(a), i(-1),
+      all_mons(!_find_near_mons(a->pos(), los, near_mons))
 {
     if (!valid(&you))
         advance();
@@ -61,28 +96,35 @@ bool actor_near_iterator::valid(const actor* a) const
     return cell_see_cell(center, a->pos(), _los);
 }
 
+bool actor_near_iterator::candidate() const
+{
+    return i < 0 || i >= MAX_MONSTERS || all_mons || near_mons[i];
+}
+
 void actor_near_iterator::advance()
 {
     do
          if (++i >= MAX_MONSTERS)
              return;
-    while (!valid(**this));
+    while (!candidate() || !valid(**this));
 }
 
 //////////////////////////////////////////////////////////////////////////
 
 monster_near_iterator::monster_near_iterator(coord_def c, los_type los)
-    : center(c), _los(los), viewer(nullptr), i(0)
+    : center(c), _los(los), viewer(nullptr), i(0),
+      all_mons(!_find_near_mons(c, los, near_mons))
 {
-    if (!valid(&env.mons[0]))
+    if (!candidate() || !valid(&env.mons[0]))
         advance();
     begin_point = i;
 }
 
 monster_near_iterator::monster_near_iterator(const actor *a, los_type los)
-    : center(a->pos()), _los(los), viewer(a), i(0)
+    : center(a->pos()), _los(los), viewer(a), i(0),
+      all_mons(!_find_near_mons(a->pos(), los, near_mons))
 {
-    if (!valid(&env.mons[0]))
+    if (!candidate() || !valid(&env.mons[0]))
         advance();
     begin_point = i;
 }
@@ -151,21 +193,61 @@ bool monster_near_iterator::valid(const monster* a) const
     return cell_see_cell(center, a->pos(), _los);
 }
 
+bool monster_near_iterator::candidate() const
+{
+    return i >= MAX_MONSTERS || all_mons || near_mons[i];
+}
+
 void monster_near_iterator::advance()
 {
     do
          if (++i >= MAX_MONSTERS)
              return;
-    while (!valid(**this));
+    while (!candidate() || !valid(**this));
 }
 
 //////////////////////////////////////////////////////////////////////////
 
+/**
+ * Record that a slot of env.mons is (about to be) occupied, so that
+ * monster_iterator will visit it. Slots are kept in index order so that
+ * iteration matches a scan of the whole array; a slot that is noted but
+ * empty or dead is just skipped. Monsters outside the real slots of
+ * env.mons are ignored.
+ */
+void note_monster_slot(const monster &mon)
+{
+    const int idx = mon.mindex();
+    if (idx < 0 || idx >= MAX_MONSTERS)
+        return;
+
+    auto &used = env.mons_used;
+    auto it = lower_bound(used.begin(), used.end(), idx);
+    if (it == used.end() || *it != idx)
+        used.insert(it, idx);
+}
+
+void forget_monster_slot(const monster &mon)
+{
+    const int idx = mon.mindex();
+    if (idx < 0 || idx >= MAX_MONSTERS)
+        return;
+
+    auto &used = env.mons_used;
+    auto it = lower_bound(used.begin(), used.end(), idx);
+    if (it != used.end() && *it == idx)
+        used.erase(it);
+}
+
+bool monster_slot_noted(int idx)
+{
+    return binary_search(env.mons_used.begin(), env.mons_used.end(), idx);
+}
+
 monster_iterator::monster_iterator()
-    : i(0)
+    : i(-1)
 {
-    while (i < MAX_MONSTERS && !env.mons[i].alive())
-        i++;
+    advance();
 }
 
 monster_iterator::operator bool() const
@@ -188,9 +270,7 @@ monster* monster_iterator::operator->() const
 
 monster_iterator& monster_iterator::operator++()
 {
-    while (++i < MAX_MONSTERS)
-        if (env.mons[i].alive())
-            break;
+    advance();
     return *this;
 }
 
@@ -201,12 +281,22 @@ monster_iterator monster_iterator::operator++(int)
     return copy;
 }
 
+// Look the current slot up again each time, rather than keeping a position
+// in env.mons_used, so that monsters placed or removed mid-loop behave as
+// they would for a scan of the whole of env.mons.
 void monster_iterator::advance()
 {
-    do
-         if (++i >= MAX_MONSTERS)
-             return;
-    while (!(*this)->alive());
+    const auto &used = env.mons_used;
+    for (auto it = upper_bound(used.begin(), used.end(), i);
+         it != used.end(); ++it)
+    {
+        if (env.mons[*it].alive())
+        {
+            i = *it;
+            return;
+        }
+    }
+    i = MAX_MONSTERS;
 }
 
 bool far_to_near_sorter::operator()(const actor* a, const actor* b)
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include "bitary.h"
+#include "defines.h"
 #include "los-type.h"
 
 class actor_near_iterator
@@ -24,8 +26,13 @@ protected:
     los_type _los;
     const actor* viewer;
     int i;
+    // Monster slots that could be in range of center; see _find_near_mons.
+    // This has to come before all_mons, whose initialiser fills it.
+    FixedBitVector<MAX_MONSTERS> near_mons;
+    bool all_mons;
 
     bool valid(const actor* a) const;
+    bool candidate() const;
     void advance();
 };
 
@@ -51,8 +58,11 @@ protected:
     const actor* viewer;
     int i;
     int begin_point;
+    FixedBitVector<MAX_MONSTERS> near_mons;
+    bool all_mons;
 
     bool valid(const monster* a) const;
+    bool candidate() const;
     void advance();
 };
 
@@ -72,6 +82,10 @@ protected:
     void advance();
 };
 
+void note_monster_slot(const monster &mon);
+void forget_monster_slot(const monster &mon);
+bool monster_slot_noted(int idx);
+
 // Actor sorters for combination with the above
 // Compare two actors, sorting farthest to nearest from {pos}
 struct far_to_near_sorter
@@ -38,7 +38,9 @@ bool player::see_cell(const coord_def &p) const
 
 bool actor::can_see(const actor &target) const
 {
-    return target.visible_to(this) && see_cell(target.pos());
+    // Line of sight is cached, while visibility means looking through
+    // enchantments and equipment, so rule out what's out of sight first.
+    return see_cell(target.pos()) && target.visible_to(this);
 }
 
 bool actor::see_cell_no_trans(const coord_def &p) const
@@ -54,6 +54,8 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/dbg-asrt.cc \
     $(CRAWL_PATH)/dbg-maps.cc \
     $(CRAWL_PATH)/dbg-objstat.cc \
+    $(CRAWL_PATH)/dbg-mem.cc \
+    $(CRAWL_PATH)/dbg-prof.cc \
     $(CRAWL_PATH)/dbg-scan.cc \
     $(CRAWL_PATH)/dbg-util.cc \
     $(CRAWL_PATH)/decks.cc \
@@ -109,8 +111,10 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/item-name.cc \
     $(CRAWL_PATH)/item-prop.cc \
     $(CRAWL_PATH)/items.cc \
+    $(CRAWL_PATH)/job-pool.cc \
     $(CRAWL_PATH)/jobs.cc \
     $(CRAWL_PATH)/json.cc \
+    $(CRAWL_PATH)/key-journal.cc \
     $(CRAWL_PATH)/kills.cc \
     $(CRAWL_PATH)/l-colour.cc \
     $(CRAWL_PATH)/l-crawl.cc \
@@ -276,6 +280,7 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/wizard.cc \
     $(CRAWL_PATH)/worley.cc \
     $(CRAWL_PATH)/xom.cc \
+    $(CRAWL_PATH)/zygote.cc \
     $(CRAWL_PATH)/tilepick.cc \
     $(CRAWL_PATH)/tileview.cc \
     $(CRAWL_PATH)/tiledoll.cc \
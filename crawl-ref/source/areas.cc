@@ -8,6 +8,8 @@
 
 #include "areas.h"
 
+#include <array>
+
 #include "act-iter.h"
 #include "artefact.h"
 #include "art-enum.h"
@@ -46,6 +48,7 @@ enum class areaprop
 };
 /// Bit field for the area properties
 DEF_BITFIELD(areaprops, areaprop);
+static const int NUM_AREAPROPS = 11;
 
 /// Center of an area effect
 struct area_centre
@@ -57,12 +60,35 @@ struct area_centre
     explicit area_centre (area_centre_type t, coord_def c, int r) : type(t), centre(c), radius(r) { }
 };
 
+/// What one actor puts into the area grid, kept so that it can be taken out
+/// again when the actor moves.
+struct area_stamp
+{
+    mid_t source = MID_NOBODY;
+    vector<area_centre> centres;
+    vector<pair<coord_def, areaprop>> cells;
+
+    void clear()
+    {
+        source = MID_NOBODY;
+        centres.clear();
+        cells.clear();
+    }
+};
+
 typedef FixedArray<areaprops, GXM, GYM> propgrid_t;
+/// How many stamps give each cell each area property.
+typedef FixedArray<array<uint16_t, NUM_AREAPROPS>, GXM, GYM> propcount_t;
 
 /// The area center cache. Contains centers of all area effects.
 static vector<area_centre> _agrid_centres;
+/// Is \ref _agrid_centres up to date with the stamps?
+static bool _agrid_centres_valid = false;
 
 static propgrid_t _agrid; ///< The area grid cache
+static propcount_t _agrid_counts;
+/// The player's stamp, then each monster's by index.
+static area_stamp _agrid_stamps[MAX_MONSTERS + 1];
 /// \brief Is the area grid cache up-to-date?
 /// \details If false, each check for area effects that affect a coordinate
 /// would trigger an update of the area grid cache.
@@ -70,14 +96,33 @@ static bool _agrid_valid = false;
 /// \brief If true, the level has no area effect
 static bool no_areas = false;
 
-static void _set_agrid_flag(const coord_def& p, areaprop f)
+static bool _check_agrid_flag(const coord_def& p, areaprop f)
 {
-    _agrid(p) |= f;
+    return bool(_agrid(p) & f);
 }
 
-static bool _check_agrid_flag(const coord_def& p, areaprop f)
+static area_stamp &_actor_stamp(const actor *a)
 {
-    return bool(_agrid(p) & f);
+    return _agrid_stamps[a->is_player() ? 0 : a->mindex() + 1];
+}
+
+/// Add a stamp's cells to the grid (\p delta 1), or take them out (-1).
+static void _apply_stamp(const area_stamp &stamp, int delta)
+{
+    for (const auto &cell : stamp.cells)
+    {
+        const areaprop f = cell.second;
+        int i = 0;
+        while (static_cast<areaprop>(1 << i) != f)
+            ++i;
+
+        uint16_t &count = _agrid_counts(cell.first)[i];
+        count += delta;
+        if (count)
+            _agrid(cell.first) |= f;
+        else
+            _agrid(cell.first) &= ~areaprops(f);
+    }
 }
 
 /// \brief Invalidates the area effect cache
@@ -92,87 +137,145 @@ void invalidate_agrid(bool recheck_new)
         no_areas = false;
 }
 
-void areas_actor_moved(const actor* act, const coord_def& oldpos)
-{
-    UNUSED(oldpos);
-    if (act->alive() &&
-        (you.entering_level
-         || act->halo_radius() > -1 || act->silence_radius() > -1
-         || act->liquefying_radius() > -1 || act->umbra_radius() > -1
-         || act->demon_silence_radius() > -1))
-    {
-        // Not necessarily new, but certainly potentially interesting.
-        invalidate_agrid(true);
-    }
-}
-
-/// \brief Add some of the actor's area effects to the grid and center caches
+/// \brief Remember the area effects of an actor in its stamp
 /// \param actor The actor
-/// \details Adds some but not all of an actor's area effects (e.g. silence)
-/// to the area grid (\ref _agrid) and center (\ref _agrid_centres) caches.
-/// Sets \ref no_areas to false if the actor generates those area effects.
-static void _actor_areas(actor *a)
+/// \details Records some but not all of an actor's area effects (e.g.
+/// silence), to be added to the area grid (\ref _agrid) and center
+/// (\ref _agrid_centres) caches. The player's also has the Orb's glow, quad
+/// damage and disjunction.
+/// Sets \ref no_areas to false if the actor generates area effects.
+static void _actor_areas(const actor *a)
 {
+    area_stamp &stamp = _actor_stamp(a);
+    stamp.clear();
+    stamp.source = a->mid;
+
     int r;
 
     if ((r = a->silence_radius()) >= 0)
     {
-        _agrid_centres.emplace_back(area_centre_type::silence, a->pos(), r);
+        stamp.centres.emplace_back(area_centre_type::silence, a->pos(), r);
 
         for (radius_iterator ri(a->pos(), r, C_SQUARE); ri; ++ri)
-            _set_agrid_flag(*ri, areaprop::silence);
-        no_areas = false;
+            stamp.cells.emplace_back(*ri, areaprop::silence);
     }
 
     if ((r = a->demon_silence_radius()) >= 0)
     {
-        _agrid_centres.emplace_back(area_centre_type::silence, a->pos(), r);
+        stamp.centres.emplace_back(area_centre_type::silence, a->pos(), r);
 
         for (radius_iterator ri(a->pos(), r, C_SQUARE, LOS_DEFAULT, true); ri; ++ri)
-            _set_agrid_flag(*ri, areaprop::silence);
-        no_areas = false;
+            stamp.cells.emplace_back(*ri, areaprop::silence);
     }
 
     if ((r = a->halo_radius()) >= 0)
     {
-        _agrid_centres.emplace_back(area_centre_type::halo, a->pos(), r);
+        stamp.centres.emplace_back(area_centre_type::halo, a->pos(), r);
 
         for (radius_iterator ri(a->pos(), r, C_SQUARE, LOS_DEFAULT); ri; ++ri)
-            _set_agrid_flag(*ri, areaprop::halo);
-        no_areas = false;
+            stamp.cells.emplace_back(*ri, areaprop::halo);
     }
 
     if ((r = a->liquefying_radius()) >= 0)
     {
-        _agrid_centres.emplace_back(area_centre_type::liquid, a->pos(), r);
+        stamp.centres.emplace_back(area_centre_type::liquid, a->pos(), r);
 
         for (radius_iterator ri(a->pos(), r, C_SQUARE, LOS_SOLID); ri; ++ri)
         {
             dungeon_feature_type f = env.grid(*ri);
 
-            _set_agrid_flag(*ri, areaprop::liquid);
+            stamp.cells.emplace_back(*ri, areaprop::liquid);
 
             if (feat_has_solid_floor(f) && !feat_is_water(f))
-                _set_agrid_flag(*ri, areaprop::actual_liquid);
+                stamp.cells.emplace_back(*ri, areaprop::actual_liquid);
         }
-        no_areas = false;
     }
 
     if ((r = a->umbra_radius()) >= 0)
     {
-        _agrid_centres.emplace_back(area_centre_type::umbra, a->pos(), r);
+        stamp.centres.emplace_back(area_centre_type::umbra, a->pos(), r);
 
         for (radius_iterator ri(a->pos(), r, C_SQUARE, LOS_DEFAULT); ri; ++ri)
-            _set_agrid_flag(*ri, areaprop::umbra);
+            stamp.cells.emplace_back(*ri, areaprop::umbra);
+    }
+
+    if (a->is_player() && player_has_orb() && !you.pos().origin())
+    {
+        r = 2;
+        stamp.centres.emplace_back(area_centre_type::orb, you.pos(), r);
+        for (radius_iterator ri(you.pos(), r, C_SQUARE, LOS_DEFAULT); ri; ++ri)
+            stamp.cells.emplace_back(*ri, areaprop::orb);
+    }
+
+    if (a->is_player() && you.duration[DUR_QUAD_DAMAGE])
+    {
+        r = 2;
+        stamp.centres.emplace_back(area_centre_type::quad, you.pos(), r);
+        for (radius_iterator ri(you.pos(), r, C_SQUARE);
+             ri; ++ri)
+        {
+            if (cell_see_cell(you.pos(), *ri, LOS_DEFAULT))
+                stamp.cells.emplace_back(*ri, areaprop::quad);
+        }
+    }
+
+    if (a->is_player() && you.duration[DUR_DISJUNCTION])
+    {
+        r = 4;
+        stamp.centres.emplace_back(area_centre_type::disjunction,
+                                   you.pos(), r);
+        for (radius_iterator ri(you.pos(), r, C_SQUARE);
+             ri; ++ri)
+        {
+            if (cell_see_cell(you.pos(), *ri, LOS_DEFAULT))
+                stamp.cells.emplace_back(*ri, areaprop::disjunction);
+        }
+    }
+
+    if (!stamp.centres.empty())
         no_areas = false;
+}
+
+void areas_actor_moved(const actor* act, const coord_def& oldpos)
+{
+    UNUSED(oldpos);
+    if (!act->alive())
+        return;
+
+    area_stamp &stamp = _actor_stamp(act);
+    if (!you.entering_level && stamp.centres.empty()
+        && act->halo_radius() == -1 && act->silence_radius() == -1
+        && act->liquefying_radius() == -1 && act->umbra_radius() == -1
+        && act->demon_silence_radius() == -1
+        && (!act->is_player() || !player_has_orb()
+                                 && !you.duration[DUR_QUAD_DAMAGE]
+                                 && !you.duration[DUR_DISJUNCTION]))
+    {
+        return;
     }
+
+    // Nothing else's areas change when something moves, so if the grid is
+    // otherwise up to date, just move this actor's.
+    if (!_agrid_valid || you.entering_level || !in_bounds(act->pos())
+        || !stamp.centres.empty() && stamp.source != act->mid)
+    {
+        // Not necessarily new, but certainly potentially interesting.
+        invalidate_agrid(true);
+        return;
+    }
+
+    rng::generator gameplay(rng::GAMEPLAY);
+    _apply_stamp(stamp, -1);
+    _actor_areas(act);
+    _apply_stamp(stamp, 1);
+    _agrid_centres_valid = false;
 }
 
 /**
  * Update the area grid cache.
  *
  * Updates the _agrid FixedArray of grid information flags using the
- * areaprop types.
+ * areaprop types, from a fresh stamp for every actor.
  */
 static void _update_agrid()
 {
@@ -186,7 +289,10 @@ static void _update_agrid()
     }
 
     _agrid.init(areaprops());
-    _agrid_centres.clear();
+    _agrid_counts.init({});
+    for (area_stamp &stamp : _agrid_stamps)
+        stamp.clear();
+    _agrid_centres_valid = false;
 
     no_areas = true;
 
@@ -194,47 +300,25 @@ static void _update_agrid()
     for (monster_iterator mi; mi; ++mi)
         _actor_areas(*mi);
 
-    if (player_has_orb() && !you.pos().origin())
-    {
-        const int r = 2;
-        _agrid_centres.emplace_back(area_centre_type::orb, you.pos(), r);
-        for (radius_iterator ri(you.pos(), r, C_SQUARE, LOS_DEFAULT); ri; ++ri)
-            _set_agrid_flag(*ri, areaprop::orb);
-        no_areas = false;
-    }
-
-    if (you.duration[DUR_QUAD_DAMAGE])
-    {
-        const int r = 2;
-        _agrid_centres.emplace_back(area_centre_type::quad, you.pos(), r);
-        for (radius_iterator ri(you.pos(), r, C_SQUARE);
-             ri; ++ri)
-        {
-            if (cell_see_cell(you.pos(), *ri, LOS_DEFAULT))
-                _set_agrid_flag(*ri, areaprop::quad);
-        }
-        no_areas = false;
-    }
-
-    if (you.duration[DUR_DISJUNCTION])
-    {
-        const int r = 4;
-        _agrid_centres.emplace_back(area_centre_type::disjunction,
-                                    you.pos(), r);
-        for (radius_iterator ri(you.pos(), r, C_SQUARE);
-             ri; ++ri)
-        {
-            if (cell_see_cell(you.pos(), *ri, LOS_DEFAULT))
-                _set_agrid_flag(*ri, areaprop::disjunction);
-        }
-        no_areas = false;
-    }
+    for (const area_stamp &stamp : _agrid_stamps)
+        _apply_stamp(stamp, 1);
 
     // TODO: update sanctuary here.
 
     _agrid_valid = true;
 }
 
+static void _update_agrid_centres()
+{
+    _agrid_centres.clear();
+    for (const area_stamp &stamp : _agrid_stamps)
+    {
+        _agrid_centres.insert(_agrid_centres.end(), stamp.centres.begin(),
+                              stamp.centres.end());
+    }
+    _agrid_centres_valid = true;
+}
+
 static area_centre_type _get_first_area(const coord_def& f)
 {
     areaprops a = _agrid(f);
@@ -268,6 +352,9 @@ coord_def find_centre_for(const coord_def& f, area_centre_type at)
     if (!_agrid(f))
         return coord_def(-1, -1);
 
+    if (!_agrid_centres_valid)
+        _update_agrid_centres();
+
     if (_agrid_centres.empty())
         return coord_def(-1, -1);
 
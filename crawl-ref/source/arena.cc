@@ -255,6 +255,7 @@ namespace arena
     static uint32_t cycle_random_pos = 0;
 
     static FILE *file = nullptr;
+    static FILE *batch_file = nullptr; // one line per fight, for -arena-batch
     static level_id place(BRANCH_DEPTHS, 1);
     static string arena_log;
 
@@ -613,6 +614,9 @@ namespace arena
         for (int i = 0; i < NUM_STATS; ++i)
             you.base_stats[i] = 20;
 
+        if (crawl_state.arena_batch)
+            return;
+
         // XXX: now that you.species is valid, do a layout.
         // This is necessary to ensure that the stat window is positioned.
 #ifdef USE_TILE
@@ -861,16 +865,23 @@ namespace arena
 
     static void do_fight()
     {
-        viewwindow();
-        update_screen();
-        clear_messages(true);
+        // A batch has nobody watching, so there's nothing to draw or wait
+        // for.
+        const bool batch = crawl_state.arena_batch;
+        if (!batch)
+        {
+            viewwindow();
+            update_screen();
+            clear_messages(true);
+        }
 
         {
             cursor_control coff(false);
             while (fight_is_on() && !contest_cancelled)
             {
 #ifdef ARENA_VERBOSE
-                mprf("---- Turn #%d ----", turns);
+                if (!batch)
+                    mprf("---- Turn #%d ----", turns);
 #endif
 
                 // Check the consistency of our book-keeping every 100 turns.
@@ -884,12 +895,15 @@ namespace arena
                 do_respawn(faction_a);
                 do_respawn(faction_b);
                 balance_spawners();
-                if (!contest_cancelled)
-                    ui::delay(Options.view_delay);
-                clear_messages();
+                if (!batch)
+                {
+                    if (!contest_cancelled)
+                        ui::delay(Options.view_delay);
+                    clear_messages();
+                }
                 ASSERT(you.pet_target == MHITNOT);
             }
-            if (!contest_cancelled)
+            if (!contest_cancelled && !batch)
             {
                 viewwindow();
                 update_screen();
@@ -957,7 +971,13 @@ namespace arena
         else if (faction_a.won)
             team_a_wins++;
 
-        show_fight_banner(true);
+        if (batch_file)
+        {
+            fprintf(batch_file, "%d\t%s\t%d\n", trials_done,
+                    was_tied ? "tie" : faction_a.won ? "a" : "b", turns);
+        }
+        if (!batch)
+            show_fight_banner(true);
 
         string msg;
         if (was_tied)
@@ -996,6 +1016,12 @@ namespace arena
         // Set various options from the arena spec's tags
         parse_monster_spec(); // may throw an arena_error
 
+        if (crawl_state.arena_batch)
+        {
+            total_trials = crawl_state.arena_batch;
+            Options.use_animations = UA_NONE;
+        }
+
         crawl_view.init_geometry();
         expand_mlist(5);
 
@@ -1013,8 +1039,11 @@ namespace arena
     {
         if (file != nullptr)
             fclose(file);
+        if (batch_file != nullptr)
+            fclose(batch_file);
 
         file = nullptr;
+        batch_file = nullptr;
         arena_log = "";
     }
 
@@ -1118,6 +1147,39 @@ namespace arena
 
         write_results();
     }
+
+    /// Run the -arena-batch fights back to back, without a display.
+    static void simulate_batch()
+    {
+        init_level_connectivity();
+
+        const char *batch_log = "arena-batch.tsv";
+        batch_file = fopen(batch_log, "w");
+        if (!batch_file)
+            throw arena_error_f("Can't write %s", batch_log);
+        fprintf(batch_file, "# a: %s\n# b: %s\n", faction_a.desc.c_str(),
+                faction_b.desc.c_str());
+        fprintf(batch_file, "trial\twinner\tturns\n");
+
+        // The messages are only wanted if they're being dumped.
+        msg::suppress quiet(!Options.arena_dump_msgs);
+
+        while (trials_done < total_trials)
+        {
+            try
+            {
+                setup_fight();
+            }
+            catch (const arena_error &error)
+            {
+                write_error(error.what());
+                game_ended_with_error(error.what());
+            }
+            do_fight();
+        }
+
+        write_results();
+    }
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -1497,6 +1559,8 @@ static void _choose_arena_teams(newgame_def& choice,
 
     if (!choice.arena_teams.empty())
         return;
+    if (crawl_state.arena_batch)
+        throw arena::arena_error("-arena-batch needs the teams from -arena.");
     arena::skipped_arena_ui = false;
     clear_message_store();
 
@@ -1568,7 +1632,10 @@ NORETURN void run_arena(const newgame_def& choice, const string &default_arena_t
 #endif
 
             arena::global_setup(arena_choice.arena_teams);
-            arena::simulate();
+            if (crawl_state.arena_batch)
+                arena::simulate_batch();
+            else
+                arena::simulate();
             arena::global_shutdown();
             game_ended(game_exit::death); // there is only death in the arena
         }
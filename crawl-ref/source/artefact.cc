@@ -1627,8 +1627,16 @@ bool randart_is_bad(const item_def &item)
     return randart_is_bad(item, proprt);
 }
 
+static unsigned int _artefact_property_changes = 0;
+
+unsigned int artefact_property_changes()
+{
+    return _artefact_property_changes;
+}
+
 static void _artefact_setup_prop_vectors(item_def &item)
 {
+    ++_artefact_property_changes;
     CrawlHashTable &props = item.props;
     if (!props.exists(ARTEFACT_PROPS_KEY))
         props[ARTEFACT_PROPS_KEY].new_vector(SV_SHORT).resize(ART_PROPERTIES);
@@ -1908,6 +1916,7 @@ void artefact_set_property(item_def          &item,
     ASSERT(rap_vec.get_max_size() == ART_PROPERTIES);
 
     rap_vec[prop].get_short() = val;
+    ++_artefact_property_changes;
 }
 
 template<typename Z>
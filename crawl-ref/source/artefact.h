@@ -135,6 +135,8 @@ const unrandart_entry* get_unrand_entry(int unrand_index);
 void artefact_set_property(item_def           &item,
                            artefact_prop_type  prop,
                            int                 val);
+// Counts changes to artefact properties, for things that cache them.
+unsigned int artefact_property_changes();
 
 /// Type for the value of an artefact property
 enum artp_value_type
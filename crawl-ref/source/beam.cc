@@ -1082,22 +1082,51 @@ void bolt::affect_cell()
         affect_ground();
 }
 
-static void _undo_tracer(bolt &orig, bolt &copy)
+// What a tracer's trip along the ray changes that isn't tracer output, and
+// so has to be put back afterwards. Saved on its own rather than as a copy
+// of the whole bolt, so that tracing doesn't copy the beam's names, path and
+// hit records just to restore a dozen fields.
+struct tracer_undo
 {
     // FIXME: we should have a better idea of what gets changed!
-    orig.target           = copy.target;
-    orig.source           = copy.source;
-    orig.aimed_at_spot    = copy.aimed_at_spot;
-    orig.aimed_at_feet    = copy.aimed_at_feet;
-    orig.extra_range_used = copy.extra_range_used;
-    orig.auto_hit         = copy.auto_hit;
-    orig.ray              = copy.ray;
-    orig.colour           = copy.colour;
-    orig.flavour          = copy.flavour;
-    orig.real_flavour     = copy.real_flavour;
-    orig.bounces          = copy.bounces;
-    orig.bounce_pos       = copy.bounce_pos;
-}
+    coord_def  target;
+    coord_def  source;
+    bool       aimed_at_spot;
+    bool       aimed_at_feet;
+    int        extra_range_used;
+    bool       auto_hit;
+    ray_def    ray;
+    colour_t   colour;
+    beam_type  flavour;
+    beam_type  real_flavour;
+    int        bounces;
+    coord_def  bounce_pos;
+
+    explicit tracer_undo(const bolt &b)
+        : target(b.target), source(b.source), aimed_at_spot(b.aimed_at_spot),
+          aimed_at_feet(b.aimed_at_feet), extra_range_used(b.extra_range_used),
+          auto_hit(b.auto_hit), ray(b.ray), colour(b.colour),
+          flavour(b.flavour), real_flavour(b.real_flavour),
+          bounces(b.bounces), bounce_pos(b.bounce_pos)
+    {
+    }
+
+    void restore(bolt &b) const
+    {
+        b.target           = target;
+        b.source           = source;
+        b.aimed_at_spot    = aimed_at_spot;
+        b.aimed_at_feet    = aimed_at_feet;
+        b.extra_range_used = extra_range_used;
+        b.auto_hit         = auto_hit;
+        b.ray              = ray;
+        b.colour           = colour;
+        b.flavour          = flavour;
+        b.real_flavour     = real_flavour;
+        b.bounces          = bounces;
+        b.bounce_pos       = bounce_pos;
+    }
+};
 
 // This saves some important things before calling fire().
 void bolt::fire()
@@ -1109,22 +1138,24 @@ void bolt::fire()
 
     if (is_tracer)
     {
-        bolt boltcopy = *this;
-        if (special_explosion != nullptr)
-            boltcopy.special_explosion = new bolt(*special_explosion);
+        const tracer_undo saved(*this);
+        const tracer_undo saved_explosion(special_explosion ? *special_explosion
+                                                            : *this);
 
         do_fire();
 
         if (special_explosion != nullptr)
-        {
-            _undo_tracer(*special_explosion, *boltcopy.special_explosion);
-            delete boltcopy.special_explosion;
-        }
+            saved_explosion.restore(*special_explosion);
 
-        _undo_tracer(*this, boltcopy);
+        saved.restore(*this);
     }
     else
+    {
+#ifdef USE_TILE_WEB
+        tiles_animation batch;
+#endif
         do_fire();
+    }
 
     //XXX: suspect, but code relies on path_taken being non-empty
     if (path_taken.empty())
@@ -4091,7 +4122,7 @@ void bolt::update_hurt_or_helped(monster* mon)
     {
         if (nasty_to(mon))
             foe_info.hurt++;
-        else if (nice_to(monster_info(mon)))
+        else if (nice_to(mon))
         {
             foe_info.helped++;
             // Accidentally helped a foe.
@@ -4113,7 +4144,7 @@ void bolt::update_hurt_or_helped(monster* mon)
             if (!is_tracer && mon->mid == source_id)
                 xom_is_stimulated(100);
         }
-        else if (nice_to(monster_info(mon)))
+        else if (nice_to(mon))
             friend_info.helped++;
     }
 }
@@ -6110,6 +6141,10 @@ bool bolt::explode(bool show_more, bool hole_in_the_middle)
     else
         real_flavour = flavour;
 
+#ifdef USE_TILE_WEB
+    tiles_animation batch(!is_tracer);
+#endif
+
     const int r = min(ex_size, MAX_EXPLOSION_RADIUS);
     in_explosion_phase = true;
     // being hit by bounces doesn't exempt you from the explosion (not that it
@@ -6281,6 +6316,18 @@ void bolt::explosion_affect_cell(const coord_def& p)
 void bolt::determine_affected_cells(explosion_map& m, const coord_def& delta,
                                     int count, int r,
                                     bool stop_at_statues, bool stop_at_walls)
+{
+    // These are the same all over the explosion, which visits many cells
+    // many times over, so find them just the once.
+    const actor *caster = actor_by_mid(source_id);
+    spread_explosion(m, delta, count, r, stop_at_statues, stop_at_walls,
+                     caster ? caster->pos() : you.pos(), can_burn_trees());
+}
+
+void bolt::spread_explosion(explosion_map& m, const coord_def& delta,
+                            int count, int r, bool stop_at_statues,
+                            bool stop_at_walls, const coord_def& caster_pos,
+                            bool burn_trees)
 {
     const coord_def centre(9,9);
     const coord_def loc = pos() + delta;
@@ -6309,7 +6356,7 @@ void bolt::determine_affected_cells(explosion_map& m, const coord_def& delta,
     if (feat_is_wall(dngn_feat)
         || feat_is_tree(dngn_feat)
            && (!feat_is_flammable(dngn_feat)
-               || !can_burn_trees()
+               || !burn_trees
                || env.markers.property_at(loc, MAT_ANY, "veto_destroy") == "veto")
         || feat_is_closed_door(dngn_feat))
     {
@@ -6340,10 +6387,6 @@ void bolt::determine_affected_cells(explosion_map& m, const coord_def& delta,
             continue;
 
         // If we were at a wall, only move to visible squares.
-        coord_def caster_pos = actor_by_mid(source_id) ?
-                                   actor_by_mid(source_id)->pos() :
-                                   you.pos();
-
         if (at_wall && !cell_see_cell(caster_pos, loc + Compass[i], LOS_NO_TRANS))
             continue;
 
@@ -6359,8 +6402,8 @@ void bolt::determine_affected_cells(explosion_map& m, const coord_def& delta,
         if (m(new_delta + centre) <= count + cadd)
             continue;
 
-        determine_affected_cells(m, new_delta, count + cadd, r,
-                                 stop_at_statues, stop_at_walls);
+        spread_explosion(m, new_delta, count + cadd, r, stop_at_statues,
+                         stop_at_walls, caster_pos, burn_trees);
     }
 }
 
@@ -6389,7 +6432,7 @@ bool bolt::nasty_to(const monster* mon) const
         return true;
 
     // Positive effects.
-    if (nice_to(monster_info(mon)))
+    if (nice_to(mon))
         return false;
 
     switch (flavour)
@@ -6436,14 +6479,16 @@ bool bolt::nasty_to(const monster* mon) const
 // Return true if the bolt is considered nice by mon.
 // This is not the inverse of nasty_to(): the bolt needs to be
 // actively positive.
-bool bolt::nice_to(const monster_info& mi) const
+// Only the monster's type matters, so tracers can ask about a monster
+// without building a monster_info for it.
+static bool _nice_to_type(beam_type flavour, monster_type mon_type)
 {
     // Polymorphing a (very) ugly thing will mutate it into a different
     // (very) ugly thing.
     if (flavour == BEAM_POLYMORPH)
     {
-        return mi.type == MONS_UGLY_THING
-               || mi.type == MONS_VERY_UGLY_THING;
+        return mon_type == MONS_UGLY_THING
+               || mon_type == MONS_VERY_UGLY_THING;
     }
 
     if (flavour == BEAM_HASTE
@@ -6460,6 +6505,16 @@ bool bolt::nice_to(const monster_info& mi) const
     return false;
 }
 
+bool bolt::nice_to(const monster_info& mi) const
+{
+    return _nice_to_type(flavour, mi.type);
+}
+
+bool bolt::nice_to(const monster* mon) const
+{
+    return _nice_to_type(flavour, mon->type);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // bolt
 // TODO: Eventually it'd be nice to have a proper factory for these things
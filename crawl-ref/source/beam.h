@@ -204,6 +204,7 @@ public:
     bool is_harmless(const monster* mon) const;
     bool nasty_to(const monster* mon) const;
     bool nice_to(const monster_info& mi) const;
+    bool nice_to(const monster* mon) const;
     bool has_saving_throw() const;
 
     void draw(const coord_def& p, bool force_refresh=true);
@@ -236,6 +237,10 @@ private:
     bool is_omnireflectable() const;
     bool is_fiery() const;
     bool can_burn_trees() const;
+    void spread_explosion(explosion_map& m, const coord_def& delta,
+                          int count, int r, bool stop_at_statues,
+                          bool stop_at_walls, const coord_def& caster_pos,
+                          bool burn_trees);
     bool is_bouncy(dungeon_feature_type feat) const;
     bool stop_at_target() const;
     bool harmless_to_player() const;
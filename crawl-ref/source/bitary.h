@@ -191,4 +191,19 @@ public:
         data &= x.data;
         return *this;
     }
+
+    inline void flip()
+    {
+        data.flip();
+    }
+
+    inline unsigned int count() const
+    {
+        return data.count();
+    }
+
+    inline bool any() const
+    {
+        return data.any();
+    }
 };
@@ -0,0 +1,34 @@
+#include "AppHdr.h"
+
+#include "bench_fixture.h"
+
+#include "coordit.h"
+#include "env.h"
+#include "losglobal.h"
+#include "player.h"
+#include "random.h"
+
+void bench_build_level()
+{
+    you.where_are_you = BRANCH_DUNGEON;
+    you.depth = 1;
+
+    rng::subgenerator level_rng(1, 1);
+    for (rectangle_iterator ri(0); ri; ++ri)
+    {
+        const coord_def p = *ri;
+        env.grid(p) = in_bounds(p) && (p == BENCH_CENTRE || !one_chance_in(5))
+                      ? DNGN_FLOOR : DNGN_ROCK_WALL;
+        env.map_knowledge(p).set_feature(env.grid(p));
+        env.map_knowledge(p).flags |= MAP_GRID_KNOWN;
+    }
+    invalidate_los();
+}
+
+coord_def bench_floor_near(const coord_def &p)
+{
+    for (distance_iterator di(p); di; ++di)
+        if (in_bounds(*di) && env.grid(*di) == DNGN_FLOOR)
+            return *di;
+    return BENCH_CENTRE;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "coord-def.h"
+
+// The middle of the benchmark level, which is always floor.
+const coord_def BENCH_CENTRE(GXM / 2, GYM / 2);
+
+// Make the level the benchmarks work on: open floor with a fixed scattering
+// of rock, all of it mapped, so that LOS and pathfinding have something to
+// work around. It's the same level every time.
+void bench_build_level();
+
+// The nearest floor to p on the benchmark level.
+coord_def bench_floor_near(const coord_def &p);
@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @brief A Catch2 reporter that writes benchmark results as JSON, so that
+ *        runs can be compared by scripts. Use with -r json.
+**/
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#define CATCH_CONFIG_EXTERNAL_INTERFACES
+
+#include "catch.hpp"
+
+#include "AppHdr.h"
+
+#include "json.h"
+#include "json-wrapper.h"
+#include "version.h"
+
+// Catch2 reports durations in nanoseconds.
+static JsonNode *_estimate(const Catch::Benchmark::Estimate<
+                               std::chrono::duration<double, std::nano>> &e)
+{
+    JsonNode *node = json_mkobject();
+    json_append_member(node, "point", json_mknumber(e.point.count()));
+    json_append_member(node, "lower", json_mknumber(e.lower_bound.count()));
+    json_append_member(node, "upper", json_mknumber(e.upper_bound.count()));
+    return node;
+}
+
+class json_reporter : public Catch::StreamingReporterBase<json_reporter>
+{
+public:
+    json_reporter(const Catch::ReporterConfig &config)
+        : StreamingReporterBase(config), results(json_mkarray())
+    {
+    }
+
+    static std::string getDescription()
+    {
+        return "Reports benchmark results as a JSON object";
+    }
+
+    void assertionStarting(const Catch::AssertionInfo &) override { }
+
+    bool assertionEnded(const Catch::AssertionStats &) override
+    {
+        return true;
+    }
+
+    void benchmarkEnded(const Catch::BenchmarkStats<> &stats) override
+    {
+        JsonNode *bench = json_mkobject();
+        json_append_member(bench, "test",
+                           json_mkstring(currentTestCaseInfo->name.c_str()));
+        json_append_member(bench, "name",
+                           json_mkstring(stats.info.name.c_str()));
+        json_append_member(bench, "samples",
+                           json_mknumber(stats.info.samples));
+        json_append_member(bench, "iterations",
+                           json_mknumber(stats.info.iterations));
+        json_append_member(bench, "mean_ns", _estimate(stats.mean));
+        json_append_member(bench, "std_dev_ns",
+                           _estimate(stats.standardDeviation));
+        json_append_member(bench, "outlier_variance",
+                           json_mknumber(stats.outlierVariance));
+        json_append_element(results.node, bench);
+    }
+
+    void testRunEnded(const Catch::TestRunStats &run) override
+    {
+        JsonWrapper report(json_mkobject());
+        json_append_member(report.node, "version",
+                           json_mkstring(Version::Long));
+        json_append_member(report.node, "benchmarks", results.node);
+        results.node = nullptr;
+        stream << report.to_string() << "\n";
+        StreamingReporterBase::testRunEnded(run);
+    }
+
+private:
+    JsonWrapper results;
+};
+
+CATCH_REGISTER_REPORTER("json", json_reporter)
@@ -0,0 +1,30 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "catch.hpp"
+
+#include "AppHdr.h"
+
+#include "bench_fixture.h"
+#include "los.h"
+#include "losglobal.h"
+
+TEST_CASE( "LOS benchmarks", "[benchmark]" ) {
+    bench_build_level();
+
+    BENCHMARK("losight") {
+        los_grid sight;
+        losight(sight, BENCH_CENTRE);
+        return sight(coord_def(1, 1));
+    };
+
+    const coord_def target = bench_floor_near(BENCH_CENTRE + coord_def(5, 3));
+
+    BENCHMARK("cell_see_cell, cached") {
+        return cell_see_cell(BENCH_CENTRE, target, LOS_DEFAULT);
+    };
+
+    BENCHMARK("cell_see_cell, after a terrain change") {
+        invalidate_los_around(BENCH_CENTRE);
+        return cell_see_cell(BENCH_CENTRE, target, LOS_DEFAULT);
+    };
+}
@@ -0,0 +1,35 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "catch.hpp"
+
+#include "AppHdr.h"
+
+#include "bench_fixture.h"
+#include "mon-pathfind.h"
+#include "travel.h"
+
+TEST_CASE( "Pathfinding benchmarks", "[benchmark]" ) {
+    bench_build_level();
+
+    const coord_def start = bench_floor_near(coord_def(2, 2));
+    const coord_def end = bench_floor_near(coord_def(GXM - 3, GYM - 3));
+
+    BENCHMARK("monster_pathfind across the level") {
+        monster_pathfind mp;
+        return mp.init_pathfind(start, end);
+    };
+
+    BENCHMARK("monster_pathfind, short range") {
+        monster_pathfind mp;
+        mp.set_range(8);
+        return mp.init_pathfind(BENCH_CENTRE,
+                                bench_floor_near(BENCH_CENTRE
+                                                 + coord_def(6, -4)));
+    };
+
+    BENCHMARK("travel_pathfind connectivity flood") {
+        travel_pathfind tp;
+        tp.set_floodseed(start);
+        return tp.pathfind(RMODE_CONNECTIVITY);
+    };
+}
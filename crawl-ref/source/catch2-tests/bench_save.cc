@@ -0,0 +1,114 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "catch.hpp"
+
+#include "AppHdr.h"
+
+#include "bench_fixture.h"
+#include "env.h"
+#include "package.h"
+#include "store.h"
+#include "stringutil.h"
+#include "syscalls.h"
+#include "tags.h"
+#include "tag-version.h"
+
+static vector<unsigned char> _marshall_level()
+{
+    vector<unsigned char> buf;
+    writer th(&buf);
+    tag_write(TAG_LEVEL, th);
+    return buf;
+}
+
+TEST_CASE( "Save benchmarks", "[benchmark]" ) {
+    bench_build_level();
+    const vector<unsigned char> level = _marshall_level();
+
+    BENCHMARK("marshall a level") {
+        return _marshall_level().size();
+    };
+
+    BENCHMARK("unmarshall a level") {
+        reader th(level, TAG_MINOR_VERSION);
+        tag_read(th, TAG_LEVEL);
+        return env.grid(BENCH_CENTRE);
+    };
+
+    const char *file = "catch2-bench-package.cs";
+
+    BENCHMARK("package write and commit") {
+        package pkg(file, true, true);
+        chunk_writer *wr = pkg.writer("lev");
+        wr->write(level.data(), level.size());
+        delete wr;
+        pkg.commit();
+    };
+
+    BENCHMARK("package read") {
+        package pkg(file, false);
+        chunk_reader *rd = pkg.reader("lev");
+        vector<char> data;
+        rd->read_all(data);
+        delete rd;
+        return data.size();
+    };
+
+    unlink_u(file);
+}
+
+// A table shaped like a busy monster's props: counters, flags, strings,
+// positions and a nested table or two.
+static CrawlHashTable _busy_props()
+{
+    CrawlHashTable props;
+    for (int i = 0; i < 40; ++i)
+    {
+        props[make_stringf("counter_%d", i)] = i;
+        props[make_stringf("flag_%d", i)] = bool(i & 1);
+        props[make_stringf("name_%d", i)] = make_stringf("a longer name %d", i);
+        props[make_stringf("pos_%d", i)] = coord_def(i, i + 1);
+        props[make_stringf("place_%d", i)] = level_id(BRANCH_DUNGEON, i % 15 + 1);
+    }
+    CrawlHashTable &nested = props["nested"].get_table();
+    for (int i = 0; i < 20; ++i)
+        nested[make_stringf("n%d", i)] = coord_def(i, -i);
+    return props;
+}
+
+TEST_CASE( "CrawlHashTable copy and save benchmarks", "[benchmark]" ) {
+    const CrawlHashTable props = _busy_props();
+    vector<unsigned char> saved;
+    writer w(&saved);
+    props.write(w);
+
+    BENCHMARK("copy props") {
+        CrawlHashTable copy = props;
+        return copy.size();
+    };
+
+    vector<string> keys;
+    for (int i = 0; i < 40; ++i)
+        keys.push_back(make_stringf("counter_%d", i));
+
+    BENCHMARK("look up props") {
+        int total = 0;
+        for (const string &key : keys)
+            total += props[key].get_int();
+        return total;
+    };
+
+    BENCHMARK("save props") {
+        vector<unsigned char> out;
+        writer th(&out);
+        props.write(th);
+        return out.size();
+    };
+
+    BENCHMARK("load props") {
+        reader th(saved);
+        CrawlHashTable loaded;
+        loaded.read(th);
+        return loaded.size();
+    };
+}
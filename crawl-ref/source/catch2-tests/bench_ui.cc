@@ -0,0 +1,112 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include "catch.hpp"
+
+#include "AppHdr.h"
+
+#include "bench_fixture.h"
+#include "env.h"
+#include "files.h"
+#include "format.h"
+#include "mapdef.h"
+#include "maps.h"
+#include "mon-info.h"
+#include "mon-util.h"
+#include "monster.h"
+#include "stringutil.h"
+#include "syscalls.h"
+#include "unicode.h"
+
+TEST_CASE( "Formatting benchmarks", "[benchmark]" ) {
+    const string msg = "<lightred>The orc warrior</lightred> hits you "
+                       "<white>with a +2 orcish great sword</white>! "
+                       "<<nothing</yellow> <green>You feel better.</green>";
+
+    BENCHMARK("formatted_string::parse_string") {
+        return formatted_string::parse_string(msg).ops.size();
+    };
+}
+
+TEST_CASE( "Text width benchmarks", "[benchmark]" ) {
+    // Real description text, as the menus and describe popups wrap it.
+    vector<string> lines;
+    const string path = datafile_path("descript/monsters.txt", false);
+    if (FILE *f = fopen_u(path.c_str(), "r"))
+    {
+        char buf[1024];
+        while (fgets(buf, sizeof(buf), f))
+            lines.emplace_back(buf);
+        fclose(f);
+    }
+    REQUIRE( !lines.empty() );
+
+    BENCHMARK("strwidth") {
+        int w = 0;
+        for (const string &line : lines)
+            w += strwidth(line);
+        return w;
+    };
+
+    BENCHMARK("chop_string") {
+        size_t len = 0;
+        for (const string &line : lines)
+            len += chop_string(line, 40).size();
+        return len;
+    };
+
+    BENCHMARK("wordwrap_line") {
+        int count = 0;
+        for (const string &line : lines)
+        {
+            string rest = line;
+            while (!rest.empty())
+            {
+                wordwrap_line(rest, 60);
+                ++count;
+            }
+        }
+        return count;
+    };
+}
+
+TEST_CASE( "Monster info benchmarks", "[benchmark]" ) {
+    init_monsters();
+    bench_build_level();
+
+    BENCHMARK("monster_info from a type") {
+        return monster_info(MONS_ORC_WARRIOR, MONS_ORC_WARRIOR).hd;
+    };
+
+    monster &mon = env.mons[0];
+    mon.reset();
+    mon.type = MONS_ORC_WARRIOR;
+    mon.base_monster = MONS_NO_MONSTER;
+    define_monster(mon);
+    mon.position = BENCH_CENTRE;
+    env.mgrid(BENCH_CENTRE) = 0;
+
+    BENCHMARK("monster_info from a monster") {
+        return monster_info(&mon).hd;
+    };
+
+    env.mgrid(BENCH_CENTRE) = NON_MONSTER;
+    mon.reset();
+}
+
+TEST_CASE( "Map selection benchmarks", "[benchmark]" ) {
+    bench_build_level();
+
+    // Only a few of these share the tag asked for, as with most real tags.
+    for (int i = 0; i < 200; ++i)
+    {
+        map_def md;
+        md.name = make_stringf("bench_map_%d", i);
+        md.add_tags(i % 10 ? "bench_maps bench_filler"
+                           : "bench_maps bench_want");
+        add_parsed_map(md);
+    }
+
+    BENCHMARK("random_map_for_tag") {
+        return random_map_for_tag("bench_want");
+    };
+}
@@ -0,0 +1,42 @@
+#include "catch.hpp"
+
+#include "AppHdr.h"
+
+#include "colour.h"
+#include "format.h"
+
+TEST_CASE( "parse_string splits text and colour ops", "[single-file]" ) {
+    const formatted_string fs
+        = formatted_string::parse_string("a <red>bc</red> d");
+
+    REQUIRE( fs.tostring() == "a bc d" );
+    REQUIRE( fs.ops.size() == 5 );
+    REQUIRE( fs.ops[0].text == "a " );
+    REQUIRE( fs.ops[1].type == FSOP_COLOUR );
+    REQUIRE( fs.ops[1].colour == RED );
+    REQUIRE( fs.ops[2].text == "bc" );
+    REQUIRE( fs.ops[3].colour == LIGHTGREY );
+    REQUIRE( fs.ops[4].text == " d" );
+}
+
+TEST_CASE( "parse_string handles escapes and bad tags", "[single-file]" ) {
+    REQUIRE( formatted_string::parse_string("<<red>").tostring() == "<red>" );
+    REQUIRE( formatted_string::parse_string("a <").tostring() == "a <" );
+    REQUIRE( formatted_string::parse_string("a <b").tostring() == "a <b" );
+    REQUIRE( formatted_string::parse_string("<>x").tostring() == "<>x" );
+    REQUIRE( formatted_string::parse_string("<nocolour>x").tostring()
+             == "<nocolour>x" );
+    REQUIRE( formatted_string::parse_string("x</red>").tostring()
+             == "x</red>" );
+}
+
+TEST_CASE( "parse_string breaks up long text", "[single-file]" ) {
+    const string text(2500, 'x');
+    const formatted_string fs = formatted_string::parse_string(
+                                    "<blue>" + text + "</blue>");
+
+    REQUIRE( fs.tostring() == text );
+    for (const auto &op : fs.ops)
+        if (op.type == FSOP_TEXT)
+            REQUIRE( op.text.size() <= 999 );
+}
@@ -0,0 +1,68 @@
+#include "catch.hpp"
+
+#include "AppHdr.h"
+
+#include "package.h"
+#include "stringutil.h"
+#include "syscalls.h"
+
+static void _write_chunk(package &pkg, const string &name, const string &data)
+{
+    chunk_writer *wr = pkg.writer(name);
+    wr->write(data.data(), data.size());
+    delete wr;
+}
+
+static string _read_chunk(package &pkg, const string &name)
+{
+    chunk_reader *rd = pkg.reader(name);
+    REQUIRE(rd);
+    vector<char> data;
+    rd->read_all(data);
+    delete rd;
+    return string(data.begin(), data.end());
+}
+
+TEST_CASE( "Package chunks read back what was last written", "[single-file]" ) {
+
+    const char *file = "catch2-test-package.cs";
+
+    SECTION ("rewritten chunks are not served stale from memory") {
+        {
+            package pkg(file, true, true);
+            _write_chunk(pkg, "lev", "first version");
+            REQUIRE(_read_chunk(pkg, "lev") == "first version");
+            REQUIRE(_read_chunk(pkg, "lev") == "first version");
+            pkg.commit();
+
+            _write_chunk(pkg, "lev", "second, longer version");
+            REQUIRE(_read_chunk(pkg, "lev") == "second, longer version");
+            pkg.commit();
+            REQUIRE(_read_chunk(pkg, "lev") == "second, longer version");
+        }
+        {
+            package pkg(file, true);
+            REQUIRE(_read_chunk(pkg, "lev") == "second, longer version");
+            REQUIRE(_read_chunk(pkg, "lev") == "second, longer version");
+        }
+        unlink_u(file);
+    }
+
+    SECTION ("chunks too big for the cache and evicted chunks still read") {
+        const string big(PACKAGE_CACHE_SIZE / 2, 'x');
+        const string medium(PACKAGE_CACHE_SIZE / 8, 'y');
+        {
+            package pkg(file, true, true);
+            _write_chunk(pkg, "big", big);
+            for (int i = 0; i < 16; ++i)
+                _write_chunk(pkg, make_stringf("m%d", i), medium);
+            pkg.commit();
+
+            REQUIRE(_read_chunk(pkg, "big") == big);
+            for (int i = 0; i < 16; ++i)
+                REQUIRE(_read_chunk(pkg, make_stringf("m%d", i)) == medium);
+            REQUIRE(_read_chunk(pkg, "m0") == medium);
+        }
+        unlink_u(file);
+    }
+}
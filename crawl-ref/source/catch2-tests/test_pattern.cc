@@ -0,0 +1,37 @@
+#include "catch.hpp"
+
+#include "AppHdr.h"
+
+#include "pattern.h"
+
+TEST_CASE( "pattern_set matches if any pattern does", "[single-file]" ) {
+    pattern_set set;
+    REQUIRE( set.empty() );
+    REQUIRE( !set.matches("anything") );
+
+    set.add(text_pattern("^You die"));
+    set.add(text_pattern("[0-9]+ gold"));
+    set.add(text_pattern("SHOUTS", true));
+
+    REQUIRE( set.matches("You die...") );
+    REQUIRE( set.matches("There are 12 gold pieces here.") );
+    REQUIRE( set.matches("The orc shouts!") );
+    REQUIRE( !set.matches("Not you die") );
+    REQUIRE( !set.matches("gold") );
+}
+
+TEST_CASE( "pattern_set copes with patterns it can't join", "[single-file]" ) {
+    pattern_set set;
+    set.add(text_pattern("(ab)\\1"));
+    set.add(text_pattern("[unclosed"));
+    set.add(text_pattern("orc"));
+    set.add(text_pattern(""));
+
+    REQUIRE( set.matches("abab") );
+    REQUIRE( !set.matches("ab") );
+    REQUIRE( set.matches("an orc") );
+    REQUIRE( !set.matches("a goblin") );
+
+    set.clear();
+    REQUIRE( !set.matches("an orc") );
+}
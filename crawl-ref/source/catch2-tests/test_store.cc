@@ -0,0 +1,138 @@
+#include "catch.hpp"
+
+#include "AppHdr.h"
+
+#include "store.h"
+#include "stringutil.h"
+
+// Check the table against what a plain map with the same operations holds.
+static void _check_table(const CrawlHashTable &table,
+                         const map<string, int> &expected)
+{
+    REQUIRE(table.size() == expected.size());
+    auto entry = table.begin();
+    for (const auto &want : expected)
+    {
+        REQUIRE(entry->first == want.first);
+        REQUIRE(table.exists(want.first));
+        REQUIRE(table[want.first.c_str()].get_int() == want.second);
+        ++entry;
+    }
+}
+
+TEST_CASE( "CrawlHashTable lookups follow changes to the table",
+           "[single-file]" ) {
+
+    CrawlHashTable table;
+    map<string, int> expected;
+
+    SECTION ("small and indexed tables find what was put in") {
+        for (int i = 0; i < 50; ++i)
+        {
+            const string key = make_stringf("key_%d", i * 7 % 50);
+            table[key.c_str()] = i;
+            expected[key] = i;
+            _check_table(table, expected);
+        }
+        REQUIRE_FALSE(table.exists("key_50"));
+        REQUIRE_FALSE(table.exists(""));
+    }
+
+    SECTION ("erasing keeps the rest of the index usable") {
+        for (int i = 0; i < 40; ++i)
+        {
+            const string key = make_stringf("prop_%d", i);
+            table[key] = i;
+            expected[key] = i;
+        }
+        for (int i = 0; i < 40; i += 3)
+        {
+            const string key = make_stringf("prop_%d", i);
+            REQUIRE(table.erase(key) == 1);
+            expected.erase(key);
+            _check_table(table, expected);
+        }
+        REQUIRE(table.erase("prop_0") == 0);
+
+        auto it = table.find("prop_1");
+        table.erase(it);
+        expected.erase("prop_1");
+        _check_table(table, expected);
+    }
+
+    SECTION ("inserting around the index is noticed") {
+        for (int i = 0; i < 20; ++i)
+        {
+            const string key = make_stringf("a%d", i);
+            table[key] = i;
+            expected[key] = i;
+        }
+        _check_table(table, expected);
+        table.emplace("b", CrawlStoreValue(99));
+        expected["b"] = 99;
+        table.erase("a3");
+        expected.erase("a3");
+        _check_table(table, expected);
+    }
+
+    SECTION ("copies and swaps keep their own indices") {
+        for (int i = 0; i < 20; ++i)
+        {
+            const string key = make_stringf("k%d", i);
+            table[key] = i;
+            expected[key] = i;
+        }
+        _check_table(table, expected);
+
+        CrawlHashTable copy = table;
+        copy.erase("k5");
+        table.erase("k6");
+        _check_table(copy, [&] {
+            map<string, int> m = expected; m.erase("k5"); return m; }());
+
+        CrawlHashTable other;
+        other["x"] = 1;
+        other.swap(table);
+        expected.erase("k6");
+        _check_table(other, expected);
+        _check_table(table, { { "x", 1 } });
+
+        table.clear();
+        REQUIRE_FALSE(table.exists("x"));
+    }
+}
+
+TEST_CASE( "CrawlStoreValue moves and inline values", "[single-file]" ) {
+
+    SECTION ("moving takes the value and leaves the source unset") {
+        CrawlStoreValue from;
+        from.get_table()["a"] = 1;
+        from.get_table()["b"] = string("bee");
+        const CrawlHashTable *table = &from.get_table();
+
+        CrawlStoreValue to(std::move(from));
+        REQUIRE(&to.get_table() == table);
+        REQUIRE(from.get_type() == SV_NONE);
+
+        CrawlStoreValue other(string("old"));
+        other = std::move(to);
+        REQUIRE(&other.get_table() == table);
+        REQUIRE(other.get_table()["b"].get_string() == "bee");
+    }
+
+    SECTION ("coords and level ids survive copies and type changes") {
+        CrawlHashTable table;
+        table["pos"] = coord_def(3, 4);
+        table["place"] = level_id(BRANCH_LAIR, 2);
+        CrawlHashTable copy = table;
+        copy["pos"].get_coord().x = 5;
+        REQUIRE(table["pos"].get_coord() == coord_def(3, 4));
+        REQUIRE(copy["pos"].get_coord() == coord_def(5, 4));
+        REQUIRE(copy["place"].get_level_id() == level_id(BRANCH_LAIR, 2));
+
+        copy["pos"] = string("somewhere");
+        REQUIRE(copy["pos"].get_string() == "somewhere");
+        copy["pos"] = coord_def(1, 1);
+        REQUIRE(copy["pos"].get_coord() == coord_def(1, 1));
+    }
+}
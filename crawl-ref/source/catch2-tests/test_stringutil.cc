@@ -6,6 +6,7 @@
 #include <locale.h>
 
 #include "stringutil.h"
+#include "unicode.h"
 
 // Test plain arrays, vectors, and lists (not random-access), with const variants of both
 TEMPLATE_TEST_CASE( "comma_separated_*", "[single-file]",
@@ -114,3 +115,21 @@ TEST_CASE( "uppercase and lowercase", "[single-file]")
         CHECK(&result2 == &s1);
     }
 }
+
+TEST_CASE( "strwidth and chop_string on ASCII", "[single-file]")
+{
+    // Long enough to go through the word-at-a-time path, with the odd
+    // control character (no width) and DEL to knock it off again.
+    const string text = "The orc warrior hits you with a great sword!";
+    CHECK(strwidth(text) == (int) text.size());
+    CHECK(strwidth("abcdefgh\tijklmnop\x7fqrs") == 19);
+    CHECK(strwidth("") == 0);
+
+    for (int width = 0; width <= (int) text.size() + 2; ++width)
+    {
+        const string chopped = chop_string(text, width, false);
+        CHECK(chopped == text.substr(0, width));
+        CHECK(strwidth(chop_string(text, width)) == width);
+    }
+    CHECK(chop_string("abcdefgh\tijklmnop", 9, false) == "abcdefgh\ti");
+}
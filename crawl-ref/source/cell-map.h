@@ -0,0 +1,134 @@
+/**
+ * @file
+ * @brief A map from level positions to things, for things that exist on at
+ *        most a few cells of the level (clouds, traps, shops).
+**/
+
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "coord.h"
+#include "fixedarray.h"
+
+/**
+ * A grid of indices into a pool of values, with freed entries reused.
+ *
+ * Lookups are a single grid read. Values don't move around in the pool, so
+ * references to one stay good while others are added. Iteration visits
+ * values in position order (by x, then y), as map<coord_def, T> does; saves
+ * and the order things act in depend on that.
+ *
+ * T must have a coord_def pos member, which callers keep up to date.
+ */
+template <class T> class cell_map
+{
+public:
+    cell_map() : slots(NONE), count(0) { }
+
+    /// The value at p, which is default constructed if there's none.
+    T &operator[](const coord_def &p)
+    {
+        ASSERT(map_bounds(p));
+        short &slot = slots(p);
+        if (slot != NONE)
+            return pool[slot];
+
+        if (free_slots.empty())
+        {
+            slot = pool.size();
+            pool.emplace_back();
+        }
+        else
+        {
+            slot = free_slots.back();
+            free_slots.pop_back();
+            pool[slot] = T();
+        }
+        ++count;
+        return pool[slot];
+    }
+
+    T *find(const coord_def &p)
+    {
+        if (!map_bounds(p))
+            return nullptr;
+        const short slot = slots(p);
+        return slot == NONE ? nullptr : &pool[slot];
+    }
+
+    const T *find(const coord_def &p) const
+    {
+        return const_cast<cell_map *>(this)->find(p);
+    }
+
+    void erase(const coord_def &p)
+    {
+        if (!map_bounds(p))
+            return;
+        short &slot = slots(p);
+        if (slot == NONE)
+            return;
+        free_slots.push_back(slot);
+        slot = NONE;
+        --count;
+    }
+
+    void clear()
+    {
+        slots.init(NONE);
+        pool.clear();
+        free_slots.clear();
+        count = 0;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return !count; }
+
+    template <class Map, class Value> class iter
+    {
+    public:
+        iter(Map &m, int i) : cmap(m), cell(i) { skip_empty(); }
+        Value &operator*() const
+        {
+            return cmap.pool[cmap.slots[cell / GYM][cell % GYM]];
+        }
+        Value *operator->() const { return &**this; }
+        iter &operator++() { ++cell; skip_empty(); return *this; }
+        bool operator!=(const iter &other) const
+        {
+            return cell != other.cell;
+        }
+    private:
+        void skip_empty()
+        {
+            while (cell < GXM * GYM
+                   && cmap.slots[cell / GYM][cell % GYM] == NONE)
+            {
+                ++cell;
+            }
+        }
+
+        Map &cmap;
+        int cell;
+    };
+    typedef iter<cell_map, T> iterator;
+    typedef iter<const cell_map, const T> const_iterator;
+
+    iterator begin() { return iterator(*this, count ? 0 : GXM * GYM); }
+    iterator end() { return iterator(*this, GXM * GYM); }
+    const_iterator begin() const
+    {
+        return const_iterator(*this, count ? 0 : GXM * GYM);
+    }
+    const_iterator end() const { return const_iterator(*this, GXM * GYM); }
+
+private:
+    enum { NONE = -1 };
+
+    FixedArray<short, GXM, GYM> slots;
+    deque<T> pool;
+    vector<short> free_slots;
+    size_t count;
+};
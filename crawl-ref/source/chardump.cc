@@ -51,6 +51,7 @@
 #include "state.h"
 #include "stringutil.h"
 #include "tag-version.h"
+#include "threads.h"
 #include "transform.h"
 #include "travel.h"
 #include "unicode.h"
@@ -91,7 +92,8 @@ static void _sdump_action_counts(dump_params &);
 static void _sdump_separator(dump_params &);
 static void _sdump_lua(dump_params &);
 static bool _write_dump(const string &fname, const dump_params &,
-                        bool print_dump_path = false);
+                        bool print_dump_path = false,
+                        bool background = false);
 
 struct dump_section_handler
 {
@@ -180,10 +182,18 @@ static dump_params _get_dump(bool full_id = false,
     return par;
 }
 
+/**
+ * Write a character dump to the morgue.
+ *
+ * @param background  Leave writing the text out to a thread, so that the
+ *                    game can get on with the death screen; the file has
+ *                    already been created when this returns.
+ *                    finish_char_dump() waits for it.
+ */
 bool dump_char(const string &fname, bool quiet, bool full_id,
-               const scorefile_entry *se)
+               const scorefile_entry *se, bool background)
 {
-    return _write_dump(fname, _get_dump(full_id, se), quiet);
+    return _write_dump(fname, _get_dump(full_id, se), quiet, background);
 }
 
 string seed_description()
@@ -1653,8 +1663,39 @@ void dump_map(const char* fname, bool debug, bool dist, bool log)
     fclose(fp);
 }
 
-static bool _write_dump(const string &fname, const dump_params &par, bool quiet)
+// A dump being written out by a thread.
+struct pending_dump
+{
+    FILE *handle;
+    string text;
+};
+static pending_dump *_pending_dump = nullptr;
+static thread_t _dump_thread;
+
+static void *_dump_thread_main(void *arg)
+{
+    pending_dump *dump = static_cast<pending_dump *>(arg);
+    fputs(dump->text.c_str(), dump->handle);
+    fclose(dump->handle);
+    return nullptr;
+}
+
+/// Wait for the dump being written in the background, if there is one.
+void finish_char_dump()
 {
+    if (!_pending_dump)
+        return;
+    thread_join(_dump_thread);
+    delete _pending_dump;
+    _pending_dump = nullptr;
+}
+
+static bool _write_dump(const string &fname, const dump_params &par, bool quiet,
+                        bool background)
+{
+    // This may be the same file again.
+    finish_char_dump();
+
     bool succeeded = false;
 
     string file_name = morgue_directory();
@@ -1675,8 +1716,21 @@ static bool _write_dump(const string &fname, const dump_params &par, bool quiet)
 
     if (handle != nullptr)
     {
-        fputs(OUTS(par.text), handle);
-        fclose(handle);
+        pending_dump *dump = nullptr;
+        if (background)
+            dump = new pending_dump { handle, OUTS(par.text) };
+        if (dump && !thread_create_joinable(&_dump_thread, _dump_thread_main,
+                                            dump))
+        {
+            _pending_dump = dump;
+        }
+        else
+        {
+            // No thread, so write it now.
+            delete dump;
+            fputs(OUTS(par.text), handle);
+            fclose(handle);
+        }
         succeeded = true;
         if (!quiet)
 #ifdef DGAMELAUNCH
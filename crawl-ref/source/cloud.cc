@@ -15,6 +15,7 @@
 #include "art-enum.h"
 #include "colour.h"
 #include "coordit.h"
+#include "dbg-prof.h"
 #include "dungeon.h"
 #include "english.h"
 #include "god-conduct.h"
@@ -43,7 +44,7 @@
 
 cloud_struct* cloud_at(coord_def pos)
 {
-    return map_find(env.cloud, pos);
+    return env.cloud.find(pos);
 }
 
 /// damage = base + random2avg(random, random/15 + 1)
@@ -369,6 +370,19 @@ static bool _killer_whose_match(kill_category whose, killer_type killer)
 }
 #endif
 
+// Cloud changes whose LOS invalidation is being held back until the end of
+// a pass over many clouds; see cloud_los_batch.
+struct deferred_los_changes
+{
+    vector<coord_def> cells;
+    // Whether each cell had an opaque cloud before its first change, or -1
+    // if it hasn't changed.
+    FixedArray<int8_t, GXM, GYM> was_opaque;
+
+    deferred_los_changes() : was_opaque(-1) { }
+};
+static deferred_los_changes *_deferred_los = nullptr;
+
 /*
  * The LOS may have changed based on cloud changes at position `p`.
  *
@@ -378,10 +392,66 @@ static bool _killer_whose_match(kill_category whose, killer_type killer)
  */
 static void _los_cloud_changed(const coord_def& p, const cloud_type t, const cloud_type old)
 {
-    if (is_opaque_cloud(t) || is_opaque_cloud(old))
-        los_terrain_changed(p);
+    if (!is_opaque_cloud(t) && !is_opaque_cloud(old))
+        return;
+
+    if (_deferred_los)
+    {
+        int8_t &was = _deferred_los->was_opaque(p);
+        if (was < 0)
+        {
+            was = is_opaque_cloud(old);
+            _deferred_los->cells.push_back(p);
+        }
+        return;
+    }
+
+    los_terrain_changed(p);
 }
 
+/**
+ * While one of these is in scope, LOS isn't told about cloud changes as they
+ * happen. When it ends, LOS is told once about each cell whose opacity
+ * differs from before, so a cloud that dissipates and is replaced, or a cell
+ * that several clouds spread into, is only invalidated once (or not at all).
+ *
+ * Cached LOS between cells may be out of date until then.
+ */
+class cloud_los_batch
+{
+public:
+    cloud_los_batch() : owner(!_deferred_los)
+    {
+        if (owner)
+            _deferred_los = &changes;
+    }
+
+    ~cloud_los_batch()
+    {
+        finish();
+    }
+
+    /// Tell LOS about the changes so far, and stop holding them back.
+    void finish()
+    {
+        if (!owner)
+            return;
+        owner = false;
+        _deferred_los = nullptr;
+
+        vector<coord_def> changed;
+        for (const coord_def &p : changes.cells)
+            if (changes.was_opaque(p) != is_opaque_cloud(cloud_type_at(p)))
+                changed.push_back(p);
+        if (!changed.empty())
+            los_terrain_changed(changed);
+    }
+
+private:
+    bool owner;
+    deferred_los_changes changes;
+};
+
 cloud_struct::cloud_struct(coord_def p, cloud_type c, int d, int spread,
                            kill_category kc, killer_type kt, mid_t src,
                            int excl)
@@ -616,14 +686,20 @@ static void _handle_spectral_cloud(const cloud_struct& cloud)
 
 void manage_clouds()
 {
+    PROFILE_SCOPE(PROF_CLOUDS);
+    cloud_los_batch los_batch;
+
     // We can't iterate over env.cloud directly because _dissipate_cloud
     // will remove this cloud and invalidate our iterator.
-    vector<cloud_struct *> cloud_ptrs;
-    for (auto& entry : env.cloud)
-        cloud_ptrs.push_back(&entry.second);
+    vector<coord_def> cloud_locs;
+    for (const cloud_struct& cloud : env.cloud)
+        cloud_locs.push_back(cloud.pos);
 
-    for (auto ptr : cloud_ptrs)
+    for (coord_def pos : cloud_locs)
     {
+        cloud_struct* ptr = cloud_at(pos);
+        if (!ptr)
+            continue;
         cloud_struct& cloud = *ptr;
 
 #ifdef ASSERTS
@@ -642,6 +718,7 @@ void manage_clouds()
         _dissipate_cloud(cloud);
     }
 
+    los_batch.finish();
     update_cloud_knowledge();
 }
 
@@ -689,8 +766,8 @@ void delete_all_clouds()
     // We can't iterate over env.cloud directly because delete_cloud
     // will remove this cloud and invalidate our iterator.
     vector<coord_def> cloud_locs;
-    for (auto& entry : env.cloud)
-        cloud_locs.push_back(entry.first);
+    for (const cloud_struct& cloud : env.cloud)
+        cloud_locs.push_back(cloud.pos);
 
     for (auto pos : cloud_locs)
         delete_cloud(pos);
@@ -775,6 +852,10 @@ void place_cloud(cloud_type cl_type, const coord_def& ctarget, int cl_range,
                  const actor *agent, int spread_rate, int excl_rad,
                  bool do_conducts)
 {
+    // It wouldn't last; see update_level().
+    if (crawl_state.updating_level)
+        return;
+
     if (is_sanctuary(ctarget) && !is_harmless_cloud(cl_type))
         return;
 
@@ -1828,9 +1909,9 @@ void remove_vortex_clouds(mid_t whose)
     // We can't iterate over env.cloud directly because delete_cloud
     // will remove this cloud and invalidate our iterator.
     vector<coord_def> vortices;
-    for (auto& entry : env.cloud)
-        if (entry.second.type == CLOUD_VORTEX && entry.second.source == whose)
-            vortices.push_back(entry.first);
+    for (const cloud_struct& cloud : env.cloud)
+        if (cloud.type == CLOUD_VORTEX && cloud.source == whose)
+            vortices.push_back(cloud.pos);
 
     for (auto pos : vortices)
         delete_cloud(pos);
@@ -1881,6 +1962,7 @@ void run_cloud_spreaders(int dur)
     if (!dur)
         return;
 
+    cloud_los_batch los_batch;
     for (map_marker *marker : env.markers.get_all(MAT_CLOUD_SPREADER))
     {
         map_cloud_spreader_marker * const mark
@@ -3,6 +3,8 @@
 #include "clua.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 
 #include "cluautil.h"
 #include "dlua.h"
@@ -28,6 +30,135 @@
 #define NO_CUSTOM_ALLOCATOR
 #endif
 
+#ifndef NO_CUSTOM_ALLOCATOR
+// Most of what Lua allocates is small: strings, table nodes, closures and
+// the like. Carving those from bigger chunks, with a free list for each
+// size, saves a malloc() and free() apiece, and keeps a bot that churns
+// through tables every turn from fragmenting the heap. Chunks are only
+// freed with the pool, so it holds on to the VM's peak small-block use.
+class lua_alloc_pool
+{
+public:
+    ~lua_alloc_pool()
+    {
+        for (char *chunk : chunks)
+            free(chunk);
+    }
+
+    // As for lua_Alloc: osize is the block's old size, nsize its new one.
+    void *reallocate(void *ptr, size_t osize, size_t nsize)
+    {
+        const int oclass = ptr ? _size_class(osize) : LARGE;
+        if (!nsize)
+        {
+            if (ptr)
+                release(ptr, oclass);
+            return nullptr;
+        }
+
+        const int nclass = _size_class(nsize);
+        if (!ptr)
+            return nclass == LARGE ? malloc(nsize) : take(nclass);
+        if (oclass == LARGE && nclass == LARGE)
+            return realloc(ptr, nsize);
+        if (oclass == nclass)
+            return ptr;
+
+        void *block = nclass == LARGE ? malloc(nsize) : take(nclass);
+        if (!block)
+            return nullptr;
+        memcpy(block, ptr, min(osize, nsize));
+        release(ptr, oclass);
+        return block;
+    }
+
+private:
+    static const int LARGE = -1;
+    // Sizes are rounded up to a multiple of GRANULE, which keeps blocks
+    // as aligned as malloc() would.
+    static const size_t GRANULE = 16;
+    static const size_t MAX_SMALL = 256;
+    static const size_t CHUNK_SIZE = 16 * 1024;
+    static const int NUM_CLASSES = MAX_SMALL / GRANULE;
+
+    struct free_block
+    {
+        free_block *next;
+    };
+
+    static int _size_class(size_t size)
+    {
+        if (!size || size > MAX_SMALL)
+            return LARGE;
+        return (size - 1) / GRANULE;
+    }
+
+    void *take(int size_class)
+    {
+        if (!free_lists[size_class])
+            refill(size_class);
+        free_block *block = free_lists[size_class];
+        if (block)
+            free_lists[size_class] = block->next;
+        return block;
+    }
+
+    void release(void *ptr, int size_class)
+    {
+        if (size_class == LARGE)
+        {
+            free(ptr);
+            return;
+        }
+        free_block *block = static_cast<free_block *>(ptr);
+        block->next = free_lists[size_class];
+        free_lists[size_class] = block;
+    }
+
+    void refill(int size_class)
+    {
+        char *chunk = static_cast<char *>(malloc(CHUNK_SIZE));
+        if (!chunk)
+            return;
+        chunks.push_back(chunk);
+        const size_t size = (size_class + 1) * GRANULE;
+        for (size_t off = 0; off + size <= CHUNK_SIZE; off += size)
+            release(chunk + off, size_class);
+    }
+
+    free_block *free_lists[NUM_CLASSES] = {};
+    vector<char *> chunks;
+};
+#else
+class lua_alloc_pool { };
+#endif
+
+// Charges the wall time until it goes out of scope to a function in
+// CLua::fn_times. A null fn (a function from the stack) isn't counted.
+class lua_fn_timer
+{
+public:
+    lua_fn_timer(CLua &lua, const char *fn)
+        : entry(fn ? &lua.fn_times[fn] : nullptr),
+          start(chrono::steady_clock::now())
+    {
+    }
+
+    ~lua_fn_timer()
+    {
+        if (!entry)
+            return;
+        const auto elapsed = chrono::steady_clock::now() - start;
+        ++entry->calls;
+        entry->usec
+            += chrono::duration_cast<chrono::microseconds>(elapsed).count();
+    }
+
+private:
+    lua_fn_time *entry;
+    chrono::steady_clock::time_point start;
+};
+
 static int  _clua_panic(lua_State *);
 static void _clua_throttle_hook(lua_State *, lua_Debug *);
 #ifndef NO_CUSTOM_ALLOCATOR
@@ -45,8 +176,9 @@ CLua::CLua(bool managed)
       throttle_sleep_ms(0), throttle_sleep_start(2),
       throttle_sleep_end(800), n_throttle_sleeps(0), mixed_call_depth(0),
       lua_call_depth(0), max_mixed_call_depth(8),
-      max_lua_call_depth(100), memory_used(0),
-      _state(nullptr), sourced_files(), uniqindex(0)
+      max_lua_call_depth(100), memory_used(0), alloc_pool(), fn_times(),
+      unset_globals(), _state(nullptr), gc_pause(0), gc_stepmul(0),
+      sourced_files(), uniqindex(0)
 {
 }
 
@@ -218,11 +350,30 @@ void CLua::set_error(int err, lua_State *ls)
     error = serr? serr : "<Unknown error>";
 }
 
+// Lua 5.1 only has the incremental collector, so what there is to tune is
+// how long it waits after a cycle (pause, as a percentage of the memory in
+// use after the last one) and how much it does per step (stepmul).
+void CLua::apply_gc_options()
+{
+    if (gc_pause != Options.lua_gc_pause)
+    {
+        gc_pause = Options.lua_gc_pause;
+        lua_gc(_state, LUA_GCSETPAUSE, gc_pause);
+    }
+    if (gc_stepmul != Options.lua_gc_stepmul)
+    {
+        gc_stepmul = Options.lua_gc_stepmul;
+        lua_gc(_state, LUA_GCSETSTEPMUL, gc_stepmul);
+    }
+}
+
 void CLua::init_throttle()
 {
     if (!managed_vm)
         return;
 
+    apply_gc_options();
+
     if (!crawl_state.throttle)
         return;
 
@@ -343,11 +494,18 @@ bool CLua::runhook(const char *hook, const char *params, ...)
     if (!ls)
         return false;
 
+    if (is_unset_global(hook))
+        return false;
+
     lua_stack_cleaner clean(ls);
 
     pushglobal(hook);
     if (!lua_istable(ls, -1))
+    {
+        note_unset_global(hook);
         return false;
+    }
+    lua_fn_timer timer(*this, hook);
     for (int i = 1; ; ++i)
     {
         lua_stack_cleaner clean2(ls);
@@ -549,12 +707,19 @@ maybe_bool CLua::callmbooleanfn(const char *fn, const char *params,
     if (!ls)
         return MB_MAYBE;
 
+    if (is_unset_global(fn))
+        return MB_MAYBE;
+
     lua_stack_cleaner clean(ls);
 
     pushglobal(fn);
     if (!lua_isfunction(ls, -1))
+    {
+        note_unset_global(fn);
         return MB_MAYBE;
+    }
 
+    lua_fn_timer timer(*this, fn);
     bool ret = calltopfn(ls, params, args, 1);
     if (!ret)
         return MB_MAYBE;
@@ -578,12 +743,19 @@ maybe_bool CLua::callmaybefn(const char *fn, const char *params, va_list args)
     if (!ls)
         return MB_MAYBE;
 
+    if (is_unset_global(fn))
+        return MB_MAYBE;
+
     lua_stack_cleaner clean(ls);
 
     pushglobal(fn);
     if (!lua_isfunction(ls, -1))
+    {
+        note_unset_global(fn);
         return MB_MAYBE;
+    }
 
+    lua_fn_timer timer(*this, fn);
     bool ret = calltopfn(ls, params, args, 1);
     if (!ret)
         return MB_MAYBE;
@@ -614,6 +786,32 @@ bool CLua::proc_returns(const char *par) const
     return strchr(par, '>') != nullptr;
 }
 
+// Most hooks are only defined by a few players, yet some are tried for
+// every message or every turn. Globals found to be nil are remembered
+// until something assigns to them, which always goes through
+// _clua_set_new_global: a nil global isn't in _G, so setting it calls
+// _G's __newindex. Only simple names are remembered, since tables can
+// change without touching _G.
+bool CLua::is_unset_global(const char *name) const
+{
+    return !unset_globals.empty() && unset_globals.count(name);
+}
+
+// Call with the result of pushglobal(name) on top of the stack.
+void CLua::note_unset_global(const char *name)
+{
+    if (managed_vm && lua_isnil(_state, -1) && !strchr(name, '.'))
+        unset_globals.insert(name);
+}
+
+static int _clua_set_new_global(lua_State *ls)
+{
+    if (lua_type(ls, 2) == LUA_TSTRING)
+        CLua::get_vm(ls).unset_globals.erase(lua_tostring(ls, 2));
+    lua_rawset(ls, 1);
+    return 0;
+}
+
 // Identical to lua_getglobal for simple names, but will look up
 // "a.b.c" names in tables, so you can pushglobal("dgn.point") and get
 // _G['dgn']['point'], as expected.
@@ -658,12 +856,13 @@ bool CLua::callfn(const char *fn, const char *params, ...)
 {
     error.clear();
     lua_State *ls = state();
-    if (!ls)
+    if (!ls || is_unset_global(fn))
         return false;
 
     pushglobal(fn);
     if (!lua_isfunction(ls, -1))
     {
+        note_unset_global(fn);
         lua_pop(ls, 1);
         return false;
     }
@@ -672,6 +871,7 @@ bool CLua::callfn(const char *fn, const char *params, ...)
     va_list fnret;
     va_start(args, params);
 
+    lua_fn_timer timer(*this, fn);
     bool ret = calltopfn(ls, params, args, -1, &fnret);
     if (ret)
     {
@@ -694,9 +894,16 @@ bool CLua::callfn(const char *fn, int nargs, int nret)
     // If a function is not provided on the stack, get the named function.
     if (fn)
     {
+        if (is_unset_global(fn))
+        {
+            lua_settop(ls, -nargs - 1);
+            return false;
+        }
+
         pushglobal(fn);
         if (!lua_isfunction(ls, -1))
         {
+            note_unset_global(fn);
             lua_settop(ls, -nargs - 2);
             return false;
         }
@@ -706,6 +913,7 @@ bool CLua::callfn(const char *fn, int nargs, int nret)
             lua_insert(ls, -nargs - 1);
     }
 
+    lua_fn_timer timer(*this, fn);
     lua_call_throttle strangler(this);
     int err = lua_pcall(ls, nargs, nret, 0);
     set_error(err, ls);
@@ -727,6 +935,8 @@ void CLua::init_lua()
     _state = luaL_newstate();
 #else
     // Throttle memory usage in managed (clua) VMs
+    if (managed_vm)
+        alloc_pool = make_unique<lua_alloc_pool>();
     _state = managed_vm? lua_newstate(_clua_allocator, this) : luaL_newstate();
 #endif
     if (!_state)
@@ -779,6 +989,15 @@ void CLua::init_lua()
 
     lua_pushlightuserdata(_state, this);
     setregistry("__clua");
+
+    if (managed_vm)
+    {
+        lua_pushvalue(_state, LUA_GLOBALSINDEX);
+        lua_newtable(_state);
+        lua_pushcfunction(_state, _clua_set_new_global);
+        lua_setfield(_state, -2, "__newindex");
+        lua_setmetatable(_state, -2);
+    }
 }
 
 static int lua_loadstring(lua_State *ls)
@@ -1108,13 +1327,7 @@ static void *_clua_allocator(void *ud, void *ptr, size_t osize, size_t nsize)
         return nullptr;
     }
 
-    if (!nsize)
-    {
-        free(ptr);
-        return nullptr;
-    }
-    else
-        return realloc(ptr, nsize);
+    return cl->alloc_pool->reallocate(ptr, osize, nsize);
 }
 #endif
 
@@ -9,8 +9,10 @@ extern "C" {
 #include <cstdarg>
 #include <cstdio>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "maybe-bool.h"
@@ -18,6 +20,7 @@ extern "C" {
 using std::vector;
 
 class CLua;
+class lua_alloc_pool;
 
 class lua_stack_cleaner
 {
@@ -86,6 +89,13 @@ private:
     void cleanup();
 };
 
+// Calls to a named Lua function from C++, and the wall time they took.
+struct lua_fn_time
+{
+    unsigned int calls = 0;
+    int64_t usec = 0;
+};
+
 class CLua
 {
 public:
@@ -167,11 +177,20 @@ public:
     int max_lua_call_depth;
 
     long memory_used;
+    // Small blocks for a managed VM's allocator; freed after the state is.
+    unique_ptr<lua_alloc_pool> alloc_pool;
+
+    // Time spent in functions and hooks called by name, such as a bot's
+    // ready(). Nested calls are counted in both.
+    map<string, lua_fn_time> fn_times;
+    // Globals that were nil when last looked for; see is_unset_global().
+    unordered_set<string> unset_globals;
 
     static const int MAX_THROTTLE_SLEEPS = 15;
 
 private:
     lua_State *_state;
+    int gc_pause, gc_stepmul;
     typedef set<string> sfset;
     sfset sourced_files;
     unsigned int uniqindex;
@@ -182,6 +201,9 @@ private:
     void init_lua();
     void set_error(int err, lua_State *ls = nullptr);
     void init_throttle();
+    void apply_gc_options();
+    bool is_unset_global(const char *name) const;
+    void note_unset_global(const char *name);
 
     static void _getregistry(lua_State *, const char *name);
 
@@ -648,6 +648,20 @@ void init_element_colours()
                        ));
 }
 
+static unsigned int _element_colour_evaluations = 0;
+
+// Elements whose colour depends only on the cell they're drawn at.
+static bool _element_colour_is_fixed(int element)
+{
+    return element == ETC_TREE || element == ETC_MANGROVE
+           || element == ETC_ELVEN_BRICK;
+}
+
+unsigned int element_colour_evaluations()
+{
+    return _element_colour_evaluations;
+}
+
 int element_colour(int element, bool no_random, const coord_def& loc)
 {
     // pass regular colours through for safety.
@@ -657,6 +671,9 @@ int element_colour(int element, bool no_random, const coord_def& loc)
     // Strip COLFLAGs just in case.
     element &= 0x007f;
 
+    if (!_element_colour_is_fixed(element))
+        ++_element_colour_evaluations;
+
     ASSERT(element_colours[element]);
     int ret = element_colours[element]->get(loc, no_random);
 
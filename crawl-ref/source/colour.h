@@ -120,6 +120,10 @@ colour_t make_low_colour(colour_t colour) IMMUTABLE;
 colour_t make_high_colour(colour_t colour) IMMUTABLE;
 int  element_colour(int element, bool no_random = false,
                     const coord_def& loc = coord_def());
+// How many element colours that can change from one call to the next (all
+// but those fixed by location) have been worked out so far; output that
+// used one shouldn't be reused.
+unsigned int element_colour_evaluations();
 int get_disjunct_phase(const coord_def& loc);
 bool get_vortex_phase(const coord_def& loc);
 bool get_orb_phase(const coord_def& loc);
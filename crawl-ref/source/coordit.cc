@@ -87,22 +87,8 @@ void rectangle_iterator::operator++(int)
 random_rectangle_iterator::random_rectangle_iterator(const coord_def& corner1,
                                                      const coord_def& corner2)
 {
-    int left   = min(corner1.x, corner2.x);
-    int right  = max(corner1.x, corner2.x);
-    int top    = min(corner1.y, corner2.y);
-    int bottom = max(corner1.y, corner2.y);
-
-    top_left.x = left;
-    top_left.y = top;
-
-    for (int y = top; y <= bottom; y++)
-        for (int x = left; x <= right; x++)
-            remaining.emplace_back(x, y);
-
-    if (remaining.empty())
-        current = 0;
-    else
-        current = random2(remaining.size());
+    init(min(corner1.x, corner2.x), min(corner1.y, corner2.y),
+         max(corner1.x, corner2.x), max(corner1.y, corner2.y));
 }
 
 random_rectangle_iterator::random_rectangle_iterator(int x_border_dist,
@@ -111,51 +97,101 @@ random_rectangle_iterator::random_rectangle_iterator(int x_border_dist,
     if (y_border_dist < 0)
         y_border_dist = x_border_dist;
 
-    int right  = GXM - x_border_dist - 1;
-    int bottom = GYM - y_border_dist - 1;
-
-    top_left.x = x_border_dist;
-    top_left.y = y_border_dist;
+    init(x_border_dist, y_border_dist,
+         GXM - x_border_dist - 1, GYM - y_border_dist - 1);
+}
 
-    for (int y = y_border_dist; y <= bottom; y++)
-        for (int x = x_border_dist; x <= right; x++)
-            remaining.emplace_back(x, y);
+void random_rectangle_iterator::init(int left, int top, int right, int bottom)
+{
+    top_left.x = left;
+    top_left.y = top;
+    width = max(right - left + 1, 0);
+    count = width * max(bottom - top + 1, 0);
+    nmoved = 0;
 
-    if (remaining.empty())
-        current = 0;
+    if (count)
+    {
+        current = random2(count);
+        pos = cell_pos(current);
+    }
     else
-        current = random2(remaining.size());
+        current = 0;
+}
+
+int random_rectangle_iterator::cell_at(int slot) const
+{
+    for (int i = 0; i < nmoved; i++)
+        if (moved[i].first == slot)
+            return moved[i].second;
+    return slot;
+}
+
+coord_def random_rectangle_iterator::cell_pos(int cell) const
+{
+    return top_left + coord_def(cell % width, cell / width);
+}
+
+void random_rectangle_iterator::spill()
+{
+    remaining.reserve(count);
+    for (int slot = 0; slot < count; slot++)
+        remaining.push_back(cell_pos(cell_at(slot)));
 }
 
 random_rectangle_iterator::operator bool() const
 {
-    return !remaining.empty();
+    return count > 0;
 }
 
 coord_def random_rectangle_iterator::operator *() const
 {
-    if (remaining.empty())
-        return top_left;
-    else
-        return remaining[current];
+    return count ? pos : top_left;
 }
 
 const coord_def* random_rectangle_iterator::operator->() const
 {
-    if (remaining.empty())
-        return &top_left;
-    else
-        return &(remaining[current]);
+    return count ? &pos : &top_left;
 }
 
 void random_rectangle_iterator::operator ++()
 {
+    if (!count)
+        return;
+
+    if (remaining.empty() && nmoved == MAX_MOVED)
+        spill();
+
+    // Move the last cell into the slot just returned, and drop the last slot.
+    const int last = --count;
     if (!remaining.empty())
     {
         remaining[current] = remaining.back();
         remaining.pop_back();
-        if (!remaining.empty())
-            current = random2(remaining.size());
+    }
+    else
+    {
+        const int last_cell = cell_at(last);
+        int fill = -1;
+        for (int i = 0; i < nmoved; i++)
+        {
+            if (moved[i].first == last)
+                moved[i--] = moved[--nmoved];
+            else if (moved[i].first == current)
+                fill = i;
+        }
+        if (current != last)
+        {
+            if (fill < 0)
+                fill = nmoved++;
+            moved[fill] = make_pair(current, last_cell);
+        }
+    }
+
+    if (count)
+    {
+        current = random2(count);
+        pos = remaining.empty() ? cell_pos(cell_at(current))
+                                : remaining[current];
     }
 }
 
@@ -167,40 +203,83 @@ void random_rectangle_iterator::operator++(int)
 /*
  *  radius iterator
  */
+static int _radius_credit(int r, circle_type ctype)
+{
+    switch (ctype)
+    {
+    case C_CIRCLE: return r;
+    case C_POINTY: return r * r;
+    case C_ROUND:  return r * r + 1;
+    case C_SQUARE: return r;
+    }
+    return r;
+}
+
+/**
+ * The offsets a radius_iterator visits, in the order it visits them.
+ *
+ * This is by rows outwards from the centre, returning the four reflections
+ * of each offset in turn; things like explosions act in this order, so it
+ * mustn't change. The centre comes first, so excluding it skips one cell.
+ * Cells off the map are skipped while iterating, which leaves the order of
+ * the rest alone.
+ */
+static const vector<coord_def> &_radius_offsets(int credit, bool is_square)
+{
+    static map<int, vector<coord_def>> tables[2];
+
+    auto found = tables[is_square].find(credit);
+    if (found != tables[is_square].end())
+        return found->second;
+
+    vector<coord_def> &offsets = tables[is_square][credit];
+    const int base_cost = is_square ? 1 : -1;
+    const int inc_cost = is_square ? 0 : 2;
+
+    int y = 0;
+    int cost_y = base_cost;
+    int credit_y = credit;
+    do
+    {
+        int x = 0;
+        int cost_x = base_cost;
+        int credit_x = (is_square ? credit : credit_y);
+        do
+        {
+            offsets.emplace_back(x, y);
+            if (y)
+                offsets.emplace_back(x, -y);
+            if (x)
+                offsets.emplace_back(-x, y);
+            if (x && y)
+                offsets.emplace_back(-x, -y);
+            x++;
+            credit_x -= (cost_x += inc_cost);
+        } while (credit_x >= 0);
+
+        y++;
+        credit_y -= (cost_y += inc_cost);
+    } while (credit_y >= 0);
+
+    return offsets;
+}
+
 radius_iterator::radius_iterator(const coord_def _center, int r,
                                  circle_type ctype,
                                  bool _exclude_center)
-    : state(RI_START),
-      center(_center),
+    : center(_center),
       los(LOS_NONE)
 {
-    ASSERT(map_bounds(_center));
-    switch (ctype)
-    {
-    case C_CIRCLE: credit = r; break;
-    case C_POINTY: credit = r * r; break;
-    case C_ROUND:  credit = r * r + 1; break;
-    case C_SQUARE: credit = r; break;
-    }
-    is_square = (ctype == C_SQUARE);
-    ++(*this);
-    if (_exclude_center)
-        ++(*this);
+    init(_radius_credit(r, ctype), ctype == C_SQUARE, _exclude_center);
 }
 
 radius_iterator::radius_iterator(const coord_def _center,
                                  los_type _los,
                                  bool _exclude_center)
-    : state(RI_START),
-      center(_center),
+    : center(_center),
       los(_los)
 {
-    ASSERT(map_bounds(_center));
-    credit = get_los_radius();
-    is_square = true;
-    ++(*this);
-    if (_exclude_center)
-        ++(*this);
+    init(get_los_radius(), true, _exclude_center);
 }
 
 radius_iterator::radius_iterator(const coord_def _center,
@@ -208,27 +287,28 @@ radius_iterator::radius_iterator(const coord_def _center,
                                  circle_type ctype,
                                  los_type _los,
                                  bool _exclude_center)
-    : state(RI_START),
-      center(_center),
+    : center(_center),
       los(_los)
 {
-    ASSERT(map_bounds(_center));
-    switch (ctype)
-    {
-    case C_CIRCLE: credit = r; break;
-    case C_POINTY: credit = r * r; break;
-    case C_ROUND:  credit = r * r + 1; break;
-    case C_SQUARE: credit = r; break;
-    }
-    is_square = (ctype == C_SQUARE);
+    init(_radius_credit(r, ctype), ctype == C_SQUARE, _exclude_center);
+}
+
+void radius_iterator::init(int credit, bool is_square, bool exclude_center)
+{
+    ASSERT(map_bounds(center));
+    const vector<coord_def> &offsets = _radius_offsets(credit, is_square);
+    offset = offsets.data();
+    offsets_end = offset + offsets.size();
+    valid = true;
+
     ++(*this);
-    if (_exclude_center)
+    if (exclude_center)
         ++(*this);
 }
 
 radius_iterator::operator bool() const
 {
-    return state;
+    return valid;
 }
 
 coord_def radius_iterator::operator *() const
@@ -241,59 +321,18 @@ const coord_def* radius_iterator::operator->() const
     return &current;
 }
 
-#define coreturn(id) { state = id; return; case id:; }
-#define cobegin(id)  switch (state) { case id:
-#define coend(id)    coreturn(id); }
-#define ret_coord(dx, dy, id) do                                \
-    {                                                           \
-        current.x = center.x + (dx);                            \
-        current.y = center.y + (dy);                            \
-        if (!los || cell_see_cell(center, current, los))        \
-            coreturn(id);                                       \
-    } while (0)
-
 void radius_iterator::operator++()
 {
-    cobegin(RI_START);
-
-    base_cost = is_square ? 1 : -1;
-    inc_cost = is_square ? 0 : 2;
-
-    y = 0;
-    cost_y = base_cost;
-    credit_y = credit;
-
-    do
+    while (offset != offsets_end)
     {
-        x = 0;
-        cost_x = base_cost;
-        credit_x = (is_square ? credit : credit_y);
-
-        do
+        current = center + *offset++;
+        if (map_bounds(current)
+            && (!los || cell_see_cell(center, current, los)))
         {
-            if (x + center.x < GXM)
-            {
-                if (y + center.y < GYM)
-                    ret_coord( x,  y, RI_SE);
-                if (y && y <= center.y)
-                    ret_coord( x, -y, RI_NE);
-            }
-            if (x && x <= center.x)
-            {
-                if (y + center.y < GYM)
-                    ret_coord(-x,  y, RI_SW);
-                if (y && y <= center.y)
-                    ret_coord(-x, -y, RI_NW);
-            }
-            x++;
-            credit_x -= (cost_x += inc_cost);
-        } while (credit_x >= 0);
-
-        y++;
-        credit_y -= (cost_y += inc_cost);
-    } while (credit_y >= 0);
-
-    coend(RI_DONE);
+            return;
+        }
+    }
+    valid = false;
 }
 
 void radius_iterator::operator++(int)
@@ -33,6 +33,11 @@ private:
  *
  * When this iterator has returned all elements, it will just
  * return the top left corner forever.
+ *
+ * Most users stop after a few cells, so the cells still to visit are kept
+ * as the rectangle in row order with a few slots replaced, and only written
+ * out in full once it has gone further than that. Either way it picks the
+ * same cells with the same random numbers.
  */
 class random_rectangle_iterator : public iterator<forward_iterator_tag,
                                                   coord_def>
@@ -49,9 +54,23 @@ public:
     void operator ++ ();
     void operator ++ (int);
 private:
+    void init(int left, int top, int right, int bottom);
+    int cell_at(int slot) const;
+    coord_def cell_pos(int cell) const;
+    void spill();
+
     coord_def top_left;
+    int width;
+    int count;     // cells not yet returned
+    int current;   // the slot of the one being returned
+    coord_def pos; // and where it is
+
+    enum { MAX_MOVED = 16 };
+    // The slots (as slot, cell) that no longer hold their own cell.
+    pair<int, int> moved[MAX_MOVED];
+    int nmoved;
+    // Every remaining cell, once there were too many moves to track.
     vector<coord_def> remaining;
-    int current;
 };
 
 /**
@@ -80,11 +99,13 @@ public:
     void operator ++ (int);
 
 private:
-    enum costate { RI_DONE, RI_START, RI_SE, RI_NE, RI_SW, RI_NW };
-    int x, y, cost_x, cost_y, credit, credit_x, credit_y, base_cost, inc_cost;
-    bool is_square;
+    void init(int credit, bool is_square, bool exclude_center);
+
+    // The offsets left to try, from a table shared by all iterators of
+    // this shape.
+    const coord_def *offset, *offsets_end;
+    bool valid;
 
-    costate state;
     coord_def center;
     los_type los;
     coord_def current;    // storage for operator->
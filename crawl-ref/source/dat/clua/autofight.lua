@@ -221,12 +221,8 @@ local AF_REACHING = 1 -- target in range for a reaching attack + reaching availa
 local AF_MELEE = 2    -- target in melee range + melee attack available
 local AF_FIRE = 3     -- target in fire range + ranged attack available
 
-local function get_monster_info(dx,dy,no_move)
-  m = monster.get_monster_at(dx,dy)
+local function get_monster_info(m,dx,dy,no_move)
   name = m:name()
-  if not m then
-    return nil
-  end
   info = {}
   info.distance = (abs(dx) > abs(dy)) and -abs(dx) or -abs(dy)
   if have_ranged() then
@@ -284,12 +280,8 @@ local function compare_monster_info(m1, m2)
   return false
 end
 
-local function is_candidate_for_attack(x,y)
-  m = monster.get_monster_at(x, y)
-  --if m then crawl.mpr("Checking: (" .. x .. "," .. y .. ") " .. m:name()) end
-  if not m then
-    return false
-  end
+local function is_candidate_for_attack(m)
+  --crawl.mpr("Checking: (" .. m:x_pos() .. "," .. m:y_pos() .. ") " .. m:name())
   if m:name() == "butterfly"
       or m:name() == "orb of destruction" then
     return false
@@ -308,21 +300,33 @@ local function is_candidate_for_attack(x,y)
   return false
 end
 
+-- Orders monsters the way scanning the view column by column would find
+-- them, so that ties go to the same monster.
+local function scan_order(m1, m2)
+  local x1, x2 = m1:x_pos(), m2:x_pos()
+  return x1 < x2 or x1 == x2 and m1:y_pos() < m2:y_pos()
+end
+
 local function get_target(no_move)
   local los_radius = you.los()
   local x, y, bestx, besty, best_info, new_info
   bestx = 0
   besty = 0
   best_info = nil
-  for x = -los_radius,los_radius do
-    for y = -los_radius,los_radius do
-      if is_candidate_for_attack(x, y) then
-        new_info = get_monster_info(x, y, no_move)
-        if (not best_info) or compare_monster_info(new_info, best_info) then
-          bestx = x
-          besty = y
-          best_info = new_info
-        end
+  -- Only the cells with monsters on them matter, so ask for just those
+  -- rather than looking at every cell in view.
+  local mons = monster.get_monsters()
+  table.sort(mons, scan_order)
+  for _, m in ipairs(mons) do
+    x = m:x_pos()
+    y = m:y_pos()
+    if abs(x) <= los_radius and abs(y) <= los_radius
+       and is_candidate_for_attack(m) then
+      new_info = get_monster_info(m, x, y, no_move)
+      if (not best_info) or compare_monster_info(new_info, best_info) then
+        bestx = x
+        besty = y
+        best_info = new_info
       end
     end
   end
@@ -4,8 +4,14 @@
 -- Compiles and loads .des files that Crawl needs.
 ------------------------------------------------------------------------------
 
-local des_files = file.datadir_files_recursive("dat/des", ".des")
+local des_files = { }
+for _, file in ipairs(file.datadir_files_recursive("dat/des", ".des")) do
+  table.insert(des_files, "des/" .. file)
+end
+
+-- Rebuild any stale caches up front, several at a time where we can.
+dgn.build_des_caches(des_files)
 
 for _, file in ipairs(des_files) do
-  dgn.load_des_file("des/" .. file)
+  dgn.load_des_file(file)
 end
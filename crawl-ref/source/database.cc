@@ -8,7 +8,9 @@
 #include "database.h"
 
 #include <cstdlib>
+#include <cstring>
 #include <fcntl.h>
+#include <unordered_map>
 #include <sys/stat.h>
 #include <sys/types.h>
 #if defined(UNIX) || defined(TARGET_COMPILER_MINGW)
@@ -23,38 +25,96 @@
 #include "random.h"
 #include "stringutil.h"
 #include "syscalls.h"
+#include "threads.h"
 #include "unicode.h"
 
 // TextDB handles dependency checking the db vs text files, creating the
-// db, loading, and destroying the DB.
+// db, loading, and destroying the DB. Stale dbs are rebuilt in a thread
+// each; anything that needs one first waits for it to finish.
 class TextDB
 {
 public:
     // db_name is the savedir-relative name of the db file,
-    // minus the "db" extension.
-    TextDB(const char* db_name, const char* dir, vector<string> files);
+    // minus the "db" extension. A preloaded db is read into memory whole
+    // when opened; the rest keep their recently used entries.
+    TextDB(const char* db_name, const char* dir, vector<string> files,
+           bool preload = false);
     TextDB(TextDB *parent);
     ~TextDB() { shutdown(true); delete translation; }
-    void init();
+    void init(bool load_all = false);
     void shutdown(bool recursive = false);
-    DBM* get() { return _db; }
+    DBM* get() { _finish_regenerating(); return _db; }
+    bool fetch(const string &key, string &result);
 
     // Make it easier to migrate from raw DBM* to TextDB
-    operator bool() const { return _db != 0; }
-    operator DBM*() const { return _db; }
+    operator bool() { return get() != 0; }
+    operator DBM*() { return get(); }
+
+    // Every entry but the internal "__" ones, for searching; read in on the
+    // first search. The folded copies are lowercased (ASCII only, as the
+    // case-insensitive patterns are) so that plain words can be looked for
+    // without a regex.
+    struct search_entry
+    {
+        string key;
+        string body;
+        string folded_key;
+        string folded_body;
+    };
+    const vector<search_entry> &search_entries();
 
  private:
     bool _needs_update() const;
     void _regenerate_db();
+    static void *_regenerate_worker(void *textdb);
+    void _write_db();
+    void _finish_regenerating();
 
  private:
     bool open_db();
+    void _reset_cache();
+    void _load_all();
+    bool _open_image();
+    void _write_image();
+    bool _image_fetch(const string &key, string &result) const;
+    void _cache(const string &key, bool found, const string &body);
     const char* const _db_name;
     string _directory;
     vector<string> _input_files;
     DBM* _db;
     string timestamp;
     TextDB *_parent;
+
+    // Looked-up entries, kept across shutdown() so that games forked after
+    // init_static_game_data() share them; dropped if the db changes. A
+    // preloaded db is only read in on the first lookup, as most of them
+    // aren't wanted until a game is under way.
+    const bool _preload;
+    string _cache_timestamp;
+    bool _all_loaded;
+    unordered_map<string, string> _all;
+    // A loaded preloaded db, as a file mapped read-only and shared by all
+    // the games on a server; _all stays empty while this is there.
+    const char *_image;
+    size_t _image_size;
+    struct cached_entry
+    {
+        string key;
+        bool found;
+        string body;
+    };
+    list<cached_entry> _recent; // most recently used first
+    unordered_map<string, list<cached_entry>::iterator> _recent_index;
+    bool _search_loaded;
+    vector<search_entry> _search;
+
+    // Set while a worker is writing the db.
+    bool _regenerating;
+    thread_t _regen_thread;
+    file_lock *_regen_lock;
+    vector<string> _regen_inputs;
+    string _regen_timestamp;
+    string _regen_error;
     const char* lang() { return _parent ? Options.lang_name : 0; }
 public:
     TextDB *translation;
@@ -62,11 +122,12 @@ public:
 
 // Convenience functions for (read-only) access to generic
 // berkeley DB databases.
-static void _store_text_db(const string &in, DBM *db);
+static bool _store_text_db(const string &in, DBM *db);
+static datum _database_fetch(DBM *database, const string &key);
 
 static string _query_database(TextDB &db, string key, bool canonicalise_key,
                               bool run_lua, bool untranslated = false);
-static void _add_entry(DBM *db, const string &k, string &v);
+static bool _add_entry(DBM *db, const string &k, string &v);
 
 static TextDB AllDBs[] =
 {
@@ -108,18 +169,18 @@ static TextDB AllDBs[] =
             "wpnnoise.txt", // noisy weapon speech
             "insult.txt",   // imp/demon taunts
             "godspeak.txt"  // god speech
-            }),
+            }, true),
 
     TextDB("shout", "database/",
           { "shout.txt",
             "insult.txt"    // imp/demon taunts, again
-            }),
+            }, true),
 
     TextDB("misc", "database/",
           { "miscname.txt", // names for miscellaneous things
             "godname.txt",  // god-related names (mostly His Xomminess)
             "montitle.txt", // titles for monsters (i.e. uniques)
-            }),
+            }, true),
 
     TextDB("quotes", "descript/",
           { "quotes.txt"    // quotes for items and monsters
@@ -161,9 +222,18 @@ static string _db_cache_path(string db, const char *lang)
 // TextDB
 // ----------------------------------------------------------------------
 
-TextDB::TextDB(const char* db_name, const char* dir, vector<string> files)
+// Entries kept by each db that isn't preloaded. Lookups repeat a lot (the
+// same monster's speech and description, misses on suffixed keys), but are
+// spread over far more keys than it's worth keeping.
+#define RECENT_ENTRIES 256
+
+TextDB::TextDB(const char* db_name, const char* dir, vector<string> files,
+               bool preload)
     : _db_name(db_name), _directory(dir), _input_files(files),
-      _db(nullptr), timestamp(""), _parent(0), translation(0)
+      _db(nullptr), timestamp(""), _parent(0), _preload(preload),
+      _all_loaded(false), _image(nullptr), _image_size(0),
+      _search_loaded(false), _regenerating(false),
+      _regen_lock(nullptr), translation(0)
 {
 }
 
@@ -171,7 +241,10 @@ TextDB::TextDB(TextDB *parent)
     : _db_name(parent->_db_name),
       _directory(parent->_directory + Options.lang_name + "/"),
       _input_files(parent->_input_files), // FIXME: pointless copy
-      _db(nullptr), timestamp(""), _parent(parent), translation(nullptr)
+      _db(nullptr), timestamp(""), _parent(parent),
+      _preload(parent->_preload), _all_loaded(false), _image(nullptr),
+      _image_size(0), _search_loaded(false),
+      _regenerating(false), _regen_lock(nullptr), translation(nullptr)
 {
 }
 
@@ -185,36 +258,305 @@ bool TextDB::open_db()
     if (!_db)
         return false;
 
-    timestamp = _query_database(*this, "TIMESTAMP", false, false, true);
+    datum ts = _database_fetch(_db, "TIMESTAMP");
+    timestamp = string((const char *)ts.dptr, ts.dsize);
     if (timestamp.empty())
         return false;
 
+    if (timestamp != _cache_timestamp)
+        _reset_cache();
+
     return true;
 }
 
-void TextDB::init()
+void TextDB::_reset_cache()
 {
-    if (Options.lang_name && !_parent)
+    _all.clear();
+    _all_loaded = false;
+    unmap_file(_image, _image_size);
+    _image = nullptr;
+    _image_size = 0;
+    _recent.clear();
+    _recent_index.clear();
+    _search.clear();
+    _search_loaded = false;
+    _cache_timestamp = timestamp;
+}
+
+void TextDB::_load_all()
+{
+    _all_loaded = true;
+    if (_open_image())
+        return;
+
+    for (datum key = dbm_firstkey(_db); key.dptr; key = dbm_nextkey(_db))
     {
-        translation = new TextDB(this);
-        translation->init();
+        datum body = dbm_fetch(_db, key);
+        _all[string((const char *)key.dptr, key.dsize)]
+            = string((const char *)body.dptr, body.dsize);
     }
 
-    open_db();
+    // Leave an image for the next game, and use it ourselves if we can.
+    _write_image();
+    if (_open_image())
+        _all.clear();
+}
+
+// The image of a preloaded db: a header, then its entries sorted by key,
+// then the text they point into. Offsets are from the start of the file;
+// it's only ever read on the machine that wrote it.
+#define DB_IMAGE_MAGIC "CRAWLDBI"
+#define DB_IMAGE_VERSION 1
 
-    if (!_needs_update())
+struct db_image_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t entries;
+    uint32_t timestamp_len;
+};
+
+struct db_image_entry
+{
+    uint32_t key_off, key_len;
+    uint32_t body_off, body_len;
+};
+
+static size_t _image_entries_offset(size_t timestamp_len)
+{
+    const size_t align = alignof(db_image_entry);
+    return (sizeof(db_image_header) + timestamp_len + align - 1) / align
+           * align;
+}
+
+static string _db_image_path(const char *db_name, const char *lang)
+{
+    return _db_cache_path(db_name, lang) + ".img";
+}
+
+void TextDB::_write_image()
+{
+    vector<const pair<const string, string> *> entries;
+    for (const auto &entry : _all)
+        entries.push_back(&entry);
+    sort(entries.begin(), entries.end(),
+         [](const pair<const string, string> *a,
+            const pair<const string, string> *b)
+         {
+             return a->first < b->first;
+         });
+
+    db_image_header header;
+    memcpy(header.magic, DB_IMAGE_MAGIC, sizeof(header.magic));
+    header.version = DB_IMAGE_VERSION;
+    header.entries = entries.size();
+    header.timestamp_len = timestamp.size();
+
+    const size_t table = _image_entries_offset(timestamp.size());
+    size_t text = table + entries.size() * sizeof(db_image_entry);
+    vector<db_image_entry> index;
+    for (const auto *entry : entries)
+    {
+        db_image_entry e;
+        e.key_off = text;
+        e.key_len = entry->first.size();
+        e.body_off = e.key_off + e.key_len;
+        e.body_len = entry->second.size();
+        text = e.body_off + e.body_len;
+        index.push_back(e);
+    }
+    // The offsets have to fit.
+    if (text > UINT32_MAX)
         return;
-    _regenerate_db();
 
-    if (!open_db())
+    const string file = _db_image_path(_db_name, lang());
+    file_lock lock(file + ".lk", "wb", false);
+    FILE *fp = fopen_replace(file.c_str());
+    if (!fp)
+        return;
+
+    const char padding[alignof(db_image_entry)] = {};
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1
+              && fwrite(timestamp.data(), 1, timestamp.size(), fp)
+                 == timestamp.size()
+              && fwrite(padding, 1, table - sizeof(header) - timestamp.size(),
+                        fp) == table - sizeof(header) - timestamp.size()
+              && (index.empty()
+                  || fwrite(index.data(), sizeof(db_image_entry), index.size(),
+                            fp) == index.size());
+    for (const auto *entry : entries)
     {
-        end(1, true, "Failed to open DB: %s",
-            _db_cache_path(_db_name, lang()).c_str());
+        ok = ok && fwrite(entry->first.data(), 1, entry->first.size(), fp)
+                   == entry->first.size()
+                && fwrite(entry->second.data(), 1, entry->second.size(), fp)
+                   == entry->second.size();
+    }
+    ok = !fclose(fp) && ok;
+    if (!ok)
+        unlink_u(file.c_str());
+}
+
+// Map the image in, if there's one of this version of the db.
+bool TextDB::_open_image()
+{
+    const string file = _db_image_path(_db_name, lang());
+    file_lock lock(file + ".lk", "rb", false);
+
+    size_t size = 0;
+    const char *data = (const char *)map_file_u(file.c_str(), size);
+    if (!data)
+        return false;
+
+    bool ok = size >= sizeof(db_image_header);
+    db_image_header header;
+    if (ok)
+    {
+        memcpy(&header, data, sizeof(header));
+        ok = !memcmp(header.magic, DB_IMAGE_MAGIC, sizeof(header.magic))
+             && header.version == DB_IMAGE_VERSION
+             && header.timestamp_len == timestamp.size()
+             && size >= _image_entries_offset(header.timestamp_len)
+             && !memcmp(data + sizeof(header), timestamp.data(),
+                        timestamp.size());
+    }
+
+    const size_t table = ok ? _image_entries_offset(header.timestamp_len) : 0;
+    ok = ok && (size - table) / sizeof(db_image_entry) >= header.entries;
+    const db_image_entry *entries = (const db_image_entry *)(data + table);
+    for (uint32_t i = 0; ok && i < header.entries; ++i)
+    {
+        const db_image_entry &e = entries[i];
+        ok = e.key_off <= size && e.key_len <= size - e.key_off
+             && e.body_off <= size && e.body_len <= size - e.body_off;
+    }
+
+    if (!ok)
+    {
+        unmap_file(data, size);
+        return false;
+    }
+    _image = data;
+    _image_size = size;
+    return true;
+}
+
+bool TextDB::_image_fetch(const string &key, string &result) const
+{
+    db_image_header header;
+    memcpy(&header, _image, sizeof(header));
+    const db_image_entry *entries = (const db_image_entry *)
+        (_image + _image_entries_offset(header.timestamp_len));
+
+    const db_image_entry *entry = lower_bound(entries,
+                                              entries + header.entries, key,
+        [this](const db_image_entry &e, const string &k)
+        {
+            return k.compare(0, string::npos, _image + e.key_off,
+                             e.key_len) > 0;
+        });
+    if (entry == entries + header.entries
+        || key.compare(0, string::npos, _image + entry->key_off,
+                       entry->key_len))
+    {
+        return false;
+    }
+    result.assign(_image + entry->body_off, entry->body_len);
+    return true;
+}
+
+static string _fold_ascii(const string &s)
+{
+    string folded = s;
+    for (char &c : folded)
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+    return folded;
+}
+
+const vector<TextDB::search_entry> &TextDB::search_entries()
+{
+    if (_search_loaded || !get())
+        return _search;
+
+    for (datum key = dbm_firstkey(_db); key.dptr; key = dbm_nextkey(_db))
+    {
+        string k((const char *)key.dptr, key.dsize);
+        if (k.find("__") != string::npos)
+            continue;
+        datum body = dbm_fetch(_db, key);
+        string b((const char *)body.dptr, body.dsize);
+        const string fk = _fold_ascii(k), fb = _fold_ascii(b);
+        _search.push_back({ move(k), move(b), fk, fb });
+    }
+    _search_loaded = true;
+    return _search;
+}
+
+void TextDB::_cache(const string &key, bool found, const string &body)
+{
+    _recent.push_front({ key, found, body });
+    _recent_index[key] = _recent.begin();
+    if (_recent.size() > RECENT_ENTRIES)
+    {
+        _recent_index.erase(_recent.back().key);
+        _recent.pop_back();
+    }
+}
+
+// Look up an entry, setting result; false if it's missing or empty.
+bool TextDB::fetch(const string &key, string &result)
+{
+    if (!get())
+        return false;
+
+    if (_preload)
+    {
+        if (!_all_loaded)
+            _load_all();
+        if (_image)
+            return _image_fetch(key, result) && !result.empty();
+        auto entry = _all.find(key);
+        if (entry == _all.end())
+            return false;
+        result = entry->second;
+        return !result.empty();
+    }
+
+    auto recent = _recent_index.find(key);
+    if (recent != _recent_index.end())
+    {
+        _recent.splice(_recent.begin(), _recent, recent->second);
+        result = recent->second->body;
+        return recent->second->found;
+    }
+
+    datum entry = _database_fetch(_db, key);
+    const bool found = entry.dsize > 0;
+    result = found ? string((const char *)entry.dptr, entry.dsize) : "";
+    _cache(key, found, result);
+    return found;
+}
+
+void TextDB::init(bool load_all)
+{
+    if (Options.lang_name && !_parent)
+    {
+        translation = new TextDB(this);
+        translation->init(load_all);
     }
+
+    open_db();
+
+    if (_needs_update())
+        _regenerate_db();
+
+    if (load_all && _preload && !_all_loaded && get())
+        _load_all();
 }
 
 void TextDB::shutdown(bool recursive)
 {
+    _finish_regenerating();
     if (_db)
     {
         dbm_close(_db);
@@ -290,14 +632,19 @@ void TextDB::_regenerate_db()
             end(1, false, "Cannot create db directory '%s'.", output_dir.c_str());
     }
 
-    file_lock lock(db_path + ".lk", "wb");
+    // Everything that can end() happens here, on the main thread; the
+    // worker only parses the files into the db.
+    _regen_lock = new file_lock(db_path + ".lk", "wb");
 #ifndef DGL_REWRITE_PROTECT_DB_FILES
     unlink_u(full_db_path.c_str());
 #endif
 
-    string ts;
     if (!(_db = dbm_open(db_path.c_str(), O_RDWR | O_CREAT, 0660)))
         end(1, true, "Unable to open DB: %s", db_path.c_str());
+
+    _regen_inputs.clear();
+    _regen_timestamp.clear();
+    _regen_error.clear();
     for (const string &file : _input_files)
     {
         string full_input_path = _directory + file;
@@ -308,26 +655,81 @@ void TextDB::_regenerate_db()
             || !_parent) // english is mandatory
         {
             snprintf(buf, sizeof(buf), ":%" PRId64, (int64_t)mtime);
-            ts += buf;
-            _store_text_db(full_input_path, _db);
+            _regen_timestamp += buf;
+            _regen_inputs.push_back(full_input_path);
         }
     }
-    _add_entry(_db, "TIMESTAMP", ts);
 
+    _regenerating = true;
+    if (thread_create_joinable(&_regen_thread, _regenerate_worker, this))
+    {
+        // No thread to be had; do it ourselves.
+        _write_db();
+        _regenerating = false;
+        _finish_regenerating();
+    }
+}
+
+void *TextDB::_regenerate_worker(void *textdb)
+{
+    static_cast<TextDB *>(textdb)->_write_db();
+    return nullptr;
+}
+
+// Runs on the worker: fill in the db opened by _regenerate_db(), and close
+// it. Errors are left in _regen_error for the main thread.
+void TextDB::_write_db()
+{
+    for (const string &input : _regen_inputs)
+    {
+        if (!_store_text_db(input, _db))
+        {
+            _regen_error = "Unable to store " + input;
+            break;
+        }
+    }
+    if (_regen_error.empty() && !_add_entry(_db, "TIMESTAMP", _regen_timestamp))
+        _regen_error = "Error storing TIMESTAMP";
+
+    // This commits everything stored, as one transaction.
     dbm_close(_db);
     _db = 0;
 }
 
+void TextDB::_finish_regenerating()
+{
+    if (_regenerating)
+    {
+        thread_join(_regen_thread);
+        _regenerating = false;
+    }
+    if (!_regen_lock)
+        return;
+    delete _regen_lock;
+    _regen_lock = nullptr;
+
+    if (!_regen_error.empty())
+    {
+        end(1, false, "%s: %s", _db_cache_path(_db_name, lang()).c_str(),
+            _regen_error.c_str());
+    }
+    if (!open_db())
+    {
+        end(1, true, "Failed to open DB: %s",
+            _db_cache_path(_db_name, lang()).c_str());
+    }
+}
+
 // ----------------------------------------------------------------------
 // DB system
 // ----------------------------------------------------------------------
 
 #define NUM_DB ARRAYSZ(AllDBs)
 
-void databaseSystemInit()
+void databaseSystemInit(bool load_all)
 {
     for (unsigned int i = 0; i < NUM_DB; i++)
-        AllDBs[i].init();
+        AllDBs[i].init(load_all);
 }
 
 void databaseSystemShutdown()
@@ -356,61 +758,55 @@ static datum _database_fetch(DBM *database, const string &key)
     return result;
 }
 
-static vector<string> _database_find_keys(DBM *database,
-                                          const string &regex,
-                                          bool ignore_case,
-                                          db_find_filter filter = nullptr)
+// A pattern with nothing special in it can be matched by looking for it in
+// the folded text. Non-ASCII is left to the regex, which may fold it
+// differently.
+static bool _is_plain_word(const string &regex)
 {
-    text_pattern             tpat(regex, ignore_case);
-    vector<string> matches;
+    for (const char c : regex)
+        if (strchr("\\^$.|?*+()[]{}", c) || (unsigned char) c >= 0x80)
+            return false;
+    return !regex.empty();
+}
 
-    datum dbKey = dbm_firstkey(database);
+static vector<string> _database_find(TextDB &db, const string &regex,
+                                     bool ignore_case, bool in_bodies,
+                                     db_find_filter filter)
+{
+    text_pattern tpat(regex, ignore_case);
+    const bool plain = ignore_case && _is_plain_word(regex);
+    const string needle = _fold_ascii(regex);
+    vector<string> matches;
 
-    while (dbKey.dptr != nullptr)
+    for (const auto &entry : db.search_entries())
     {
-        string key((const char *)dbKey.dptr, dbKey.dsize);
-
-        if (tpat.matches(key)
-            && key.find("__") == string::npos
-            && (filter == nullptr || !(*filter)(key, "")))
+        const string &text = in_bodies ? entry.body : entry.key;
+        const bool found = plain
+            ? (in_bodies ? entry.folded_body
+                         : entry.folded_key).find(needle) != string::npos
+            : tpat.matches(text);
+        if (found && (filter == nullptr
+                      || !(*filter)(entry.key, in_bodies ? entry.body : "")))
         {
-            matches.push_back(key);
+            matches.push_back(entry.key);
         }
-
-        dbKey = dbm_nextkey(database);
     }
 
     return matches;
 }
 
-static vector<string> _database_find_bodies(DBM *database,
-                                            const string &regex,
+static vector<string> _database_find_keys(TextDB &db, const string &regex,
+                                          bool ignore_case,
+                                          db_find_filter filter = nullptr)
+{
+    return _database_find(db, regex, ignore_case, false, filter);
+}
+
+static vector<string> _database_find_bodies(TextDB &db, const string &regex,
                                             bool ignore_case,
                                             db_find_filter filter = nullptr)
 {
-    text_pattern             tpat(regex, ignore_case);
-    vector<string> matches;
-
-    datum dbKey = dbm_firstkey(database);
-
-    while (dbKey.dptr != nullptr)
-    {
-        string key((const char *)dbKey.dptr, dbKey.dsize);
-
-        datum dbBody = dbm_fetch(database, dbKey);
-        string body((const char *)dbBody.dptr, dbBody.dsize);
-
-        if (tpat.matches(body)
-            && key.find("__") == string::npos
-            && (filter == nullptr || !(*filter)(key, body)))
-        {
-            matches.push_back(key);
-        }
-
-        dbKey = dbm_nextkey(database);
-    }
-
-    return matches;
+    return _database_find(db, regex, ignore_case, true, filter);
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -479,7 +875,7 @@ static void _trim_leading_newlines(string &s)
     s.erase(0, s.find_first_not_of("\n"));
 }
 
-static void _add_entry(DBM *db, const string &k, string &v)
+static bool _add_entry(DBM *db, const string &k, string &v)
 {
     _trim_leading_newlines(v);
     datum key, value;
@@ -489,11 +885,10 @@ static void _add_entry(DBM *db, const string &k, string &v)
     value.dptr = (char *) v.c_str();
     value.dsize = v.length();
 
-    if (dbm_store(db, key, value, DBM_REPLACE))
-        end(1, true, "Error storing %s", k.c_str());
+    return !dbm_store(db, key, value, DBM_REPLACE);
 }
 
-static void _parse_text_db(LineInput &inf, DBM *db)
+static bool _parse_text_db(LineInput &inf, DBM *db)
 {
     string key;
     string value;
@@ -508,8 +903,8 @@ static void _parse_text_db(LineInput &inf, DBM *db)
 
         if (!line.compare(0, 4, "%%%%"))
         {
-            if (!key.empty())
-                _add_entry(db, key, value);
+            if (!key.empty() && !_add_entry(db, key, value))
+                return false;
             key.clear();
             value.clear();
             in_entry = true;
@@ -532,27 +927,31 @@ static void _parse_text_db(LineInput &inf, DBM *db)
         }
     }
 
-    if (!key.empty())
-        _add_entry(db, key, value);
+    return key.empty() || _add_entry(db, key, value);
 }
 
-static void _store_text_db(const string &in, DBM *db)
+static bool _store_text_db(const string &in, DBM *db)
 {
     UTF8FileLineInput inf(in.c_str());
-    if (inf.error())
-        end(1, true, "Unable to open input file: %s", in.c_str());
-
-    _parse_text_db(inf, db);
+    return !inf.error() && _parse_text_db(inf, db);
 }
 
-static string _chooseStrByWeight(const string &entry, int fixed_weight = -1)
+// An entry split up into its choices, with the running total of their
+// weights; or, if it can't be, what to say instead.
+struct weighted_choices
 {
     vector<string> parts;
     vector<int>    weights;
+    int            total_weight = 0;
+    string         error;
+};
+
+static weighted_choices _parse_weighted(const string &entry)
+{
+    weighted_choices choices;
 
     vector<string> lines = split_string("\n", entry, false, true);
 
-    int total_weight = 0;
     for (int i = 0, size = lines.size(); i < size; i++)
     {
         // Skip over multiple blank lines, and leading and trailing
@@ -570,12 +969,15 @@ static string _chooseStrByWeight(const string &entry, int fixed_weight = -1)
         {
             i++;
             if (i == size)
-                return "BUG, WEIGHT AT END OF ENTRY";
+            {
+                choices.error = "BUG, WEIGHT AT END OF ENTRY";
+                return choices;
+            }
         }
         else
             weight = 10;
 
-        total_weight += weight;
+        choices.total_weight += weight;
 
         while (i < size && !lines[i].empty())
         {
@@ -584,22 +986,47 @@ static string _chooseStrByWeight(const string &entry, int fixed_weight = -1)
         }
         trim_string(part);
 
-        parts.push_back(part);
-        weights.push_back(total_weight);
+        choices.parts.push_back(part);
+        choices.weights.push_back(choices.total_weight);
     }
 
-    if (parts.empty())
-        return "BUG, EMPTY ENTRY";
+    if (choices.parts.empty())
+        choices.error = "BUG, EMPTY ENTRY";
+    return choices;
+}
+
+// Entries get picked from over and over (randart names try up to a
+// hundred times for one that fits), so keep them parsed. They're found by
+// their text, so a changed db can't leave stale ones behind.
+static const weighted_choices &_weighted_choices(const string &entry)
+{
+    static unordered_map<string, weighted_choices> parsed;
+
+    auto it = parsed.find(entry);
+    if (it != parsed.end())
+        return it->second;
+
+    // Plenty for the randart names and the speech most recently used.
+    if (parsed.size() >= 4096)
+        parsed.clear();
+    return parsed.emplace(entry, _parse_weighted(entry)).first->second;
+}
+
+static string _chooseStrByWeight(const string &entry, int fixed_weight = -1)
+{
+    const weighted_choices &choices = _weighted_choices(entry);
+    if (!choices.error.empty())
+        return choices.error;
 
     int choice = 0;
     if (fixed_weight != -1)
-        choice = fixed_weight % total_weight;
+        choice = fixed_weight % choices.total_weight;
     else
-        choice = random2(total_weight);
+        choice = random2(choices.total_weight);
 
-    for (int i = 0, size = parts.size(); i < size; i++)
-        if (choice < weights[i])
-            return parts[i];
+    for (int i = 0, size = choices.parts.size(); i < size; i++)
+        if (choice < choices.weights[i])
+            return choices.parts[i];
 
     return "BUG, NO STRING CHOSEN";
 }
@@ -616,32 +1043,23 @@ static string _getWeightedString(TextDB &db, const string &key,
     lowercase(canonical_key);
 
     // Query the DB.
-    datum result;
-
-    if (db.translation)
-        result = _database_fetch(db.translation->get(), canonical_key);
-    if (result.dsize <= 0)
-        result = _database_fetch(db.get(), canonical_key);
+    string str;
 
-    if (result.dsize <= 0)
+    if (!(db.translation && db.translation->fetch(canonical_key, str))
+        && !db.fetch(canonical_key, str))
     {
         // Try ignoring the suffix.
         canonical_key = key;
         lowercase(canonical_key);
 
         // Query the DB.
-        if (db.translation)
-            result = _database_fetch(db.translation->get(), canonical_key);
-        if (result.dsize <= 0)
-            result = _database_fetch(db.get(), canonical_key);
-
-        if (result.dsize <= 0)
+        if (!(db.translation && db.translation->fetch(canonical_key, str))
+            && !db.fetch(canonical_key, str))
+        {
             return "";
+        }
     }
 
-    // Cons up a (C++) string to return. The caller must release it.
-    string str = string((const char *)result.dptr, result.dsize);
-
     return _chooseStrByWeight(str, fixed_weight);
 }
 
@@ -730,17 +1148,13 @@ static string _query_database(TextDB &db, string key, bool canonicalise_key,
     }
 
     // Query the DB.
-    datum result;
-
-    if (db.translation && !untranslated)
-        result = _database_fetch(db.translation->get(), key);
-    if (result.dsize <= 0)
-        result = _database_fetch(db.get(), key);
+    string str;
 
-    if (result.dsize <= 0)
+    if (!(db.translation && !untranslated && db.translation->fetch(key, str))
+        && !db.fetch(key, str))
+    {
         return "";
-
-    string str((const char *)result.dptr, result.dsize);
+    }
 
     // <foo> is an alias to key foo
     if (str[0] == '<' && str[str.size() - 2] == '>'
@@ -786,7 +1200,7 @@ vector<string> getLongDescKeysByRegex(const string &regex,
 
     // FIXME: need to match regex against translated keys, which can't
     // be done by db only.
-    return _database_find_keys(DescriptionDB.get(), regex, true, filter);
+    return _database_find_keys(DescriptionDB, regex, true, filter);
 }
 
 vector<string> getLongDescBodiesByRegex(const string &regex,
@@ -802,9 +1216,9 @@ vector<string> getLongDescBodiesByRegex(const string &regex,
     // Not good, but otherwise we'd have to check hundreds of keys, with
     // two queries for each.
     // SQL can do this in one go, DBM can't.
-    DBM *database = DescriptionDB.translation ?
-        DescriptionDB.translation->get() : DescriptionDB.get();
-    return _database_find_bodies(database, regex, true, filter);
+    TextDB &db = DescriptionDB.translation ? *DescriptionDB.translation
+                                           : DescriptionDB;
+    return _database_find_bodies(db, regex, true, filter);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -868,7 +1282,7 @@ vector<string> getAllFAQKeys()
         return empty;
     }
 
-    return _database_find_keys(FAQDB.get(), "^q.+", false);
+    return _database_find_keys(FAQDB, "^q.+", false);
 }
 
 string getFAQ_Question(const string &key)
@@ -27,7 +27,9 @@ extern "C" {
 
 #define DPTR_COERCE char *
 
-void databaseSystemInit();
+// load_all reads the preloaded databases in now rather than on first use,
+// for a zygote to share with its games.
+void databaseSystemInit(bool load_all = false);
 void databaseSystemShutdown();
 
 typedef bool (*db_find_filter)(string key, string body);
@@ -773,6 +773,7 @@ void do_crash_dump()
     set_msg_dump_file(nullptr);
 
     mark_milestone("crash", cause_msg, "", t);
+    flush_milestones(true);
 
     if (file != stderr)
         fclose(file);
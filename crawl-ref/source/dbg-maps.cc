@@ -7,22 +7,42 @@
 
 #include "dbg-maps.h"
 
+#include <chrono>
+#include <cinttypes>
+
+#ifdef UNIX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "act-iter.h"
+#include "artefact.h"
 #include "branch.h"
 #include "chardump.h"
 #include "crash.h"
 #include "dbg-objstat.h"
+#include "dbg-util.h"
 #include "dungeon.h"
 #include "env.h"
+#include "files.h"
 #include "initfile.h"
+#include "json.h"
+#include "json-wrapper.h"
 #include "libutil.h"
+#include "los.h"
 #include "maps.h"
 #include "message.h"
+#include "mon-util.h"
 #include "ng-init.h"
+#include "ng-setup.h"
 #include "player.h"
+#include "random.h"
 #include "shopping.h"
 #include "state.h"
 #include "stringutil.h"
+#include "syscalls.h"
 #include "tag-version.h"
+#include "tileview.h"
 #include "view.h"
 
 #ifdef DEBUG_STATISTICS
@@ -46,6 +66,14 @@ static int levels_tried = 0, levels_failed = 0;
 static int build_attempts = 0, level_vetoes = 0;
 // Map from message to counts.
 static map<string, int> veto_messages;
+// And from the part of the build that vetoed (see dungeon.cc) to counts.
+static map<string, int> veto_stages;
+// Map name to its Lua's calls into C, and the number of times it was run.
+static map<string, pair<int, int> > lua_calls;
+// And to the microseconds its Lua took, over all those runs.
+static map<string, int64_t> lua_usec;
+// Level to the microseconds spent building it, and how many builds that was.
+static map<level_id, pair<int64_t, int> > level_build_usec;
 
 void mapstat_report_map_build_start()
 {
@@ -53,10 +81,11 @@ void mapstat_report_map_build_start()
     map_builds[level_id::current()].first++;
 }
 
-void mapstat_report_map_veto(const string &message)
+void mapstat_report_map_veto(const string &message, const string &stage)
 {
     level_vetoes++;
     ++veto_messages[message];
+    ++veto_stages[stage];
     map_builds[level_id::current()].second++;
 }
 
@@ -93,7 +122,13 @@ static bool _do_build_level()
     }
 
     ++levels_tried;
-    if (!builder())
+    const auto build_start = chrono::steady_clock::now();
+    const bool built = builder();
+    pair<int64_t, int> &build_time = level_build_usec[level_id::current()];
+    build_time.first += chrono::duration_cast<chrono::microseconds>(
+                            chrono::steady_clock::now() - build_start).count();
+    build_time.second++;
+    if (!built)
     {
         ++levels_failed;
         // Abort level build failure in objstat since the statistics will be
@@ -243,24 +278,28 @@ static bool _build_dungeon()
  * builder() fails, as the level may be in an invalid state and any object
  * statistics erroneous.
 */
-bool mapstat_build_levels()
+static bool _build_iterations(int iters, bool progress)
 {
-    if (!generated_levels.size())
-        _dungeon_places();
-    printf("Iteration: ");
-    fflush(stdout);
-    for (int i = 0; i < SysEnv.map_gen_iters; ++i)
+    if (progress)
+    {
+        printf("Iteration: ");
+        fflush(stdout);
+    }
+    for (int i = 0; i < iters; ++i)
     {
         clear_messages();
         mprf("On %d of %d; %d g, %d fail, %u err%s, %u uniq, "
              "%d try, %d (%.2f%%) vetoes",
-             i, SysEnv.map_gen_iters, levels_tried, levels_failed,
+             i, iters, levels_tried, levels_failed,
              (unsigned int)errors.size(),
              last_error.empty() ? "" : (" (" + last_error + ")").c_str(),
              (unsigned int)use_count.size(), build_attempts, level_vetoes,
              build_attempts ? level_vetoes * 100.0 / build_attempts : 0.0);
-        printf("%d..", i + 1);
-        fflush(stdout);
+        if (progress)
+        {
+            printf("%d..", i + 1);
+            fflush(stdout);
+        }
         dlua.callfn("dgn_clear_data", "");
         you.uniq_map_tags.clear();
         you.uniq_map_names.clear();
@@ -274,9 +313,214 @@ bool mapstat_build_levels()
         if (crawl_state.obj_stat_gen)
             objstat_iteration_stats();
     }
+    if (progress)
+    {
+        printf("Finished.\n");
+        fflush(stdout);
+    }
+    return true;
+}
+
+#ifdef UNIX
+// Named after the parent's pid too, so that runs sharing a directory don't
+// pick up each other's results.
+static string _worker_stats_file(pid_t parent, int worker)
+{
+    return make_stringf("mapstat-%d-worker-%d.tmp", (int) parent, worker);
+}
+
+static void _write_worker_stats(const string &file, bool ok)
+{
+    FILE *fp = fopen_u(file.c_str(), "wb");
+    if (!fp)
+        return;
+    writer th(file, fp);
+    marshallBoolean(th, ok);
+    marshall_stat(th, try_count);
+    marshall_stat(th, use_count);
+    marshall_stat(th, success_count);
+    marshall_stat(th, level_mapcounts);
+    marshall_stat(th, map_builds);
+    marshall_stat(th, level_mapsused);
+    marshall_stat(th, map_levelsused);
+    marshall_stat(th, errors);
+    marshall_stat(th, last_error);
+    marshallInt(th, levels_tried);
+    marshallInt(th, levels_failed);
+    marshallInt(th, build_attempts);
+    marshallInt(th, level_vetoes);
+    marshall_stat(th, veto_messages);
+    marshall_stat(th, veto_stages);
+    marshall_stat(th, lua_calls);
+    marshall_stat(th, lua_usec);
+    marshall_stat(th, level_build_usec);
+    if (crawl_state.obj_stat_gen)
+        objstat_marshall_worker_stats(th);
+    fclose(fp);
+}
+
+// Adding up the workers' tables: counts are summed, sets joined, and the
+// first worker's error message for a map is kept.
+static void _merge_stat(int &into, int from)
+{
+    into += from;
+}
+
+static void _merge_stat(string &into, const string &from)
+{
+    if (into.empty())
+        into = from;
+}
+
+static void _merge_stat(int64_t &into, int64_t from)
+{
+    into += from;
+}
+
+template <typename A, typename B>
+static void _merge_stat(pair<A, B> &into, const pair<A, B> &from)
+{
+    into.first += from.first;
+    into.second += from.second;
+}
+
+template <typename T>
+static void _merge_stat(set<T> &into, const set<T> &from)
+{
+    into.insert(from.begin(), from.end());
+}
+
+template <typename K, typename V>
+static void _merge_stat(map<K, V> &into, const map<K, V> &from)
+{
+    for (const auto &entry : from)
+        _merge_stat(into[entry.first], entry.second);
+}
+
+template <typename T>
+static void _merge_worker_stat(reader &th, T &into)
+{
+    T from;
+    unmarshall_stat(th, from);
+    _merge_stat(into, from);
+}
+
+static bool _merge_worker_stats(reader &th)
+{
+    const bool ok = unmarshallBoolean(th);
+    _merge_worker_stat(th, try_count);
+    _merge_worker_stat(th, use_count);
+    _merge_worker_stat(th, success_count);
+    _merge_worker_stat(th, level_mapcounts);
+    _merge_worker_stat(th, map_builds);
+    _merge_worker_stat(th, level_mapsused);
+    _merge_worker_stat(th, map_levelsused);
+    _merge_worker_stat(th, errors);
+    string error;
+    unmarshall_stat(th, error);
+    if (!error.empty())
+        last_error = error;
+    levels_tried += unmarshallInt(th);
+    levels_failed += unmarshallInt(th);
+    build_attempts += unmarshallInt(th);
+    level_vetoes += unmarshallInt(th);
+    _merge_worker_stat(th, veto_messages);
+    _merge_worker_stat(th, veto_stages);
+    _merge_worker_stat(th, lua_calls);
+    _merge_worker_stat(th, lua_usec);
+    _merge_worker_stat(th, level_build_usec);
+    if (crawl_state.obj_stat_gen)
+        objstat_merge_worker_stats(th);
+    return ok;
+}
+
+static bool _merge_worker_stats(const string &file)
+{
+    FILE *fp = fopen_u(file.c_str(), "rb");
+    if (!fp)
+        return false;
+    reader th(fp);
+    bool ok;
+    try
+    {
+        ok = _merge_worker_stats(th);
+    }
+    catch (short_read_exception &E)
+    {
+        // The worker died while writing.
+        ok = false;
+    }
+    fclose(fp);
+    return ok;
+}
+
+/**
+ * Split the iterations between forked workers, each with its own seed, and
+ * merge what they found. Workers are merged in order, so for a given seed
+ * and number of jobs the results are always the same.
+ */
+static bool _build_iterations_in_workers(int jobs)
+{
+    const int iters = SysEnv.map_gen_iters;
+    const uint64_t base_seed = rng::get_uint64();
+    printf("Splitting %d iteration(s) between %d workers...", iters, jobs);
+    fflush(stdout);
+    fflush(stderr);
+
+    const pid_t parent = getpid();
+    vector<pid_t> workers;
+    for (int i = 0; i < jobs; ++i)
+    {
+        const pid_t pid = fork();
+        if (pid < 0)
+            end(1, true, "Can't fork mapstat worker");
+        if (pid == 0)
+        {
+            crawl_state.forked_worker = true;
+            msg::suppress quiet;
+            rng::seed(base_seed + i);
+            const bool ok = _build_iterations(iters / jobs + (i < iters % jobs),
+                                              false);
+            _write_worker_stats(_worker_stats_file(parent, i), ok);
+            _exit(0);
+        }
+        workers.push_back(pid);
+    }
+
+    bool ok = true;
+    for (int i = 0; i < jobs; ++i)
+    {
+        int status;
+        while (waitpid(workers[i], &status, 0) < 0 && errno == EINTR)
+            ;
+        const string file = _worker_stats_file(parent, i);
+        if (!_merge_worker_stats(file))
+        {
+            fprintf(stderr, "\nWorker %d failed.\n", i);
+            ok = false;
+        }
+        unlink_u(file.c_str());
+    }
     printf("Finished.\n");
     fflush(stdout);
-    return true;
+    return ok;
+}
+#endif
+
+bool mapstat_build_levels()
+{
+    if (!generated_levels.size())
+        _dungeon_places();
+
+#ifdef UNIX
+    int jobs = SysEnv.map_gen_jobs;
+    if (jobs == 0)
+        jobs = max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+    jobs = min(jobs, SysEnv.map_gen_iters);
+    if (jobs > 1)
+        return _build_iterations_in_workers(jobs);
+#endif
+    return _build_iterations(SysEnv.map_gen_iters, true);
 }
 
 void mapstat_report_map_try(const map_def &map)
@@ -302,6 +546,14 @@ void mapstat_report_error(const map_def &/*map*/, const string &err)
     last_error = err;
 }
 
+void mapstat_report_lua_calls(const map_def &map, int calls, int64_t usec)
+{
+    pair<int, int> &count = lua_calls[map.name];
+    count.first += calls;
+    count.second++;
+    lua_usec[map.name] += usec;
+}
+
 static void _report_available_random_vaults(FILE *outf)
 {
     you.uniq_map_tags.clear();
@@ -408,6 +660,17 @@ static void _write_map_stats()
                     vetoes, tries, vetoes * 100.0 / tries);
         }
 
+        fprintf(outf, "\n\nVetoes by build stage:\n");
+        multimap<int, string> sortedstages;
+        for (const auto &entry : veto_stages)
+            sortedstages.insert(make_pair(entry.second, entry.first));
+
+        for (auto i = sortedstages.rbegin(); i != sortedstages.rend(); ++i)
+        {
+            fprintf(outf, "%6d (%.2f%%) %s\n", i->first,
+                    i->first * 100.0 / level_vetoes, i->second.c_str());
+        }
+
         fprintf(outf, "\n\nVeto reasons:\n");
         multimap<int, string> sortedreasons;
         for (const auto &entry : veto_messages)
@@ -417,6 +680,27 @@ static void _write_map_stats()
             fprintf(outf, "%3d) %s\n", i->first, i->second.c_str());
     }
 
+    if (!lua_calls.empty())
+    {
+        fprintf(outf, "\n\nLua calls into C, per run of the map's Lua:\n");
+        multimap<double, string> sortedcalls;
+        for (const auto &entry : lua_calls)
+        {
+            sortedcalls.emplace(entry.second.first / (double) entry.second.second,
+                                entry.first);
+        }
+
+        const int max_shown = 50;
+        int count = 0;
+        for (auto i = sortedcalls.rbegin();
+             i != sortedcalls.rend() && count < max_shown; ++i)
+        {
+            fprintf(outf, "%3d) %s (%.1f in %d run%s)\n", ++count,
+                    i->second.c_str(), i->first, lua_calls[i->second].second,
+                    lua_calls[i->second].second == 1 ? "" : "s");
+        }
+    }
+
     if (!unused_maps.empty() && !SysEnv.map_gen_range)
     {
         fprintf(outf, "\n\nUnused maps:\n\n");
@@ -490,6 +774,160 @@ static void _write_map_stats()
     printf("\n");
 }
 
+static double _mean_build_ms(const pair<int64_t, int> &build_time)
+{
+    return build_time.second ? build_time.first / 1000.0 / build_time.second
+                             : 0.0;
+}
+
+static JsonNode *_level_stats_json()
+{
+    JsonNode *levels = json_mkobject();
+    for (const auto &entry : level_build_usec)
+    {
+        const level_id &lid = entry.first;
+        const pair<int, int> tries = lookup(map_builds, lid, make_pair(0, 0));
+        JsonNode *level = json_mkobject();
+        json_append_member(level, "builds", json_mknumber(entry.second.second));
+        json_append_member(level, "mean_ms",
+                           json_mknumber(_mean_build_ms(entry.second)));
+        json_append_member(level, "attempts", json_mknumber(tries.first));
+        json_append_member(level, "vetoes", json_mknumber(tries.second));
+        json_append_member(level, "maps_used",
+                           json_mknumber(lookup(level_mapcounts, lid, 0)));
+        json_append_member(levels, lid.describe().c_str(), level);
+    }
+    return levels;
+}
+
+static JsonNode *_map_stats_json()
+{
+    JsonNode *maps = json_mkobject();
+    for (const auto &entry : try_count)
+    {
+        const string &name = entry.first;
+        JsonNode *map = json_mkobject();
+        json_append_member(map, "tried", json_mknumber(entry.second));
+        json_append_member(map, "used",
+                           json_mknumber(lookup(use_count, name, 0)));
+        json_append_member(map, "successful",
+                           json_mknumber(lookup(success_count, name, 0)));
+        const pair<int, int> calls = lookup(lua_calls, name, make_pair(0, 0));
+        if (calls.second)
+        {
+            json_append_member(map, "lua_runs", json_mknumber(calls.second));
+            json_append_member(map, "lua_c_calls", json_mknumber(calls.first));
+            json_append_member(map, "lua_ms",
+                json_mknumber(lookup(lua_usec, name, 0) / 1000.0));
+        }
+        json_append_member(maps, name.c_str(), map);
+    }
+    return maps;
+}
+
+/**
+ * Write mapstat.json, for comparing one run's figures to another's: the
+ * totals, and for each level its mean build time, attempts and vetoes, and
+ * for each map how often it was tried and used and how long its Lua took.
+ */
+static void _write_map_stats_json()
+{
+    JsonWrapper json(json_mkobject());
+    json_append_member(json.node, "seed",
+        json_mkstring(make_stringf("%" PRIu64, crawl_state.seed)));
+    json_append_member(json.node, "iterations",
+                       json_mknumber(SysEnv.map_gen_iters));
+    json_append_member(json.node, "levels_tried", json_mknumber(levels_tried));
+    json_append_member(json.node, "levels_failed",
+                       json_mknumber(levels_failed));
+    json_append_member(json.node, "build_attempts",
+                       json_mknumber(build_attempts));
+    json_append_member(json.node, "vetoes", json_mknumber(level_vetoes));
+
+    JsonNode *stages = json_mkobject();
+    for (const auto &entry : veto_stages)
+        json_append_member(stages, entry.first.c_str(),
+                           json_mknumber(entry.second));
+    json_append_member(json.node, "veto_stages", stages);
+    json_append_member(json.node, "levels", _level_stats_json());
+    json_append_member(json.node, "maps", _map_stats_json());
+
+    const char *out_file = "mapstat.json";
+    FILE *outf = fopen_u(out_file, "w");
+    if (!outf)
+    {
+        fprintf(stderr, "Can't write %s\n", out_file);
+        return;
+    }
+    char *text = json_stringify(json.node, " ");
+    fprintf(outf, "%s\n", text ? text : "");
+    free(text);
+    fclose(outf);
+}
+
+// Differences smaller than this are noise, however many times slower.
+static const double MIN_REGRESSION_MS = 5.0;
+
+/**
+ * Compare this run's level build times to those in the -mapstat-baseline
+ * file, and list the levels that got more than the threshold times slower.
+ *
+ * @returns False if any did, or if the baseline couldn't be read.
+ */
+static bool _check_baseline(const string &file)
+{
+    FILE *fp = fopen_u(file.c_str(), "r");
+    if (!fp)
+    {
+        fprintf(stderr, "Can't read baseline %s\n", file.c_str());
+        return false;
+    }
+    string text;
+    char buf[4096];
+    size_t len;
+    while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+        text.append(buf, len);
+    fclose(fp);
+
+    JsonWrapper baseline(json_decode(text.c_str()));
+    const JsonNode *levels = baseline.node
+                             ? json_find_member(baseline.node, "levels")
+                             : nullptr;
+    if (!levels || levels->tag != JSON_OBJECT)
+    {
+        fprintf(stderr, "%s isn't a mapstat.json file\n", file.c_str());
+        return false;
+    }
+
+    int regressions = 0;
+    for (const auto &entry : level_build_usec)
+    {
+        const string name = entry.first.describe();
+        const JsonNode *level = json_find_member(levels, name.c_str());
+        const JsonNode *was = level ? json_find_member(level, "mean_ms")
+                                    : nullptr;
+        if (!was || was->tag != JSON_NUMBER)
+            continue;
+
+        const double now = _mean_build_ms(entry.second);
+        if (now > was->number_ * SysEnv.map_gen_threshold
+            && now - was->number_ >= MIN_REGRESSION_MS)
+        {
+            if (!regressions++)
+            {
+                printf("Levels more than %.1fx slower to build than in %s:\n",
+                       SysEnv.map_gen_threshold, file.c_str());
+            }
+            printf("  %s: %.1f ms, was %.1f ms\n", name.c_str(), now,
+                   was->number_);
+        }
+    }
+    if (!regressions)
+        printf("No level is more than %.1fx slower to build than in %s.\n",
+               SysEnv.map_gen_threshold, file.c_str());
+    return !regressions;
+}
+
 bool mapstat_find_forced_map()
 {
     const map_def *map = find_map_by_name(crawl_state.force_map);
@@ -508,7 +946,13 @@ bool mapstat_find_forced_map()
     return true;
 }
 
-void mapstat_generate_stats()
+/**
+ * Run -mapstat: build the levels, and write mapstat.log and mapstat.json.
+ *
+ * @returns False if the build times were compared to a baseline and some
+ * level was too much slower, or if the forced map doesn't exist.
+ */
+bool mapstat_generate_stats()
 {
     // Warn assertions about possible oddities like the artefact list being
     // cleared.
@@ -518,7 +962,7 @@ void mapstat_generate_stats()
     you.species = SP_HUMAN;
 
     if (!crawl_state.force_map.empty() && !mapstat_find_forced_map())
-        return;
+        return false;
 
     initialise_item_descriptions();
     initialise_branch_depths();
@@ -539,7 +983,238 @@ void mapstat_generate_stats()
     mapstat_build_levels();
 
     _write_map_stats();
+    _write_map_stats_json();
     printf("Map stats complete.\n");
+
+    if (!SysEnv.map_gen_baseline.empty())
+        return _check_baseline(SysEnv.map_gen_baseline);
+    return true;
+}
+
+static void _catalog_entry(FILE *out, uint64_t seed, const string &place,
+                           const char *kind, const string &name)
+{
+    fprintf(out, "%" PRIu64 "\t%s\t%s\t%s\n", seed, place.c_str(), kind,
+            name.c_str());
+}
+
+static void _catalog_item(FILE *out, uint64_t seed, const string &place,
+                          const item_def &item, const string &where)
+{
+    if (item.base_type == OBJ_RUNES)
+    {
+        _catalog_entry(out, seed, place, "rune",
+                       item.name(DESC_PLAIN, false, true) + where);
+    }
+    else if (is_artefact(item))
+    {
+        _catalog_entry(out, seed, place, "item",
+                       item.name(DESC_PLAIN, false, true) + where);
+    }
+}
+
+static void _catalog_current_level(FILE *out, uint64_t seed)
+{
+    const string place = level_id::current().describe();
+    for (const string &vault : level_vault_names(true))
+        _catalog_entry(out, seed, place, "vault", vault);
+    for (monster_iterator mi; mi; ++mi)
+        if (mons_is_unique(mi->type))
+            _catalog_entry(out, seed, place, "unique", mi->name(DESC_PLAIN, true));
+    for (int i = 0; i < MAX_ITEMS; ++i)
+        if (env.item[i].defined())
+            _catalog_item(out, seed, place, env.item[i], "");
+    for (const auto &shop : env.shop)
+        for (const item_def &item : shop.stock)
+            _catalog_item(out, seed, place, item, " (shop)");
+}
+
+static void _catalog_level(FILE *out, uint64_t seed, const level_id &lid)
+{
+    if (is_connected_branch(lid.branch))
+        you.level_stack.clear();
+    else if (!player_in_branch(lid.branch))
+        you.level_stack.push_back(level_pos::current());
+    you.goto_place(lid);
+    {
+        msg::suppress mx;
+        env.map_knowledge.init(map_cell());
+        los_changed();
+        tile_init_default_flavour();
+        tile_clear_flavour();
+        tile_new_level(true);
+        if (!builder())
+        {
+            _catalog_entry(out, seed, lid.describe(), "failed", "");
+            return;
+        }
+        update_portal_entrances();
+    }
+    if (!SysEnv.map_gen_range || SysEnv.map_gen_range->is_usable_in(lid))
+        _catalog_current_level(out, seed);
+}
+
+/**
+ * Build a game's dungeon from scratch, in the stable generation order, and
+ * write down what's on each level of interest. Everything that a level can
+ * depend on is reset first, so the catalog for a seed is the same however
+ * many other seeds the process has already done.
+ */
+static void _catalog_seed(FILE *out, uint64_t seed)
+{
+    Options.seed = seed;
+    rng::reset();
+    dgn_reset_level();
+    dgn_flush_map_memory();
+    init_level_connectivity();
+    initial_dungeon_setup();
+
+    for (const level_id &lid : generation_order_levels())
+    {
+        watchdog();
+        // Levels outside the range still have to be built, since everything
+        // later in the order depends on them.
+        _catalog_level(out, seed, lid);
+        for (const level_id &portal : portal_levels_at(lid))
+            _catalog_level(out, seed, portal);
+    }
+}
+
+static void _catalog_seeds(FILE *out, uint64_t first, uint64_t count,
+                           bool progress)
+{
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        if (progress)
+        {
+            printf("%" PRIu64 "..", first + i);
+            fflush(stdout);
+        }
+        _catalog_seed(out, first + i);
+    }
+}
+
+#ifdef UNIX
+static string _worker_catalog_file(pid_t parent, int worker)
+{
+    return make_stringf("seedcat-%d-worker-%d.tmp", (int) parent, worker);
+}
+
+static bool _append_file(FILE *out, const string &file)
+{
+    FILE *in = fopen_u(file.c_str(), "rb");
+    if (!in)
+        return false;
+    char buf[4096];
+    size_t len;
+    while ((len = fread(buf, 1, sizeof(buf), in)) > 0)
+        fwrite(buf, 1, len, out);
+    fclose(in);
+    return true;
+}
+
+/**
+ * Split the seeds into one run of consecutive seeds per forked worker, and
+ * put their catalogs together in seed order.
+ */
+static bool _catalog_seeds_in_workers(FILE *out, uint64_t first,
+                                      uint64_t count, int jobs)
+{
+    printf("Splitting %" PRIu64 " seed(s) between %d workers...", count, jobs);
+    fflush(stdout);
+    fflush(stderr);
+
+    const pid_t parent = getpid();
+    vector<pid_t> workers;
+    uint64_t start = first;
+    for (int i = 0; i < jobs; ++i)
+    {
+        const uint64_t share = count / jobs + ((uint64_t) i < count % jobs);
+        const pid_t pid = fork();
+        if (pid < 0)
+            end(1, true, "Can't fork seed catalog worker");
+        if (pid == 0)
+        {
+            crawl_state.forked_worker = true;
+            msg::suppress quiet;
+            FILE *fp = fopen_u(_worker_catalog_file(parent, i).c_str(), "wb");
+            if (!fp)
+                _exit(1);
+            _catalog_seeds(fp, start, share, false);
+            fclose(fp);
+            _exit(0);
+        }
+        workers.push_back(pid);
+        start += share;
+    }
+
+    bool ok = true;
+    for (int i = 0; i < jobs; ++i)
+    {
+        int status;
+        while (waitpid(workers[i], &status, 0) < 0 && errno == EINTR)
+            ;
+        const string file = _worker_catalog_file(parent, i);
+        if (!WIFEXITED(status) || WEXITSTATUS(status)
+            || !_append_file(out, file))
+        {
+            fprintf(stderr, "\nWorker %d failed.\n", i);
+            ok = false;
+        }
+        unlink_u(file.c_str());
+    }
+    printf("Finished.\n");
+    fflush(stdout);
+    return ok;
+}
+#endif
+
+/**
+ * Write seed-catalog.txt: the vaults, uniques, artefacts and runes of every
+ * level, for each seed in the range given with -seedcat. Each line is
+ *
+ *   seed <tab> place <tab> vault|unique|item|rune|failed <tab> name
+ *
+ * in generation order, so two catalogs can be compared with diff.
+ */
+void seedcat_generate_catalog()
+{
+    you.wizard = true;
+    you.species = SP_HUMAN;
+    you.deterministic_levelgen = true;
+
+    run_map_global_preludes();
+    run_map_local_preludes();
+
+    const uint64_t first = SysEnv.seed_cat_first;
+    const uint64_t count = SysEnv.seed_cat_last - first + 1;
+    const char *out_file = "seed-catalog.txt";
+    FILE *outf = fopen_u(out_file, "w");
+    if (!outf)
+        end(1, true, "Can't write %s", out_file);
+    fprintf(outf, "# seed\tplace\tkind\tname\n");
+
+    printf("Cataloguing %" PRIu64 " seed(s) into %s.\n", count, out_file);
+    fflush(stdout);
+
+    bool ok = true;
+#ifdef UNIX
+    int jobs = SysEnv.map_gen_jobs;
+    if (jobs == 0)
+        jobs = max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+    if ((uint64_t) jobs > count)
+        jobs = count;
+    if (jobs > 1)
+        ok = _catalog_seeds_in_workers(outf, first, count, jobs);
+    else
+#endif
+    {
+        printf("Seed: ");
+        _catalog_seeds(outf, first, count, true);
+        printf("Finished.\n");
+    }
+    fclose(outf);
+    printf(ok ? "Seed catalog complete.\n" : "Seed catalog incomplete.\n");
 }
 
 #endif // DEBUG_STATISTICS
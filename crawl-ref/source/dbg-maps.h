@@ -7,14 +7,120 @@
 
 #ifdef DEBUG_STATISTICS
 
+#include "tags.h"
+
 class map_def;
 void mapstat_report_map_try(const map_def &map);
 void mapstat_report_map_use(const map_def &map);
 void mapstat_report_map_success(const string &map_name);
 void mapstat_report_error(const map_def &map, const string &err);
+void mapstat_report_lua_calls(const map_def &map, int calls, int64_t usec);
 void mapstat_report_map_build_start();
-void mapstat_report_map_veto(const string &message);
-void mapstat_generate_stats();
+void mapstat_report_map_veto(const string &message, const string &stage);
+bool mapstat_generate_stats();
 bool mapstat_build_levels();
 bool mapstat_find_forced_map();
+void seedcat_generate_catalog();
+
+// Marshalling for the statistics tables, which -jobs workers send back to
+// be merged: ints and enums, times, strings, level_ids, and pairs, sets and
+// maps of those.
+static inline void marshall_stat(writer &th, const int64_t &v)
+{
+    marshallSigned(th, v);
+}
+
+static inline void marshall_stat(writer &th, const string &v)
+{
+    marshallString(th, v);
+}
+
+static inline void marshall_stat(writer &th, const level_id &v)
+{
+    marshall_level_id(th, v);
+}
+
+template <typename T>
+static void marshall_stat(writer &th, const T &v)
+{
+    marshallInt(th, static_cast<int>(v));
+}
+
+template <typename A, typename B>
+static void marshall_stat(writer &th, const pair<A, B> &v)
+{
+    marshall_stat(th, v.first);
+    marshall_stat(th, v.second);
+}
+
+template <typename T>
+static void marshall_stat(writer &th, const set<T> &v)
+{
+    marshallInt(th, v.size());
+    for (const T &entry : v)
+        marshall_stat(th, entry);
+}
+
+template <typename K, typename V>
+static void marshall_stat(writer &th, const map<K, V> &v)
+{
+    marshallInt(th, v.size());
+    for (const auto &entry : v)
+    {
+        marshall_stat(th, entry.first);
+        marshall_stat(th, entry.second);
+    }
+}
+
+static inline void unmarshall_stat(reader &th, int64_t &v)
+{
+    v = unmarshallSigned(th);
+}
+
+static inline void unmarshall_stat(reader &th, string &v)
+{
+    v = unmarshallString(th);
+}
+
+static inline void unmarshall_stat(reader &th, level_id &v)
+{
+    v = unmarshall_level_id(th);
+}
+
+template <typename T>
+static void unmarshall_stat(reader &th, T &v)
+{
+    v = static_cast<T>(unmarshallInt(th));
+}
+
+template <typename A, typename B>
+static void unmarshall_stat(reader &th, pair<A, B> &v)
+{
+    unmarshall_stat(th, v.first);
+    unmarshall_stat(th, v.second);
+}
+
+template <typename T>
+static void unmarshall_stat(reader &th, set<T> &v)
+{
+    v.clear();
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        T entry;
+        unmarshall_stat(th, entry);
+        v.insert(entry);
+    }
+}
+
+template <typename K, typename V>
+static void unmarshall_stat(reader &th, map<K, V> &v)
+{
+    v.clear();
+    for (int i = unmarshallInt(th); i > 0; --i)
+    {
+        K key;
+        unmarshall_stat(th, key);
+        unmarshall_stat(th, v[key]);
+    }
+}
 #endif
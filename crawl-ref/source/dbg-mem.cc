@@ -0,0 +1,283 @@
+/**
+ * @file
+ * @brief Where a game's memory goes.
+ *
+ * The subsystem figures are estimates, from the sizes of the objects and
+ * the strings and tables they own; the allocator's own overhead isn't in
+ * them. Lua reports its own use. In DEBUG_PROFILE builds operator new is
+ * replaced, to count allocations per turn.
+**/
+
+#include "AppHdr.h"
+
+#include "dbg-mem.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#ifndef TARGET_OS_WINDOWS
+# include <unistd.h>
+#endif
+
+#include "clua.h"
+#include "coordit.h"
+#include "dlua.h"
+#include "env.h"
+#include "ghost.h"
+#include "mapdef.h"
+#include "maps.h"
+#include "message.h"
+#include "mon-info.h"
+#include "player.h"
+#include "scroller.h"
+#include "store.h"
+#include "stringutil.h"
+
+static size_t _props_bytes(const CrawlHashTable &props);
+
+static size_t _store_bytes(const CrawlStoreValue &val)
+{
+    size_t bytes = sizeof(val);
+    switch (val.get_type())
+    {
+    case SV_STR:
+        bytes += val.get_string().size();
+        break;
+    case SV_HASH:
+        bytes += sizeof(CrawlHashTable) + _props_bytes(val.get_table());
+        break;
+    case SV_VEC:
+        bytes += sizeof(CrawlVector);
+        for (const CrawlStoreValue &elem : val.get_vector())
+            bytes += _store_bytes(elem);
+        break;
+    case SV_ITEM:
+        bytes += sizeof(item_def) + _props_bytes(val.get_item().props);
+        break;
+    case SV_MONST:
+        bytes += sizeof(monster) + _props_bytes(val.get_monster().props);
+        break;
+    default:
+        break;
+    }
+    return bytes;
+}
+
+// What a props table owns, beyond its own object.
+static size_t _props_bytes(const CrawlHashTable &props)
+{
+    size_t bytes = 0;
+    for (const auto &entry : props)
+    {
+        // A map node's links, the key's text, and the value.
+        bytes += 4 * sizeof(void *) + entry.first.capacity()
+                 + _store_bytes(entry.second);
+    }
+    return bytes;
+}
+
+static mem_area _item_memory()
+{
+    mem_area area = { "items", sizeof(env.item), 0 };
+    for (const item_def &item : env.item)
+    {
+        if (!item.defined())
+            continue;
+        ++area.count;
+        area.bytes += _props_bytes(item.props);
+    }
+    for (const item_def &item : you.inv)
+        area.bytes += _props_bytes(item.props);
+    return area;
+}
+
+static mem_area _monster_memory()
+{
+    mem_area area = { "monsters", sizeof(env.mons), 0 };
+    for (const monster &mon : env.mons)
+    {
+        if (!mon.alive())
+            continue;
+        ++area.count;
+        area.bytes += _props_bytes(mon.props);
+        if (mon.ghost)
+            area.bytes += sizeof(ghost_demon);
+    }
+    return area;
+}
+
+static mem_area _map_knowledge_memory()
+{
+    mem_area area = { "map knowledge", sizeof(env.map_knowledge), 0 };
+    for (rectangle_iterator ri(0); ri; ++ri)
+    {
+        const monster_info *mi = env.map_knowledge(*ri).monsterinfo();
+        if (!mi)
+            continue;
+        ++area.count;
+        area.bytes += sizeof(*mi) + mi->mname.capacity()
+                      + _props_bytes(mi->props);
+    }
+    return area;
+}
+
+static mem_area _map_index_memory()
+{
+    mem_area area = { "map index", 0, (size_t)map_count() };
+    for (int i = 0; i < map_count(); ++i)
+    {
+        const map_def *map = map_by_index(i);
+        area.bytes += sizeof(*map) + map->name.capacity()
+                      + map->description.capacity()
+                      + map->tags_string().size()
+                      + map->prelude.compiled_chunk().capacity()
+                      + map->prelude.lua_string().capacity();
+    }
+    return area;
+}
+
+static mem_area _lua_memory(const char *name, CLua &vm)
+{
+    lua_State *ls = vm.state();
+    if (!ls)
+        return { name, 0, 0 };
+    return { name, (size_t)lua_gc(ls, LUA_GCCOUNT, 0) * 1024
+                   + lua_gc(ls, LUA_GCCOUNTB, 0), 0 };
+}
+
+vector<mem_area> memory_usage()
+{
+    return
+    {
+        _item_memory(),
+        _monster_memory(),
+        _map_knowledge_memory(),
+        _map_index_memory(),
+        _lua_memory("user lua", clua),
+        _lua_memory("dungeon lua", dlua),
+        { "messages", message_history_memory(), 0 },
+    };
+}
+
+size_t process_rss()
+{
+#if defined(UNIX) && !defined(TARGET_OS_MACOSX)
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (!statm)
+        return 0;
+    unsigned long size = 0, resident = 0;
+    const bool ok = fscanf(statm, "%lu %lu", &size, &resident) == 2;
+    fclose(statm);
+    return ok ? resident * sysconf(_SC_PAGESIZE) : 0;
+#else
+    return 0;
+#endif
+}
+
+string memory_report()
+{
+    string report = make_stringf("%-16s %12s %8s\n", "Subsystem", "KB",
+                                 "count");
+    size_t total = 0;
+    for (const mem_area &area : memory_usage())
+    {
+        total += area.bytes;
+        report += make_stringf("%-16s %12.1f", area.name.c_str(),
+                               area.bytes / 1024.0);
+        if (area.count)
+            report += make_stringf(" %8u", (unsigned int)area.count);
+        report += "\n";
+    }
+    report += make_stringf("%-16s %12.1f\n", "total", total / 1024.0);
+    if (const size_t rss = process_rss())
+        report += make_stringf("%-16s %12.1f\n", "process RSS", rss / 1024.0);
+#ifdef DEBUG_PROFILE
+    report += "\n" + allocation_report();
+#endif
+    return report;
+}
+
+#ifdef DEBUG_PROFILE
+
+static atomic<uint64_t> _allocs(0);
+static atomic<uint64_t> _alloc_bytes(0);
+static uint64_t _turn_start_allocs = 0;
+static uint64_t _max_turn_allocs = 0;
+static int _max_alloc_turn = 0;
+static uint64_t _reset_allocs = 0;
+static int _alloc_turns = 0;
+
+static void *_counted_alloc(size_t size)
+{
+    _allocs.fetch_add(1, memory_order_relaxed);
+    _alloc_bytes.fetch_add(size, memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void *operator new(size_t size)
+{
+    return _counted_alloc(size);
+}
+
+void *operator new[](size_t size)
+{
+    return _counted_alloc(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void memory_end_turn()
+{
+    const uint64_t now = _allocs.load(memory_order_relaxed);
+    const uint64_t turn = now - _turn_start_allocs;
+    if (turn > _max_turn_allocs)
+    {
+        _max_turn_allocs = turn;
+        _max_alloc_turn = you.num_turns;
+    }
+    _turn_start_allocs = now;
+    ++_alloc_turns;
+}
+
+void memory_reset()
+{
+    _reset_allocs = _turn_start_allocs = _allocs.load(memory_order_relaxed);
+    _max_turn_allocs = 0;
+    _alloc_turns = 0;
+}
+
+string allocation_report()
+{
+    const uint64_t allocs = _allocs.load(memory_order_relaxed) - _reset_allocs;
+    return make_stringf("Allocations: %" PRIu64 " (%.1f MB in all since "
+                        "startup), %.1f per turn, at most %" PRIu64
+                        " (turn %d)\n",
+                        allocs,
+                        _alloc_bytes.load(memory_order_relaxed) / 1048576.0,
+                        _alloc_turns ? (double)allocs / _alloc_turns : 0.0,
+                        _max_turn_allocs, _max_alloc_turn);
+}
+
+#endif
+
+#ifdef WIZARD
+void wizard_memory_report()
+{
+    formatted_scroller report_scroller;
+    report_scroller.set_more();
+    report_scroller.add_raw_text(memory_report(), false);
+    report_scroller.show();
+}
+#endif
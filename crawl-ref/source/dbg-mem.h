@@ -0,0 +1,32 @@
+/**
+ * @file
+ * @brief Where a game's memory goes.
+**/
+
+#pragma once
+
+#include <vector>
+
+struct mem_area
+{
+    string name;
+    size_t bytes;
+    size_t count; // items, monsters, maps...; 0 if that means nothing
+};
+
+// An estimate of the memory each subsystem holds, from walking its data.
+vector<mem_area> memory_usage();
+// The resident size of the whole process, or 0 if that can't be found out.
+size_t process_rss();
+string memory_report();
+
+#ifdef DEBUG_PROFILE
+// Allocations through operator new, this turn and overall.
+void memory_end_turn();
+void memory_reset();
+string allocation_report();
+#endif
+
+#ifdef WIZARD
+void wizard_memory_report();
+#endif
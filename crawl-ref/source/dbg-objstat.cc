@@ -1352,6 +1352,63 @@ static void _write_object_stats()
     printf("Wrote Feature stats to %s.\n", out_file.c_str());
 }
 
+void objstat_marshall_worker_stats(writer &th)
+{
+    marshall_stat(th, item_recs);
+    marshall_stat(th, brand_recs);
+    marshall_stat(th, monster_recs);
+    marshall_stat(th, feature_recs);
+    marshall_stat(th, spell_recs);
+}
+
+// Each iteration's minimum and maximum have to stay a minimum and maximum;
+// everything else recorded is a running total.
+static void _merge_fields(map<string, int> &into, const map<string, int> &from)
+{
+    for (const auto &field : from)
+    {
+        auto it = into.find(field.first);
+        if (it == into.end())
+            into.insert(field);
+        else if (field.first == "NumMin")
+            it->second = min(it->second, field.second);
+        else if (field.first == "NumMax")
+            it->second = max(it->second, field.second);
+        else
+            it->second += field.second;
+    }
+}
+
+static void _merge_fields(map<int, int> &into, const map<int, int> &from)
+{
+    for (const auto &field : from)
+        into[field.first] += field.second;
+}
+
+template <typename K, typename V>
+static void _merge_fields(map<K, V> &into, const map<K, V> &from)
+{
+    for (const auto &entry : from)
+        _merge_fields(into[entry.first], entry.second);
+}
+
+template <typename T>
+static void _merge_worker_recs(reader &th, T &into)
+{
+    T from;
+    unmarshall_stat(th, from);
+    _merge_fields(into, from);
+}
+
+void objstat_merge_worker_stats(reader &th)
+{
+    _merge_worker_recs(th, item_recs);
+    _merge_worker_recs(th, brand_recs);
+    _merge_worker_recs(th, monster_recs);
+    _merge_worker_recs(th, feature_recs);
+    _merge_worker_recs(th, spell_recs);
+}
+
 void objstat_generate_stats()
 {
     // Warn assertions about possible oddities like the artefact list being
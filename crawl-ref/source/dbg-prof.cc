@@ -0,0 +1,263 @@
+/**
+ * @file
+ * @brief Per-subsystem turn cost profiling.
+**/
+
+#include "AppHdr.h"
+
+#include "dbg-prof.h"
+
+#ifdef DEBUG_PROFILE
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <map>
+
+#include "clua.h"
+#include "dbg-mem.h"
+#include "message.h"
+#include "mon-util.h"
+#include "player.h"
+#include "prompt.h"
+#include "scroller.h"
+#include "stringutil.h"
+#include "syscalls.h"
+#include "unicode.h"
+
+namespace
+{
+    struct prof_stat
+    {
+        uint64_t calls = 0;
+        uint64_t total_ns = 0;
+        uint64_t turn_ns = 0;     // accumulated during the current turn
+        uint64_t turn_cpu_ns = 0; // the same in CPU time, when tracing
+        uint64_t max_turn_ns = 0;
+        int max_turn = 0;         // you.num_turns when max_turn_ns was seen
+
+        void add(uint64_t ns)
+        {
+            ++calls;
+            total_ns += ns;
+            turn_ns += ns;
+        }
+
+        void end_turn()
+        {
+            if (!turn_ns)
+                return;
+            if (turn_ns > max_turn_ns)
+            {
+                max_turn_ns = turn_ns;
+                max_turn = you.num_turns;
+            }
+            turn_ns = 0;
+            turn_cpu_ns = 0;
+        }
+    };
+}
+
+static prof_stat _zone_stats[NUM_PROF_ZONES];
+static map<int, prof_stat> _monster_stats;
+static int _profiled_turns = 0;
+// One row per turn of wall and CPU time for each zone, if wanted.
+static FILE *_trace = nullptr;
+
+static const char *_zone_names[] =
+{
+    "world_reacts", "handle_monsters", "handle_monster_move",
+    "manage_clouds", "apply_noises", "viewwindow", "builder",
+};
+COMPILE_CHECK(ARRAYSZ(_zone_names) == NUM_PROF_ZONES);
+
+// Reading the CPU clock costs more than the wall clock, so that's only done
+// when there's a trace to write it to.
+prof_scope::prof_scope(prof_zone z, int key)
+    : zone(z), subkey(key), start(chrono::steady_clock::now()),
+      cpu_start(_trace ? clock() : 0)
+{
+}
+
+prof_scope::~prof_scope()
+{
+    const uint64_t ns = chrono::duration_cast<chrono::nanoseconds>(
+                            chrono::steady_clock::now() - start).count();
+    _zone_stats[zone].add(ns);
+    if (_trace)
+    {
+        _zone_stats[zone].turn_cpu_ns += (uint64_t) (clock() - cpu_start)
+                                         * (1000000000 / CLOCKS_PER_SEC);
+    }
+    if (zone == PROF_MONSTER_MOVE && subkey >= 0)
+        _monster_stats[subkey].add(ns);
+}
+
+static void _trace_turn()
+{
+    fprintf(_trace, "%d", you.num_turns);
+    for (const prof_stat &stat : _zone_stats)
+    {
+        fprintf(_trace, "\t%" PRIu64 "\t%" PRIu64, stat.turn_ns / 1000,
+                stat.turn_cpu_ns / 1000);
+    }
+    fprintf(_trace, "\n");
+}
+
+void profile_end_turn()
+{
+    ++_profiled_turns;
+    if (_trace)
+        _trace_turn();
+    for (prof_stat &stat : _zone_stats)
+        stat.end_turn();
+    for (auto &entry : _monster_stats)
+        entry.second.end_turn();
+    memory_end_turn();
+}
+
+void profile_reset()
+{
+    for (prof_stat &stat : _zone_stats)
+        stat = prof_stat();
+    _monster_stats.clear();
+    _profiled_turns = 0;
+    clua.fn_times.clear();
+    memory_reset();
+}
+
+static string _stat_line(const string &name, const prof_stat &stat)
+{
+    const double ms = stat.total_ns / 1e6;
+    return make_stringf("%-28s %9" PRIu64 " %11.2f %9.4f %9.3f %8d\n",
+                        chop_string(name, 28).c_str(), stat.calls, ms,
+                        stat.calls ? ms / stat.calls : 0.0,
+                        stat.max_turn_ns / 1e6, stat.max_turn);
+}
+
+static string _stat_header(const string &what)
+{
+    return make_stringf("%-28s %9s %11s %9s %9s %8s\n",
+                        what.c_str(), "calls", "total ms", "ms/call",
+                        "worst ms", "on turn");
+}
+
+/**
+ * Summarise everything recorded since the last reset. Times are inclusive:
+ * world_reacts contains handle_monsters, which contains the per-monster
+ * moves.
+ */
+string profile_report()
+{
+    string report = make_stringf("Profiled turns: %d\n", _profiled_turns);
+    report += allocation_report() + "\n";
+
+    report += _stat_header("Subsystem");
+    for (int i = 0; i < NUM_PROF_ZONES; ++i)
+        report += _stat_line(_zone_names[i], _zone_stats[i]);
+
+    vector<pair<int, const prof_stat *>> mons;
+    for (const auto &entry : _monster_stats)
+        mons.emplace_back(entry.first, &entry.second);
+    sort(mons.begin(), mons.end(),
+         [](const pair<int, const prof_stat *> &a,
+            const pair<int, const prof_stat *> &b)
+         {
+             return a.second->total_ns > b.second->total_ns;
+         });
+
+    const size_t shown = min<size_t>(mons.size(), 20);
+    if (shown)
+    {
+        report += make_stringf("\nMonster moves (top %u of %u types)\n",
+                               (unsigned int) shown,
+                               (unsigned int) mons.size());
+        report += _stat_header("Monster");
+        for (size_t i = 0; i < shown; ++i)
+        {
+            const monster_type mt = static_cast<monster_type>(mons[i].first);
+            report += _stat_line(mons_type_name(mt, DESC_PLAIN),
+                                 *mons[i].second);
+        }
+    }
+
+    vector<pair<string, lua_fn_time>> lua_fns(clua.fn_times.begin(),
+                                               clua.fn_times.end());
+    sort(lua_fns.begin(), lua_fns.end(),
+         [](const pair<string, lua_fn_time> &a,
+            const pair<string, lua_fn_time> &b)
+         {
+             return a.second.usec > b.second.usec;
+         });
+    if (!lua_fns.empty())
+    {
+        report += "\nUser Lua functions and hooks\n";
+        report += make_stringf("%-28s %9s %11s %9s\n", "Function", "calls",
+                               "total ms", "ms/call");
+        for (const auto &fn : lua_fns)
+        {
+            const double ms = fn.second.usec / 1e3;
+            report += make_stringf("%-28s %9u %11.2f %9.4f\n",
+                                   chop_string(fn.first, 28).c_str(),
+                                   fn.second.calls, ms,
+                                   fn.second.calls ? ms / fn.second.calls
+                                                   : 0.0);
+        }
+    }
+
+    return report;
+}
+
+bool profile_dump(const string &filename)
+{
+    FILE *f = fopen_u(filename.c_str(), "w");
+    if (!f)
+        return false;
+
+    fprintf(f, "%s", profile_report().c_str());
+    fclose(f);
+    return true;
+}
+
+/**
+ * Write each turn's time in each zone to filename as it ends, as tab
+ * separated microseconds of wall and CPU time.
+ */
+bool profile_trace_turns(const string &filename)
+{
+    profile_stop_trace();
+    _trace = fopen_u(filename.c_str(), "w");
+    if (!_trace)
+        return false;
+
+    fprintf(_trace, "turn");
+    for (const char *name : _zone_names)
+        fprintf(_trace, "\t%s_wall_us\t%s_cpu_us", name, name);
+    fprintf(_trace, "\n");
+    return true;
+}
+
+void profile_stop_trace()
+{
+    if (_trace)
+        fclose(_trace);
+    _trace = nullptr;
+}
+
+#ifdef WIZARD
+void wizard_profile_report()
+{
+    formatted_scroller report_scroller;
+    report_scroller.set_more();
+    report_scroller.add_raw_text(profile_report(), false);
+    report_scroller.show();
+
+    if (yesno("Reset the profile counters?", true, 'n'))
+    {
+        profile_reset();
+        mpr("Profile counters reset.");
+    }
+}
+#endif
+
+#endif
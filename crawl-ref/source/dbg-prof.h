@@ -0,0 +1,67 @@
+/**
+ * @file
+ * @brief Per-subsystem turn cost profiling.
+ *
+ * Only compiled in with DEBUG_PROFILE; otherwise PROFILE_SCOPE expands to
+ * nothing and the hooks below are empty inlines.
+**/
+
+#pragma once
+
+enum prof_zone
+{
+    PROF_WORLD_REACTS,
+    PROF_HANDLE_MONSTERS,
+    PROF_MONSTER_MOVE,
+    PROF_CLOUDS,
+    PROF_NOISES,
+    PROF_VIEWWINDOW,
+    PROF_LEVELGEN,
+    NUM_PROF_ZONES
+};
+
+#ifdef DEBUG_PROFILE
+
+#include <chrono>
+#include <ctime>
+
+// Times the enclosing block and charges it to a zone; subkey further
+// buckets the time (PROF_MONSTER_MOVE uses the monster type).
+class prof_scope
+{
+public:
+    prof_scope(prof_zone zone, int subkey = -1);
+    ~prof_scope();
+
+    prof_scope(const prof_scope&) = delete;
+    prof_scope &operator=(const prof_scope&) = delete;
+
+private:
+    prof_zone zone;
+    int subkey;
+    chrono::steady_clock::time_point start;
+    clock_t cpu_start;
+};
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_SCOPE(...) \
+    prof_scope PROFILE_CONCAT(_prof_scope_, __LINE__)(__VA_ARGS__)
+
+void profile_end_turn();
+void profile_reset();
+string profile_report();
+bool profile_dump(const string &filename);
+bool profile_trace_turns(const string &filename);
+void profile_stop_trace();
+#ifdef WIZARD
+void wizard_profile_report();
+#endif
+
+#else
+
+#define PROFILE_SCOPE(...) do {} while (false)
+
+static inline void profile_end_turn() {}
+
+#endif
@@ -11,6 +11,7 @@
 #include <cmath>
 #include <sstream>
 
+#include "act-iter.h"
 #include "artefact.h"
 #include "branch.h"
 #include "chardump.h"
@@ -336,6 +337,12 @@ void debug_mons_scan()
                               m->type, pos.x, pos.y, i);
         }
 
+        if (!monster_slot_noted(i))
+        {
+            mprf(MSGCH_ERROR, "Unlisted monster: %s at (%d, %d), midx = %d",
+                 m->full_name(DESC_PLAIN).c_str(), pos.x, pos.y, i);
+        }
+
         if (!in_bounds(pos))
         {
             mprf(MSGCH_ERROR, "Out of bounds monster: %s at (%d, %d), "
@@ -10,6 +10,10 @@
 #if defined(UNIX) || defined(TARGET_COMPILER_MINGW)
 #include <unistd.h>
 #endif
+#ifdef TARGET_OS_LINUX
+#include <fcntl.h>
+#include <sys/inotify.h>
+#endif
 
 #include "files.h"
 #include "initfile.h"
@@ -23,6 +27,69 @@
 
 static struct stat mfilestat;
 
+#ifdef TARGET_OS_LINUX
+// An inotify watch on the message file's directory (the file itself may
+// come and go), so that the file is only looked at after something has
+// happened to it. -1 if there's no watch, and the file has to be polled.
+static int _watch_fd = -1;
+static bool _watch_tried = false;
+
+static void _start_watch()
+{
+    _watch_tried = true;
+    _watch_fd = inotify_init();
+    if (_watch_fd < 0)
+        return;
+    fcntl(_watch_fd, F_SETFL, fcntl(_watch_fd, F_GETFL) | O_NONBLOCK);
+    fcntl(_watch_fd, F_SETFD, FD_CLOEXEC);
+
+    string dir = get_parent_directory(SysEnv.messagefile);
+    if (dir.empty())
+        dir = ".";
+    if (inotify_add_watch(_watch_fd, dir.c_str(),
+                          IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE
+                          | IN_MOVED_TO | IN_ATTRIB) < 0)
+    {
+        close(_watch_fd);
+        _watch_fd = -1;
+    }
+}
+
+// Whether the message file may have changed since the last call.
+static bool _message_file_touched()
+{
+    if (!_watch_tried)
+    {
+        _start_watch();
+        // Messages may have arrived before the watch did.
+        return true;
+    }
+    if (_watch_fd < 0)
+        return true;
+
+    const string name = get_base_filename(SysEnv.messagefile);
+    bool touched = false;
+    alignas(inotify_event) char buf[4096];
+    ssize_t len;
+    while ((len = read(_watch_fd, buf, sizeof(buf))) > 0)
+    {
+        for (char *p = buf; p < buf + len;)
+        {
+            const inotify_event *ev = (const inotify_event *) p;
+            if (ev->mask & IN_Q_OVERFLOW || ev->len && name == ev->name)
+                touched = true;
+            p += sizeof(inotify_event) + ev->len;
+        }
+    }
+    return touched;
+}
+#else
+static bool _message_file_touched()
+{
+    return true;
+}
+#endif
+
 static void _show_message_line(string line)
 {
     const string::size_type sender_pos = line.find(":");
@@ -139,6 +206,9 @@ void check_messages()
         return;
     }
 
+    if (!_message_file_touched())
+        return;
+
     const bool had_messages = SysEnv.have_messages;
     struct stat st;
     if (stat(SysEnv.messagefile.c_str(), &st))
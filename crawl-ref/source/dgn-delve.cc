@@ -132,31 +132,36 @@ static void _digcell(map_lines *map, store_type& store, coord_def c)
     }
 }
 
-// Count dug out neighbours.
-static int ngb_count(map_lines *map, coord_def c)
+// Which neighbours are dug out: bit d is set for Compass[d]. Both counts
+// below come from this, so each neighbour is only looked at once.
+static unsigned int _dug_neighbours(map_lines *map, coord_def c)
 {
     ASSERT(_in_map(map, c));
 
-    int cnt = 0;
+    unsigned int dug = 0;
     for (unsigned int d = 0; d < 8; d++)
-    {
-        coord_def neigh = c + Compass[d];
-        if (_dug(map, neigh))
-            cnt++;
-    }
+        if (_dug(map, c + Compass[d]))
+            dug |= 1 << d;
+    return dug;
+}
+
+// Count dug out neighbours.
+static int ngb_count(unsigned int dug)
+{
+    int cnt = 0;
+    for (; dug; dug &= dug - 1)
+        cnt++;
     return cnt;
 }
 
 // Count disjoint groups of dug out neighbours.
-static int ngb_groups(map_lines *map, coord_def c)
+static int ngb_groups(unsigned int dug)
 {
-    ASSERT(_in_map(map, c));
-
-    bool prev2 = 0, prev = _dug(map, c + Compass[0]);
+    bool prev2 = 0, prev = dug & 1;
     int cnt = 0;
     for (int d = 7; d >= 0; d--)
     {
-        bool cur = _dug(map, c + Compass[d]);
+        bool cur = dug >> d & 1;
         // Diagonal connectivity counts, too -- but only cardinal directions
         // (even Compass indices) can reach their predecessors.
         if (cur && !prev && (d&1 || !prev2))
@@ -270,9 +275,12 @@ retry:
         if (!_diggable(map, c))
             continue;
 
+        // Only work out the neighbours of cells close enough to matter.
+        const unsigned int dug = (c - center).abs() > 2
+                                 ? 0 : _dug_neighbours(map, c);
         if ((c - center).abs() > 2
-            || ngb_count(map, c) > ngb_max
-            || (ngb_groups(map, c) > 1 && !x_chance_in_y(connchance, 100)))
+            || ngb_count(dug) > ngb_max
+            || (ngb_groups(dug) > 1 && !x_chance_in_y(connchance, 100)))
         {
             // Original algorithm:
             // * ignore ngb_min
@@ -296,10 +304,11 @@ retry:
         if (!_diggable(map, c))
             continue;
 
-        int ngbcount = ngb_count(map, c);
+        const unsigned int dug = _dug_neighbours(map, c);
+        int ngbcount = ngb_count(dug);
 
         if (ngbcount < ngb_min || ngbcount > ngb_max
-            || (ngb_groups(map, c) > 1 && !x_chance_in_y(connchance, 100)))
+            || (ngb_groups(dug) > 1 && !x_chance_in_y(connchance, 100)))
         {
             continue;
         }
@@ -40,6 +40,16 @@ bool dgn_event_dispatcher::has_listeners_at(const coord_def &pos) const
     return grid_triggers[pos.x][pos.y].get();
 }
 
+// Listeners may add or remove listeners while being notified, so go
+// through a copy of the list. A vector is one allocation, rather than one
+// per listener.
+static vector<dgn_event_listener*> _listener_snapshot(
+    const dgn_square_alarm &alarm)
+{
+    return vector<dgn_event_listener*>(alarm.listeners.begin(),
+                                       alarm.listeners.end());
+}
+
 bool dgn_event_dispatcher::fire_vetoable_position_event(
     dgn_event_type et, const coord_def &pos)
 {
@@ -53,8 +63,7 @@ bool dgn_event_dispatcher::fire_vetoable_position_event(
     dgn_square_alarm *alarm = grid_triggers[pos.x][pos.y].get();
     if (alarm && (alarm->eventmask & et.type))
     {
-        dgn_square_alarm alcopy(*alarm);
-        for (auto listener : alcopy.listeners)
+        for (auto listener : _listener_snapshot(*alarm))
             if (!listener->notify_dgn_event(et))
                 return false;
     }
@@ -74,8 +83,7 @@ void dgn_event_dispatcher::fire_position_event(
     dgn_square_alarm *alarm = grid_triggers[pos.x][pos.y].get();
     if (alarm && (alarm->eventmask & et.type))
     {
-        dgn_square_alarm alcopy = *alarm;
-        for (auto listener : alcopy.listeners)
+        for (auto listener : _listener_snapshot(*alarm))
             listener->notify_dgn_event(et);
     }
 }
@@ -155,7 +163,13 @@ void dgn_event_dispatcher::remove_listener_at(const coord_def &pos,
                                               dgn_event_listener *listener)
 {
     if (dgn_square_alarm *alarm = grid_triggers[pos.x][pos.y].get())
+    {
         erase_val(alarm->listeners, listener);
+        // With nobody left listening, moves onto the square needn't look
+        // any further than the empty slot.
+        if (alarm->listeners.empty())
+            grid_triggers[pos.x][pos.y].reset(nullptr);
+    }
 }
 
 /////////////////////////////////////////////////////////////////////////////
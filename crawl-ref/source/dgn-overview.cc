@@ -80,6 +80,7 @@ static string _get_shops(bool display);
 static string _get_portals();
 static string _get_notes(bool display);
 static string _print_altars_for_gods(const vector<god_type>& gods,
+                                     const set<god_type>& seen,
                                      bool print_unseen, bool display);
 static const string _get_coloured_level_annotation(level_id li);
 
@@ -193,34 +194,38 @@ int overview_knows_num_portals(dungeon_feature_type portal)
 
 static string _portals_description_string()
 {
+    // Sort the portals by where they lead first, rather than looking through
+    // all of them for each branch.
+    vector<const level_pos *> by_branch[NUM_BRANCHES];
+    for (const auto &entry : portals_present)
+        if (entry.second >= 0 && entry.second < NUM_BRANCHES)
+            by_branch[entry.second].push_back(&entry.first);
+
     string disp;
     level_id    last_id;
     for (branch_iterator it; it; ++it)
     {
         last_id.depth = 10000;
-        for (const auto &entry : portals_present)
+        for (const level_pos *pos : by_branch[it->id])
         {
             // one line per region should be enough, they're all of the form
             // Branch:XX.
-            if (entry.second == it->id)
-            {
-                if (last_id.depth == 10000)
-                    disp += coloured_branch(entry.second)+ ":";
+            if (last_id.depth == 10000)
+                disp += coloured_branch(it->id)+ ":";
 
-                if (entry.first.id == last_id)
-                    disp += '*';
-                else
-                {
-                    disp += ' ';
-                    disp += entry.first.id.describe(false, true);
-                }
-                last_id = entry.first.id;
-
-                // Portals notes (Trove price).
-                const string note = portal_notes[entry.first];
-                if (!note.empty())
-                    disp += " (" + note + ")";
+            if (pos->id == last_id)
+                disp += '*';
+            else
+            {
+                disp += ' ';
+                disp += pos->id.describe(false, true);
             }
+            last_id = pos->id;
+
+            // Portals notes (Trove price).
+            const string *note = map_find(portal_notes, *pos);
+            if (note && !note->empty())
+                disp += " (" + *note + ")";
         }
         if (last_id.depth != 10000)
             disp += "\n";
@@ -401,14 +406,20 @@ static string _get_altars(bool display)
                 "<white>?/g</white> for information about gods)";
     }
     disp += "\n";
-    disp += _print_altars_for_gods(temple_god_list(), true, display);
-    disp += _print_altars_for_gods(nontemple_god_list(), false, display);
+
+    set<god_type> seen;
+    for (const auto &entry : altars_present)
+        seen.insert(entry.second);
+
+    disp += _print_altars_for_gods(temple_god_list(), seen, true, display);
+    disp += _print_altars_for_gods(nontemple_god_list(), seen, false, display);
 
     return disp;
 }
 
 // Loops through gods, printing their altar status by colour.
 static string _print_altars_for_gods(const vector<god_type>& gods,
+                                     const set<god_type>& seen,
                                      bool print_unseen, bool display)
 {
     string disp;
@@ -419,16 +430,7 @@ static string _print_altars_for_gods(const vector<god_type>& gods,
 
     for (const god_type god : gods)
     {
-        // for each god, look through the notable altars list for a match
-        bool has_altar_been_seen = false;
-        for (const auto &entry : altars_present)
-        {
-            if (entry.second == god)
-            {
-                has_altar_been_seen = true;
-                break;
-            }
-        }
+        const bool has_altar_been_seen = seen.count(god);
 
         // If dumping, only laundry list the seen gods
         if (!display)
@@ -567,13 +569,26 @@ static string _get_notes(bool display)
 {
     string disp;
 
+    // Only branches with some note are worth going through level by level.
+    set<branch_type> noted;
+    for (const annotation_map_type *notes
+             : { &level_annotations, &level_exclusions, &level_uniques })
+    {
+        for (const auto &entry : *notes)
+            noted.insert(entry.first.branch);
+    }
+
     for (branch_iterator it; it; ++it)
+    {
+        if (!noted.count(it->id))
+            continue;
         for (int d = 1; d <= brdepth[it->id]; ++d)
         {
             level_id i(it->id, d);
             if (!get_level_annotation(i).empty())
                 disp += _get_coloured_level_annotation(i) + "\n";
         }
+    }
 
     if (disp.empty())
         return disp;
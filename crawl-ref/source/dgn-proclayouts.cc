@@ -61,13 +61,44 @@ DiamondLayout::operator()(const coord_def &p, const uint32_t offset) const
     return ProceduralSample(p, DNGN_FLOOR, offset + 4096);
 }
 
+void ProceduralLayout::sample(const vector<coord_def> &ps,
+                              const uint32_t offset,
+                              vector<ProceduralSample> &out) const
+{
+    out.clear();
+    out.reserve(ps.size());
+    for (const coord_def &p : ps)
+        out.push_back((*this)(p, offset));
+}
+
+// Sample the points that a layout passes on to another (those at indices
+// in passed) as one batch, and fill in their samples in out.
+static void _sample_passed(const ProceduralLayout &layout,
+                           const vector<coord_def> &ps,
+                           const vector<size_t> &passed,
+                           const uint32_t offset,
+                           vector<ProceduralSample> &out)
+{
+    if (passed.empty())
+        return;
+    vector<coord_def> pass_ps;
+    pass_ps.reserve(passed.size());
+    for (size_t i : passed)
+        pass_ps.push_back(ps[i]);
+    vector<ProceduralSample> samples;
+    layout.sample(pass_ps, offset, samples);
+    for (size_t j = 0; j < passed.size(); ++j)
+        out[passed[j]] = samples[j];
+}
+
 static uint32_t _get_changepoint(const worley::noise_datum &n, const double scale)
 {
     return max(1, (int) floor((n.distance[1] - n.distance[0]) * scale) - 5);
 }
 
-ProceduralSample
-WorleyLayout::operator()(const coord_def &p, const uint32_t offset) const
+// Which of the layouts p falls in, and where to sample it.
+int WorleyLayout::_choose(const coord_def &p, const uint32_t offset,
+                          coord_def &pd, uint32_t &changepoint) const
 {
     const double offset_scale = 5000.0;
     double x = p.x / scale;
@@ -75,20 +106,60 @@ WorleyLayout::operator()(const coord_def &p, const uint32_t offset) const
     double z = offset / offset_scale;
     worley::noise_datum n = worley::noise(x, y, z + seed);
 
-    const uint32_t changepoint = offset + _get_changepoint(n, offset_scale);
+    changepoint = offset + _get_changepoint(n, offset_scale);
     const uint8_t size = layouts.size();
     bool parity = n.id[0] % 4;
     uint32_t id = n.id[0] / 4;
     const uint8_t choice = parity
         ? id % size
         : min(id % size, (id / size) % size);
-    const coord_def pd = p + id;
-    ProceduralSample sample = (*layouts[(choice + seed) % size])(pd, offset);
+    pd = p + id;
+    return (choice + seed) % size;
+}
+
+ProceduralSample
+WorleyLayout::operator()(const coord_def &p, const uint32_t offset) const
+{
+    coord_def pd;
+    uint32_t changepoint;
+    const int choice = _choose(p, offset, pd, changepoint);
+    ProceduralSample sample = (*layouts[choice])(pd, offset);
 
     return ProceduralSample(p, sample.feat(),
                 min(changepoint, sample.changepoint()));
 }
 
+void WorleyLayout::sample(const vector<coord_def> &ps, const uint32_t offset,
+                          vector<ProceduralSample> &out) const
+{
+    vector<vector<size_t>> chosen(layouts.size());
+    vector<vector<coord_def>> chosen_ps(layouts.size());
+    vector<uint32_t> changepoints(ps.size());
+    for (size_t i = 0; i < ps.size(); ++i)
+    {
+        coord_def pd;
+        const int choice = _choose(ps[i], offset, pd, changepoints[i]);
+        chosen[choice].push_back(i);
+        chosen_ps[choice].push_back(pd);
+    }
+
+    // Placeholders, until each layout has sampled its points.
+    out.assign(ps.size(), ProceduralSample(coord_def(), DNGN_FLOOR, 0));
+    vector<ProceduralSample> samples;
+    for (size_t l = 0; l < layouts.size(); ++l)
+    {
+        if (chosen[l].empty())
+            continue;
+        layouts[l]->sample(chosen_ps[l], offset, samples);
+        for (size_t j = 0; j < chosen[l].size(); ++j)
+        {
+            const size_t i = chosen[l][j];
+            out[i] = ProceduralSample(ps[i], samples[j].feat(),
+                        min(changepoints[i], samples[j].changepoint()));
+        }
+    }
+}
+
 ProceduralSample
 ChaosLayout::operator()(const coord_def &p, const uint32_t offset) const
 {
@@ -126,17 +197,19 @@ WastesLayout::operator()(const coord_def &p, const uint32_t offset) const
     return ProceduralSample(p, feat, min(sample.changepoint(), changepoint));
 }
 
-ProceduralSample
-RiverLayout::operator()(const coord_def &p, const uint32_t offset) const
+// The river feature at p, or DNGN_UNSEEN if p is left to the base layout.
+dungeon_feature_type RiverLayout::_river(const coord_def &p,
+                                         const uint32_t offset,
+                                         uint32_t &changepoint) const
 {
     const double scale = 10000;
     const double scalar = 90.0;
     double x = (p.x + perlin::fBM(p.x/4.0, p.y/4.0, seed, 5) * 3) / scalar;
     double y = (p.y + perlin::fBM(p.x/4.0 + 3.7, p.y/4.0 + 1.9, seed + 4, 5) * 3) / scalar;
     worley::noise_datum n = worley::noise(x, y, offset / scale + seed);
-    const uint32_t changepoint = offset + _get_changepoint(n, scale);
+    changepoint = offset + _get_changepoint(n, scale);
     if ((n.id[0] ^ n.id[1] ^ seed) % 4)
-        return layout(p, offset);
+        return DNGN_UNSEEN;
 
     double delta = n.distance[1] - n.distance[0];
     if (delta < 1.5/scalar)
@@ -147,9 +220,36 @@ RiverLayout::operator()(const coord_def &p, const uint32_t offset) const
             feat = DNGN_DEEP_WATER;
         if (!(hash % 23))
             feat = DNGN_TREE;
-        return ProceduralSample(p, feat, changepoint);
+        return feat;
     }
-    return layout(p, offset);
+    return DNGN_UNSEEN;
+}
+
+ProceduralSample
+RiverLayout::operator()(const coord_def &p, const uint32_t offset) const
+{
+    uint32_t changepoint;
+    const dungeon_feature_type feat = _river(p, offset, changepoint);
+    if (feat == DNGN_UNSEEN)
+        return layout(p, offset);
+    return ProceduralSample(p, feat, changepoint);
+}
+
+void RiverLayout::sample(const vector<coord_def> &ps, const uint32_t offset,
+                         vector<ProceduralSample> &out) const
+{
+    out.assign(ps.size(), ProceduralSample(coord_def(), DNGN_FLOOR, 0));
+    vector<size_t> passed;
+    for (size_t i = 0; i < ps.size(); ++i)
+    {
+        uint32_t changepoint;
+        const dungeon_feature_type feat = _river(ps[i], offset, changepoint);
+        if (feat == DNGN_UNSEEN)
+            passed.push_back(i);
+        else
+            out[i] = ProceduralSample(ps[i], feat, changepoint);
+    }
+    _sample_passed(layout, ps, passed, offset, out);
 }
 
 ProceduralSample
@@ -280,6 +380,22 @@ LevelLayout::operator()(const coord_def &p, const uint32_t offset) const
     return ProceduralSample(p, feat, offset + 4096);
 }
 
+void LevelLayout::sample(const vector<coord_def> &ps, const uint32_t offset,
+                         vector<ProceduralSample> &out) const
+{
+    out.assign(ps.size(), ProceduralSample(coord_def(), DNGN_FLOOR, 0));
+    vector<size_t> passed;
+    for (size_t i = 0; i < ps.size(); ++i)
+    {
+        const dungeon_feature_type feat = grid(clip(ps[i]));
+        if (feat == DNGN_UNSEEN)
+            passed.push_back(i);
+        else
+            out[i] = ProceduralSample(ps[i], feat, offset + 4096);
+    }
+    _sample_passed(layout, ps, passed, offset, out);
+}
+
 ProceduralSample
 NoiseLayout::operator()(const coord_def &p, const uint32_t offset) const
 {
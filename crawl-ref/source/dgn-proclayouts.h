@@ -58,6 +58,11 @@ class ProceduralLayout
     public:
         virtual ProceduralSample operator()(const coord_def &p,
             const uint32_t offset = 0) const = 0;
+        // Sample all of ps, with out[i] the sample for ps[i]. Layouts that
+        // hand points on to other layouts override this, so that those get
+        // whole batches of points instead of one at a time.
+        virtual void sample(const vector<coord_def> &ps, const uint32_t offset,
+                            vector<ProceduralSample> &out) const;
         virtual ~ProceduralLayout() { }
 };
 
@@ -101,7 +106,12 @@ class WorleyLayout : public ProceduralLayout
             seed(_seed), layouts(_layouts), scale(_scale) {}
         ProceduralSample operator()(const coord_def &p,
             const uint32_t offset = 0) const override;
+        void sample(const vector<coord_def> &ps, const uint32_t offset,
+                    vector<ProceduralSample> &out) const override;
     private:
+        int _choose(const coord_def &p, const uint32_t offset, coord_def &pd,
+                    uint32_t &changepoint) const;
+
         const uint32_t seed;
         const vector<const ProceduralLayout*> layouts;
         const float scale;
@@ -154,7 +164,12 @@ class RiverLayout : public ProceduralLayout
             seed(_seed), layout(_layout) {}
         ProceduralSample operator()(const coord_def &p,
             const uint32_t offset = 0) const override;
+        void sample(const vector<coord_def> &ps, const uint32_t offset,
+                    vector<ProceduralSample> &out) const override;
     private:
+        dungeon_feature_type _river(const coord_def &p, const uint32_t offset,
+                                    uint32_t &changepoint) const;
+
         const uint32_t seed;
         const ProceduralLayout &layout;
 };
@@ -179,6 +194,8 @@ class LevelLayout : public ProceduralLayout
             const ProceduralLayout &_layout);
         ProceduralSample operator()(const coord_def &p,
             const uint32_t offset = 0) const override;
+        void sample(const vector<coord_def> &ps, const uint32_t offset,
+                    vector<ProceduralSample> &out) const override;
     private:
         feature_grid grid;
         uint32_t seed;
@@ -28,6 +28,8 @@
 static const char *PROPS_SHOALS_TIDE_KEY = "shoals-tide-height";
 static const char *PROPS_SHOALS_TIDE_VEL = "shoals-tide-velocity";
 static const char *PROPS_SHOALS_TIDE_UPDATE_TIME = "shoals-tide-update-time";
+// The level's tide_seed marker positions, found once per level.
+static const char *PROPS_SHOALS_TIDE_SEEDS = "shoals-tide-seeds";
 
 static dgn_island_plan _shoals_islands;
 
@@ -905,9 +907,28 @@ static int _shoals_tide_at(coord_def pos, int base_tide)
     return base_tide + max(0, tide_called_peak - pos.rdist() * 3);
 }
 
+// Finding markers by property asks every cell of the level, so remember
+// where the seeds are. They come from vaults, and don't move.
 static vector<coord_def> _shoals_extra_tide_seeds()
 {
-    return find_marker_positions_by_prop("tide_seed");
+    // The level may still be thrown away.
+    if (crawl_state.generating_level)
+        return find_marker_positions_by_prop("tide_seed");
+
+    if (!env.properties.exists(PROPS_SHOALS_TIDE_SEEDS))
+    {
+        CrawlVector &seeds
+            = env.properties[PROPS_SHOALS_TIDE_SEEDS].new_vector(SV_COORD);
+        for (const coord_def &c : find_marker_positions_by_prop("tide_seed"))
+            seeds.push_back(c);
+    }
+
+    vector<coord_def> seeds;
+    const CrawlVector &saved
+        = env.properties[PROPS_SHOALS_TIDE_SEEDS].get_vector();
+    for (const auto &seed : saved)
+        seeds.push_back(seed.get_coord());
+    return seeds;
 }
 
 static void _shoals_apply_tide(int tide)
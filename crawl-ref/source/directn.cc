@@ -1257,19 +1257,41 @@ void direction_chooser::draw_beam(crawl_view_buffer &vbuf)
     // Use the new API if implemented.
     if (hitfunc)
     {
-        if (behaviour->targeted() && !hitfunc->set_aim(target()))
-            return;
-        const los_type los = hitfunc->can_affect_unseen()
-                                            ? LOS_NONE : LOS_DEFAULT;
-        for (radius_iterator ri(you.pos(), los); ri; ++ri)
+        const coord_def aim = behaviour->targeted() ? target()
+                                                    : hitfunc->aim;
+        auto preview = aff_preview.find(aim);
+        // Asking about every cell in view is slow for some targeters, and
+        // redraws come far more often than the aim changes. Aiming again
+        // is still needed if it was left somewhere else, as callers use
+        // the targeter as drawing leaves it.
+        if (preview == aff_preview.end() || hitfunc->aim != aim)
+        {
+            if (behaviour->targeted() && !hitfunc->set_aim(target()))
+                return;
+        }
+        if (preview == aff_preview.end())
         {
-            aff_type aff = hitfunc->is_affected(*ri);
-            if (aff
-                && (!feat_is_solid(env.grid(*ri)) || hitfunc->can_affect_walls()))
+            vector<pair<coord_def, int>> cells;
+            const los_type los = hitfunc->can_affect_unseen()
+                                                ? LOS_NONE : LOS_DEFAULT;
+            for (radius_iterator ri(you.pos(), los); ri; ++ri)
             {
-                auto& cell = vbuf(grid2view(*ri) - 1);
-                _draw_ray_cell(cell, *ri, *ri == target(), aff);
+                aff_type aff = hitfunc->is_affected(*ri);
+                if (aff
+                    && (!feat_is_solid(env.grid(*ri))
+                        || hitfunc->can_affect_walls()))
+                {
+                    cells.emplace_back(*ri, aff);
+                }
             }
+            preview = aff_preview.emplace(aim, move(cells)).first;
+        }
+
+        for (const auto &entry : preview->second)
+        {
+            auto& cell = vbuf(grid2view(entry.first) - 1);
+            _draw_ray_cell(cell, entry.first, entry.first == target(),
+                           static_cast<aff_type>(entry.second));
         }
 
         return;
@@ -2733,8 +2755,15 @@ static bool _mons_is_valid_target(const monster* mon, targ_mode_type mode,
 static bool _want_target_monster(const monster *mon, targ_mode_type mode,
                                  targeter* hitfunc)
 {
-    if (hitfunc && !hitfunc->affects_monster(monster_info(mon)))
-        return false;
+    if (hitfunc)
+    {
+        const monster_info *mi = viewed_monster_info(*mon);
+        if (mi ? !hitfunc->affects_monster(*mi)
+               : !hitfunc->affects_monster(monster_info(mon)))
+        {
+            return false;
+        }
+    }
     switch (mode)
     {
     case TARG_ANY:
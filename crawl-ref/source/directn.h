@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <map>
 #include <vector>
 
 #include "command-type.h"
@@ -273,6 +274,9 @@ private:
     ray_def beam;               // The (possibly invalid) beam.
     bool show_beam;             // Does the user want the beam displayed?
     bool have_beam;             // Is the currently stored beam valid?
+    // The cells hitfunc affects (and how, as aff_types) for each aim point
+    // drawn so far. Nothing moves while choosing, so they don't change.
+    map<coord_def, vector<pair<coord_def, int>>> aff_preview;
     coord_def objfind_pos, monsfind_pos; // Cycling memory
 
     // What we need to redraw.
@@ -28,6 +28,7 @@
 #include "describe.h"
 #include "directn.h"
 #include "dbg-maps.h"
+#include "dbg-prof.h"
 #include "dbg-scan.h"
 #include "dgn-delve.h"
 #include "dgn-height.h"
@@ -271,6 +272,7 @@ int dgn_builder_y()
  *********************************************************************/
 bool builder(bool enable_random_maps)
 {
+    PROFILE_SCOPE(PROF_LEVELGEN);
 #ifndef DEBUG_FULL_DUNGEON_SPAM
     // hide builder debug spam by default -- this is still collected by a tee
     // and accessible via &ctrl-l without this #define.
@@ -432,6 +434,9 @@ bool builder(bool enable_random_maps)
     return false;
 }
 
+// Which part of the build we're in, for the veto statistics.
+static const char *dgn_build_stage = "setup";
+
 void dgn_record_veto(const dgn_veto_exception &e)
 {
     string error = make_stringf("%s: %s",
@@ -442,7 +447,7 @@ void dgn_record_veto(const dgn_veto_exception &e)
     dprf(DIAG_DNGN, "<white>VETO</white>: %s", error.c_str());
 
 #ifdef DEBUG_STATISTICS
-    mapstat_report_map_veto(e.what());
+    mapstat_report_map_veto(e.what(), dgn_build_stage);
 #endif
 
 }
@@ -454,6 +459,7 @@ static bool _build_level_vetoable(bool enable_random_maps)
 #endif
 
     dgn_reset_level(enable_random_maps);
+    dgn_build_stage = "setup";
 
     if (player_in_branch(BRANCH_TEMPLE))
         _setup_temple_altars(you.props);
@@ -940,54 +946,78 @@ static bool _dgn_square_is_ever_passable(const coord_def &c)
     return _dgn_square_is_passable(c);
 }
 
-static inline void _dgn_point_record_stub(const coord_def &) { }
+struct dgn_zone
+{
+    int size = 0;
+    bool wanted = false; // whether any square passed iswanted
+};
 
-template <class point_record>
-static bool _dgn_fill_zone(
-    const coord_def &start, int zone,
-    point_record &record_point,
+static int _dgn_zone_root(vector<int> &parent, int i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// Sets travel_point_distance to the number of the (8-way connected) zone
+// of passable squares each square is in, or 0 if it isn't passable. Zones
+// are numbered from 1 in the order of their first square, scanning by rows.
+// Returns the zones, indexed by number (zones[0] is unused).
+//
+// This is a union-find over a single scan, rather than a flood fill for
+// each zone, as it runs after every vault placement.
+static vector<dgn_zone> _dgn_label_zones(
     bool (*passable)(const coord_def &) = _dgn_square_is_passable,
     bool (*iswanted)(const coord_def &) = nullptr)
 {
-    bool ret = false;
-    list<coord_def> points[2];
-    int cur = 0;
-    int found_points = 0;
-
-    // No bounds checks, assuming the level has at least one layer of
-    // rock border.
-
-    for (points[cur].push_back(start); !points[cur].empty();)
+    // Squares are indexed by rows, and each zone's root is the square in
+    // it that comes first.
+    vector<int> parent(GXM * GYM, -1);
+    const coord_def earlier[] =
     {
-        for (const auto &c : points[cur])
+        coord_def(-1, 0), coord_def(-1, -1), coord_def(0, -1), coord_def(1, -1)
+    };
+    for (int y = 0; y < GYM; ++y)
+        for (int x = 0; x < GXM; ++x)
         {
-            travel_point_distance[c.x][c.y] = zone;
-            found_points++;
-
-            if (iswanted && iswanted(c))
-                ret = true;
-
-            for (adjacent_iterator ai(c); ai; ++ai)
+            const coord_def c(x, y);
+            if (!map_bounds(c) || !passable(c))
+                continue;
+            const int i = y * GXM + x;
+            parent[i] = i;
+            for (const coord_def &delta : earlier)
             {
-                const coord_def& cp = *ai;
-                if (!map_bounds(cp)
-                    || travel_point_distance[cp.x][cp.y] || !passable(cp))
-                {
+                const coord_def n = c + delta;
+                if (!map_bounds(n) || parent[n.y * GXM + n.x] < 0)
                     continue;
-                }
-
-                travel_point_distance[cp.x][cp.y] = zone;
-                record_point(cp);
-                points[!cur].push_back(cp);
+                const int a = _dgn_zone_root(parent, i);
+                const int b = _dgn_zone_root(parent, n.y * GXM + n.x);
+                parent[max(a, b)] = min(a, b);
             }
         }
 
-        points[cur].clear();
-        cur = !cur;
-    }
-    dprf("Zone %d contains %d points from seed %d,%d", zone, found_points,
-        start.x, start.y);
-    return ret;
+    memset(travel_point_distance, 0, sizeof(travel_distance_grid_t));
+    vector<dgn_zone> zones(1);
+    for (int y = 0; y < GYM; ++y)
+        for (int x = 0; x < GXM; ++x)
+        {
+            const int i = y * GXM + x;
+            if (parent[i] < 0)
+                continue;
+            const int root = _dgn_zone_root(parent, i);
+            if (root == i)
+                zones.emplace_back();
+            const int zone = root == i ? zones.size() - 1
+                : travel_point_distance[root % GXM][root / GXM];
+            travel_point_distance[x][y] = zone;
+            zones[zone].size++;
+            if (iswanted && !zones[zone].wanted && iswanted(coord_def(x, y)))
+                zones[zone].wanted = true;
+        }
+    return zones;
 }
 
 static bool _is_perm_down_stair(const coord_def &c)
@@ -1094,92 +1124,76 @@ static bool _is_exit_stair(const coord_def &c)
 // If fill is non-zero, it fills any disconnected regions with fill.
 //
 // TODO: refactor this to something more usable
-static int _process_disconnected_zones(int x1, int y1, int x2, int y2,
-                bool choose_stairless,
+static int _process_disconnected_zones(bool choose_stairless,
                 dungeon_feature_type fill,
                 bool (*passable)(const coord_def &) = _dgn_square_is_passable,
                 bool (*fill_check)(const coord_def &) = nullptr,
                 int fill_small_zones = 0)
 {
-    memset(travel_point_distance, 0, sizeof(travel_distance_grid_t));
-    int nzones = 0;
+    const vector<dgn_zone> zones = _dgn_label_zones(passable,
+        choose_stairless ? (at_branch_bottom() ? _is_upwards_exit_stair
+                                               : _is_exit_stair)
+                         : nullptr);
+    const int nzones = zones.size() - 1;
     int ngood = 0;
-    for (int y = y1; y <= y2 ; ++y)
-    {
-        for (int x = x1; x <= x2; ++x)
-        {
-            if (!map_bounds(x, y)
-                || travel_point_distance[x][y]
-                || !passable(coord_def(x, y)))
-            {
-                continue;
-            }
-
-            int zone_size = 0;
-            auto inc_zone_size = [&zone_size](const coord_def &) { zone_size++; };
-
-            const bool found_exit_stair =
-                _dgn_fill_zone(coord_def(x, y), ++nzones,
-                               inc_zone_size,
-                               passable,
-                               choose_stairless ? (at_branch_bottom() ?
-                                                   _is_upwards_exit_stair :
-                                                   _is_exit_stair) : nullptr);
-
-            // If we want only stairless zones, screen out zones that did
-            // have stairs.
-            if (choose_stairless && found_exit_stair)
-                ++ngood;
-            else if (fill
-                && (fill_small_zones <= 0 || zone_size <= fill_small_zones))
+    for (int zone = 1; zone <= nzones; ++zone)
+    {
+        // This used to count every square but the first.
+        const int zone_size = zones[zone].size - 1;
+
+        // If we want only stairless zones, screen out zones that did
+        // have stairs.
+        if (choose_stairless && zones[zone].wanted)
+            ++ngood;
+        else if (fill
+            && (fill_small_zones <= 0 || zone_size <= fill_small_zones))
+        {
+            // Don't fill in areas connected to vaults.
+            // We want vaults to be accessible; if the area is disconneted
+            // from the rest of the level, this will cause the level to be
+            // vetoed later on.
+            bool veto = false;
+            vector<coord_def> coords;
+            dprf("Filling zone %d", zone);
+            for (int fy = 0; fy < GYM; ++fy)
             {
-                // Don't fill in areas connected to vaults.
-                // We want vaults to be accessible; if the area is disconneted
-                // from the rest of the level, this will cause the level to be
-                // vetoed later on.
-                bool veto = false;
-                vector<coord_def> coords;
-                dprf("Filling zone %d", nzones);
-                for (int fy = y1; fy <= y2 ; ++fy)
+                for (int fx = 0; fx < GXM; ++fx)
                 {
-                    for (int fx = x1; fx <= x2; ++fx)
+                    if (travel_point_distance[fx][fy] == zone)
                     {
-                        if (travel_point_distance[fx][fy] == nzones)
+                        if (map_masked(coord_def(fx, fy), MMT_VAULT))
                         {
-                            if (map_masked(coord_def(fx, fy), MMT_VAULT))
-                            {
-                                veto = true;
-                                break;
-                            }
-                            else if (!fill_check || fill_check(coord_def(fx, fy)))
-                                coords.emplace_back(fx, fy);
+                            veto = true;
+                            break;
                         }
+                        else if (!fill_check || fill_check(coord_def(fx, fy)))
+                            coords.emplace_back(fx, fy);
                     }
-                    if (veto)
-                        break;
                 }
-                if (!veto)
+                if (veto)
+                    break;
+            }
+            if (!veto)
+            {
+                for (auto c : coords)
                 {
-                    for (auto c : coords)
+                    // For normal builder scenarios items shouldn't be
+                    // placed yet, but it could (if not careful) happen
+                    // in weirder cases, such as the abyss.
+                    if (env.igrid(c) != NON_ITEM
+                        && (!feat_is_traversable(fill)
+                            || feat_destroys_items(fill)))
                     {
-                        // For normal builder scenarios items shouldn't be
-                        // placed yet, but it could (if not careful) happen
-                        // in weirder cases, such as the abyss.
-                        if (env.igrid(c) != NON_ITEM
-                            && (!feat_is_traversable(fill)
-                                || feat_destroys_items(fill)))
-                        {
-                            // Alternatively, could place floor instead?
-                            dprf("Nuke item stack at (%d, %d)", c.x, c.y);
-                            lose_item_stack(c);
-                        }
-                        _set_grd(c, fill);
-                        if (env.mgrid(c) != NON_MONSTER
-                            && !env.mons[env.mgrid(c)].is_habitable_feat(fill))
-                        {
-                            monster_die(env.mons[env.mgrid(c)],
-                                        KILL_RESET, NON_MONSTER, false, true);
-                        }
+                        // Alternatively, could place floor instead?
+                        dprf("Nuke item stack at (%d, %d)", c.x, c.y);
+                        lose_item_stack(c);
+                    }
+                    _set_grd(c, fill);
+                    if (env.mgrid(c) != NON_MONSTER
+                        && !env.mons[env.mgrid(c)].is_habitable_feat(fill))
+                    {
+                        monster_die(env.mons[env.mgrid(c)],
+                                    KILL_RESET, NON_MONSTER, false, true);
                     }
                 }
             }
@@ -1192,7 +1206,7 @@ static int _process_disconnected_zones(int x1, int y1, int x2, int y2,
 int dgn_count_tele_zones(bool choose_stairless)
 {
     dprf("Counting teleport zones");
-    return _process_disconnected_zones(0, 0, GXM-1, GYM-1, choose_stairless,
+    return _process_disconnected_zones(choose_stairless,
                                     DNGN_UNSEEN, _dgn_square_is_tele_connected);
 }
 
@@ -1202,7 +1216,7 @@ int dgn_count_tele_zones(bool choose_stairless)
 int dgn_count_disconnected_zones(bool choose_stairless,
                                  dungeon_feature_type fill)
 {
-    return _process_disconnected_zones(0, 0, GXM-1, GYM-1, choose_stairless,
+    return _process_disconnected_zones(choose_stairless,
                                        fill);
 }
 
@@ -1211,7 +1225,7 @@ static void _fill_small_disconnected_zones()
     // debugging tip: change the feature to something like lava that will be
     // very noticeable.
     // TODO: make even more agressive, up to ~25?
-    _process_disconnected_zones(0, 0, GXM-1, GYM-1, true, DNGN_ROCK_WALL,
+    _process_disconnected_zones(true, DNGN_ROCK_WALL,
                                        _dgn_square_is_passable,
                                        _dgn_square_is_boring,
                                        10);
@@ -1412,12 +1426,13 @@ static bool _ensure_vault_placed_ex(bool vault_success, const map_def *vault)
                                     vault->name);
 }
 
-static coord_def _find_level_feature(int feat)
+static coord_def _find_level_feature(dungeon_feature_type feat)
 {
-    for (rectangle_iterator ri(1); ri; ++ri)
+    ASSERT(feat_is_stair(feat));
+    for (const coord_def &c : level_stairs())
     {
-        if (env.grid(*ri) == feat)
-            return *ri;
+        if (env.grid(c) == feat && in_bounds(c))
+            return c;
     }
 
     return coord_def(0, 0);
@@ -1829,10 +1844,9 @@ static list<coord_def> _find_stone_stairs(bool up_stairs)
 {
     list<coord_def> stairs;
 
-    for (rectangle_iterator ri(1); ri; ++ri)
+    for (const coord_def &c : level_stairs())
     {
-        const coord_def& c = *ri;
-        if (feature_mimic_at(c))
+        if (!in_bounds(c) || feature_mimic_at(c))
             continue;
 
         const dungeon_feature_type feat = env.grid(c);
@@ -2113,88 +2127,76 @@ static bool _fixup_stone_stairs(bool preserve_vault_stairs)
 static bool _add_feat_if_missing(bool (*iswanted)(const coord_def &),
                                  dungeon_feature_type feat)
 {
-    memset(travel_point_distance, 0, sizeof(travel_distance_grid_t));
-    int nzones = 0;
-    for (int y = 0; y < GYM; ++y)
-        for (int x = 0; x < GXM; ++x)
-        {
-            // [ds] Use dgn_square_is_passable instead of
-            // dgn_square_travel_ok here, for we'll otherwise
-            // fail on floorless isolated pocket in vaults (like the
-            // altar surrounded by deep water), and trigger the assert
-            // downstairs.
-            const coord_def gc(x, y);
-            if (!map_bounds(x, y)
-                || travel_point_distance[x][y] // already covered previously
-                || !_dgn_square_is_passable(gc))
-            {
-                continue;
-            }
+    // [ds] Use dgn_square_is_passable instead of
+    // dgn_square_travel_ok here, for we'll otherwise
+    // fail on floorless isolated pocket in vaults (like the
+    // altar surrounded by deep water), and trigger the assert
+    // downstairs.
+    const vector<dgn_zone> zones = _dgn_label_zones(_dgn_square_is_passable,
+                                                    iswanted);
+    for (int zone = 1; zone < (int) zones.size(); ++zone)
+    {
+        if (zones[zone].wanted)
+            continue;
 
-            if (_dgn_fill_zone(gc, ++nzones, _dgn_point_record_stub,
-                               _dgn_square_is_passable, iswanted))
+        bool found_feature = false;
+        for (rectangle_iterator ri(0); ri; ++ri)
+        {
+            if (env.grid(*ri) == feat
+                && travel_point_distance[ri->x][ri->y] == zone)
             {
-                continue;
+                found_feature = true;
+                break;
             }
+        }
 
-            bool found_feature = false;
-            for (rectangle_iterator ri(0); ri; ++ri)
-            {
-                if (env.grid(*ri) == feat
-                    && travel_point_distance[ri->x][ri->y] == nzones)
-                {
-                    found_feature = true;
-                    break;
-                }
-            }
+        if (found_feature)
+            continue;
 
-            if (found_feature)
+        int i = 0;
+        while (i++ < 2000)
+        {
+            coord_def rnd;
+            rnd.x = random2(GXM);
+            rnd.y = random2(GYM);
+            if (env.grid(rnd) != DNGN_FLOOR)
                 continue;
 
-            int i = 0;
-            while (i++ < 2000)
-            {
-                coord_def rnd;
-                rnd.x = random2(GXM);
-                rnd.y = random2(GYM);
-                if (env.grid(rnd) != DNGN_FLOOR)
-                    continue;
+            if (travel_point_distance[rnd.x][rnd.y] != zone)
+                continue;
 
-                if (travel_point_distance[rnd.x][rnd.y] != nzones)
-                    continue;
+            _set_grd(rnd, feat);
+            found_feature = true;
+            break;
+        }
 
-                _set_grd(rnd, feat);
-                found_feature = true;
-                break;
-            }
+        if (found_feature)
+            continue;
 
-            if (found_feature)
+        for (rectangle_iterator ri(0); ri; ++ri)
+        {
+            if (env.grid(*ri) != DNGN_FLOOR)
                 continue;
 
-            for (rectangle_iterator ri(0); ri; ++ri)
-            {
-                if (env.grid(*ri) != DNGN_FLOOR)
-                    continue;
-
-                if (travel_point_distance[ri->x][ri->y] != nzones)
-                    continue;
+            if (travel_point_distance[ri->x][ri->y] != zone)
+                continue;
 
-                _set_grd(*ri, feat);
-                found_feature = true;
-                break;
-            }
+            _set_grd(*ri, feat);
+            found_feature = true;
+            break;
+        }
 
-            if (found_feature)
-                continue;
+        if (found_feature)
+            continue;
 
 #ifdef DEBUG_DIAGNOSTICS
-            dump_map("debug.map", true, true);
+        dump_map("debug.map", true, true);
 #endif
-            // [ds] Too many normal cases trigger this ASSERT, including
-            // rivers that surround a stair with deep water.
-            // die("Couldn't find region.");
-            return false;
-        }
+        // [ds] Too many normal cases trigger this ASSERT, including
+        // rivers that surround a stair with deep water.
+        // die("Couldn't find region.");
+        return false;
+    }
 
     return true;
 }
@@ -2672,11 +2674,14 @@ static void _post_vault_build()
 
 static void _build_dungeon_level()
 {
+    dgn_build_stage = "layout";
     bool place_vaults = _builder_by_type();
 
     if (player_in_branch(BRANCH_SLIME))
         _slime_connectivity_fixup();
 
+    dgn_build_stage = "vaults";
+
     // Now place items, mons, gates, etc.
     // Stairs must exist by this point (except in Shoals where they are
     // yet to be placed). Some items and monsters already exist.
@@ -2729,8 +2734,10 @@ static void _build_dungeon_level()
         _place_traps();
 
         // Any vault-placement activity must happen before this check.
+        dgn_build_stage = "connectivity";
         _dgn_verify_connectivity(nvaults);
 
+        dgn_build_stage = "population";
         _builder_monsters();
 
         // Place items.
@@ -2745,6 +2752,7 @@ static void _build_dungeon_level()
         _post_vault_build();
     }
 
+    dgn_build_stage = "stairs";
     // Translate stairs for pandemonium levels.
     if (player_in_branch(BRANCH_PANDEMONIUM))
         _fixup_pandemonium_stairs();
@@ -4549,13 +4557,13 @@ static const vault_placement *_build_vault_impl(const map_def *vault,
     if (!build_only && (placed_vault_orientation != MAP_ENCOMPASS || is_layout)
         && player_in_branch(BRANCH_SWAMP))
     {
-        _process_disconnected_zones(0, 0, GXM-1, GYM-1, true, DNGN_MANGROVE);
+        _process_disconnected_zones(true, DNGN_MANGROVE);
         // do a second pass to remove tele closets consisting of deep water
         // created by the first pass -- which will not fill in deep water
         // because it is treated as impassable.
         // TODO: get zonify to prevent these?
         // TODO: does this come up anywhere outside of swamp?
-        _process_disconnected_zones(0, 0, GXM-1, GYM-1, true, DNGN_MANGROVE,
+        _process_disconnected_zones(true, DNGN_MANGROVE,
                 _dgn_square_is_ever_passable);
     }
 
@@ -6762,20 +6770,7 @@ static bool _fixup_interlevel_connectivity()
     has_down[0] = has_down[1] = has_down[2] = false;
 
     // Find up stairs and down stairs on the current level.
-    memset(travel_point_distance, 0, sizeof(travel_distance_grid_t));
-    int nzones = 0;
-    for (rectangle_iterator ri(0); ri; ++ri)
-    {
-        if (!map_bounds(ri->x, ri->y)
-            || travel_point_distance[ri->x][ri->y]
-            || !dgn_square_travel_ok(*ri))
-        {
-            continue;
-        }
-
-        _dgn_fill_zone(*ri, ++nzones, _dgn_point_record_stub,
-                       dgn_square_travel_ok, nullptr);
-    }
+    _dgn_label_zones(dgn_square_travel_ok);
 
     int max_region = 0;
     for (rectangle_iterator ri(0); ri; ++ri)
@@ -14,6 +14,7 @@
 #include "colour.h"
 #include "crash.h"
 #include "database.h"
+#include "dbg-prof.h"
 #include "describe.h"
 #include "dungeon.h"
 #include "files.h"
@@ -21,6 +22,7 @@
 #include "god-passive.h"
 #include "ghost.h"
 #include "hints.h"
+#include "hiscores.h"
 #include "initfile.h"
 #include "invent.h"
 #include "item-prop.h"
@@ -168,7 +170,15 @@ bool CrawlIsCrashing = false;
 
 NORETURN void end(int exit_code, bool print_error, const char *format, ...)
 {
+    // A forked worker has nothing of its own to clean up, and mustn't tear
+    // down the terminal or webtiles connection that its parent is using.
+    // The parent will find out what went wrong for itself.
+    if (crawl_state.forked_worker)
+        _Exit(exit_code);
+
     disable_other_crashes();
+    flush_milestones(true);
+    finish_char_dump();
 
     // Let "error" go out of scope for valgrind's sake.
     {
@@ -198,12 +208,23 @@ NORETURN void end(int exit_code, bool print_error, const char *format, ...)
 #endif
 
         cio_cleanup();
+        if (crawl_state.startup_profile)
+            print_startup_profile();
         msg::deinitialise_mpr_streams();
         _clear_globals_on_exit();
         databaseSystemShutdown();
 #ifdef DEBUG_PROPS
         dump_prop_accesses();
 #endif
+#ifdef DEBUG_PROFILE
+        profile_stop_trace();
+        if (!SysEnv.profile_dump_file.empty()
+            && !profile_dump(SysEnv.profile_dump_file))
+        {
+            fprintf(stderr, "Couldn't write profile to %s\n",
+                    SysEnv.profile_dump_file.c_str());
+        }
+#endif
 
         if (!error.empty())
         {
@@ -316,19 +337,22 @@ NORETURN void end_game(scorefile_entry &se)
                         || death_type == KILLED_BY_WINNING
                         || death_type == KILLED_BY_LEAVING;
 
+    // The game a replay came from has already been scored.
+    const bool replay = !crawl_state.replay_journal.empty();
+
     int hiscore_index = -1;
-#ifndef SCORE_WIZARD_CHARACTERS
-    if (!you.wizard && !you.explore)
+#ifdef SCORE_WIZARD_CHARACTERS
+    if (!replay)
+#else
+    if (!you.wizard && !you.explore && !replay)
 #endif
     {
         // Add this highscore to the score file.
         hiscore_index = hiscores_new_entry(se);
         logfile_new_entry(se);
     }
-#ifndef SCORE_WIZARD_CHARACTERS
     else
         hiscores_read_to_memory();
-#endif
 
     // Never generate bones files of wizard or tutorial characters -- bwr
     if (!non_death && !crawl_state.game_is_tutorial() && !you.wizard)
@@ -441,7 +465,7 @@ NORETURN void end_game(scorefile_entry &se)
     }
 
     string fname = morgue_name(you.your_name, se.get_death_time());
-    if (!dump_char(fname, true, true, &se))
+    if (!dump_char(fname, true, true, &se, true))
         mpr("Char dump unsuccessful! Sorry about that.");
 #ifdef USE_TILE_WEB
     else
@@ -559,6 +583,9 @@ NORETURN void end_game(scorefile_entry &se)
 
 NORETURN void game_ended(game_exit exit, const string &message)
 {
+    flush_milestones(true);
+    finish_char_dump();
+
     if (crawl_state.marked_as_won &&
         (exit == game_exit::death || exit == game_exit::leave))
     {
@@ -4,6 +4,7 @@
 #include <memory> // unique_ptr
 #include <vector>
 
+#include "cell-map.h"
 #include "cloud.h"
 #include "coord.h"
 #include "fprop.h"
@@ -32,6 +33,8 @@ struct crawl_environment
 
     FixedVector< item_def, MAX_ITEMS >       item;  // item list
     FixedVector< monster, MAX_MONSTERS+2 >   mons;  // monster list, plus anon
+    vector<unsigned short>                   mons_used; // sorted slots of mons
+                                                        // that may be in use
 
     feature_grid                             grid;  // terrain grid
     FixedArray<terrain_property_t, GXM, GYM> pgrid; // terrain properties
@@ -61,10 +64,10 @@ struct crawl_environment
 
     vector<coord_def>                        travel_trail;
 
-    map<coord_def, cloud_struct> cloud;
+    cell_map<cloud_struct> cloud;
 
-    map<coord_def, shop_struct> shop; // shop list
-    map<coord_def, trap_def> trap; // trap list
+    cell_map<shop_struct> shop; // shop list
+    cell_map<trap_def> trap; // trap list
 
     FixedVector< monster_type, MAX_MONS_ALLOC > mons_alloc;
     map_markers                              markers;
@@ -17,7 +17,9 @@
 #include "english.h"
 #include "env.h"
 #include "hints.h"
+#include "job-pool.h"
 #include "libutil.h"
+#include "los.h"
 #include "mon-util.h"
 #include "options.h"
 #include "stringutil.h"
@@ -193,14 +195,14 @@ void exclude_set::erase(const coord_def &p)
     if (it == exclude_roots.end())
         return;
 
-    travel_exclude old_ex = it->second;
+    remove_exclude_points(it->second);
     exclude_roots.erase(it);
-
-    recompute_excluded_points();
 }
 
 void exclude_set::add_exclude(travel_exclude &ex)
 {
+    if (travel_exclude *old = map_find(exclude_roots, ex.pos))
+        remove_exclude_points(*old);
     add_exclude_points(ex);
     exclude_roots[ex.pos] = ex;
 }
@@ -213,47 +215,78 @@ void exclude_set::add_exclude(const coord_def &p, int radius,
     add_exclude(ex);
 }
 
+// Work out the cells ex covers, and add them to the set. An up to date
+// exclusion's los is used as it is.
 void exclude_set::add_exclude_points(travel_exclude& ex)
 {
+    ex.points.clear();
     if (ex.radius == 0)
+        ex.points.push_back(ex.pos);
+    else
     {
-        exclude_points.insert(ex.pos);
-        return;
+        if (!ex.uptodate)
+            ex.set_los();
+
+        for (radius_iterator ri(ex.pos, ex.radius, C_SQUARE); ri; ++ri)
+            if (ex.affects(*ri))
+                ex.points.push_back(*ri);
     }
 
-    if (!ex.uptodate)
-        ex.set_los();
-    else
-        ex.los.update();
+    for (const coord_def &p : ex.points)
+        ++exclude_points[p];
+}
+
+void exclude_set::remove_exclude_points(travel_exclude& ex)
+{
+    for (const coord_def &p : ex.points)
+    {
+        auto it = exclude_points.find(p);
+        ASSERT(it != exclude_points.end());
+        if (!--it->second)
+            exclude_points.erase(it);
+    }
+    ex.points.clear();
+}
 
-    for (radius_iterator ri(ex.pos, ex.radius, C_SQUARE); ri; ++ri)
-        if (ex.affects(*ri))
-            exclude_points.insert(*ri);
+// Work out the los of several exclusions at once. Each only reads the map
+// and writes to its own exclusion, so they can go in parallel.
+void exclude_set::set_los(const vector<travel_exclude *> &exs)
+{
+    // The ray tables are otherwise built on first use, which mustn't happen
+    // in several jobs at once; this can be the first LOS of a restored game.
+    los_precompute();
+    parallel_for(exs.size(), [&exs](int i) { exs[i]->set_los(); });
 }
 
-void exclude_set::update_excluded_points(bool recompute_los)
+// Redo only the exclusions whose los might have changed; the others still
+// cover the same cells.
+void exclude_set::update_excluded_points()
 {
-    for (iterator it = exclude_roots.begin(); it != exclude_roots.end(); ++it)
+    vector<travel_exclude *> stale;
+    for (auto &entry : exclude_roots)
+        if (!entry.second.uptodate)
+            stale.push_back(&entry.second);
+
+    set_los(stale);
+    for (travel_exclude *ex : stale)
     {
-        travel_exclude &ex = it->second;
-        if (!ex.uptodate)
-        {
-            recompute_excluded_points(recompute_los);
-            return;
-        }
+        remove_exclude_points(*ex);
+        add_exclude_points(*ex);
     }
 }
 
 void exclude_set::recompute_excluded_points(bool recompute_los)
 {
     exclude_points.clear();
-    for (iterator it = exclude_roots.begin(); it != exclude_roots.end(); ++it)
+    if (recompute_los)
     {
-        travel_exclude &ex = it->second;
-        if (recompute_los)
-            ex.set_los();
-        add_exclude_points(ex);
+        vector<travel_exclude *> all;
+        for (auto &entry : exclude_roots)
+            all.push_back(&entry.second);
+        set_los(all);
     }
+    for (auto &entry : exclude_roots)
+        add_exclude_points(entry.second);
 }
 
 bool exclude_set::is_excluded(const coord_def &p) const
@@ -331,7 +364,7 @@ void update_exclusion_los(vector<coord_def> changed)
     for (coord_def c : changed)
         _mark_excludes_non_updated(c);
 
-    curr_excludes.update_excluded_points(true);
+    curr_excludes.update_excluded_points();
 }
 
 bool is_excluded(const coord_def &p, const exclude_set &exc)
@@ -488,7 +521,7 @@ void set_exclude(const coord_def &p, int radius, bool autoexcl, bool vaultexcl,
 
         exc->radius   = radius;
         exc->uptodate = false;
-        curr_excludes.recompute_excluded_points();
+        curr_excludes.update_excluded_points();
     }
     else
     {
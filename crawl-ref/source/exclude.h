@@ -45,6 +45,9 @@ public:
     bool affects(const coord_def& p) const;
 
 private:
+    // The cells this exclusion last added to its exclude_set.
+    vector<coord_def> points;
+
     void set_los();
 
     friend class exclude_set;
@@ -68,7 +71,7 @@ public:
                      string desc = "",
                      bool vaultexcl = false);
 
-    void update_excluded_points(bool recompute_los = false);
+    void update_excluded_points();
     void recompute_excluded_points(bool recompute_los = false);
 
     travel_exclude* get_exclude_root(const coord_def &p);
@@ -87,13 +90,16 @@ public:
     iterator  end();
 
 private:
-    typedef set<coord_def> exclset;
+    // How many exclusions cover each excluded cell.
+    typedef map<coord_def, int> exclcount;
 
     exclmap exclude_roots;
-    exclset exclude_points;
+    exclcount exclude_points;
 
 private:
     void add_exclude_points(travel_exclude& ex);
+    void remove_exclude_points(travel_exclude& ex);
+    static void set_los(const vector<travel_exclude *> &exs);
 };
 
 extern exclude_set curr_excludes; // in travel.cc
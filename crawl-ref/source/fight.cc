@@ -1095,11 +1095,10 @@ bool stop_attack_prompt(targeter &hitfunc, const char* verb,
     counted_monster_list victims;
     for (distance_iterator di(hitfunc.origin, false, true, LOS_RADIUS); di; ++di)
     {
-        if (hitfunc.is_affected(*di) <= AFF_NO)
-            continue;
-
+        // Most cells are empty, and area targeters can be slow to ask, so
+        // only ask about the ones with someone there.
         const monster* mon = monster_at(*di);
-        if (!mon || !you.can_see(*mon))
+        if (!mon || hitfunc.is_affected(*di) <= AFF_NO || !you.can_see(*mon))
             continue;
 
         if (affects && !affects(mon))
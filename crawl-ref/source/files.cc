@@ -57,6 +57,7 @@
 #include "god-companions.h"
 #include "god-passive.h"
 #include "hints.h"
+#include "hiscores.h"
 #include "initfile.h"
 #include "item-name.h"
 #include "items.h"
@@ -136,7 +137,10 @@ static bool _ghost_version_compatible(const save_version &version);
 
 static bool _restore_tagged_chunk(package *save, const string &name,
                                   tag_type tag, const char* complaint);
+static void _load_level(const level_id &level);
 static player_save_info _read_character_info(package *save);
+static player_save_info _read_character_info(reader &inf,
+                                             const string &filename);
 
 static bool _convert_obsolete_species();
 
@@ -691,23 +695,223 @@ string savedir_versioned_path(const string &shortpath)
     return catpath(versioned_dir, shortpath);
 }
 
-#ifdef USE_TILE
+/*
+ * What the game selection menu needs from each save, kept in an index next
+ * to them so that the menu doesn't have to open every save to find out.
+ * An entry is used for as long as its save's modification time and size stay
+ * the same; otherwise the save is read again. The chunks are kept as they are
+ * in the save, so the index doesn't care which version wrote it.
+ */
+#define SAVE_INDEX_FILE "saves.idx"
+static const int SAVE_INDEX_VERSION = 1;
 #define LINEMAX 1024
-static bool _readln(chunk_reader &rd, char *buf)
+
+struct save_index_entry
+{
+    int64_t mtime = 0;
+    int64_t size = 0;
+    vector<unsigned char> chr;  // the "chr" chunk
+    bool has_doll = false;      // whether there's a "tdl" chunk,
+    bool doll_read = false;     // whether it had anything in it,
+    string doll;                // and its first line
+};
+typedef map<string, save_index_entry> save_index;
+
+static bool _save_stamp(const string &path, int64_t &mtime, int64_t &size)
 {
-    for (int space = LINEMAX - 1; space; space--)
+    struct stat st;
+    if (stat(path.c_str(), &st))
+        return false;
+    mtime = st.st_mtime;
+    size = st.st_size;
+    return true;
+}
+
+static void _marshall_index_bytes(writer &th, const void *data, size_t len)
+{
+    marshallInt(th, len);
+    th.write(data, len);
+}
+
+static string _unmarshall_index_string(reader &th)
+{
+    const int len = unmarshallInt(th);
+    if (len < 0 || len > 65536)
+        throw short_read_exception();
+    string s(len, 0);
+    th.read(&s[0], len);
+    return s;
+}
+
+static save_index _read_save_index(const string &dir)
+{
+    save_index index;
+    FILE *f = fopen_u(catpath(dir, SAVE_INDEX_FILE).c_str(), "rb");
+    if (!f)
+        return index;
+
+    reader th(f);
+    th.set_safe_read(true);
+    try
     {
-        if (!rd.read(buf, 1))
-            return false;
-        if (*buf == '\n')
-            break;
-        buf++;
+        if (unmarshallInt(th) != SAVE_INDEX_VERSION)
+            throw short_read_exception();
+        for (int n = unmarshallInt(th); n > 0; --n)
+        {
+            const string filename = _unmarshall_index_string(th);
+            save_index_entry &entry = index[filename];
+            entry.mtime = unmarshallUnsigned(th);
+            entry.size = unmarshallUnsigned(th);
+            const string chr = _unmarshall_index_string(th);
+            entry.chr.assign(chr.begin(), chr.end());
+            entry.has_doll = unmarshallBoolean(th);
+            entry.doll_read = unmarshallBoolean(th);
+            entry.doll = _unmarshall_index_string(th);
+        }
+    }
+    catch (short_read_exception &E)
+    {
+        // Whatever is wrong with it, it'll be rebuilt.
+        index.clear();
+    }
+    fclose(f);
+    return index;
+}
+
+// Other processes may be listing the same directory, so the index is
+// replaced in one go rather than written in place.
+/// A name to write a replacement for filename under, before renaming it
+/// into place.
+static string _replacement_filename(const string &filename)
+{
+#ifdef UNIX
+    return make_stringf("%s.%d", filename.c_str(), (int) getpid());
+#else
+    return filename + ".tmp";
+#endif
+}
+
+static void _write_save_index(const string &dir, const save_index &index)
+{
+    const string filename = catpath(dir, SAVE_INDEX_FILE);
+    const string tmp = _replacement_filename(filename);
+    FILE *f = fopen_u(tmp.c_str(), "wb");
+    if (!f)
+        return;
+
+    writer th(tmp, f, true);
+    marshallInt(th, SAVE_INDEX_VERSION);
+    marshallInt(th, index.size());
+    for (const auto &item : index)
+    {
+        const save_index_entry &entry = item.second;
+        _marshall_index_bytes(th, item.first.data(), item.first.size());
+        marshallUnsigned(th, entry.mtime);
+        marshallUnsigned(th, entry.size);
+        _marshall_index_bytes(th, entry.chr.data(), entry.chr.size());
+        marshallBoolean(th, entry.has_doll);
+        marshallBoolean(th, entry.doll_read);
+        _marshall_index_bytes(th, entry.doll.data(), entry.doll.size());
+    }
+    const bool ok = th.succeeded() && !fclose(f);
+    if (!ok || rename_u(tmp.c_str(), filename.c_str()))
+        unlink_u(tmp.c_str());
+}
+
+/// Read what the index needs from a save. Throws as package() does.
+static void _index_save(const string &path, save_index_entry &entry)
+{
+    package save(path.c_str(), false);
+
+    vector<char> data;
+    chunk_reader(&save, "chr").read_all(data);
+    entry.chr.assign(data.begin(), data.end());
+
+    entry.has_doll = save.has_chunk("tdl");
+    entry.doll_read = false;
+    entry.doll.clear();
+    if (entry.has_doll)
+    {
+        data.clear();
+        chunk_reader(&save, "tdl").read_all(data);
+        entry.doll_read = !data.empty();
+        const auto eol = find(data.begin(), data.end(), '\n');
+        entry.doll.assign(data.begin(), eol);
+        if (entry.doll.size() >= LINEMAX)
+            entry.doll.resize(LINEMAX - 1);
     }
-    *buf = 0;
-    return true;
 }
 
-static void _fill_player_doll(player_save_info &p, package *save)
+// Whether another game has the save open, which would stop package() from
+// opening it.
+static bool _save_in_use(const string &path)
+{
+    const int fd = open_u(path.c_str(), O_RDONLY | O_BINARY, 0666);
+    if (fd == -1)
+        return false;
+    const bool in_use = !lock_file(fd, false);
+    close(fd);
+    return in_use;
+}
+
+/**
+ * Look a save up in the index, reading it again if it has changed.
+ * @param index    the index for the save's directory.
+ * @param path     the save.
+ * @param filename its name in the index.
+ * @param[out] changed set if the index needs writing back.
+ * @return the entry, or nullptr if the save couldn't be read.
+ * @throws game_ended_condition if another game is using the save.
+ */
+static const save_index_entry *_indexed_save(save_index &index,
+                                             const string &path,
+                                             const string &filename,
+                                             bool &changed)
+{
+    save_index_entry stamp;
+    if (!_save_stamp(path, stamp.mtime, stamp.size))
+        return nullptr;
+
+    auto it = index.find(filename);
+    if (it != index.end() && it->second.mtime == stamp.mtime
+        && it->second.size == stamp.size)
+    {
+        if (_save_in_use(path))
+        {
+            game_ended(game_exit::abort,
+                       "Another game is already in progress using this save!");
+        }
+        return &it->second;
+    }
+
+    try
+    {
+        _index_save(path, stamp);
+    }
+    catch (ext_fail_exception &E)
+    {
+        dprf("%s: %s", filename.c_str(), E.what());
+        if (it != index.end())
+        {
+            index.erase(it);
+            changed = true;
+        }
+        return nullptr;
+    }
+    changed = true;
+    return &(index[filename] = move(stamp));
+}
+
+static player_save_info _indexed_character_info(const save_index_entry &entry,
+                                                const string &filename)
+{
+    reader inf(entry.chr);
+    return _read_character_info(inf, filename);
+}
+
+#ifdef USE_TILE
+static void _fill_player_doll(player_save_info &p,
+                              const save_index_entry &entry)
 {
     dolls_data equip_doll;
     for (unsigned int j = 0; j < TILEP_PART_MAX; ++j)
@@ -716,20 +920,14 @@ static void _fill_player_doll(player_save_info &p, package *save)
     equip_doll.parts[TILEP_PART_BASE]
         = tilep_species_to_base_tile(p.species, p.experience_level);
 
-    bool success = false;
-
-    chunk_reader fdoll(save, "tdl");
+    const bool success = entry.doll_read;
+    if (success)
     {
-        char fbuf[LINEMAX];
-        if (_readln(fdoll,fbuf))
-        {
-            tilep_scan_parts(fbuf, equip_doll, p.species, p.experience_level);
-            tilep_race_default(p.species, p.experience_level, &equip_doll);
-            success = true;
-        }
+        string line = entry.doll; // tilep_scan_parts() writes to it
+        tilep_scan_parts(&line[0], equip_doll, p.species, p.experience_level);
+        tilep_race_default(p.species, p.experience_level, &equip_doll);
     }
-
-    if (!success) // Use default doll instead.
+    else // Use default doll instead.
     {
         job_type job = get_job_by_name(p.class_name.c_str());
         if (job == JOB_UNKNOWN)
@@ -759,20 +957,30 @@ static vector<player_save_info> _find_saved_characters()
     if (searchpath.empty())
         searchpath = ".";
 
+    save_index index = _read_save_index(searchpath);
+    bool index_changed = false;
+    set<string> found;
+
     for (const string &filename : get_dir_files_sorted(searchpath))
     {
         if (is_save_file_name(filename))
         {
+            found.insert(filename);
             try
             {
-                package save(_get_savedir_path(filename).c_str(), false);
-                player_save_info p = _read_character_info(&save);
+                const save_index_entry *entry
+                    = _indexed_save(index, _get_savedir_path(filename),
+                                    filename, index_changed);
+                if (!entry)
+                    continue;
+                player_save_info p = _indexed_character_info(*entry,
+                                                             filename);
                 if (!p.name.empty())
                 {
                     p.filename = filename;
 #ifdef USE_TILE
-                    if (Options.tile_menu_icons && save.has_chunk("tdl"))
-                        _fill_player_doll(p, &save);
+                    if (Options.tile_menu_icons && entry->has_doll)
+                        _fill_player_doll(p, *entry);
 #endif
                     chars.push_back(p);
                 }
@@ -780,6 +988,9 @@ static vector<player_save_info> _find_saved_characters()
             catch (ext_fail_exception &E)
             {
                 dprf("%s: %s", filename.c_str(), E.what());
+                // In case it's the index that's bad, read the save next time.
+                if (index.erase(filename))
+                    index_changed = true;
             }
             catch (game_ended_condition &E) // another process is using the save
             {
@@ -789,6 +1000,19 @@ static vector<player_save_info> _find_saved_characters()
         }
     }
 
+    for (auto it = index.begin(); it != index.end();)
+    {
+        if (found.count(it->first))
+            ++it;
+        else
+        {
+            it = index.erase(it);
+            index_changed = true;
+        }
+    }
+    if (index_changed)
+        _write_save_index(searchpath, index);
+
     sort(chars.begin(), chars.end());
 #endif // !DISABLE_SAVEGAME_LISTS
     return chars;
@@ -862,8 +1086,22 @@ static bool _append_save_info(JsonWrapper &json, const char *filename,
         return false;
     try
     {
-        package save(filename, false);
-        player_save_info p = _read_character_info(&save);
+        const string dir = get_parent_directory(filename);
+        save_index index = _read_save_index(dir);
+        bool index_changed = false;
+        const save_index_entry *entry
+            = _indexed_save(index, filename, get_base_filename(filename),
+                            index_changed);
+        if (!entry)
+        {
+            // Let package() say what's wrong with it.
+            package save(filename, false);
+            _read_character_info(&save);
+            return false;
+        }
+        if (index_changed && is_save_file_name(filename))
+            _write_save_index(dir, index);
+        player_save_info p = _indexed_character_info(*entry, filename);
 
         // TODO: some json for the non-loadable case? I think this comes up
         // for save compat mismatches so shouldn't be relevant for webtiles
@@ -1042,12 +1280,27 @@ void write_ghost_version(writer &outf)
         marshallInt(outf, 0);
 }
 
-static void _write_tagged_chunk(const string &chunkname, tag_type tag)
+// Most chunks are written out on every level change whether or not
+// anything in them did, so build them in memory first, and leave them be
+// if the save already holds the same thing.
+static void _write_chunk_if_changed(const string &chunkname,
+                                    const vector<unsigned char> &data)
 {
+    if (you.save->chunk_holds(chunkname, data.data(), data.size()))
+        return;
+
     writer outf(you.save, chunkname);
+    outf.write(data.data(), data.size());
+}
+
+static void _write_tagged_chunk(const string &chunkname, tag_type tag)
+{
+    vector<unsigned char> data;
+    writer outf(&data);
 
     write_save_version(outf, save_version::current());
     tag_write(tag, outf);
+    _write_chunk_if_changed(chunkname, data);
 }
 
 static int _get_dest_stair_type(dungeon_feature_type stair_taken,
@@ -1640,6 +1893,19 @@ void reset_portal_entrances()
             brentry[b] = level_id();
 }
 
+/**
+ * The portal levels whose entrance is on `here`, in the order they're built.
+ */
+vector<level_id> portal_levels_at(const level_id &here)
+{
+    vector<level_id> levels;
+    for (auto b : portal_generation_order)
+        if (brentry[b] == here)
+            for (int i = 1; i <= brdepth[b]; i++)
+                levels.push_back(level_id(b, i));
+    return levels;
+}
+
 /**
  * Generate portals relative to the current level. This function does not clean
  * up builder state.
@@ -1648,16 +1914,8 @@ void reset_portal_entrances()
  */
 static int _generate_portal_levels()
 {
-    // find any portals that branch off of the current level.
-    level_id here = level_id::current();
-    vector<level_id> to_build;
-    for (auto b : portal_generation_order)
-        if (brentry[b] == here)
-            for (int i = 1; i <= brdepth[b]; i++)
-                to_build.push_back(level_id(b, i));
-
     int count = 0;
-    for (auto lid : to_build)
+    for (auto lid : portal_levels_at(level_id::current()))
     {
         if (!generate_level(lid))
         {
@@ -1829,37 +2087,28 @@ static bool _branch_pregenerates(branch_type b)
         branch_generation_order.end(), b) > 0;
 }
 
-/**
-* Generate dungeon branches in a stable order until the level `stopping_point`
-* is found; `stopping_point` will be generated if it doesn't already exist. If
-* it does exist, the function is a noop.
-*
-* If `stopping_point` is not in the generation order, it will be generated on
-* its own.
-*
-* To generate all generatable levels, pass a level_id with NUM_BRANCHES as the
-* branch.
-*
-* @return whether stopping_point generated; if stopping_point is NUM_BRANCHES,
-* whether the full pregen list completed. This will return false if all needed
-* levels are already generated, so the caller should check whether false is an
-* error case or trivial success (using the save chunk).
-*/
-bool pregen_dungeon(const level_id &stopping_point)
+static bool _pregen_branch_exists(branch_type br)
 {
-    // TODO: the is_valid() check here doesn't look quite right to me, but so
-    // far I can't get it to break anything...
-    if (stopping_point.is_valid()
-        || stopping_point.branch != NUM_BRANCHES &&
-           is_random_subbranch(stopping_point.branch) && you.wizard)
-    {
-        if (you.save->has_chunk(stopping_point.describe()))
-            return false;
-
-        if (!_branch_pregenerates(stopping_point.branch))
-            return generate_level(stopping_point);
-    }
+    // TODO: why is dungeon invalid? it's not set up properly in
+    // `initialise_branch_depths` for some reason. The vestibule is invalid
+    // because its depth isn't set until the player actually enters a
+    // portal, similarly for other portal branches.
+    return br < NUM_BRANCHES
+           && (brentry[br].is_valid()
+               || br == BRANCH_DUNGEON || br == BRANCH_VESTIBULE
+               || !is_connected_branch(br));
+}
 
+/**
+ * List the levels that still need to be generated, in generation order, up
+ * to and including `stopping_point`.
+ *
+ * @param stopping_point the last level of interest; NUM_BRANCHES as the branch
+ *                       means everything generatable.
+ * @return the missing levels, in the order they must be built in.
+ */
+static vector<level_id> _pregen_list(const level_id &stopping_point)
+{
     vector<level_id> to_generate;
     bool at_end = false;
     for (auto br : branch_generation_order)
@@ -1873,14 +2122,7 @@ bool pregen_dungeon(const level_id &stopping_point)
             to_generate.push_back(stopping_point);
             continue;
         }
-        // TODO: why is dungeon invalid? it's not set up properly in
-        // `initialise_branch_depths` for some reason. The vestibule is invalid
-        // because its depth isn't set until the player actually enters a
-        // portal, similarly for other portal branches.
-        if (br < NUM_BRANCHES &&
-            (brentry[br].is_valid()
-             || br == BRANCH_DUNGEON || br == BRANCH_VESTIBULE
-             || !is_connected_branch(br)))
+        if (_pregen_branch_exists(br))
         {
             for (int i = 1; i <= brdepth[br]; i++)
             {
@@ -1901,7 +2143,64 @@ bool pregen_dungeon(const level_id &stopping_point)
         if (at_end)
             break;
     }
+    return to_generate;
+}
+
+/**
+ * Every level of the stable generation order for this game's branch layout,
+ * whether or not it has been built. Portals are left out, as they're built
+ * with the level they're found on (see portal_levels_at()), and so are
+ * Pandemonium and ziggurats, which are only in the order so that entering
+ * them builds everything else first.
+ */
+vector<level_id> generation_order_levels()
+{
+    vector<level_id> levels;
+    for (auto br : branch_generation_order)
+    {
+        if (br == BRANCH_PANDEMONIUM || br == BRANCH_ZIGGURAT
+            || !_pregen_branch_exists(br))
+        {
+            continue;
+        }
+        for (int i = 1; i <= brdepth[br]; i++)
+            levels.push_back(level_id(br, i));
+    }
+    return levels;
+}
+
+/**
+* Generate dungeon branches in a stable order until the level `stopping_point`
+* is found; `stopping_point` will be generated if it doesn't already exist. If
+* it does exist, the function is a noop.
+*
+* If `stopping_point` is not in the generation order, it will be generated on
+* its own.
+*
+* To generate all generatable levels, pass a level_id with NUM_BRANCHES as the
+* branch.
+*
+* @return whether stopping_point generated; if stopping_point is NUM_BRANCHES,
+* whether the full pregen list completed. This will return false if all needed
+* levels are already generated, so the caller should check whether false is an
+* error case or trivial success (using the save chunk).
+*/
+bool pregen_dungeon(const level_id &stopping_point)
+{
+    // TODO: the is_valid() check here doesn't look quite right to me, but so
+    // far I can't get it to break anything...
+    if (stopping_point.is_valid()
+        || stopping_point.branch != NUM_BRANCHES &&
+           is_random_subbranch(stopping_point.branch) && you.wizard)
+    {
+        if (you.save->has_chunk(stopping_point.describe()))
+            return false;
+
+        if (!_branch_pregenerates(stopping_point.branch))
+            return generate_level(stopping_point);
+    }
 
+    const vector<level_id> to_generate = _pregen_list(stopping_point);
     if (to_generate.size() == 0)
     {
         dprf("levelgen: No valid levels to generate.");
@@ -1951,6 +2250,55 @@ bool pregen_dungeon(const level_id &stopping_point)
     }
 }
 
+/**
+ * While waiting for the player's input, build the next level of the stable
+ * generation order ahead of time, if it is in the current branch and at most
+ * Options.pregen_lookahead levels down. As the order is kept, the dungeon
+ * comes out the same as if each level was built on arrival; the player just
+ * doesn't have to wait on the stairs. The current level is saved and then
+ * reloaded quietly, as at the end of a level excursion, so nothing on it
+ * sees the player arrive again. Only one level is built per call, and only
+ * when no key is waiting, so a build holds up at most the next keypress.
+ *
+ * @return whether a level was built.
+ */
+bool pregen_lookahead()
+{
+    if (!Options.pregen_lookahead
+        || Options.pregen_dungeon != level_gen_type::incremental
+        || !crawl_state.game_standard_levelgen()
+        || !you.on_current_level
+        || !is_connected_branch(you.where_are_you)
+        || !_branch_pregenerates(you.where_are_you)
+        || you.props.exists(FORCE_MAP_KEY)
+        || you.props.exists(FORCE_MINIVAULT_KEY))
+    {
+        return false;
+    }
+
+    const vector<level_id> to_generate
+        = _pregen_list(level_id(NUM_BRANCHES, -1));
+    if (to_generate.empty()
+        || to_generate[0].branch != you.where_are_you
+        || to_generate[0].depth > you.depth + Options.pregen_lookahead)
+    {
+        return false;
+    }
+
+    const level_id here = level_id::current();
+    dprf("Pregenerating %s ahead.", to_generate[0].describe().c_str());
+    save_level(here);
+    // A failed build is left for the stairs to retry (and report).
+    const bool built = generate_level(to_generate[0]);
+
+    // Come back the way ~level_excursion does.
+    _load_level(here);
+    travel_cache.get_level_info(here).set_level_excludes();
+    env.markers.activate_all(false);
+    you.on_current_level = true;
+    return built;
+}
+
 static void _rescue_player_from_wall()
 {
     // n.b. you.wizmode_teleported_into_rock would be better, but it is not
@@ -2168,7 +2516,7 @@ bool load_level(dungeon_feature_type stair_taken, load_mode_type load_mode,
     show_update_emphasis();
 
     // Shouldn't happen, but this is too unimportant to assert.
-    deleteAll(env.final_effects);
+    clear_final_effects();
 
     los_changed();
 
@@ -2442,11 +2790,13 @@ void save_level(const level_id& lid)
 # define CHUNK(short, long) long
 #endif
 
-#define SAVEFILE(short, long, savefn)           \
-    do                                          \
-    {                                           \
-        writer w(you.save, CHUNK(short, long)); \
-        savefn(w);                              \
+#define SAVEFILE(short, long, savefn)                      \
+    do                                                     \
+    {                                                      \
+        vector<unsigned char> data;                        \
+        writer w(&data);                                   \
+        savefn(w);                                         \
+        _write_chunk_if_changed(CHUNK(short, long), data); \
     } while (false)
 
 // Stack allocated string's go in separate function, so Valgrind doesn't
@@ -2520,6 +2870,10 @@ void save_game(bool leave_game, const char *farewellmsg)
     // that can.
     ASSERT(you.on_current_level || Options.no_save);
 
+    // A replay carries on through the saves in its journal, as if the game
+    // had been restored straight away.
+    if (!crawl_state.replay_journal.empty())
+        leave_game = false;
 
     if (leave_game && Options.dump_on_save)
     {
@@ -2538,13 +2892,14 @@ void save_game(bool leave_game, const char *farewellmsg)
     // Stack allocated string's go in separate function,
     // so Valgrind doesn't complain.
     _save_game_base();
+    flush_milestones();
 
     // If just save, early out.
     if (!leave_game)
     {
         if (!crawl_state.disables[DIS_SAVE_CHECKPOINTS])
         {
-            you.save->commit();
+            you.save->commit(true);
             save_game_prefs();
         }
         return;
@@ -2604,7 +2959,8 @@ static string _bones_permastore_file()
         return dist_full_path;
 
     // no matching permastore is in the player's bones file, but one exists in
-    // the crawl distribution. Install it.
+    // the crawl distribution. Install it. It's copied under another name and
+    // renamed into place, so that another game never sees half of it.
 
     FILE *src = fopen(dist_full_path.c_str(), "rb");
     if (!src)
@@ -2613,7 +2969,8 @@ static string _bones_permastore_file()
             dist_full_path.c_str());
         return "";
     }
-    FILE *target = lk_open("wb", full_path);
+    const string tmp_path = _replacement_filename(full_path);
+    FILE *target = lk_open("wb", tmp_path);
     if (!target)
     {
         mprf(MSGCH_ERROR, "Unable to open bones file %s for writing",
@@ -2632,15 +2989,15 @@ static string _bones_permastore_file()
 
     lk_close(target);
 
-    if (!feof(src))
+    if (!feof(src) || rename_u(tmp_path.c_str(), full_path.c_str()))
     {
         mprf(MSGCH_ERROR, "Error installing bones file to %s",
                                                     full_path.c_str());
-        if (unlink(full_path.c_str()) != 0)
+        if (unlink(tmp_path.c_str()) != 0)
         {
             mprf(MSGCH_ERROR,
                 "Failed to unlink probably corrupt bones file: %s",
-                full_path.c_str());
+                tmp_path.c_str());
         }
         fclose(src);
         return "";
@@ -2817,7 +3174,11 @@ vector<ghost_demon> load_bones_file(string ghost_filename, bool backup)
     if (ghost_filename.empty())
         return result; // no such ghost.
 
-    reader inf(ghost_filename);
+    // Wait for a game that's still writing the file to finish. Without the
+    // lock, its ghosts would look broken and the file would be scrapped.
+    FILE *ghost_file = lk_open("rb", ghost_filename);
+    ON_UNWIND { lk_close(ghost_file); };
+    reader inf(ghost_file);
     if (!inf.valid())
     {
         // file doesn't exist
@@ -3409,7 +3770,12 @@ static bool _loadable_save_ver(int major, int minor)
 static player_save_info _read_character_info(package *save)
 {
     reader inf(save, "chr");
+    return _read_character_info(inf, save->get_filename());
+}
 
+static player_save_info _read_character_info(reader &inf,
+                                             const string &filename)
+{
     try
     {
         player_save_info result;
@@ -3419,7 +3785,7 @@ static player_save_info _read_character_info(package *save)
 
         unsigned int len = unmarshallInt(inf);
         if (len > 1024) // something is fishy
-            fail("Save file `%s` corrupted (info > 1KB)", save->get_filename().c_str());
+            fail("Save file `%s` corrupted (info > 1KB)", filename.c_str());
         vector<unsigned char> buf;
         buf.resize(len);
         inf.read(&buf[0], len);
@@ -3435,7 +3801,7 @@ static player_save_info _read_character_info(package *save)
         if (format > TAG_CHR_FORMAT)
         {
             fail("Incompatible character data from the future in `%s`",
-                                        save->get_filename().c_str());
+                                        filename.c_str());
         }
 
         result = tag_read_char_info(th, format, major, minor);
@@ -3450,7 +3816,7 @@ static player_save_info _read_character_info(package *save)
     }
     catch (short_read_exception &E)
     {
-        fail("Save file `%s` corrupted (short read)", save->get_filename().c_str());
+        fail("Save file `%s` corrupted (short read)", filename.c_str());
     };
 }
 
@@ -3655,24 +4021,34 @@ static vector<ghost_demon> _update_permastore(const vector<ghost_demon> &ghosts)
             }
         }
 
-        FILE *ghost_file = lk_open("wb", permastore_file);
+        // Write the new store beside the old one and rename it over, so
+        // that games reading the store never find it truncated.
+        const string tmp_file = _replacement_filename(permastore_file);
+        FILE *ghost_file = lk_open("wb", tmp_file);
 
         if (!ghost_file)
         {
             // this will fail silently if the lock fails, seems safest
             // TODO: better lock system for servers?
             _ghost_dprf("Could not open ghost permastore: %s",
-                                                    permastore_file.c_str());
+                                                    tmp_file.c_str());
             return ghosts;
         }
 
         _ghost_dprf("Rewriting ghost permastore %s with %u ghosts",
                     permastore_file.c_str(), (unsigned int) permastore.size());
-        writer outw(permastore_file, ghost_file);
+        writer outw(tmp_file, ghost_file);
         write_ghost_version(outw);
         tag_write_ghosts(outw, permastore);
 
         lk_close(ghost_file);
+        if (rename_u(tmp_file.c_str(), permastore_file.c_str()))
+        {
+            _ghost_dprf("Could not replace ghost permastore: %s",
+                                                    permastore_file.c_str());
+            unlink_u(tmp_file.c_str());
+            return ghosts;
+        }
     }
     return leftovers;
 }
@@ -91,6 +91,9 @@ void update_portal_entrances();
 void reset_portal_entrances();
 bool generate_level(const level_id &l);
 bool pregen_dungeon(const level_id &stopping_point);
+vector<level_id> generation_order_levels();
+vector<level_id> portal_levels_at(const level_id &here);
+bool pregen_lookahead();
 bool load_level(dungeon_feature_type stair_taken, load_mode_type load_mode,
                 const level_id& old_level);
 void delete_level(const level_id &level);
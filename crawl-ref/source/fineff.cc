@@ -8,6 +8,8 @@
 
 #include "fineff.h"
 
+#include <unordered_map>
+
 #include "beam.h"
 #include "bloodspatter.h"
 #include "coordit.h"
@@ -38,167 +40,168 @@
 #include "transform.h"
 #include "view.h"
 
+namespace
+{
+    struct fineff_key_hash
+    {
+        size_t operator()(const fineff_key &k) const
+        {
+            size_t h = k.kind;
+            h = h * 31 + k.att;
+            h = h * 31 + k.def;
+            h = h * 31 + k.posn.x * GYM + k.posn.y;
+            return h * 31 + k.extra;
+        }
+    };
+}
+
+// Where each mergeable effect in env.final_effects is, by key.
+static unordered_map<fineff_key, size_t, fineff_key_hash> _fineff_index;
+
 /*static*/ void final_effect::schedule(final_effect *eff)
 {
-    for (auto fe : env.final_effects)
+    fineff_key key;
+    if (eff->merge_key(key))
     {
-        if (fe->mergeable(*eff))
+        auto it = _fineff_index.find(key);
+        if (it != _fineff_index.end())
         {
-            fe->merge(*eff);
+            env.final_effects[it->second]->merge(*eff);
             delete eff;
             return;
         }
+        _fineff_index[key] = env.final_effects.size();
     }
     env.final_effects.push_back(eff);
 }
 
-bool mirror_damage_fineff::mergeable(const final_effect &fe) const
+bool mirror_damage_fineff::merge_key(fineff_key &key) const
 {
-    const mirror_damage_fineff *o =
-        dynamic_cast<const mirror_damage_fineff *>(&fe);
-    return o && att == o->att && def == o->def;
+    key = { FINEFF_MIRROR_DAMAGE, att, def, coord_def(), 0 };
+    return true;
 }
 
-bool anguish_fineff::mergeable(const final_effect &fe) const
+bool anguish_fineff::merge_key(fineff_key &key) const
 {
-    const anguish_fineff *o =
-        dynamic_cast<const anguish_fineff *>(&fe);
-    return o && att == o->att;
+    key = { FINEFF_ANGUISH, att, 0, coord_def(), 0 };
+    return true;
 }
 
-bool ru_retribution_fineff::mergeable(const final_effect &fe) const
+bool ru_retribution_fineff::merge_key(fineff_key &key) const
 {
-    const ru_retribution_fineff *o =
-        dynamic_cast<const ru_retribution_fineff *>(&fe);
-    return o && att == o->att && def == o->def;
+    key = { FINEFF_RU_RETRIBUTION, att, def, coord_def(), 0 };
+    return true;
 }
 
-bool trample_follow_fineff::mergeable(const final_effect &fe) const
+bool trample_follow_fineff::merge_key(fineff_key &key) const
 {
-    const trample_follow_fineff *o =
-        dynamic_cast<const trample_follow_fineff *>(&fe);
-    return o && att == o->att && posn == o->posn;
+    key = { FINEFF_TRAMPLE_FOLLOW, att, 0, posn, 0 };
+    return true;
 }
 
-bool blink_fineff::mergeable(const final_effect &fe) const
+bool blink_fineff::merge_key(fineff_key &key) const
 {
-    const blink_fineff *o = dynamic_cast<const blink_fineff *>(&fe);
-    return o && def == o->def && att == o->att;
+    key = { FINEFF_BLINK, att, def, coord_def(), 0 };
+    return true;
 }
 
-bool teleport_fineff::mergeable(const final_effect &fe) const
+bool teleport_fineff::merge_key(fineff_key &key) const
 {
-    const teleport_fineff *o =
-        dynamic_cast<const teleport_fineff *>(&fe);
-    return o && def == o->def;
+    key = { FINEFF_TELEPORT, 0, def, coord_def(), 0 };
+    return true;
 }
 
-bool trj_spawn_fineff::mergeable(const final_effect &fe) const
+bool trj_spawn_fineff::merge_key(fineff_key &key) const
 {
-    const trj_spawn_fineff *o = dynamic_cast<const trj_spawn_fineff *>(&fe);
-    return o && att == o->att && def == o->def && posn == o->posn;
+    key = { FINEFF_TRJ_SPAWN, att, def, posn, 0 };
+    return true;
 }
 
-bool blood_fineff::mergeable(const final_effect &fe) const
+bool blood_fineff::merge_key(fineff_key &key) const
 {
-    const blood_fineff *o = dynamic_cast<const blood_fineff *>(&fe);
-    return o && posn == o->posn && mtype == o->mtype;
+    key = { FINEFF_BLOOD, 0, 0, posn, mtype };
+    return true;
 }
 
-bool deferred_damage_fineff::mergeable(const final_effect &fe) const
+bool deferred_damage_fineff::merge_key(fineff_key &key) const
 {
-    const deferred_damage_fineff *o = dynamic_cast<const deferred_damage_fineff *>(&fe);
-    return o && att == o->att && def == o->def
-           && attacker_effects == o->attacker_effects && fatal == o->fatal;
+    key = { FINEFF_DEFERRED_DAMAGE, att, def, coord_def(),
+            attacker_effects | fatal << 1 };
+    return true;
 }
 
-bool starcursed_merge_fineff::mergeable(const final_effect &fe) const
+bool starcursed_merge_fineff::merge_key(fineff_key &key) const
 {
-    const starcursed_merge_fineff *o = dynamic_cast<const starcursed_merge_fineff *>(&fe);
-    return o && def == o->def;
+    key = { FINEFF_STARCURSED_MERGE, 0, def, coord_def(), 0 };
+    return true;
 }
 
-bool shock_serpent_discharge_fineff::mergeable(const final_effect &fe) const
+bool shock_serpent_discharge_fineff::merge_key(fineff_key &key) const
 {
-    const shock_serpent_discharge_fineff *o = dynamic_cast<const shock_serpent_discharge_fineff *>(&fe);
-    return o && def == o->def;
+    key = { FINEFF_SHOCK_SERPENT_DISCHARGE, 0, def, coord_def(), 0 };
+    return true;
 }
 
-bool delayed_action_fineff::mergeable(const final_effect &) const
+bool delayed_action_fineff::merge_key(fineff_key &) const
 {
     return false;
 }
 
-bool rakshasa_clone_fineff::mergeable(const final_effect &fe) const
+bool rakshasa_clone_fineff::merge_key(fineff_key &key) const
 {
-    const rakshasa_clone_fineff *o =
-        dynamic_cast<const rakshasa_clone_fineff *>(&fe);
-    return o && att == o->att && def == o->def && posn == o->posn;
+    key = { FINEFF_RAKSHASA_CLONE, att, def, posn, 0 };
+    return true;
 }
 
-bool summon_dismissal_fineff::mergeable(const final_effect &fe) const
+bool summon_dismissal_fineff::merge_key(fineff_key &key) const
 {
-    const summon_dismissal_fineff *o =
-        dynamic_cast<const summon_dismissal_fineff *>(&fe);
-    return o && def == o->def;
+    key = { FINEFF_SUMMON_DISMISSAL, 0, def, coord_def(), 0 };
+    return true;
 }
 
 void mirror_damage_fineff::merge(const final_effect &fe)
 {
     const mirror_damage_fineff *mdfe =
-        dynamic_cast<const mirror_damage_fineff *>(&fe);
-    ASSERT(mdfe);
-    ASSERT(mergeable(*mdfe));
+        static_cast<const mirror_damage_fineff *>(&fe);
     damage += mdfe->damage;
 }
 
 void anguish_fineff::merge(const final_effect &fe)
 {
     const anguish_fineff *afe =
-        dynamic_cast<const anguish_fineff *>(&fe);
-    ASSERT(afe);
-    ASSERT(mergeable(*afe));
+        static_cast<const anguish_fineff *>(&fe);
     damage += afe->damage;
 }
 
-void ru_retribution_fineff::merge(const final_effect &fe)
+void ru_retribution_fineff::merge(const final_effect &)
 {
-    const ru_retribution_fineff *mdfe =
-        dynamic_cast<const ru_retribution_fineff *>(&fe);
-    ASSERT(mdfe);
-    ASSERT(mergeable(*mdfe));
+    // Retribution comes once, however much damage was done.
 }
 
 void trj_spawn_fineff::merge(const final_effect &fe)
 {
     const trj_spawn_fineff *trjfe =
-        dynamic_cast<const trj_spawn_fineff *>(&fe);
-    ASSERT(trjfe);
-    ASSERT(mergeable(*trjfe));
+        static_cast<const trj_spawn_fineff *>(&fe);
     damage += trjfe->damage;
 }
 
 void blood_fineff::merge(const final_effect &fe)
 {
-    const blood_fineff *bfe = dynamic_cast<const blood_fineff *>(&fe);
-    ASSERT(bfe);
-    ASSERT(mergeable(*bfe));
+    const blood_fineff *bfe = static_cast<const blood_fineff *>(&fe);
     blood += bfe->blood;
 }
 
 void deferred_damage_fineff::merge(const final_effect &fe)
 {
     const deferred_damage_fineff *ddamfe =
-        dynamic_cast<const deferred_damage_fineff *>(&fe);
-    ASSERT(ddamfe);
-    ASSERT(mergeable(*ddamfe));
+        static_cast<const deferred_damage_fineff *>(&fe);
     damage += ddamfe->damage;
 }
 
 void shock_serpent_discharge_fineff::merge(const final_effect &fe)
 {
     const shock_serpent_discharge_fineff *ssdfe =
-        dynamic_cast<const shock_serpent_discharge_fineff *>(&fe);
+        static_cast<const shock_serpent_discharge_fineff *>(&fe);
     power += ssdfe->power;
 }
 
@@ -876,6 +879,15 @@ void fire_final_effects()
         // Remove it first so nothing can merge with it.
         unique_ptr<final_effect> eff(env.final_effects.back());
         env.final_effects.pop_back();
+        fineff_key key;
+        if (eff->merge_key(key))
+            _fineff_index.erase(key);
         eff->fire();
     }
 }
+
+void clear_final_effects()
+{
+    deleteAll(env.final_effects);
+    _fineff_index.clear();
+}
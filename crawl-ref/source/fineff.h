@@ -14,12 +14,48 @@
 
 struct bolt;
 
+// The kinds of final effect that can merge with each other.
+enum fineff_kind
+{
+    FINEFF_MIRROR_DAMAGE,
+    FINEFF_ANGUISH,
+    FINEFF_RU_RETRIBUTION,
+    FINEFF_TRAMPLE_FOLLOW,
+    FINEFF_BLINK,
+    FINEFF_TELEPORT,
+    FINEFF_TRJ_SPAWN,
+    FINEFF_BLOOD,
+    FINEFF_DEFERRED_DAMAGE,
+    FINEFF_STARCURSED_MERGE,
+    FINEFF_SHOCK_SERPENT_DISCHARGE,
+    FINEFF_RAKSHASA_CLONE,
+    FINEFF_SUMMON_DISMISSAL,
+};
+
+// Effects with equal keys merge: the later one is folded into the earlier,
+// through merge().
+struct fineff_key
+{
+    fineff_kind kind;
+    mid_t att, def;
+    coord_def posn;
+    int extra;
+
+    bool operator==(const fineff_key &o) const
+    {
+        return kind == o.kind && att == o.att && def == o.def
+               && posn == o.posn && extra == o.extra;
+    }
+};
+
 class final_effect
 {
 public:
     virtual ~final_effect() {}
 
-    virtual bool mergeable(const final_effect &a) const = 0;
+    // Fill in key and return true if this can merge with other effects.
+    virtual bool merge_key(fineff_key &key) const = 0;
+    // Only called with an effect of the same class, whose key matched.
     virtual void merge(const final_effect &)
     {
     }
@@ -45,7 +81,7 @@ protected:
 class mirror_damage_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &a) const override;
+    bool merge_key(fineff_key &key) const override;
     void merge(const final_effect &a) override;
     void fire() override;
 
@@ -64,7 +100,7 @@ protected:
 class anguish_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &a) const override;
+    bool merge_key(fineff_key &key) const override;
     void merge(const final_effect &a) override;
     void fire() override;
 
@@ -83,7 +119,7 @@ protected:
 class ru_retribution_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &a) const override;
+    bool merge_key(fineff_key &key) const override;
     void merge(const final_effect &a) override;
     void fire() override;
 
@@ -102,7 +138,7 @@ protected:
 class trample_follow_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &a) const override;
+    bool merge_key(fineff_key &key) const override;
     void fire() override;
 
     static void schedule(const actor *attack, const coord_def &pos)
@@ -119,7 +155,7 @@ protected:
 class blink_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &a) const override;
+    bool merge_key(fineff_key &key) const override;
     void fire() override;
 
     static void schedule(const actor *blinker, const actor *other = nullptr)
@@ -136,7 +172,7 @@ protected:
 class teleport_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &a) const override;
+    bool merge_key(fineff_key &key) const override;
     void fire() override;
 
     static void schedule(const actor *defend)
@@ -153,7 +189,7 @@ protected:
 class trj_spawn_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &a) const override;
+    bool merge_key(fineff_key &key) const override;
     void merge(const final_effect &a) override;
     void fire() override;
 
@@ -174,7 +210,7 @@ protected:
 class blood_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &a) const override;
+    bool merge_key(fineff_key &key) const override;
     void fire() override;
     void merge(const final_effect &a) override;
 
@@ -195,7 +231,7 @@ protected:
 class deferred_damage_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &a) const override;
+    bool merge_key(fineff_key &key) const override;
     void merge(const final_effect &a) override;
     void fire() override;
 
@@ -221,7 +257,7 @@ protected:
 class starcursed_merge_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &a) const override;
+    bool merge_key(fineff_key &key) const override;
     void fire() override;
 
     static void schedule(const actor *merger)
@@ -238,7 +274,7 @@ protected:
 class shock_serpent_discharge_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &a) const override;
+    bool merge_key(fineff_key &key) const override;
     void merge(const final_effect &a) override;
     void fire() override;
 
@@ -267,7 +303,7 @@ class explosion_fineff : public final_effect
 {
 public:
     // One explosion at a time, please.
-    bool mergeable(const final_effect &) const override { return false; }
+    bool merge_key(fineff_key &) const override { return false; }
     void fire() override;
 
     static void schedule(bolt &beam, string boom, string sanct,
@@ -297,7 +333,7 @@ protected:
 class delayed_action_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &a) const override;
+    bool merge_key(fineff_key &key) const override;
     virtual void fire() override;
 
     static void schedule(daction_type action, const string &final_msg)
@@ -333,7 +369,7 @@ protected:
 class rakshasa_clone_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &a) const override;
+    bool merge_key(fineff_key &key) const override;
     void fire() override;
 
     static void schedule(const actor *defend, const coord_def &pos)
@@ -352,7 +388,7 @@ class bennu_revive_fineff : public final_effect
 {
 public:
     // Each trigger is from the death of a different bennu---no merging.
-    bool mergeable(const final_effect &) const override { return false; }
+    bool merge_key(fineff_key &) const override { return false; }
     void fire() override;
 
     static void schedule(coord_def pos, int revives, beh_type attitude,
@@ -377,7 +413,7 @@ class avoided_death_fineff : public final_effect
 {
 public:
     // Each trigger is from the death of a different monster---no merging.
-    bool mergeable(const final_effect &) const override { return false; }
+    bool merge_key(fineff_key &) const override { return false; }
     void fire() override;
 
     static void schedule(monster * mons)
@@ -400,7 +436,7 @@ protected:
 class infestation_death_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &) const override { return false; }
+    bool merge_key(fineff_key &) const override { return false; }
     void fire() override;
 
     static void schedule(coord_def pos, const string &name)
@@ -418,7 +454,7 @@ protected:
 class make_derived_undead_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &) const override { return false; }
+    bool merge_key(fineff_key &) const override { return false; }
     void fire() override;
 
     static void schedule(coord_def pos, mgen_data mg, int xl,
@@ -442,7 +478,7 @@ protected:
 class mummy_death_curse_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &) const override { return false; }
+    bool merge_key(fineff_key &) const override { return false; }
     void fire() override;
 
     static void schedule(const actor * attack, string name, killer_type killer, int pow)
@@ -465,7 +501,7 @@ protected:
 class summon_dismissal_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &fe) const override;
+    bool merge_key(fineff_key &key) const override;
     void merge(const final_effect &) override;
     void fire() override;
 
@@ -483,7 +519,7 @@ protected:
 class spectral_weapon_fineff : public final_effect
 {
 public:
-    bool mergeable(const final_effect &) const override { return false; };
+    bool merge_key(fineff_key &) const override { return false; };
     void fire() override;
 
     static void schedule(const actor &attack, const actor &defend)
@@ -498,3 +534,4 @@ protected:
 };
 
 void fire_final_effects();
+void clear_final_effects();
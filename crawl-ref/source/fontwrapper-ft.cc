@@ -62,6 +62,8 @@ FontWrapper* FontWrapper::create()
 
 FTFontWrapper::FTFontWrapper() :
     m_atlas(nullptr),
+    m_atlas_clock(0),
+    m_atlas_count(0),
     m_max_advance(0, 0),
     m_min_offset(0),
     charsz(1,1),
@@ -148,6 +150,10 @@ bool FTFontWrapper::configure_font()
 
     for (int i = 0; i < MAX_GLYPHS; i++)
         m_atlas[i] = FontAtlasEntry();
+    m_atlas_slot.clear();
+    m_atlas_used.assign(MAX_GLYPHS, 0);
+    m_atlas_clock = 0;
+    m_atlas_count = 0;
 
     // atlas[0] always contains a full-white block (never evicted)
     // this is currently used by colour_bar
@@ -213,8 +219,6 @@ bool FTFontWrapper::load_font(const char *font_name, unsigned int font_size)
     }
 
     m_atlas = new FontAtlasEntry[MAX_GLYPHS];
-    m_atlas_lru.clear();
-    m_atlas_lru.reserve(MAX_GLYPHS);
 
     return configure_font();
 }
@@ -321,28 +325,30 @@ unsigned int FTFontWrapper::map_unicode(char *ch)
 
 unsigned int FTFontWrapper::map_unicode(char32_t uchar)
 {
-    unsigned int c = MAX_GLYPHS;
-    for (unsigned int i = 1; i < MAX_GLYPHS; i++)
-        if (m_atlas[i].uchar == uchar)
-        {
-            c = i;
-            break;
-        }
+    if (uchar >= m_atlas_slot.size())
+        m_atlas_slot.resize(uchar + 1, 0);
 
-    if (c == MAX_GLYPHS) // not found: need to load into atlas
+    unsigned int c = m_atlas_slot[uchar];
+    if (!c) // not found: need to load into atlas
     {
-        bool atlas_full = m_atlas_lru.size() == MAX_GLYPHS-1;
-        c = atlas_full ? m_atlas_lru[0] : m_atlas_lru.size()+1;
+        if (m_atlas_count < MAX_GLYPHS - 1)
+            c = ++m_atlas_count;
+        else
+        {
+            // evict the least recently drawn glyph (slot 0 is never evicted)
+            c = 1;
+            for (unsigned int i = 2; i < MAX_GLYPHS; i++)
+                if (m_atlas_used[i] < m_atlas_used[c])
+                    c = i;
+            m_atlas_slot[m_atlas[c].uchar] = 0;
+        }
         m_atlas[c].uchar = uchar;
+        m_atlas_slot[uchar] = c;
         load_glyph(c, uchar);
         n_subst++;
     }
 
-    auto it = find(m_atlas_lru.begin(), m_atlas_lru.end(), (uint8_t)c);
-    if (it != m_atlas_lru.end())
-        m_atlas_lru.erase(it);
-    m_atlas_lru.push_back(c);
-
+    m_atlas_used[c] = ++m_atlas_clock;
     return c;
 }
 
@@ -130,7 +130,12 @@ protected:
         char32_t uchar;
     };
     FontAtlasEntry *m_atlas;
-    vector<char32_t> m_atlas_lru;
+    // atlas slot of each codepoint, indexed like m_glyphs; 0 if not loaded
+    vector<uint8_t> m_atlas_slot;
+    // when each atlas slot was last drawn, for picking one to evict
+    vector<uint64_t> m_atlas_used;
+    uint64_t m_atlas_clock;
+    unsigned int m_atlas_count;
 
     // count of glyph loads in the current text block
     int n_subst;
@@ -169,17 +169,21 @@ void formatted_string::parse_string1(const string &s, formatted_string &fs,
                 bound = 999;
 
             fs.cprintf(currs.substr(0, bound));
-            if (currs.size() > bound)
-                currs = currs.substr(bound);
-            else
-                currs.clear();
+            currs.erase(0, bound);
             tag--;
             continue;
         }
 
         if (s[tag] != '<' || tag >= length - 1)
         {
-            currs += s[tag];
+            // Take the whole run of text up to the next tag at once, but
+            // no more than fits before the string is broken up.
+            string::size_type next = s.find('<', tag + 1);
+            if (next == string::npos)
+                next = length;
+            const auto run = min(next - tag, 999 - currs.size());
+            currs.append(s, tag, run);
+            tag += run - 1;
             continue;
         }
 
@@ -212,7 +216,7 @@ void formatted_string::parse_string1(const string &s, formatted_string &fs,
         if (tagtext[0] == '/')
         {
             revert_colour = true;
-            tagtext = tagtext.substr(1);
+            tagtext.erase(0, 1);
             tag++;
         }
 
@@ -221,7 +225,7 @@ void formatted_string::parse_string1(const string &s, formatted_string &fs,
 
         if (!currs.empty())
         {
-            fs.cprintf(currs);
+            fs.ops.emplace_back(move(currs));
             currs.clear();
         }
 
@@ -261,7 +265,7 @@ void formatted_string::parse_string1(const string &s, formatted_string &fs,
         tag += tagtext.length() + 1;
     }
     if (currs.length())
-        fs.cprintf(currs);
+        fs.ops.emplace_back(move(currs));
 }
 
 /// Return a plaintext version of this string, sans tags, colours, etc.
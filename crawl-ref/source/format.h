@@ -85,7 +85,7 @@ public:
         {
         }
 
-        fs_op(const string &s) : type(FSOP_TEXT), colour(-1), text(s)
+        fs_op(string s) : type(FSOP_TEXT), colour(-1), text(move(s))
         {
         }
 
@@ -149,9 +149,7 @@ OGLStateManager::OGLStateManager()
     glClearColor(0.0, 0.0, 0.0, 1.0f);
     glDepthFunc(GL_LEQUAL);
 
-#ifdef __ANDROID__
     m_last_tex = 0;
-#endif
     m_window_height = 0;
 }
 
@@ -352,6 +350,11 @@ void OGLStateManager::delete_textures(size_t count, unsigned int *textures)
 {
     glDeleteTextures(count, (GLuint*)textures);
     glDebug("glDeleteTextures");
+
+    // Deleting the bound texture unbinds it, and its name may be reused.
+    for (size_t i = 0; i < count; i++)
+        if (textures[i] == (unsigned int) m_last_tex)
+            m_last_tex = 0;
 }
 
 void OGLStateManager::generate_textures(size_t count, unsigned int *textures)
@@ -362,11 +365,14 @@ void OGLStateManager::generate_textures(size_t count, unsigned int *textures)
 
 void OGLStateManager::bind_texture(unsigned int texture)
 {
+    // Each tile buffer binds its texture before drawing, and consecutive
+    // buffers often share one.
+    if (texture == (unsigned int) m_last_tex)
+        return;
+
     glBindTexture(GL_TEXTURE_2D, texture);
     glDebug("glBindTexture");
-#ifdef __ANDROID__
     m_last_tex = texture;
-#endif
 }
 
 void OGLStateManager::load_texture(unsigned char *pixels, unsigned int width,
@@ -622,36 +628,40 @@ void OGLShapeBuffer::add_rect(const GLWPrim &rect)
         m_colour_buffer[last + 3].set(rect.col_e);
     }
 
-    // build indices
-    last = m_ind_buffer.size();
+}
+
+// The triangle strip indices for drawing the given number of boxes. These
+// are the same for every buffer, so they're built once and shared rather
+// than per buffer on every frame.
+static const unsigned short int *_rect_indices(size_t boxes)
+{
+    static vector<unsigned short int> indices;
 
-    if (last > 3)
+    if (indices.empty())
+    {
+        // The first box doesn't need any degenerate triangles.
+        indices = { 0, 1, 2, 3 };
+    }
+
+    while (indices.size() < 4 + 6 * (boxes - 1))
     {
         // This is not the first box so make FOUR degenerate triangles
-        m_ind_buffer.resize(last + 6);
-        unsigned short int val = m_ind_buffer[last - 1];
+        unsigned short int val = indices.back();
 
         // the first three degens finish the previous box and move
         // to the first position of the new one we just added and
         // the fourth degen creates a triangle that is a line from p1 to p3
-        m_ind_buffer[last    ] = val++;
-        m_ind_buffer[last + 1] = val;
+        indices.push_back(val++);
+        indices.push_back(val);
 
         // Now add as normal
-        m_ind_buffer[last + 2] = val++;
-        m_ind_buffer[last + 3] = val++;
-        m_ind_buffer[last + 4] = val++;
-        m_ind_buffer[last + 5] = val;
-    }
-    else
-    {
-        // This is the first box so don't bother making any degenerate triangles
-        m_ind_buffer.resize(last + 4);
-        m_ind_buffer[0] = 0;
-        m_ind_buffer[1] = 1;
-        m_ind_buffer[2] = 2;
-        m_ind_buffer[3] = 3;
+        indices.push_back(val++);
+        indices.push_back(val++);
+        indices.push_back(val++);
+        indices.push_back(val);
     }
+
+    return indices.data();
 }
 
 void OGLShapeBuffer::add_line(const GLWPrim &rect)
@@ -706,9 +716,12 @@ void OGLShapeBuffer::draw(const GLState &state)
     switch (m_prim_type)
     {
     case GLW_RECTANGLE:
-        glDrawElements(GL_TRIANGLE_STRIP, m_ind_buffer.size(),
-                       GL_UNSIGNED_SHORT, &m_ind_buffer[0]);
+    {
+        const size_t boxes = m_position_buffer.size() / 4;
+        glDrawElements(GL_TRIANGLE_STRIP, 4 + 6 * (boxes - 1),
+                       GL_UNSIGNED_SHORT, _rect_indices(boxes));
         break;
+    }
     case GLW_LINES:
         glDrawArrays(GL_LINES, 0, m_position_buffer.size());
         break;
@@ -722,7 +735,6 @@ void OGLShapeBuffer::draw(const GLState &state)
 void OGLShapeBuffer::clear()
 {
     m_position_buffer.clear();
-    m_ind_buffer.clear();
     m_texture_buffer.clear();
     m_colour_buffer.clear();
 }
@@ -43,9 +43,7 @@ public:
     int device_to_logical(int n, bool round=true) const override;
 protected:
     GLState m_current_state;
-#ifdef __ANDROID__
-    GLint m_last_tex;
-#endif
+    GLint m_last_tex; // the texture bound now
     int m_window_height;
 
 private:
@@ -77,7 +75,6 @@ protected:
     vector<GLW_3VF> m_position_buffer;
     vector<GLW_2VF> m_texture_buffer;
     vector<VColour> m_colour_buffer;
-    vector<unsigned short int> m_ind_buffer;
 
 private:
     bool glDebug(const char* msg) const;
@@ -733,9 +733,10 @@ int ash_detect_portals(bool all)
 
     if (all)
     {
-        for (rectangle_iterator ri(0); ri; ++ri)
+        // Ash's portals are all stairs.
+        for (const coord_def &c : level_stairs())
         {
-            if (_check_portal(*ri))
+            if (_check_portal(c))
                 portals_found++;
         }
     }
@@ -877,6 +878,18 @@ void qazlal_storm_clouds()
 
     const int radius = you.piety >= piety_breakpoint(3) ? 2 : 1;
 
+    // Which cells within reach of the corridor check are open. Neighbouring
+    // candidates share most of their neighbours, so each cell is only
+    // looked at once; cells off the map count as solid.
+    const int span = radius + 1;
+    bool open[2 * 3 + 1][2 * 3 + 1]; // radius is at most 2
+    for (int dx = -span; dx <= span; ++dx)
+        for (int dy = -span; dy <= span; ++dy)
+        {
+            const coord_def c = you.pos() + coord_def(dx, dy);
+            open[dx + span][dy + span] = map_bounds(c) && !cell_is_solid(c);
+        }
+
     vector<coord_def> candidates;
     for (radius_iterator ri(you.pos(), radius, C_SQUARE, LOS_SOLID, true);
          ri; ++ri)
@@ -891,9 +904,11 @@ void qazlal_storm_clouds()
             continue;
 
         // No clouds in corridors.
-        for (adjacent_iterator ai(*ri); ai; ++ai)
-            if (!cell_is_solid(*ai))
-                count++;
+        const coord_def off = *ri - you.pos() + coord_def(span, span);
+        for (int dx = -1; dx <= 1; ++dx)
+            for (int dy = -1; dy <= 1; ++dy)
+                if ((dx || dy) && open[off.x + dx][off.y + dy])
+                    count++;
 
         if (count >= 5)
             candidates.push_back(*ri);
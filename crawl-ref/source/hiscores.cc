@@ -67,14 +67,17 @@ using namespace ui;
 
 #define SCORE_VERSION "0.1"
 
-// enough memory allocated to snarf in the scorefile entries
-static unique_ptr<scorefile_entry> hs_list[SCORE_FILE_ENTRIES];
-static int hs_list_size = 0;
+// The score file's lines, best first. Only the ones that are shown get
+// parsed into hs_list; adding a score only needs to know the others' points.
+static vector<string> hs_lines;
+static vector<unique_ptr<scorefile_entry>> hs_list;
 static bool hs_list_initalized = false;
 
 static FILE *_hs_open(const char *mode, const string &filename);
 static void  _hs_close(FILE *handle);
 static bool  _hs_read(FILE *scores, scorefile_entry &dest);
+static bool  _hs_read_line(FILE *scores, string &line);
+static int   _hs_line_score(const string &line);
 static void  _hs_write(FILE *scores, scorefile_entry &entry);
 static time_t _parse_time(const string &st);
 static string _xlog_escape(const string &s);
@@ -102,92 +105,94 @@ static string _log_file_name()
         "logfile" + crawl_state.game_type_qualifier());
 }
 
+// Forget what was read before, and hold lines in their place.
+static void _hs_set_lines(vector<string> lines)
+{
+    hs_lines = move(lines);
+    hs_list.clear();
+    hs_list.resize(hs_lines.size());
+    hs_list_initalized = true;
+}
+
+// The i'th best score, parsed when first asked for.
+static scorefile_entry &_hs_entry(int i)
+{
+    if (!hs_list[i])
+    {
+        hs_list[i].reset(new scorefile_entry);
+        hs_list[i]->parse(hs_lines[i]);
+    }
+    return *hs_list[i];
+}
+
 int hiscores_new_entry(const scorefile_entry &ne)
 {
     unwind_bool score_update(crawl_state.updating_scores, true);
 
-    FILE *scores;
-    int i;
-    bool inserted = false;
-    int newest_entry = -1;
-
     // open highscore file (reading) -- nullptr is fatal!
     //
     // Opening as a+ instead of r+ to force an exclusive lock (see
     // hs_open) and to create the file if it's not there already.
-    scores = _hs_open("a+", _score_file_name());
+    FILE *scores = _hs_open("a+", _score_file_name());
     if (scores == nullptr)
         end(1, true, "failed to open score file for writing");
 
     // we're at the end of the file, seek back to beginning.
     fseek(scores, 0, SEEK_SET);
 
-    // read highscore file, inserting new entry at appropriate point,
-    for (i = 0; i < SCORE_FILE_ENTRIES; i++)
+    // Read the scores, finding where the new one goes. Only the points of
+    // each are needed; the lines themselves are written back untouched.
+    vector<string> lines;
+    int newest_entry = -1;
+    long insert_at = 0;
+    string line;
+    while (lines.size() < SCORE_FILE_ENTRIES)
     {
-        hs_list[i].reset(new scorefile_entry);
-        if (_hs_read(scores, *hs_list[i]) == false)
+        const long pos = ftell(scores);
+        if (!_hs_read_line(scores, line))
             break;
-
-        // compare points..
-        if (!inserted && ne.get_score() >= hs_list[i]->get_score())
+        if (newest_entry == -1 && ne.get_score() >= _hs_line_score(line))
         {
-            newest_entry = i;           // for later printing
-            inserted = true;
-            // copy read entry to i+1th position
-            // Fixed a nasty overflow bug here -- Sharp
-            if (i+1 < SCORE_FILE_ENTRIES)
-            {
-                hs_list[i + 1] = move(hs_list[i]);
-                hs_list[i].reset(new scorefile_entry(ne));
-                i++;
-            }
-            else
-                *hs_list[i] = ne; // copy new entry to current position
+            newest_entry = lines.size();
+            insert_at = pos;
         }
+        lines.push_back(line);
     }
 
     // special case: lowest score, with room
-    if (!inserted && i < SCORE_FILE_ENTRIES)
+    if (newest_entry == -1 && lines.size() < SCORE_FILE_ENTRIES)
     {
-        newest_entry = i;
-        inserted = true;
-        // copy new entry
-        hs_list[i].reset(new scorefile_entry(ne));
-        i++;
+        newest_entry = lines.size();
+        insert_at = ftell(scores);
     }
 
-    hs_list_size = i;
-    hs_list_initalized = true;
-
     // If we've still not inserted it, it's not a highscore.
-    if (!inserted)
+    if (newest_entry == -1)
     {
+        _hs_set_lines(move(lines));
         _hs_close(scores);
         return -1;
     }
 
+    lines.insert(lines.begin() + newest_entry, ne.raw_string());
+    if (lines.size() > SCORE_FILE_ENTRIES)
+        lines.pop_back();
+
     // The old code closed and reopened the score file, leading to a
     // race condition where one Crawl process could overwrite the
     // other's highscore. Now we truncate and rewrite the file without
-    // closing it.
-    if (ftruncate(fileno(scores), 0))
+    // closing it; everything above the new score stays as it is.
+    if (ftruncate(fileno(scores), insert_at))
         end(1, true, "unable to truncate scorefile");
 
-    rewind(scores);
-
-    // write scorefile entries.
-    for (i = 0; i < hs_list_size; i++)
-    {
-        _hs_write(scores, *hs_list[i]);
+    fseek(scores, insert_at, SEEK_SET);
+    for (size_t i = newest_entry; i < lines.size(); i++)
+        fprintf(scores, "%s", lines[i].c_str());
 
-        // Leave in memory. Does this anyway if !inserted.
-        // Can write cleanup function if nessicary??
-        // hs_list[i].reset(nullptr);
-    }
-
-    // close scorefile.
     _hs_close(scores);
+
+    _hs_set_lines(move(lines));
+    hs_list[newest_entry].reset(new scorefile_entry(ne));
     return newest_entry;
 }
 
@@ -236,24 +241,17 @@ static void _hiscores_print_entry(const scorefile_entry &se,
 // Reads hiscores file to memory
 void hiscores_read_to_memory()
 {
-    FILE *scores;
-    int i;
-
     // open highscore file (reading)
-    scores = _hs_open("r", _score_file_name());
+    FILE *scores = _hs_open("r", _score_file_name());
     if (scores == nullptr)
         return;
 
     // read highscore file
-    for (i = 0; i < SCORE_FILE_ENTRIES; i++)
-    {
-        hs_list[i].reset(new scorefile_entry);
-        if (_hs_read(scores, *hs_list[i]) == false)
-            break;
-    }
-
-    hs_list_size = i;
-    hs_list_initalized = true;
+    vector<string> lines;
+    string line;
+    while (lines.size() < SCORE_FILE_ENTRIES && _hs_read_line(scores, line))
+        lines.push_back(line);
+    _hs_set_lines(move(lines));
 
     //close off
     _hs_close(scores);
@@ -303,7 +301,7 @@ string hiscores_print_list(int display_count, int format, int newest_entry, int&
     if (display_count <= 0)
         return "";
 
-    total_entries = hs_list_size;
+    total_entries = hs_lines.size();
 
     int start = newest_entry - display_count / 2;
 
@@ -321,7 +319,7 @@ string hiscores_print_list(int display_count, int format, int newest_entry, int&
         if (i == newest_entry)
             ret += "<yellow>";
 
-        _hiscores_print_entry(*hs_list[i], i, format, [&ret](const char */*fmt*/, const char *s){
+        _hiscores_print_entry(_hs_entry(i), i, format, [&ret](const char */*fmt*/, const char *s){
             ret += string(s);
         });
 
@@ -460,24 +458,13 @@ UIHiscoresMenu::UIHiscoresMenu()
 
 void UIHiscoresMenu::_construct_hiscore_table()
 {
-    FILE *scores = _hs_open("r", _score_file_name());
-
-    if (scores == nullptr)
+    hs_list_initalized = false;
+    hiscores_read_to_memory();
+    if (!hs_list_initalized)
         return;
 
-    int i;
-    // read highscore file
-    for (i = 0; i < SCORE_FILE_ENTRIES; i++)
-    {
-        hs_list[i].reset(new scorefile_entry);
-        if (_hs_read(scores, *hs_list[i]) == false)
-            break;
-    }
-
-    _hs_close(scores);
-
-    for (int j=0; j<i; j++)
-        _add_hiscore_row(*hs_list[j], j);
+    for (int j = 0; j < (int) hs_lines.size(); j++)
+        _add_hiscore_row(_hs_entry(j), j);
 }
 
 void UIHiscoresMenu::_add_hiscore_row(scorefile_entry& se, int id)
@@ -489,7 +476,7 @@ void UIHiscoresMenu::_add_hiscore_row(scorefile_entry& se, int id)
     tmp->set_margin_for_sdl(2);
     btn->set_child(move(tmp));
     btn->on_activate_event([id](const ActivateEvent&) {
-        _show_morgue(*hs_list[id]);
+        _show_morgue(_hs_entry(id));
         return true;
     });
     btn->on_focusin_event([this, se](const FocusEvent&) {
@@ -610,18 +597,41 @@ static void _hs_close(FILE *handle)
 }
 
 static bool _hs_read(FILE *scores, scorefile_entry &dest)
+{
+    string line;
+    dest.reset();
+    return _hs_read_line(scores, line) && dest.parse(line);
+}
+
+// Reads a line of the score file without parsing it. Like _hs_read(), this
+// stops at a 4.0-style line, which scorefile_entry::parse() won't take.
+static bool _hs_read_line(FILE *scores, string &line)
 {
     char inbuf[1300];
     if (!scores || feof(scores))
         return false;
 
-    memset(inbuf, 0, sizeof inbuf);
-    dest.reset();
-
     if (!fgets(inbuf, sizeof inbuf, scores))
         return false;
 
-    return dest.parse(inbuf);
+    line = inbuf;
+    if (line[0] == ':')
+    {
+        dprf("Corrupted xlog-line: %s", line.c_str());
+        return false;
+    }
+    return true;
+}
+
+// A score line's points, as scorefile_entry would read them, without the
+// rest of the parsing.
+static int _hs_line_score(const string &line)
+{
+    int score = 0;
+    for (const string &field : _xlog_split_fields(line))
+        if (starts_with(field, "sc="))
+            score = atoi(field.c_str() + 3);
+    return score;
 }
 
 static int _val_char(char digit)
@@ -3019,8 +3029,63 @@ void sync_last_milestone()
 }
 #endif
 
+#ifdef DGL_MILESTONES
+// Milestone lines waiting for flush_milestones(), oldest first, with the
+// file each goes to.
+static vector<pair<string, string>> _pending_milestones;
+#endif
+#ifdef DGL_WHEREIS
+// Only the latest whereis line matters, since the file is replaced.
+static unique_ptr<xlog_fields> _pending_whereis;
+#endif
+
+/**
+ * Write out the milestones and whereis status that have been put off until
+ * now. Gameplay only queues them, so that stairs and god events don't wait
+ * on the disk; they're written at each save and when the game ends, in the
+ * order they happened.
+ *
+ * @param sync  Also make sure the milestones have reached the disk, because
+ *              crawl is about to exit.
+ */
+void flush_milestones(bool sync)
+{
+#ifdef DGL_MILESTONES
+    for (size_t i = 0; i < _pending_milestones.size();)
+    {
+        // Write each run of lines for the same file under one lock.
+        const string &file = _pending_milestones[i].first;
+        FILE *fp = lk_open("a", file);
+        for (; i < _pending_milestones.size()
+               && _pending_milestones[i].first == file; ++i)
+        {
+            if (fp)
+                fprintf(fp, "%s\n", _pending_milestones[i].second.c_str());
+        }
+        if (fp && sync)
+        {
+            fflush(fp);
+#ifdef UNIX
+            fsync(fileno(fp));
+#endif
+        }
+        lk_close(fp);
+    }
+    _pending_milestones.clear();
+#endif
+#ifdef DGL_WHEREIS
+    if (_pending_whereis)
+    {
+        whereis_record(*_pending_whereis);
+        _pending_whereis.reset();
+    }
+#endif
+    UNUSED(sync);
+}
+
 /**
  * @brief Record the player reaching a milestone, if ::DGL_MILESTONES is defined.
+ * The milestones file is written by flush_milestones().
  * @callergraph
  */
 void mark_milestone(const string &type, const string &milestone,
@@ -3078,14 +3143,10 @@ void mark_milestone(const string &type, const string &milestone,
         return;
 #endif
 
-    const string xlog_line = xl.xlog_line();
-    const string milestone_file = catpath(
-        Options.save_dir, "milestones" + crawl_state.game_type_qualifier());
-    if (FILE *fp = lk_open("a", milestone_file))
-    {
-        fprintf(fp, "%s\n", xlog_line.c_str());
-        lk_close(fp);
-    }
+    _pending_milestones.emplace_back(
+        catpath(Options.save_dir,
+                "milestones" + crawl_state.game_type_qualifier()),
+        xl.xlog_line());
 #endif
 #else
     UNUSED(type, milestone, origin_level, milestone_time);
@@ -3131,7 +3192,7 @@ void update_whereis(const char *status)
     tiles.send_milestone(xl);
 #endif
 #ifdef DGL_WHEREIS
-    whereis_record(xl);
+    _pending_whereis.reset(new xlog_fields(xl));
 #endif
 #else
     UNUSED(status);
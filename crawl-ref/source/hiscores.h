@@ -35,6 +35,7 @@ void mark_milestone(const string &type, const string &milestone,
                     const string &origin_level = "", time_t t = 0);
 
 void update_whereis(const char *status = "active");
+void flush_milestones(bool sync = false);
 
 #if defined(USE_TILE_WEB)
 void sync_last_milestone();
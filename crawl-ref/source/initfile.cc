@@ -266,6 +266,7 @@ const vector<GameOption*> game_options::build_options_list()
         new BoolGameOption(SIMPLE_NAME(travel_key_stop), true),
         new BoolGameOption(SIMPLE_NAME(travel_one_unsafe_move), false),
         new BoolGameOption(SIMPLE_NAME(dump_on_save), true),
+        new BoolGameOption(SIMPLE_NAME(key_journal), false),
         new BoolGameOption(SIMPLE_NAME(rest_wait_both), false),
         new BoolGameOption(SIMPLE_NAME(rest_wait_ancestor), false),
         new BoolGameOption(SIMPLE_NAME(cloud_status), !is_tiles()),
@@ -307,6 +308,8 @@ const vector<GameOption*> game_options::build_options_list()
         new IntGameOption(SIMPLE_NAME(hp_warning), 30, 0, 100),
         new IntGameOption(magic_point_warning, {"mp_warning"}, 0, 0, 100),
         new IntGameOption(SIMPLE_NAME(autofight_warning), 0, 0, 1000),
+        new IntGameOption(SIMPLE_NAME(lua_gc_pause), 200, 50, 1000),
+        new IntGameOption(SIMPLE_NAME(lua_gc_stepmul), 200, 100, 1000),
         // These need to be odd, hence allow +1.
         new IntGameOption(SIMPLE_NAME(view_max_width),
                       max(VIEW_BASE_WIDTH, VIEW_MIN_WIDTH),
@@ -385,6 +388,7 @@ const vector<GameOption*> game_options::build_options_list()
              {"classic", level_gen_type::classic},
              {"false", level_gen_type::classic}
             }, true),
+        new IntGameOption(SIMPLE_NAME(pregen_lookahead), 0, 0, 27),
 
 #ifdef DGL_SIMPLE_MESSAGING
         new BoolGameOption(SIMPLE_NAME(messaging), true),
@@ -580,10 +584,10 @@ const vector<GameOption*> game_options::build_options_list()
     return options;
 }
 
-map<string, GameOption*> game_options::build_options_map(
+unordered_map<string, GameOption*> game_options::build_options_map(
     const vector<GameOption*> &options)
 {
-    map<string, GameOption*> option_map;
+    unordered_map<string, GameOption*> option_map;
     for (GameOption* option : options)
         for (string name : option->getNames())
             option_map[name] = option;
@@ -1180,6 +1184,9 @@ void game_options::reset_paths()
 
 void game_options::reset_options()
 {
+    // Anything kept for the old options is stale now.
+    ++lines_read;
+
     // XXX: do we really need to rebuild the list and map every time?
     // Will they ever change within a single execution of Crawl?
     // GameOption::value's value will change of course, but not the reference.
@@ -2939,6 +2946,25 @@ static bool _is_autopickup_ban(pair<text_pattern, bool> entry)
     return !entry.second;
 }
 
+// Options whose values keep their case. Options with "font" in their name,
+// and the old cset options, do too.
+static const unordered_set<string> _case_sensitive_options =
+{
+    "name", "crawl_dir", "macro_dir", "combo", "species", "background", "job",
+    "race", "class", "ban_pickup", "autopickup_exceptions",
+    "explore_stop_pickup_ignore", "stop_travel", "force_more_message",
+    "flash_screen_message", "confirm_action", "drop_filter", "lua_file",
+    "terp_file", "note_items", "autoinscribe", "note_monsters",
+    "note_messages", "display_char", "dungeon", "feature", "mon_glyph",
+    "item_glyph", "fire_items_start", "opt", "option", "menu_colour",
+    "menu_color", "message_colour", "message_color", "levels", "level",
+    "entries", "include", "bindkey", "spell_slot", "item_slot",
+    "ability_slot", "sound", "hold_sound", "sound_file_path",
+#ifdef USE_TILE_WEB
+    "action_panel_filter",
+#endif
+};
+
 void game_options::read_option_line(const string &str, bool runscript)
 {
 #define NEWGAME_OPTION(_opt, _conv, _type)                                     \
@@ -2955,6 +2981,8 @@ void game_options::read_option_line(const string &str, bool runscript)
         else                                                                   \
             _opt.push_back(_conv(part));                                       \
     }
+    ++lines_read;
+
     string key    = "";
     string subkey = "";
     string field  = "";
@@ -3033,35 +3061,8 @@ void game_options::read_option_line(const string &str, bool runscript)
     // Keep unlowercased field around
     const string orig_field = field;
 
-    if (key != "name" && key != "crawl_dir" && key != "macro_dir"
-        && key != "combo"
-        && key != "species" && key != "background" && key != "job"
-        && key != "race" && key != "class" && key != "ban_pickup"
-        && key != "autopickup_exceptions"
-        && key != "explore_stop_pickup_ignore"
-        && key != "stop_travel"
-        && key != "force_more_message"
-        && key != "flash_screen_message"
-        && key != "confirm_action"
-        && key != "drop_filter" && key != "lua_file" && key != "terp_file"
-        && key != "note_items" && key != "autoinscribe"
-        && key != "note_monsters" && key != "note_messages"
-        && key != "display_char" && !starts_with(key, "cset") // compatibility
-        && key != "dungeon" && key != "feature"
-        && key != "mon_glyph" && key != "item_glyph"
-        && key != "fire_items_start"
-        && key != "opt" && key != "option"
-        && key != "menu_colour" && key != "menu_color"
-        && key != "message_colour" && key != "message_color"
-        && key != "levels" && key != "level" && key != "entries"
-        && key != "include" && key != "bindkey"
-        && key != "spell_slot"
-        && key != "item_slot"
-        && key != "ability_slot"
-        && key != "sound" && key != "hold_sound" && key != "sound_file_path"
-#ifdef USE_TILE_WEB
-        && key != "action_panel_filter"
-#endif
+    if (!_case_sensitive_options.count(key)
+        && !starts_with(key, "cset") // compatibility
         && key.find("font") == string::npos)
     {
         lowercase(field);
@@ -4273,10 +4274,17 @@ enum commandline_option_type
     CLO_MAPSTAT,
     CLO_MAPSTAT_DUMP_DISCONNECT,
     CLO_OBJSTAT,
+    CLO_SEEDCAT,
     CLO_ITERATIONS,
+    CLO_JOBS,
     CLO_FORCE_MAP,
+    CLO_MAPSTAT_BASELINE,
+    CLO_FSIM,
     CLO_ARENA,
+    CLO_ARENA_BATCH,
+    CLO_REPLAY,
     CLO_DUMP_MAPS,
+    CLO_STARTUP_PROFILE,
     CLO_TEST,
     CLO_SCRIPT,
     CLO_BUILDDB,
@@ -4309,6 +4317,11 @@ enum commandline_option_type
     CLO_WEBTILES_SOCKET,
     CLO_AWAIT_CONNECTION,
     CLO_PRINT_WEBTILES_OPTIONS,
+    CLO_ZYGOTE,
+#endif
+#ifdef DEBUG_PROFILE
+    CLO_PROFILE_DUMP,
+    CLO_PROFILE_TURNS,
 #endif
 
     CLO_NOPS
@@ -4318,14 +4331,20 @@ static const char *cmd_ops[] =
 {
     "scores", "name", "species", "background", "dir", "rc", "rcdir", "tscores",
     "vscores", "scorefile", "morgue", "macro", "mapstat", "dump-disconnect",
-    "objstat", "iters", "force-map", "arena", "dump-maps", "test", "script",
-    "builddb", "help", "version", "seed", "pregen", "save-version", "sprint",
-    "extra-opt-first", "extra-opt-last", "sprint-map", "edit-save",
+    "objstat", "seedcat", "iters", "jobs", "force-map",
+    "mapstat-baseline", "fsim", "arena",
+    "arena-batch", "replay", "dump-maps", "startup-profile", "test", "script",
+    "builddb", "help", "version", "seed", "pregen", "save-version",
+    "sprint", "extra-opt-first", "extra-opt-last", "sprint-map", "edit-save",
     "print-charset", "tutorial", "wizard", "explore", "no-save",
     "no-player-bones", "gdb", "no-gdb", "nogdb", "throttle", "no-throttle",
     "playable-json", "branches-json", "save-json", "gametypes-json", "bones",
 #ifdef USE_TILE_WEB
     "webtiles-socket", "await-connection", "print-webtiles-options",
+    "zygote",
+#endif
+#ifdef DEBUG_PROFILE
+    "profile-dump", "profile-turns",
 #endif
 };
 
@@ -5102,8 +5121,8 @@ bool parse_args(int argc, char **argv, bool rc_only)
     COMPILE_CHECK(ARRAYSZ(cmd_ops) == CLO_NOPS);
 
 #ifndef DEBUG_STATISTICS
-    const char *dbg_stat_err = "mapstat and objstat are available only in "
-                               "DEBUG_STATISTICS builds.\n";
+    const char *dbg_stat_err = "mapstat, objstat and seedcat are available "
+                               "only in DEBUG_STATISTICS builds.\n";
 #endif
 
     if (crawl_state.command_line_arguments.empty())
@@ -5124,6 +5143,8 @@ bool parse_args(int argc, char **argv, bool rc_only)
 
     SysEnv.rcdirs.clear();
     SysEnv.map_gen_iters = 0;
+    SysEnv.map_gen_jobs = 1;
+    SysEnv.map_gen_threshold = 2.0;
 
     if (argc < 2)           // no args!
         return true;
@@ -5276,6 +5297,47 @@ bool parse_args(int argc, char **argv, bool rc_only)
             break;
 #else
             end(1, false, "%s", dbg_stat_err);
+#endif
+        case CLO_SEEDCAT:
+#ifdef DEBUG_STATISTICS
+            crawl_state.seed_cat_gen = true;
+#ifdef USE_TILE_LOCAL
+            crawl_state.tiles_disabled = true;
+#endif
+            SysEnv.seed_cat_first = SysEnv.seed_cat_last = 0;
+            if (!next_is_param
+                || !sscanf(next_arg, "%" SCNu64, &SysEnv.seed_cat_first))
+            {
+                end(1, false, "Seed range required for -%s\n", arg);
+            }
+            if (!strchr(next_arg, '-')
+                || !sscanf(strchr(next_arg, '-') + 1, "%" SCNu64,
+                           &SysEnv.seed_cat_last))
+            {
+                SysEnv.seed_cat_last = SysEnv.seed_cat_first;
+            }
+            if (SysEnv.seed_cat_last < SysEnv.seed_cat_first)
+                end(1, false, "Bad seed range for -%s: %s\n", arg, next_arg);
+            nextUsed = true;
+
+            // The levels to catalog, in -mapstat syntax.
+            if (current + 2 < argc && argv[current + 2][0] != '-')
+            {
+                SysEnv.map_gen_range.reset(new depth_ranges);
+                try
+                {
+                    *SysEnv.map_gen_range =
+                        depth_ranges::parse_depth_ranges(argv[current + 2]);
+                }
+                catch (const bad_level_id &err)
+                {
+                    end(1, false, "Error parsing depths: %s\n", err.what());
+                }
+                current++;
+            }
+            break;
+#else
+            end(1, false, "%s", dbg_stat_err);
 #endif
         case CLO_MAPSTAT_DUMP_DISCONNECT:
 #ifdef DEBUG_STATISTICS
@@ -5301,6 +5363,21 @@ bool parse_args(int argc, char **argv, bool rc_only)
 #endif
             break;
 
+        case CLO_JOBS:
+#if defined(DEBUG_STATISTICS) || defined(WIZARD)
+            if (!next_is_param || !isadigit(*next_arg))
+                end(1, false, "Integer argument required for -%s\n", arg);
+            else
+            {
+                // 0 for one per CPU.
+                SysEnv.map_gen_jobs = atoi(next_arg);
+                nextUsed = true;
+            }
+#else
+            end(1, false, "%s", dbg_stat_err);
+#endif
+            break;
+
         case CLO_FORCE_MAP:
 #ifdef DEBUG_STATISTICS
             if (!next_is_param)
@@ -5315,6 +5392,46 @@ bool parse_args(int argc, char **argv, bool rc_only)
 #endif
             break;
 
+        case CLO_MAPSTAT_BASELINE:
+#ifdef DEBUG_STATISTICS
+            if (!next_is_param)
+                end(1, false, "Baseline file required for -%s\n", arg);
+            SysEnv.map_gen_baseline = next_arg;
+            nextUsed = true;
+
+            // How many times slower a level may get, if given.
+            if (current + 2 < argc && isadigit(*argv[current + 2]))
+            {
+                SysEnv.map_gen_threshold = atof(argv[current + 2]);
+                if (SysEnv.map_gen_threshold <= 1.0)
+                {
+                    end(1, false, "Threshold for -%s must be more than 1\n",
+                        arg);
+                }
+                current++;
+            }
+#else
+            end(1, false, "%s", dbg_stat_err);
+#endif
+            break;
+
+        case CLO_FSIM:
+#ifdef WIZARD
+            if (!next_is_param)
+                end(1, false, "Matchups required for -%s\n", arg);
+            else
+            {
+                crawl_state.fsim_sweep = next_arg;
+#ifdef USE_TILE_LOCAL
+                crawl_state.tiles_disabled = true;
+#endif
+                nextUsed = true;
+            }
+#else
+            end(1, false, "-%s is available only in wizard builds.\n", arg);
+#endif
+            break;
+
         case CLO_ARENA:
             if (!rc_only)
             {
@@ -5329,10 +5446,40 @@ bool parse_args(int argc, char **argv, bool rc_only)
             }
             break;
 
+        case CLO_ARENA_BATCH:
+            if (!next_is_param || !isadigit(*next_arg) || atoi(next_arg) < 1)
+                end(1, false, "Number of fights required for -%s\n", arg);
+            else
+            {
+                if (!rc_only)
+                {
+                    Options.game.type = GAME_TYPE_ARENA;
+                    Options.restart_after_game = MB_FALSE;
+                }
+                crawl_state.arena_batch = atoi(next_arg);
+                nextUsed = true;
+            }
+            break;
+
+        case CLO_REPLAY:
+            if (!next_is_param)
+                return false;
+            if (!rc_only)
+            {
+                crawl_state.replay_journal = next_arg;
+                Options.restart_after_game = MB_FALSE;
+            }
+            nextUsed = true;
+            break;
+
         case CLO_DUMP_MAPS:
             crawl_state.dump_maps = true;
             break;
 
+        case CLO_STARTUP_PROFILE:
+            crawl_state.startup_profile = true;
+            break;
+
         case CLO_PLAYABLE_JSON:
             fprintf(stdout, "%s", playable_metadata_json().c_str());
             end(0);
@@ -5569,6 +5716,31 @@ bool parse_args(int argc, char **argv, bool rc_only)
                 end(0);
             }
             break;
+
+        case CLO_ZYGOTE:
+            if (!next_is_param)
+                return false;
+            SysEnv.zygote_socket = next_arg;
+            nextUsed = true;
+            break;
+#endif
+
+#ifdef DEBUG_PROFILE
+        case CLO_PROFILE_DUMP:
+            if (!next_is_param)
+                return false;
+            if (!rc_only)
+                SysEnv.profile_dump_file = next_arg;
+            nextUsed = true;
+            break;
+
+        case CLO_PROFILE_TURNS:
+            if (!next_is_param)
+                return false;
+            if (!rc_only)
+                SysEnv.profile_turns_file = next_arg;
+            nextUsed = true;
+            break;
 #endif
 
         case CLO_PRINT_CHARSET:
@@ -61,7 +61,21 @@ public:
     vector<string> cmd_args;
 
     int map_gen_iters;
+    int map_gen_jobs;
+    uint64_t seed_cat_first;
+    uint64_t seed_cat_last;
     unique_ptr<depth_ranges> map_gen_range;
+    string map_gen_baseline;       // mapstat.json to compare build times to.
+    double map_gen_threshold;      // How many times slower is a regression.
+
+#ifdef DEBUG_PROFILE
+    string profile_dump_file;      // Where to write the profile report on exit.
+    string profile_turns_file;     // Where to write each turn's profile.
+#endif
+
+#ifdef USE_TILE_WEB
+    string zygote_socket;          // Fork games on requests from here.
+#endif
 
     vector<string> extra_opts_first;
     vector<string> extra_opts_last;
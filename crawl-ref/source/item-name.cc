@@ -127,10 +127,103 @@ static string _item_inscription(const item_def &item)
                                              ", ").c_str());
 }
 
+namespace
+{
+    struct memo_name
+    {
+        // the arguments to name()
+        description_level_type descrip;
+        bool terse, ident, with_inscription, quantity_in_words;
+        iflags_t ignore_flags;
+
+        // enough of the item to tell a different item at the same address
+        object_class_type base_type;
+        uint8_t sub_type;
+        short plus, plus2;
+        int special;
+        uint8_t rnd;
+        short quantity;
+        iflags_t flags;
+        short link;
+        coord_def pos;
+        string inscription;
+
+        string name;
+
+        bool matches(const item_def &item, const memo_name &args) const
+        {
+            return descrip == args.descrip && terse == args.terse
+                && ident == args.ident
+                && with_inscription == args.with_inscription
+                && quantity_in_words == args.quantity_in_words
+                && ignore_flags == args.ignore_flags
+                && base_type == item.base_type && sub_type == item.sub_type
+                && plus == item.plus && plus2 == item.plus2
+                && special == item.special && rnd == item.rnd
+                && quantity == item.quantity && flags == item.flags
+                && link == item.link && pos == item.pos
+                && inscription == item.inscription;
+        }
+    };
+}
+
+static map<const item_def *, vector<memo_name>> *_name_memo = nullptr;
+
+item_name_memo::item_name_memo() : owner(!_name_memo)
+{
+    if (owner)
+        _name_memo = new map<const item_def *, vector<memo_name>>;
+}
+
+item_name_memo::~item_name_memo()
+{
+    if (owner)
+    {
+        delete _name_memo;
+        _name_memo = nullptr;
+    }
+}
+
 string item_def::name(description_level_type descrip, bool terse, bool ident,
                       bool with_inscription, bool quantity_in_words,
                       iflags_t ignore_flags) const
 {
+    if (_name_memo)
+    {
+        memo_name args;
+        args.descrip = descrip;
+        args.terse = terse;
+        args.ident = ident;
+        args.with_inscription = with_inscription;
+        args.quantity_in_words = quantity_in_words;
+        args.ignore_flags = ignore_flags;
+
+        vector<memo_name> &names = (*_name_memo)[this];
+        for (const memo_name &memo : names)
+            if (memo.matches(*this, args))
+                return memo.name;
+
+        {
+            unwind_var<map<const item_def *, vector<memo_name>> *>
+                no_memo(_name_memo, nullptr);
+            args.name = name(descrip, terse, ident, with_inscription,
+                             quantity_in_words, ignore_flags);
+        }
+        args.base_type = base_type;
+        args.sub_type = sub_type;
+        args.plus = plus;
+        args.plus2 = plus2;
+        args.special = special;
+        args.rnd = rnd;
+        args.quantity = quantity;
+        args.flags = flags;
+        args.link = link;
+        args.pos = pos;
+        args.inscription = inscription;
+        names.push_back(args);
+        return args.name;
+    }
+
     if (crawl_state.game_is_arena())
         ignore_flags |= ISFLAG_KNOW_PLUSES | ISFLAG_COSMETIC_MASK;
 
@@ -2530,12 +2623,21 @@ bool is_interesting_item(const item_def& item)
     if (fully_identified(item) && is_artefact(item))
         return true;
 
-    const string iname = item_prefix(item, false) + " " + item.name(DESC_PLAIN);
-    for (const text_pattern &pat : Options.note_items)
-        if (pat.matches(iname))
-            return true;
+    static pattern_set note_patterns;
+    static unsigned int note_patterns_version = UINT_MAX;
+    if (note_patterns_version != Options.lines_read)
+    {
+        note_patterns.clear();
+        for (const text_pattern &pat : Options.note_items)
+            note_patterns.add(pat);
+        note_patterns_version = Options.lines_read;
+    }
 
-    return false;
+    if (note_patterns.empty())
+        return false;
+
+    const string iname = item_prefix(item, false) + " " + item.name(DESC_PLAIN);
+    return note_patterns.matches(iname);
 }
 
 /**
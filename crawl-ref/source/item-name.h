@@ -145,6 +145,21 @@ bool set_ident_type(item_def &item, bool identify, bool check_last=true);
 bool set_ident_type(object_class_type basetype, int subtype, bool identify,
                     bool check_last=true);
 
+/**
+ * While one of these is alive, item_def::name() remembers the names it
+ * builds, for each item and set of arguments. Put one around a pass that
+ * names the same items over and over (stash searches, greedy explore) and
+ * that doesn't change any item or what the player knows about them.
+ */
+class item_name_memo
+{
+public:
+    item_name_memo();
+    ~item_name_memo();
+private:
+    bool owner;
+};
+
 string item_prefix(const item_def &item, bool temp = true);
 string menu_colour_item_name(const item_def &item,
                                    description_level_type desc);
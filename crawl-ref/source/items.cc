@@ -478,6 +478,8 @@ int get_mitm_slot(int reserve)
 
     int item = NON_ITEM;
 
+    // There's no free list to consult: an item is freed by anything that
+    // zeroes its quantity or base type, not just by destroy_item().
     for (item = 0; item < (MAX_ITEMS - reserve); item++)
         if (!env.item[item].defined())
             break;
@@ -2705,9 +2707,17 @@ static bool _drop_item_order(const SelItem &first, const SelItem &second)
     return first.slot < second.slot;
 }
 
+static unsigned int _autopickup_settings_version = 0;
+
 void set_item_autopickup(const item_def &item, autopickup_level_type ap)
 {
     you.force_autopickup[item.base_type][_autopickup_subtype(item)] = ap;
+    ++_autopickup_settings_version;
+}
+
+unsigned int autopickup_settings_version()
+{
+    return _autopickup_settings_version;
 }
 
 int item_autopickup_level(const item_def &item)
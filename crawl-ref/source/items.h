@@ -145,6 +145,8 @@ bool need_to_autopickup();
 void autopickup(bool forced = false);
 
 void set_item_autopickup(const item_def &item, autopickup_level_type ap);
+// Changes whenever set_item_autopickup() does.
+unsigned int autopickup_settings_version();
 int item_autopickup_level(const item_def &item);
 
 int find_free_slot(const item_def &i);
@@ -0,0 +1,156 @@
+/**
+ * @file
+ * @brief Spreading independent computations over several threads.
+ *
+ * The workers are started the first time there's a batch big enough to
+ * share, and then sleep between batches. Indices are handed out one at a
+ * time to whichever thread asks next, the calling thread included, so a
+ * slow job doesn't hold up the others.
+ *
+ * threads.h's condition variables can miss a wakeup on some platforms, so
+ * nothing depends on one arriving: the caller works through the batch
+ * itself, and then only waits for the jobs the workers have already
+ * taken.
+**/
+
+#include "AppHdr.h"
+
+#include "job-pool.h"
+
+#ifndef TARGET_OS_WINDOWS
+# include <sched.h>
+# include <unistd.h>
+#endif
+
+#include "threads.h"
+
+// More than this doesn't help with the batch sizes crawl has.
+static const int MAX_WORKERS = 7;
+
+static thread_local bool _in_job = false;
+
+// Everything here is protected by _pool_lock.
+static mutex_t _pool_lock;
+static cond_t _work_ready;
+static const function<void(int)> *_job = nullptr;
+static int _next = 0;
+static int _size = 0;
+static int _running = 0; // workers holding a job from this batch
+static thread_t _workers[MAX_WORKERS];
+static int _num_workers = -1; // not started yet
+
+static int _cpu_count()
+{
+#ifdef TARGET_OS_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#else
+    return sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+}
+
+static void _yield()
+{
+#ifdef TARGET_OS_WINDOWS
+    Sleep(0);
+#else
+    sched_yield();
+#endif
+}
+
+// Run jobs from the batch until there are none left. Called and returns
+// with _pool_lock held.
+static void _run_jobs(const function<void(int)> &job)
+{
+    _in_job = true;
+    while (_next < _size)
+    {
+        const int i = _next++;
+        // Someone else could be taking the next one meanwhile.
+        if (_next < _size)
+            cond_wake(_work_ready);
+        mutex_unlock(_pool_lock);
+        job(i);
+        mutex_lock(_pool_lock);
+    }
+    _in_job = false;
+}
+
+static void *_worker_main(void *)
+{
+    mutex_lock(_pool_lock);
+    while (true)
+    {
+        while (!_job || _next >= _size)
+            cond_wait(_work_ready, _pool_lock);
+
+        ++_running;
+        _run_jobs(*_job);
+        --_running;
+    }
+    return nullptr;
+}
+
+static void _start_workers()
+{
+    mutex_init(_pool_lock);
+    cond_init(_work_ready);
+
+    _num_workers = 0;
+    const int wanted = min(_cpu_count() - 1, MAX_WORKERS);
+    for (int i = 0; i < wanted; ++i)
+    {
+        // Without a worker, the caller just does more of the work.
+        if (thread_create_joinable(&_workers[_num_workers], _worker_main,
+                                   nullptr))
+        {
+            break;
+        }
+        ++_num_workers;
+    }
+}
+
+void parallel_for(int n, const function<void(int)> &job, int min_batch)
+{
+    if (n < max(min_batch, 2) || _in_job || !_num_workers)
+    {
+        for (int i = 0; i < n; ++i)
+            job(i);
+        return;
+    }
+
+    if (_num_workers < 0)
+    {
+        _start_workers();
+        if (!_num_workers)
+        {
+            parallel_for(n, job, min_batch);
+            return;
+        }
+    }
+
+    mutex_lock(_pool_lock);
+    _job = &job;
+    _next = 0;
+    _size = n;
+    cond_wake(_work_ready);
+
+    _run_jobs(job);
+
+    // The workers' last jobs are already running, so this isn't long.
+    while (_running)
+    {
+        mutex_unlock(_pool_lock);
+        _yield();
+        mutex_lock(_pool_lock);
+    }
+    _job = nullptr;
+    _size = 0;
+    mutex_unlock(_pool_lock);
+}
+
+bool in_parallel_job()
+{
+    return _in_job;
+}
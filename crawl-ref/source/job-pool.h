@@ -0,0 +1,26 @@
+/**
+ * @file
+ * @brief Spreading independent computations over several threads.
+**/
+
+#pragma once
+
+#include <functional>
+
+/**
+ * Call job(i) for every i in [0, n), on the main thread and any idle
+ * workers, and return once all of them are done.
+ *
+ * The jobs run at the same time, in no particular order, so each one may
+ * only read game state, write to its own part of the caller's output, and
+ * not use the RNG, print messages or touch any cache. The caller combines
+ * the results afterwards, in index order, so they don't depend on how the
+ * work was split up.
+ *
+ * Small batches aren't worth waking the workers for; below min_batch jobs,
+ * everything runs on the calling thread.
+ */
+void parallel_for(int n, const function<void(int)> &job, int min_batch = 4);
+
+/// Is this thread running a parallel_for() job?
+bool in_parallel_job();
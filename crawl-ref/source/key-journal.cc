@@ -0,0 +1,251 @@
+/**
+ * @file
+ * @brief Recording the keys of a game, and playing them back.
+ *
+ * A journal starts with the game's seed and character, then has one line
+ * per key read from the terminal:
+ *
+ *   k <key>     getch_ck() returned key.
+ *   h <n>       kbhit() said a key was waiting, after n calls that didn't
+ *               since the last entry. Travel, resting and the like stop for
+ *               those, so they have to happen on the same call again.
+ *   restore     the game was saved and restored here.
+ *
+ * Replaying feeds the keys back at full speed, into a game with the same
+ * seed and character that doesn't save. As long as it's the same version
+ * with the same options, that's the same game.
+**/
+
+#include "AppHdr.h"
+
+#include "key-journal.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include "end.h"
+#include "files.h"
+#include "jobs.h"
+#include "newgame-def.h"
+#include "options.h"
+#include "player.h"
+#include "species.h"
+#include "state.h"
+#include "stringutil.h"
+#include "syscalls.h"
+#include "version.h"
+
+static FILE *_journal = nullptr;
+// kbhit() calls since the last entry that didn't find a key.
+static int _kbhit_misses = 0;
+
+// While replaying, the entry that getch_ck() or kbhit() will use next.
+static char _next_type = 0;
+static int _next_value = 0;
+
+static string _journal_filename()
+{
+    const string save = get_savedir_filename(you.your_name);
+    return save.substr(0, save.size() - strlen(SAVE_SUFFIX)) + ".keys";
+}
+
+/**
+ * Begin recording keys, if the key_journal option is set. A new game
+ * starts a new journal; a restored one carries on with its old journal, if
+ * there is one.
+ */
+void key_journal_start(const newgame_def *ng)
+{
+    if (_journal || !Options.key_journal || Options.no_save
+        || !crawl_state.replay_journal.empty())
+    {
+        return;
+    }
+
+    const string filename = _journal_filename();
+    if (!ng)
+    {
+        // Without the start of the game, there's nothing to replay from.
+        if (!file_exists(filename))
+            return;
+        _journal = fopen_u(filename.c_str(), "a");
+        if (_journal)
+            fprintf(_journal, "restore\n");
+        return;
+    }
+
+    _journal = fopen_u(filename.c_str(), "w");
+    if (!_journal)
+        return;
+
+    fprintf(_journal, "# %s key journal\n", CRAWL);
+    fprintf(_journal, "version %s\n", Version::Long);
+    fprintf(_journal, "seed %" PRIu64 "\n", you.game_seed);
+    fprintf(_journal, "pregen %d\n",
+            static_cast<int>(Options.pregen_dungeon));
+    fprintf(_journal, "type %d\n", crawl_state.type);
+    fprintf(_journal, "map %s\n", crawl_state.map.c_str());
+    fprintf(_journal, "name %s\n", you.your_name.c_str());
+    fprintf(_journal, "species %s\n", species::get_abbrev(you.species));
+    fprintf(_journal, "job %s\n", get_job_abbrev(you.char_class));
+    fprintf(_journal, "weapon %d\n", ng->weapon);
+    fprintf(_journal, "keys\n");
+    fflush(_journal);
+}
+
+void key_journal_record_key(int key)
+{
+    _kbhit_misses = 0;
+    if (!_journal)
+        return;
+    fprintf(_journal, "k %d\n", key);
+    // Keys come slowly, and a journal is most useful after a crash.
+    fflush(_journal);
+}
+
+void key_journal_record_kbhit(bool hit)
+{
+    if (!hit)
+    {
+        ++_kbhit_misses;
+        return;
+    }
+    if (_journal)
+        fprintf(_journal, "h %d\n", _kbhit_misses);
+    _kbhit_misses = 0;
+}
+
+static void _read_entry()
+{
+    char line[256];
+    while (fgets(line, sizeof(line), _journal))
+    {
+        if (sscanf(line, "k %d", &_next_value) == 1)
+        {
+            _next_type = 'k';
+            return;
+        }
+        if (sscanf(line, "h %d", &_next_value) == 1)
+        {
+            _next_type = 'h';
+            return;
+        }
+        // Restores need nothing doing: the replayed game never stopped.
+    }
+    _next_type = 0;
+}
+
+NORETURN static void _end_replay()
+{
+    fclose(_journal);
+    _journal = nullptr;
+    end(0);
+}
+
+/**
+ * Open the journal given by -replay, and set up the game it was recorded
+ * from: ng gets the character, and the options get the seed. The replay
+ * never saves, so that it can't touch the game it came from.
+ */
+void key_journal_load_replay(newgame_def &ng)
+{
+    const string &filename = crawl_state.replay_journal;
+    _journal = fopen_u(filename.c_str(), "r");
+    if (!_journal)
+        end(1, true, "Can't read key journal %s", filename.c_str());
+
+    string version;
+    char buf[256];
+    bool found_keys = false;
+    while (fgets(buf, sizeof(buf), _journal))
+    {
+        string line = buf;
+        trim_string(line);
+        if (line == "keys")
+        {
+            found_keys = true;
+            break;
+        }
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        string key = line, value;
+        const size_t space = line.find(' ');
+        if (space != string::npos)
+        {
+            key = line.substr(0, space);
+            value = line.substr(space + 1);
+        }
+
+        if (key == "version")
+            version = value;
+        else if (key == "seed")
+        {
+            Options.seed = strtoull(value.c_str(), nullptr, 10);
+            Options.seed_from_rc = Options.seed;
+        }
+        else if (key == "pregen")
+        {
+            Options.pregen_dungeon
+                = static_cast<level_gen_type>(atoi(value.c_str()));
+        }
+        else if (key == "type")
+            ng.type = static_cast<game_type>(atoi(value.c_str()));
+        else if (key == "map")
+            ng.map = value;
+        else if (key == "name")
+            ng.name = value;
+        else if (key == "species")
+            ng.species = species::from_abbrev(value.c_str());
+        else if (key == "job")
+            ng.job = get_job_by_abbrev(value.c_str());
+        else if (key == "weapon")
+            ng.weapon = static_cast<weapon_type>(atoi(value.c_str()));
+    }
+
+    if (!found_keys || ng.name.empty() || ng.species == SP_UNKNOWN
+        || ng.job == JOB_UNKNOWN)
+    {
+        end(1, false, "%s isn't a key journal this version can replay",
+            filename.c_str());
+    }
+    if (version != Version::Long)
+    {
+        fprintf(stderr, "Key journal %s is from %s; it may not replay "
+                "faithfully.\n", filename.c_str(), version.c_str());
+    }
+
+    Options.no_save = true;
+    Options.no_player_bones = true;
+    crawl_state.disables.set(DIS_DELAY);
+
+    _read_entry();
+}
+
+int key_journal_replay_key()
+{
+    _kbhit_misses = 0;
+    // A kbhit() that didn't happen this time around; skip it, and hope.
+    while (_next_type == 'h')
+        _read_entry();
+    if (!_next_type)
+        _end_replay();
+
+    const int key = _next_value;
+    _read_entry();
+    return key;
+}
+
+bool key_journal_replay_kbhit()
+{
+    if (_next_type != 'h' || _next_value != _kbhit_misses)
+    {
+        ++_kbhit_misses;
+        return false;
+    }
+
+    _kbhit_misses = 0;
+    _read_entry();
+    return true;
+}
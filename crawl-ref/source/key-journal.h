@@ -0,0 +1,20 @@
+/**
+ * @file
+ * @brief Recording the keys of a game, and playing them back.
+**/
+
+#pragma once
+
+struct newgame_def;
+
+// Recording, with the key_journal option. Keys are written as read from
+// the terminal, before keymaps and macros, next to the save. ng is the
+// character for a new game, or null for a restored one.
+void key_journal_start(const newgame_def *ng);
+void key_journal_record_key(int key);
+void key_journal_record_kbhit(bool hit);
+
+// Playing back, with -replay <journal>.
+void key_journal_load_replay(newgame_def &ng);
+int key_journal_replay_key();
+bool key_journal_replay_kbhit();
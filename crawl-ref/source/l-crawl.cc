@@ -1001,6 +1001,7 @@ static int crawl_article_a(lua_State *ls)
 LUARET1(crawl_game_started, boolean, crawl_state.need_save
                                      || crawl_state.map_stat_gen
                                      || crawl_state.obj_stat_gen
+                                     || crawl_state.seed_cat_gen
                                      || crawl_state.test)
 /*** Is crawl asking us to choose a stat?
  * @treturn boolean
@@ -1435,6 +1436,28 @@ static int crawl_version(lua_State *ls)
     return 1;
 }
 
+/*** How long the game has spent in Lua functions and hooks it called by
+ * name, such as ready(). Useful for finding out which part of a bot is
+ * slow. Nested calls count towards both functions.
+ * @treturn table keyed by function name, with fields calls and usec
+ * (total wall time in microseconds)
+ * @function fn_times
+ */
+static int crawl_fn_times(lua_State *ls)
+{
+    lua_newtable(ls);
+    for (const auto &fn : CLua::get_vm(ls).fn_times)
+    {
+        lua_newtable(ls);
+        lua_pushnumber(ls, fn.second.calls);
+        lua_setfield(ls, -2, "calls");
+        lua_pushnumber(ls, fn.second.usec);
+        lua_setfield(ls, -2, "usec");
+        lua_setfield(ls, -2, fn.first.c_str());
+    }
+    return 1;
+}
+
 static const struct luaL_reg crawl_clib[] =
 {
     { "mpr",                crawl_mpr },
@@ -1506,6 +1529,7 @@ static const struct luaL_reg crawl_clib[] =
     { "call_dlua",          crawl_call_dlua },
 #endif
     { "version",            crawl_version },
+    { "fn_times",           crawl_fn_times },
     { "weapon_check",       crawl_weapon_check},
     { nullptr, nullptr },
 };
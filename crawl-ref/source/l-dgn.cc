@@ -678,6 +678,25 @@ static int dgn_load_des_file(lua_State *ls)
     return 0;
 }
 
+static int dgn_build_des_caches(lua_State *ls)
+{
+    luaL_checktype(ls, 1, LUA_TTABLE);
+    vector<string> files;
+    for (int i = 1; ; ++i)
+    {
+        lua_rawgeti(ls, 1, i);
+        if (lua_isnil(ls, -1))
+        {
+            lua_pop(ls, 1);
+            break;
+        }
+        files.emplace_back(luaL_checkstring(ls, -1));
+        lua_pop(ls, 1);
+    }
+    build_des_caches(files);
+    return 0;
+}
+
 static int dgn_lfloorcol(lua_State *ls)
 {
     MAP(ls, 1, map);
@@ -1838,6 +1857,7 @@ const struct luaL_reg dgn_dlib[] =
 { "gly_points", dgn_gly_points },
 { "original_map", dgn_original_map },
 { "load_des_file", dgn_load_des_file },
+{ "build_des_caches", dgn_build_des_caches },
 { "register_listener", dgn_register_listener },
 { "remove_listener", dgn_remove_listener },
 { "remove_marker", dgn_remove_marker },
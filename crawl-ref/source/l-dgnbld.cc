@@ -1304,6 +1304,9 @@ LUAFN(dgn_mapgrd_table)
 
     map_def **mapref = clua_new_userdata<map_def *>(ls, MAPGRD_METATABLE);
     *mapref = map;
+    // For mapgrd_get() to keep its columns in.
+    lua_newtable(ls);
+    lua_setfenv(ls, -2);
 
     return 1;
 }
@@ -22,10 +22,20 @@ static int mapgrd_get(lua_State *ls)
 
     int column = luaL_safe_checkint(ls, 2);
 
+    // Columns are kept in the mapgrd's environment table, so that a loop
+    // over mapgrd[x][y] doesn't make a new userdata for every cell.
+    lua_getfenv(ls, 1);
+    lua_rawgeti(ls, -1, column);
+    if (!lua_isnil(ls, -1))
+        return 1;
+    lua_pop(ls, 1);
+
     mapcolumn *mapref = clua_new_userdata<mapcolumn>(ls, MAPGRD_COL_METATABLE);
     mapref->map = map;
     mapref->col = column;
 
+    lua_pushvalue(ls, -1);
+    lua_rawseti(ls, -3, column);
     return 1;
 }
 
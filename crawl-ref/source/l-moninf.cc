@@ -9,6 +9,7 @@
 
 #include "cluautil.h"
 #include "coord.h"
+#include "coordit.h"
 #include "env.h"
 #include "fight.h"
 #include "l-defs.h"
@@ -38,6 +39,50 @@ void lua_push_moninf(lua_State *ls, monster_info *mi)
     *miref = new monster_info(*mi);
 }
 
+// The monster.info made for each monster since the player last acted,
+// indexed by mid, so that scripts asking about the same monsters again
+// and again don't copy their monster_info each time.
+#define MONINF_CACHE "__moninf_cache"
+
+static void _push_moninf_cache(lua_State *ls)
+{
+    lua_getfield(ls, LUA_REGISTRYINDEX, MONINF_CACHE);
+    if (lua_istable(ls, -1))
+    {
+        lua_getfield(ls, -1, "turn");
+        lua_getfield(ls, -2, "time");
+        const bool current = lua_tointeger(ls, -2) == you.num_turns
+                             && lua_tointeger(ls, -1) == you.elapsed_time;
+        lua_pop(ls, 2);
+        if (current)
+            return;
+    }
+    lua_pop(ls, 1);
+
+    lua_newtable(ls);
+    lua_pushinteger(ls, you.num_turns);
+    lua_setfield(ls, -2, "turn");
+    lua_pushinteger(ls, you.elapsed_time);
+    lua_setfield(ls, -2, "time");
+    lua_pushvalue(ls, -1);
+    lua_setfield(ls, LUA_REGISTRYINDEX, MONINF_CACHE);
+}
+
+static void _push_cached_moninf(lua_State *ls, monster &mon)
+{
+    _push_moninf_cache(ls);
+    lua_rawgeti(ls, -1, mon.mid);
+    if (lua_isnil(ls, -1))
+    {
+        lua_pop(ls, 1);
+        monster_info mi(&mon);
+        lua_push_moninf(ls, &mi);
+        lua_pushvalue(ls, -1);
+        lua_rawseti(ls, -3, mon.mid);
+    }
+    lua_remove(ls, -2);
+}
+
 #define MONINF(ls, n, var) \
     monster_info *var = *(monster_info **) \
         luaL_checkudata(ls, n, MONINF_METATABLE); \
@@ -881,14 +926,36 @@ LUAFN(mi_get_monster_at)
     monster* m = &env.mons[env.mgrid(p)];
     if (!m->visible_to(&you))
         return 0;
-    monster_info mi(m);
-    lua_push_moninf(ls, &mi);
+    _push_cached_moninf(ls, *m);
+    return 1;
+}
+
+/*** Get all the monsters the player can see.
+ * The same as calling get_monster_at for every cell in view, in one call.
+ * @treturn {monster.info,...}
+ * @function get_monsters
+ */
+LUAFN(mi_get_monsters)
+{
+    lua_newtable(ls);
+    int i = 0;
+    for (radius_iterator ri(you.pos(), LOS_DEFAULT); ri; ++ri)
+    {
+        if (!you.see_cell(*ri) || env.mgrid(*ri) == NON_MONSTER)
+            continue;
+        monster &m = env.mons[env.mgrid(*ri)];
+        if (!m.visible_to(&you))
+            continue;
+        _push_cached_moninf(ls, m);
+        lua_rawseti(ls, -2, ++i);
+    }
     return 1;
 }
 
 static const struct luaL_reg mon_lib[] =
 {
     { "get_monster_at", mi_get_monster_at },
+    { "get_monsters", mi_get_monsters },
 
     { nullptr, nullptr }
 };
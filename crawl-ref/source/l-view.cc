@@ -39,6 +39,33 @@ LUAFN(view_feature_at)
     return 1;
 }
 
+/*** What are the features around the player?
+ * A single call for what would otherwise take a feature_at call per cell:
+ * the result is a flat array, row by row from the top left corner of the
+ * square of the given radius, so the feature at x, y is at index
+ * (y + radius) * (2 * radius + 1) + x + radius + 1.
+ * @tparam[opt=8] int radius
+ * @treturn {string,...} feature names, with "unseen" off the map
+ * @function features
+ */
+LUAFN(view_features)
+{
+    const int radius = min(max(0, luaL_optint(ls, 1, LOS_MAX_RANGE)),
+                           max(GXM, GYM));
+    lua_createtable(ls, (2 * radius + 1) * (2 * radius + 1), 0);
+    int i = 0;
+    for (int y = -radius; y <= radius; ++y)
+        for (int x = -radius; x <= radius; ++x)
+        {
+            const coord_def p = player2grid(coord_def(x, y));
+            lua_pushstring(ls, map_bounds(p)
+                ? dungeon_feature_name(env.map_knowledge(p).feat())
+                : "unseen");
+            lua_rawseti(ls, -2, ++i);
+        }
+    return 1;
+}
+
 /*** What kind of cloud (if any) is here?
  * @tparam int x
  * @tparam int y
@@ -210,6 +237,7 @@ LUAFN(view_update_monsters)
 static const struct luaL_reg view_lib[] =
 {
     { "feature_at", view_feature_at },
+    { "features", view_features },
     { "cloud_at", view_cloud_at },
     { "is_safe_square", view_is_safe_square },
     { "can_reach", view_can_reach },
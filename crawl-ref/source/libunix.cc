@@ -34,6 +34,7 @@
 #include "colour.h"
 #include "cio.h"
 #include "crash.h"
+#include "key-journal.h"
 #include "state.h"
 #include "tiles-build-specific.h"
 #include "unicode.h"
@@ -529,7 +530,7 @@ void set_getch_returns_resizes(bool rr)
     getch_returns_resizes = rr;
 }
 
-int getch_ck()
+static int _getch_ck()
 {
     while (true)
     {
@@ -597,6 +598,16 @@ int getch_ck()
     }
 }
 
+int getch_ck()
+{
+    if (!crawl_state.replay_journal.empty())
+        return key_journal_replay_key();
+
+    const int key = _getch_ck();
+    key_journal_record_key(key);
+    return key;
+}
+
 static void unix_handle_terminal_resize()
 {
     console_shutdown();
@@ -875,6 +886,9 @@ int num_to_lines(int num)
 
 #ifdef DGAMELAUNCH
 static bool _suppress_dgl_clrscr = false;
+// When the terminal was last really cleared, for DGL_CLEAR_INTERVAL; 0 if
+// the next clear should be a real one.
+static time_t _last_dgl_clrscr = 0;
 
 // TODO: this is not an ideal way to solve this problem. An alternative might
 // be to queue dgl clrscr and only send them at the same time as an actual
@@ -891,19 +905,38 @@ suppress_dgl_clrscr::~suppress_dgl_clrscr()
 }
 #endif
 
+// curses keeps track of what's on the terminal, and refresh() only sends the
+// cells that changed. clear() would throw that away and send the whole
+// screen again on the next refresh, which is what most of the bytes of a
+// game over ssh or in a ttyrec used to be; erase() just blanks the window,
+// so redrawing what was there before costs nothing.
 void clrscr_sys()
 {
     textcolour(LIGHTGREY);
     textbackground(BLACK);
-    clear();
 #ifdef DGAMELAUNCH
-    if (!_suppress_dgl_clrscr)
+    const time_t now = time(nullptr);
+    if (!_suppress_dgl_clrscr
+        && (!DGL_CLEAR_INTERVAL || !_last_dgl_clrscr
+            || now - _last_dgl_clrscr >= DGL_CLEAR_INTERVAL))
     {
+        // This really clears the terminal, so it all has to be sent again.
+        clear();
         printf("%s", DGL_CLEAR_SCREEN);
         fflush(stdout);
+        _last_dgl_clrscr = now;
+        return;
     }
 #endif
+    erase();
+}
 
+void unixcurses_repaint()
+{
+    clearok(curscr, TRUE);
+#ifdef DGAMELAUNCH
+    _last_dgl_clrscr = 0;
+#endif
 }
 
 void set_cursor_enabled(bool enabled)
@@ -1624,6 +1657,13 @@ void delay(unsigned int time)
         return;
 
 #ifdef USE_TILE_WEB
+    // Frames of a batched animation are timed by the client.
+    if (tiles.animation_frame(time))
+    {
+        refresh();
+        return;
+    }
+
     tiles.redraw();
     if (time)
     {
@@ -1638,7 +1678,7 @@ void delay(unsigned int time)
 }
 
 /* This is Juho Snellman's modified kbhit, to work with macros */
-bool kbhit()
+static bool _kbhit()
 {
     if (pending)
         return true;
@@ -1672,3 +1712,13 @@ bool kbhit()
     return result;
 #endif
 }
+
+bool kbhit()
+{
+    if (!crawl_state.replay_journal.empty())
+        return key_journal_replay_kbhit();
+
+    const bool hit = _kbhit();
+    key_journal_record_kbhit(hit);
+    return hit;
+}
@@ -6,6 +6,9 @@
 
 void fakecursorxy(int x, int y);
 int unixcurses_get_vi_key(int keyin);
+// Send the whole screen on the next refresh, for when the terminal may not
+// show what curses thinks it does.
+void unixcurses_repaint();
 
 #ifdef DGAMELAUNCH
 class suppress_dgl_clrscr
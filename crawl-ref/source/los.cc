@@ -51,9 +51,15 @@
 #include "coord.h"
 #include "coordit.h"
 #include "env.h"
+#include "files.h"
+#include "job-pool.h"
 #include "losglobal.h"
+#include "maps.h"
 #include "mon-act.h"
 #include "mpr.h"
+#include "nearby-danger.h"
+#include "syscalls.h"
+#include "tags.h"
 
 // These determine what rays are cast in the precomputation,
 // and affect start-up time significantly.
@@ -61,6 +67,10 @@
 #define LOS_MAX_ANGLE (2*LOS_MAX_RANGE-2)
 #define LOS_INTERCEPT_MULT (2)
 
+// The precomputed tables are cached on disk next to the des cache.
+// Bump this whenever the precomputation or the cache layout changes.
+#define LOS_CACHE_VERSION (1)
+
 // These store all unique (in terms of footprint) full rays.
 // The footprint of ray=fullray[i] consists of ray.length cells,
 // stored in ray_coords[ray.start..ray.length-1].
@@ -72,12 +82,46 @@ static vector<coord_def> ray_coords;
 
 // These store all unique minimal cellrays. For each i,
 // cellray i ends in cellray_ends[i] and passes through
-// thoses cells p that have blockrays(p)[i] set. In other
-// words, blockrays(p)[i] is set iff an opaque cell p blocks
+// thoses cells p that have bit i of _blockrays(p) set. In other
+// words, that bit is set iff an opaque cell p blocks
 // the cellray with index i.
 static vector<coord_def> cellray_ends;
-typedef FixedArray<bit_vector*, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> blockrays_t;
-static blockrays_t blockrays;
+
+// The blocking sets are stored as rows of ray_words 64-bit words, one
+// row per quadrant cell, all in one contiguous table. This lets
+// _losight_quadrant combine them a whole word at a time in tight loops
+// that the compiler can vectorise, without per-bit calls or temporaries.
+typedef uint64_t ray_word;
+#define RAY_WORD_BITS 64
+static unsigned int ray_words = 0;
+static vector<ray_word> blockray_table;
+
+static inline ray_word* _blockrays(const coord_def& p)
+{
+    return &blockray_table[(p.y * (LOS_MAX_RANGE + 1) + p.x) * ray_words];
+}
+
+static inline bool _ray_bit(const ray_word* row, unsigned int i)
+{
+    return (row[i / RAY_WORD_BITS] >> (i % RAY_WORD_BITS)) & 1;
+}
+
+static inline void _set_ray_bit(ray_word* row, unsigned int i)
+{
+    row[i / RAY_WORD_BITS] |= (ray_word)1 << (i % RAY_WORD_BITS);
+}
+
+static inline int _lowest_ray_bit(ray_word w)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(w);
+#else
+    int i = 0;
+    for (; !(w & 1); w >>= 1)
+        ++i;
+    return i;
+#endif
+}
 
 // We also store the minimal cellrays by target position
 // for efficient retrieval by find_ray.
@@ -85,11 +129,30 @@ static blockrays_t blockrays;
 struct cellray;
 static FixedArray<vector<cellray>, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> min_cellrays;
 
+// For each cell p in the quadrant, the distinct end points of the
+// minimal cellrays that p blocks, i.e. the cells whose visibility
+// from the origin can depend on the opacity of p. Derived from
+// blockrays on first use by los_blocked_targets.
+static FixedArray<vector<coord_def>, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1>
+    blocked_targets;
+
 // Temporary arrays used in losight() to track which rays
 // are blocked or have seen a smoke cloud.
 // Allocated when doing the precomputations.
-static bit_vector *dead_rays     = nullptr;
-static bit_vector *smoke_rays    = nullptr;
+// Scratch space for losight(), which can run on several threads at once.
+static thread_local vector<ray_word> dead_rays;
+static thread_local vector<ray_word> smoke_rays;
+
+// Size the blocking table and the temporary arrays for n_min_rays
+// minimal cellrays, with all bits clear.
+static void _init_ray_tables(unsigned int n_min_rays)
+{
+    ray_words = (n_min_rays + RAY_WORD_BITS - 1) / RAY_WORD_BITS;
+    blockray_table.assign((LOS_MAX_RANGE + 1) * (LOS_MAX_RANGE + 1)
+                          * ray_words, 0);
+    dead_rays.assign(ray_words, 0);
+    smoke_rays.assign(ray_words, 0);
+}
 
 class quadrant_iterator : public rectangle_iterator
 {
@@ -103,10 +166,9 @@ public:
 
 void clear_rays_on_exit()
 {
-    delete dead_rays;
-    delete smoke_rays;
-    for (quadrant_iterator qi; qi; ++qi)
-        delete blockrays(*qi);
+    vector<ray_word>().swap(dead_rays);
+    vector<ray_word>().swap(smoke_rays);
+    vector<ray_word>().swap(blockray_table);
 }
 
 // LOS radius.
@@ -389,7 +451,7 @@ static void _create_blockrays()
     // Cellrays are numbered according to the index of their end
     // cell in ray_coords.
     const int n_cellrays = ray_coords.size();
-    blockrays_t all_blockrays;
+    FixedArray<bit_vector*, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> all_blockrays;
     for (quadrant_iterator qi; qi; ++qi)
         all_blockrays(*qi) = new bit_vector(n_cellrays);
 
@@ -415,27 +477,225 @@ static void _create_blockrays()
         cellray_ends[i] = ray_coords[min_indices[i]];
 
     // Compress blockrays accordingly.
+    _init_ray_tables(n_min_rays);
     for (quadrant_iterator qi; qi; ++qi)
     {
-        blockrays(*qi) = new bit_vector(n_min_rays);
+        ray_word* row = _blockrays(*qi);
         for (int i = 0; i < n_min_rays; ++i)
-        {
-            blockrays(*qi)->set(i, all_blockrays(*qi)
-                                   ->get(min_indices[i]));
-        }
+            if (all_blockrays(*qi)->get(min_indices[i]))
+                _set_ray_bit(row, i);
     }
 
     // We can throw away all_blockrays now.
     for (quadrant_iterator qi; qi; ++qi)
         delete all_blockrays(*qi);
 
-    dead_rays  = new bit_vector(n_min_rays);
-    smoke_rays = new bit_vector(n_min_rays);
-
     dprf("Cellrays: %d Fullrays: %u Minimal cellrays: %u",
           n_cellrays, (unsigned int)fullrays.size(), n_min_rays);
 }
 
+// The cache stores everything the LOS queries need after precomputation:
+// ray_coords, cellray_ends, blockrays and min_cellrays. fullrays is only
+// used while casting and is left empty when loading.
+
+static string _los_cache_file()
+{
+    return get_descache_path("los", ".cache");
+}
+
+static void _marshall_double(writer &th, double d)
+{
+    uint64_t bits;
+    COMPILE_CHECK(sizeof(bits) == sizeof(d));
+    memcpy(&bits, &d, sizeof(bits));
+    marshallUnsigned(th, bits);
+}
+
+static double _unmarshall_double(reader &th)
+{
+    const uint64_t bits = unmarshallUnsigned(th);
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+static void _marshall_los_ray(writer &th, const los_ray &ray)
+{
+    _marshall_double(th, ray.r.start.x);
+    _marshall_double(th, ray.r.start.y);
+    _marshall_double(th, ray.r.dir.x);
+    _marshall_double(th, ray.r.dir.y);
+    marshallBoolean(th, ray.on_corner);
+    marshallUnsigned(th, ray.start);
+    marshallUnsigned(th, ray.length);
+}
+
+static bool _unmarshall_los_ray(reader &th, los_ray &ray)
+{
+    ray.r.start.x = _unmarshall_double(th);
+    ray.r.start.y = _unmarshall_double(th);
+    ray.r.dir.x = _unmarshall_double(th);
+    ray.r.dir.y = _unmarshall_double(th);
+    ray.on_corner = unmarshallBoolean(th);
+    unmarshallUnsigned(th, ray.start);
+    unmarshallUnsigned(th, ray.length);
+    return ray.start + ray.length <= ray_coords.size();
+}
+
+static void _write_los_header(writer &th)
+{
+    write_save_version(th, save_version::current());
+    marshallInt(th, LOS_CACHE_VERSION);
+    marshallInt(th, LOS_MAX_RANGE);
+    marshallInt(th, LOS_MAX_ANGLE);
+    marshallInt(th, LOS_INTERCEPT_MULT);
+}
+
+static bool _check_los_header(reader &th)
+{
+    const auto version = get_save_version(th);
+    return version.major == TAG_MAJOR_VERSION
+           && version.minor == TAG_MINOR_VERSION
+           && unmarshallInt(th) == LOS_CACHE_VERSION
+           && unmarshallInt(th) == LOS_MAX_RANGE
+           && unmarshallInt(th) == LOS_MAX_ANGLE
+           && unmarshallInt(th) == LOS_INTERCEPT_MULT;
+}
+
+static void _write_los_cache()
+{
+    const string file = _los_cache_file();
+    file_lock lock(file + ".lk", "wb", false);
+
+    FILE *fp = fopen_replace(file.c_str());
+    if (!fp)
+        return;
+
+    writer outf(file, fp, true);
+    _write_los_header(outf);
+
+    marshallUnsigned(outf, ray_coords.size());
+    for (coord_def c : ray_coords)
+        marshallCoord(outf, c);
+
+    const unsigned int n_min_rays = cellray_ends.size();
+    marshallUnsigned(outf, n_min_rays);
+    for (coord_def c : cellray_ends)
+        marshallCoord(outf, c);
+
+    for (quadrant_iterator qi; qi; ++qi)
+    {
+        for (unsigned int i = 0; i < n_min_rays; i += 8)
+        {
+            uint8_t bits = 0;
+            for (unsigned int j = 0; j < 8 && i + j < n_min_rays; ++j)
+                if (_ray_bit(_blockrays(*qi), i + j))
+                    bits |= 1 << j;
+            marshallUByte(outf, bits);
+        }
+    }
+
+    for (quadrant_iterator qi; qi; ++qi)
+    {
+        const vector<cellray> &min = min_cellrays(*qi);
+        marshallUnsigned(outf, min.size());
+        for (const cellray &c : min)
+        {
+            _marshall_los_ray(outf, c.ray);
+            marshallUnsigned(outf, c.end);
+            marshallInt(outf, c.imbalance);
+            marshallBoolean(outf, c.first_diag);
+        }
+    }
+
+    fclose(fp);
+    if (!outf.succeeded())
+        unlink_u(file.c_str());
+}
+
+// Returns false and leaves the tables empty if the cache is missing,
+// stale or damaged; the caller then does the full precomputation.
+static bool _load_los_cache()
+{
+    const string file = _los_cache_file();
+    file_lock lock(file + ".lk", "rb", false);
+
+    FILE *fp = fopen_u(file.c_str(), "rb");
+    if (!fp)
+        return false;
+
+    bool ok = false;
+    try
+    {
+        reader inf(fp);
+        inf.set_safe_read(true);
+        ok = _check_los_header(inf);
+
+        // Sanity bounds; the real tables are a few thousand entries.
+        const unsigned int max_entries = 1 << 20;
+
+        const unsigned int n_coords = ok ? unmarshallUnsigned(inf) : 0;
+        ok = ok && n_coords <= max_entries;
+        for (unsigned int i = 0; ok && i < n_coords; ++i)
+            ray_coords.push_back(unmarshallCoord(inf));
+
+        const unsigned int n_min_rays = ok ? unmarshallUnsigned(inf) : 0;
+        ok = ok && n_min_rays <= n_coords;
+        for (unsigned int i = 0; ok && i < n_min_rays; ++i)
+            cellray_ends.push_back(unmarshallCoord(inf));
+
+        if (ok)
+            _init_ray_tables(n_min_rays);
+        for (quadrant_iterator qi; ok && qi; ++qi)
+        {
+            ray_word* row = _blockrays(*qi);
+            for (unsigned int i = 0; i < n_min_rays; i += 8)
+            {
+                const uint8_t bits = unmarshallUByte(inf);
+                for (unsigned int j = 0; j < 8 && i + j < n_min_rays; ++j)
+                    if (bits & (1 << j))
+                        _set_ray_bit(row, i + j);
+            }
+        }
+
+        for (quadrant_iterator qi; ok && qi; ++qi)
+        {
+            const unsigned int n = unmarshallUnsigned(inf);
+            ok = n <= n_min_rays;
+            vector<cellray> &min = min_cellrays(*qi);
+            for (unsigned int i = 0; ok && i < n; ++i)
+            {
+                los_ray ray(geom::ray(0, 0, 0, 0));
+                ok = _unmarshall_los_ray(inf, ray);
+                cellray c(ray, unmarshallUnsigned(inf));
+                c.imbalance = unmarshallInt(inf);
+                c.first_diag = unmarshallBoolean(inf);
+                ok = ok && c.end < ray.length && c.target() == *qi;
+                min.push_back(c);
+            }
+        }
+    }
+    catch (short_read_exception &E)
+    {
+        ok = false;
+    }
+    fclose(fp);
+
+    if (!ok)
+    {
+        ray_coords.clear();
+        cellray_ends.clear();
+        clear_rays_on_exit();
+        for (quadrant_iterator qi; qi; ++qi)
+            min_cellrays(*qi).clear();
+        return false;
+    }
+
+    dprf("Loaded LOS tables from cache: %u minimal cellrays",
+         (unsigned int)cellray_ends.size());
+    return true;
+}
+
 static int _gcd(int x, int y)
 {
     int tmp;
@@ -460,11 +720,16 @@ static void raycast()
     static bool done_raycast = false;
     if (done_raycast)
         return;
+    // Done once, before anything can look for LOS in parallel.
+    ASSERT(!in_parallel_job());
 
     // Creating all rays for first quadrant
     // We have a considerable amount of overkill.
     done_raycast = true;
 
+    if (_load_los_cache())
+        return;
+
     // register perpendiculars FIRST, to make them top choice
     // when selecting beams
     _register_ray(geom::ray(0.5, 0.5, 0.0, 1.0));
@@ -505,6 +770,14 @@ static void raycast()
 
     // Now create the appropriate blockrays array
     _create_blockrays();
+
+    _write_los_cache();
+}
+
+// Do the precalculations now, rather than on first use.
+void los_precompute()
+{
+    raycast();
 }
 
 static int _imbalance(ray_def ray, const coord_def& target)
@@ -561,7 +834,6 @@ static bool _find_ray_se(const coord_def& target, ray_def& ray,
 
     const vector<cellray> &min = min_cellrays(target);
     ASSERT(!min.empty());
-    cellray c = min[0]; // XXX: const cellray &c ?
     unsigned int index = 0;
 
     if (cycle)
@@ -570,21 +842,37 @@ static bool _find_ray_se(const coord_def& target, ray_def& ray,
     unsigned int start = cycle ? ray.cycle_idx + 1 : 0;
     ASSERT(start <= min.size());
 
+    // The candidates mostly pass through the same few cells, so look up
+    // each cell's opacity only once. Everything they pass through is
+    // inside the rectangle spanned by the target.
+    static const int8_t OPC_UNKNOWN = -1;
+    int8_t cell_opc[LOS_MAX_RANGE + 1][LOS_MAX_RANGE + 1];
+    for (int x = 0; x <= target.x; ++x)
+        for (int y = 0; y <= target.y; ++y)
+            cell_opc[x][y] = OPC_UNKNOWN;
+
     int blocked = OPC_OPAQUE;
     for (unsigned int i = start;
          (blocked >= OPC_OPAQUE) && (i < start + min.size()); i++)
     {
         index = i % min.size();
-        c = min[index];
+        const cellray &c = min[index];
         blocked = OPC_CLEAR;
         // Check all inner points.
         for (unsigned int j = 0; j < c.end && blocked < OPC_OPAQUE; j++)
-            blocked += opc(c[j]);
+        {
+            const coord_def p = ray_coords[c.ray.start + j];
+            ASSERT(p.x <= target.x && p.y <= target.y);
+            int8_t &o = cell_opc[p.x][p.y];
+            if (o == OPC_UNKNOWN)
+                o = opc(p);
+            blocked += o;
+        }
     }
     if (blocked >= OPC_OPAQUE)
         return false;
 
-    ray = c.ray;
+    ray = min[index].ray;
     ray.cycle_idx = index;
 
     return true;
@@ -681,6 +969,39 @@ dungeon_feature_type ray_blocker(const coord_def& source,
     return NUM_FEATURES;
 }
 
+// Returns the cells, relative to a viewer at the origin, whose visibility
+// can depend on the opacity of p; p is in the first quadrant.
+const vector<coord_def>& los_blocked_targets(const coord_def& p)
+{
+    ASSERT(p.x >= 0);
+    ASSERT(p.y >= 0);
+    ASSERT(p.rdist() <= LOS_MAX_RANGE);
+
+    static bool done_targets = false;
+    if (!done_targets)
+    {
+        raycast();
+        done_targets = true;
+
+        const unsigned int num_cellrays = cellray_ends.size();
+        for (quadrant_iterator qi; qi; ++qi)
+        {
+            FixedArray<bool, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> seen(false);
+            for (unsigned int rayidx = 0; rayidx < num_cellrays; ++rayidx)
+            {
+                const coord_def t = cellray_ends[rayidx];
+                if (_ray_bit(_blockrays(*qi), rayidx) && !seen(t))
+                {
+                    seen(t) = true;
+                    blocked_targets(*qi).push_back(t);
+                }
+            }
+        }
+    }
+
+    return blocked_targets(p);
+}
+
 // Returns a straight ray from source to target.
 void fallback_ray(const coord_def& source, const coord_def& target,
                   ray_def& ray)
@@ -736,9 +1057,14 @@ bool cell_see_cell_nocache(const coord_def& p1, const coord_def& p2)
 static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy)
 {
     const unsigned int num_cellrays = cellray_ends.size();
+    const unsigned int nwords = ray_words;
+    dead_rays.resize(nwords);
+    smoke_rays.resize(nwords);
+    ray_word* dead = dead_rays.data();
+    ray_word* smoke = smoke_rays.data();
 
-    dead_rays->reset();
-    smoke_rays->reset();
+    fill(dead, dead + nwords, 0);
+    fill(smoke, smoke + nwords, 0);
 
     for (quadrant_iterator qi; qi; ++qi)
     {
@@ -746,16 +1072,21 @@ static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy
         if (!dat.los_bounds(p))
             continue;
 
+        const ray_word* block = _blockrays(*qi);
         switch (dat.opacity(p))
         {
         case OPC_OPAQUE:
             // Block the appropriate rays.
-            *dead_rays |= *blockrays(*qi);
+            for (unsigned int w = 0; w < nwords; ++w)
+                dead[w] |= block[w];
             break;
         case OPC_HALF:
             // Block rays which have already seen a cloud.
-            *dead_rays  |= (*smoke_rays & *blockrays(*qi));
-            *smoke_rays |= *blockrays(*qi);
+            for (unsigned int w = 0; w < nwords; ++w)
+            {
+                dead[w]  |= smoke[w] & block[w];
+                smoke[w] |= block[w];
+            }
             break;
         default:
             break;
@@ -763,12 +1094,17 @@ static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy
     }
 
     // Ray calculation done. Now work out which cells in this
-    // quadrant are visible.
-    for (unsigned int rayidx = 0; rayidx < num_cellrays; ++rayidx)
+    // quadrant are visible, visiting only the rays still alive.
+    for (unsigned int w = 0; w < nwords; ++w)
     {
-        // make the cells seen by this ray at this point visible
-        if (!dead_rays->get(rayidx))
+        for (ray_word alive = ~dead[w]; alive; alive &= alive - 1)
         {
+            const unsigned int rayidx = w * RAY_WORD_BITS
+                                        + _lowest_ray_bit(alive);
+            // The padding bits past the last ray always look alive.
+            if (rayidx >= num_cellrays)
+                break;
+
             // This ray is alive, thus the end cell is visible.
             const coord_def p = coord_def(sx * cellray_ends[rayidx].x,
                                           sy * cellray_ends[rayidx].y);
@@ -841,6 +1177,7 @@ opacity_type mons_opacity(const monster* mon, los_type how)
 static void _handle_los_change()
 {
     invalidate_agrid();
+    invalidate_hurt_player_cache();
 }
 
 static bool _mons_block_sight(const monster* mons)
@@ -857,6 +1194,9 @@ void los_actor_moved(const actor* act, const coord_def& oldpos)
         invalidate_los_around(act->pos());
         _handle_los_change();
     }
+    // Monster paths go around stationary monsters.
+    else if (act->is_monster() && act->is_stationary())
+        invalidate_hurt_player_cache();
 }
 
 void los_monster_died(const monster* mon)
@@ -866,6 +1206,8 @@ void los_monster_died(const monster* mon)
         invalidate_los_around(mon->pos());
         _handle_los_change();
     }
+    else if (mon->is_stationary())
+        invalidate_hurt_player_cache();
 }
 
 // Might want to pass new/old terrain.
@@ -875,6 +1217,13 @@ void los_terrain_changed(const coord_def& p)
     _handle_los_change();
 }
 
+void los_terrain_changed(const vector<coord_def>& ps)
+{
+    for (const coord_def &p : ps)
+        invalidate_los_around(p);
+    _handle_los_change();
+}
+
 void los_changed()
 {
     mons_reset_just_seen();
@@ -33,10 +33,12 @@ void fallback_ray(const coord_def& source, const coord_def& target,
                   ray_def& ray);
 
 bool cell_see_cell_nocache(const coord_def& p1, const coord_def& p2);
+const vector<coord_def>& los_blocked_targets(const coord_def& p);
 
 typedef SquareArray<bool, LOS_MAX_RANGE> los_grid;
 
 void clear_rays_on_exit();
+void los_precompute();
 void losight(los_grid& sh, const coord_def& center,
              const opacity_func &opc = opc_default,
              const circle_def &bds = BDS_DEFAULT);
@@ -44,5 +46,6 @@ void losight(los_grid& sh, const coord_def& center,
 void los_actor_moved(const actor* act, const coord_def& oldpos);
 void los_monster_died(const monster* mon);
 void los_terrain_changed(const coord_def& p);
+void los_terrain_changed(const vector<coord_def>& ps);
 void los_changed();
 opacity_type mons_opacity(const monster* mon, los_type how);
@@ -5,6 +5,7 @@
 #include "coord.h"
 #include "coordit.h"
 #include "libutil.h"
+#include "los.h"
 #include "los-def.h"
 
 #define LOS_KNOWN 4
@@ -59,15 +60,46 @@ static void _save_los(los_def* los, los_type l)
 }
 
 // Opacity at p has changed.
+// Only the pairs (o, q) that have a minimal cellray from o to q passing
+// through p can change visibility; forget just those. Cells on an axis
+// relative to o belong to two (or four) quadrants, so every matching
+// quadrant is considered.
 void invalidate_los_around(const coord_def& p)
 {
-    int x1 = max(p.x - LOS_MAX_RANGE, 0);
-    int y1 = max(p.y - LOS_MAX_RANGE, 0);
-    int x2 = min(p.x, GXM - 1);
-    int y2 = min(p.y + LOS_MAX_RANGE, GYM - 1);
-    for (int y = y1; y <= y2; y++)
-        for (int x = x1; x <= x2; x++)
-            memset(globallos[x][y], 0, sizeof(halflos_t));
+    static const int signs[2] = { 1, -1 };
+
+    for (int oy = p.y - LOS_MAX_RANGE; oy <= p.y + LOS_MAX_RANGE; ++oy)
+        for (int ox = p.x - LOS_MAX_RANGE; ox <= p.x + LOS_MAX_RANGE; ++ox)
+        {
+            const coord_def o(ox, oy);
+            if (!map_bounds(o) || o == p)
+                continue;
+
+            const coord_def d = p - o;
+            const coord_def a(abs(d.x), abs(d.y));
+            const vector<coord_def>& targets = los_blocked_targets(a);
+            if (targets.empty())
+                continue;
+
+            for (int sx : signs)
+            {
+                if (d.x * sx < 0)
+                    continue;
+                for (int sy : signs)
+                {
+                    if (d.y * sy < 0)
+                        continue;
+                    for (const coord_def &t : targets)
+                    {
+                        losfield_t* flags =
+                            _lookup_globallos(o, o + coord_def(sx * t.x,
+                                                               sy * t.y));
+                        if (flags)
+                            *flags = 0;
+                    }
+                }
+            }
+        }
 }
 
 void invalidate_los()
@@ -129,3 +161,33 @@ bool cell_see_cell(const coord_def& p, const coord_def& q, los_type l)
     ASSERT(*flags & (l << LOS_KNOWN));
     return *flags & l;
 }
+
+// Batch version of cell_see_cell for every cell in range of p.
+// Fills vis, indexed by offset from p, and computes the LOS field of p
+// at most once, instead of looking it up pair by pair.
+void cell_see_cells(const coord_def& p, los_type l, los_grid& vis)
+{
+    vis.init(l == LOS_NONE);
+    if (l == LOS_NONE)
+        return;
+
+    bool updated = false;
+    for (int y = -LOS_MAX_RANGE; y <= LOS_MAX_RANGE; y++)
+        for (int x = -LOS_MAX_RANGE; x <= LOS_MAX_RANGE; x++)
+        {
+            const coord_def d(x, y);
+            losfield_t* flags = _lookup_globallos(p, p + d);
+            if (!flags)
+                continue;
+
+            if (!(*flags & (l << LOS_KNOWN)))
+            {
+                // A single update fills in the whole range around p.
+                ASSERT(!updated);
+                _update_globallos_at(p, l);
+                updated = true;
+            }
+
+            vis(d) = *flags & l;
+        }
+}
@@ -488,14 +488,39 @@ void macro_buf_add_cmd(command_type cmd, bool reverse)
 }
 
 /*
- * Adds keypresses from a sequence into the internal keybuffer. Does some
- * O(N^2) analysis to the sequence to apply keymaps.
+ * Finds the longest key in the map that the sequence starts with, and that
+ * expands to something. Returns mapref.end() if there's none.
+ */
+static macromap::const_iterator _longest_match(const macromap &mapref,
+                                               const keyseq &seq)
+{
+    // The keys starting with a given prefix are together in the map, from
+    // lower_bound(prefix) on, so as soon as no key starts with the prefix,
+    // there's no point making it longer.
+    auto best = mapref.end();
+    keyseq prefix;
+    for (int key : seq)
+    {
+        prefix.push_back(key);
+        auto it = mapref.lower_bound(prefix);
+        if (it == mapref.end() || it->first.size() < prefix.size()
+            || !equal(prefix.begin(), prefix.end(), it->first.begin()))
+        {
+            break;
+        }
+        if (it->first.size() == prefix.size() && !it->second.empty())
+            best = it;
+    }
+    return best;
+}
+
+/*
+ * Adds keypresses from a sequence into the internal keybuffer, applying
+ * keymaps.
  */
 static void macro_buf_add_long(keyseq actions,
                                macromap &keymap = Keymaps[KMC_DEFAULT])
 {
-    keyseq tmp;
-
     // debug << "Adding: " << vtostr(actions) << endl;
     // debug.flush();
 
@@ -507,25 +532,8 @@ static void macro_buf_add_long(keyseq actions,
 
     while (!actions.empty())
     {
-        tmp = actions;
-
-        while (!tmp.empty())
-        {
-            auto subst = keymap.find(tmp);
-            // Found a macro. Add the expansion (action) of the
-            // macro into the buffer.
-            if (subst != keymap.end() && !subst->second.empty())
-            {
-                macro_buf_add(subst->second, false, false);
-                break;
-            }
-
-            // Didn't find a macro. Remove a key from the end
-            // of the sequence, and try again.
-            tmp.pop_back();
-        }
-
-        if (tmp.empty())
+        auto subst = _longest_match(keymap, actions);
+        if (subst == keymap.end())
         {
             // Didn't find a macro. Add the first keypress of the sequence
             // into the buffer, remove it from the sequence, and try again.
@@ -534,10 +542,11 @@ static void macro_buf_add_long(keyseq actions,
         }
         else
         {
-            // Found a macro, which has already been added above. Now just
-            // remove the macroed keys from the sequence.
-            for (unsigned int i = 0; i < tmp.size(); i++)
-                actions.pop_front();
+            // Found a macro. Add the expansion (action) of the macro into
+            // the buffer, and remove the macroed keys from the sequence.
+            macro_buf_add(subst->second, false, false);
+            actions.erase(actions.begin(),
+                          actions.begin() + subst->first.size());
         }
     }
 }
@@ -591,30 +600,19 @@ static void macro_buf_apply_command_macro()
     if (macro_keys_left > 0 || expanded_keys_left > 0)
         return;
 
-    keyseq tmp = Buffer;
-
     // find the longest match from the start of the buffer and replace it
-    while (!tmp.empty())
-    {
-        auto expansion = Macros.find(tmp);
-
-        if (expansion != Macros.end() && !expansion->second.empty())
-        {
-            const keyseq &result = expansion->second;
-
-            // Found macro, remove match from front:
-            for (unsigned int i = 0; i < tmp.size(); i++)
-                Buffer.pop_front();
+    auto expansion = _longest_match(Macros, Buffer);
+    if (expansion == Macros.end())
+        return;
 
-            macro_keys_left = result.size();
+    const keyseq &result = expansion->second;
 
-            macro_buf_add(result, true, true);
+    // Found macro, remove match from front:
+    Buffer.erase(Buffer.begin(), Buffer.begin() + expansion->first.size());
 
-            break;
-        }
+    macro_keys_left = result.size();
 
-        tmp.pop_back();
-    }
+    macro_buf_add(result, true, true);
 }
 
 /*
@@ -50,6 +50,7 @@
 #include "corpse.h"
 #include "crash.h"
 #include "database.h"
+#include "dbg-prof.h"
 #include "dbg-scan.h"
 #include "dbg-util.h"
 #include "delay.h"
@@ -153,6 +154,7 @@
 #include "wiz-you.h" // FREEZE_TIME_KEY
 #include "wizard.h" // handle_wizard_command() and enter_explore_mode()
 #include "xom.h" // XOM_CLOUD_TRAIL_TYPE_KEY
+#include "zygote.h"
 
 // ----------------------------------------------------------------------
 // Globals whose construction/destruction order needs to be managed
@@ -296,6 +298,23 @@ int main(int argc, char *argv[])
     // make sure all the expected data directories exist
     validate_basedirs();
 
+#ifdef USE_TILE_WEB
+    if (!SysEnv.zygote_socket.empty())
+    {
+        // From here on we're a game forked for the webtiles server, with
+        // its arguments and environment.
+        zygote_serve(SysEnv.zygote_socket, argc, argv);
+        SysEnv = system_environment();
+        get_system_environment();
+        if (!parse_args(argc, argv, true))
+        {
+            _show_commandline_options_help();
+            return 1;
+        }
+        validate_basedirs();
+    }
+#endif
+
     {
         // Read the init file -- first pass. This pass ignores lua. It'll get
         // reread with lua on starting a game.
@@ -535,6 +554,14 @@ static void _show_commandline_options_help()
     puts("");
     puts("Arena options: (Stage a tournament between various monsters.)");
     puts("  -arena \"<monster list> v <monster list> arena:<arena map>\"");
+    puts("  -arena-batch <num>  with -arena, run this many fights without "
+         "drawing them;");
+    puts("      each one's result is written to arena-batch.tsv");
+    puts("");
+    puts("Replay options:");
+    puts("  -replay <file>      play the keys in a key_journal file back at "
+         "full speed,");
+    puts("      without saving; use the same options as the recorded game");
 #ifdef DEBUG_DIAGNOSTICS
     puts("");
     puts("Diagnostic options:");
@@ -558,14 +585,53 @@ static void _show_commandline_options_help()
     puts("  -objstat [<levels>] run monster and item stats on the given range "
          "of levels");
     puts("      Defaults to entire dungeon; same level syntax as -mapstat.");
+    puts("  -seedcat <first>[-<last>] [<levels>]");
+    puts("                      catalog the vaults, uniques, artefacts and "
+         "runes of the");
+    puts("      given levels for each seed in the range; written to "
+         "seed-catalog.txt");
     puts("  -iters <num>        For -mapstat and -objstat, set the number of "
          "iterations");
+    puts("  -jobs <num>         For -mapstat, -objstat and -seedcat, split the "
+         "work between");
+    puts("      this many processes; 0 for one per CPU");
     puts("  -force-map <map>    For -mapstat and -objstat, alway choose the "
          "      given map on every level.");
+    puts("  -mapstat-baseline <file> [<factor>]");
+    puts("                      For -mapstat, compare level build times to "
+         "those in an");
+    puts("      earlier mapstat.json, and fail if any level got <factor> "
+         "(default 2)");
+    puts("      times slower. Use -seed for the same levels in both runs.");
+#endif
+#ifdef WIZARD
+    puts("");
+    puts("Fight simulator options:");
+    puts("  -fsim \"<combos> v <monsters>\"");
+    puts("                      simulate each character (e.g. MiFi,HuBe) "
+         "fighting each");
+    puts("      monster over the skill range, for each fsim_kit; fsim_mode, "
+         "fsim_scale");
+    puts("      and fsim_rounds apply. Written to fsim.tsv.");
+    puts("  -jobs <num>         For -fsim, split the matchups between this "
+         "many processes;");
+    puts("      0 for one per CPU");
+#endif
+#ifdef DEBUG_PROFILE
+#if !defined(DEBUG_DIAGNOSTICS) && !defined(DEBUG_STATISTICS)
+    puts("");
+    puts("Diagnostic options:");
+#endif
+    puts("  -profile-dump <file> write the subsystem turn profile to <file> "
+         "on exit");
+    puts("  -profile-turns <file> write each turn's wall and CPU time per "
+         "subsystem to <file>");
 #endif
     puts("");
     puts("Miscellaneous options:");
     puts("  -dump-maps       write map Lua to stderr when parsing .des files");
+    puts("  -startup-profile print how long each part of startup took, on "
+         "exit");
 #ifndef TARGET_OS_WINDOWS
     puts("  -gdb/-no-gdb     produce gdb backtrace when a crash happens (default:on)");
 #endif
@@ -1184,6 +1250,13 @@ static void _input()
 
                 }
             }
+
+            // Use the wait for a keypress to build upcoming levels.
+            if (pregen_lookahead())
+            {
+                viewwindow();
+                update_screen();
+            }
         }
 
 #ifdef WATCHDOG
@@ -2322,6 +2395,9 @@ void process_command(command_type cmd, command_type prev_cmd)
 
         // Game commands.
     case CMD_REDRAW_SCREEN:
+#if defined(UNIX) && !defined(USE_TILE_LOCAL)
+        unixcurses_repaint();
+#endif
         redraw_screen();
         update_screen();
         break;
@@ -2517,6 +2593,11 @@ static void _check_spectral_weapon()
 
 void world_reacts()
 {
+    // Close the previous turn's profile, which includes whatever screen
+    // updates happened while waiting for this turn's input.
+    profile_end_turn();
+    PROFILE_SCOPE(PROF_WORLD_REACTS);
+
     // All markers should be activated at this point.
     ASSERT(!env.markers.need_activate());
 
@@ -2607,7 +2688,10 @@ void world_reacts()
     add_auto_excludes();
 
     viewwindow();
-    update_screen();
+    // When the map isn't being drawn, don't push the rest of the screen out
+    // every turn either; it goes out once the run or rest is over.
+    if (viewwindow_should_render())
+        update_screen();
 
     if (you.cannot_act() && any_messages()
         && crawl_state.repeat_cmd != CMD_WIZARD)
@@ -2632,6 +2716,11 @@ void world_reacts()
         record_turn_timestamp();
         update_turn_count();
         msgwin_new_turn();
+#ifdef USE_TILE_WEB
+        // Cheap, but there's no need for it often.
+        if (!(you.num_turns % 1000))
+            tiles.send_memory_stats();
+#endif
         crawl_state.lua_calls_no_turn = 0;
         if ((crawl_state.game_is_sprint() && !(you.num_turns % 256)
                 || crawl_state.save_after_turn)
@@ -210,6 +210,17 @@ struct map_cell
         _mons = new monster_info(mi);
     }
 
+    // Views update every visible monster each turn: take over mi's
+    // strings and items, and the old record's allocation if there is one.
+    void set_monster(monster_info&& mi)
+    {
+        if (_mons)
+            *_mons = move(mi);
+        else
+            _mons = new monster_info(move(mi));
+        flags &= ~(MAP_DETECTED_MONSTER | MAP_INVISIBLE_MONSTER);
+    }
+
     bool detected_monster() const
     {
         return !!(flags & MAP_DETECTED_MONSTER);
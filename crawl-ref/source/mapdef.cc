@@ -13,6 +13,8 @@
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
+#include <list>
+#include <unordered_map>
 
 #include "abyss.h"
 #include "artefact.h"
@@ -50,6 +52,37 @@
 #include "rltiles/tiledef-dngn.h"
 #include "rltiles/tiledef-player.h"
 
+static vector<string> map_tag_names;
+static unordered_map<string, map_tag_id> map_tag_ids;
+
+map_tag_id intern_map_tag(const string &tag)
+{
+    auto found = map_tag_ids.find(tag);
+    if (found != map_tag_ids.end())
+        return found->second;
+
+    const map_tag_id id = map_tag_names.size();
+    map_tag_names.push_back(tag);
+    map_tag_ids[tag] = id;
+    return id;
+}
+
+// Like intern_map_tag(), but for tags that are only being looked for: a tag
+// no map has ever had can't match anything.
+bool find_map_tag(const string &tag, map_tag_id &id)
+{
+    auto found = map_tag_ids.find(tag);
+    if (found == map_tag_ids.end())
+        return false;
+    id = found->second;
+    return true;
+}
+
+const string &map_tag_name(map_tag_id id)
+{
+    return map_tag_names[id];
+}
+
 #ifdef DEBUG_TAG_PROFILING
 static map<string,int> _tag_profile;
 
@@ -2300,12 +2333,9 @@ bool map_def::map_already_used() const
                env.level_uniq_maps.end()
            || env.new_used_subvault_names.find(name) !=
                env.new_used_subvault_names.end()
-           || has_any_tag(get_uniq_map_tags().begin(),
-                          get_uniq_map_tags().end())
-           || has_any_tag(env.level_uniq_map_tags.begin(),
-                          env.level_uniq_map_tags.end())
-           || has_any_tag(env.new_used_subvault_tags.begin(),
-                          env.new_used_subvault_tags.end());
+           || has_tag_in(get_uniq_map_tags())
+           || has_tag_in(env.level_uniq_map_tags)
+           || has_tag_in(env.new_used_subvault_tags);
 }
 
 bool map_def::valid_item_array_glyph(int gly)
@@ -2460,11 +2490,44 @@ void map_def::strip()
     feat_renames.clear();
 }
 
+// The Lua of recently loaded maps, by name, most recently used first. The
+// .dsc stores it compiled, so this saves a map tried on level after level
+// its trip to the disk.
+struct map_body
+{
+    dlua_chunk prelude, mapchunk, main, validate, veto, epilogue;
+};
+static const size_t MAP_BODY_CACHE_SIZE = 256;
+typedef list<pair<string, map_body>> map_body_list;
+static map_body_list map_bodies;
+static unordered_map<string, map_body_list::iterator> map_body_index;
+
+void clear_map_body_cache()
+{
+    map_bodies.clear();
+    map_body_index.clear();
+}
+
 void map_def::load()
 {
     if (!index_only)
         return;
 
+    auto cached = map_body_index.find(name);
+    if (cached != map_body_index.end())
+    {
+        map_bodies.splice(map_bodies.begin(), map_bodies, cached->second);
+        const map_body &body = cached->second->second;
+        prelude = body.prelude;
+        mapchunk = body.mapchunk;
+        main = body.main;
+        validate = body.validate;
+        veto = body.veto;
+        epilogue = body.epilogue;
+        index_only = false;
+        return;
+    }
+
     const string descache_base = get_descache_path(cache_name, "");
     file_lock deslock(descache_base + ".lk", "rb", false);
     const string loadfile = descache_base + ".dsc";
@@ -2479,6 +2542,21 @@ void map_def::load()
     read_full(inf);
 
     index_only = false;
+
+    if (map_bodies.size() >= MAP_BODY_CACHE_SIZE)
+    {
+        map_body_index.erase(map_bodies.back().first);
+        map_bodies.pop_back();
+    }
+    map_bodies.emplace_front(name, map_body());
+    map_body &body = map_bodies.front().second;
+    body.prelude = prelude;
+    body.mapchunk = mapchunk;
+    body.main = main;
+    body.validate = validate;
+    body.veto = veto;
+    body.epilogue = epilogue;
+    map_body_index[name] = map_bodies.begin();
 }
 
 vector<coord_def> map_def::find_glyph(int glyph) const
@@ -2791,9 +2869,9 @@ string map_def::validate_map_placeable()
     // Ok, the map wants to be placed by tag. In this case it should have
     // at least one tag that's not a map flag.
     bool has_selectable_tag = false;
-    for (const string &piece : tags)
+    for (map_tag_id piece : tags)
     {
-        if (_map_tag_is_selectable(piece))
+        if (_map_tag_is_selectable(map_tag_name(piece)))
         {
             has_selectable_tag = true;
             break;
@@ -2854,6 +2932,16 @@ string map_def::validate_map_def(const depth_ranges &default_depths)
     test_lua_validate(true);
     run_lua_epilogue(true);
 
+    // The veto isn't run here, but compile it anyway so that the cache
+    // stores it compiled like the rest.
+    if (!veto.empty())
+    {
+        dlua_set_map mset(this);
+        if (veto.load(dlua))
+            return veto.orig_error();
+        lua_pop(dlua, 1);
+    }
+
     if (!has_depth() && !lc_default_depths.empty())
         depths.add_depths(lc_default_depths);
 
@@ -3338,15 +3426,34 @@ bool map_def::has_tag(const string &tagwanted) const
 #ifdef DEBUG_TAG_PROFILING
     _profile_inc_tag(tagwanted);
 #endif
-    return tags.count(tagwanted) > 0;
+    map_tag_id id;
+    return find_map_tag(tagwanted, id) && has_tag(id);
+}
+
+bool map_def::has_tag(map_tag_id tagwanted) const
+{
+    return binary_search(tags.begin(), tags.end(), tagwanted);
+}
+
+// Does the map have any of these tags? The sets of used unique tags grow
+// through the game, while a map only has a handful of tags, so look for
+// the map's in the set rather than the other way round.
+bool map_def::has_tag_in(const set<string> &tagset) const
+{
+    if (tagset.empty())
+        return false;
+    for (map_tag_id tag : tags)
+        if (tagset.count(map_tag_name(tag)))
+            return true;
+    return false;
 }
 
 bool map_def::has_tag_prefix(const string &prefix) const
 {
     if (prefix.empty())
         return false;
-    for (const auto &tag : tags)
-        if (starts_with(tag, prefix))
+    for (map_tag_id tag : tags)
+        if (starts_with(map_tag_name(tag), prefix))
             return true;
     return false;
 }
@@ -3355,39 +3462,58 @@ bool map_def::has_tag_suffix(const string &suffix) const
 {
     if (suffix.empty())
         return false;
-    for (const auto &tag : tags)
-        if (ends_with(tag, suffix))
+    for (map_tag_id tag : tags)
+        if (ends_with(map_tag_name(tag), suffix))
             return true;
     return false;
 }
 
 const unordered_set<string> map_def::get_tags_unsorted() const
 {
-    return tags;
+    unordered_set<string> result;
+    for (map_tag_id tag : tags)
+        result.insert(map_tag_name(tag));
+    return result;
 }
 
 const vector<string> map_def::get_tags() const
 {
     // this might seem inefficient, but get_tags is not called very much; the
     // hotspot revealed by profiling is actually has_tag checks.
-    vector<string> result(tags.begin(), tags.end());
+    vector<string> result;
+    for (map_tag_id tag : tags)
+        result.push_back(map_tag_name(tag));
     sort(result.begin(), result.end());
     return result;
 }
 
 void map_def::add_tags(const string &tag)
 {
-    auto parsed_tags = parse_tags(tag);
-    tags.insert(parsed_tags.begin(), parsed_tags.end());
+    for (const string &t : parse_tags(tag))
+    {
+        const map_tag_id id = intern_map_tag(t);
+        auto pos = lower_bound(tags.begin(), tags.end(), id);
+        if (pos == tags.end() || *pos != id)
+            tags.insert(pos, id);
+    }
     update_cached_tags();
 }
 
 bool map_def::remove_tags(const string &tag)
 {
     bool removed = false;
-    auto parsed_tags = parse_tags(tag);
-    for (auto &t : parsed_tags)
-        removed = tags.erase(t) || removed; // would iterator overload be ok?
+    for (const string &t : parse_tags(tag))
+    {
+        map_tag_id id;
+        if (!find_map_tag(t, id))
+            continue;
+        auto pos = lower_bound(tags.begin(), tags.end(), id);
+        if (pos != tags.end() && *pos == id)
+        {
+            tags.erase(pos);
+            removed = true;
+        }
+    }
     update_cached_tags();
     return removed;
 }
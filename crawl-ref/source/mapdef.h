@@ -1085,6 +1085,17 @@ struct subvault_place
     void set_subvault(const map_def &);
 };
 
+// Map tags are interned: each distinct tag gets a small id, and a map keeps
+// a sorted vector of the ids of its tags.
+typedef unsigned map_tag_id;
+map_tag_id intern_map_tag(const string &tag);
+bool find_map_tag(const string &tag, map_tag_id &id);
+const string &map_tag_name(map_tag_id id);
+
+// Forget the map bodies kept by map_def::load(), once the .dsc files they
+// came from may have changed.
+void clear_map_body_cache();
+
 /////////////////////////////////////////////////////////////////////////////
 // map_def: map definitions for maps loaded from .des files.
 //
@@ -1156,7 +1167,7 @@ public:
     string          file;
 
 private:
-    unordered_set<string>     tags;
+    vector<map_tag_id> tags; // sorted
     // This map has been loaded from an index, and not fully realised.
     bool            index_only;
     mutable long    cache_offset;
@@ -1262,6 +1273,8 @@ public:
     bool is_overwritable_layout() const;
     bool is_extra_vault() const;
     bool has_tag(const string &tagwanted) const;
+    bool has_tag(map_tag_id tagwanted) const;
+    bool has_tag_in(const set<string> &tagset) const;
     bool has_tag_prefix(const string &tag) const;
     bool has_tag_suffix(const string &suffix) const;
 
@@ -1287,6 +1300,7 @@ public:
     }
 
     const vector<string> get_tags() const;
+    const vector<map_tag_id> &get_tag_ids() const { return tags; }
     const unordered_set<string> get_tags_unsorted() const;
     void add_tags(const string &tag);
     void set_tags(const string &tag);
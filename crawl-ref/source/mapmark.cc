@@ -1057,11 +1057,19 @@ void map_markers::activate_markers_at(coord_def p)
 
 void map_markers::add(map_marker *marker)
 {
-    markers.insert(dgn_pos_marker(marker->pos, marker));
+    link_marker(marker);
     have_inactive_markers = true;
 }
 
-void map_markers::unlink_marker(const map_marker *marker)
+void map_markers::link_marker(map_marker *marker)
+{
+    markers.insert(dgn_pos_marker(marker->pos, marker));
+    typed_markers[marker->get_type()].insert(
+        dgn_pos_marker(marker->pos, marker));
+}
+
+static void _erase_marker(multimap<coord_def, map_marker *> &markers,
+                          const map_marker *marker)
 {
     auto els = markers.equal_range(marker->pos);
     for (auto i = els.first; i != els.second; ++i)
@@ -1074,6 +1082,12 @@ void map_markers::unlink_marker(const map_marker *marker)
     }
 }
 
+void map_markers::unlink_marker(const map_marker *marker)
+{
+    _erase_marker(markers, marker);
+    _erase_marker(typed_markers[marker->get_type()], marker);
+}
+
 void map_markers::check_empty()
 {
     if (markers.empty())
@@ -1096,8 +1110,10 @@ void map_markers::remove_markers_at(const coord_def &c,
         auto todel = i++;
         if (type == MAT_ANY || todel->second->get_type() == type)
         {
-            delete todel->second;
+            map_marker *marker = todel->second;
             markers.erase(todel);
+            _erase_marker(typed_markers[marker->get_type()], marker);
+            delete marker;
         }
     }
     check_empty();
@@ -1105,20 +1121,17 @@ void map_markers::remove_markers_at(const coord_def &c,
 
 map_marker *map_markers::find(const coord_def &c, map_marker_type type)
 {
-    auto els = markers.equal_range(c);
-    for (auto i = els.first; i != els.second; ++i)
-        if (type == MAT_ANY || i->second->get_type() == type)
-            return i->second;
-    return nullptr;
+    const dgn_marker_map &from = type == MAT_ANY ? markers
+                                                 : typed_markers[type];
+    auto i = from.lower_bound(c);
+    return i == from.end() || i->first != c ? nullptr : i->second;
 }
 
 map_marker *map_markers::find(map_marker_type type)
 {
-    for (const auto &entry : markers)
-        if (type == MAT_ANY || entry.second->get_type() == type)
-            return entry.second;
-
-    return nullptr;
+    const dgn_marker_map &from = type == MAT_ANY ? markers
+                                                 : typed_markers[type];
+    return from.empty() ? nullptr : from.begin()->second;
 }
 
 void map_markers::move(const coord_def &from, const coord_def &to)
@@ -1131,6 +1144,8 @@ void map_markers::move(const coord_def &from, const coord_def &to)
     {
         auto curr = i++;
         tmarkers.push_back(curr->second);
+        _erase_marker(typed_markers[curr->second->get_type()],
+                      curr->second);
         markers.erase(curr);
     }
 
@@ -1151,12 +1166,12 @@ void map_markers::move_marker(map_marker *marker, const coord_def &to)
 
 vector<map_marker*> map_markers::get_all(map_marker_type mat)
 {
+    const dgn_marker_map &from = mat == MAT_ANY ? markers
+                                                : typed_markers[mat];
     vector<map_marker*> rmarkers;
-    for (const auto &entry : markers)
-    {
-        if (mat == MAT_ANY || entry.second->get_type() == mat)
-            rmarkers.push_back(entry.second);
-    }
+    rmarkers.reserve(from.size());
+    for (const auto &entry : from)
+        rmarkers.push_back(entry.second);
     return rmarkers;
 }
 
@@ -1208,6 +1223,8 @@ void map_markers::clear()
     for (auto &entry : markers)
         delete entry.second;
     markers.clear();
+    for (dgn_marker_map &typed : typed_markers)
+        typed.clear();
     check_empty();
 }
 
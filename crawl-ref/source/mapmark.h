@@ -375,11 +375,16 @@ private:
     typedef pair<coord_def, map_marker *> dgn_pos_marker;
 
     void init_from(const map_markers &);
+    void link_marker(map_marker *);
     void unlink_marker(const map_marker *);
     void check_empty();
 
 private:
     dgn_marker_map markers;
+    // The same markers again, split up by type, so that looking for a
+    // type doesn't go through all the others. Each keeps the order of
+    // markers.
+    dgn_marker_map typed_markers[NUM_MAP_MARKER_TYPES];
     bool have_inactive_markers;
 };
 
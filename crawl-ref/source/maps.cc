@@ -8,6 +8,8 @@
 #include "maps.h"
 
 #include <algorithm>
+#include <cerrno>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
 #include <sys/param.h>
@@ -15,6 +17,9 @@
 #if defined(UNIX) || defined(TARGET_COMPILER_MINGW)
 #include <unistd.h>
 #endif
+#ifdef UNIX
+#include <sys/wait.h>
+#endif
 
 #include "branch.h"
 #include "coord.h"
@@ -174,10 +179,56 @@ static void _dgn_flush_map_environment_for(const string &mapname)
     dlua.callfn("dgn_flush_map_environment_for", "s", mapname.c_str());
 }
 
+#ifdef DEBUG_STATISTICS
+static int lua_c_calls = 0;
+
+static void _count_lua_c_call(lua_State *ls, lua_Debug *ar)
+{
+    if (lua_getinfo(ls, "S", ar) && ar->what[0] == 'C')
+        ++lua_c_calls;
+}
+
+// For mapstat: count the calls from a map's Lua into C while it's resolved,
+// and the time that takes, including those of any subvaults that it places.
+class lua_c_call_counter
+{
+public:
+    lua_c_call_counter(const map_def &_map)
+        : map(_map), start(lua_c_calls),
+          hooked(crawl_state.map_stat_gen && !lua_gethook(dlua)),
+          start_time(chrono::steady_clock::now())
+    {
+        if (hooked)
+            lua_sethook(dlua, _count_lua_c_call, LUA_MASKCALL, 0);
+    }
+
+    ~lua_c_call_counter()
+    {
+        if (hooked)
+            lua_sethook(dlua, nullptr, 0, 0);
+        if (crawl_state.map_stat_gen)
+        {
+            const auto elapsed = chrono::steady_clock::now() - start_time;
+            mapstat_report_lua_calls(map, lua_c_calls - start,
+                chrono::duration_cast<chrono::microseconds>(elapsed).count());
+        }
+    }
+
+private:
+    const map_def &map;
+    const int start;
+    const bool hooked;
+    const chrono::steady_clock::time_point start_time;
+};
+#endif
+
 // Execute the map's Lua, perform substitutions and other transformations,
 // and validate the map
 static bool _resolve_map_lua(map_def &map)
 {
+#ifdef DEBUG_STATISTICS
+    lua_c_call_counter count_calls(map);
+#endif
     _dgn_flush_map_environment_for(map.name);
     map.reinit();
 
@@ -432,6 +483,43 @@ static bool _is_transporter_place(const coord_def &c)
                  || !m->property(TRANSPORTER_DEST_NAME_PROP).empty());
 }
 
+// While looking for a spot for a minivault, the number of vault cells above
+// and to the left of each point. A spot well clear of any vault can then
+// skip looking around every one of its cells for one.
+struct vault_cell_counts
+{
+    int sums[GXM + 1][GYM + 1];
+
+    void build()
+    {
+        for (int x = 0; x <= GXM; ++x)
+            sums[x][0] = 0;
+        for (int y = 0; y <= GYM; ++y)
+            sums[0][y] = 0;
+        for (int x = 1; x <= GXM; ++x)
+            for (int y = 1; y <= GYM; ++y)
+            {
+                const bool vault = env.level_map_mask[x - 1][y - 1] & MMT_VAULT;
+                sums[x][y] = sums[x - 1][y] + sums[x][y - 1]
+                             - sums[x - 1][y - 1] + vault;
+            }
+    }
+
+    // Vault cells from tl to br inclusive, within the map.
+    int count(coord_def tl, coord_def br) const
+    {
+        tl.x = max(tl.x, 0);
+        tl.y = max(tl.y, 0);
+        br.x = min(br.x, GXM - 1);
+        br.y = min(br.y, GYM - 1);
+        if (tl.x > br.x || tl.y > br.y)
+            return 0;
+        return sums[br.x + 1][br.y + 1] - sums[tl.x][br.y + 1]
+               - sums[br.x + 1][tl.y] + sums[tl.x][tl.y];
+    }
+};
+static const vault_cell_counts *_vault_counts = nullptr;
+
 static bool _map_safe_vault_place(const map_def &map,
                                   const coord_def &c,
                                   const coord_def &size)
@@ -452,6 +540,11 @@ static bool _map_safe_vault_place(const map_def &map,
     const bool vault_can_replace_portals =
         map.has_tag("replace_portal");
 
+    // Only worth looking around each cell if there's a vault anywhere
+    // around the whole rectangle.
+    const bool near_vaults = !_vault_counts
+        || _vault_counts->count(c - coord_def(1, 1), c + size);
+
     // respect smaller builder levels
     if (c.x < (GXM - dgn_builder_x()) / 2
         || c.x + size.x - 1 > (GXM + dgn_builder_x()) / 2
@@ -478,7 +571,7 @@ static bool _map_safe_vault_place(const map_def &map,
         {
             // Also check adjacent squares for collisions, because being next
             // to another vault may block off one of this vault's exits.
-            for (adjacent_iterator ai(cp); ai; ++ai)
+            for (adjacent_iterator ai(cp); near_vaults && ai; ++ai)
             {
                 if (map_bounds(*ai) && (env.level_map_mask(*ai) & MMT_VAULT))
                     return false;
@@ -587,6 +680,11 @@ static coord_def _find_minivault_place(
     // The spotty connector in the Shoals needs one more space to work.
     const int margin = MAPGEN_BORDER * 2 + player_in_branch(BRANCH_SHOALS);
 
+    // The vaults don't change while looking.
+    static vault_cell_counts counts;
+    counts.build();
+    unwind_var<const vault_cell_counts *> use_counts(_vault_counts, &counts);
+
     // Find a target area which can be safely overwritten.
     for (int tries = 0; tries < 600; ++tries)
     {
@@ -798,6 +896,7 @@ private:
 public:
     bool accept(const map_def &md) const;
     void announce(const map_def *map) const;
+    vector<unsigned> candidates() const;
 
     bool valid() const
     {
@@ -874,7 +973,9 @@ static bool _overflow_range(level_id place)
     return place.branch == BRANCH_DUNGEON && place.depth <= MAX_OVERFLOW_LEVEL;
 }
 
-bool map_selector::depth_selectable(const map_def &mapdef) const
+// The part of depth_selectable() that's down to the map and place alone.
+static bool _depth_selectable_anywhere(const map_def &mapdef,
+                                       const level_id &place)
 {
     return mapdef.is_usable_in(place)
            // Some tagged levels cannot be selected as random
@@ -885,7 +986,12 @@ bool map_selector::depth_selectable(const map_def &mapdef) const
            && !mapdef.has_tag("tutorial")
            && (!mapdef.has_tag_prefix("temple_")
                || !_overflow_range(place)
-                  && mapdef.has_tag_prefix("uniq_altar_"))
+                  && mapdef.has_tag_prefix("uniq_altar_"));
+}
+
+bool map_selector::depth_selectable(const map_def &mapdef) const
+{
+    return _depth_selectable_anywhere(mapdef, place)
            && _map_matches_species(mapdef)
            && (!check_layout || _map_matches_layout_type(mapdef));
 }
@@ -991,13 +1097,128 @@ string vault_chance_tag(const map_def &map)
 
 typedef vector<unsigned> vault_indices;
 
+// Indices into vdefs, to narrow each selection down to the maps that could
+// match before accept() looks at them: the maps with each tag, and those
+// that PLACE: or depth could allow on each level. These only depend on the
+// maps themselves; everything that depends on the game (maps used, the
+// level's layout, species, tutorial) is left to accept(). Rebuilt lazily
+// after vdefs changes.
+static bool maps_by_tag_valid = false;
+static vector<vault_indices> maps_by_tag; // by map_tag_id
+// The maps with all of a space-separated list of tags, as asked for by
+// subvaults and other tag selections; each retry asks again.
+static map<string, vault_indices> maps_by_tags;
+static map<level_id, vault_indices> maps_by_place;
+static map<level_id, vault_indices> maps_by_depth;
+
+static void _invalidate_map_indices()
+{
+    maps_by_tag_valid = false;
+    maps_by_tag.clear();
+    maps_by_tags.clear();
+    maps_by_place.clear();
+    maps_by_depth.clear();
+    clear_map_body_cache();
+}
+
+static void _build_tag_index()
+{
+    if (maps_by_tag_valid)
+        return;
+
+    for (unsigned i = 0, size = vdefs.size(); i < size; ++i)
+        for (map_tag_id tag : vdefs[i].get_tag_ids())
+        {
+            if (tag >= maps_by_tag.size())
+                maps_by_tag.resize(tag + 1);
+            maps_by_tag[tag].push_back(i);
+        }
+    maps_by_tag_valid = true;
+}
+
+static const vault_indices &_maps_for_level(
+    map<level_id, vault_indices> &index, const level_id &place,
+    bool (*usable)(const map_def &, const level_id &))
+{
+    auto found = index.find(place);
+    if (found != index.end())
+        return found->second;
+
+    vault_indices &maps = index[place];
+    for (unsigned i = 0, size = vdefs.size(); i < size; ++i)
+        if (usable(vdefs[i], place))
+            maps.push_back(i);
+    return maps;
+}
+
+static bool _place_usable(const map_def &mapdef, const level_id &place)
+{
+    return mapdef.place.is_usable_in(place);
+}
+
+vault_indices map_selector::candidates() const
+{
+    switch (sel)
+    {
+    case PLACE:
+        return _maps_for_level(maps_by_place, place, _place_usable);
+
+    case DEPTH:
+    case DEPTH_AND_CHANCE:
+        return _maps_for_level(maps_by_depth, place,
+                               _depth_selectable_anywhere);
+
+    case TAG:
+    {
+        auto found = maps_by_tags.find(tag);
+        if (found != maps_by_tags.end())
+            return found->second;
+
+        _build_tag_index();
+        vault_indices &maps = maps_by_tags[tag];
+        bool first = true;
+        for (const string &wanted : parse_tags(tag))
+        {
+            map_tag_id id;
+            if (!find_map_tag(wanted, id) || id >= maps_by_tag.size())
+            {
+                maps.clear();
+                return maps;
+            }
+            const vault_indices &tagged = maps_by_tag[id];
+            if (first)
+                maps = tagged;
+            else
+            {
+                vault_indices both;
+                set_intersection(maps.begin(), maps.end(),
+                                 tagged.begin(), tagged.end(),
+                                 back_inserter(both));
+                maps.swap(both);
+            }
+            first = false;
+        }
+        if (first)
+        {
+            // No tags at all; has_all_tags() accepts every map.
+            for (unsigned i = 0, size = vdefs.size(); i < size; ++i)
+                maps.push_back(i);
+        }
+        return maps;
+    }
+
+    default:
+        return vault_indices();
+    }
+}
+
 static vault_indices _eligible_maps_for_selector(const map_selector &sel)
 {
     vault_indices eligible;
 
     if (sel.valid())
     {
-        for (unsigned i = 0, size = vdefs.size(); i < size; ++i)
+        for (unsigned i : sel.candidates())
             if (sel.accept(vdefs[i]))
                 eligible.push_back(i);
     }
@@ -1310,6 +1531,23 @@ static bool _verify_map_full(const string &base, time_t mtime)
     return verify_file_version(base + ".dsc", mtime);
 }
 
+static bool _read_whole_file(const string &file, vector<unsigned char> &buf)
+{
+    FILE *fp = fopen_u(file.c_str(), "rb");
+    if (!fp)
+        return false;
+
+    buf.clear();
+    unsigned char block[16384];
+    size_t n;
+    while ((n = fread(block, 1, sizeof(block), fp)) > 0)
+        buf.insert(buf.end(), block, block + n);
+
+    const bool ok = !ferror(fp);
+    fclose(fp);
+    return ok;
+}
+
 static bool _load_map_index(const string& cache, const string &base,
                             time_t mtime)
 {
@@ -1333,11 +1571,13 @@ static bool _load_map_index(const string& cache, const string &base,
         global_preludes.push_back(lc_global_prelude);
     }
 
-    FILE* fp = fopen_u((base + ".idx").c_str(), "rb");
-    if (!fp)
+    // Slurp the whole index and parse it from memory, rather than going
+    // through stdio a byte at a time.
+    vector<unsigned char> idx;
+    if (!_read_whole_file(base + ".idx", idx))
         end(1, true, "Unable to read %s", (base + ".idx").c_str());
 
-    reader inf(fp, TAG_MINOR_VERSION);
+    reader inf(idx, TAG_MINOR_VERSION);
     // Re-check version, might have been modified in the meantime.
     const auto version = get_save_version(inf);
     const auto major = version.major, minor = version.minor;
@@ -1357,6 +1597,7 @@ static bool _load_map_index(const string& cache, const string &base,
 
     const int nmaps = unmarshallShort(inf);
     const int nexist = vdefs.size();
+    _invalidate_map_indices();
     vdefs.resize(nexist + nmaps, map_def());
     for (int i = 0; i < nmaps; ++i)
     {
@@ -1369,7 +1610,6 @@ static bool _load_map_index(const string& cache, const string &base,
         lc_loaded_maps[vdef.name] = vdef.place_loaded_from;
         vdef.place_loaded_from.clear();
     }
-    fclose(fp);
 
     return true;
 }
@@ -1468,6 +1708,24 @@ static void _write_map_cache(const string &filename, size_t vs, size_t ve,
     _write_map_index(descache_base, vs, ve, mtime);
 }
 
+// Parse a .des file, adding its maps to vdefs and leaving its global
+// prelude in lc_global_prelude.
+static void _compile_des_file(const string &s)
+{
+    FILE *dat = fopen_u(s.c_str(), "r");
+    if (!dat)
+        end(1, true, "Failed to open %s for reading", s.c_str());
+
+    _reset_map_parser();
+
+    extern int yyparse();
+    extern FILE *yyin;
+    yyin = dat;
+
+    yyparse();
+    fclose(dat);
+}
+
 static void _parse_maps(const string &s)
 {
     string cache_name = get_cache_name(s);
@@ -1479,30 +1737,18 @@ static void _parse_maps(const string &s)
     if (_load_map_cache(s, cache_name))
         return;
 
-    FILE *dat = fopen_u(s.c_str(), "r");
-    if (!dat)
-        end(1, true, "Failed to open %s for reading", s.c_str());
-
 #ifdef DEBUG_DIAGNOSTICS
     printf("Regenerating des: %s\n", s.c_str());
 #endif
     // won't be seen by the user unless they look for it
     mprf(MSGCH_PLAIN, "Regenerating des: %s", s.c_str());
 
-    time_t mtime = file_modtime(dat);
-    _reset_map_parser();
-
-    extern int yyparse();
-    extern FILE *yyin;
-    yyin = dat;
-
     const size_t file_start = vdefs.size();
-    yyparse();
-    fclose(dat);
-
+    _compile_des_file(s);
     global_preludes.push_back(lc_global_prelude);
 
-    _write_map_cache(cache_name, file_start, vdefs.size(), mtime);
+    _write_map_cache(cache_name, file_start, vdefs.size(),
+                     file_modtime(s));
 }
 
 void read_map(const string &file)
@@ -1513,6 +1759,95 @@ void read_map(const string &file)
     dlua.gc();
 }
 
+/**
+ * Bring the caches of these .des files up to date before they're loaded,
+ * rebuilding the stale ones in parallel.
+ *
+ * The parser is far too fond of its globals to run in threads, but each
+ * file is parsed on its own, so a child process per stale file can write
+ * its cache while others do the same. read_map() then loads them in the
+ * usual order. A file whose child fails is left stale, for read_map() to
+ * parse again and report the error properly.
+ *
+ * @param files datadir-relative .des paths, as for read_map().
+ */
+void build_des_caches(const vector<string> &files)
+{
+#ifdef UNIX
+    // Dumping maps happens during parsing, which has to be done in order.
+    if (crawl_state.dump_maps)
+        return;
+
+    vector<string> stale;
+    for (const string &file : files)
+    {
+        const string path = datafile_path(file);
+        const string cache_name = get_cache_name(path);
+        if (map_files_read.count(cache_name))
+            continue;
+
+        _check_des_index_dir();
+        const string descache_base = get_descache_path(cache_name, "");
+        const time_t mtime = file_modtime(path);
+        if (!_verify_map_index(descache_base, mtime)
+            || !_verify_map_full(descache_base, mtime))
+        {
+            stale.push_back(path);
+        }
+    }
+    if (stale.size() < 2)
+        return;
+
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    const size_t jobs = min(stale.size(), (size_t) max(cpus, 1L));
+    dprf("Rebuilding %u des caches with %u workers",
+         (unsigned int) stale.size(), (unsigned int) jobs);
+
+    // Don't let the children flush our buffers a second time.
+    fflush(stdout);
+    fflush(stderr);
+
+    set<pid_t> workers;
+    size_t next = 0;
+    while (next < stale.size() || !workers.empty())
+    {
+        while (workers.size() < jobs && next < stale.size())
+        {
+            const string &path = stale[next];
+            const pid_t pid = fork();
+            if (pid == 0)
+            {
+                crawl_state.forked_worker = true;
+                lc_desfile = path;
+                const size_t file_start = vdefs.size();
+                _compile_des_file(path);
+                _write_map_cache(get_cache_name(path), file_start,
+                                 vdefs.size(), file_modtime(path));
+                _exit(0);
+            }
+            // Out of processes: read_map() will do the rest.
+            if (pid < 0)
+                next = stale.size();
+            else
+            {
+                workers.insert(pid);
+                ++next;
+            }
+        }
+
+        if (workers.empty())
+            break;
+        int status;
+        const pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0 && errno != EINTR)
+            break;
+        workers.erase(pid);
+    }
+#else
+    UNUSED(files);
+#endif
+}
+
 void read_maps()
 {
     if (dlua.execfile("dlua/loadmaps.lua", true, true, true))
@@ -1541,6 +1876,7 @@ void reread_maps()
 
     // BOOM!
     vdefs.clear();
+    _invalidate_map_indices();
     map_files_read.clear();
     read_maps();
 }
@@ -1560,6 +1896,7 @@ void add_parsed_map(const map_def &md)
 
     map.fixup();
     vdefs.push_back(map);
+    _invalidate_map_indices();
 }
 
 void run_map_global_preludes()
@@ -58,6 +58,7 @@ mapref_vector find_maps_for_tag(const string &tag,
 void read_maps();
 void reread_maps();
 void read_map(const string &file);
+void build_des_caches(const vector<string> &files);
 void run_map_global_preludes();
 void run_map_local_preludes();
 string get_descache_path(const string &file, const string &ext);
@@ -143,7 +143,12 @@ protected:
         formatted_string text;
         vector<tile_def> tiles;
         bool heading;
+        // measured once by update_item(), rather than on every layout
+        int text_width = 0, prefix_width = 0;
+        // height of the text when last split, and the width it was split to
+        int split_width = -1, split_height = 0;
     };
+    int split_height(MenuItemInfo &entry, int width);
     vector<MenuItemInfo> item_info;
     vector<int> row_heights;
 
@@ -252,6 +257,17 @@ void UIMenu::get_item_region(int index, int *y1, int *y2)
 #endif
 }
 
+#ifdef USE_TILE_LOCAL
+static bool _has_hotkey_prefix(const string &s)
+{
+    // [enne] - Ugh, hack. Maybe MenuEntry could specify the
+    // presence and length of this substring?
+    bool let = (s[1] >= 'a' && s[1] <= 'z' || s[1] >= 'A' && s[1] <= 'Z');
+    bool plus = (s[3] == '-' || s[3] == '+' || s[3] == '#');
+    return let && plus && s[0] == ' ' && s[2] == ' ' && s[4] == ' ';
+}
+#endif
+
 void UIMenu::update_item(int index)
 {
     _invalidate_sizereq();
@@ -271,19 +287,39 @@ void UIMenu::update_item(int index)
     entry.heading = me->level == MEL_TITLE || me->level == MEL_SUBTITLE;
     entry.tiles.clear();
     me->get_tiles(entry.tiles);
+    entry.text_width = m_font_entry->string_width(entry.text);
+    entry.prefix_width = 0;
+    if (!entry.heading && _has_hotkey_prefix(entry.text.tostring()))
+        entry.prefix_width = m_font_entry->string_width(entry.text.chop(5));
+    entry.split_width = -1;
 #else
     UNUSED(index);
 #endif
 }
 
 #ifdef USE_TILE_LOCAL
-static bool _has_hotkey_prefix(const string &s)
+/// The height of the entry's text split to the given width, without its
+/// hotkey prefix, remembered until the width changes.
+int UIMenu::split_height(MenuItemInfo &entry, int width)
 {
-    // [enne] - Ugh, hack. Maybe MenuEntry could specify the
-    // presence and length of this substring?
-    bool let = (s[1] >= 'a' && s[1] <= 'z' || s[1] >= 'A' && s[1] <= 'Z');
-    bool plus = (s[3] == '-' || s[3] == '+' || s[3] == '#');
-    return let && plus && s[0] == ' ' && s[2] == ' ' && s[4] == ' ';
+    if (entry.split_width == width)
+        return entry.split_height;
+
+    formatted_string text;
+    if (entry.prefix_width)
+    {
+        text = entry.text;
+        // remove hotkeys. As Enne said above, this is a monstrosity.
+        for (int k = 0; k < 5; k++)
+            text.del_char();
+    }
+    else
+        text += entry.text;
+
+    formatted_string split = m_font_entry->split(text, width, UINT_MAX);
+    entry.split_width = width;
+    entry.split_height = m_font_entry->string_height(split);
+    return entry.split_height;
 }
 
 void UIMenu::do_layout(int mw, int num_columns)
@@ -315,7 +351,7 @@ void UIMenu::do_layout(int mw, int num_columns)
             row_height = 0;
         }
 
-        const int text_width = m_font_entry->string_width(entry.text);
+        const int text_width = entry.text_width;
 
         entry.y = height;
         entry.row = row_heights.size() - 1;
@@ -331,10 +367,7 @@ void UIMenu::do_layout(int mw, int num_columns)
 
             // wrap titles to two lines if they don't fit
             if (m_draw_tiles && text_width > mw)
-            {
-                formatted_string split = m_font_entry->split(entry.text, mw, UINT_MAX);
-                row_height = max(row_height, (int)m_font_entry->string_height(split));
-            }
+                row_height = max(row_height, split_height(entry, mw));
             column = num_columns-1;
         }
         else
@@ -349,24 +382,10 @@ void UIMenu::do_layout(int mw, int num_columns)
             if (!m_menu->is_set(MF_NO_WRAP_ROWS))
                 if ((text_width > max_column_width-entry.x-pad_right))
                 {
-                    formatted_string text;
                     // TODO: refactor to use _get_text_preface
-                    if (_has_hotkey_prefix(entry.text.tostring()))
-                    {
-                        formatted_string header = entry.text.chop(5);
-                        text_sx += m_font_entry->string_width(header);
-                        text = entry.text;
-                        // remove hotkeys. As Enne said above, this is a monstrosity.
-                        for (int k = 0; k < 5; k++)
-                            text.del_char();
-                    }
-                    else
-                        text += entry.text;
-
+                    text_sx += entry.prefix_width;
                     int w = max_column_width - text_sx - pad_right;
-                    formatted_string split = m_font_entry->split(text, w, UINT_MAX);
-                    int string_height = m_font_entry->string_height(split);
-                    string_height = min(string_height, text_height*2);
+                    int string_height = min(split_height(entry, w), text_height*2);
                     item_height = max(item_height, string_height);
                 }
 
@@ -506,7 +525,7 @@ public:
         m_text.clear();
         m_text += fs;
         _expose();
-        m_wrapped_size = Size(-1);
+        _invalidate_wrapping();
         wrap_text_to_size(m_region.width, m_region.height);
     }
 
@@ -66,10 +66,17 @@ struct message_particle
 {
     string text;        /// text of message (tagged string...)
     int repeats;        /// Number of times the message is in succession (x2)
+    string pure;        /// text without tags, parsed once
 
-    string pure_text() const
+    message_particle(string txt, int reps)
+        : text(move(txt)), repeats(reps),
+          pure(formatted_string::parse_string(text).tostring())
     {
-        return formatted_string::parse_string(text).tostring();
+    }
+
+    const string &pure_text() const
+    {
+        return pure;
     }
 
     string with_repeats() const
@@ -107,6 +114,11 @@ struct message_line
     int                 turn;
     bool                join;          /// may we merge this message w/others?
 
+    // The message wrapped for the message history, and the width it was
+    // wrapped to; kept so that redrawing the history doesn't re-parse it.
+    mutable vector<formatted_string> history_lines;
+    mutable int         history_width = 0;
+
     message_line() : channel(NUM_MESSAGE_CHANNELS), param(0), turn(-1),
                      join(true)
     {
@@ -167,6 +179,7 @@ struct message_line
             && other.last_msg().text == last_msg().text)
         {
             messages.back().repeats += other.last_msg().repeats;
+            history_width = 0;
             return true;
         }
         else if (Options.msg_condense_short
@@ -186,6 +199,7 @@ struct message_line
             // merge in other's messages; they'll be delimited when printing.
             messages.insert(messages.end(),
                             other.messages.begin(), other.messages.end());
+            history_width = 0;
             return true;
         }
 
@@ -229,6 +243,24 @@ struct message_line
     {
         return formatted_string::parse_string(full_text()).tostring();
     }
+
+    /// The full text broken into lines of the given width.
+    const vector<formatted_string> &wrapped(int width) const
+    {
+        if (history_width != width)
+        {
+            history_lines.clear();
+            string text = full_text();
+            if (!text.empty())
+            {
+                linebreak_string(text, width);
+                formatted_string::parse_string_to_multiple(text,
+                                                           history_lines, 80);
+            }
+            history_width = width;
+        }
+        return history_lines;
+    }
 };
 
 static int _mod(int num, int denom)
@@ -1013,7 +1045,8 @@ namespace msg
             return !crawl_state.io_inited // one of these is not like the others
                 || crawl_state.test || crawl_state.script
                 || crawl_state.build_db
-                || crawl_state.map_stat_gen || crawl_state.obj_stat_gen;
+                || crawl_state.map_stat_gen || crawl_state.obj_stat_gen
+                || crawl_state.seed_cat_gen;
         }
         return false;
     }
@@ -1361,15 +1394,50 @@ void dprf(diag_type param, const char *format, ...)
 
 static bool _updating_view = false;
 
+/**
+ * The filters of a message option, combined for each channel so that a
+ * message is matched against the whole list at once. Remade whenever an
+ * option line is read.
+ */
+struct message_filter_set
+{
+    unsigned int options_version = UINT_MAX;
+    pattern_set patterns[NUM_MESSAGE_CHANNELS];
+    bool whole_channel[NUM_MESSAGE_CHANNELS]; // filters without a pattern
+
+    bool matches(const vector<message_filter> &filters,
+                 msg_channel_type channel, const string &line)
+    {
+        ASSERT_RANGE(channel, 0, NUM_MESSAGE_CHANNELS);
+        if (options_version != Options.lines_read)
+        {
+            for (int ch = 0; ch < NUM_MESSAGE_CHANNELS; ++ch)
+            {
+                patterns[ch].clear();
+                whole_channel[ch] = false;
+                for (const message_filter &filter : filters)
+                {
+                    if (filter.channel != ch && filter.channel != -1)
+                        continue;
+                    if (filter.pattern.empty())
+                        whole_channel[ch] = true;
+                    else
+                        patterns[ch].add(filter.pattern);
+                }
+            }
+            options_version = Options.lines_read;
+        }
+        return whole_channel[channel] || patterns[channel].matches(line);
+    }
+};
+
 static bool _check_option(const string& line, msg_channel_type channel,
-                          const vector<message_filter>& option)
+                          const vector<message_filter>& option,
+                          message_filter_set &filters)
 {
     if (crawl_state.generating_level)
         return false;
-    return any_of(begin(option),
-                  end(option),
-                  bind(mem_fn(&message_filter::is_filtered),
-                       placeholders::_1, channel, line));
+    return filters.matches(option, channel, line);
 }
 
 static bool _check_more(const string& line, msg_channel_type channel)
@@ -1379,7 +1447,8 @@ static bool _check_more(const string& line, msg_channel_type channel)
     // crash here in order to find the real bug?
     if (!you.on_current_level)
         return false;
-    return _check_option(line, channel, Options.force_more_message);
+    static message_filter_set filters;
+    return _check_option(line, channel, Options.force_more_message, filters);
 }
 
 static bool _check_flash_screen(const string& line, msg_channel_type channel)
@@ -1389,7 +1458,9 @@ static bool _check_flash_screen(const string& line, msg_channel_type channel)
     // crash here in order to find the real bug?
     if (!you.on_current_level)
         return false;
-    return _check_option(line, channel, Options.flash_screen_message);
+    static message_filter_set filters;
+    return _check_option(line, channel, Options.flash_screen_message,
+                         filters);
 }
 
 static bool _check_join(const string& /*line*/, msg_channel_type channel)
@@ -1768,21 +1839,24 @@ static void mpr_check_patterns(const string& message,
 {
     if (crawl_state.generating_level)
         return;
-    for (const text_pattern &pat : Options.note_messages)
+
+    static pattern_set note_patterns;
+    static unsigned int note_patterns_version = UINT_MAX;
+    if (note_patterns_version != Options.lines_read)
     {
-        if (channel == MSGCH_EQUIPMENT || channel == MSGCH_FLOOR_ITEMS
-            || channel == MSGCH_MULTITURN_ACTION
-            || channel == MSGCH_EXAMINE || channel == MSGCH_EXAMINE_FILTER
-            || channel == MSGCH_TUTORIAL || channel == MSGCH_DGL_MESSAGE)
-        {
-            continue;
-        }
+        note_patterns.clear();
+        for (const text_pattern &pat : Options.note_messages)
+            note_patterns.add(pat);
+        note_patterns_version = Options.lines_read;
+    }
 
-        if (pat.matches(message))
-        {
-            take_note(Note(NOTE_MESSAGE, channel, param, message));
-            break;
-        }
+    if (channel != MSGCH_EQUIPMENT && channel != MSGCH_FLOOR_ITEMS
+        && channel != MSGCH_MULTITURN_ACTION
+        && channel != MSGCH_EXAMINE && channel != MSGCH_EXAMINE_FILTER
+        && channel != MSGCH_TUTORIAL && channel != MSGCH_DGL_MESSAGE
+        && note_patterns.matches(message))
+    {
+        take_note(Note(NOTE_MESSAGE, channel, param, message));
     }
 
     if (channel != MSGCH_DIAGNOSTICS && channel != MSGCH_EQUIPMENT)
@@ -2207,6 +2281,25 @@ bool recent_error_messages()
     return false;
 }
 
+size_t message_history_memory()
+{
+    const store_t &msgs = buffer.get_store();
+    size_t bytes = sizeof(msgs);
+    for (int i = 0; i < msgs.size(); ++i)
+    {
+        const message_line &msg = msgs[i];
+        for (const message_particle &part : msg.messages)
+        {
+            bytes += sizeof(part) + part.text.capacity()
+                     + part.pure.capacity();
+        }
+        for (const formatted_string &line : msg.history_lines)
+            for (const auto &op : line.ops)
+                bytes += sizeof(op) + op.text.capacity();
+    }
+    return bytes;
+}
+
 // We just write out the whole message store including empty/unused
 // messages. They'll be ignored when restoring.
 void save_messages(writer& outf)
@@ -2258,17 +2351,13 @@ static void _replay_messages_core(formatted_scroller &hist)
 {
     flush_prev_message();
 
-    const store_t msgs = buffer.get_store();
+    const store_t &msgs = buffer.get_store();
+    const int width = cgetsize(GOTO_CRT).x - 1;
     formatted_string lines;
     for (int i = 0; i < msgs.size(); ++i)
         if (channel_message_history(msgs[i].channel))
         {
-            string text = msgs[i].full_text();
-            if (!text.size())
-                continue;
-            linebreak_string(text, cgetsize(GOTO_CRT).x - 1);
-            vector<formatted_string> parts;
-            formatted_string::parse_string_to_multiple(text, parts, 80);
+            const vector<formatted_string> &parts = msgs[i].wrapped(width);
             for (unsigned int j = 0; j < parts.size(); ++j)
             {
                 prefix_type p = prefix_type::none;
@@ -167,6 +167,8 @@ void set_more_autoclear(bool on);
 
 string get_last_messages(int mcount, bool full = false);
 bool recent_error_messages();
+// Roughly how much memory the message history holds, in bytes.
+size_t message_history_memory();
 
 int channel_to_colour(msg_channel_type channel, int param = 0);
 bool strip_channel_prefix(string &text, msg_channel_type &channel,
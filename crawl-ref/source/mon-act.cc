@@ -16,6 +16,7 @@
 #include "colour.h"
 #include "coordit.h"
 #include "corpse.h"
+#include "dbg-prof.h"
 #include "dbg-scan.h"
 #include "delay.h"
 #include "directn.h" // feature_description_at
@@ -1584,6 +1585,7 @@ static bool _mons_take_special_action(monster &mons, int old_energy)
 void handle_monster_move(monster* mons)
 {
     ASSERT(mons); // XXX: change to monster &mons
+    PROFILE_SCOPE(PROF_MONSTER_MOVE, mons->type);
     const monsterentry* entry = get_monster_data(mons->type);
     if (!entry)
         return;
@@ -2228,16 +2230,36 @@ static void _post_monster_move(monster* mons)
         monster_die(*mons, KILL_MISC, NON_MONSTER);
 }
 
-priority_queue<pair<monster *, int>,
-               vector<pair<monster *, int> >,
-               MonsterActionQueueCompare> monster_queue;
+// A max-heap on speed_increment. This is kept as a plain vector driven by
+// push_heap/pop_heap, exactly as std::priority_queue would drive it, so that
+// the order among monsters with equal energy (and so seeded games) is
+// unchanged; the storage is reserved once and reused every turn.
+static vector<pair<monster *, int>> monster_queue;
+
+static void _queue_monster(monster *mons)
+{
+    if (monster_queue.capacity() < MAX_MONSTERS)
+        monster_queue.reserve(MAX_MONSTERS);
+    monster_queue.emplace_back(mons, mons->speed_increment);
+    push_heap(monster_queue.begin(), monster_queue.end(),
+              MonsterActionQueueCompare());
+}
+
+static pair<monster *, int> _dequeue_monster()
+{
+    pop_heap(monster_queue.begin(), monster_queue.end(),
+             MonsterActionQueueCompare());
+    const pair<monster *, int> top = monster_queue.back();
+    monster_queue.pop_back();
+    return top;
+}
 
 // Inserts a monster into the monster queue (needed to ensure that any monsters
 // given energy or an action by a effect can actually make use of that energy
 // this round)
 void queue_monster_for_action(monster* mons)
 {
-    monster_queue.emplace(mons, mons->speed_increment);
+    _queue_monster(mons);
 }
 
 static void _clear_monster_flags()
@@ -2312,11 +2334,12 @@ static void _display_just_seen()
  */
 void handle_monsters(bool with_noise)
 {
+    PROFILE_SCOPE(PROF_HANDLE_MONSTERS);
     for (monster_iterator mi; mi; ++mi)
     {
         _pre_monster_move(**mi);
         if (!invalid_monster(*mi) && mi->alive() && mi->has_action_energy())
-            monster_queue.emplace(*mi, mi->speed_increment);
+            _queue_monster(*mi);
     }
 
     int tries = 0; // infinite loop protection, shouldn't be ever needed
@@ -2326,12 +2349,12 @@ void handle_monsters(bool with_noise)
         {
             die("infinite handle_monsters() loop, mons[0 of %d] is %s",
                 (int)monster_queue.size(),
-                monster_queue.top().first->name(DESC_PLAIN, true).c_str());
+                monster_queue.front().first->name(DESC_PLAIN, true).c_str());
         }
 
-        monster *mon = monster_queue.top().first;
-        const int oldspeed = monster_queue.top().second;
-        monster_queue.pop();
+        const pair<monster *, int> next = _dequeue_monster();
+        monster *mon = next.first;
+        const int oldspeed = next.second;
 
         if (invalid_monster(mon) || !mon->alive() || !mon->has_action_energy())
             continue;
@@ -2350,7 +2373,7 @@ void handle_monsters(bool with_noise)
         }
 
         if (mon->has_action_energy())
-            monster_queue.emplace(mon, mon->speed_increment);
+            _queue_monster(mon);
 
         // If the player got banished, discard pending monster actions.
         if (you.banished)
@@ -2813,8 +2836,13 @@ bool mon_can_move_to_pos(const monster* mons, const coord_def& delta,
     if (_check_damaging_walls(mons, targ))
         return false;
 
-    const bool digs = _mons_can_cast_dig(mons, false)
-                      || _mons_can_zap_dig(mons);
+    // Only worth asking (it searches spells and inventory) for something
+    // there is to dig through.
+    const bool diggable = target_grid == DNGN_ROCK_WALL
+                          || target_grid == DNGN_CLEAR_ROCK_WALL
+                          || target_grid == DNGN_GRATE;
+    const bool digs = diggable && (_mons_can_cast_dig(mons, false)
+                                   || _mons_can_zap_dig(mons));
     if ((target_grid == DNGN_ROCK_WALL || target_grid == DNGN_CLEAR_ROCK_WALL)
            && (mons->can_burrow() || digs)
         || mons->type == MONS_SPATIAL_MAELSTROM
@@ -932,12 +932,15 @@ void set_nearest_monster_foe(monster* mon, bool near_player)
 
     while (true)
     {
+        los_grid visible;
+        cell_see_cells(center, LOS_NO_TRANS, visible);
+
         for (auto di = distance_iterator(center, true, true,
                                          second_pass ? you.current_vision :
                                          LOS_DEFAULT_RANGE);
              di; ++di)
         {
-            if (!cell_see_cell(center, *di, LOS_NO_TRANS)
+            if (!visible(*di - center)
                 || (near_player && !you.see_cell(*di)))
             {
                 continue;
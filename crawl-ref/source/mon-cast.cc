@@ -2106,7 +2106,7 @@ static int _tension_door_closed(set<coord_def> door,
 {
     // this unwind is a bit heavy, but because out-of-los clouds dissipate
     // instantly, they can be wiped out by these door tests.
-    unwind_var<map<coord_def, cloud_struct>> cloud_state(env.cloud);
+    unwind_var<cell_map<cloud_struct>> cloud_state(env.cloud);
     _set_door(door, DNGN_CLOSED_DOOR);
     const int new_tension = get_tension(GOD_NO_GOD);
     _set_door(door, old_feat);
@@ -3169,10 +3169,12 @@ static void _corrupting_pulse(monster *mons)
         }
     }
 
+    los_grid visible;
+    cell_see_cells(mons->pos(), LOS_SOLID_SEE, visible);
     for (radius_iterator ri(mons->pos(), LOS_RADIUS, C_SQUARE); ri; ++ri)
     {
         monster *m = monster_at(*ri);
-        if (m && cell_see_cell(mons->pos(), *ri, LOS_SOLID_SEE)
+        if (m && visible(*ri - mons->pos())
             && !mons_aligned(mons, m))
         {
             m->corrupt();
@@ -3759,6 +3761,107 @@ static mon_spell_slot _find_spell_prospect(const monster &mons,
     return hspell_pass[i];
 }
 
+// Tracers fired while a monster chooses its spell. The same spell can be
+// justified at the same target more than once in one choice (an emergency
+// pick followed by the regular attempts, or a second attempt rolling the same
+// spell), and nothing moves in between, so the first result stands in for
+// the rest. See _choose_spell_to_cast().
+struct memo_tracer
+{
+    // The bolt inputs that decide what a tracer from this caster hits.
+    spell_type origin_spell;
+    coord_def  target;
+    int        range;
+    beam_type  flavour;
+    dice_def   damage;
+    int        ench_power;
+    int        hit;
+    int        ex_size;
+    bool       pierce;
+    bool       is_explosion;
+    bool       aimed_at_spot;
+    bool       affects_nothing;
+    int        foe_ratio;
+    const bolt *special_explosion;
+    bool       explode;
+
+    // What fire_tracer() leaves in the bolt.
+    coord_def         source;
+    mid_t             source_id;
+    mon_attitude_type attitude;
+    int               out_foe_ratio;
+    tracer_info       foe_info;
+    tracer_info       friend_info;
+    vector<coord_def> path_taken;
+
+    memo_tracer(const bolt &in, bool explode_)
+        : origin_spell(in.origin_spell), target(in.target), range(in.range),
+          flavour(in.flavour), damage(in.damage), ench_power(in.ench_power),
+          hit(in.hit), ex_size(in.ex_size), pierce(in.pierce),
+          is_explosion(in.is_explosion), aimed_at_spot(in.aimed_at_spot),
+          affects_nothing(in.affects_nothing), foe_ratio(in.foe_ratio),
+          special_explosion(in.special_explosion), explode(explode_)
+    {
+    }
+
+    bool matches(const bolt &b, bool explode_) const
+    {
+        return explode == explode_
+               && origin_spell == b.origin_spell
+               && target == b.target
+               && range == b.range
+               && flavour == b.flavour
+               && damage.num == b.damage.num
+               && damage.size == b.damage.size
+               && ench_power == b.ench_power
+               && hit == b.hit
+               && ex_size == b.ex_size
+               && pierce == b.pierce
+               && is_explosion == b.is_explosion
+               && aimed_at_spot == b.aimed_at_spot
+               && affects_nothing == b.affects_nothing
+               && foe_ratio == b.foe_ratio
+               && special_explosion == b.special_explosion;
+    }
+};
+static vector<memo_tracer> _tracer_memo;
+static bool _memo_tracers = false;
+
+static void _fire_memo_tracer(const monster &mons, bolt &beem, bool explode)
+{
+    if (!_memo_tracers)
+    {
+        fire_tracer(&mons, beem, explode);
+        return;
+    }
+
+    for (const memo_tracer &memo : _tracer_memo)
+    {
+        if (!memo.matches(beem, explode))
+            continue;
+
+        beem.source      = memo.source;
+        beem.source_id   = memo.source_id;
+        beem.attitude    = memo.attitude;
+        beem.foe_ratio   = memo.out_foe_ratio;
+        beem.foe_info    = memo.foe_info;
+        beem.friend_info = memo.friend_info;
+        beem.path_taken  = memo.path_taken;
+        return;
+    }
+
+    memo_tracer memo(beem, explode);
+    fire_tracer(&mons, beem, explode);
+    memo.source        = beem.source;
+    memo.source_id     = beem.source_id;
+    memo.attitude      = beem.attitude;
+    memo.out_foe_ratio = beem.foe_ratio;
+    memo.foe_info      = beem.foe_info;
+    memo.friend_info   = beem.friend_info;
+    memo.path_taken    = beem.path_taken;
+    _tracer_memo.push_back(move(memo));
+}
+
 /**
  * Would it be a good idea for the given monster to cast the given spell?
  *
@@ -3775,7 +3878,7 @@ static bool _should_cast_spell(const monster &mons, spell_type spell,
     if (get_spell_flags(spell) & spflag::needs_tracer)
     {
         const bool explode = spell_is_direct_explosion(spell);
-        fire_tracer(&mons, beem, explode);
+        _fire_memo_tracer(mons, beem, explode);
         // Good idea?
         return mons_should_fire(beem, ignore_good_idea);
     }
@@ -3833,6 +3936,25 @@ static string _ru_spell_stop_desc(monster &mons)
     return "attack";
 }
 
+// While _find_usable_spells() checks this monster's spells, how many of its
+// summons are out, by spell; counted when first needed.
+static const monster *_summon_counts_for = nullptr;
+static bool _summon_counts_valid = false;
+static map<spell_type, int> _summon_counts;
+
+static int _count_summons(const monster *mon, spell_type spell)
+{
+    if (mon != _summon_counts_for)
+        return count_summons(mon, spell);
+    if (!_summon_counts_valid)
+    {
+        _summon_counts = count_summons_by_spell(mon);
+        _summon_counts_valid = true;
+    }
+    const int *count = map_find(_summon_counts, spell);
+    return count ? *count : 0;
+}
+
 /// What spells can the given monster currently use?
 static monster_spells _find_usable_spells(monster &mons)
 {
@@ -3847,6 +3969,12 @@ static monster_spells _find_usable_spells(monster &mons)
         });
     }
 
+    // Count the caster's summons once for all its capped summon spells,
+    // rather than once for each of them.
+    _summon_counts_for = &mons;
+    _summon_counts_valid = false;
+    ON_UNWIND { _summon_counts_for = nullptr; };
+
     // Remove currently useless spells.
     erase_if(hspell_pass, [&](const mon_spell_slot &t) {
         return !ai_action::is_viable(_monster_spell_goodness(&mons, t))
@@ -3937,6 +4065,10 @@ static mon_spell_slot _choose_spell_to_cast(monster &mons,
 
     bolt orig_beem = beem;
 
+    // Nothing moves until we've chosen, so repeated tracers can be skipped.
+    _tracer_memo.clear();
+    unwind_bool memo_tracers(_memo_tracers, true);
+
     // Promote the casting of useful spells for low-HP monsters.
     // (kraken should always cast their escape spell of inky).
     if (_mons_in_emergency(mons)
@@ -4714,11 +4846,14 @@ static coord_def _mons_fragment_target(const monster &mon)
 
     const int range = mons_spell_range(*mons, SPELL_LRD);
     int maxpower = 0;
-    for (distance_iterator di(mons->pos(), true, true, range); di; ++di)
+    los_grid visible;
+    cell_see_cells(mons->pos(), LOS_SOLID, visible);
+    for (distance_iterator di(mons->pos(), true, true,
+                              min(range, LOS_MAX_RANGE)); di; ++di)
     {
         bool temp;
 
-        if (!cell_see_cell(mons->pos(), *di, LOS_SOLID))
+        if (!visible(*di - mons->pos()))
             continue;
 
         bolt beam;
@@ -7321,7 +7456,7 @@ ai_action::goodness monster_spell_goodness(monster* mon, spell_type spell)
 
     // Don't bother casting a summon spell if we're already at its cap
     if (summons_are_capped(spell)
-        && count_summons(mon, spell) >= summons_limit(spell, false))
+        && _count_summons(mon, spell) >= summons_limit(spell, false))
     {
         return ai_action::impossible();
     }
@@ -48,6 +48,7 @@
 #include "mon-cast.h"
 #include "mon-explode.h"
 #include "mon-gear.h"
+#include "mon-info.h"
 #include "mon-place.h"
 #include "mon-poly.h"
 #include "mon-speak.h"
@@ -1693,6 +1694,8 @@ item_def* monster_die(monster& mons, killer_type killer,
     if (testbits(mons.flags, MF_PENDING_REVIVAL))
         return nullptr;
 
+    invalidate_monster_info();
+
     const bool was_visible = you.can_see(mons);
 
     // If a monster was banished to the Abyss and then killed there,
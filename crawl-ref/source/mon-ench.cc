@@ -91,7 +91,9 @@ void update_mons_cloud_ring(monster* mons)
 #ifdef DEBUG_ENCH_CACHE_DIAGNOSTICS
 bool monster::has_ench(enchant_type ench) const
 {
-    mon_enchant e = get_ench(ench);
+    // Not get_ench(), which trusts the cache.
+    auto it = enchantments.find(ench);
+    mon_enchant e = it == enchantments.end() ? mon_enchant() : it->second;
     if (e.ench == ench)
     {
         if (!ench_cache[ench])
@@ -138,8 +140,13 @@ mon_enchant monster::get_ench(enchant_type ench1,
     if (ench2 == ENCH_NONE)
         ench2 = ench1;
 
+    // Most lookups are for enchantments the monster doesn't have: let the
+    // cache answer those without searching the map.
     for (int e = ench1; e <= ench2; ++e)
     {
+        if (!ench_cache[e])
+            continue;
+
         auto i = enchantments.find(static_cast<enchant_type>(e));
 
         if (i != enchantments.end())
@@ -151,7 +158,7 @@ mon_enchant monster::get_ench(enchant_type ench1,
 
 void monster::update_ench(const mon_enchant &ench)
 {
-    if (ench.ench != ENCH_NONE)
+    if (ench.ench != ENCH_NONE && ench_cache[ench.ench])
     {
         if (mon_enchant *curr_ench = map_find(enchantments, ench.ench))
             *curr_ench = ench;
@@ -1744,7 +1744,7 @@ bool monster_info::unravellable() const
                   { return this->has_trivial_ench(ench); });
 }
 
-void get_monster_info(vector<monster_info>& mons)
+static void _build_monster_info(vector<monster_info>& mons)
 {
     vector<monster* > visible;
     if (crawl_state.game_is_arena())
@@ -1766,6 +1766,59 @@ void get_monster_info(vector<monster_info>& mons)
     sort(mons.begin(), mons.end(), monster_info::less_than_wrapper);
 }
 
+// The monster list is wanted by several panes each redraw, and rarely
+// changes between them, so it's built once and shared until the view is
+// next updated, a monster dies, or time passes.
+static vector<monster_info> monster_info_list;
+static bool monster_info_list_valid = false;
+static int monster_info_list_time = -1;
+
+void invalidate_monster_info()
+{
+    monster_info_list_valid = false;
+}
+
+/**
+ * The visible monsters that matter, sorted by difficulty.
+ *
+ * The list is shared; it's good until the next call to this after
+ * something has changed, so copy it to keep it any longer.
+ */
+const vector<monster_info>& get_monster_info()
+{
+    if (!monster_info_list_valid || monster_info_list_time != you.elapsed_time)
+    {
+        monster_info_list.clear();
+        _build_monster_info(monster_info_list);
+        monster_info_list_valid = true;
+        monster_info_list_time = you.elapsed_time;
+    }
+    return monster_info_list;
+}
+
+/**
+ * The monster_info the player's map already holds for a monster, built at
+ * the last view update; for predicates that would otherwise construct a
+ * new one just to look at a few fields.
+ *
+ * @return the map's info, or nullptr if it has none for this monster.
+ */
+const monster_info* viewed_monster_info(const monster& mon)
+{
+    if (!in_bounds(mon.pos()))
+        return nullptr;
+    const monster_info *mi = env.map_knowledge(mon.pos()).monsterinfo();
+    if (!mi || !mi->client_id || mi->client_id != mon.get_client_id())
+        return nullptr;
+    return mi;
+}
+
+void get_monster_info(vector<monster_info>& mons)
+{
+    const vector<monster_info> &list = get_monster_info();
+    mons.insert(mons.end(), list.begin(), list.end());
+}
+
 void mons_to_string_pane(string& desc, int& desc_colour, bool fullname,
                          const vector<monster_info>& mi, int start,
                          int count)
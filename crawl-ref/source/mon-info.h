@@ -299,6 +299,9 @@ struct monster_info : public monster_info_base
         return *this;
     }
 
+    monster_info(monster_info&& mi) = default;
+    monster_info& operator=(monster_info&& mi) = default;
+
     void to_string(int count, string& desc, int& desc_colour,
                    bool fullname = true, const char *adjective = nullptr,
                    bool verbose = true) const;
@@ -430,7 +433,10 @@ protected:
 bool set_monster_list_colour(string key, int colour);
 void clear_monster_list_colours();
 
+const vector<monster_info>& get_monster_info();
+const monster_info* viewed_monster_info(const monster& mon);
 void get_monster_info(vector<monster_info>& mons);
+void invalidate_monster_info();
 
 void mons_to_string_pane(string& desc, int& desc_colour, bool fullname,
                            const vector<monster_info>& mi, int start,
@@ -214,7 +214,7 @@ bool try_pathfind(monster* mon)
     monster_pathfind mp;
     mp.set_range(range);
 
-    if (mp.init_pathfind(mon, targpos))
+    if (mp.init_flow_pathfind(mon, targpos))
     {
         mon->travel_path = mp.calc_waypoints();
         if (!mon->travel_path.empty())
@@ -958,14 +958,23 @@ static void _find_all_level_exits(vector<level_exit> &e)
 {
     e.clear();
 
-    for (rectangle_iterator ri(1); ri; ++ri)
-    {
-        if (!in_bounds(*ri))
-            continue;
-
-        if (_is_level_exit(*ri))
-            e.push_back(level_exit(*ri, false));
-    }
+    vector<coord_def> exits;
+    for (const coord_def &c : level_stairs())
+        if (in_bounds(c))
+            exits.push_back(c);
+    for (const trap_def &trap : env.trap)
+        if (_is_level_exit(trap.pos) && !feat_is_stair(env.grid(trap.pos)))
+            exits.push_back(trap.pos);
+
+    // In the order a scan of the level would find them, which decides
+    // between exits at the same distance.
+    sort(exits.begin(), exits.end(),
+         [](const coord_def &a, const coord_def &b)
+         {
+             return a.y < b.y || (a.y == b.y && a.x < b.x);
+         });
+    for (const coord_def &c : exits)
+        e.push_back(level_exit(c, false));
 }
 
 int mons_find_nearest_level_exit(const monster* mon, vector<level_exit> &e,
@@ -2,12 +2,16 @@
 
 #include "mon-pathfind.h"
 
+#include "coordit.h"
 #include "directn.h"
 #include "env.h"
+#include "libutil.h"
 #include "los.h"
 #include "misc.h"
 #include "mon-movetarget.h"
 #include "mon-place.h"
+#include "mon-util.h"
+#include "place.h"
 #include "religion.h"
 #include "state.h"
 #include "terrain.h"
@@ -60,16 +64,100 @@ int mons_tracking_range(const monster* mon)
     return range;
 }
 
+// Scratch space for one search; big enough that it's worth reusing rather
+// than building it on the stack each time. Per-cell entries are only valid
+// when their stamp matches the current search, so nothing needs clearing
+// when a new search starts. Queued positions are kept in buckets by total
+// estimated path length. Each bucket is a linked list threaded through
+// next_node/prev_node, newest first.
+struct pathfind_workspace
+{
+    unsigned int search;
+    unsigned int stamp[GXM][GYM];
+    // The distances from start to any already tried point.
+    int dist[GXM][GYM];
+    // Where we came from on a given shortest path.
+    int prev[GXM][GYM];
+    maybe_bool traversable_cache[GXM][GYM];
+    bool queued[GXM][GYM];
+
+    int next_node[GXM * GYM];
+    int prev_node[GXM * GYM];
+    unsigned int bucket_stamp[GXM * GYM];
+    int bucket[GXM * GYM];
+
+    void new_search()
+    {
+        if (!++search)
+        {
+            memset(stamp, 0, sizeof(stamp));
+            memset(bucket_stamp, 0, sizeof(bucket_stamp));
+            search = 1;
+        }
+    }
+
+    void touch(const coord_def &p)
+    {
+        if (stamp[p.x][p.y] == search)
+            return;
+        stamp[p.x][p.y] = search;
+        dist[p.x][p.y] = INFINITE_DISTANCE;
+        traversable_cache[p.x][p.y] = MB_MAYBE;
+        queued[p.x][p.y] = false;
+    }
+
+    int &head(int total)
+    {
+        ASSERT_RANGE(total, 0, GXM * GYM);
+        if (bucket_stamp[total] != search)
+        {
+            bucket_stamp[total] = search;
+            bucket[total] = -1;
+        }
+        return bucket[total];
+    }
+};
+
+static vector<pathfind_workspace*> _spare_workspaces;
+
+static int _node(const coord_def &p)
+{
+    return p.x * GYM + p.y;
+}
+
+static coord_def _node_pos(int n)
+{
+    return coord_def(n / GYM, n % GYM);
+}
+
 //#define DEBUG_PATHFIND
 monster_pathfind::monster_pathfind()
     : mons(nullptr), start(), target(), pos(), allow_diagonals(true),
-      traverse_unmapped(false), range(0), min_length(0), max_length(0),
-      dist(), prev(), hash(), traversable_cache()
+      traverse_unmapped(false), range(0), min_length(0), max_length(0)
 {
+    if (_spare_workspaces.empty())
+    {
+        ws = new pathfind_workspace;
+        ws->search = 0;
+        memset(ws->stamp, 0, sizeof(ws->stamp));
+        memset(ws->bucket_stamp, 0, sizeof(ws->bucket_stamp));
+    }
+    else
+    {
+        ws = _spare_workspaces.back();
+        _spare_workspaces.pop_back();
+    }
 }
 
 monster_pathfind::~monster_pathfind()
 {
+    _spare_workspaces.push_back(ws);
+}
+
+int &monster_pathfind::dist(const coord_def &p)
+{
+    ws->touch(p);
+    return ws->dist[p.x][p.y];
 }
 
 void monster_pathfind::set_range(int r)
@@ -80,7 +168,7 @@ void monster_pathfind::set_range(int r)
 
 coord_def monster_pathfind::next_pos(const coord_def &c) const
 {
-    return c + Compass[prev[c.x][c.y]];
+    return c + Compass[ws->prev[c.x][c.y]];
 }
 
 // The main method in the monster_pathfind class.
@@ -126,6 +214,223 @@ bool monster_pathfind::init_pathfind(coord_def src, coord_def dest, bool diag,
     return start_pathfind(msg);
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Flow fields
+//
+// When a crowd of monsters hunts the same target, they would each run
+// their own A* over much the same ground. Instead, one search outward from
+// the target gives the cost of the cheapest path from every cell within
+// range, and all monsters that move alike just walk downhill on it. The
+// fields are only kept for the current turn (and are dropped whenever the
+// terrain changes wholesale), so they can't go stale for long.
+
+// Everything about a monster that traversable() and travel_cost() depend on;
+// monsters with the same key get the same answers everywhere.
+struct flow_key
+{
+    coord_def target;
+    int range;
+    monster_type type;
+    monster_type base_type;
+    mon_attitude_type attitude;
+    mon_itemuse_type itemuse;
+    size_type size;
+    bool airborne;
+    bool eats_items;
+    bool sees_you;
+
+    bool operator==(const flow_key &other) const
+    {
+        return target == other.target && range == other.range
+               && type == other.type && base_type == other.base_type
+               && attitude == other.attitude && itemuse == other.itemuse
+               && size == other.size && airborne == other.airborne
+               && eats_items == other.eats_items && sees_you == other.sees_you;
+    }
+};
+
+struct flow_field
+{
+    flow_key key;
+    // The cost of the cheapest path from each cell to the target, or
+    // INFINITE_DISTANCE if there is none within range.
+    int dist[GXM][GYM];
+};
+
+#define MAX_FLOW_FIELDS 8
+
+// Most recently used first.
+static vector<flow_field*> _flow_fields;
+static int _flow_fields_time = -1;
+static level_id _flow_fields_level;
+
+void clear_pathfind_flow_fields()
+{
+    deleteAll(_flow_fields);
+}
+
+static flow_key _flow_key(const monster &mon, coord_def target, int range)
+{
+    flow_key key;
+    key.target     = target;
+    key.range      = range;
+    key.type       = mon.type;
+    key.base_type  = mon.base_monster;
+    key.attitude   = mon.attitude;
+    key.itemuse    = mons_itemuse(mon);
+    key.size       = mon.body_size(PSIZE_BODY);
+    key.airborne   = mon.airborne();
+    key.eats_items = mons_eats_items(mon);
+    key.sees_you   = mon.friendly() && mon.can_see(you);
+    return key;
+}
+
+// Build the field from target outwards. This is Dijkstra's algorithm run
+// backwards; step costs are 1 to 3, so four rotating buckets are enough for
+// the queue. Cells that can't be passed through still get a cost (so that
+// a monster stuck in one can step out), but are never expanded.
+void monster_pathfind::build_flow_field(int (&field)[GXM][GYM])
+{
+    for (int i = 0; i < GXM; i++)
+        for (int j = 0; j < GYM; j++)
+            field[i][j] = INFINITE_DISTANCE;
+
+    ws->new_search();
+    vector<coord_def> queue[4];
+    field[target.x][target.y] = 0;
+    queue[0].push_back(target);
+    int queued = 1;
+
+    for (int d = 0; queued; d++)
+    {
+        vector<coord_def> &now = queue[d % 4];
+        while (!now.empty())
+        {
+            const coord_def q = now.back();
+            now.pop_back();
+            queued--;
+            if (field[q.x][q.y] != d)
+                continue;
+            if (q != target && !traversable_memoized(q))
+                continue;
+
+            // What it costs to step onto q.
+            pos = q;
+            const int step = d + travel_cost(q);
+            for (adjacent_iterator ai(q); ai; ++ai)
+            {
+                const coord_def p = *ai;
+                if (!in_bounds(p) || estimated_cost(p) > range
+                    || step > range * 2 || step >= field[p.x][p.y])
+                {
+                    continue;
+                }
+                field[p.x][p.y] = step;
+                queue[step % 4].push_back(p);
+                queued++;
+            }
+        }
+    }
+}
+
+// Walk downhill on field from start to target, filling prev as a search
+// would have, so that backtrack() and calc_waypoints() work as usual.
+bool monster_pathfind::follow_flow_field(const int (&field)[GXM][GYM])
+{
+    ws->new_search();
+    pos = start;
+    // As in calc_path_to_neighbours(): diagonals first, orthogonals last,
+    // with a random rotation to avoid bias.
+    const int rotate = random2(4) * 2;
+    while (pos != target)
+    {
+        int best = INFINITE_DISTANCE, best_dir = -1;
+        for (int idir = 1; idir < 8; (idir += 2) == 9 && (idir = 0))
+        {
+            const int dir = (idir + rotate) % 8;
+            const coord_def npos = pos + Compass[dir];
+            if (!in_bounds(npos)
+                || field[npos.x][npos.y] == INFINITE_DISTANCE
+                || npos != target && !traversable_memoized(npos))
+            {
+                continue;
+            }
+            const int cost = field[npos.x][npos.y] + travel_cost(npos);
+            if (cost < best)
+                best = cost, best_dir = dir;
+        }
+
+        if (best_dir == -1)
+            return false;
+
+        pos += Compass[best_dir];
+        ws->prev[pos.x][pos.y] = (best_dir + 4) % 8;
+    }
+    return true;
+}
+
+// Like init_pathfind(mon, dest), but shares the work with other monsters
+// moving alike towards the same target this turn. Falls back to a normal
+// search for unusual movers.
+bool monster_pathfind::init_flow_pathfind(const monster* mon, coord_def dest)
+{
+    mons   = mon;
+    start  = mon->pos();
+    target = dest;
+    pos    = start;
+    allow_diagonals   = true;
+    traverse_unmapped = false;
+    traverse_in_sight = (!crawl_state.game_is_arena()
+                         && mon->friendly() &&  mon->is_summoned()
+                         && you.see_cell_no_trans(mon->pos()));
+
+    if (start == target)
+        return true;
+
+    // Limiting the search to the player's sight, briar-hugging thorn
+    // hunters and ghosts with their own movement aren't shared.
+    if (!range || traverse_in_sight || mon->type == MONS_THORN_HUNTER
+        || mons_is_ghost_demon(mon->type))
+    {
+        return start_pathfind();
+    }
+
+    if (you.elapsed_time != _flow_fields_time
+        || level_id::current() != _flow_fields_level)
+    {
+        clear_pathfind_flow_fields();
+        _flow_fields_time  = you.elapsed_time;
+        _flow_fields_level = level_id::current();
+    }
+
+    const flow_key key = _flow_key(*mon, dest, range);
+    flow_field *field = nullptr;
+    for (unsigned int i = 0; i < _flow_fields.size(); i++)
+        if (_flow_fields[i]->key == key)
+        {
+            field = _flow_fields[i];
+            _flow_fields.erase(_flow_fields.begin() + i);
+            break;
+        }
+
+    if (!field)
+    {
+        if (_flow_fields.size() >= MAX_FLOW_FIELDS)
+        {
+            field = _flow_fields.back();
+            _flow_fields.pop_back();
+        }
+        else
+            field = new flow_field;
+        field->key = key;
+        build_flow_field(field->dist);
+        pos = start;
+    }
+    _flow_fields.insert(_flow_fields.begin(), field);
+
+    return follow_flow_field(field->dist);
+}
+
 bool monster_pathfind::start_pathfind(bool msg)
 {
     // NOTE: We never do any traversable() check for the target square.
@@ -136,14 +441,8 @@ bool monster_pathfind::start_pathfind(bool msg)
     //       a wall.
 
     max_length = min_length = grid_distance(pos, target);
-    for (int i = 0; i < GXM; i++)
-        for (int j = 0; j < GYM; j++)
-        {
-            dist[i][j] = INFINITE_DISTANCE;
-            traversable_cache[i][j] = MB_MAYBE;
-        }
-
-    dist[pos.x][pos.y] = 0;
+    ws->new_search();
+    dist(pos) = 0;
 
     bool success = false;
     do
@@ -213,8 +512,8 @@ bool monster_pathfind::calc_path_to_neighbours()
         if (range && estimated_cost(npos) > range)
             continue;
 
-        distance = dist[pos.x][pos.y] + travel_cost(npos);
-        old_dist = dist[npos.x][npos.y];
+        distance = dist(pos) + travel_cost(npos);
+        old_dist = dist(npos);
 
         // Also bail out if this would make the path longer than twice the
         // allowed distance from the target. (This factor may need tuning.)
@@ -256,7 +555,7 @@ bool monster_pathfind::calc_path_to_neighbours()
             }
 
             // Update distance start->pos.
-            dist[npos.x][npos.y] = distance;
+            dist(npos) = distance;
 
             // Set backtracking information.
             // Converts the Compass direction to its counterpart.
@@ -264,7 +563,7 @@ bool monster_pathfind::calc_path_to_neighbours()
             //      7  .  3   ==>   3  .  7       e.g. (3 + 4) % 8          = 7
             //      6  5  4         2  1  0            (7 + 4) % 8 = 11 % 8 = 3
 
-            prev[npos.x][npos.y] = (dir + 4) % 8;
+            ws->prev[npos.x][npos.y] = (dir + 4) % 8;
 
             // Are we finished?
             if (npos == target)
@@ -280,22 +579,26 @@ bool monster_pathfind::calc_path_to_neighbours()
 }
 
 // Starting at known min_length (minimum total estimated path distance), check
-// the hash for existing vectors, then pick the last entry of the first vector
-// that matches. Update min_length, if necessary.
+// the buckets for queued positions, then pick the newest entry of the first
+// bucket that has any. Update min_length, if necessary.
 bool monster_pathfind::get_best_position()
 {
     for (int i = min_length; i <= max_length; i++)
     {
-        if (!hash[i].empty())
+        int &head = ws->head(i);
+        if (head >= 0)
         {
             if (i > min_length)
                 min_length = i;
 
-            vector<coord_def> &vec = hash[i];
-            // Pick the last position pushed into the vector as it's most
+            // Pick the last position pushed into the bucket as it's most
             // likely to be close to the target.
-            pos = vec[vec.size()-1];
-            vec.pop_back();
+            const int n = head;
+            head = ws->next_node[n];
+            if (head >= 0)
+                ws->prev_node[head] = -1;
+            pos = _node_pos(n);
+            ws->queued[pos.x][pos.y] = false;
 
 #ifdef DEBUG_PATHFIND
             mprf("Returning (%d, %d) as best pos with total dist %d.",
@@ -330,7 +633,7 @@ vector<coord_def> monster_pathfind::backtrack()
     int dir;
     do
     {
-        dir = prev[pos.x][pos.y];
+        dir = ws->prev[pos.x][pos.y];
         pos = pos + Compass[dir];
         ASSERT_IN_BOUNDS(pos);
 #ifdef DEBUG_PATHFIND
@@ -394,9 +697,11 @@ vector<coord_def> monster_pathfind::calc_waypoints()
 
 bool monster_pathfind::traversable_memoized(const coord_def& p)
 {
-    if (traversable_cache[p.x][p.y] == MB_MAYBE)
-        traversable_cache[p.x][p.y] = frombool(traversable(p));
-    return tobool(traversable_cache[p.x][p.y], false);
+    ws->touch(p);
+    maybe_bool &cached = ws->traversable_cache[p.x][p.y];
+    if (cached == MB_MAYBE)
+        cached = frombool(traversable(p));
+    return tobool(cached, false);
 }
 
 bool monster_pathfind::traversable(const coord_def& p)
@@ -495,23 +800,32 @@ int monster_pathfind::estimated_cost(coord_def p)
 
 void monster_pathfind::add_new_pos(coord_def npos, int total)
 {
-    hash[total].push_back(npos);
+    const int n = _node(npos);
+    int &head = ws->head(total);
+    ws->next_node[n] = head;
+    ws->prev_node[n] = -1;
+    if (head >= 0)
+        ws->prev_node[head] = n;
+    head = n;
+    ws->touch(npos);
+    ws->queued[npos.x][npos.y] = true;
 }
 
 void monster_pathfind::update_pos(coord_def npos, int total)
 {
-    // Find hash position of old distance and delete it,
-    // then call_add_new_pos.
-    int old_total = dist[npos.x][npos.y] + estimated_cost(npos);
-
-    vector<coord_def> &vec = hash[old_total];
-    for (unsigned int i = 0; i < vec.size(); i++)
+    // Take it out of the bucket for its old distance, if it's still
+    // queued, then call add_new_pos.
+    if (ws->queued[npos.x][npos.y])
     {
-        if (vec[i] == npos)
-        {
-            vec.erase(vec.begin() + i);
-            break;
-        }
+        const int old_total = dist(npos) + estimated_cost(npos);
+        const int n = _node(npos);
+        const int next = ws->next_node[n], prev = ws->prev_node[n];
+        if (prev >= 0)
+            ws->next_node[prev] = next;
+        else
+            ws->head(old_total) = next;
+        if (next >= 0)
+            ws->prev_node[next] = prev;
     }
 
     add_new_pos(npos, total);
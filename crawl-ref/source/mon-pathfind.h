@@ -10,14 +10,18 @@
 using std::vector;
 
 class monster;
+struct pathfind_workspace;
 
 int mons_tracking_range(const monster* mon);
+void clear_pathfind_flow_fields();
 
 class monster_pathfind
 {
 public:
     monster_pathfind();
     virtual ~monster_pathfind();
+    monster_pathfind(const monster_pathfind &) = delete;
+    monster_pathfind &operator=(const monster_pathfind &) = delete;
 
     // public methods
     void set_range(int r);
@@ -27,6 +31,7 @@ public:
                        bool pass_unmapped = false);
     bool init_pathfind(coord_def src, coord_def dest,
                        bool diag = true, bool msg = false);
+    bool init_flow_pathfind(const monster* mon, coord_def dest);
     bool start_pathfind(bool msg = false);
     vector<coord_def> backtrack();
     vector<coord_def> calc_waypoints();
@@ -43,6 +48,9 @@ protected:
     void add_new_pos(coord_def pos, int total);
     void update_pos(coord_def pos, int total);
     bool get_best_position();
+    int &dist(const coord_def &p);
+    void build_flow_field(int (&field)[GXM][GYM]);
+    bool follow_flow_field(const int (&field)[GXM][GYM]);
 
     // The monster trying to find a path.
     const monster* mons;
@@ -69,12 +77,7 @@ protected:
     int min_length;
     int max_length;
 
-    // The array of distances from start to any already tried point.
-    int dist[GXM][GYM];
-    // An array to store where we came from on a given shortest path.
-    int prev[GXM][GYM];
-
-    FixedVector<vector<coord_def>, GXM * GYM> hash;
-
-    maybe_bool traversable_cache[GXM][GYM];
+    // Distances, backtracking information and the queue of positions to
+    // look at, borrowed from a pool for as long as we live.
+    pathfind_workspace *ws;
 };
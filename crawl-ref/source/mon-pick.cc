@@ -88,12 +88,79 @@ monster_type pick_monster_from(const vector<pop_entry>& fpop, int depth,
     return picker.pick_with_veto(fpop, depth, MONS_0, veto);
 }
 
+namespace
+{
+    // The monsters of a population table that can appear at a depth, in
+    // table order, with their rarities there.
+    struct depth_population
+    {
+        // to notice a table that isn't the one this was made from
+        const pop_entry *data;
+        size_t size;
+        vector<pair<monster_type, int>> entries;
+    };
+}
+
+// Populations are static tables, so remember what they hold at each depth by
+// their address rather than working it out again for every pick.
+static const depth_population &_population_at(monster_picker &picker,
+                                              const vector<pop_entry> &weights,
+                                              int level)
+{
+    static map<pair<const vector<pop_entry> *, int>, depth_population> cache;
+
+    depth_population &pop = cache[make_pair(&weights, level)];
+    if (pop.data == weights.data() && pop.size == weights.size())
+        return pop;
+
+    pop.data = weights.data();
+    pop.size = weights.size();
+    pop.entries.clear();
+    for (const pop_entry &entry : weights)
+    {
+        if (level < entry.minr || level > entry.maxr)
+            continue;
+
+        pop.entries.emplace_back(entry.value, picker.rarity_at(entry, level));
+    }
+    return pop;
+}
+
 monster_type monster_picker::pick_with_veto(const vector<pop_entry>& weights,
                                             int level, monster_type none,
                                             mon_pick_vetoer vetoer)
 {
     _veto = vetoer;
-    return pick(weights, level, none);
+
+    // This is random_picker::pick() over the remembered population: the
+    // vetoes are asked in the same order and the roll is the same, so the
+    // same monster comes out of the same RNG state.
+    const auto &entries = _population_at(*this, weights, level).entries;
+    ASSERT(entries.size() <= NUM_MONSTERS);
+    bool vetoed[NUM_MONSTERS];
+    int totalrar = 0;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        vetoed[i] = veto(entries[i].first);
+        if (vetoed[i])
+            continue;
+
+        const int rar = entries[i].second;
+        ASSERTM(rar > 0, "Rarity %d: %d at level %d", rar, entries[i].first,
+                level);
+        totalrar += rar;
+    }
+
+    if (!totalrar)
+        return none;
+
+    totalrar = random2(totalrar); // the roll!
+
+    for (size_t i = 0; i < entries.size(); i++)
+        if (!vetoed[i] && (totalrar -= entries[i].second) < 0)
+            return entries[i].first;
+
+    die("random_pick roll out of range");
 }
 
 // Veto specialisation for the monster_picker class; this simply calls the
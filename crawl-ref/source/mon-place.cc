@@ -12,6 +12,7 @@
 #include <functional>
 
 #include "abyss.h"
+#include "act-iter.h"
 #include "areas.h"
 #include "arena.h"
 #include "attitude-change.h"
@@ -540,6 +541,34 @@ monster_type fixup_zombie_type(const monster_type cls,
             : cls;
 }
 
+// Whether any stair that matches is within LOS_RADIUS of pos. Looking
+// through the level's stairs beats looking at every cell in range, which
+// is what it comes to for every candidate spot.
+static bool _stair_near(const coord_def &pos,
+                        bool (*matches)(dungeon_feature_type))
+{
+    for (const coord_def &stair : level_stairs())
+    {
+        if (in_bounds(stair) && grid_distance(pos, stair) <= LOS_RADIUS
+            && matches(env.grid(stair)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool _is_entrance_stair(dungeon_feature_type feat)
+{
+    // We may be checking before branch exit cleanup.
+    return feat_is_branch_exit(feat) || feat_is_stone_stair_up(feat);
+}
+
+static bool _is_delver_stair(dungeon_feature_type feat)
+{
+    return feat == DNGN_STONE_STAIRS_DOWN_I;
+}
+
 // Checks if the monster is ok to place at mg_pos. If force_location
 // is true, then we'll be less rigorous in our checks, in particular
 // allowing land monsters to be placed in shallow water and water
@@ -577,33 +606,25 @@ static bool _valid_monster_generation_location(const mgen_data &mg,
     // Check that the location is not proximal to level stairs.
     else if (mg.proximity == PROX_AWAY_FROM_STAIRS)
     {
-        for (distance_iterator di(mg_pos, false, false, LOS_RADIUS); di; ++di)
-            if (feat_is_stone_stair(env.grid(*di)))
-                return false;
+        if (_stair_near(mg_pos, feat_is_stone_stair))
+            return false;
     }
     // Check that the location is not proximal to an area where the player
     // begins the game.
     else if (mg.proximity == PROX_AWAY_FROM_ENTRANCE)
     {
-        for (distance_iterator di(mg_pos, false, false, LOS_RADIUS); di; ++di)
+        // for consistency, this should happen regardless of whether the
+        // player is starting on D:1
+        if (env.absdepth0 == 0)
         {
-            // for consistency, this should happen regardless of whether the
-            // player is starting on D:1
-            if (env.absdepth0 == 0)
-            {
-                if (feat_is_branch_exit(env.grid(*di))
-                    // We may be checking before branch exit cleanup.
-                    || feat_is_stone_stair_up(env.grid(*di)))
-                {
-                    return false;
-                }
-            }
-            else if (env.absdepth0 == starting_absdepth())
-            {
-                // Delvers start on a (specific) D:5 downstairs.
-                if (env.grid(*di) == DNGN_STONE_STAIRS_DOWN_I)
-                    return false;
-            }
+            if (_stair_near(mg_pos, _is_entrance_stair))
+                return false;
+        }
+        else if (env.absdepth0 == starting_absdepth())
+        {
+            // Delvers start on a (specific) D:5 downstairs.
+            if (_stair_near(mg_pos, _is_delver_stair))
+                return false;
         }
     }
 
@@ -836,10 +857,13 @@ monster* place_monster(mgen_data mg, bool force_pos, bool dont_place)
 
 monster* get_free_monster()
 {
+    // Always the lowest free slot, as for items; slots are freed wherever a
+    // monster's type is reset, so there's nothing to keep a free list with.
     for (auto &mons : menv_real)
         if (mons.type == MONS_NO_MONSTER)
         {
             mons.reset();
+            note_monster_slot(mons);
             return &mons;
         }
 
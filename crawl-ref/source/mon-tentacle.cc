@@ -1137,11 +1137,10 @@ void move_child_tentacles(monster* mons)
 
 static monster* _mons_get_parent_monster(monster* mons)
 {
-    for (monster_iterator mi; mi; ++mi)
-    {
-        if (mi->is_parent_monster_of(mons))
-            return *mi;
-    }
+    // A child only has the one parent, which it knows the mid of.
+    monster* parent = monster_by_mid(mons->tentacle_connect);
+    if (parent && parent->alive() && parent->is_parent_monster_of(mons))
+        return parent;
 
     return nullptr;
 }
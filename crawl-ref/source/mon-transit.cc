@@ -107,18 +107,17 @@ static void _level_place_followers(m_transit_list &m)
     for (auto i = m.begin(); i != m.end();)
     {
         auto mon = i++;
-        if ((mon->mons.flags & MF_TAKING_STAIRS) && mon->place(true))
+        if (!(mon->mons.flags & MF_TAKING_STAIRS))
+            continue;
+
+        if (monster* new_mon = mon->place(true))
         {
-            if (mon->mons.is_divine_companion())
-            {
-                move_companion_to(monster_by_mid(mon->mons.mid),
-                                                 level_id::current());
-            }
+            if (new_mon->is_divine_companion())
+                move_companion_to(new_mon, level_id::current());
 
             // Now that the monster is onlevel, we can safely apply traps to it.
-            if (monster* new_mon = monster_by_mid(mon->mons.mid))
-                // old loc isn't really meaningful
-                new_mon->apply_location_effects(new_mon->pos());
+            // old loc isn't really meaningful
+            new_mon->apply_location_effects(new_mon->pos());
             m.erase(mon);
         }
     }
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <cmath>
 #include <sstream>
+#include <unordered_map>
 
 #include "act-iter.h"
 #include "areas.h"
@@ -193,7 +194,9 @@ monster_type random_monster_at_grid(const coord_def& p, bool species)
                               : valid_mons[ random2(valid_mons.size()) ];
 }
 
-typedef map<string, monster_type> mon_name_map;
+// Only ever looked up by exact name (from Lua, maps and wizard commands), so
+// a hash beats the string comparisons of an ordered map.
+typedef unordered_map<string, monster_type> mon_name_map;
 static mon_name_map Mon_Name_Cache;
 
 void init_mon_name_cache()
@@ -201,6 +204,7 @@ void init_mon_name_cache()
     if (!Mon_Name_Cache.empty())
         return;
 
+    Mon_Name_Cache.reserve(ARRAYSZ(mondata));
     for (const monsterentry &me : mondata)
     {
         string name = me.name;
@@ -212,7 +216,7 @@ void init_mon_name_cache()
         // Deal sensibly with duplicate entries; refuse or allow the
         // insert, depending on which should take precedence. Some
         // uniques of multiple forms can get away with this, though.
-        if (Mon_Name_Cache.count(name))
+        if (!Mon_Name_Cache.emplace(name, mon).second)
         {
             if (mon == MONS_PLAYER_SHADOW
                 || mon == MONS_BAI_SUZHEN_DRAGON
@@ -225,8 +229,6 @@ void init_mon_name_cache()
             else
                 die("Un-handled duplicate monster name: %s", name.c_str());
         }
-
-        Mon_Name_Cache[name] = mon;
     }
 }
 
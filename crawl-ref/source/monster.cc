@@ -116,6 +116,8 @@ monster &monster::operator = (const monster& mon)
 
 void monster::reset()
 {
+    forget_monster_slot(*this);
+
     mname.clear();
     enchantments.clear();
     ench_cache.reset();
@@ -208,6 +210,9 @@ void monster::init_with(const monster& mon)
         ghost.reset(new ghost_demon(*mon.ghost));
     else
         ghost.reset(nullptr);
+
+    if (type != MONS_NO_MONSTER)
+        note_monster_slot(*this);
 }
 
 uint32_t monster::last_client_id = 0;
@@ -4936,14 +4941,13 @@ bool monster::invisible() const
 
 bool monster::visible_to(const actor *looker) const
 {
-    const bool blind = looker->is_monster()
-                       && looker->as_monster()->has_ench(ENCH_BLIND);
-    const bool physically_vis = !blind && (!invisible()
-                                           || looker->can_see_invisible());
-    const bool seen_by_att = looker->is_player() && (friendly() || pacified());
-
-    const bool vis = seen_by_att || physically_vis;
-    return vis && (this == looker || !submerged());
+    if (this != looker && submerged())
+        return false;
+    if (looker->is_player() && (friendly() || pacified()))
+        return true;
+    if (looker->is_monster() && looker->as_monster()->has_ench(ENCH_BLIND))
+        return false;
+    return !invisible() || looker->can_see_invisible();
 }
 
 bool monster::near_foe() const
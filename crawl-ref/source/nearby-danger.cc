@@ -89,13 +89,79 @@ static bool _mons_has_path_to_player(const monster* mon)
     return false;
 }
 
+// What _mons_has_path_to_player() last said about each monster, and what it
+// depended on. The path search is the expensive part of tension, which Xom,
+// Cheibriados and monster door spells all ask for several times a turn while
+// nothing has moved. Terrain and stationary monsters can change the answer
+// without either end moving, so los.cc bumps the epoch when they do.
+struct hurt_path_cache
+{
+    mid_t mid = MID_NOBODY;
+    monster_type type;
+    coord_def mon_pos;
+    coord_def you_pos;
+    int turn;
+    unsigned int epoch;
+    int range;
+    bool airborne;
+    montravel_target_type travel_target;
+    bool has_path;
+};
+
+static hurt_path_cache _hurt_paths[MAX_MONSTERS];
+static unsigned int _hurt_path_epoch = 0;
+
+void invalidate_hurt_player_cache()
+{
+    ++_hurt_path_epoch;
+}
+
+static bool _hurt_path_matches(const hurt_path_cache &entry,
+                               const monster* mon)
+{
+    return entry.mid == mon->mid
+           && entry.type == mon->type
+           && entry.mon_pos == mon->pos()
+           && entry.you_pos == you.pos()
+           && entry.turn == you.num_turns
+           && entry.epoch == _hurt_path_epoch
+           && entry.airborne == mon->airborne()
+           && entry.travel_target == mon->travel_target
+           && entry.range == mons_tracking_range(mon);
+}
+
+static bool _mons_has_cached_path_to_player(const monster* mon)
+{
+    const int idx = mon->mindex();
+    // Only monsters on the level have a slot; copies just search.
+    if (invalid_monster_index(idx) || &env.mons[idx] != mon)
+        return _mons_has_path_to_player(mon);
+
+    hurt_path_cache &entry = _hurt_paths[idx];
+    if (_hurt_path_matches(entry, mon))
+        return entry.has_path;
+
+    // Only afterwards, since the search may mark the monster as unreachable.
+    entry.has_path = _mons_has_path_to_player(mon);
+    entry.mid = mon->mid;
+    entry.type = mon->type;
+    entry.mon_pos = mon->pos();
+    entry.you_pos = you.pos();
+    entry.turn = you.num_turns;
+    entry.epoch = _hurt_path_epoch;
+    entry.range = mons_tracking_range(mon);
+    entry.airborne = mon->airborne();
+    entry.travel_target = mon->travel_target;
+    return entry.has_path;
+}
+
 bool mons_can_hurt_player(const monster* mon)
 {
     // FIXME: This takes into account whether the player knows the map!
     //        It should, for the purposes of i_feel_safe. [rob]
     // It also always returns true for sleeping monsters, but that's okay
     // for its current purposes. (Travel interruptions and tension.)
-    if (_mons_has_path_to_player(mon))
+    if (_mons_has_cached_path_to_player(mon))
         return true;
 
     // Even if the monster can not actually reach the player it might
@@ -17,6 +17,8 @@ using std::vector;
 extern const struct coord_def Compass[9];
 
 bool mons_can_hurt_player(const monster* mon);
+// Terrain, LOS or a stationary monster changed; forget the paths found.
+void invalidate_hurt_player_cache();
 bool mons_is_safe(const monster* mon, const bool want_move = false,
                   const bool consider_user_options = true,
                   const bool check_dist = true);
@@ -115,7 +115,8 @@ public:
     // Propagate noise from the noise sources registered.
     void propagate_noise();
 
-    // Clear all noise from the noise grid.
+    // Clear all noise from the noise grid. Only cells that were reached by
+    // a noise since the last reset are touched.
     void reset();
 
     bool dirty() const { return !noises.empty(); }
@@ -127,6 +128,7 @@ public:
 #endif
 
 private:
+    noise_cell &touch(const coord_def &pos);
     bool propagate_noise_to_neighbour(int base_attenuation,
                                       int travel_distance,
                                       const noise_cell &cell,
@@ -142,6 +144,8 @@ private:
 
 private:
     FixedArray<noise_cell, GXM, GYM> cells;
+    vector<coord_def> touched_cells;
+    vector<coord_def> noise_perimeter[2];
     vector<noise_t> noises;
     int affected_actor_count;
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -184,6 +185,7 @@ public:
     uint64_t    seed;           // Non-random games.
     uint64_t    seed_from_rc;
     level_gen_type pregen_dungeon;
+    int         pregen_lookahead; // Levels to build ahead while idle.
 
 #ifdef DGL_SIMPLE_MESSAGING
     bool        messaging;      // Check for messages.
@@ -326,6 +328,8 @@ public:
     wizard_option_type explore_mode;  // no, never, start in explore mode
 
     vector<string> terp_files; // Lua files to load for luaterp
+    int            lua_gc_pause;   // clua collector pause, in percent
+    int            lua_gc_stepmul; // clua collector step multiplier
     bool           no_save;    // don't use persistent save files
     bool           no_player_bones;   // don't save player's info in bones files
 
@@ -429,6 +433,7 @@ public:
     vector<menu_sort_condition> sort_menus;
 
     bool        dump_on_save;       // Automatically dump character when saving.
+    bool        key_journal;        // Record keys for -replay.
     kill_dump_options dump_kill_places;   // How to dump place information for kills.
     int         dump_message_count; // How many old messages to dump
 
@@ -644,6 +649,10 @@ private:
 
 public:
     bool prefs_dirty;
+    // Bumped for every option line read and on a reset, so that anything
+    // derived from the options (like the remembered parts of the view, or
+    // combined option patterns) can be redone.
+    unsigned int lines_read = 0;
     // Fix option values if necessary, specifically file paths.
     void fixup_options();
     void reset_loaded_state();
@@ -718,9 +727,9 @@ private:
     static const string interrupt_prefix;
 
     vector<GameOption*> option_behaviour;
-    map<string, GameOption*> options_by_name;
+    unordered_map<string, GameOption*> options_by_name;
     const vector<GameOption*> build_options_list();
-    map<string, GameOption*> build_options_map(const vector<GameOption*> &opts);
+    unordered_map<string, GameOption*> build_options_map(const vector<GameOption*> &opts);
 };
 
 char32_t get_glyph_override(int c);
@@ -1578,8 +1578,7 @@ static string _get_monster_name(const monster_info& mi, int count, bool fullname
 string mpr_monster_list(bool past)
 {
     // Get monsters via the monster_pane_info, sorted by difficulty.
-    vector<monster_info> mons;
-    get_monster_info(mons);
+    const vector<monster_info> &mons = get_monster_info();
 
     string msg = "";
     if (mons.empty())
@@ -1720,8 +1719,7 @@ int update_monster_pane()
     {
         save_cursor_pos save;
 
-        vector<monster_info> mons;
-        get_monster_info(mons);
+        const vector<monster_info> &mons = get_monster_info();
 
         // Count how many groups of monsters there are.
         unsigned int lines_needed = mons.size();
@@ -59,8 +59,14 @@ static plen_t htole(plen_t x)
 #define dprintf(...) do {} while (0)
 #endif
 
-#define PACKAGE_VERSION 1
+#define PACKAGE_VERSION 2
 #define PACKAGE_MAGIC   0x53534344 /* "DCSS" */
+#define FOOTER_MAGIC    0x46534344 /* "DCSF" */
+
+// Commits start moving chunks into earlier free space once at least this
+// much of the file, and this fraction of it, is unused.
+#define COMPACT_MIN_SLACK  (64 * 1024)
+#define COMPACT_SLACK_FRAC 4
 
 struct file_header
 {
@@ -76,6 +82,24 @@ struct block_header
     plen_t next;
 };
 
+// A cleanly closed save has its block map after the end of the package
+// proper: footer_blocks entries, then a trailer. Versions that don't know
+// about it see only some unused space.
+struct footer_block
+{
+    plen_t start;
+    plen_t len;
+    plen_t next;
+};
+
+struct footer_trailer
+{
+    plen_t dir_start;
+    plen_t blocks;
+    uint32_t crc;
+    uint32_t magic;
+};
+
 typedef map<string, plen_t> directory_t;
 typedef pair<plen_t, plen_t> bm_p;
 typedef map<plen_t, bm_p> bm_t;
@@ -83,9 +107,16 @@ typedef map<plen_t, plen_t> fb_t;
 
 package::package(const char* file, bool writeable, bool empty)
   : n_users(0), dirty(false), aborted(false)
-#ifdef DO_FSYNC
     , tmp(false)
+#ifdef USE_ZSTD
+    , write_codec(CODEC_ZSTD)
+#else
+    , write_codec(CODEC_ZLIB)
 #endif
+#ifdef ASYNC_COMMIT
+    , commit_pending(false), commit_start(0), commit_error(0)
+#endif
+    , chunk_cache_size(0)
 {
     dprintf("package: initializing file=\"%s\" rw=%d\n", file, writeable);
     ASSERT(writeable || !empty);
@@ -133,9 +164,16 @@ package::package(const char* file, bool writeable, bool empty)
 
 package::package()
   : rw(true), n_users(0), dirty(false), aborted(false)
-#ifdef DO_FSYNC
     , tmp(true)
+#ifdef USE_ZSTD
+    , write_codec(CODEC_ZSTD)
+#else
+    , write_codec(CODEC_ZLIB)
+#endif
+#ifdef ASYNC_COMMIT
+    , commit_pending(false), commit_start(0), commit_error(0)
 #endif
+    , chunk_cache_size(0)
 {
     dprintf("package: initializing tmp file\n");
     filename = "[tmp]";
@@ -182,10 +220,143 @@ void package::load()
     file_len = len;
     read_directory(htole(head.start), head.version);
 
-    if (rw)
+    if (rw && !read_footer())
         load_traces();
 }
 
+// Covers the directory as well as the block map, so that a footer left
+// over from an earlier commit can't pass for this one's.
+static uint32_t _footer_crc(const directory_t &directory,
+                            const vector<footer_block> &blocks, plen_t end)
+{
+    uLong crc = crc32(0, Z_NULL, 0);
+    for (const auto &entry : directory)
+    {
+        const plen_t start = htole(entry.second);
+        crc = crc32(crc, (const Bytef*)entry.first.data(), entry.first.size());
+        crc = crc32(crc, (const Bytef*)&start, sizeof(start));
+    }
+    if (!blocks.empty())
+    {
+        crc = crc32(crc, (const Bytef*)&blocks[0],
+                    blocks.size() * sizeof(footer_block));
+    }
+    end = htole(end);
+    return crc32(crc, (const Bytef*)&end, sizeof(end));
+}
+
+// Write the block map after the end of the save, so that the next load
+// needn't trace every chunk to rebuild it. Only for a save just committed
+// and about to be closed; a failure only costs the next load the trace.
+void package::write_footer()
+{
+    vector<footer_block> blocks;
+    blocks.reserve(block_map.size());
+    for (const auto &bl : block_map)
+    {
+        blocks.push_back({ htole(bl.first), htole(bl.second.first),
+                           htole(bl.second.second) });
+    }
+
+    footer_trailer trailer;
+    trailer.dir_start = htole(directory[""]);
+    trailer.blocks = htole((plen_t)blocks.size());
+    trailer.crc = htole32(_footer_crc(directory, blocks, file_len));
+    trailer.magic = htole32(FOOTER_MAGIC);
+
+    const size_t blocks_len = blocks.size() * sizeof(footer_block);
+    seek(file_len);
+    if (blocks_len && write(fd, &blocks[0], blocks_len) != (ssize_t)blocks_len
+        || write(fd, &trailer, sizeof(trailer)) != sizeof(trailer))
+    {
+        // A torn footer wouldn't pass the check anyway, but don't leave
+        // junk around.
+        if (ftruncate(fd, file_len))
+            sysfail("failed to update save file");
+    }
+}
+
+// Take the block map from the footer of a cleanly closed save, instead of
+// tracing every chunk. If there's no footer, or it doesn't match the
+// directory or the file, the caller has to do the full trace after all.
+// The footer is then removed from the file, as the save won't match it
+// once anything is written; if the game crashes, the next load checks
+// everything again.
+bool package::read_footer()
+{
+    ASSERT(block_map.empty());
+    footer_trailer trailer;
+    if (file_len < sizeof(file_header) + sizeof(trailer))
+        return false;
+    seek(file_len - sizeof(trailer));
+    if (::read(fd, &trailer, sizeof(trailer)) != sizeof(trailer)
+        || htole32(trailer.magic) != FOOTER_MAGIC
+        || htole(trailer.dir_start) != directory[""])
+    {
+        return false;
+    }
+
+    const plen_t count = htole(trailer.blocks);
+    const plen_t footer_len = sizeof(trailer) + count * sizeof(footer_block);
+    if (count > file_len / sizeof(footer_block)
+        || footer_len > file_len - sizeof(file_header))
+    {
+        return false;
+    }
+    const plen_t end = file_len - footer_len;
+
+    vector<footer_block> blocks(count);
+    const size_t blocks_len = count * sizeof(footer_block);
+    seek(end);
+    if (count && ::read(fd, &blocks[0], blocks_len) != (ssize_t)blocks_len
+        || htole32(trailer.crc) != _footer_crc(directory, blocks, end))
+    {
+        return false;
+    }
+
+    // The same checks trace_chunk() makes: the blocks may not overlap or
+    // run past the end, and every chain has to lead through known blocks.
+    plen_t pos = sizeof(file_header);
+    for (const footer_block &fb : blocks)
+    {
+        const plen_t start = htole(fb.start);
+        const plen_t len = htole(fb.len);
+        if (start < pos || start >= end || len > end - start
+            || end - start - len < sizeof(block_header))
+        {
+            block_map.clear();
+            free_blocks.clear();
+            return false;
+        }
+        if (start > pos)
+            free_blocks[pos] = start - pos;
+        block_map[start] = bm_p(len, htole(fb.next));
+        pos = start + len + sizeof(block_header);
+    }
+    if (pos < end)
+        free_blocks[pos] = end - pos;
+
+    bool ok = true;
+    for (const auto &bl : block_map)
+        if (bl.second.second && !block_map.count(bl.second.second))
+            ok = false;
+    for (const auto &entry : directory)
+        if (entry.second && !block_map.count(entry.second))
+            ok = false;
+
+    if (!ok || ftruncate(fd, end))
+    {
+        block_map.clear();
+        free_blocks.clear();
+        return false;
+    }
+
+    file_len = end;
+    index_free_blocks();
+    dprintf("package: %u blocks from the footer\n", (unsigned int)count);
+    return true;
+}
+
 void package::load_traces()
 {
     ASSERT(!dirty);
@@ -197,6 +368,7 @@ void package::load_traces()
 
     for (const auto &entry : directory)
         trace_chunk(entry.second);
+    index_free_blocks();
 
 #ifdef COSTLY_ASSERTS
     // any inconsitency in the save is guaranteed to be already found
@@ -219,7 +391,11 @@ package::~package()
         commit();
         if (ftruncate(fd, file_len))
             sysfail("failed to update save file");
+        if (!tmp)
+            write_footer();
     }
+    else
+        finish_commit();
 
     // all errors here should be cached write errors
     if (fd != -1)
@@ -231,22 +407,69 @@ package::~package()
     dprintf("package: closed\n");
 }
 
-void package::commit()
+// Make everything written so far the new committed state of the save.
+// With async, the flushes and the header update may be left to a
+// background thread; the game can keep writing new chunks meanwhile, as
+// they only ever go into space neither the old nor the new directory
+// uses. The next commit (or closing the package) waits for it to finish.
+// Either way, a crash leaves the save at the old or the new commit.
+void package::commit(bool async)
 {
     ASSERT(rw);
+    finish_commit();
     if (!dirty)
         return;
     ASSERT(!aborted);
 
+    compact();
+
 #ifdef COSTLY_ASSERTS
     fsck();
 #endif
 
+    const plen_t start = write_directory();
+    new_chunks.clear();
+    dirty = false;
+
+#ifdef ASYNC_COMMIT
+    if (async && !tmp)
+    {
+        // Blocks unlinked from now on are still used by the commit being
+        // written, so only these can be reclaimed when it is done.
+        committing_blocks.swap(unlinked_blocks);
+        commit_start = start;
+        commit_error = 0;
+        if (!thread_create_joinable(&commit_thread, commit_thread_main, this))
+        {
+            commit_pending = true;
+            return;
+        }
+        // No thread, do it the slow way.
+        unlinked_blocks.insert(unlinked_blocks.end(),
+                               committing_blocks.begin(),
+                               committing_blocks.end());
+        committing_blocks.clear();
+    }
+#else
+    UNUSED(async);
+#endif
+
+    write_header(start);
+    collect_blocks();
+
+#ifdef COSTLY_ASSERTS
+    fsck();
+#endif
+}
+
+// Point the file header at the directory chunk at start.
+void package::write_header(plen_t start)
+{
     file_header head;
     head.magic = htole(PACKAGE_MAGIC);
     head.version = PACKAGE_VERSION;
     memset(&head.padding, 0, sizeof(head.padding));
-    head.start = htole(write_directory());
+    head.start = htole(start);
 #ifdef DO_FSYNC
     // We need a barrier before updating the link to point at the new directory.
     if (!tmp && fdatasync(fd))
@@ -259,13 +482,50 @@ void package::commit()
     if (!tmp && fdatasync(fd))
         sysfail("flush error while saving");
 #endif
+}
 
-    new_chunks.clear();
-    collect_blocks();
-    dirty = false;
+#ifdef ASYNC_COMMIT
+// The background half of an async commit. It only touches the file, never
+// the block maps, and writes the header with pwrite so that the game's
+// own seeks and writes on the same descriptor are not disturbed.
+void *package::commit_thread_main(void *arg)
+{
+    package *pkg = static_cast<package*>(arg);
 
-#ifdef COSTLY_ASSERTS
-    fsck();
+    file_header head;
+    head.magic = htole(PACKAGE_MAGIC);
+    head.version = PACKAGE_VERSION;
+    memset(&head.padding, 0, sizeof(head.padding));
+    head.start = htole(pkg->commit_start);
+
+    if (fdatasync(pkg->fd)
+        || pwrite(pkg->fd, &head, sizeof(head), 0) != sizeof(head)
+        || fdatasync(pkg->fd))
+    {
+        pkg->commit_error = errno ? errno : EIO;
+    }
+    return nullptr;
+}
+#endif
+
+// Wait for a pending async commit, if any, and reclaim what it freed.
+void package::finish_commit()
+{
+#ifdef ASYNC_COMMIT
+    if (!commit_pending)
+        return;
+
+    thread_join(commit_thread);
+    commit_pending = false;
+    if (commit_error && !aborted)
+    {
+        errno = commit_error;
+        sysfail("flush error while saving");
+    }
+
+    for (plen_t at : committing_blocks)
+        free_block_chain(at);
+    committing_blocks.clear();
 #endif
 }
 
@@ -312,33 +572,28 @@ plen_t package::extend_block(plen_t at, plen_t size, plen_t by)
     {
         // we consume the entire block
         by = free;
-        free_blocks.erase(bl);
+        remove_free(bl);
         return by;
     }
 
-    free_blocks.erase(bl);
-    free_blocks[at + size + by] = free - by;
+    remove_free(bl);
+    add_free(at + size + by, free - by);
 
     return by;
 }
 
 plen_t package::alloc_block(plen_t &size)
 {
-    fb_t::iterator bl, best_big, best_small;
-    plen_t bb_size = (plen_t)-1, bs_size = 0;
-    for (bl = free_blocks.begin(); bl!=free_blocks.end(); ++bl)
+    // The smallest free block the whole write fits in; failing that, the
+    // biggest one, as long as it isn't tiny. The lowest of several of the
+    // same size.
+    auto fit = free_sizes.lower_bound(bm_p(size + sizeof(block_header), 0));
+    if (fit == free_sizes.end() && !free_sizes.empty()
+        && free_sizes.rbegin()->first >= 16)
     {
-        if (bl->second < bb_size && bl->second >= size + sizeof(block_header))
-            best_big = bl, bb_size = bl->second;
-        // don't reuse very small blocks unless they're big enough
-        else if (bl->second >= 16 && bl->second > bs_size)
-            best_small = bl, bs_size = bl->second;
+        fit = free_sizes.lower_bound(bm_p(free_sizes.rbegin()->first, 0));
     }
-    if (bb_size != (plen_t)-1)
-        bl = best_big;
-    else if (bs_size != 0)
-        bl = best_small;
-    else
+    if (fit == free_sizes.end())
     {
         plen_t at = file_len;
 
@@ -346,23 +601,45 @@ plen_t package::alloc_block(plen_t &size)
         return at;
     }
 
-    plen_t at = bl->first;
-    plen_t free = bl->second;
+    plen_t at = fit->second;
+    plen_t free = fit->first;
     dprintf("found a block for reuse at %u size %u\n", at, free);
-    free_blocks.erase(bl);
+    remove_free(free_blocks.find(at));
     free -= sizeof(block_header);
     if (size > free)
         size = free;
     if ((free -= size))
-        free_blocks[at + sizeof(block_header) + size] = free;
+        add_free(at + sizeof(block_header) + size, free);
 
     return at;
 }
 
-void package::finish_chunk(const string &name, plen_t at)
+void package::add_free(plen_t at, plen_t size)
+{
+    free_blocks[at] = size;
+    free_sizes.insert(bm_p(size, at));
+}
+
+void package::remove_free(map<plen_t, plen_t>::iterator bl)
+{
+    free_sizes.erase(bm_p(bl->second, bl->first));
+    free_blocks.erase(bl);
+}
+
+// Loading fills in free_blocks directly; this catches free_sizes up.
+void package::index_free_blocks()
+{
+    free_sizes.clear();
+    for (const auto &bl : free_blocks)
+        free_sizes.insert(bm_p(bl.second, bl.first));
+}
+
+void package::finish_chunk(const string &name, plen_t at, chunk_codec codec)
 {
     free_chunk(name);
     directory[name] = at;
+    if (codec != CODEC_ZLIB)
+        codecs[at] = codec;
     new_chunks.insert(at);
     dirty = true;
 }
@@ -382,6 +659,128 @@ void package::free_chunk(const string &name)
     dirty = true;
 }
 
+// Once enough of the file is unused, rewrite the chunks after the first
+// free space contiguously, each as a single block, so that the end of the
+// file can be given back and reading a chunk needs only one seek. The
+// compressed data is copied as it is.
+//
+// Old copies can't be overwritten before a commit has made the new ones
+// the real thing, so the chunks are first copied to the end of the file,
+// and then, after a commit of their own, back down into the space they
+// left. Chunks that are being read stay where they are.
+void package::compact()
+{
+    plen_t slack = 0;
+    for (const auto &bl : free_blocks)
+        slack += bl.second;
+    if (slack < COMPACT_MIN_SLACK || slack < file_len / COMPACT_SLACK_FRAC)
+        return;
+
+    dprintf("compacting: %u of %u unused\n", slack, file_len);
+    for (const auto &ch : movable_chunks())
+        if (ch.first > free_blocks.begin()->first)
+            move_chunk(ch.second, file_len, chain_length(ch.first));
+
+    write_header(write_directory());
+    new_chunks.clear();
+    collect_blocks();
+
+    // From the front, so that each chunk follows the one before.
+    for (const auto &ch : movable_chunks())
+    {
+        const plen_t len = chain_length(ch.first);
+        auto hole = free_blocks.begin();
+        while (hole != free_blocks.end() && hole->first < ch.first
+               && hole->second < len + sizeof(block_header))
+        {
+            ++hole;
+        }
+        if (hole != free_blocks.end() && hole->first < ch.first)
+            move_chunk(ch.second, hole->first, len);
+    }
+}
+
+// The chunks that compact() may move, by their position in the file.
+vector<pair<plen_t, string> > package::movable_chunks()
+{
+    vector<pair<plen_t, string> > chunks;
+    for (const auto &entry : directory)
+        if (!entry.first.empty() && !reader_count.count(entry.second))
+            chunks.emplace_back(entry.second, entry.first);
+    sort(chunks.begin(), chunks.end());
+    return chunks;
+}
+
+// The length of the data in the block chain starting at at.
+plen_t package::chain_length(plen_t at)
+{
+    plen_t len = 0;
+    while (at)
+    {
+        auto bl = block_map.find(at);
+        ASSERT(bl != block_map.end());
+        len += bl->second.first;
+        at = bl->second.second;
+    }
+    return len;
+}
+
+// Copy a chunk's len bytes of data into a single block, at the start of
+// the free block at to, or at the end of the file.
+void package::move_chunk(const string &name, plen_t to, plen_t len)
+{
+    const plen_t from = directory[name];
+    dprintf("moving chunk(%s) from %u to %u\n", name.c_str(), from, to);
+
+    vector<char> data(len);
+    plen_t got = 0;
+    for (plen_t at = from; at; )
+    {
+        const bm_p &bl = block_map[at];
+        seek(at + sizeof(block_header));
+        if (::read(fd, &data[got], bl.first) != (ssize_t)bl.first)
+            sysfail("error reading the save file");
+        got += bl.first;
+        at = bl.second;
+    }
+
+    const plen_t size = len + sizeof(block_header);
+    if (to == file_len)
+        file_len += size;
+    else
+    {
+        auto hole = free_blocks.find(to);
+        ASSERT(hole != free_blocks.end());
+        const plen_t hole_size = hole->second;
+        ASSERT(hole_size >= size);
+        remove_free(hole);
+        if (hole_size > size)
+            add_free(to + size, hole_size - size);
+    }
+
+    block_header head;
+    head.len = htole(len);
+    head.next = 0;
+    seek(to);
+    if (::write(fd, &head, sizeof(head)) != sizeof(head)
+        || ::write(fd, &data[0], len) != (ssize_t)len)
+    {
+        sysfail("write error while saving");
+    }
+    block_map[to] = bm_p(len, 0);
+
+    const chunk_codec *codec = map_find(codecs, from);
+    if (codec)
+        codecs[to] = *codec;
+    for (cached_chunk &entry : chunk_cache)
+        if (entry.start == from)
+            entry.start = to;
+
+    free_chunk(name);
+    directory[name] = to;
+    new_chunks.insert(to);
+}
+
 void package::delete_chunk(const string &name)
 {
     free_chunk(name);
@@ -400,6 +799,9 @@ plen_t package::write_directory()
         dir.write(&entry.first[0], entry.first.length());
         plen_t start = htole(entry.second);
         dir.write((const char*)&start, sizeof(plen_t));
+        const chunk_codec *codec = map_find(codecs, entry.second);
+        uint8_t c = codec ? *codec : CODEC_ZLIB;
+        dir.write((const char*)&c, sizeof(c));
     }
 
     ASSERT(dir.str().size());
@@ -427,6 +829,9 @@ void package::collect_blocks()
 
 void package::free_block_chain(plen_t at)
 {
+    // Nobody can open this chunk anymore, and its blocks may be reused.
+    cache_forget(at);
+
     if (reader_count.count(at))
     {
         dprintf("deleting an in-use chain at %d\n", at);
@@ -435,6 +840,7 @@ void package::free_block_chain(plen_t at)
     }
 
     dprintf("freeing an unlinked chain at %d\n", at);
+    codecs.erase(at);
     while (at)
     {
         auto bl = block_map.find(at);
@@ -461,7 +867,7 @@ void package::free_block(plen_t at, plen_t size)
             // combine with the left neighbour
             at = neigh->first;
             size += neigh->second;
-            free_blocks.erase(neigh);
+            remove_free(neigh);
         }
     }
 
@@ -473,19 +879,20 @@ void package::free_block(plen_t at, plen_t size)
         {
             // combine with the right neighbour
             size += neigh->second;
-            free_blocks.erase(neigh);
+            remove_free(neigh);
         }
     }
 
     if (at + size == file_len)
         file_len -= size;
     else
-        free_blocks[at] = size;
+        add_free(at, size);
 }
 
 void package::fsck()
 {
     fb_t  save_free_blocks = free_blocks;
+    set<bm_p> save_free_sizes = free_sizes;
     plen_t save_file_len = file_len;
 
 #ifdef FSCK_VERBOSE
@@ -505,9 +912,11 @@ void package::fsck()
     }
     // after freeing everything, the file should be empty
     ASSERT(free_blocks.empty());
+    ASSERT(free_sizes.empty());
     ASSERT(file_len == sizeof(file_header));
 
     free_blocks = save_free_blocks;
+    free_sizes = save_free_sizes;
     file_len = save_file_len;
 }
 
@@ -540,6 +949,7 @@ void package::read_directory(plen_t start, uint8_t version)
         }
         break;
     case 1:
+    case 2:
         uint8_t name_len;
         plen_t bstart;
         while (plen_t res = rd.read(&name_len, sizeof(name_len)))
@@ -553,6 +963,25 @@ void package::read_directory(plen_t start, uint8_t version)
             if (rd.read(&bstart, sizeof(bstart)) != sizeof(bstart))
                 corrupted("save file corrupted -- truncated directory");
             directory[chname] = htole(bstart);
+            if (version >= 2)
+            {
+                uint8_t codec;
+                if (rd.read(&codec, sizeof(codec)) != sizeof(codec))
+                    corrupted("save file corrupted -- truncated directory");
+                switch (codec)
+                {
+                case CODEC_ZLIB:
+                    break;
+#ifdef USE_ZSTD
+                case CODEC_ZSTD:
+                    codecs[htole(bstart)] = (chunk_codec)codec;
+                    break;
+#endif
+                default:
+                    corrupted("save file (%s) uses an unsupported compression"
+                              " method %u", filename.c_str(), codec);
+                }
+            }
             dprintf("* %s\n", chname.c_str());
         }
         break;
@@ -567,6 +996,21 @@ bool package::has_chunk(const string &name)
     return !name.empty() && directory.count(name);
 }
 
+/**
+ * Whether the chunk is known to consist of exactly these bytes, so that
+ * writing them again can be skipped. Only chunks still in the cache can be
+ * compared; for anything else, this says no.
+ */
+bool package::chunk_holds(const string &name, const void *data, plen_t len)
+{
+    const plen_t *start = map_find(directory, name);
+    if (!start)
+        return false;
+    chunk_data contents = cache_find(*start);
+    return contents && contents->size() == len
+           && (!len || !memcmp(contents->data(), data, len));
+}
+
 vector<string> package::list_chunks()
 {
     vector<string> list;
@@ -614,6 +1058,54 @@ void package::trace_chunk(plen_t start)
     }
 }
 
+chunk_data package::cache_find(plen_t start)
+{
+    for (unsigned int i = 0; i < chunk_cache.size(); ++i)
+        if (chunk_cache[i].start == start)
+        {
+            if (i)
+            {
+                cached_chunk hit = chunk_cache[i];
+                chunk_cache.erase(chunk_cache.begin() + i);
+                chunk_cache.insert(chunk_cache.begin(), hit);
+            }
+            return chunk_cache[0].data;
+        }
+    return chunk_data();
+}
+
+void package::cache_insert(plen_t start, vector<char> &data)
+{
+    if (!rw || aborted || data.size() > PACKAGE_CACHE_SIZE / 4)
+        return;
+
+    cache_forget(start);
+    cached_chunk entry;
+    entry.start = start;
+    auto contents = std::make_shared<vector<char> >();
+    contents->swap(data);
+    entry.data = contents;
+    chunk_cache_size += entry.data->size();
+    chunk_cache.insert(chunk_cache.begin(), entry);
+
+    while (chunk_cache_size > PACKAGE_CACHE_SIZE)
+    {
+        chunk_cache_size -= chunk_cache.back().data->size();
+        chunk_cache.pop_back();
+    }
+}
+
+void package::cache_forget(plen_t start)
+{
+    for (unsigned int i = 0; i < chunk_cache.size(); ++i)
+        if (chunk_cache[i].start == start)
+        {
+            chunk_cache_size -= chunk_cache[i].data->size();
+            chunk_cache.erase(chunk_cache.begin() + i);
+            return;
+        }
+}
+
 void package::abort()
 {
     // Disable any further operations, allow a shutdown. All errors past
@@ -625,6 +1117,7 @@ void package::abort()
 void package::unlink()
 {
     abort();
+    finish_commit();
     close(fd);
     fd = -1;
     ::unlink_u(filename.c_str());
@@ -661,20 +1154,11 @@ plen_t package::get_chunk_compressed_length(const string &name)
 {
     load_traces();
     ASSERT(directory.count(name)); // not has_chunk(), "" is valid
-    plen_t len = 0;
-    plen_t at = directory[name];
-    while (at)
-    {
-        auto bl = block_map.find(at);
-        ASSERT(bl != block_map.end());
-        len += bl->second.first;
-        at = bl->second.second;
-    }
-    return len;
+    return chain_length(directory[name]);
 }
 
 chunk_writer::chunk_writer(package *parent, const string &_name)
-    : first_block(0), cur_block(0), block_len(0)
+    : first_block(0), cur_block(0), block_len(0), cache_plain(parent->rw)
 {
     ASSERT(parent);
     ASSERT(!parent->aborted);
@@ -688,17 +1172,42 @@ chunk_writer::chunk_writer(package *parent, const string &_name)
     pkg->n_users++;
     name = _name;
 
-#ifdef USE_ZLIB
-    zs.data_type = Z_BINARY;
-    zs.zalloc    = 0;
-    zs.zfree     = 0;
-    zs.opaque    = Z_NULL;
-    if (deflateInit(&zs, Z_DEFAULT_COMPRESSION))
-        fail("save file compression failed during init: %s", zs.msg);
+    // The directory is read before we know any codecs, so it stays zlib.
+    codec = name.empty() ? CODEC_ZLIB : pkg->write_codec;
 #define ZB_SIZE 32768
-    zs.next_out  = z_buffer = (Bytef*)malloc(ZB_SIZE);
-    zs.avail_out = ZB_SIZE;
+    z_buffer = (Bytef*)malloc(ZB_SIZE);
+
+    switch (codec)
+    {
+    case CODEC_ZLIB:
+        zs.data_type = Z_BINARY;
+        zs.zalloc    = 0;
+        zs.zfree     = 0;
+        zs.opaque    = Z_NULL;
+        // Nobody will ever load a temporary package, favour speed there.
+        if (deflateInit(&zs, pkg->tmp ? Z_BEST_SPEED : Z_DEFAULT_COMPRESSION))
+            fail("save file compression failed during init: %s", zs.msg);
+        zs.next_out  = z_buffer;
+        zs.avail_out = ZB_SIZE;
+        break;
+#ifdef USE_ZSTD
+    case CODEC_ZSTD:
+    {
+        zcs = ZSTD_createCStream();
+        if (!zcs)
+            fail("save file compression failed during init");
+        size_t res = ZSTD_initCStream(zcs, pkg->tmp ? 1 : ZSTD_CLEVEL_DEFAULT);
+        if (ZSTD_isError(res))
+        {
+            fail("save file compression failed during init: %s",
+                 ZSTD_getErrorName(res));
+        }
+        break;
+    }
 #endif
+    default:
+        die("unknown chunk codec %d", codec);
+    }
 }
 
 chunk_writer::~chunk_writer()
@@ -709,33 +1218,59 @@ chunk_writer::~chunk_writer()
     pkg->n_users--;
     if (pkg->aborted)
     {
-#ifdef USE_ZLIB
         // ignore errors, they're not relevant anymore
-        deflateEnd(&zs);
-        free(z_buffer);
+        if (codec == CODEC_ZLIB)
+            deflateEnd(&zs);
+#ifdef USE_ZSTD
+        else if (codec == CODEC_ZSTD)
+            ZSTD_freeCStream(zcs);
 #endif
+        free(z_buffer);
         return;
     }
 
-#ifdef USE_ZLIB
-    zs.avail_in = 0;
-    int res;
-    do
+    flush_pending();
+    if (codec == CODEC_ZLIB)
     {
-        res = deflate(&zs, Z_FINISH);
-        if (res != Z_STREAM_END && res != Z_OK && res != Z_BUF_ERROR)
-            fail("save file compression failed: %s", zs.msg);
-        raw_write(z_buffer, zs.next_out - z_buffer);
-        zs.next_out = z_buffer;
-        zs.avail_out = ZB_SIZE;
-    } while (res != Z_STREAM_END);
-    if (deflateEnd(&zs) != Z_OK)
-        fail("save file compression failed during clean-up: %s", zs.msg);
-    free(z_buffer);
+        zs.avail_in = 0;
+        int res;
+        do
+        {
+            res = deflate(&zs, Z_FINISH);
+            if (res != Z_STREAM_END && res != Z_OK && res != Z_BUF_ERROR)
+                fail("save file compression failed: %s", zs.msg);
+            raw_write(z_buffer, zs.next_out - z_buffer);
+            zs.next_out = z_buffer;
+            zs.avail_out = ZB_SIZE;
+        } while (res != Z_STREAM_END);
+        if (deflateEnd(&zs) != Z_OK)
+            fail("save file compression failed during clean-up: %s", zs.msg);
+    }
+#ifdef USE_ZSTD
+    else if (codec == CODEC_ZSTD)
+    {
+        size_t left;
+        do
+        {
+            ZSTD_outBuffer out = { z_buffer, ZB_SIZE, 0 };
+            left = ZSTD_endStream(zcs, &out);
+            if (ZSTD_isError(left))
+            {
+                fail("save file compression failed: %s",
+                     ZSTD_getErrorName(left));
+            }
+            raw_write(z_buffer, out.pos);
+        } while (left);
+        ZSTD_freeCStream(zcs);
+    }
 #endif
+    free(z_buffer);
+
     if (cur_block)
         finish_block(0);
-    pkg->finish_chunk(name, first_block);
+    pkg->finish_chunk(name, first_block, codec);
+    if (cache_plain)
+        pkg->cache_insert(first_block, plain);
 }
 
 void chunk_writer::raw_write(const void *data, plen_t len)
@@ -777,12 +1312,64 @@ void chunk_writer::finish_block(plen_t next)
     pkg->block_map[cur_block] = bm_p(block_len, next);
 }
 
+// Writes smaller than this are gathered up before compressing.
+#define WB_SIZE 65536
+
 void chunk_writer::write(const void *data, plen_t len)
 {
     ASSERT(data);
     ASSERT(!pkg->aborted);
 
-#ifdef USE_ZLIB
+    if (pending.size() + len > WB_SIZE)
+        flush_pending();
+    if (len < WB_SIZE)
+    {
+        if (pending.empty())
+            pending.reserve(WB_SIZE);
+        pending.insert(pending.end(), (const char*)data,
+                       (const char*)data + len);
+    }
+    else
+        compress(data, len);
+}
+
+void chunk_writer::flush_pending()
+{
+    if (pending.empty())
+        return;
+    compress(pending.data(), pending.size());
+    pending.clear();
+}
+
+void chunk_writer::compress(const void *data, plen_t len)
+{
+    if (cache_plain)
+    {
+        if (plain.size() + len > PACKAGE_CACHE_SIZE / 4)
+        {
+            cache_plain = false;
+            vector<char>().swap(plain);
+        }
+        else
+            plain.insert(plain.end(), (const char*)data, (const char*)data + len);
+    }
+
+#ifdef USE_ZSTD
+    if (codec == CODEC_ZSTD)
+    {
+        ZSTD_inBuffer in = { data, len, 0 };
+        while (in.pos < in.size)
+        {
+            ZSTD_outBuffer out = { z_buffer, ZB_SIZE, 0 };
+            size_t res = ZSTD_compressStream(zcs, &out, &in);
+            if (ZSTD_isError(res))
+                fail("save file compression failed: %s", ZSTD_getErrorName(res));
+            raw_write(z_buffer, out.pos);
+        }
+        return;
+    }
+#endif
+
     zs.next_in  = (Bytef*)data;
     zs.avail_in = len;
     while (zs.avail_in)
@@ -797,9 +1384,6 @@ void chunk_writer::write(const void *data, plen_t len)
         if (deflate(&zs, Z_NO_FLUSH) != Z_OK)
             fail("save file compression failed: %s", zs.msg);
     }
-#else
-    raw_write(data, len);
-#endif
 }
 
 void chunk_reader::init(plen_t start)
@@ -809,10 +1393,34 @@ void chunk_reader::init(plen_t start)
     pkg->reader_count[start]++;
     first_block = next_block = start;
     block_left = 0;
+    cached = pkg->cache_find(start);
+    cached_pos = 0;
+    cache_plain = pkg->rw && !cached;
+    if (cached)
+        return;
 
-#ifdef USE_ZLIB
     if (!start)
-        corrupted("save file corrupted -- zlib header missing");
+        corrupted("save file corrupted -- compression header missing");
+
+    const chunk_codec *c = map_find(pkg->codecs, start);
+    codec = c ? *c : CODEC_ZLIB;
+    eof = false;
+#ifdef USE_ZSTD
+    if (codec == CODEC_ZSTD)
+    {
+        zds = ZSTD_createDStream();
+        if (!zds)
+            fail("save file decompression failed during init");
+        size_t res = ZSTD_initDStream(zds);
+        if (ZSTD_isError(res))
+        {
+            fail("save file decompression failed during init: %s",
+                 ZSTD_getErrorName(res));
+        }
+        z_pos = z_len = 0;
+        return;
+    }
+#endif
 
     zs.zalloc    = 0;
     zs.zfree     = 0;
@@ -821,8 +1429,6 @@ void chunk_reader::init(plen_t start)
     zs.avail_in  = 0;
     if (inflateInit(&zs))
         fail("save file decompression failed during init: %s", zs.msg);
-    eof = false;
-#endif
 }
 
 chunk_reader::chunk_reader(package *parent, plen_t start)
@@ -847,10 +1453,13 @@ chunk_reader::~chunk_reader()
 {
     dprintf("chunk_reader: closing\n");
 
-#ifdef USE_ZLIB
-    if (inflateEnd(&zs) != Z_OK)
-        fail("save file decompression failed during clean-up: %s", zs.msg);
+#ifdef USE_ZSTD
+    if (!cached && codec == CODEC_ZSTD)
+        ZSTD_freeDStream(zds);
+    else
 #endif
+    if (!cached && inflateEnd(&zs) != Z_OK)
+        fail("save file decompression failed during clean-up: %s", zs.msg);
     ASSERT(pkg->reader_count[first_block] > 0);
     if (!--pkg->reader_count[first_block])
         pkg->reader_count.erase(first_block);
@@ -910,12 +1519,55 @@ plen_t chunk_reader::read(void *data, plen_t len)
     if (pkg->aborted)
         return 0;
 
-#ifdef USE_ZLIB
+    if (cached)
+    {
+        const plen_t s = min<size_t>(len, cached->size() - cached_pos);
+        if (s)
+            memcpy(data, &(*cached)[cached_pos], s);
+        cached_pos += s;
+        return s;
+    }
+
     if (!len)
         return 0;
     if (eof)
         return 0;
 
+#ifdef USE_ZSTD
+    if (codec == CODEC_ZSTD)
+    {
+        ZSTD_outBuffer out = { data, len, 0 };
+        while (out.pos < out.size)
+        {
+            if (z_pos == z_len)
+            {
+                z_pos = 0;
+                z_len = raw_read(z_buffer, sizeof(z_buffer));
+                if (!z_len)
+                    corrupted("save file corrupted -- block truncated");
+            }
+            ZSTD_inBuffer in = { z_buffer, z_len, z_pos };
+            size_t res = ZSTD_decompressStream(zds, &out, &in);
+            z_pos = in.pos;
+            if (ZSTD_isError(res))
+            {
+                corrupted("save file decompression failed: %s",
+                          ZSTD_getErrorName(res));
+            }
+            if (!res)
+            {
+                // end of frame
+                eof = true;
+                keep_plain(data, out.pos);
+                finish_plain();
+                return out.pos;
+            }
+        }
+        keep_plain(data, len);
+        return len;
+    }
+#endif
+
     zs.next_out  = (Bytef*)data;
     zs.avail_out = len;
     while (zs.avail_out)
@@ -931,15 +1583,37 @@ plen_t chunk_reader::read(void *data, plen_t len)
         if (res == Z_STREAM_END)
         {
             eof = true;
+            keep_plain(data, zs.next_out - (Bytef*)data);
+            finish_plain();
             return zs.next_out - (Bytef*)data;
         }
         if (res != Z_OK)
             corrupted("save file decompression failed: %s", zs.msg);
     }
+    keep_plain(data, len);
     return zs.next_out - (Bytef*)data;
-#else
-    return raw_read(data, len);
-#endif
+}
+
+void chunk_reader::keep_plain(const void *data, plen_t len)
+{
+    if (!cache_plain)
+        return;
+
+    if (plain.size() + len > PACKAGE_CACHE_SIZE / 4)
+    {
+        cache_plain = false;
+        vector<char>().swap(plain);
+    }
+    else
+        plain.insert(plain.end(), (const char*)data, (const char*)data + len);
+}
+
+// The whole chunk has been read; hand it over to the cache.
+void chunk_reader::finish_plain()
+{
+    if (cache_plain)
+        pkg->cache_insert(first_block, plain);
+    cache_plain = false;
 }
 
 void chunk_reader::read_all(vector<char> &data)
@@ -1,13 +1,13 @@
 #pragma once
 
-#define USE_ZLIB
-
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
-#ifdef USE_ZLIB
 #include <zlib.h>
+#ifdef USE_ZSTD
+#include <zstd.h>
 #endif
 
 using std::map;
@@ -20,10 +20,35 @@ using std::vector;
 #define DO_FSYNC
 #endif
 
+// With DO_FSYNC, a commit can hand its flushes and the header update to a
+// background thread; see package::commit().
+#if defined(DO_FSYNC) && !defined(TARGET_OS_WINDOWS)
+#define ASYNC_COMMIT
+#include "threads.h"
+#endif
+
 #define MAX_CHUNK_NAME_LENGTH 255
 
+// Total size of the inflated chunks a writeable package keeps in memory,
+// so that reading back a chunk touched earlier in the session (a level
+// left a few turns ago) needs neither disk reads nor decompression.
+#ifndef PACKAGE_CACHE_SIZE
+#define PACKAGE_CACHE_SIZE (4 * 1024 * 1024)
+#endif
+
 typedef uint32_t plen_t;
 
+// How a chunk is compressed; stored in the directory next to the chunk.
+// Saves from before there was a choice use zlib throughout.
+enum chunk_codec : uint8_t
+{
+    CODEC_ZLIB = 0,
+    CODEC_ZSTD = 1,
+};
+
+// The inflated contents of a chunk, shared by the cache and its readers.
+typedef std::shared_ptr<const vector<char> > chunk_data;
+
 class package;
 
 class chunk_writer
@@ -34,10 +59,19 @@ private:
     plen_t first_block;
     plen_t cur_block;
     plen_t block_len;
-#ifdef USE_ZLIB
+    chunk_codec codec;
     z_stream zs;
-    Bytef *z_buffer;
+#ifdef USE_ZSTD
+    ZSTD_CStream *zcs;
 #endif
+    Bytef *z_buffer;
+    // Uncompressed contents written so far, to seed the package's cache.
+    vector<char> plain;
+    bool cache_plain;
+    // Small writes not yet compressed; saves write a byte at a time.
+    vector<char> pending;
+    void compress(const void *data, plen_t len);
+    void flush_pending();
     void raw_write(const void *data, plen_t len);
     void finish_block(plen_t next);
 public:
@@ -55,12 +89,26 @@ private:
     package *pkg;
     plen_t first_block, next_block;
     plen_t off, block_left;
-#ifdef USE_ZLIB
+    chunk_codec codec;
     bool eof;
     z_stream zs;
-    Bytef z_buffer[32768];
+#ifdef USE_ZSTD
+    ZSTD_DStream *zds;
+    // The part of z_buffer not yet consumed by zds.
+    size_t z_pos, z_len;
 #endif
+    Bytef z_buffer[32768];
+    // Set if the chunk was found in the package's cache; read() then
+    // serves it from memory.
+    chunk_data cached;
+    size_t cached_pos;
+    // Otherwise, what has been inflated so far, for adding to the cache
+    // once the whole chunk has been read.
+    vector<char> plain;
+    bool cache_plain;
     plen_t raw_read(void *data, plen_t len);
+    void keep_plain(const void *data, plen_t len);
+    void finish_plain();
 public:
     chunk_reader(package *parent, const string &_name);
     ~chunk_reader();
@@ -77,9 +125,10 @@ public:
     ~package();
     chunk_writer* writer(const string &name);
     chunk_reader* reader(const string &name);
-    void commit();
+    void commit(bool async = false);
     void delete_chunk(const string &name);
     bool has_chunk(const string &name);
+    bool chunk_holds(const string &name, const void *data, plen_t len);
     vector<string> list_chunks();
     void abort();
     void unlink();
@@ -98,18 +147,54 @@ private:
     int n_users;
     bool dirty;
     bool aborted;
-#ifdef DO_FSYNC
     bool tmp;
+    // The codec new chunks are written with.
+    chunk_codec write_codec;
+#ifdef ASYNC_COMMIT
+    // A commit whose flushes and header write are still in progress.
+    bool commit_pending;
+    thread_t commit_thread;
+    plen_t commit_start;
+    int commit_error;
+    // Chains unlinked before that commit, to be freed once it is on disk.
+    vector<plen_t> committing_blocks;
+    static void *commit_thread_main(void *pkg);
 #endif
+    void write_header(plen_t start);
+    void write_footer();
+    bool read_footer();
+    void finish_commit();
     map<string, plen_t> directory;
+    // Codecs of the chunks, by their first block. Absent means zlib.
+    map<plen_t, chunk_codec> codecs;
     map<plen_t, plen_t> free_blocks;
+    // The same free blocks as (size, start), for finding one that fits.
+    set<pair<plen_t, plen_t> > free_sizes;
     vector<plen_t> unlinked_blocks;
     map<plen_t, pair<plen_t, plen_t> > block_map;
     set<plen_t> new_chunks;
     map<plen_t, uint32_t> reader_count;
+    struct cached_chunk
+    {
+        plen_t start;
+        chunk_data data;
+    };
+    // Most recently used first.
+    vector<cached_chunk> chunk_cache;
+    size_t chunk_cache_size;
+    chunk_data cache_find(plen_t start);
+    void cache_insert(plen_t start, vector<char> &data);
+    void cache_forget(plen_t start);
     plen_t extend_block(plen_t at, plen_t size, plen_t by);
     plen_t alloc_block(plen_t &size);
-    void finish_chunk(const string &name, plen_t at);
+    void add_free(plen_t at, plen_t size);
+    void remove_free(map<plen_t, plen_t>::iterator bl);
+    void index_free_blocks();
+    void compact();
+    vector<pair<plen_t, string> > movable_chunks();
+    plen_t chain_length(plen_t at);
+    void move_chunk(const string &name, plen_t to, plen_t len);
+    void finish_chunk(const string &name, plen_t at, chunk_codec codec);
     void free_chunk(const string &name);
     plen_t write_directory();
     void collect_blocks();
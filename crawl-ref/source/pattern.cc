@@ -14,6 +14,7 @@
 #endif
 
 #include "pattern.h"
+#include "libutil.h"
 #include "stringutil.h"
 
 #if defined(REGEX_PCRE)
@@ -62,6 +63,12 @@ static pattern_match _pattern_match_location(void *compiled_pattern,
         return pattern_match::failed(string(text));
 }
 
+// Wrap a pattern to be one of several alternatives.
+static string _alternative(const string &pattern)
+{
+    return "(?:" + pattern + ")";
+}
+
 ////////////////////////////////////////////////////////////////////
 #else
 ////////////////////////////////////////////////////////////////////
@@ -115,6 +122,12 @@ static pattern_match _pattern_match_location(void *compiled_pattern,
         return pattern_match::failed(string(text));
 }
 
+// Wrap a pattern to be one of several alternatives.
+static string _alternative(const string &pattern)
+{
+    return "(" + pattern + ")";
+}
+
 ////////////////////////////////////////////////////////////////////
 #endif
 
@@ -229,3 +242,85 @@ pattern_match plaintext_pattern::match_location(const string &s) const
     else
         return pattern_match::failed(s);
 }
+
+void pattern_set::clear()
+{
+    patterns.clear();
+    combined.clear();
+    singles.clear();
+    dirty = false;
+}
+
+void pattern_set::add(const text_pattern &pat)
+{
+    patterns.push_back(pat);
+    dirty = true;
+}
+
+// Would joining this pattern with others change what it means?
+static bool _has_backreference(const string &pattern)
+{
+    for (size_t i = 0; i + 1 < pattern.size(); ++i)
+        if (pattern[i] == '\\')
+        {
+            if (isadigit(pattern[i + 1]))
+                return true;
+            ++i;
+        }
+    return false;
+}
+
+void pattern_set::combine() const
+{
+    combined.clear();
+    combined.reserve(2);
+    singles.clear();
+    dirty = false;
+
+    for (bool icase : { false, true })
+    {
+        vector<size_t> joinable;
+        string alternation;
+        for (size_t i = 0; i < patterns.size(); ++i)
+        {
+            const text_pattern &pat = patterns[i];
+            if (pat.empty() || pat.case_insensitive() != icase)
+                continue;
+            if (_has_backreference(pat.tostring()))
+            {
+                singles.push_back(i);
+                continue;
+            }
+            if (!alternation.empty())
+                alternation += "|";
+            alternation += _alternative(pat.tostring());
+            joinable.push_back(i);
+        }
+
+        if (joinable.size() == 1)
+            singles.push_back(joinable[0]);
+        else if (!joinable.empty())
+        {
+            combined.emplace_back(alternation, icase);
+            if (!combined.back().valid())
+            {
+                combined.pop_back();
+                singles.insert(singles.end(), joinable.begin(), joinable.end());
+            }
+        }
+    }
+}
+
+bool pattern_set::matches(const string &s) const
+{
+    if (dirty)
+        combine();
+
+    for (const text_pattern &pat : combined)
+        if (pat.matches(s))
+            return true;
+    for (size_t i : singles)
+        if (patterns[i].matches(s))
+            return true;
+    return false;
+}
@@ -116,6 +116,8 @@ public:
         return pattern;
     }
 
+    bool case_insensitive() const { return ignore_case; }
+
 private:
     string pattern;
     mutable void *compiled_pattern;
@@ -123,6 +125,34 @@ private:
     bool ignore_case;
 };
 
+/**
+ * Some text_patterns, for asking whether any of them match.
+ *
+ * The patterns are joined into one alternation for each case sensitivity,
+ * so a string is scanned once rather than once per pattern. Patterns that
+ * can't be joined (ones with backreferences, or any pattern that stops the
+ * alternation from compiling) are tried one at a time.
+ */
+class pattern_set
+{
+public:
+    pattern_set() : dirty(false) { }
+
+    void clear();
+    void add(const text_pattern &pat);
+    bool empty() const { return patterns.empty(); }
+    bool matches(const string &s) const;
+
+private:
+    void combine() const;
+
+    vector<text_pattern> patterns;
+    mutable vector<text_pattern> combined;
+    // Indices into patterns, so that a copied set matches with its own.
+    mutable vector<size_t> singles;
+    mutable bool dirty;
+};
+
 class plaintext_pattern : public base_pattern
 {
 public:
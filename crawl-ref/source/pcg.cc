@@ -48,6 +48,38 @@ namespace rng
         return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
     }
 
+    /**
+     * Generate n uniformly distributed 32-bit random numbers into out.
+     * This is the sequence n calls to get_uint32() would give, but keeps the
+     * state in registers while doing it.
+     */
+    void PcgRNG::fill(uint32_t *out, size_t n)
+    {
+        uint64_t state = state_;
+        const uint64_t inc = inc_ | 1;
+        for (size_t i = 0; i < n; i++)
+        {
+            const uint64_t oldstate = state;
+            state = oldstate * static_cast<uint64_t>(6364136223846793005ULL)
+                    + inc;
+            const uint32_t xorshifted = ((oldstate >> 18u) ^ oldstate) >> 27u;
+            const uint32_t rot = oldstate >> 59u;
+            out[i] = (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+        }
+        state_ = state;
+        count_ += n;
+    }
+
+    /**
+     * Generate n numbers in [0, range) into out, as n calls to
+     * get_bounded_uint32(range) would.
+     */
+    void PcgRNG::fill_bounded(uint32_t *out, size_t n, uint32_t range)
+    {
+        for (size_t i = 0; i < n; i++)
+            out[i] = get_bounded_uint32(range);
+    }
+
     uint64_t
     PcgRNG::get_uint64()
     {
@@ -14,6 +14,10 @@ namespace rng
         uint32_t get_uint32();
         uint32_t get_bounded_uint32(uint32_t bound);
         uint64_t get_uint64();
+        // The same values as n calls to get_uint32() or
+        // get_bounded_uint32(), in order.
+        void fill(uint32_t *out, size_t n);
+        void fill_bounded(uint32_t *out, size_t n, uint32_t bound);
         uint32_t operator()() { return get_uint32(); }
         uint32_t operator()(uint32_t bound) { return get_bounded_uint32(bound); }
 
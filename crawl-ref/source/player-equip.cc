@@ -62,6 +62,13 @@ static void _flight_equip()
     you.attribute[ATTR_PERM_FLIGHT] = 1;
 }
 
+static unsigned int _equipment_changes = 0;
+
+unsigned int equipment_changes()
+{
+    return _equipment_changes;
+}
+
 // Fill an empty equipment slot.
 void equip_item(equipment_type slot, int item_slot, bool msg, bool skip_effects)
 {
@@ -74,6 +81,7 @@ void equip_item(equipment_type slot, int item_slot, bool msg, bool skip_effects)
 #endif
 
     you.equip[slot] = item_slot;
+    ++_equipment_changes;
 
     if (!skip_effects)
         equip_effect(slot, item_slot, false, msg);
@@ -106,6 +114,7 @@ bool unequip_item(equipment_type slot, bool msg, bool skip_effects)
 #endif
 
         you.equip[slot] = -1;
+        ++_equipment_changes;
 
         if (you.melded[slot])
         {
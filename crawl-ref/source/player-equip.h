@@ -12,6 +12,9 @@ void equip_item(equipment_type slot, int item_slot, bool msg=true,
 bool unequip_item(equipment_type slot, bool msg=true, bool skip_effects=false);
 bool meld_slot(equipment_type slot);
 bool unmeld_slot(equipment_type slot);
+// Counts calls to equip_item() and unequip_item(), for caches of what the
+// player has on.
+unsigned int equipment_changes();
 
 void equip_effect(equipment_type slot, int item_slot, bool unmeld, bool msg);
 void unequip_effect(equipment_type slot, int item_slot, bool meld, bool msg);
@@ -539,6 +539,10 @@ static void _try_to_respawn_ancestor()
  */
 static void _decrement_simple_duration(duration_type dur, int delay)
 {
+    // Don't roll the expiry offset for a duration that isn't running.
+    if (!you.duration[dur])
+        return;
+
     if (_decrement_a_duration(dur, delay, duration_end_message(dur),
                              duration_expire_offset(dur),
                              duration_expire_message(dur),
@@ -550,6 +554,19 @@ static void _decrement_simple_duration(duration_type dur, int delay)
 
 
 
+// The durations that _decrement_simple_duration() handles, in order.
+static const vector<duration_type> &_simple_durations()
+{
+    static vector<duration_type> durs;
+    if (durs.empty())
+    {
+        for (int i = 0; i < NUM_DURATIONS; ++i)
+            if (duration_decrements_normally((duration_type) i))
+                durs.push_back((duration_type) i);
+    }
+    return durs;
+}
+
 /**
  * Decrement player durations based on how long the player's turn lasted in aut.
  */
@@ -812,9 +829,8 @@ static void _decrement_durations()
     }
 
     // these should be after decr_ambrosia, transforms, liquefying, etc.
-    for (int i = 0; i < NUM_DURATIONS; ++i)
-        if (duration_decrements_normally((duration_type) i))
-            _decrement_simple_duration((duration_type) i, delay);
+    for (duration_type dur : _simple_durations())
+        _decrement_simple_duration(dur, delay);
 }
 
 static void _handle_emergency_flight()
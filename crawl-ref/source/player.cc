@@ -2223,23 +2223,30 @@ void forget_map(bool rot)
     const int radius = (rot_resist ? 200 : 100);
 
     const int scalar = 0xFF;
+    // The chance of a cell being kept depends only on its distance, and
+    // the Abyss rots the map every turn.
+    FixedVector<int, GXM> keep_chance; // GXM > GYM
+    if (rot)
+    {
+        for (int dist = 0; dist < GXM; ++dist)
+        {
+            keep_chance[dist] = pow(geometric_chance,
+                                    max(1, (dist * dist - radius) / 40))
+                                * scalar;
+        }
+    }
+
     for (rectangle_iterator ri(0); ri; ++ri)
     {
         const coord_def &p = *ri;
         if (!env.map_knowledge(p).known() || you.see_cell(p))
             continue;
 
-        if (rot)
+        if (rot && x_chance_in_y(keep_chance[grid_distance(you.pos(), p)],
+                                 scalar))
         {
-            const int dist = grid_distance(you.pos(), p);
-            int chance = pow(geometric_chance,
-                             max(1, (dist * dist - radius) / 40)) * scalar;
-            if (x_chance_in_y(chance, scalar))
-                continue;
-        }
-
-        if (you.see_cell(p))
             continue;
+        }
 
         env.map_knowledge(p).clear();
         if (env.map_forgotten)
@@ -3463,9 +3470,106 @@ int slaying_bonus(bool throwing)
 // a given property. Slow if any randarts are worn, so avoid where
 // possible. If `matches' is non-nullptr, items with nonzero property are
 // pushed onto *matches.
+namespace
+{
+    // What an equipment slot contributes to scan_artefacts().
+    struct artefact_slot
+    {
+        int8_t eq = -1;
+        object_class_type base_type = OBJ_UNASSIGNED;
+        uint8_t sub_type = 0;
+        int special = 0;
+        iflags_t flags = 0;
+
+        bool operator==(const artefact_slot &other) const
+        {
+            return eq == other.eq && base_type == other.base_type
+                   && sub_type == other.sub_type && special == other.special
+                   && flags == other.flags;
+        }
+    };
+
+    // The artefact properties of everything the player has on, and what
+    // they were worked out from.
+    struct artefact_totals
+    {
+        const player *owner = nullptr;
+        time_t birth_time = 0;
+        unsigned int prop_changes = 0;
+        unsigned int equip_changes = 0;
+        FixedVector<artefact_slot, NUM_EQUIP> slots;
+        artefact_properties_t totals;
+    };
+}
+
+static artefact_slot _artefact_slot(const player &p, int i)
+{
+    artefact_slot slot;
+    if (p.melded[i] || p.equip[i] == -1)
+        return slot;
+
+    const item_def &item = p.inv[p.equip[i]];
+    // Only weapons give their effects when in our hands.
+    if (i == EQ_WEAPON && item.base_type != OBJ_WEAPONS || !is_artefact(item))
+        return slot;
+
+    slot.eq = p.equip[i];
+    slot.base_type = item.base_type;
+    slot.sub_type = item.sub_type;
+    slot.special = item.special;
+    slot.flags = item.flags;
+    return slot;
+}
+
+/**
+ * The sum of each artefact property over the player's equipment.
+ *
+ * Resists, stealth, regeneration and so on ask for these many times an
+ * action, so they're only added up again when something is put on or taken
+ * off, an artefact changes, or the equipment looks different (for code that
+ * sets you.equip directly, like inventory slot swaps).
+ */
+static const artefact_properties_t &_artefact_totals(const player &p)
+{
+    static artefact_totals cache;
+
+    FixedVector<artefact_slot, NUM_EQUIP> slots;
+    for (int i = EQ_FIRST_EQUIP; i < NUM_EQUIP; ++i)
+        slots[i] = _artefact_slot(p, i);
+
+    if (cache.owner == &p && cache.birth_time == p.birth_time
+        && cache.prop_changes == artefact_property_changes()
+        && cache.equip_changes == equipment_changes()
+        && equal(slots.begin(), slots.end(), cache.slots.begin()))
+    {
+        return cache.totals;
+    }
+
+    cache.owner = &p;
+    cache.birth_time = p.birth_time;
+    cache.prop_changes = artefact_property_changes();
+    cache.equip_changes = equipment_changes();
+    cache.slots = slots;
+    cache.totals.init(0);
+    for (int i = EQ_FIRST_EQUIP; i < NUM_EQUIP; ++i)
+    {
+        if (slots[i].eq == -1)
+            continue;
+
+        artefact_properties_t proprt;
+        artefact_properties(p.inv[slots[i].eq], proprt);
+        for (int prop = 0; prop < ART_PROPERTIES; prop++)
+            cache.totals[prop] += proprt[prop];
+    }
+    return cache.totals;
+}
+
 int player::scan_artefacts(artefact_prop_type which_property,
                            vector<const item_def *> *matches) const
 {
+    if (!matches)
+        return _artefact_totals(*this)[which_property];
+
     int retval = 0;
 
     for (int i = EQ_FIRST_EQUIP; i < NUM_EQUIP; ++i)
@@ -5949,7 +6053,7 @@ vector<const item_def *> player::get_armour_items_one_removal(const item_def& re
  * @return  The player's AC, multiplied by the given scale.
  */
 int player::base_ac_with_specific_items(int scale,
-                            vector<const item_def *> armour_items) const
+                        const vector<const item_def *> &armour_items) const
 {
     int AC = 0;
 
@@ -6001,13 +6105,13 @@ int player::armour_class() const
     return armour_class_with_specific_items(get_armour_items());
 }
 
-int player::armour_class_with_one_sub(item_def sub) const
+int player::armour_class_with_one_sub(const item_def &sub) const
 {
     return armour_class_with_specific_items(
                             get_armour_items_one_sub(sub));
 }
 
-int player::armour_class_with_one_removal(item_def removed) const
+int player::armour_class_with_one_removal(const item_def &removed) const
 {
     return armour_class_with_specific_items(
                             get_armour_items_one_removal(removed));
@@ -6035,7 +6139,8 @@ static int _meek_bonus()
     return min(max(0, (scale_top - you.hp) / hp_per_ac), max_ac);
 }
 
-int player::armour_class_with_specific_items(vector<const item_def *> items) const
+int player::armour_class_with_specific_items(
+                                const vector<const item_def *> &items) const
 {
     const int scale = 100;
     int AC = base_ac_with_specific_items(scale, items);
@@ -7030,14 +7135,13 @@ bool player::visible_to(const actor *looker) const
     if (crawl_state.game_is_arena())
         return false;
 
-    const bool invis_to = invisible() && !looker->can_see_invisible()
-                          && !in_water();
-    if (this == looker)
-        return !invis_to;
-
     const monster* mon = looker->as_monster();
-    return mon->friendly()
-        || (!mon->has_ench(ENCH_BLIND) && !invis_to);
+    if (this != looker && mon->friendly())
+        return true;
+    if (this != looker && mon->has_ench(ENCH_BLIND))
+        return false;
+
+    return !(invisible() && !looker->can_see_invisible() && !in_water());
 }
 
 /**
@@ -910,18 +910,18 @@ public:
 
     bool clear_far_engulf(bool force = false) override;
 
-    int armour_class_with_one_sub(item_def sub) const;
+    int armour_class_with_one_sub(const item_def &sub) const;
 
-    int armour_class_with_one_removal(item_def sub) const;
+    int armour_class_with_one_removal(const item_def &sub) const;
 
     int ac_changes_from_mutations() const;
     vector<const item_def *> get_armour_items() const;
     vector<const item_def *> get_armour_items_one_sub(const item_def& sub) const;
     vector<const item_def *> get_armour_items_one_removal(const item_def& sub) const;
     int base_ac_with_specific_items(int scale,
-                                    vector<const item_def *> armour_items) const;
+                        const vector<const item_def *> &armour_items) const;
     int armour_class_with_specific_items(
-                                vector<const item_def *> items) const;
+                        const vector<const item_def *> &items) const;
 
 protected:
     void _removed_beholder(bool quiet = false);
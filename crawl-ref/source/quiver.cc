@@ -1240,10 +1240,11 @@ namespace quiver
             if (spell == SPELL_SANDBLAST)
                 qdesc.cprintf(" (stones: %d)", sandblast_find_ammo().first);
 
-            if (fail_severity(spell) > 0)
+            const int raw_fail = raw_spell_fail(spell);
+            if (fail_severity(spell, raw_fail) > 0)
             {
                 qdesc.cprintf(" (%s)",
-                        failure_rate_to_string(raw_spell_fail(spell)).c_str());
+                              failure_rate_to_string(raw_fail).c_str());
             }
 
             return qdesc;
@@ -13,6 +13,7 @@
 #include "pcg.h"
 #include "syscalls.h"
 #include "branch-type.h"
+#include "job-pool.h"
 #include "state.h"
 #include "store.h"
 #include "options.h"
@@ -109,6 +110,8 @@ namespace rng
     {
         UNUSED(r);
         ASSERT(_generator != ASSERT_NO_RNG);
+        // Jobs run in no particular order, so they mustn't use the RNG.
+        ASSERT(!in_parallel_job());
         if (_generator == SUB_GENERATOR)
             return _sub_generator;
         else
@@ -127,6 +130,11 @@ namespace rng
         return current_generator().get_uint32();
     }
 
+    void fill_uint32(uint32_t *out, size_t n)
+    {
+        current_generator().fill(out, n);
+    }
+
     uint32_t peek_uint32()
     {
         PcgRNG tmp = current_generator(); // make a copy
@@ -274,8 +282,13 @@ int roll_dice(int num, int size)
     {
         ret += num;     // since random2() is zero based
 
-        for (int i = 0; i < num; i++)
-            ret += random2(size);
+        // random2(1) is always 0, and doesn't use the RNG.
+        if (size > 1)
+        {
+            rng::PcgRNG &gen = rng::current_generator();
+            for (int i = 0; i < num; i++)
+                ret += gen.get_bounded_uint32(size);
+        }
     }
 
     return ret;
@@ -331,8 +344,12 @@ int random2avg(int max, int rolls)
 {
     int sum = random2(max);
 
-    for (int i = 0; i < (rolls - 1); i++)
-        sum += random2(max + 1);
+    if (max > 0)
+    {
+        rng::PcgRNG &gen = rng::current_generator();
+        for (int i = 0; i < (rolls - 1); i++)
+            sum += gen.get_bounded_uint32(max + 1);
+    }
 
     return sum / rolls;
 }
@@ -363,9 +380,18 @@ int biased_random2(int max, int n)
  */
 int binomial(unsigned n_trials, unsigned trial_prob, unsigned scale)
 {
+    // As n_trials calls to x_chance_in_y(), which only rolls when the
+    // chance is strictly between 0 and 1.
+    const int x = trial_prob, y = scale;
+    if (x <= 0)
+        return 0;
+    if (x >= y)
+        return n_trials;
+
+    rng::PcgRNG &gen = rng::current_generator();
     int count = 0;
     for (unsigned i = 0; i < n_trials; ++i)
-        if (::x_chance_in_y(trial_prob, scale))
+        if (static_cast<int>(gen.get_bounded_uint32(y)) < x)
             count++;
 
     return count;
@@ -54,6 +54,7 @@ namespace rng
     uint64_t get_uint64(rng_type generator);
     uint32_t get_uint32();
     uint64_t get_uint64();
+    void fill_uint32(uint32_t *out, size_t n);
     uint32_t peek_uint32();
     uint64_t peek_uint64();
 
@@ -227,9 +228,13 @@ template <typename I>
 void shuffle_array(I begin, I end)
 {
     size_t n = end - begin;
+    if (n < 2)
+        return;
+    // random2(n), without finding the generator each time
+    rng::PcgRNG &gen = rng::current_generator();
     while (n > 1)
     {
-        const int i = random2(n);
+        const int i = gen.get_bounded_uint32(n);
         n--;
         iter_swap(begin + i, begin + n);
     }
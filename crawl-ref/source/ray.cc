@@ -104,9 +104,20 @@ static coord_def floor_vec(const geom::vector &v)
 
 coord_def ray_def::pos() const
 {
+    if (pos_known && on_corner == pos_on_corner
+        && r.start.x == pos_r.start.x && r.start.y == pos_r.start.y
+        && r.dir.x == pos_r.dir.x && r.dir.y == pos_r.dir.y)
+    {
+        return pos_cell;
+    }
+
     ASSERT(_valid());
     // XXX: pretty arbitrary if we're just on a corner.
-    return floor_vec(r.start);
+    pos_cell = floor_vec(r.start);
+    pos_r = r;
+    pos_on_corner = on_corner;
+    pos_known = true;
+    return pos_cell;
 }
 
 static void _round_to_corner(geom::ray *r)
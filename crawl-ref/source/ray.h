@@ -17,9 +17,9 @@ struct ray_def
     bool on_corner;
     int cycle_idx;
 
-    ray_def() : on_corner(false), cycle_idx(-1) {}
+    ray_def() : on_corner(false), cycle_idx(-1), pos_known(false) {}
     ray_def(const geom::ray& _r)
-        : r(_r), on_corner(false), cycle_idx(-1) {}
+        : r(_r), on_corner(false), cycle_idx(-1), pos_known(false) {}
 
     coord_def pos() const;
     bool advance();
@@ -28,4 +28,13 @@ struct ray_def
     void regress();
 
     bool _valid() const;
+
+private:
+    // The cell pos() last found, and the state it was found for. Beams ask
+    // where they are far more often than they move, and working it out
+    // (and checking the ray) takes a good deal of floating point.
+    mutable geom::ray pos_r;
+    mutable bool pos_on_corner;
+    mutable coord_def pos_cell;
+    mutable bool pos_known;
 };
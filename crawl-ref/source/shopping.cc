@@ -1396,12 +1396,12 @@ shop_struct *shop_at(const coord_def& where)
     if (env.grid(where) != DNGN_ENTER_SHOP)
         return nullptr;
 
-    auto it = env.shop.find(where);
-    ASSERT(it != env.shop.end());
-    ASSERT(it->second.pos == where);
-    ASSERT(it->second.type != SHOP_UNASSIGNED);
+    shop_struct *shop = env.shop.find(where);
+    ASSERT(shop);
+    ASSERT(shop->pos == where);
+    ASSERT(shop->type != SHOP_UNASSIGNED);
 
-    return &it->second;
+    return shop;
 }
 
 string shop_type_name(shop_type type)
@@ -2012,6 +2012,7 @@ void ShoppingList::move_things(const coord_def &_src, const coord_def &_dst)
 {
     if (crawl_state.map_stat_gen
         || crawl_state.obj_stat_gen
+        || crawl_state.seed_cat_gen
         || crawl_state.test)
     {
         return; // Shopping list is unitialized and uneeded.
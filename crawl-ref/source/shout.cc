@@ -14,6 +14,7 @@
 #include "artefact.h"
 #include "branch.h"
 #include "database.h"
+#include "dbg-prof.h"
 #include "directn.h"
 #include "english.h"
 #include "env.h"
@@ -36,7 +37,10 @@
 #include "view.h"
 #include "viewchar.h"
 
-static noise_grid _noise_grid;
+// Noises are registered in one grid while another propagates, since waking
+// monsters can shout; grids are recycled rather than copied.
+static unique_ptr<noise_grid> _noise_grid(new noise_grid);
+static vector<unique_ptr<noise_grid>> _spare_noise_grids;
 static void _actor_apply_noise(actor *act,
                                const coord_def &apparent_source,
                                int noise_intensity_millis);
@@ -764,16 +768,24 @@ void yell(const actor* mon)
 
 void apply_noises()
 {
-    // [ds] This copying isn't awesome, but we cannot otherwise handle
-    // the case where one set of noises wakes up monsters who then let
-    // out yips of their own, modifying _noise_grid while it is in the
-    // middle of propagate_noise().
-    if (_noise_grid.dirty())
+    PROFILE_SCOPE(PROF_NOISES);
+    // [ds] We cannot otherwise handle the case where one set of noises
+    // wakes up monsters who then let out yips of their own, modifying
+    // _noise_grid while it is in the middle of propagate_noise(): so swap
+    // in a clean grid first.
+    if (_noise_grid->dirty())
     {
-        noise_grid copy = _noise_grid;
-        // Reset the main grid.
-        _noise_grid.reset();
-        copy.propagate_noise();
+        unique_ptr<noise_grid> grid(move(_noise_grid));
+        if (_spare_noise_grids.empty())
+            _noise_grid.reset(new noise_grid);
+        else
+        {
+            _noise_grid = move(_spare_noise_grids.back());
+            _spare_noise_grids.pop_back();
+        }
+        grid->propagate_noise();
+        grid->reset();
+        _spare_noise_grids.push_back(move(grid));
     }
 }
 
@@ -819,7 +831,7 @@ bool noisy(int original_loudness, const coord_def& where,
     // Add +1 to scaled_loudness so that all squares adjacent to a
     // sound of loudness 1 will hear the sound.
     const string noise_msg(msg ? msg : "");
-    _noise_grid.register_noise(
+    _noise_grid->register_noise(
         noise_t(where, noise_msg, (scaled_loudness + 1) * multiplier, who,
                 fake_noise));
 
@@ -923,11 +935,22 @@ noise_grid::noise_grid()
 
 void noise_grid::reset()
 {
-    cells.init(noise_cell());
+    for (const coord_def &p : touched_cells)
+        cells(p) = noise_cell();
+    touched_cells.clear();
     noises.clear();
     affected_actor_count = 0;
 }
 
+// Get a cell that is about to receive noise, remembering it for reset().
+noise_cell &noise_grid::touch(const coord_def &pos)
+{
+    noise_cell &cell(cells(pos));
+    if (cell.noise_id == -1)
+        touched_cells.push_back(pos);
+    return cell;
+}
+
 void noise_grid::register_noise(const noise_t &noise)
 {
     noise_cell &target_cell(cells(noise.noise_source));
@@ -936,7 +959,7 @@ void noise_grid::register_noise(const noise_t &noise)
         const int noise_index = noises.size();
         noises.push_back(noise);
         noises[noise_index].noise_id = noise_index;
-        cells(noise.noise_source).apply_noise(noise.noise_intensity_millis,
+        touch(noise.noise_source).apply_noise(noise.noise_intensity_millis,
                                               noise_index,
                                               0,
                                               coord_def(0, 0));
@@ -952,7 +975,6 @@ void noise_grid::propagate_noise()
     dprf(DIAG_NOISE, "noise_grid: %u noises to apply",
          (unsigned int)noises.size());
 #endif
-    vector<coord_def> noise_perimeter[2];
     int circ_index = 0;
 
     for (const noise_t &noise : noises)
@@ -1043,10 +1065,10 @@ bool noise_grid::propagate_noise_to_neighbour(int base_attenuation,
     if (noise_is_audible(attenuated_noise_intensity))
     {
         const int neighbour_old_distance = neighbour.noise_travel_distance;
-        if (neighbour.apply_noise(attenuated_noise_intensity,
-                                  cell.noise_id,
-                                  travel_distance,
-                                  next_pos - current_pos))
+        if (touch(next_pos).apply_noise(attenuated_noise_intensity,
+                                       cell.noise_id,
+                                       travel_distance,
+                                       next_pos - current_pos))
             // Return true only if we hadn't already registered this
             // cell as a neighbour (presumably with a lower volume).
             return neighbour_old_distance != travel_distance;
@@ -19,6 +19,7 @@
 #include "level-state-type.h"
 #include "libutil.h"
 #include "map-knowledge.h"
+#include "mon-info.h"
 #include "mon-place.h"
 #include "state.h"
 #include "tag-version.h"
@@ -252,13 +253,11 @@ void update_item_at(const coord_def &gp, bool wizard)
     }
     else
     {
-        const vector<item_def> stash = item_list_in_stash(gp);
-        if (stash.empty())
+        const item_def *top = top_item_in_stash(gp, more_items);
+        if (!top)
             return;
 
-        eitem = stash[0];
-        if (stash.size() > 1)
-            more_items = true;
+        eitem = *top;
     }
     env.map_knowledge(gp).set_item(get_item_known_info(eitem), more_items);
 }
@@ -429,8 +428,7 @@ static void _update_monster(monster* mons)
     if (mons->visible_to(&you))
     {
         mons->ensure_has_client_id();
-        monster_info mi(mons);
-        env.map_knowledge(gp).set_monster(mi);
+        env.map_knowledge(gp).set_monster(monster_info(mons));
         return;
     }
 
@@ -507,6 +505,7 @@ void show_update_at(const coord_def &gp, layers_type layers)
     {
         if (layers & LAYER_MONSTERS)
         {
+            invalidate_monster_info();
             monster* mons = monster_at(gp);
             if (mons && mons->alive())
                 _update_monster(mons);
@@ -1312,8 +1312,11 @@ static int _train(skill_type exsk, int &max_exp, bool simu)
         }
     }
 
-    const skill_type old_best_skill = best_skill(SK_FIRST_SKILL, SK_LAST_SKILL);
-    const int old_level = you.skill(exsk, 10, true);
+    // Only needed for the redraw, which simulations (training previews,
+    // potions of experience, wizard mode) skip.
+    const skill_type old_best_skill = simu ? SK_NONE
+                                    : best_skill(SK_FIRST_SKILL, SK_LAST_SKILL);
+    const int old_level = simu ? 0 : you.skill(exsk, 10, true);
     you.skill_points[exsk] += skill_inc;
     you.exp_available -= cost;
     you.total_experience += cost;
@@ -2021,11 +2024,32 @@ int skill_bump(skill_type skill, int scale)
 // (i.e., old-style aptitude 50).
 #define APT_DOUBLE 4
 
-float apt_to_factor(int apt)
+static float _apt_to_factor(int apt)
 {
     return 1 / exp(log(2) * apt / APT_DOUBLE);
 }
 
+static const int MAX_TABLED_APT = 20;
+
+float apt_to_factor(int apt)
+{
+    // This is behind every skill_exp_needed(), so skip the exp() for the
+    // aptitudes there are.
+    static float factors[MAX_TABLED_APT - UNUSABLE_SKILL + 1];
+    static bool factors_initialised = false;
+
+    if (apt < UNUSABLE_SKILL || apt > MAX_TABLED_APT)
+        return _apt_to_factor(apt);
+
+    if (!factors_initialised)
+    {
+        for (int i = UNUSABLE_SKILL; i <= MAX_TABLED_APT; i++)
+            factors[i - UNUSABLE_SKILL] = _apt_to_factor(i);
+        factors_initialised = true;
+    }
+    return factors[apt - UNUSABLE_SKILL];
+}
+
 static int _modulo_skill_cost(int modulo_level)
 {
     return 25 * modulo_level * (modulo_level + 1);
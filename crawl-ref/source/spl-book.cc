@@ -51,7 +51,7 @@ struct sortable_spell
     sortable_spell(spell_type s) : spell(s),
                 raw_fail(raw_spell_fail(s)),
                 fail_rate(failure_rate_to_int(raw_fail)),
-                fail_rate_colour(failure_rate_colour(s)),
+                fail_rate_colour(failure_rate_colour(s, raw_fail)),
                 level(spell_levels_required(s)),
                 difficulty(spell_difficulty(s)),
                 name(spell_title(s)),
@@ -2538,7 +2538,12 @@ int max_miscast_damage(spell_type spell)
  */
 int fail_severity(spell_type spell)
 {
-    const int raw_fail = raw_spell_fail(spell);
+    return fail_severity(spell, raw_spell_fail(spell));
+}
+
+// As above, for callers that already have raw_spell_fail(spell).
+int fail_severity(spell_type spell, int raw_fail)
+{
     const int level = spell_difficulty(spell);
 
     // Impossible to get a damaging miscast
@@ -2569,7 +2574,12 @@ COMPILE_CHECK(ARRAYSZ(fail_severity_adjs) > 3);
 // based on the chance of getting a severity >= 2 miscast.
 int failure_rate_colour(spell_type spell)
 {
-    const int severity = fail_severity(spell);
+    return failure_rate_colour(spell, raw_spell_fail(spell));
+}
+
+int failure_rate_colour(spell_type spell, int raw_fail)
+{
+    const int severity = fail_severity(spell, raw_fail);
     return severity == 0 ? LIGHTGREY :
            severity == 1 ? WHITE :
            severity == 2 ? YELLOW :
@@ -2602,17 +2612,20 @@ string failure_rate_to_string(int fail)
 
 string spell_failure_rate_string(spell_type spell)
 {
-    const string failure = failure_rate_to_string(raw_spell_fail(spell));
-    const string colour = colour_to_str(failure_rate_colour(spell));
+    const int raw_fail = raw_spell_fail(spell);
+    const string failure = failure_rate_to_string(raw_fail);
+    const string colour = colour_to_str(failure_rate_colour(spell, raw_fail));
     return make_stringf("<%s>%s</%s>",
             colour.c_str(), failure.c_str(), colour.c_str());
 }
 
 static string _spell_failure_rate_description(spell_type spell)
 {
-    const string failure = failure_rate_to_string(raw_spell_fail(spell));
-    const char *severity_adj = fail_severity_adjs[fail_severity(spell)];
-    const string colour = colour_to_str(failure_rate_colour(spell));
+    const int raw_fail = raw_spell_fail(spell);
+    const string failure = failure_rate_to_string(raw_fail);
+    const char *severity_adj
+        = fail_severity_adjs[fail_severity(spell, raw_fail)];
+    const string colour = colour_to_str(failure_rate_colour(spell, raw_fail));
     const char *col = colour.c_str();
 
     return make_stringf("<%s>%s</%s>; <%s>%s</%s> risk of failure",
@@ -130,7 +130,9 @@ extern const char *fail_severity_adjs[];
 
 int max_miscast_damage(spell_type spell);
 int fail_severity(spell_type spell);
+int fail_severity(spell_type spell, int raw_fail);
 int failure_rate_colour(spell_type spell);
+int failure_rate_colour(spell_type spell, int raw_fail);
 int failure_rate_to_int(int fail);
 string failure_rate_to_string(int fail);
 
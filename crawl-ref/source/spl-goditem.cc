@@ -72,6 +72,8 @@ static bool _mons_hostile(const monster* mon)
 
 string unpacifiable_reason(const monster& mon)
 {
+    if (const monster_info *mi = viewed_monster_info(mon))
+        return unpacifiable_reason(*mi);
     return unpacifiable_reason(monster_info(&mon));
 }
 
@@ -2271,6 +2271,27 @@ int count_summons(const actor *summoner, spell_type spell)
     return count;
 }
 
+/// count_summons() for every spell at once, in one pass over the level.
+map<spell_type, int> count_summons_by_spell(const actor *summoner)
+{
+    map<spell_type, int> counts;
+    for (monster_iterator mi; mi; ++mi)
+    {
+        if (summoner == *mi)
+            continue;
+
+        int stype    = 0;
+        const bool summoned = mi->is_summoned(nullptr, &stype);
+        if (summoned && summoner->mid == mi->summoner
+            && mons_aligned(summoner, *mi))
+        {
+            counts[static_cast<spell_type>(stype)]++;
+        }
+    }
+
+    return counts;
+}
+
 static bool _create_briar_patch(coord_def& target)
 {
     mgen_data mgen = mgen_data(MONS_BRIAR_PATCH, BEH_FRIENDLY, target,
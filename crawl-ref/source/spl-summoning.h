@@ -91,6 +91,7 @@ void summoned_monster(const monster* mons, const actor* caster,
 bool summons_are_capped(spell_type spell);
 int summons_limit(spell_type spell, bool player);
 int count_summons(const actor *summoner, spell_type spell);
+map<spell_type, int> count_summons_by_spell(const actor *summoner);
 
 vector<coord_def> find_briar_spaces(bool just_check = false);
 void fedhas_wall_of_briars();
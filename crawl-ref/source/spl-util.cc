@@ -13,6 +13,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <unordered_map>
 
 #include "act-iter.h" // monster_near_iterator
 #include "areas.h"
@@ -41,6 +42,7 @@
 #include "spl-transloc.h"
 #include "spl-util.h"
 #include "spl-zap.h"
+#include "state.h"
 #include "stringutil.h"
 #include "target.h"
 #include "terrain.h"
@@ -146,7 +148,7 @@ void init_spell_descs()
     }
 }
 
-typedef map<string, spell_type> spell_name_map;
+typedef unordered_map<string, spell_type> spell_name_map;
 
 static spell_name_map &_get_spell_name_cache()
 {
@@ -157,6 +159,7 @@ static spell_name_map &_get_spell_name_cache()
 void init_spell_name_cache()
 {
     spell_name_map &cache = _get_spell_name_cache();
+    cache.reserve(NUM_SPELLS);
     for (int i = 0; i < NUM_SPELLS; i++)
     {
         spell_type type = static_cast<spell_type>(i);
@@ -779,7 +782,7 @@ void apply_area_cloud(cloud_func func, const coord_def& where,
                        int pow, int number, cloud_type ctype,
                        const actor *agent, int spread_rate, int excl_rad)
 {
-    if (number <= 0)
+    if (number <= 0 || crawl_state.updating_level)
         return;
 
     targeter_cloud place(agent, GDM, number, number);
@@ -7,6 +7,8 @@
 
 #include "startup.h"
 
+#include <chrono>
+
 #include "abyss.h"
 #include "arena.h"
 #include "branch.h"
@@ -16,6 +18,7 @@
 #include "database.h"
 #include "dbg-maps.h"
 #include "dbg-objstat.h"
+#include "dbg-prof.h"
 #include "dungeon.h"
 #include "end.h"
 #include "exclude.h"
@@ -27,8 +30,10 @@
 #include "item-name.h"
 #include "item-prop.h"
 #include "items.h"
+#include "key-journal.h"
 #include "libutil.h"
 #include "loading-screen.h"
+#include "los.h"
 #include "macro.h"
 #include "maps.h"
 #include "menu.h"
@@ -63,6 +68,7 @@
 #endif
 #include "ui.h"
 #include "version.h"
+#include "wiz-fsim.h"
 
 using namespace ui;
 
@@ -75,9 +81,113 @@ static void _loading_message(string m)
 #endif
 }
 
+// Set once init_static_game_data() has run, possibly in a zygote parent.
+static bool _static_data_ready = false;
+// Set once this startup has the dungeon builder's Lua and the maps.
+static bool _game_data_ready = false;
+
+// For -startup-profile: how long each part of startup took, in ms.
+static vector<pair<string, double>> _startup_phases;
+static chrono::steady_clock::time_point _phase_start;
+
+// Charge the time since the last phase ended to this one.
+static void _end_startup_phase(const string &name)
+{
+    if (!crawl_state.startup_profile)
+        return;
+    const auto now = chrono::steady_clock::now();
+    _startup_phases.emplace_back(name,
+        chrono::duration<double, milli>(now - _phase_start).count());
+    _phase_start = now;
+}
+
+void print_startup_profile()
+{
+    double total = 0;
+    for (const auto &phase : _startup_phases)
+    {
+        printf("%-36s %9.2f ms\n", phase.first.c_str(), phase.second);
+        total += phase.second;
+    }
+    printf("%-36s %9.2f ms\n", "total", total);
+}
+
+static void _init_data_tables()
+{
+    if (_static_data_ready)
+        return;
+
+    init_spell_descs();        // This needs to be way up top. {dlb}
+    init_zap_index();
+    init_mut_index();
+    init_sac_index();
+    init_duration_index();
+    init_mon_name_cache();
+    init_mons_spells();
+}
+
+/**
+ * Do the expensive part of startup that doesn't depend on the player, their
+ * options or their save: data tables, the dungeon builder's Lua and the
+ * maps, and rebuilding any stale databases. A webtiles zygote does this
+ * once for all the games it forks; _initialize() then skips it.
+ */
+void init_static_game_data()
+{
+    _init_data_tables();
+    init_dungeon_lua();
+
+    // Only to bring the cache files up to date: SQLite handles mustn't be
+    // shared across fork(), so each game opens its own.
+    databaseSystemInit(true);
+    init_feat_desc_cache();
+    init_spell_name_cache();
+    read_maps();
+    run_map_global_preludes();
+    databaseSystemShutdown();
+
+    los_precompute();
+    _static_data_ready = true;
+}
+
+/**
+ * Set up the dungeon builder's Lua and read the maps. Nothing before a game
+ * is chosen needs them, so an interactive start leaves this until then, and
+ * the menu comes up that much sooner.
+ */
+static void _init_game_data()
+{
+    if (_game_data_ready)
+        return;
+    _game_data_ready = true;
+    if (_static_data_ready)
+        return;
+
+    init_dungeon_lua();
+    _end_startup_phase("dungeon Lua");
+
+    _loading_message("Loading maps...");
+    read_maps();
+    run_map_global_preludes();
+    _end_startup_phase("maps");
+}
+
+// Whether this is one of the jobs that _initialize() runs itself, rather
+// than a game.
+static bool _startup_runs_job()
+{
+    return crawl_state.build_db || crawl_state.test
+           || crawl_state.map_stat_gen || crawl_state.obj_stat_gen
+           || crawl_state.seed_cat_gen || !crawl_state.fsim_sweep.empty();
+}
+
 // Initialise a whole lot of stuff...
 static void _initialize()
 {
+    _phase_start = chrono::steady_clock::now();
+    _startup_phases.clear();
+    _game_data_ready = false;
+
     Options.fixup_options();
 
     you.symbol = MONS_PLAYER;
@@ -86,17 +196,13 @@ static void _initialize()
     rng::seed(); // don't use any chosen seed yet
 
     clua.init_libraries();
+    _end_startup_phase("user Lua");
 
     init_char_table(Options.char_set);
     init_show_table();
     init_monster_symbols();
-    init_spell_descs();        // This needs to be way up top. {dlb}
-    init_zap_index();
-    init_mut_index();
-    init_sac_index();
-    init_duration_index();
-    init_mon_name_cache();
-    init_mons_spells();
+    _init_data_tables();
+    _end_startup_phase("data tables");
 
     // init_item_name_cache() needs to be redone after init_char_table()
     // and init_show_table() have been called, so that the glyphs will
@@ -119,9 +225,7 @@ static void _initialize()
 
     you.unique_creatures.reset();
     you.unique_items.init(UNIQ_NOT_EXISTS);
-
-    // Set up the Lua interpreter for the dungeon builder.
-    init_dungeon_lua();
+    _end_startup_phase("items, monsters and grids");
 
 #ifdef USE_TILE_LOCAL
     // Draw the splash screen before the database gets initialised as that
@@ -134,6 +238,7 @@ static void _initialize()
     // Initialise internal databases.
     _loading_message("Loading databases...");
     databaseSystemInit();
+    _end_startup_phase("databases");
 
     _loading_message("Loading spells and features...");
     init_feat_desc_cache();
@@ -141,11 +246,10 @@ static void _initialize()
 #ifdef DEBUG
     validate_spellbooks();
 #endif
+    _end_startup_phase("spell and feature names");
 
-    // Read special levels and vaults.
-    _loading_message("Loading maps...");
-    read_maps();
-    run_map_global_preludes();
+    if (_startup_runs_job())
+        _init_game_data();
 
     if (crawl_state.build_db)
         end(0);
@@ -161,8 +265,7 @@ static void _initialize()
     if (crawl_state.map_stat_gen)
     {
         release_cli_signals();
-        mapstat_generate_stats();
-        end(0, false);
+        end(mapstat_generate_stats() ? 0 : 1, false);
     }
     else if (crawl_state.obj_stat_gen)
     {
@@ -170,6 +273,30 @@ static void _initialize()
         objstat_generate_stats();
         end(0, false);
     }
+    else if (crawl_state.seed_cat_gen)
+    {
+        release_cli_signals();
+        seedcat_generate_catalog();
+        end(0, false);
+    }
+#endif
+
+#ifdef WIZARD
+    if (!crawl_state.fsim_sweep.empty())
+    {
+        release_cli_signals();
+        fsim_run_sweep();
+        end(0, false);
+    }
+#endif
+
+#ifdef DEBUG_PROFILE
+    if (!SysEnv.profile_turns_file.empty()
+        && !profile_trace_turns(SysEnv.profile_turns_file))
+    {
+        end(1, true, "Can't write the turn profile to %s",
+            SysEnv.profile_turns_file.c_str());
+    }
 #endif
 
     if (!crawl_state.test_list)
@@ -177,6 +304,7 @@ static void _initialize()
         if (!crawl_state.io_inited)
             cio_init();
         clrscr();
+        _end_startup_phase("console");
     }
 
     if (crawl_state.test)
@@ -322,8 +450,9 @@ static void _post_init(bool newc)
     }
 
 #ifdef WIZARD
-    // Save-less games are pointless except for tests.
-    if (Options.no_save)
+    // Save-less games are pointless except for tests. Replays aren't, but
+    // wizard mode would change what they do on death.
+    if (Options.no_save && crawl_state.replay_journal.empty())
         you.wizard = true;
 #endif
 
@@ -1003,10 +1132,25 @@ static bool _exit_type_allows_menu_bypass(game_exit exit)
 }
 #endif
 
+// Start the game that a -replay key journal was recorded in.
+static bool _startup_replay()
+{
+    newgame_def ng;
+    key_journal_load_replay(ng);
+    _init_game_data();
+    clear_message_store();
+    setup_game(ng);
+    _post_init(true);
+    return true;
+}
+
 bool startup_step()
 {
     _initialize();
 
+    if (!crawl_state.replay_journal.empty())
+        return _startup_replay();
+
     newgame_def choice   = Options.game;
 
     // Setup base game type *before* reading startup prefs -- the prefs file
@@ -1068,6 +1212,9 @@ bool startup_step()
     else
         crawl_state.bypassed_startup_menu = true;
 #endif
+    _end_startup_phase("menu");
+
+    _init_game_data();
 
     // TODO: integrate arena better with
     //       choose_game and setup_game
@@ -1083,11 +1230,15 @@ bool startup_step()
         choice.filename = get_save_filename(choice.name);
 
     if (save_exists(choice.filename) && restore_game(choice.filename))
+    {
         save_player_name();
+        key_journal_start(nullptr);
+    }
     else if (choose_game(ng, choice, defaults)
              && restore_game(ng.filename))
     {
         save_player_name();
+        key_journal_start(nullptr);
     }
     else
     {
@@ -1097,11 +1248,14 @@ bool startup_step()
         choice.seed = Options.seed; // kind of ugly, but may be changed during
                                     // setup_game.
         write_newgame_options_file(choice);
+        key_journal_start(&ng);
     }
     if (Options.remember_name)
         crawl_state.default_startup_name = you.your_name;
+    _end_startup_phase(newchar ? "new game" : "restore");
 
     _post_init(newchar);
+    _end_startup_phase("level setup");
 
     return newchar;
 }
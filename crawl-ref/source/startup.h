@@ -6,4 +6,6 @@
 #pragma once
 
 bool startup_step();
+void init_static_game_data();
+void print_startup_profile();
 void cio_init();
@@ -27,12 +27,14 @@
 #include "god-passive.h"
 #include "hints.h"
 #include "invent.h"
+#include "item-name.h"
 #include "item-prop.h"
 #include "item-status-flag-type.h"
 #include "items.h"
 #include "libutil.h" // map_find
 #include "menu.h"
 #include "message.h"
+#include "misc.h"
 #include "notes.h"
 #include "output.h"
 #include "religion.h"
@@ -133,7 +135,7 @@ void describe_stash(const coord_def& c)
         mprf(MSGCH_EXAMINE_FILTER, "%s", desc.c_str());
 }
 
-vector<item_def> Stash::get_items() const
+const vector<item_def> &Stash::get_items() const
 {
     return items;
 }
@@ -153,6 +155,25 @@ vector<item_def> item_list_in_stash(const coord_def& pos)
     return ret;
 }
 
+/**
+ * The first item remembered at pos, without copying the rest of them.
+ *
+ * @param pos         the stash's position on the current level.
+ * @param more_items  set to whether there are other items under it.
+ * @return            the item, or nullptr if none are remembered there.
+ */
+const item_def *top_item_in_stash(const coord_def& pos, bool &more_items)
+{
+    more_items = false;
+    LevelStashes *ls = StashTrack.find_current_level();
+    const Stash *s = ls ? ls->find_stash(pos) : nullptr;
+    if (!s || s->get_items().empty())
+        return nullptr;
+
+    more_items = s->get_items().size() > 1;
+    return &s->get_items()[0];
+}
+
 static void _fully_identify_item(item_def *item)
 {
     if (!item || !item->defined())
@@ -199,10 +220,34 @@ bool Stash::unvisited() const
     return !visited;
 }
 
+void Stash::items_changed()
+{
+    search_cache.clear();
+    pickup_cache.clear();
+}
+
+// Explore and travel ask this about every stash they pass, each step.
+bool Stash::needs_autopickup(size_t i) const
+{
+    if (pickup_cache.size() != items.size()
+        || pickup_cache_time != you.elapsed_time
+        || pickup_cache_options != Options.lines_read
+        || pickup_cache_settings != autopickup_settings_version())
+    {
+        pickup_cache.assign(items.size(), MB_MAYBE);
+        pickup_cache_time = you.elapsed_time;
+        pickup_cache_options = Options.lines_read;
+        pickup_cache_settings = autopickup_settings_version();
+    }
+    if (pickup_cache[i] == MB_MAYBE)
+        pickup_cache[i] = frombool(item_needs_autopickup(items[i]));
+    return pickup_cache[i] == MB_TRUE;
+}
+
 bool Stash::pickup_eligible() const
 {
-    for (const item_def &item : items)
-        if (item_needs_autopickup(item))
+    for (size_t i = 0; i < items.size(); ++i)
+        if (needs_autopickup(i))
             return true;
 
     return false;
@@ -210,8 +255,8 @@ bool Stash::pickup_eligible() const
 
 bool Stash::needs_stop() const
 {
-    for (const item_def &item : items)
-        if (!item_needs_autopickup(item))
+    for (size_t i = 0; i < items.size(); ++i)
+        if (!needs_autopickup(i))
             return true;
 
     return false;
@@ -235,6 +280,8 @@ bool Stash::unmark_trapping_nets()
     for (auto &item : items)
         if (item_is_stationary_net(item))
             item.net_placed = false, changed = true;
+    if (changed)
+        items_changed();
     return changed;
 }
 
@@ -262,6 +309,7 @@ void Stash::update()
 
     // Zap existing items
     items.clear();
+    items_changed();
 
     if (!_grid_has_perceived_item(pos))
     {
@@ -375,18 +423,18 @@ vector<stash_search_result> Stash::matches_search(
     if (empty())
         return results;
 
-    for (const item_def &item : items)
+    const vector<search_text> &texts = search_texts();
+    for (size_t i = 0; i < items.size(); ++i)
     {
-        const string s   = stash_item_name(item);
-        const string ann = stash_annotate_item(STASH_LUA_SEARCH_ANNOTATE, &item);
-        if (search.matches(prefix + " " + ann + " " + s)
-            || is_dumpable_artefact(item) && search.matches(chardump_desc(item)))
+        const search_text &text = texts[i];
+        if (search.matches(prefix + " " + text.annotation + " " + text.name)
+            || text.dumpable && search.matches(text.dump))
         {
             stash_search_result res;
             res.match_type = MATCH_ITEM;
-            res.match = s;
-            res.primary_sort = item.name(DESC_QUALNAME);
-            res.item = item;
+            res.match = text.name;
+            res.primary_sort = text.qualname;
+            res.item = items[i];
             results.push_back(res);
         }
     }
@@ -412,8 +460,34 @@ vector<stash_search_result> Stash::matches_search(
     return results;
 }
 
+const vector<Stash::search_text> &Stash::search_texts() const
+{
+    if (search_cache.size() != items.size()
+        || search_cache_time != you.elapsed_time
+        || search_cache_options != Options.lines_read)
+    {
+        search_cache.clear();
+        for (const item_def &item : items)
+        {
+            search_text text;
+            text.name = stash_item_name(item);
+            text.annotation = stash_annotate_item(STASH_LUA_SEARCH_ANNOTATE,
+                                                  &item);
+            text.qualname = item.name(DESC_QUALNAME);
+            text.dumpable = is_dumpable_artefact(item);
+            if (text.dumpable)
+                text.dump = chardump_desc(item);
+            search_cache.push_back(move(text));
+        }
+        search_cache_time = you.elapsed_time;
+        search_cache_options = Options.lines_read;
+    }
+    return search_cache;
+}
+
 void Stash::_update_corpses(int rot_time)
 {
+    items_changed();
     for (int i = items.size() - 1; i >= 0; i--)
     {
         item_def &item = items[i];
@@ -434,6 +508,7 @@ void Stash::_update_corpses(int rot_time)
 
 void Stash::_update_identification()
 {
+    items_changed();
     for (int i = items.size() - 1; i >= 0; i--)
     {
         god_id_item(items[i]);
@@ -450,6 +525,7 @@ void Stash::add_item(item_def &item, bool add_to_front)
         items.insert(items.begin(), item);
     else
         items.push_back(item);
+    items_changed();
 
     seen_item(item);
 
@@ -554,6 +630,7 @@ void Stash::load(reader& inf)
 
     // Zap out item vector, in case it's in use (however unlikely)
     items.clear();
+    items_changed();
     // Read in the items
     for (int i = 0; i < count; ++i)
     {
@@ -1421,18 +1498,25 @@ void StashTracker::search_stashes(string search_term)
     lastsearch = csearch_literal;
 
     vector<stash_search_result> results;
-    if (!curr_lev)
-        results = _inventory_search(*search);
-    get_matching_stashes(*search, results, curr_lev);
-
-    if (results.empty())
+    vector<stash_search_result> dedup_results;
     {
-        mprf(MSGCH_PLAIN, "Can't find anything matching that.");
-        return;
-    }
+        // Matching, sorting and deduplicating all name each item again.
+        item_name_memo names;
 
-    // The spam threshold works a lot better if we use the deduplicated size.
-    vector<stash_search_result> dedup_results = _stash_filter_duplicates(results);
+        if (!curr_lev)
+            results = _inventory_search(*search);
+        get_matching_stashes(*search, results, curr_lev);
+
+        if (results.empty())
+        {
+            mprf(MSGCH_PLAIN, "Can't find anything matching that.");
+            return;
+        }
+
+        // The spam threshold works a lot better if we use the deduplicated
+        // size.
+        dedup_results = _stash_filter_duplicates(results);
+    }
 
     if (dedup_results.size() > SEARCH_SPAM_THRESHOLD)
     {
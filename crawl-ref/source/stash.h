@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 
+#include "maybe-bool.h"
 #include "shopping.h"
 #include "trap-type.h"
 
@@ -35,7 +36,7 @@ public:
 
     string description() const;
     string feature_description() const;
-    vector<item_def> get_items() const;
+    const vector<item_def> &get_items() const;
 
     // Returns true if this Stash contains items that are eligible for
     // autopickup.
@@ -78,6 +79,32 @@ private:
     static bool are_items_same(const item_def &, const item_def &,
                                bool exact = false);
 
+    // What searches match each item against. Names and annotations change
+    // as time passes and with the options, so the texts are kept only
+    // until either does, or until the items themselves change.
+    struct search_text
+    {
+        string name;         // stash_item_name()
+        string annotation;   // the search annotation
+        string qualname;     // for sorting the results
+        bool dumpable;       // is_dumpable_artefact()
+        string dump;         // chardump_desc(), if dumpable
+    };
+    mutable vector<search_text> search_cache;
+    mutable int search_cache_time = -1;
+    mutable unsigned int search_cache_options = 0;
+    const vector<search_text> &search_texts() const;
+
+    // item_needs_autopickup() for each item, kept on the same terms, and
+    // also until a force_autopickup setting changes in the \ menu.
+    mutable vector<maybe_bool> pickup_cache;
+    mutable int pickup_cache_time = -1;
+    mutable unsigned int pickup_cache_options = 0;
+    mutable unsigned int pickup_cache_settings = 0;
+    bool needs_autopickup(size_t i) const;
+
+    void items_changed();
+
     friend class LevelStashes;
     friend class ST_ItemIterator;
 };
@@ -337,6 +364,7 @@ string get_stash_desc(const coord_def& c);
 void describe_stash(const coord_def& c);
 
 vector<item_def> item_list_in_stash(const coord_def& pos);
+const item_def *top_item_in_stash(const coord_def& pos, bool &more_items);
 
 string userdef_annotate_item(const char *s, const item_def *item);
 string stash_annotate_item(const char *s, const item_def *item);
@@ -37,11 +37,13 @@ game_state::game_state()
       smallterm(false),
 #endif
       seen_hups(0), map_stat_gen(false), map_stat_dump_disconnect(false),
-      obj_stat_gen(false), type(GAME_TYPE_NORMAL),
+      obj_stat_gen(false), seed_cat_gen(false), startup_profile(false),
+      type(GAME_TYPE_NORMAL),
       last_type(GAME_TYPE_UNSPECIFIED), last_game_exit(game_exit::unknown),
-      marked_as_won(false), arena_suspended(false),
-      generating_level(false), dump_maps(false), test(false), script(false),
-      build_db(false), tests_selected(),
+      marked_as_won(false), arena_suspended(false), arena_batch(0),
+      generating_level(false), updating_level(false),
+      dump_maps(false), test(false), script(false),
+      build_db(false), forked_worker(false), tests_selected(),
 #ifdef DGAMELAUNCH
       throttle(true),
       bypassed_startup_menu(true),
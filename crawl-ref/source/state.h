@@ -69,8 +69,12 @@ struct game_state
     bool map_stat_dump_disconnect; // Set if we dump disconnected maps and exit
                                    // under mapstat.
     bool obj_stat_gen;      // Set if we're generating object stats.
+    bool seed_cat_gen;      // Set if we're cataloguing seeds.
+    bool startup_profile;   // Set if we're timing startup.
 
     string force_map;       // Set if we're forcing a specific map to generate.
+    string fsim_sweep;      // Set to the -fsim matchups if we're running them.
+    string replay_journal;  // Set to the -replay key journal, if playing one.
 
     game_type type;
     game_type last_type;
@@ -78,13 +82,17 @@ struct game_state
     bool marked_as_won;
     bool arena_suspended;   // Set if the arena has been temporarily
                             // suspended.
+    int  arena_batch;       // Number of fights to run with -arena-batch.
     bool generating_level;
+    bool updating_level;    // Set while update_level() catches up on the
+                            // player's absence.
 
     bool dump_maps;         // Dump map Lua to stderr on fresh parse.
     bool test;              // Set if we want to run self-tests and exit.
     bool test_list;         // Show available tests and exit.
     bool script;            // Set if we want to run a Lua script and exit.
     bool build_db;          // Set if we want to rebuild the db and exit.
+    bool forked_worker;     // Set in a child process doing a job for us.
     vector<string> tests_selected; // Tests to be run.
     vector<string> script_args;    // Arguments to scripts.
 
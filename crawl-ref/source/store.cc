@@ -46,6 +46,16 @@ CrawlStoreValue::CrawlStoreValue(const CrawlStoreValue &other)
     *this = other;
 }
 
+// Takes over other's value, leaving it unset.
+CrawlStoreValue::CrawlStoreValue(CrawlStoreValue &&other)
+    : type(other.type), flags(other.flags), val(other.val)
+{
+    ASSERT_RANGE(other.type, SV_NONE, NUM_STORE_VAL_TYPES);
+    other.type = SV_NONE;
+    other.flags = SFLAG_UNSET;
+    other.val.ptr = nullptr;
+}
+
 CrawlStoreValue::CrawlStoreValue(const store_flags _flags,
                                  const store_val_type _type)
     : type(_type), flags(_flags)
@@ -214,12 +224,8 @@ void CrawlStoreValue::unset(bool force)
     }
 
     case SV_COORD:
-    {
-        coord_def* coord = static_cast<coord_def*>(val.ptr);
-        delete coord;
-        val.ptr = nullptr;
+        val.coord.reset();
         break;
-    }
 
     case SV_ITEM:
     {
@@ -246,12 +252,8 @@ void CrawlStoreValue::unset(bool force)
     }
 
     case SV_LEV_ID:
-    {
-        level_id* id = static_cast<level_id*>(val.ptr);
-        delete id;
-        val.ptr = nullptr;
+        val.lev_id.clear();
         break;
-    }
 
     case SV_LEV_POS:
     {
@@ -315,10 +317,6 @@ CrawlStoreValue &CrawlStoreValue::operator = (const CrawlStoreValue &other)
         DELETE_PTR(string);
         break;
 
-    case SV_COORD:
-        DELETE_PTR(coord_def);
-        break;
-
     case SV_ITEM:
         DELETE_PTR(item_def);
         break;
@@ -331,10 +329,6 @@ CrawlStoreValue &CrawlStoreValue::operator = (const CrawlStoreValue &other)
         DELETE_PTR(CrawlVector);
         break;
 
-    case SV_LEV_ID:
-        DELETE_PTR(level_id);
-        break;
-
      case SV_LEV_POS:
         DELETE_PTR(level_pos);
         break;
@@ -352,6 +346,8 @@ CrawlStoreValue &CrawlStoreValue::operator = (const CrawlStoreValue &other)
     case SV_INT:
     case SV_INT64:
     case SV_FLOAT:
+    case SV_COORD:
+    case SV_LEV_ID:
         val = other.val;
         break;
 
@@ -359,10 +355,6 @@ CrawlStoreValue &CrawlStoreValue::operator = (const CrawlStoreValue &other)
         COPY_PTR(string);
         break;
 
-    case SV_COORD:
-        COPY_PTR(coord_def);
-        break;
-
     case SV_ITEM:
         COPY_PTR(item_def);
         break;
@@ -375,10 +367,6 @@ CrawlStoreValue &CrawlStoreValue::operator = (const CrawlStoreValue &other)
         COPY_PTR(CrawlVector);
         break;
 
-    case SV_LEV_ID:
-        COPY_PTR(level_id);
-        break;
-
     case SV_LEV_POS:
         COPY_PTR(level_pos);
         break;
@@ -402,6 +390,28 @@ CrawlStoreValue &CrawlStoreValue::operator = (const CrawlStoreValue &other)
     return *this;
 }
 
+CrawlStoreValue &CrawlStoreValue::operator = (CrawlStoreValue &&other)
+{
+    ASSERT_RANGE(other.type, SV_NONE, NUM_STORE_VAL_TYPES);
+    ASSERT(other.type != SV_NONE || type == SV_NONE);
+    if (this == &other)
+        return *this;
+
+    if (!(flags & SFLAG_UNSET) && (flags & SFLAG_CONST_TYPE))
+        ASSERT(type == SV_NONE || type == other.type);
+
+    unset(true);
+    type  = other.type;
+    flags = other.flags;
+    val   = other.val;
+
+    other.type = SV_NONE;
+    other.flags = SFLAG_UNSET;
+    other.val.ptr = nullptr;
+
+    return *this;
+}
+
 ///////////////////////////////////
 // Meta-data accessors and changers
 store_flags CrawlStoreValue::get_flags() const
@@ -482,11 +492,8 @@ void CrawlStoreValue::write(writer &th) const
     }
 
     case SV_COORD:
-    {
-        coord_def* coord = static_cast<coord_def*>(val.ptr);
-        marshallCoord(th, *coord);
+        marshallCoord(th, val.coord);
         break;
-    }
 
     case SV_ITEM:
     {
@@ -510,11 +517,8 @@ void CrawlStoreValue::write(writer &th) const
     }
 
     case SV_LEV_ID:
-    {
-        level_id* id = static_cast<level_id*>(val.ptr);
-        id->save(th);
+        val.lev_id.save(th);
         break;
-    }
 
     case SV_LEV_POS:
     {
@@ -598,12 +602,8 @@ void CrawlStoreValue::read(reader &th)
     }
 
     case SV_COORD:
-    {
-        const coord_def coord = unmarshallCoord(th);
-        val.ptr = (void*) new coord_def(coord);
-
+        val.coord = unmarshallCoord(th);
         break;
-    }
 
     case SV_ITEM:
     {
@@ -633,13 +633,8 @@ void CrawlStoreValue::read(reader &th)
     }
 
     case SV_LEV_ID:
-    {
-        level_id* id = new level_id();
-        id->load(th);
-        val.ptr = (void*) id;
-
+        val.lev_id.load(th);
         break;
-    }
 
     case SV_LEV_POS:
     {
@@ -760,26 +755,23 @@ CrawlVector &CrawlStoreValue::new_vector(store_val_type _type,
     flags &= ~SFLAG_UNSET; \
     return field;
 
+// value is only evaluated when a new one is needed, so looking up a
+// value that's already there doesn't allocate.
 #define GET_VAL_PTR(x, _type, value) \
+    GET_VAL_INLINE(x, val.ptr, value); \
+    return *((_type) val.ptr);
+
+// For types kept in the union itself.
+#define GET_VAL_INLINE(x, field, value) \
     ASSERT((flags & SFLAG_UNSET) || !(flags & SFLAG_CONST_VAL)); \
     if (type != (x) || (flags & SFLAG_UNSET)) \
     { \
-        if (type == SV_NONE) \
-        { \
-            type    = (x); \
-            val.ptr = (value); \
-        } \
-        else \
-        { \
+        if (type != SV_NONE) \
             unset(); \
-            val.ptr = (value); \
-            type    = (x); \
-        } \
+        field = (value); \
+        type  = (x); \
     } \
-    else \
-        delete (value); \
-    flags &= ~SFLAG_UNSET; \
-    return *((_type) val.ptr);
+    flags &= ~SFLAG_UNSET
 
 bool &CrawlStoreValue::get_bool()
 {
@@ -818,7 +810,8 @@ string &CrawlStoreValue::get_string()
 
 coord_def &CrawlStoreValue::get_coord()
 {
-    GET_VAL_PTR(SV_COORD, coord_def*, new coord_def());
+    GET_VAL_INLINE(SV_COORD, val.coord, coord_def());
+    return val.coord;
 }
 
 item_def &CrawlStoreValue::get_item()
@@ -838,7 +831,8 @@ CrawlVector &CrawlStoreValue::get_vector()
 
 level_id &CrawlStoreValue::get_level_id()
 {
-    GET_VAL_PTR(SV_LEV_ID, level_id*, new level_id());
+    GET_VAL_INLINE(SV_LEV_ID, val.lev_id, level_id());
+    return val.lev_id;
 }
 
 level_pos &CrawlStoreValue::get_level_pos()
@@ -907,7 +901,7 @@ string CrawlStoreValue::get_string() const
 coord_def CrawlStoreValue::get_coord() const
 {
     GET_CONST_SETUP(SV_COORD);
-    return *((coord_def*)val.ptr);
+    return val.coord;
 }
 
 const item_def& CrawlStoreValue::get_item() const
@@ -937,7 +931,7 @@ const monster& CrawlStoreValue::get_monster() const
 level_id CrawlStoreValue::get_level_id() const
 {
     GET_CONST_SETUP(SV_LEV_ID);
-    return *((level_id*)val.ptr);
+    return val.lev_id;
 }
 
 level_pos CrawlStoreValue::get_level_pos() const
@@ -1262,11 +1256,160 @@ static map<string, int> accesses;
 //////////////////
 // Misc functions
 
-bool CrawlHashTable::exists(const string &key) const
+// Tables smaller than this are scanned rather than indexed.
+static const size_t HASH_INDEX_MIN_SIZE = 8;
+
+CrawlHashTable::CrawlHashTable(CrawlHashTable &&other)
+    : map(move(other)), indexed(0)
+{
+    other.index.clear();
+    other.indexed = 0;
+}
+
+CrawlHashTable &CrawlHashTable::operator = (const CrawlHashTable &other)
+{
+    map::operator=(other);
+    index.clear();
+    indexed = 0;
+    return *this;
+}
+
+CrawlHashTable &CrawlHashTable::operator = (CrawlHashTable &&other)
+{
+    map::operator=(move(other));
+    index.clear();
+    indexed = 0;
+    other.index.clear();
+    other.indexed = 0;
+    return *this;
+}
+
+void CrawlHashTable::index_entry(value_type *entry) const
+{
+    const size_t mask = index.size() - 1;
+    size_t slot = prop_key_hash(entry->first.c_str()) & mask;
+    while (index[slot])
+        slot = (slot + 1) & mask;
+    index[slot] = entry;
+    ++indexed;
+}
+
+void CrawlHashTable::build_index() const
+{
+    size_t slots = 16;
+    while (slots < size() * 2)
+        slots *= 2;
+    index.assign(slots, nullptr);
+    indexed = 0;
+    for (auto &entry : const_cast<CrawlHashTable &>(*this))
+        index_entry(&entry);
+}
+
+/// Take an entry that's about to be erased out of the index.
+void CrawlHashTable::unindex_entry(const value_type *entry)
+{
+    if (index.empty())
+        return;
+    if (indexed != size())
+    {
+        // Something was added behind our back; start over next time.
+        index.clear();
+        indexed = 0;
+        return;
+    }
+
+    const size_t mask = index.size() - 1;
+    size_t slot = prop_key_hash(entry->first.c_str()) & mask;
+    while (index[slot] != entry)
+    {
+        if (!index[slot])
+            return;
+        slot = (slot + 1) & mask;
+    }
+
+    // Shift back anything later in the run that would now be cut off from
+    // its home slot.
+    size_t hole = slot;
+    for (size_t next = (slot + 1) & mask; index[next]; next = (next + 1) & mask)
+    {
+        const size_t home = prop_key_hash(index[next]->first.c_str()) & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            index[hole] = index[next];
+            hole = next;
+        }
+    }
+    index[hole] = nullptr;
+    --indexed;
+}
+
+CrawlHashTable::value_type *CrawlHashTable::find_entry(const char *key) const
+{
+    if (size() < HASH_INDEX_MIN_SIZE)
+    {
+        for (auto &entry : const_cast<CrawlHashTable &>(*this))
+            if (entry.first == key)
+                return &entry;
+        return nullptr;
+    }
+
+    if (index.empty() || indexed != size())
+        build_index();
+
+    const size_t mask = index.size() - 1;
+    for (size_t slot = prop_key_hash(key) & mask; index[slot];
+         slot = (slot + 1) & mask)
+    {
+        if (index[slot]->first == key)
+            return index[slot];
+    }
+    return nullptr;
+}
+
+bool CrawlHashTable::exists(const char *key) const
 {
     ACCESS(key);
     ASSERT_VALIDITY();
-    return find(key) != end();
+    return find_entry(key);
+}
+
+CrawlHashTable::size_type CrawlHashTable::erase(const string &key)
+{
+    if (value_type *entry = find_entry(key.c_str()))
+    {
+        unindex_entry(entry);
+        return map::erase(key);
+    }
+    return 0;
+}
+
+CrawlHashTable::iterator CrawlHashTable::erase(const_iterator pos)
+{
+    unindex_entry(&*pos);
+    return map::erase(pos);
+}
+
+CrawlHashTable::iterator CrawlHashTable::erase(const_iterator first,
+                                               const_iterator last)
+{
+    index.clear();
+    indexed = 0;
+    return map::erase(first, last);
+}
+
+void CrawlHashTable::clear()
+{
+    index.clear();
+    indexed = 0;
+    map::clear();
+}
+
+void CrawlHashTable::swap(CrawlHashTable &other)
+{
+    // The nodes move with the maps, so the indices can go with them too.
+    map::swap(other);
+    index.swap(other.index);
+    std::swap(indexed, other.indexed);
 }
 
 void CrawlHashTable::assert_validity() const
@@ -1292,9 +1435,7 @@ void CrawlHashTable::assert_validity() const
         switch (val.type)
         {
         case SV_STR:
-        case SV_COORD:
         case SV_ITEM:
-        case SV_LEV_ID:
         case SV_LEV_POS:
             ASSERT(val.val.ptr != nullptr);
             break;
@@ -1333,22 +1474,34 @@ void CrawlHashTable::assert_validity() const
 ////////////////////////////////
 // Accessors to contained values
 
-CrawlStoreValue& CrawlHashTable::get_value(const string &key)
+CrawlStoreValue& CrawlHashTable::get_value(const char *key)
 {
     ASSERT_VALIDITY();
     ACCESS(key);
+    if (value_type *entry = find_entry(key))
+        return entry->second;
+
     // Inserts CrawlStoreValue() if the key was not found.
-    return map::operator[](key);
+    const bool was_indexed = !index.empty() && indexed == size();
+    value_type &entry = *map::emplace(key, CrawlStoreValue()).first;
+    if (was_indexed && size() * 2 <= index.size())
+        index_entry(&entry);
+    else
+    {
+        index.clear();
+        indexed = 0;
+    }
+    return entry.second;
 }
 
-const CrawlStoreValue& CrawlHashTable::get_value(const string &key) const
+const CrawlStoreValue& CrawlHashTable::get_value(const char *key) const
 {
     ASSERT_VALIDITY();
     ACCESS(key);
-    auto iter = find(key);
-    ASSERTM(iter != end(), "trying to read non-existent property \"%s\"", key.c_str());
+    const value_type *entry = find_entry(key);
+    ASSERTM(entry, "trying to read non-existent property \"%s\"", key);
 
-    const CrawlStoreValue& store = iter->second;
+    const CrawlStoreValue& store = entry->second;
     ASSERT(store.type != SV_NONE);
     ASSERT(!(store.flags & SFLAG_UNSET));
 
@@ -1524,9 +1677,7 @@ void CrawlVector::assert_validity() const
         switch (val.type)
         {
         case SV_STR:
-        case SV_COORD:
         case SV_ITEM:
-        case SV_LEV_ID:
         case SV_LEV_POS:
             ASSERT(val.val.ptr != nullptr);
             break;
@@ -1626,9 +1777,7 @@ void CrawlVector::push_back(CrawlStoreValue val)
     switch (val.type)
     {
     case SV_STR:
-    case SV_COORD:
     case SV_ITEM:
-    case SV_LEV_ID:
     case SV_LEV_POS:
         ASSERT(val.val.ptr != nullptr);
         break;
@@ -61,15 +61,21 @@ enum store_flag_type
     SFLAG_NO_ERASE   = (1 << 3),
 };
 
+// Coords and level_ids fit in the space a pointer would take, so they're
+// kept inline; everything bigger is on the heap.
 typedef union StoreUnion StoreUnion;
 union StoreUnion
 {
+    StoreUnion() : _int64(0) { }
+
     bool  boolean;
     char  byte;
     short _short;
     int   _int;
     float _float;
     int64_t _int64;
+    coord_def coord;
+    level_id lev_id;
     void* ptr;
 };
 
@@ -78,6 +84,7 @@ class CrawlStoreValue
 public:
     CrawlStoreValue();
     CrawlStoreValue(const CrawlStoreValue &other);
+    CrawlStoreValue(CrawlStoreValue &&other);
 
     ~CrawlStoreValue();
 
@@ -100,6 +107,7 @@ public:
     CrawlStoreValue(const dlua_chunk &val);
 
     CrawlStoreValue &operator = (const CrawlStoreValue &other);
+    CrawlStoreValue &operator = (CrawlStoreValue &&other);
 
 protected:
     // These first two fields need to match those in CrawlVector
@@ -241,27 +249,49 @@ protected:
     friend class CrawlVector;
 };
 
+// The FNV-1a hash of a property name. It's constexpr so that lookups with
+// a literal key can have the hash folded in at compile time.
+constexpr uint32_t prop_key_hash(const char *key, uint32_t hash = 2166136261U)
+{
+    return *key ? prop_key_hash(key + 1,
+                                (hash ^ static_cast<uint8_t>(*key)) * 16777619U)
+                : hash;
+}
+
+// A CrawlHashTable keeps its entries in a map, sorted by key: that's the
+// order they're saved in, and a value stays where it is however the table
+// changes, so references into it are safe to hold. Lookups don't walk the
+// tree, though. Small tables are scanned; bigger ones keep an open
+// addressing index of their entries, so looking up a const char * key
+// neither builds a string nor does more than a compare or two.
 class CrawlHashTable : public map<string, CrawlStoreValue>
 {
 public:
     friend class CrawlStoreValue;
 
+    CrawlHashTable() : indexed(0) { }
+    CrawlHashTable(const CrawlHashTable &other) : map(other), indexed(0) { }
+    CrawlHashTable(CrawlHashTable &&other);
+    CrawlHashTable &operator = (const CrawlHashTable &other);
+    CrawlHashTable &operator = (CrawlHashTable &&other);
+
     void write(writer &) const;
     void read(reader &);
 
-    bool exists(const string &key) const;
+    bool exists(const string &key) const { return exists(key.c_str()); }
+    bool exists(const char *key) const;
 
     void assert_validity() const;
 
     // NOTE: If the const versions of get_value() or [] are given a
     // key which doesn't exist, they will assert.
-    const CrawlStoreValue& get_value(const string &key) const;
-    const CrawlStoreValue& get_value(const char *key) const
-    { return get_value(string(key)); }
+    const CrawlStoreValue& get_value(const string &key) const
+    { return get_value(key.c_str()); }
+    const CrawlStoreValue& get_value(const char *key) const;
     const CrawlStoreValue& operator[] (const string &key) const
-    { return get_value(key); }
+    { return get_value(key.c_str()); }
     const CrawlStoreValue& operator[] (const char *key) const
-    { return get_value(string(key)); }
+    { return get_value(key); }
 
     // NOTE: If get_value() or [] is given a key which doesn't exist
     // in the table, an unset/empty CrawlStoreValue will be created
@@ -270,12 +300,34 @@ public:
     // hash table has a type (rather than being heterogeneous)
     // then trying to assign a different type to the CrawlStoreValue
     // will assert.
-    CrawlStoreValue& get_value(const string &key);
-    CrawlStoreValue& get_value(const char *key)
-    { return get_value(string(key)); }
-    using map::operator[];
+    CrawlStoreValue& get_value(const string &key)
+    { return get_value(key.c_str()); }
+    CrawlStoreValue& get_value(const char *key);
+    CrawlStoreValue& operator[] (const string &key)
+    { return get_value(key.c_str()); }
     CrawlStoreValue& operator[] (const char *key)
-    { return get_value(string(key)); }
+    { return get_value(key); }
+
+    // The map's own versions of these would leave the index pointing at
+    // entries that are gone. Inserting doesn't need this: the index notices
+    // that the table has grown.
+    size_type erase(const string &key);
+    iterator erase(const_iterator pos);
+    iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+    iterator erase(const_iterator first, const_iterator last);
+    void clear();
+    void swap(CrawlHashTable &other);
+
+private:
+    value_type *find_entry(const char *key) const;
+    void build_index() const;
+    void index_entry(value_type *entry) const;
+    void unindex_entry(const value_type *entry);
+
+    // Empty, or a power of two in size, with nullptr for the free slots.
+    mutable vector<value_type *> index;
+    // How many entries the index holds; it's only good while that's size().
+    mutable size_t indexed;
 };
 
 // A CrawlVector is the vector version of CrawlHashTable, except that
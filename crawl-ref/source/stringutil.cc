@@ -158,7 +158,8 @@ string wordwrap_line(string &s, int width, bool tags, bool indent, int force_ind
 
     while (int clen = utf8towc(&c, cp))
     {
-        int cw = wcwidth(c);
+        // Most of what's wrapped is plain ASCII; save asking the locale.
+        int cw = c >= ' ' && c < 0x7f ? 1 : wcwidth(c);
         if (c == ' ')
         {
             if (seen_nonspace)
@@ -19,6 +19,7 @@
 # include <dirent.h>
 # include <unistd.h>
 # include <fcntl.h>
+# include <sys/mman.h>
 # include <sys/types.h>
 # include <sys/stat.h>
 #endif
@@ -533,3 +534,37 @@ int open_u(const char *pathname, int flags, mode_t mode)
     return open(OUTS(pathname), flags, mode);
 #endif
 }
+
+const void *map_file_u(const char *pathname, size_t &size)
+{
+#ifdef TARGET_OS_WINDOWS
+    UNUSED(pathname);
+    size = 0;
+    return nullptr;
+#else
+    const int fd = open(OUTS(pathname), O_RDONLY);
+    if (fd == -1)
+        return nullptr;
+
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (!fstat(fd, &st) && st.st_size > 0)
+    {
+        size = st.st_size;
+        data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    // The mapping holds on to the file by itself.
+    close(fd);
+    return data == MAP_FAILED ? nullptr : data;
+#endif
+}
+
+void unmap_file(const void *data, size_t size)
+{
+#ifdef TARGET_OS_WINDOWS
+    UNUSED(data, size);
+#else
+    if (data)
+        munmap(const_cast<void *>(data), size);
+#endif
+}
@@ -36,3 +36,8 @@ int unlink_u(const char *pathname);
 FILE *fopen_u(const char *path, const char *mode);
 int mkdir_u(const char *pathname, mode_t mode);
 int open_u(const char *pathname, int flags, mode_t mode);
+
+// A whole file mapped read-only, so that every process using it shares the
+// one copy; nullptr where that can't be done.
+const void *map_file_u(const char *pathname, size_t &size);
+void unmap_file(const void *data, size_t size);
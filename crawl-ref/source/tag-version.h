@@ -267,6 +267,8 @@ enum tag_minor_version
     TAG_MINOR_CUT_STRICT_NEUTRAL,  // Merge strict_neutral with good_neutral
     TAG_MINOR_SPLIT_HELL_GATE,     // Split "enter" and "leave branch" features.
     TAG_MINOR_MOSTLY_REMOVE_AMMO,  // Remove most aspects of launcher ammo.
+    TAG_MINOR_SPARSE_LEVEL_SLOTS,  // Store only used item and monster slots.
+    TAG_MINOR_RLE_LEVEL_GRIDS,     // Run-length encode terrain and pgrid.
 #endif
     NUM_TAG_MINORS,
     TAG_MINOR_VERSION = NUM_TAG_MINORS - 1
@@ -142,6 +142,13 @@ void reader::close()
 
 void reader::advance(size_t offset)
 {
+    // Files and buffers can skip ahead directly.
+    if (!_chunk)
+    {
+        read(nullptr, offset);
+        return;
+    }
+
     char junk[128];
 
     while (offset)
@@ -167,23 +174,35 @@ static NORETURN void _short_read(bool safe_read)
     die_noline("short read while reading save");
 }
 
+// How much of a chunk to decompress at a time.
+static const size_t READ_WINDOW_SIZE = 65536;
+
+void reader::fill_window()
+{
+    if (_window.empty())
+        _window.resize(READ_WINDOW_SIZE);
+    _window_pos = 0;
+    _window_len = _chunk->read(&_window[0], _window.size());
+    if (!_window_len)
+        _short_read(_safe_read);
+}
+
 // Reads input in network byte order, from a file or buffer.
 unsigned char reader::readByte()
 {
-    if (_file)
+    if (_chunk)
+    {
+        if (_window_pos == _window_len)
+            fill_window();
+        return _window[_window_pos++];
+    }
+    else if (_file)
     {
         int b = fgetc(_file);
         if (b == EOF)
             _short_read(_safe_read);
         return b;
     }
-    else if (_chunk)
-    {
-        unsigned char buf;
-        if (_chunk->read(&buf, 1) != 1)
-            _short_read(_safe_read);
-        return buf;
-    }
     else
     {
         if (_read_offset >= _pbuf->size())
@@ -194,7 +213,30 @@ unsigned char reader::readByte()
 
 void reader::read(void *data, size_t size)
 {
-    if (_file)
+    if (_chunk)
+    {
+        unsigned char *out = static_cast<unsigned char *>(data);
+        while (size)
+        {
+            if (_window_pos == _window_len)
+            {
+                // Big reads can skip the window.
+                if (size >= READ_WINDOW_SIZE)
+                {
+                    if (_chunk->read(out, size) != size)
+                        _short_read(_safe_read);
+                    return;
+                }
+                fill_window();
+            }
+            const size_t len = min(size, _window_len - _window_pos);
+            memcpy(out, &_window[_window_pos], len);
+            _window_pos += len;
+            out += len;
+            size -= len;
+        }
+    }
+    else if (_file)
     {
         if (data)
         {
@@ -204,11 +246,6 @@ void reader::read(void *data, size_t size)
         else
             fseek(_file, (long)size, SEEK_CUR);
     }
-    else if (_chunk)
-    {
-        if (_chunk->read(data, size) != size)
-            _short_read(_safe_read);
-    }
     else
     {
         if (_read_offset+size > _pbuf->size())
@@ -234,7 +271,7 @@ void reader::setMinorVersion(int minorVersion)
 void reader::fail_if_not_eof(const string &name)
 {
     char dummy;
-    if (_chunk ? _chunk->read(&dummy, 1) :
+    if (_chunk ? _window_pos < _window_len || _chunk->read(&dummy, 1) :
         _file ? (fgetc(_file) != EOF) :
         _read_offset >= _pbuf->size())
     {
@@ -764,7 +801,7 @@ static void _run_length_encode(writer &th, marshall m, const grid &g,
         {
             if (!nlast)
                 last = g[x][y];
-            if (last == g[x][y] && nlast < 255)
+            if (last == static_cast<int>(g[x][y]) && nlast < 255)
             {
                 nlast++;
                 continue;
@@ -1375,12 +1412,12 @@ void tag_read(reader &inf, tag_type tag_id)
         // We can't do this when we unmarshall shops, since we haven't
         // unmarshalled items yet...
         if (th.getMinorVersion() < TAG_MINOR_SHOP_HACK)
-            for (auto& entry : env.shop)
+            for (auto& shop : env.shop)
             {
                 // Shop items were heaped up at this cell.
-                for (stack_iterator si(coord_def(0, entry.second.num+5)); si; ++si)
+                for (stack_iterator si(coord_def(0, shop.num+5)); si; ++si)
                 {
-                    entry.second.stock.push_back(*si);
+                    shop.stock.push_back(*si);
                     dec_mitm_item_quantity(si.index(), si->quantity);
                 }
             }
@@ -1998,20 +2035,26 @@ static i_transit_list unmarshall_item_list(reader &th)
 
 static void marshall_level_map_masks(writer &th)
 {
-    for (rectangle_iterator ri(0); ri; ++ri)
-    {
-        marshallInt(th, env.level_map_mask(*ri));
-        marshallInt(th, env.level_map_ids(*ri));
-    }
+    // Outside vaults these are all zero and INVALID_MAP_INDEX.
+    _run_length_encode(th, marshallInt, env.level_map_mask, GXM, GYM);
+    _run_length_encode(th, marshallInt, env.level_map_ids, GXM, GYM);
 }
 
 static void unmarshall_level_map_masks(reader &th)
 {
-    for (rectangle_iterator ri(0); ri; ++ri)
+#if TAG_MAJOR_VERSION == 34
+    if (th.getMinorVersion() < TAG_MINOR_RLE_LEVEL_GRIDS)
     {
-        env.level_map_mask(*ri) = unmarshallInt(th);
-        env.level_map_ids(*ri)  = unmarshallInt(th);
+        for (rectangle_iterator ri(0); ri; ++ri)
+        {
+            env.level_map_mask(*ri) = unmarshallInt(th);
+            env.level_map_ids(*ri)  = unmarshallInt(th);
+        }
+        return;
     }
+#endif
+    _run_length_decode(th, unmarshallInt, env.level_map_mask, GXM, GYM);
+    _run_length_decode(th, unmarshallInt, env.level_map_ids, GXM, GYM);
 }
 
 static void marshall_level_map_unique_ids(writer &th)
@@ -4654,15 +4697,6 @@ static void _tag_read_companions(reader &th)
                   unmarshall_companion);
 }
 
-template <typename Z>
-static int _last_used_index(const Z &thinglist, int max_things)
-{
-    for (int i = max_things - 1; i >= 0; --i)
-        if (thinglist[i].defined())
-            return i + 1;
-    return 0;
-}
-
 // ------------------------------- level tags ---------------------------- //
 
 static void _tag_construct_level(writer &th)
@@ -4683,13 +4717,17 @@ static void _tag_construct_level(writer &th)
 
     CANARY;
 
+    // Most of a level is rock without properties, so the terrain and its
+    // properties compress well as runs.
+    _run_length_encode(th, marshallUByte, env.grid, GXM, GYM);
+    FixedArray<int, GXM, GYM> pgrid_flags;
+    for (rectangle_iterator ri(0); ri; ++ri)
+        pgrid_flags(*ri) = env.pgrid(*ri).flags;
+    _run_length_encode(th, marshallInt, pgrid_flags, GXM, GYM);
+
     for (int count_x = 0; count_x < GXM; count_x++)
         for (int count_y = 0; count_y < GYM; count_y++)
-        {
-            marshallByte(th, env.grid[count_x][count_y]);
             marshallMapCell(th, env.map_knowledge[count_x][count_y]);
-            marshallInt(th, env.pgrid[count_x][count_y].flags);
-        }
 
     marshallBoolean(th, !!env.map_forgotten);
     if (env.map_forgotten)
@@ -4703,9 +4741,8 @@ static void _tag_construct_level(writer &th)
 
     // how many clouds?
     marshallShort(th, env.cloud.size());
-    for (const auto& entry : env.cloud)
+    for (const cloud_struct& cloud : env.cloud)
     {
-        const cloud_struct& cloud = entry.second;
         marshallByte(th, cloud.type);
         ASSERT(cloud.type != CLOUD_NONE);
         ASSERT_IN_BOUNDS(cloud.pos);
@@ -4723,8 +4760,8 @@ static void _tag_construct_level(writer &th)
 
     // how many shops?
     marshallShort(th, env.shop.size());
-    for (const auto& entry : env.shop)
-        marshall_shop(th, entry.second);
+    for (const shop_struct& shop : env.shop)
+        marshall_shop(th, shop);
 
     CANARY;
 
@@ -5599,7 +5636,7 @@ void unmarshallMapCell(reader &th, map_cell& cell)
     {
         monster_info mi;
         _unmarshallMonsterInfo(th, mi);
-        cell.set_monster(mi);
+        cell.set_monster(move(mi));
     }
 
     // set this last so the other sets don't override this
@@ -5610,19 +5647,28 @@ static void _tag_construct_level_items(writer &th)
 {
     // how many traps?
     marshallShort(th, env.trap.size());
-    for (const auto& entry : env.trap)
+    for (const trap_def& trap : env.trap)
     {
-        const trap_def& trap = entry.second;
         marshallByte(th, trap.type);
         marshallCoord(th, trap.pos);
         marshallShort(th, trap.ammo_qty);
     }
 
-    // how many items?
-    const int ni = _last_used_index(env.item, MAX_ITEMS);
-    marshallShort(th, ni);
-    for (int i = 0; i < ni; ++i)
+    // how many items? Only used slots are stored, each prefixed by the
+    // number of empty slots skipped since the previous one.
+    int ni = 0;
+    for (int i = 0; i < MAX_ITEMS; ++i)
+        if (env.item[i].base_type != OBJ_UNASSIGNED)
+            ni++;
+    marshallUnsigned(th, ni);
+    for (int i = 0, next = 0; i < MAX_ITEMS; ++i)
+    {
+        if (env.item[i].base_type == OBJ_UNASSIGNED)
+            continue;
+        marshallUnsigned(th, i - next);
         marshallItem(th, env.item[i]);
+        next = i + 1;
+    }
 }
 
 static void marshall_mon_enchant(writer &th, const mon_enchant &me)
@@ -6112,13 +6158,20 @@ static void _tag_construct_level_monsters(writer &th)
     for (int i = 0; i < nm; ++i)
         marshallMonType(th, env.mons_alloc[i]);
 
-    // how many monsters?
-    nm = _last_used_index(env.mons, MAX_MONSTERS);
-    marshallShort(th, nm);
+    // how many monsters? As with items, only the used slots are stored.
+    nm = 0;
+    for (int i = 0; i < MAX_MONSTERS; ++i)
+        if (env.mons[i].alive())
+            nm++;
+    marshallUnsigned(th, nm);
 
-    for (int i = 0; i < nm; i++)
+    for (int i = 0, next = 0; i < MAX_MONSTERS; i++)
     {
         monster& m(env.mons[i]);
+        if (!m.alive())
+            continue;
+        marshallUnsigned(th, i - next);
+        next = i + 1;
 
 #if defined(DEBUG) || defined(DEBUG_MONS_SCAN)
         if (m.type != MONS_NO_MONSTER)
@@ -6211,11 +6264,25 @@ static void _tag_read_level(reader &th)
     env.map_seen.reset();
 #if TAG_MAJOR_VERSION == 34
     vector<coord_def> transporters;
+    const bool rle_grids
+        = th.getMinorVersion() >= TAG_MINOR_RLE_LEVEL_GRIDS;
+#else
+    const bool rle_grids = true;
 #endif
+    FixedArray<int, GXM, GYM> feats, pgrid_flags;
+    if (rle_grids)
+    {
+        _run_length_decode(th,
+                           [](reader &r) { return unmarshallFeatureType(r); },
+                           feats, GXM, GYM);
+        _run_length_decode(th, unmarshallInt, pgrid_flags, GXM, GYM);
+    }
     for (int i = 0; i < gx; i++)
         for (int j = 0; j < gy; j++)
         {
-            dungeon_feature_type feat = unmarshallFeatureType(th);
+            dungeon_feature_type feat = rle_grids
+                ? static_cast<dungeon_feature_type>(feats[i][j])
+                : unmarshallFeatureType(th);
             env.grid[i][j] = feat;
             ASSERT(feat < NUM_FEATURES);
 
@@ -6234,7 +6301,8 @@ static void _tag_read_level(reader &th)
             env.map_knowledge[i][j].flags &= ~MAP_VISIBLE_FLAG;
             if (env.map_knowledge[i][j].seen())
                 env.map_seen.set(i, j);
-            env.pgrid[i][j].flags = unmarshallInt(th);
+            env.pgrid[i][j].flags = rle_grids ? pgrid_flags[i][j]
+                                              : unmarshallInt(th);
 
             env.mgrid[i][j] = NON_MONSTER;
         }
@@ -6515,24 +6583,42 @@ static void _tag_read_level_items(reader &th)
         for (int j = 0; j < GYM; j++)
         {
             coord_def pos(i, j);
-            if (feat_is_trap(env.grid(pos)) && !map_find(env.trap, pos))
+            if (feat_is_trap(env.grid(pos)) && !env.trap.find(pos))
                 env.grid(pos) = DNGN_FLOOR;
         }
 
 #endif
 
     // how many items?
-    const int item_count = unmarshallShort(th);
-    ASSERT_RANGE(item_count, 0, MAX_ITEMS + 1);
-    for (int i = 0; i < item_count; ++i)
-        unmarshallItem(th, env.item[i]);
-    for (int i = item_count; i < MAX_ITEMS; ++i)
-        env.item[i].clear();
+#if TAG_MAJOR_VERSION == 34
+    if (th.getMinorVersion() < TAG_MINOR_SPARSE_LEVEL_SLOTS)
+    {
+        const int item_count = unmarshallShort(th);
+        ASSERT_RANGE(item_count, 0, MAX_ITEMS + 1);
+        for (int i = 0; i < item_count; ++i)
+            unmarshallItem(th, env.item[i]);
+        for (int i = item_count; i < MAX_ITEMS; ++i)
+            env.item[i].clear();
+    }
+    else
+#endif
+    {
+        for (int i = 0; i < MAX_ITEMS; ++i)
+            env.item[i].clear();
+        const unsigned int item_count = unmarshallUnsigned(th);
+        ASSERT(item_count <= MAX_ITEMS);
+        for (unsigned int n = 0, i = 0; n < item_count; ++n, ++i)
+        {
+            i += unmarshallUnsigned(th);
+            ASSERT(i < MAX_ITEMS);
+            unmarshallItem(th, env.item[i]);
+        }
+    }
 
 #ifdef DEBUG_ITEM_SCAN
     // There's no way to fix this, even with wizard commands, so get
     // rid of it when restoring the game.
-    for (int i = 0; i < item_count; ++i)
+    for (int i = 0; i < MAX_ITEMS; ++i)
     {
         if (env.item[i].defined() && env.item[i].pos.origin())
         {
@@ -6551,6 +6637,7 @@ void unmarshallMonster(reader &th, monster& m)
     m.type = unmarshallMonType(th);
     if (m.type == MONS_NO_MONSTER)
         return;
+    note_monster_slot(m);
 
     ASSERT(!invalid_monster_type(m.type));
 
@@ -7058,11 +7145,25 @@ static void _tag_read_level_monsters(reader &th)
         env.mons_alloc[i] = MONS_NO_MONSTER;
 
     // how many monsters?
-    count = unmarshallShort(th);
+    bool sparse = true;
+#if TAG_MAJOR_VERSION == 34
+    if (th.getMinorVersion() < TAG_MINOR_SPARSE_LEVEL_SLOTS)
+    {
+        sparse = false;
+        count = unmarshallShort(th);
+    }
+    else
+#endif
+    count = unmarshallUnsigned(th);
     ASSERT_RANGE(count, 0, MAX_MONSTERS + 1);
 
-    for (int i = 0; i < count; i++)
+    for (int n = 0, i = 0; n < count; n++, i++)
     {
+        if (sparse)
+        {
+            i += unmarshallUnsigned(th);
+            ASSERT_RANGE(i, 0, MAX_MONSTERS);
+        }
         monster& m = env.mons[i];
         unmarshallMonster(th, m);
 
@@ -7279,6 +7380,15 @@ static tileidx_t _get_tile_from_vector(const unsigned int idx)
 
 static void _regenerate_tile_flavour()
 {
+    // Look each name up once, rather than for every cell that uses it.
+    vector<tileidx_t> tiles(tile_env.names.size() + 1, 0);
+    for (unsigned int i = 1; i < tiles.size(); ++i)
+        tiles[i] = _get_tile_from_vector(i);
+    auto tile_at = [&tiles](unsigned int idx) -> tileidx_t
+    {
+        return idx < tiles.size() ? tiles[idx] : 0;
+    };
+
     /* Remember the wall_idx and floor_idx; tile_init_default_flavour
        sets them to 0 */
     tileidx_t default_wall_idx = tile_env.default_flavour.wall_idx;
@@ -7286,7 +7396,7 @@ static void _regenerate_tile_flavour()
     tile_init_default_flavour();
     if (default_wall_idx)
     {
-        tileidx_t new_wall = _get_tile_from_vector(default_wall_idx);
+        tileidx_t new_wall = tile_at(default_wall_idx);
         if (new_wall)
         {
             tile_env.default_flavour.wall_idx = default_wall_idx;
@@ -7295,7 +7405,7 @@ static void _regenerate_tile_flavour()
     }
     if (default_floor_idx)
     {
-        tileidx_t new_floor = _get_tile_from_vector(default_floor_idx);
+        tileidx_t new_floor = tile_at(default_floor_idx);
         if (new_floor)
         {
             tile_env.default_flavour.floor_idx = default_floor_idx;
@@ -7314,7 +7424,7 @@ static void _regenerate_tile_flavour()
 
         if (flv.wall_idx)
         {
-            tileidx_t new_wall = _get_tile_from_vector(flv.wall_idx);
+            tileidx_t new_wall = tile_at(flv.wall_idx);
             if (!new_wall)
                 flv.wall_idx = 0;
             else
@@ -7322,7 +7432,7 @@ static void _regenerate_tile_flavour()
         }
         if (flv.floor_idx)
         {
-            tileidx_t new_floor = _get_tile_from_vector(flv.floor_idx);
+            tileidx_t new_floor = tile_at(flv.floor_idx);
             if (!new_floor)
                 flv.floor_idx = 0;
             else
@@ -7330,7 +7440,7 @@ static void _regenerate_tile_flavour()
         }
         if (flv.feat_idx)
         {
-            tileidx_t new_feat = _get_tile_from_vector(flv.feat_idx);
+            tileidx_t new_feat = tile_at(flv.feat_idx);
             if (!new_feat)
                 flv.feat_idx = 0;
             else
@@ -138,10 +138,16 @@ public:
 
     void set_safe_read(bool setting) { _safe_read = setting; }
 
+private:
+    void fill_window();
+
 private:
     string _filename;
     FILE* _file;
     chunk_reader *_chunk;
+    // Chunks are read ahead into this, rather than a byte at a time.
+    vector<unsigned char> _window;
+    size_t _window_pos = 0, _window_len = 0;
     bool  opened_file;
     const vector<unsigned char>* _pbuf;
     unsigned int _read_offset;
@@ -1355,6 +1355,8 @@ bool targeter_thunderbolt::set_aim(coord_def a)
     if (left_of(a2, a1))
         swap(a1, a2);
 
+    los_grid visible;
+    cell_see_cells(origin, LOS_NO_TRANS, visible);
     for (int x = -LOS_RADIUS; x <= LOS_RADIUS; ++x)
         for (int y = -LOS_RADIUS; y <= LOS_RADIUS; ++y)
         {
@@ -1366,7 +1368,7 @@ bool targeter_thunderbolt::set_aim(coord_def a)
                 (p = r) += origin;
                 if (!zapped.count(p))
                     arc_length[r.rdist()]++;
-                if (zapped[p] <= 0 && cell_see_cell(origin, p, LOS_NO_TRANS))
+                if (zapped[p] <= 0 && visible(r))
                     zapped[p] = AFF_MAYBE;
             }
         }
@@ -1631,6 +1633,8 @@ bool targeter_cone::set_aim(coord_def a)
     if (left_of(a2, a1))
         swap(a1, a2);
 
+    los_grid visible;
+    cell_see_cells(origin, LOS_NO_TRANS, visible);
     for (int x = -LOS_RADIUS; x <= LOS_RADIUS; ++x)
         for (int y = -LOS_RADIUS; y <= LOS_RADIUS; ++y)
         {
@@ -1643,7 +1647,7 @@ bool targeter_cone::set_aim(coord_def a)
                 if (zapped[p] <= 0
                     && map_bounds(p)
                     && opc_solid_see(p) < OPC_OPAQUE
-                    && cell_see_cell(origin, p, LOS_NO_TRANS))
+                    && visible(q))
                 {
                     zapped[p] = AFF_YES;
                     sweep[(origin - p).rdist()][p] = AFF_YES;
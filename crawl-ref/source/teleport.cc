@@ -310,20 +310,24 @@ static coord_def random_space_weighted(actor* moved, actor* target,
 
     for (radius_iterator ri(moved->pos(), LOS_NO_TRANS); ri; ++ri)
     {
-        if (!valid_blink_destination(moved, *ri, !allow_sanct)
-            || (keep_los && !target->see_cell_no_trans(*ri)))
-        {
-            continue;
-        }
-
         int weight;
         int dist = (tpos - *ri).rdist();
         if (close)
             weight = (LOS_RADIUS - dist) * (LOS_RADIUS - dist);
         else
             weight = dist;
-        if (weight < 0)
-            weight = 0;
+
+        // A spot with no weight can never be picked, so don't bother
+        // checking whether it's a valid one.
+        if (weight <= 0)
+            continue;
+
+        if (!valid_blink_destination(moved, *ri, !allow_sanct)
+            || (keep_los && !target->see_cell_no_trans(*ri)))
+        {
+            continue;
+        }
+
         dests.emplace_back(*ri, weight);
     }
 
@@ -8,6 +8,7 @@
 #include "terrain.h"
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
 #include <sstream>
 
@@ -34,6 +35,7 @@
 #include "mapmark.h"
 #include "message.h"
 #include "mon-behv.h"
+#include "mon-pathfind.h"
 #include "mon-place.h"
 #include "mon-poly.h"
 #include "mon-util.h"
@@ -260,6 +262,34 @@ bool feat_is_stair(dungeon_feature_type gridc)
     return feat_is_travelable_stair(gridc) || feat_is_gate(gridc);
 }
 
+/**
+ * Every feat_is_stair() cell on the level, in rectangle_iterator order.
+ *
+ * Terrain is written from far too many places to keep this up to date as
+ * it changes, so instead the grid it was found on is kept, and compared with
+ * the current one; that's much quicker than looking at every cell again.
+ */
+const vector<coord_def> &level_stairs()
+{
+    static feature_grid indexed;
+    static vector<coord_def> stairs;
+    static bool valid = false;
+
+    if (valid && !memcmp(&indexed[0][0], &env.grid[0][0],
+                         sizeof(dungeon_feature_type) * GXM * GYM))
+    {
+        return stairs;
+    }
+
+    indexed = env.grid;
+    valid = true;
+    stairs.clear();
+    for (rectangle_iterator ri(0); ri; ++ri)
+        if (feat_is_stair(env.grid(*ri)))
+            stairs.push_back(*ri);
+    return stairs;
+}
+
 /** Is this feature a level exit stair with a consistent endpoint?
  */
 bool feat_is_travelable_stair(dungeon_feature_type feat)
@@ -1275,7 +1305,7 @@ void dungeon_terrain_changed(const coord_def &pos,
         return;
     if (feat_is_wall(nfeat) && monster_at(pos))
         return;
-    if (feat_is_trap(nfeat) && env.trap.find(pos) == env.trap.end())
+    if (feat_is_trap(nfeat) && !env.trap.find(pos))
     {
         // TODO: create a trap_def in env for this case?
         mprf(MSGCH_ERROR,
@@ -1316,6 +1346,7 @@ void dungeon_terrain_changed(const coord_def &pos,
         env.level_map_mask(pos) &= ~MMT_MIMIC;
 
     set_terrain_changed(pos);
+    clear_pathfind_flow_fields();
 
     // Deal with doors being created by changing features.
     tile_init_flavour(pos);
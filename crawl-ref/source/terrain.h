@@ -68,6 +68,7 @@ bool feat_is_metal(dungeon_feature_type feat);
 bool feat_is_stair(dungeon_feature_type feat);
 bool feat_is_travelable_stair(dungeon_feature_type feat);
 bool feat_is_gate(dungeon_feature_type feat);
+const vector<coord_def> &level_stairs();
 
 string feat_preposition(dungeon_feature_type feat, bool active = false,
                         const actor* who = nullptr);
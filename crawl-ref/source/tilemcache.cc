@@ -155,35 +155,42 @@ mcache_manager::~mcache_manager()
     clear_all();
 }
 
-unsigned int mcache_manager::register_monster(const monster_info& minf)
+// Everything that goes into drawing an entry; entries with the same key
+// look the same.
+static string _entry_key(const mcache_entry &entry)
 {
-    // TODO enne - is it worth it to search against all mcache entries?
-    // TODO enne - pool mcache types to avoid too much alloc/dealloc?
+    string key(1, entry.transparent() ? 't' : 'o');
 
-    mcache_entry *entry;
+    tile_draw_info dinfo[mcache_entry::MAX_INFO_COUNT];
+    const int count = entry.info(&dinfo[0]);
+    for (int i = 0; i < count; i++)
+    {
+        const int vals[] = { (int) dinfo[i].idx, dinfo[i].ofs_x,
+                             dinfo[i].ofs_y };
+        key.append((const char *) vals, sizeof(vals));
+    }
 
-    if (minf.props.exists(MONSTER_TILE_KEY))
+    if (const dolls_data *doll = entry.doll())
     {
-        if (mcache_monster::valid(minf))
-            entry = new mcache_monster(minf);
-        else
-            return 0;
+        key += 'd';
+        key.append((const char *) doll->parts,
+                   TILEP_PART_MAX * sizeof(*doll->parts));
     }
-    else if (mcache_demon::valid(minf))
-        entry = new mcache_demon(minf);
-    else if (mcache_mbeast::valid(minf))
-        entry = new mcache_mbeast(minf);
-    else if (mcache_ghost::valid(minf))
-        entry = new mcache_ghost(minf);
-    else if (mcache_draco::valid(minf))
-        entry = new mcache_draco(minf);
-    else if (mcache_armour::valid(minf))
-        entry = new mcache_armour(minf);
-    else if (mcache_monster::valid(minf))
-        entry = new mcache_monster(minf);
-    else
-        return 0;
+    return key;
+}
+
+// Build the entry for mon on the stack, and only keep a copy of it if no
+// existing entry looks the same.
+template<class T>
+unsigned int mcache_manager::register_entry(const monster_info &mon)
+{
+    const T candidate(mon);
+    const string key = _entry_key(candidate);
+    auto found = m_lookup.find(key);
+    if (found != m_lookup.end())
+        return TILEP_MCACHE_START + found->second;
 
+    mcache_entry *entry = new T(candidate);
     tileidx_t idx = ~0;
 
     for (unsigned int i = 0; i < m_entries.size(); i++)
@@ -202,9 +209,35 @@ unsigned int mcache_manager::register_monster(const monster_info& minf)
         m_entries.push_back(entry);
     }
 
+    m_lookup[key] = idx;
     return TILEP_MCACHE_START + idx;
 }
 
+unsigned int mcache_manager::register_monster(const monster_info& minf)
+{
+    if (minf.props.exists(MONSTER_TILE_KEY))
+    {
+        if (mcache_monster::valid(minf))
+            return register_entry<mcache_monster>(minf);
+        else
+            return 0;
+    }
+    else if (mcache_demon::valid(minf))
+        return register_entry<mcache_demon>(minf);
+    else if (mcache_mbeast::valid(minf))
+        return register_entry<mcache_mbeast>(minf);
+    else if (mcache_ghost::valid(minf))
+        return register_entry<mcache_ghost>(minf);
+    else if (mcache_draco::valid(minf))
+        return register_entry<mcache_draco>(minf);
+    else if (mcache_armour::valid(minf))
+        return register_entry<mcache_armour>(minf);
+    else if (mcache_monster::valid(minf))
+        return register_entry<mcache_monster>(minf);
+    else
+        return 0;
+}
+
 void mcache_manager::clear_nonref()
 {
     for (mcache_entry *&entry : m_entries)
@@ -212,6 +245,7 @@ void mcache_manager::clear_nonref()
         if (!entry || entry->ref_count() > 0)
             continue;
 
+        m_lookup.erase(_entry_key(*entry));
         delete entry;
         entry = nullptr;
     }
@@ -220,6 +254,7 @@ void mcache_manager::clear_nonref()
 void mcache_manager::clear_all()
 {
     deleteAll(m_entries);
+    m_lookup.clear();
 }
 
 mcache_entry *mcache_manager::get(tileidx_t tile)
@@ -6,6 +6,8 @@
 #ifdef USE_TILE
 #pragma once
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 struct dolls_data;
@@ -17,6 +19,9 @@ struct dolls_data;
 // Monster cache entries for monsters that are out of sight are ref-counted
 // that they can be drawn even if that monster no longer exists. When no
 // out-of-sight tiles refer to them, they can be deleted.
+//
+// Monsters that would be drawn the same way, such as a band of orcs with the
+// same equipment, share one entry and so one tile index.
 
 class tile_draw_info
 {
@@ -73,7 +78,11 @@ public:
     bool empty() { return m_entries.empty(); }
 
 protected:
+    template<class T> unsigned int register_entry(const monster_info &mon);
+
     vector<mcache_entry*> m_entries;
+    // The index of each entry in m_entries, by what it draws.
+    unordered_map<string, unsigned int> m_lookup;
 };
 
 // The global monster cache.
@@ -17,6 +17,7 @@
 #include "tilepick.h"
 #include "tiles-build-specific.h"
 #include "tilereg-cmd.h"
+#include "unwind.h"
 
 AbilityRegion::AbilityRegion(const TileRegionInit &init) : GridRegion(init)
 {
@@ -207,8 +208,9 @@ static InventoryTile _tile_for_ability(ability_type ability)
 
 void AbilityRegion::update()
 {
-    m_items.clear();
-    m_dirty = true;
+    vector<InventoryTile> old_items;
+    old_items.swap(m_items);
+    ON_UNWIND { finish_update(old_items); };
 
     if (mx * my == 0)
         return;
@@ -48,6 +48,31 @@ void GridRegion::on_resize()
     m_dirty = true;
 }
 
+static bool _same_tile(const InventoryTile &a, const InventoryTile &b)
+{
+    // The cursor is only added when packing.
+    return a.tile == b.tile && a.idx == b.idx && a.quantity == b.quantity
+           && (a.flag & ~TILEI_FLAG_CURSOR) == (b.flag & ~TILEI_FLAG_CURSOR)
+           && a.key == b.key && a.special == b.special;
+}
+
+/**
+ * For update(), once it has built m_items afresh. The grid is only repacked
+ * if the tiles differ from old_items, the ones it showed before; update()
+ * happens on every view redraw, and usually nothing has changed.
+ */
+void GridRegion::finish_update(vector<InventoryTile> &old_items)
+{
+    bool same = old_items.size() == m_items.size();
+    for (size_t i = 0; same && i < m_items.size(); i++)
+        same = _same_tile(old_items[i], m_items[i]);
+
+    if (same)
+        m_items.swap(old_items); // these have the cursor in place
+    else
+        m_dirty = true;
+}
+
 unsigned int GridRegion::cursor_index() const
 {
     ASSERT(m_cursor != NO_CURSOR);
@@ -56,6 +56,7 @@ protected:
     int add_quad_char(char c, int x, int y, int ox, int oy);
     void draw_number(int x, int y, int number);
     void draw_desc(const char *desc);
+    void finish_update(vector<InventoryTile> &old_items);
 
     coord_def m_cursor;
     int m_last_clicked_item;
@@ -30,8 +30,10 @@
 #include "tag-version.h"
 #include "tilepick.h"
 #include "unicode.h"
+#include "unwind.h"
 
-InventoryRegion::InventoryRegion(const TileRegionInit &init) : GridRegion(init)
+InventoryRegion::InventoryRegion(const TileRegionInit &init) : GridRegion(init),
+    m_floor_flavour(0)
 {
 }
 
@@ -129,6 +131,7 @@ int InventoryRegion::handle_mouse(wm_mouse_event &event)
     {
         // next page
         m_grid_page++;
+        m_dirty = true;
         update();
         return CK_NO_KEY;
     }
@@ -136,6 +139,7 @@ int InventoryRegion::handle_mouse(wm_mouse_event &event)
     {
         // prev page
         m_grid_page--;
+        m_dirty = true;
         update();
         return CK_NO_KEY;
     }
@@ -597,8 +601,16 @@ static void _fill_item_info(InventoryTile &desc, const item_def &item)
 
 void InventoryRegion::update()
 {
-    m_items.clear();
-    m_dirty = true;
+    vector<InventoryTile> old_items;
+    old_items.swap(m_items);
+    ON_UNWIND { finish_update(old_items); };
+
+    // Floor slots are drawn with the level's floor.
+    if (tile_env.default_flavour.floor != m_floor_flavour)
+    {
+        m_floor_flavour = tile_env.default_flavour.floor;
+        m_dirty = true;
+    }
 
     if (mx * my == 0)
         return;
@@ -25,6 +25,8 @@ private:
     bool _is_next_button(int idx);
     bool _is_prev_button(int idx);
     int _real_item_count();
+
+    tileidx_t m_floor_flavour;
 };
 
 #endif
@@ -12,9 +12,14 @@
 #include "options.h"
 #include "tiles-build-specific.h"
 #include "travel.h"
+#include "unwind.h"
 #include "viewgeom.h"
 
 MapRegion::MapRegion(int pixsz) :
+    m_tex_valid(false),
+    m_changed_min(MAP_TEX_SIZE, MAP_TEX_SIZE),
+    m_changed_max(-1, -1),
+    m_buf_map(true, false, &m_tex),
     m_dirty(true),
     m_far_view(false)
 {
@@ -29,6 +34,7 @@ MapRegion::MapRegion(int pixsz) :
 void MapRegion::on_resize()
 {
     m_buf.fill(0);
+    repaint();
 }
 
 void MapRegion::init_colours()
@@ -62,6 +68,60 @@ void MapRegion::init_colours()
     m_colours[MF_TRANSPORTER]   = Options.tile_transporter_col;
     m_colours[MF_TRANSPORTER_LANDING] = Options.tile_transporter_landing_col;
     m_colours[MF_EXPLORE_HORIZON] = Options.tile_explore_horizon_col;
+
+    repaint();
+}
+
+void MapRegion::set_pixel(int x, int y)
+{
+    m_pixels[x + y * MAP_TEX_SIZE] = m_colours[m_buf[x + y * GXM]];
+
+    m_changed_min.x = min(m_changed_min.x, x);
+    m_changed_min.y = min(m_changed_min.y, y);
+    m_changed_max.x = max(m_changed_max.x, x);
+    m_changed_max.y = max(m_changed_max.y, y);
+}
+
+// Recolour every cell, as after the colours or the whole map have changed.
+void MapRegion::repaint()
+{
+    for (int y = 0; y < GYM; y++)
+        for (int x = 0; x < GXM; x++)
+            set_pixel(x, y);
+}
+
+void MapRegion::upload_texture()
+{
+    if (m_changed_min.x > m_changed_max.x)
+        return;
+
+    // Texture filtering would blur the cells into each other.
+    unwind_bool no_filter(Options.tile_filter_scaling, false);
+
+    if (!m_tex_valid)
+    {
+        m_tex.load_texture((unsigned char *) m_pixels.data(), MAP_TEX_SIZE,
+                           MAP_TEX_SIZE, MIPMAP_NONE);
+        m_tex_valid = true;
+    }
+    else
+    {
+        const int w = m_changed_max.x - m_changed_min.x + 1;
+        const int h = m_changed_max.y - m_changed_min.y + 1;
+        vector<VColour> rect;
+        rect.reserve(w * h);
+        for (int y = m_changed_min.y; y <= m_changed_max.y; y++)
+        {
+            const auto row = m_pixels.begin() + y * MAP_TEX_SIZE;
+            rect.insert(rect.end(), row + m_changed_min.x,
+                        row + m_changed_max.x + 1);
+        }
+        m_tex.load_texture((unsigned char *) rect.data(), w, h, MIPMAP_NONE,
+                           m_changed_min.x, m_changed_min.y);
+    }
+
+    m_changed_min = coord_def(MAP_TEX_SIZE, MAP_TEX_SIZE);
+    m_changed_max = coord_def(-1, -1);
 }
 
 void MapRegion::pack_buffers()
@@ -69,15 +129,12 @@ void MapRegion::pack_buffers()
     m_buf_map.clear();
     m_buf_lines.clear();
 
-    for (int x = m_min_gx; x <= m_max_gx; x++)
-        for (int y = m_min_gy; y <= m_max_gy; y++)
-        {
-            map_feature f = (map_feature)m_buf[x + y * GXM];
-
-            float pos_x = x - m_min_gx;
-            float pos_y = y - m_min_gy;
-            m_buf_map.add(pos_x, pos_y, pos_x + 1, pos_y + 1, m_colours[f]);
-        }
+    GLWPrim rect(0, 0, m_max_gx - m_min_gx + 1, m_max_gy - m_min_gy + 1);
+    rect.set_tex((float) m_min_gx / MAP_TEX_SIZE,
+                 (float) m_min_gy / MAP_TEX_SIZE,
+                 (float) (m_max_gx + 1) / MAP_TEX_SIZE,
+                 (float) (m_max_gy + 1) / MAP_TEX_SIZE);
+    m_buf_map.add_primitive(rect);
 
     // Draw window box.
     if (m_win_start.x == -1 && m_win_end.x == -1)
@@ -101,6 +158,7 @@ void MapRegion::render()
 #ifdef DEBUG_TILES_REDRAW
     cprintf("rendering MapRegion\n");
 #endif
+    upload_texture();
     if (m_dirty)
     {
         pack_buffers();
@@ -120,12 +178,16 @@ void MapRegion::recenter()
     // adjust offsets to center map.
     ox = (wx - dx * (m_max_gx - m_min_gx)) / 2;
     oy = (wy - dy * (m_max_gy - m_min_gy)) / 2;
+
+    // The quad covers the map's extent.
+    m_dirty = true;
 }
 
 void MapRegion::set(const coord_def &gc, map_feature f)
 {
     ASSERT((unsigned int)f <= (unsigned char)~0);
     m_buf[gc.x + gc.y * GXM] = f;
+    set_pixel(gc.x, gc.y);
 
     if (f == MF_UNSEEN)
         return;
@@ -190,6 +252,7 @@ void MapRegion::clear()
     recenter();
 
     m_buf.fill(0);
+    repaint();
     m_buf_map.clear();
     m_buf_lines.clear();
 }
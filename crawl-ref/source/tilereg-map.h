@@ -6,6 +6,11 @@
 #include "map-feature.h"
 #include "tilebuf.h"
 #include "tilereg.h"
+#include "tiletex.h"
+
+// Big enough for a level, and a power of two for older GL.
+#define MAP_TEX_SIZE 128
+COMPILE_CHECK(GXM <= MAP_TEX_SIZE && GYM <= MAP_TEX_SIZE);
 
 class MapRegion : public Region
 {
@@ -26,6 +31,9 @@ protected:
     virtual void on_resize() override;
     void recenter();
     void pack_buffers();
+    void set_pixel(int x, int y);
+    void repaint();
+    void upload_texture();
 
     VColour m_colours[MF_MAX];
     int m_min_gx, m_max_gx, m_min_gy, m_max_gy;
@@ -33,7 +41,15 @@ protected:
     coord_def m_win_end;
     array<unsigned char, GXM*GYM> m_buf;
 
-    ShapeBuffer m_buf_map;
+    // The map is drawn as one quad, textured with a pixel per cell. Cells
+    // that change are coloured in m_pixels, and the rectangle around them
+    // is uploaded when the map is next drawn.
+    array<VColour, MAP_TEX_SIZE * MAP_TEX_SIZE> m_pixels;
+    GenericTexture m_tex;
+    bool m_tex_valid;
+    coord_def m_changed_min, m_changed_max;
+
+    VertBuffer m_buf_map;
     LineBuffer m_buf_lines;
     bool m_dirty;
     bool m_far_view;
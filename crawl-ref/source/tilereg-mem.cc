@@ -17,6 +17,7 @@
 #include "tilepick.h"
 #include "tilereg-cmd.h"
 #include "tiles-build-specific.h"
+#include "unwind.h"
 
 MemoriseRegion::MemoriseRegion(const TileRegionInit &init) : SpellRegion(init)
 {
@@ -124,8 +125,9 @@ bool MemoriseRegion::update_tip_text(string& tip)
 
 void MemoriseRegion::update()
 {
-    m_items.clear();
-    m_dirty = true;
+    vector<InventoryTile> old_items;
+    old_items.swap(m_items);
+    ON_UNWIND { finish_update(old_items); };
 
     if (mx * my == 0)
         return;
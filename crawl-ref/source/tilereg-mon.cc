@@ -39,9 +39,7 @@ void MonsterRegion::update()
     if (max_mons == 0)
         return;
 
-    get_monster_info(m_mon_info);
-    sort(m_mon_info.begin(), m_mon_info.end(),
-              monster_info::less_than_wrapper);
+    m_mon_info = get_monster_info();
 
     unsigned int num_mons = min(max_mons, m_mon_info.size());
     for (size_t i = 0; i < num_mons; ++i)
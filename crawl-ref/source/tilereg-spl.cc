@@ -20,6 +20,7 @@
 #include "tilepick.h"
 #include "tiles-build-specific.h"
 #include "tilereg-cmd.h"
+#include "unwind.h"
 
 SpellRegion::SpellRegion(const TileRegionInit &init) : GridRegion(init)
 {
@@ -192,8 +193,9 @@ void SpellRegion::pack_buffers()
 
 void SpellRegion::update()
 {
-    m_items.clear();
-    m_dirty = true;
+    vector<InventoryTile> old_items;
+    old_items.swap(m_items);
+    ON_UNWIND { finish_update(old_items); };
 
     if (mx * my == 0)
         return;
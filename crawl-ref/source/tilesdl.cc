@@ -606,9 +606,25 @@ int TilesFramework::getch_ck()
         if (crawl_state.seen_hups)
             return ESCAPE;
 
+        // Redraw at most once a frame: if the last one was too recent,
+        // handle events until this one is due. Nothing to redraw, nothing
+        // to wake up for.
+        int timeout = INT_MAX;
+        if (!mouse_target_mode && need_redraw())
+        {
+            const unsigned int since = wm->get_ticks() - m_last_tick_redraw;
+            if (since >= wm->frame_ms())
+            {
+                last_redraw_loc = m_cur_loc;
+                redraw();
+            }
+            else
+                timeout = wm->frame_ms() - since;
+        }
+
         unsigned int ticks = 0;
 
-        if (wm->wait_event(&event, INT_MAX))
+        if (wm->wait_event(&event, timeout))
         {
             ticks = wm->get_ticks();
             if (!mouse_target_mode && event.type != WME_CUSTOMEVENT)
@@ -791,12 +807,10 @@ int TilesFramework::getch_ck()
                 m_tooltip.clear();
             }
 
-            if (need_redraw()
-                || ticks > m_last_tick_redraw
-                   && ticks - m_last_tick_redraw > ticks_per_screen_redraw)
+            if (ticks > m_last_tick_redraw
+                && ticks - m_last_tick_redraw > ticks_per_screen_redraw)
             {
-                last_redraw_loc = m_cur_loc;
-                redraw();
+                set_need_redraw();
             }
         }
     }
@@ -178,6 +178,8 @@ bool ImageManager::load_textures(bool need_mips)
     MipMapOptions mip = need_mips ?
         MIPMAP_CREATE : MIPMAP_NONE;
 
+    wm->preload_images(get_texture_filenames());
+
     int i = 0;
     for (const auto &f : get_texture_filenames())
         if (!m_textures[i++].load_texture(f.c_str(), mip))
@@ -893,7 +893,10 @@ void tile_draw_floor()
             const coord_def ep(cx, cy);
             const coord_def gc = show2grid(ep);
 
-            tileidx_t bg = _get_floor_bg(gc);
+            // Cells out of sight are drawn from memory (see
+            // tileidx_out_of_los()), so don't work out their terrain again.
+            tileidx_t bg = map_bounds(gc) && !you.see_cell(gc)
+                               ? tile_env.bk_bg(gc) : _get_floor_bg(gc);
 
             // init tiles
             tile_env.bg(ep) = bg;
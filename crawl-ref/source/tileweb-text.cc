@@ -9,6 +9,20 @@
 #include "tiles-build-specific.h"
 #include "unicode.h"
 
+// FNV-1a over a row's characters and colours, for finding rows the client
+// already has.
+static uint32_t _row_hash(const char32_t *chars, const uint8_t *cols,
+                          int width)
+{
+    uint32_t hash = 2166136261u;
+    for (int x = 0; x < width; ++x)
+    {
+        hash = (hash ^ chars[x]) * 16777619u;
+        hash = (hash ^ cols[x]) * 16777619u;
+    }
+    return hash;
+}
+
 WebTextArea::WebTextArea(string name) :
     mx(0),
     my(0),
@@ -16,6 +30,7 @@ WebTextArea::WebTextArea(string name) :
     m_abuf(nullptr),
     m_old_cbuf(nullptr),
     m_old_abuf(nullptr),
+    m_old_hash(nullptr),
     m_client_side_name(name),
     m_dirty(true)
 {
@@ -29,6 +44,7 @@ WebTextArea::~WebTextArea()
         delete[] m_abuf;
         delete[] m_old_cbuf;
         delete[] m_old_abuf;
+        delete[] m_old_hash;
     }
 }
 
@@ -46,6 +62,7 @@ void WebTextArea::resize(int x, int y)
         delete[] m_abuf;
         delete[] m_old_cbuf;
         delete[] m_old_abuf;
+        delete[] m_old_hash;
     }
 
     int size = mx * my;
@@ -53,6 +70,7 @@ void WebTextArea::resize(int x, int y)
     m_abuf = new uint8_t[size];
     m_old_cbuf = new char32_t[size];
     m_old_abuf = new uint8_t[size];
+    m_old_hash = new uint32_t[my];
 
     for (int i = 0; i < mx * my; i++)
     {
@@ -61,6 +79,11 @@ void WebTextArea::resize(int x, int y)
         m_old_cbuf[i] = ' ';
         m_old_abuf[i] = 0;
     }
+    for (int row = 0; row < my; row++)
+    {
+        m_old_hash[row] = _row_hash(m_old_cbuf + row * mx,
+                                    m_old_abuf + row * mx, mx);
+    }
 
     m_dirty = true;
 
@@ -91,6 +114,83 @@ void WebTextArea::put_character(char32_t chr, int fg, int bg, int x, int y)
     m_abuf[x + y * mx] = col;
 }
 
+// Is a black-background space, which shows the same in any colour.
+static bool _is_blank(char32_t chr, uint8_t col)
+{
+    return chr == ' ' && !(col >> 4);
+}
+
+// Write a row as the client wants it: "" if it's blank, and otherwise
+// [text, colour, length, colour, length, ...], where the colour runs
+// cover the text in order, in UTF-16 units, and a colour is fg + 16 * bg,
+// or -1 for the blanks at the start. Blanks at the end are left out, and
+// the others join the run before them, so that the colour only changes
+// where it shows.
+static void _send_row(const char32_t *chars, const uint8_t *cols, int width)
+{
+    string text;
+    vector<int> runs;
+    int col = -1;
+    int run_len = 0;
+    int blanks = 0;
+    for (int x = 0; x < width; ++x)
+    {
+        if (_is_blank(chars[x], cols[x]))
+        {
+            ++blanks;
+            continue;
+        }
+        text.append(blanks, ' ');
+        run_len += blanks;
+        blanks = 0;
+
+        if (cols[x] != col)
+        {
+            if (run_len)
+            {
+                runs.push_back(col);
+                runs.push_back(run_len);
+            }
+            col = cols[x];
+            run_len = 0;
+        }
+
+        char buf[5];
+        buf[wctoutf8(buf, chars[x])] = 0;
+        text += buf;
+        run_len += chars[x] > 0xFFFF ? 2 : 1;
+    }
+
+    if (text.empty())
+    {
+        tiles.json_write_string("");
+        return;
+    }
+
+    runs.push_back(col);
+    runs.push_back(run_len);
+    tiles.json_open_array();
+    tiles.json_write_string(text);
+    for (int n : runs)
+        tiles.json_write_int(n);
+    tiles.json_close_array();
+}
+
+static bool _rows_equal(const char32_t *chars_a, const uint8_t *cols_a,
+                        const char32_t *chars_b, const uint8_t *cols_b,
+                        int width)
+{
+    return !memcmp(chars_a, chars_b, width * sizeof(*chars_a))
+           && !memcmp(cols_a, cols_b, width * sizeof(*cols_a));
+}
+
+/**
+ * Send the rows that changed since the last time. A row that the client
+ * already shows somewhere else, as after scrolling, is copied from there
+ * instead of being sent again: the "copy" object maps the row to where
+ * it was. With force, every row that isn't blank is sent, for a client
+ * that has nothing yet.
+ */
 void WebTextArea::send(bool force)
 {
     if (m_cbuf == nullptr)
@@ -99,102 +199,76 @@ void WebTextArea::send(bool force)
         return;
     m_dirty = false;
 
-    int last_col = -1;
-    int space_count = 0;
-    bool dirty = false;
-    string html;
+    vector<bool> changed(my);
+    vector<uint32_t> hash(my);
+    for (int y = 0; y < my; ++y)
+    {
+        const int row = y * mx;
+        changed[y] = !_rows_equal(m_cbuf + row, m_abuf + row,
+                                  m_old_cbuf + row, m_old_abuf + row, mx);
+        hash[y] = changed[y] ? _row_hash(m_cbuf + row, m_abuf + row, mx)
+                             : m_old_hash[y];
+    }
 
     bool sending = false;
-
+    vector<pair<int, int> > copies;
     for (int y = 0; y < my; ++y)
     {
-        last_col = -1;
-        space_count = 0;
-        dirty = false;
-        html.clear();
+        const int row = y * mx;
+        bool blank = true;
+        for (int x = 0; x < mx && blank; ++x)
+            blank = _is_blank(m_cbuf[row + x], m_abuf[row + x]);
+        if (!changed[y] && (!force || blank))
+            continue;
 
-        for (int x = 0; x < mx; ++x)
+        if (!sending)
         {
-            char32_t chr = m_cbuf[x + y * mx];
-            uint8_t col = m_abuf[x + y * mx];
-
-            if (chr != m_old_cbuf[x + y * mx] ||
-                col != m_old_abuf[x + y * mx])
-            {
-                dirty = true;
-                m_old_cbuf[x + y * mx] = chr;
-                m_old_abuf[x + y * mx] = col;
-            }
-
-            if (chr != ' ' || ((col >> 4) & 0xF) != 0)
-            {
-                while (space_count)
-                {
-                    html.push_back(' ');
-                    space_count--;
-                }
-            }
-
-            if (col != last_col && chr != ' ')
-            {
-                if (last_col != -1)
-                    html += "</span>";
-                html += make_stringf("<span class=\\\"fg%d bg%d\\\">",
-                                     col & 0xf, (col >> 4) & 0xf);
-                last_col = col;
-            }
-
-            if (chr == ' ' && ((col >> 4) & 0xF) == 0)
-                space_count++;
-            else
-            {
-                switch (chr)
-                {
-                case '<':
-                    html += "&lt;";
-                    break;
-                case '>':
-                    html += "&gt;";
-                    break;
-                case '&':
-                    html += "&amp;";
-                    break;
-                case '\\':
-                    html += "\\\\";
-                    break;
-                case '"':
-                    html += "&quot;";
-                    break;
-                default:
-                    char buf[5];
-                    buf[wctoutf8(buf, chr)] = 0;
-                    html += buf;
-                    break;
-                }
-            }
+            tiles.write_message("{\"msg\":\"txt\",\"id\":\"%s\"",
+                                m_client_side_name.c_str());
+            if (force)
+                tiles.write_message(",\"clear\":true");
+            tiles.json_open_object("lines");
+            sending = true;
         }
 
-        if (dirty || (force && !html.empty()))
+        int from = -1;
+        for (int z = 0; !force && !blank && z < my && from < 0; ++z)
         {
-            if (!sending)
+            if (z != y && m_old_hash[z] == hash[y]
+                && _rows_equal(m_cbuf + row, m_abuf + row,
+                               m_old_cbuf + z * mx, m_old_abuf + z * mx, mx))
             {
-                tiles.write_message("{\"msg\":\"txt\",\"id\":\"%s\"",
-                                    m_client_side_name.c_str());
-                if (force)
-                    tiles.write_message(",\"clear\":true");
-                tiles.write_message(",\"lines\":{");
-                sending = true;
+                from = z;
             }
-
-            tiles.json_write_comma();
-            tiles.write_message("\"%u\":\"%s\"", y, html.c_str());
         }
+        if (from >= 0)
+        {
+            copies.emplace_back(y, from);
+            continue;
+        }
+
+        tiles.json_write_name(to_string(y));
+        _send_row(m_cbuf + row, m_abuf + row, mx);
     }
+
     if (sending)
     {
-        tiles.write_message("}}");
+        tiles.json_close_object();
+        if (!copies.empty())
+        {
+            tiles.json_open_object("copy");
+            for (const auto &copy : copies)
+                tiles.json_write_int(to_string(copy.first), copy.second);
+            tiles.json_close_object();
+        }
+        tiles.write_message("}");
         tiles.finish_message();
     }
+
+    memcpy(m_old_cbuf, m_cbuf, mx * my * sizeof(*m_cbuf));
+    memcpy(m_old_abuf, m_abuf, mx * my * sizeof(*m_abuf));
+    for (int y = 0; y < my; ++y)
+        m_old_hash[y] = hash[y];
 }
 
 void WebTextArea::on_resize()
@@ -23,8 +23,10 @@ protected:
     char32_t *m_cbuf; // Character buffer
     uint8_t *m_abuf; // Color buffer
 
+    // What the client has.
     char32_t *m_old_cbuf;
     uint8_t *m_old_abuf;
+    uint32_t *m_old_hash; // by row
 
     string m_client_side_name;
 
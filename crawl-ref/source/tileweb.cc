@@ -4,9 +4,13 @@
 
 #include "tileweb.h"
 
+#include <atomic>
 #include <cerrno>
 #include <cstdarg>
+#include <cstring>
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/types.h>
@@ -20,6 +24,7 @@
 #include "command.h"
 #include "coord.h"
 #include "database.h"
+#include "dbg-mem.h"
 #include "describe.h"
 #include "directn.h"
 #include "english.h"
@@ -85,6 +90,12 @@ TilesFramework tiles;
 
 TilesFramework::TilesFramework() :
       m_controlled_from_web(false),
+      m_need_flush(false),
+      m_need_resync(false),
+      m_next_ring_id(0),
+      m_keyframe_dest(nullptr),
+      m_animation_depth(0),
+      m_animation_behind(false),
       _send_lock(false),
       m_last_ui_state(UI_INIT),
       m_view_loaded(false),
@@ -113,6 +124,8 @@ void TilesFramework::shutdown()
     if (m_sock_name.empty())
         return;
 
+    // Give the server a last chance at the exit messages.
+    _drain_queues(5000);
     close(m_sock);
     remove(m_sock_name.c_str());
 }
@@ -187,13 +200,138 @@ void TilesFramework::write_message(const char *format, ...)
     m_msg_buf.append(buf);
 }
 
+// A receiver with this much unsent is taken to be stuck, and is dropped to
+// resyncs only; see Receiver.
+static const size_t MAX_QUEUED_BYTES = 2 * 1024 * 1024;
+
+// Room for a couple of _send_everything()s.
+static const size_t RING_CAPACITY = 4 * 1024 * 1024;
+
+static const char RING_DOORBELL[] = "*{\"msg\":\"ring\"}\n";
+
+/*
+  A shared memory ring of messages for one receiver. The layout is mirrored
+  by webserver/webtiles/connection.py, which maps the file by name.
+
+  Both positions only ever grow; the data lives at pos % capacity. Messages
+  are written whole before write_pos moves past them, so the server never
+  sees half of one.
+ */
+struct webtiles_ring_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+    char pad0[48];
+    atomic<uint64_t> write_pos; // only written by us
+    char pad1[56];
+    atomic<uint64_t> read_pos;  // only written by the server
+    char pad2[56];
+};
+COMPILE_CHECK(sizeof(webtiles_ring_header) == 192);
+
+static const uint32_t RING_MAGIC = 0x52575243; // "CRWR"
+static const uint32_t RING_VERSION = 1;
+
+class webtiles_ring
+{
+public:
+    static shared_ptr<webtiles_ring> create(const string &path,
+                                            size_t capacity);
+    ~webtiles_ring();
+
+    webtiles_ring(const webtiles_ring&) = delete;
+    webtiles_ring &operator=(const webtiles_ring&) = delete;
+
+    size_t capacity() const { return m_capacity; }
+
+    // Has the server read everything written so far?
+    bool drained() const
+    {
+        return m_hdr->read_pos.load(memory_order_acquire) == m_write_pos;
+    }
+    bool write(const string &msg);
+    void publish()
+    {
+        m_hdr->write_pos.store(m_write_pos, memory_order_release);
+    }
+
+private:
+    webtiles_ring(const string &path, int fd, void *map, size_t capacity)
+        : m_path(path), m_fd(fd), m_capacity(capacity),
+          m_hdr(static_cast<webtiles_ring_header *>(map)),
+          m_data(static_cast<char *>(map) + sizeof(webtiles_ring_header)),
+          m_write_pos(0)
+    {
+    }
+
+    string m_path;
+    int m_fd;
+    size_t m_capacity;
+    webtiles_ring_header *m_hdr;
+    char *m_data;
+    uint64_t m_write_pos; // including what isn't published yet
+};
+
+shared_ptr<webtiles_ring> webtiles_ring::create(const string &path,
+                                                size_t capacity)
+{
+    const size_t map_size = sizeof(webtiles_ring_header) + capacity;
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+        return nullptr;
+    void *map = MAP_FAILED;
+    if (ftruncate(fd, map_size) == 0)
+    {
+        map = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fd, 0);
+    }
+    if (map == MAP_FAILED)
+    {
+        close(fd);
+        unlink(path.c_str());
+        return nullptr;
+    }
+
+    // ftruncate zero-fills, which is where both positions start.
+    webtiles_ring_header *hdr = static_cast<webtiles_ring_header *>(map);
+    hdr->magic = RING_MAGIC;
+    hdr->version = RING_VERSION;
+    hdr->capacity = capacity;
+    return shared_ptr<webtiles_ring>(new webtiles_ring(path, fd, map,
+                                                       capacity));
+}
+
+webtiles_ring::~webtiles_ring()
+{
+    munmap(m_hdr, sizeof(webtiles_ring_header) + m_capacity);
+    close(m_fd);
+    // The server normally unlinks this as soon as it has it mapped.
+    unlink(m_path.c_str());
+}
+
+/// Copy a whole message in, if there's room; it's seen once published.
+bool webtiles_ring::write(const string &msg)
+{
+    const uint64_t used = m_write_pos
+                          - m_hdr->read_pos.load(memory_order_acquire);
+    if (msg.size() > m_capacity - used)
+        return false;
+
+    const size_t start = m_write_pos % m_capacity;
+    const size_t first = min(msg.size(), m_capacity - start);
+    memcpy(m_data + start, msg.data(), first);
+    memcpy(m_data, msg.data() + first, msg.size() - first);
+    m_write_pos += msg.size();
+    return true;
+}
+
 void TilesFramework::finish_message()
 {
     if (m_msg_buf.size() == 0)
         return;
 #ifdef DEBUG_WEBSOCKETS
-    const int initial_buf_size = m_msg_buf.size();
-    fprintf(stderr, "websocket: About to send %d bytes.\n", initial_buf_size);
+    fprintf(stderr, "websocket: Queueing %d bytes.\n", (int) m_msg_buf.size());
 #endif
 
     if (m_sock_name.empty())
@@ -203,86 +341,309 @@ void TilesFramework::finish_message()
     }
 
     m_msg_buf.append("\n");
-    const char* fragment_start = m_msg_buf.data();
-    const char* data_end = m_msg_buf.data() + m_msg_buf.size();
-    int fragments = 0;
-    while (fragment_start < data_end)
-    {
-        int fragment_size = data_end - fragment_start;
-        if (fragment_size > m_max_msg_size)
-            fragment_size = m_max_msg_size;
-        fragments++;
+    // Copy rather than move out of the buffer, so that it keeps its
+    // capacity: each message then costs one allocation of the right size,
+    // instead of regrowing the buffer from nothing.
+    _queue_message(make_shared<const string>(m_msg_buf));
+    m_msg_buf.clear();
+    m_need_flush = true;
 
-        for (unsigned int i = 0; i < m_dest_addrs.size(); ++i)
+    // Messages normally go out in a burst from flush_messages(), but don't
+    // let a long stretch without one build up more than the socket buffer.
+    for (const Receiver &rcv : m_receivers)
+        if (rcv.queued_bytes >= 64 * 1024)
         {
-            int retries = 30;
-            ssize_t sent = 0;
-            while (sent < fragment_size)
-            {
-                ssize_t retval = sendto(m_sock, fragment_start + sent,
-                    fragment_size - sent, 0, (sockaddr*) &m_dest_addrs[i],
-                    sizeof(sockaddr_un));
+            _send_all_queued();
+            break;
+        }
+
 #ifdef DEBUG_WEBSOCKETS
-                fprintf(stderr,
-                            "    trying to send fragment to client %d...", i);
+    // should the game actually crash in this case?
+    if (m_controlled_from_web && m_receivers.size() == 0)
+        fprintf(stderr, "No open websockets after finish_message!!\n");
 #endif
-                if (retval <= 0)
-                {
-                    const char *errmsg = retval == 0 ? "No bytes sent"
-                                                     : strerror(errno);
-                    if (--retries <= 0)
-                        die("Socket write error: %s", errmsg);
+}
 
-                    if (retval == 0 || errno == ENOBUFS || errno == EWOULDBLOCK
-                        || errno == EINTR || errno == EAGAIN)
-                    {
-                        // Wait for half a second at first (up to five), then
-                        // try again.
-                        const int sleep_time = retries > 25 ? 2 * 1000
-                                             : retries > 10 ? 500 * 1000
-                                             : 5000 * 1000;
+void TilesFramework::_queue_message(const shared_ptr<const string> &msg)
+{
+    // Messages for the server itself (exit reasons, milestones, ...) are
+    // never dropped.
+    const bool server_msg = (*msg)[0] == '*';
+
+    for (Receiver &rcv : m_receivers)
+    {
+        if (rcv.lagging && !server_msg)
+            continue;
+        if (m_keyframe_dest
+            && strcmp(rcv.addr.sun_path, m_keyframe_dest->sun_path) != 0)
+        {
+            continue;
+        }
+
+        rcv.queue.push_back(msg);
+        rcv.queued_bytes += msg->size();
+        if (rcv.lagging || rcv.queued_bytes <= MAX_QUEUED_BYTES)
+            continue;
+
+        // Drop every update it hasn't started on; it gets everything anew
+        // once it has caught up with the rest.
 #ifdef DEBUG_WEBSOCKETS
-                        fprintf(stderr, "failed (%s), sleeping for %dms.\n",
-                                                    errmsg, sleep_time / 1000);
+        fprintf(stderr, "websocket: receiver is %u bytes behind, dropping "
+                        "updates.\n", (unsigned int) rcv.queued_bytes);
 #endif
-                        usleep(sleep_time);
-                    }
-                    else if (errno == ECONNREFUSED || errno == ENOENT)
-                    {
-                        // the other side is dead
+        deque<shared_ptr<const string>> kept;
+        rcv.queued_bytes = 0;
+        for (unsigned int i = 0; i < rcv.queue.size(); ++i)
+        {
+            // A half-sent message has to be finished.
+            if ((i == 0 && rcv.sent) || (*rcv.queue[i])[0] == '*')
+            {
+                kept.push_back(rcv.queue[i]);
+                rcv.queued_bytes += rcv.queue[i]->size();
+            }
+        }
+        rcv.queued_bytes -= rcv.sent;
+        rcv.queue.swap(kept);
+        rcv.lagging = true;
+    }
+}
+
+/**
+ * Send as much of a receiver's queue as it will take without blocking.
+ *
+ * @return false if the receiver has gone away.
+ */
+bool TilesFramework::_send_queued(Receiver &rcv)
+{
+    bool full = false;
+    while (!rcv.queue.empty() && !full)
+    {
+        // The ring's announcement goes by socket, ahead of everything else.
+        if (rcv.ring && !rcv.ring_hello)
+        {
+            if (!_send_to_ring(rcv, full))
+                return false;
+        }
+        else
+        {
+            if (!_send_datagrams(rcv, full))
+                return false;
+            if (!full)
+                rcv.ring_hello = false;
+        }
+    }
+
+    while (rcv.ring_doorbell)
+    {
+        const ssize_t retval = sendto(m_sock, RING_DOORBELL,
+                                      strlen(RING_DOORBELL), MSG_DONTWAIT,
+                                      (sockaddr*) &rcv.addr,
+                                      sizeof(sockaddr_un));
+        if (retval > 0)
+            rcv.ring_doorbell = false;
+        else if (retval < 0 && (errno == ECONNREFUSED || errno == ENOENT))
+            return false;
+        else if (retval == 0 || errno != EINTR)
+            break; // ring it on the next try
+    }
+
+    if (rcv.lagging && rcv.queue.empty())
+    {
+        rcv.lagging = false;
+        m_need_resync = true;
+    }
+    return true;
+}
+
+/**
+ * Send the message at the front of a receiver's queue over the socket.
+ *
+ * @param full set if the socket wouldn't take all of it for now.
+ * @return false if the receiver has gone away.
+ */
+bool TilesFramework::_send_datagrams(Receiver &rcv, bool &full)
+{
+    const string &msg = *rcv.queue.front();
+    while (rcv.sent < msg.size())
+    {
+        // The server expects each datagram to hold part of just one
+        // message, so don't pack several together.
+        const size_t size = min<size_t>(msg.size() - rcv.sent,
+                                        m_max_msg_size);
+        const ssize_t retval = sendto(m_sock, msg.data() + rcv.sent, size,
+                                      MSG_DONTWAIT, (sockaddr*) &rcv.addr,
+                                      sizeof(sockaddr_un));
+        if (retval < 0 && errno == EINTR)
+            continue;
+        if (retval <= 0)
+        {
+            // Full up: try again on the next flush. Note that select()
+            // can't tell us when, since the receiver's queue is what's full.
+            if (retval == 0 || errno == EAGAIN || errno == EWOULDBLOCK
+                || errno == ENOBUFS)
+            {
+                full = true;
+                return true;
+            }
+            // the other side is dead
+            if (errno == ECONNREFUSED || errno == ENOENT)
+                return false;
+            die("Socket write error: %s", strerror(errno));
+        }
+
+        rcv.sent += retval;
+        rcv.queued_bytes -= retval;
+    }
+
+    rcv.queue.pop_front();
+    rcv.sent = 0;
+    return true;
+}
+
+/**
+ * Copy as many whole messages from a receiver's queue into its ring as
+ * will fit. The doorbell for them is rung by _send_queued().
+ *
+ * @param full set if the ring wouldn't take any more for now.
+ * @return false if the receiver has gone away.
+ */
+bool TilesFramework::_send_to_ring(Receiver &rcv, bool &full)
+{
+    webtiles_ring &ring = *rcv.ring;
+    while (!rcv.queue.empty() && !full)
+    {
+        const string &msg = *rcv.queue.front();
+        if (msg.size() > ring.capacity() || rcv.sent)
+        {
+            // Too big to ever fit: send it by socket instead, but only
+            // once the server has read everything before it.
+            if (!rcv.sent && (rcv.ring_doorbell || !ring.drained()))
+            {
+                full = true;
+                break;
+            }
+            if (!_send_datagrams(rcv, full))
+                return false;
+            continue;
+        }
+        if (!ring.write(msg))
+        {
+            full = true;
+            break;
+        }
+        rcv.queued_bytes -= msg.size();
+        rcv.queue.pop_front();
+        rcv.ring_doorbell = true;
+    }
+
+    ring.publish();
+    return true;
+}
+
+/// Set up a shared memory ring for a receiver that asked for one.
+void TilesFramework::_open_ring(Receiver &rcv)
+{
+    const string path = make_stringf("%s.ring%d", m_sock_name.c_str(),
+                                     m_next_ring_id++);
+    rcv.ring = webtiles_ring::create(path, RING_CAPACITY);
+    if (!rcv.ring)
+    {
+        // It just stays on the socket.
 #ifdef DEBUG_WEBSOCKETS
-                        fprintf(stderr,
-                            "failed (%s), breaking.\n", errmsg);
+        fprintf(stderr, "websocket: Can't create ring %s: %s\n",
+                path.c_str(), strerror(errno));
 #endif
-                        m_dest_addrs.erase(m_dest_addrs.begin() + i);
-                        i--;
-                        break;
-                    }
-                    else
-                        die("Socket write error: %s", errmsg);
-                }
-                else
-                {
+        return;
+    }
+
+    // Don't disturb a message that's being built.
+    string saved;
+    saved.swap(m_msg_buf);
+    json_open_object();
+    json_write_string("msg", "ring");
+    json_write_string("path", path);
+    json_write_int("size", (int) RING_CAPACITY);
+    json_close_object();
+    auto hello = make_shared<const string>("*" + m_msg_buf + "\n");
+    m_msg_buf.swap(saved);
+
+    rcv.queue.push_front(hello);
+    rcv.queued_bytes += hello->size();
+    rcv.ring_hello = true;
+}
+
+/// Try to send what's queued for every receiver. Returns true if it all went.
+bool TilesFramework::_send_all_queued()
+{
+    for (unsigned int i = 0; i < m_receivers.size(); ++i)
+    {
+        if (!_send_queued(m_receivers[i]))
+        {
 #ifdef DEBUG_WEBSOCKETS
-                    fprintf(stderr, "fragment size %d sent.\n", fragment_size);
+            fprintf(stderr, "websocket: receiver %d is gone.\n", i);
 #endif
-                    sent += retval;
-                }
-            }
+            m_receivers.erase(m_receivers.begin() + i);
+            i--;
         }
+    }
+    return !_has_queued();
+}
 
-        fragment_start += fragment_size;
+bool TilesFramework::_has_queued() const
+{
+    for (const Receiver &rcv : m_receivers)
+        if (!rcv.queue.empty() || rcv.ring_doorbell)
+            return true;
+    return false;
+}
+
+/// Keep trying to send what's queued, for at most timeout_ms.
+void TilesFramework::_drain_queues(int timeout_ms)
+{
+    const unsigned int start = get_milliseconds();
+    while (!_send_all_queued()
+           && get_milliseconds() - start < (unsigned int) timeout_ms)
+    {
+        usleep(10 * 1000);
     }
-    m_msg_buf.clear();
-    m_need_flush = true;
-#ifdef DEBUG_WEBSOCKETS
-    // should the game actually crash in this case?
-    if (m_controlled_from_web && m_dest_addrs.size() == 0)
-        fprintf(stderr, "No open websockets after finish_message!!\n");
+}
 
-    fprintf(stderr, "websocket: Sent %d bytes in %d fragments.\n",
-                                                initial_buf_size, fragments);
-#endif
+/*
+  Everything from _send_everything() is bracketed as a keyframe. The server
+  caches the last one along with what followed it, and serves new spectators
+  from that rather than asking us for everything again.
+ */
+
+/// Send everything again to all receivers, as for a new spectator.
+void TilesFramework::_resync_receivers()
+{
+    m_need_resync = false;
+    flush_messages();
+    send_message("*{\"msg\":\"keyframe_start\",\"shared\":true}");
+    _send_everything();
+    send_message("*{\"msg\":\"keyframe_end\"}");
+    flush_messages();
+}
+
+/**
+ * Send a fresh keyframe to just one receiver, whose cache of updates since
+ * the last one has grown too long. Nobody else needs it, since it only
+ * repeats what they've already been sent.
+ */
+void TilesFramework::_send_keyframe(const sockaddr_un &addr)
+{
+    // Pending updates have to go to everyone first.
+    redraw();
+    flush_messages();
+
+    // Don't let the keyframe's full map stand in for one everyone is owed.
+    unwind_bool full_map(m_need_full_map);
+    m_keyframe_dest = &addr;
+    send_message("*{\"msg\":\"keyframe_start\"}");
+    _send_everything();
+    send_message("*{\"msg\":\"keyframe_end\"}");
+    m_keyframe_dest = nullptr;
+    flush_messages();
 }
 
 void TilesFramework::send_message(const char *format, ...)
@@ -318,6 +679,7 @@ void TilesFramework::flush_messages()
         send_message("*{\"msg\":\"flush_messages\"}");
         m_need_flush = false;
     }
+    _send_all_queued();
 }
 
 void TilesFramework::_await_connection()
@@ -325,7 +687,7 @@ void TilesFramework::_await_connection()
     if (m_sock_name.empty())
         return;
 
-    while (m_dest_addrs.size() == 0)
+    while (m_receivers.size() == 0)
         _receive_control_message();
 }
 
@@ -436,7 +798,12 @@ wint_t TilesFramework::_handle_control_message(sockaddr_un addr, string data)
         JsonWrapper primary = json_find_member(obj.node, "primary");
         primary.check(JSON_BOOL);
 
-        m_dest_addrs.push_back(addr);
+        Receiver rcv;
+        rcv.addr = addr;
+        JsonWrapper shm = json_find_member(obj.node, "shm");
+        if (shm.node && shm->tag == JSON_BOOL && shm->bool_)
+            _open_ring(rcv);
+        m_receivers.push_back(move(rcv));
         m_controlled_from_web = primary->bool_;
     }
     else if (msgtype == "key")
@@ -448,11 +815,9 @@ wint_t TilesFramework::_handle_control_message(sockaddr_un addr, string data)
         c = (int) keycode->number_;
     }
     else if (msgtype == "spectator_joined")
-    {
-        flush_messages();
-        _send_everything();
-        flush_messages();
-    }
+        _resync_receivers();
+    else if (msgtype == "keyframe")
+        _send_keyframe(addr);
     else if (msgtype == "menu_hover")
     {
         JsonWrapper hover = json_find_member(obj.node, "hover");
@@ -624,8 +989,17 @@ bool TilesFramework::await_input(wint_t& c, bool block)
 
             if (block)
             {
+                if (m_need_resync)
+                    _resync_receivers();
                 tiles.flush_messages();
-                result = select(maxfd + 1, &fds, nullptr, nullptr, nullptr);
+
+                // If a receiver is behind, retry its sends every so often
+                // rather than wait on it with select(); see _send_queued().
+                timeval retry;
+                retry.tv_sec = 0;
+                retry.tv_usec = 50 * 1000;
+                result = select(maxfd + 1, &fds, nullptr, nullptr,
+                                _has_queued() ? &retry : nullptr);
             }
             else
             {
@@ -639,7 +1013,11 @@ bool TilesFramework::await_input(wint_t& c, bool block)
         while (result == -1 && errno == EINTR);
 
         if (result == 0)
+        {
+            if (block)
+                continue;
             return false;
+        }
         else if (result > 0)
         {
             if (!m_sock_name.empty() && FD_ISSET(m_sock, &fds))
@@ -724,6 +1102,21 @@ void TilesFramework::send_milestone(const xlog_fields &xl)
     finish_message();
 }
 
+void TilesFramework::send_memory_stats()
+{
+    JsonWrapper j(json_mkobject());
+    json_append_member(j.node, "msg", json_mkstring("memory"));
+    json_append_member(j.node, "turn", json_mknumber(you.num_turns));
+    json_append_member(j.node, "rss", json_mknumber(process_rss()));
+    JsonNode *areas = json_mkobject();
+    for (const mem_area &area : memory_usage())
+        json_append_member(areas, area.name.c_str(), json_mknumber(area.bytes));
+    json_append_member(j.node, "areas", areas);
+    write_message("*");
+    write_message("%s", j.to_string().c_str());
+    finish_message();
+}
+
 void TilesFramework::send_options()
 {
     json_open_object();
@@ -1216,6 +1609,15 @@ void TilesFramework::_send_player(bool force_full)
     json_open_object("inv");
     for (unsigned int i = 0; i < ENDOFPACK; ++i)
     {
+        // Most slots are empty, and stay that way; _send_item() would send
+        // nothing for them, so don't make it build their info.
+        if (!force_full && !you.inv[i].defined() && !c.inv[i].defined()
+            && you.inv[i].base_type == c.inv[i].base_type
+            && you.inv[i].quantity == c.inv[i].quantity)
+        {
+            continue;
+        }
+
         json_open_object(to_string(i));
         item_def item = get_item_known_info(you.inv[i]);
         if ((char)i == you.equip[EQ_WEAPON] && is_weapon(item) && you.corrosion_amount())
@@ -1313,12 +1715,6 @@ void TilesFramework::_send_item(item_def& current, const item_def& next,
 
     changed |= _update_int(force_full, current.sub_type, next.sub_type,
                            "sub_type", false);
-    if (Options.action_panel_glyphs)
-    {
-        string cur_glyph = force_full ? "" : stringize_glyph(get_item_glyph(current).ch);
-        string next_glyph = !defined ? "" : stringize_glyph(get_item_glyph(next).ch);
-        changed |= _update_string(force_full, cur_glyph, next_glyph, "g", false);
-    }
     if (is_xp_evoker(next))
     {
         short int next_charges = evoker_charges(next.sub_type);
@@ -1346,6 +1742,15 @@ void TilesFramework::_send_item(item_def& current, const item_def& next,
     // Derived stuff
     if (changed && defined)
     {
+        // Glyph overrides can match on the name, so this is only worth
+        // checking when the name might have changed too.
+        if (Options.action_panel_glyphs)
+        {
+            string cur_glyph = force_full ? "" : stringize_glyph(get_item_glyph(current).ch);
+            string next_glyph = stringize_glyph(get_item_glyph(next).ch);
+            _update_string(force_full, cur_glyph, next_glyph, "g", false);
+        }
+
         string name = next.name(DESC_A, true, false, true);
         if (force_full || current.name(DESC_A, true, false, true) != name
             || xp_evoker_changed)
@@ -1840,7 +2245,12 @@ void TilesFramework::_send_map(bool force_full)
 
     force_full = force_full || m_need_full_map;
     m_need_full_map = false;
+    if (force_full && m_animation_base)
+        m_animation_base->full_map = true;
 
+    // The server recognises map messages by this prefix, to re-encode them
+    // for binary-map sockets (webserver/webtiles/map_codec.py); keep "msg"
+    // the first field.
     json_open_object();
     json_write_string("msg", "map");
     json_treat_as_empty();
@@ -1941,6 +2351,21 @@ void TilesFramework::_send_map(bool force_full)
     _mcache_ref(true);
     m_mcache_ref_done = true;
 
+    // A monster whose cell wasn't sent is still where the client has it.
+    // Remembering it means that when it does move, only its id and what
+    // changed are sent, not its whole record again.
+    if (!force_full)
+    {
+        for (const auto &entry : m_monster_locs)
+        {
+            if (new_monster_locs.count(entry.first))
+                continue;
+            const monster_info *mi
+                = m_current_map_knowledge(entry.second).monsterinfo();
+            if (mi && mi->client_id == entry.first)
+                new_monster_locs.insert(entry);
+        }
+    }
     m_monster_locs = new_monster_locs;
 }
 
@@ -2243,6 +2668,117 @@ void TilesFramework::redraw()
     m_last_tick_redraw = get_milliseconds();
 }
 
+/*
+  Animations normally send each frame as it's drawn, followed by a delay
+  message and a flush, and then sleep for the delay: a round trip through
+  the server per frame. Inside begin_animation()/end_animation(), frames and
+  their delays are only queued, and all go out together at the end. The
+  client already holds back later messages for each delay, so it plays
+  them at the same pace, and the game doesn't sleep at all.
+
+  If output is already backed up, the frames in between aren't sent:
+  whatever the next redraw sends covers everything they changed.
+
+  Frames that are sent go between "*anim_start" and "*anim_summary", and
+  are followed by their net effect on the map and player, as one update
+  against what was sent before them, up to "*anim_end". The server gives
+  each watcher one or the other (see webserver/webtiles/quality.py), so
+  that those on slow links can do without the animations.
+ */
+void TilesFramework::begin_animation()
+{
+    if (m_animation_depth++)
+        return;
+    flush_messages();
+    m_animation_behind = _has_queued();
+}
+
+void TilesFramework::end_animation()
+{
+    ASSERT(m_animation_depth > 0);
+    if (--m_animation_depth)
+        return;
+    redraw();
+    if (m_animation_base)
+        _send_animation_summary();
+    flush_messages();
+}
+
+void TilesFramework::_start_animation_frames()
+{
+    m_animation_base.reset(new animation_base);
+    animation_base &base = *m_animation_base;
+    base.view = m_current_view;
+    base.map_knowledge = m_current_map_knowledge;
+    base.monster_locs = m_monster_locs;
+    base.player = m_current_player_info;
+    base.gc = m_current_gc;
+    base.player_on_level = m_player_on_level;
+    base.flash_colour = m_current_flash_colour;
+    base.full_map = false;
+    // The copied view keeps its monster tiles alive until the summary.
+    _mcache_ref(true);
+
+    send_message("*{\"msg\":\"anim_start\"}");
+}
+
+void TilesFramework::_send_animation_summary()
+{
+    unique_ptr<animation_base> base = move(m_animation_base);
+    send_message("*{\"msg\":\"anim_summary\"}");
+
+    // Diff against what was sent before the frames. The base view's mcache
+    // references take the place of the current view's.
+    if (m_mcache_ref_done)
+        _mcache_ref(false);
+    m_mcache_ref_done = true;
+    m_current_view = base->view;
+    m_current_map_knowledge = base->map_knowledge;
+    m_monster_locs = base->monster_locs;
+    m_current_player_info = base->player;
+    m_current_gc = base->gc;
+    m_player_on_level = base->player_on_level;
+
+    _send_player();
+    if (base->flash_colour != m_current_flash_colour)
+    {
+        send_message("{\"msg\":\"flash\",\"col\":%d}",
+                     m_current_flash_colour);
+    }
+    for (int y = 0; y < GYM; y++)
+        for (int x = 0; x < GXM; x++)
+            mark_dirty(coord_def(x, y));
+    _send_map(base->full_map);
+
+    send_message("*{\"msg\":\"anim_end\"}");
+}
+
+/**
+ * Show an animation frame, for delay().
+ *
+ * @return true if the frame was batched, and no delay is needed.
+ */
+bool TilesFramework::animation_frame(unsigned int delay_ms)
+{
+    if (!m_animation_depth || !m_controlled_from_web)
+        return false;
+
+    // A receiver that couldn't take the last 64KB is falling behind.
+    for (const Receiver &rcv : m_receivers)
+        if (rcv.lagging || rcv.queued_bytes >= 64 * 1024)
+            m_animation_behind = true;
+
+    if (!m_animation_behind)
+    {
+        if (!m_animation_base)
+            _start_animation_frames();
+        redraw();
+        if (delay_ms)
+            send_message("{\"msg\":\"delay\",\"t\":%d}", delay_ms);
+    }
+    return true;
+}
+
 void TilesFramework::update_minimap(const coord_def& gc)
 {
     if (gc.x < 0 || gc.x >= GXM || gc.y < 0 || gc.y >= GYM)
@@ -2426,21 +2962,33 @@ bool TilesFramework::cell_needs_redraw(const coord_def& gc)
 
 void TilesFramework::write_message_escaped(const string& s)
 {
-    for (unsigned char c : s)
+    static const char hex[] = "0123456789abcdef";
+
+    // Copy runs of characters that don't need escaping in one go; that's
+    // usually the whole string.
+    const char *run = s.data();
+    const char *end = s.data() + s.size();
+    for (const char *p = run; p < end; ++p)
     {
-        if (c == '"')
-            m_msg_buf.append("\\\"");
-        else if (c == '\\')
-            m_msg_buf.append("\\\\");
-        else if (c < 0x20)
+        const unsigned char c = *p;
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        m_msg_buf.append(run, p - run);
+        run = p + 1;
+        if (c == '"' || c == '\\')
         {
-            char buf[7];
-            snprintf(buf, sizeof(buf), "\\u%04x", c);
-            m_msg_buf.append(buf);
+            m_msg_buf.push_back('\\');
+            m_msg_buf.push_back(c);
         }
         else
-            m_msg_buf.push_back(c);
+        {
+            const char esc[] = { '\\', 'u', '0', '0', hex[c >> 4],
+                                 hex[c & 0xf] };
+            m_msg_buf.append(esc, sizeof(esc));
+        }
     }
+    m_msg_buf.append(run, end - run);
 }
 
 void TilesFramework::json_open(const string& name, char opener, char type)
@@ -2522,23 +3070,36 @@ void TilesFramework::json_write_comma()
     char last = m_msg_buf[m_msg_buf.size() - 1];
     if (last == '{' || last == '[' || last == ',' || last == ':')
         return;
-    write_message(",");
+    m_msg_buf.push_back(',');
 }
 
 void TilesFramework::json_write_name(const string& name)
 {
     json_write_comma();
 
-    write_message("\"");
+    m_msg_buf.push_back('"');
     write_message_escaped(name);
-    write_message("\":");
+    m_msg_buf.append("\":", 2);
 }
 
 void TilesFramework::json_write_int(int value)
 {
     json_write_comma();
 
-    write_message("%d", value);
+    // Formatted by hand: this is called for most fields of every update,
+    // and vsnprintf is comparatively slow.
+    char buf[12];
+    char *p = buf + sizeof(buf);
+    unsigned int u = value < 0 ? 0u - (unsigned int) value : value;
+    do
+    {
+        *--p = '0' + u % 10;
+        u /= 10;
+    }
+    while (u);
+    if (value < 0)
+        *--p = '-';
+    m_msg_buf.append(p, buf + sizeof(buf) - p);
 }
 
 void TilesFramework::json_write_int(const string& name, int value)
@@ -2554,9 +3115,9 @@ void TilesFramework::json_write_bool(bool value)
     json_write_comma();
 
     if (value)
-        write_message("true");
+        m_msg_buf.append("true", 4);
     else
-        write_message("false");
+        m_msg_buf.append("false", 5);
 }
 
 void TilesFramework::json_write_bool(const string& name, bool value)
@@ -2571,7 +3132,7 @@ void TilesFramework::json_write_null()
 {
     json_write_comma();
 
-    write_message("null");
+    m_msg_buf.append("null", 4);
 }
 
 void TilesFramework::json_write_null(const string& name)
@@ -2586,9 +3147,9 @@ void TilesFramework::json_write_string(const string& value)
 {
     json_write_comma();
 
-    write_message("\"");
+    m_msg_buf.push_back('"');
     write_message_escaped(value);
-    write_message("\"");
+    m_msg_buf.push_back('"');
 }
 
 void TilesFramework::json_write_string(const string& name, const string& value)
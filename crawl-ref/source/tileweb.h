@@ -8,7 +8,9 @@
 #ifdef USE_TILE_WEB
 
 #include <bitset>
+#include <deque>
 #include <map>
+#include <memory>
 #include <vector>
 
 #include <sys/un.h>
@@ -28,6 +30,7 @@ using std::vector;
 
 class xlog_fields;
 class Menu;
+class webtiles_ring;
 
 enum WebtilesUIState
 {
@@ -116,6 +119,12 @@ public:
     bool need_redraw() const;
     void redraw();
 
+    // Animation frames drawn between these are sent as one burst, with
+    // their delays for the client to play back; see tiles_animation.
+    void begin_animation();
+    void end_animation();
+    bool animation_frame(unsigned int delay_ms);
+
     void place_cursor(cursor_type type, const coord_def &gc);
     void clear_text_tags(text_tag_type type);
     void add_text_tag(text_tag_type type, const string &tag,
@@ -153,7 +162,7 @@ public:
     void send_message(PRINTF(1, ));
     void flush_messages();
 
-    bool has_receivers() { return !m_dest_addrs.empty(); }
+    bool has_receivers() { return !m_receivers.empty(); }
     bool is_controlled_from_web() { return m_controlled_from_web; }
 
     /* Webtiles can receive input both via stdin, and on the
@@ -216,16 +225,54 @@ public:
 
     void send_doll(const dolls_data &doll, bool submerged, bool ghost);
     void send_milestone(const xlog_fields &xl);
+    // Tell the server how much memory this game is using, and where.
+    void send_memory_stats();
     void send_options();
 
 protected:
+    // A socket we send messages to, with whatever it hasn't accepted yet.
+    // Sends never block: a receiver that falls too far behind stops getting
+    // updates until it has caught up, and is then sent everything afresh.
+    struct Receiver
+    {
+        sockaddr_un addr;
+        deque<shared_ptr<const string>> queue; // whole messages, '\n' ended
+        size_t sent = 0;         // bytes of queue.front() already sent
+        size_t queued_bytes = 0; // unsent bytes in queue
+        bool lagging = false;    // dropping updates until the queue drains
+
+        // Set if the receiver asked for messages through shared memory.
+        // The socket then only carries a doorbell saying there's more.
+        shared_ptr<webtiles_ring> ring;
+        bool ring_hello = false;    // the ring hasn't been announced yet
+        bool ring_doorbell = false; // a doorbell still has to go out
+    };
+
     int m_sock;
     int m_max_msg_size;
     string m_msg_buf;
-    vector<sockaddr_un> m_dest_addrs;
+    vector<Receiver> m_receivers;
 
     bool m_controlled_from_web;
     bool m_need_flush;
+    bool m_need_resync;
+
+    void _queue_message(const shared_ptr<const string> &msg);
+    bool _send_queued(Receiver &rcv);
+    bool _send_all_queued();
+    bool _has_queued() const;
+    void _drain_queues(int timeout_ms);
+    void _resync_receivers();
+    void _send_keyframe(const sockaddr_un &addr);
+    bool _send_datagrams(Receiver &rcv, bool &full);
+    bool _send_to_ring(Receiver &rcv, bool &full);
+    void _open_ring(Receiver &rcv);
+    int m_next_ring_id;
+    // If set, only this receiver is sent messages, for a private keyframe.
+    const sockaddr_un *m_keyframe_dest;
+
+    int m_animation_depth;
+    bool m_animation_behind; // coalescing the current animation's frames
 
     bool _send_lock; // not thread safe
 
@@ -308,6 +355,23 @@ protected:
 
     player_info m_current_player_info;
 
+    // What was last sent before the current animation's frames; watchers
+    // that skip animations get everything since then in one update.
+    struct animation_base
+    {
+        crawl_view_buffer view;
+        FixedArray<map_cell, GXM, GYM> map_knowledge;
+        map<uint32_t, coord_def> monster_locs;
+        player_info player;
+        coord_def gc;
+        bool player_on_level;
+        int flash_colour;
+        bool full_map;
+    };
+    unique_ptr<animation_base> m_animation_base;
+    void _start_animation_frames();
+    void _send_animation_summary();
+
     void _send_version();
     void _send_layout();
 
@@ -349,6 +413,26 @@ public:
     }
 };
 
+// Batch the webtiles output of the animation frames drawn in its scope.
+class tiles_animation
+{
+public:
+    tiles_animation(bool active = true) : m_active(active)
+    {
+        if (m_active)
+            tiles.begin_animation();
+    }
+
+    ~tiles_animation()
+    {
+        if (m_active)
+            tiles.end_animation();
+    }
+
+private:
+    bool m_active;
+};
+
 class tiles_ui_control
 {
 public:
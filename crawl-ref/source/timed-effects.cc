@@ -724,6 +724,9 @@ void update_level(int elapsedTime)
     ASSERT(!crawl_state.game_is_arena());
 
     const int turns = elapsedTime / 10;
+    // Every cloud is deleted at the end, so none are placed meanwhile: fog
+    // machines can fire hundreds of times over a long absence.
+    unwind_bool catching_up(crawl_state.updating_level, true);
 
 #ifdef DEBUG_DIAGNOSTICS
     int mons_total = 0;
@@ -773,12 +773,12 @@ trap_def* trap_at(const coord_def& pos)
     if (!feat_is_trap(env.grid(pos)))
         return nullptr;
 
-    auto it = env.trap.find(pos);
-    ASSERT(it != env.trap.end());
-    ASSERT(it->second.pos == pos);
-    ASSERT(it->second.type != TRAP_UNASSIGNED);
+    trap_def *trap = env.trap.find(pos);
+    ASSERT(trap);
+    ASSERT(trap->pos == pos);
+    ASSERT(trap->type != TRAP_UNASSIGNED);
 
-    return &it->second;
+    return trap;
 }
 
 trap_type get_trap_type(const coord_def& pos)
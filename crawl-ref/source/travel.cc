@@ -403,18 +403,38 @@ static bool _is_reseedable(const coord_def& c, bool ignore_danger = false)
            || !_is_safe_cloud(c);
 }
 
-struct cell_travel_safety
+static bool _is_travelsafe_terrain(const coord_def& c, bool try_fallback);
+
+// Precomputed _is_travelsafe_square() results for the whole level, as one
+// bitplane per travel mode, indexed by x * GYM + y.
+struct travel_safe_grid
 {
-    bool safe;
-    bool safe_if_ignoring_hostile_terrain;
+    FixedBitVector<GXM * GYM> safe;
+    FixedBitVector<GXM * GYM> safe_if_ignoring_hostile_terrain;
+
+    // The flags the planes were computed with. A grid for one flood only
+    // answers lookups with that flood's flags; the level-wide one answers
+    // everything, as the stair distances have always been computed.
+    bool exact;
+    bool ignore_danger;
+    bool try_fallback;
 
-    cell_travel_safety() : safe(false), safe_if_ignoring_hostile_terrain(false)
+    bool covers(bool danger, bool fallback) const
     {
+        return !exact
+               || danger == ignore_danger && fallback == try_fallback;
+    }
+
+    bool get(const coord_def &c, bool ignore_hostile) const
+    {
+        const int i = c.x * GYM + c.y;
+        return ignore_hostile ? safe_if_ignoring_hostile_terrain.get(i)
+                              : safe.get(i);
     }
 };
 
-typedef FixedArray<cell_travel_safety, GXM, GYM> travel_safe_grid;
-static unique_ptr<travel_safe_grid> _travel_safe_grid;
+static travel_safe_grid _travel_safe_grid_planes;
+static const travel_safe_grid *_travel_safe_grid = nullptr;
 
 class precompute_travel_safety_grid
 {
@@ -422,28 +442,52 @@ private:
     bool did_compute;
 
 public:
-    precompute_travel_safety_grid() : did_compute(false)
+    // With exact set, only for lookups with these ignore_danger and
+    // try_fallback flags. Does nothing if a grid is already in use.
+    precompute_travel_safety_grid(bool exact = false,
+                                  bool ignore_danger = false,
+                                  bool try_fallback = false)
+        : did_compute(false)
     {
         if (!_travel_safe_grid)
         {
             did_compute = true;
-            auto tsgrid = make_unique<travel_safe_grid>();
-            travel_safe_grid &safegrid(*tsgrid);
+            travel_safe_grid &planes(_travel_safe_grid_planes);
+            planes.safe.reset();
+            planes.safe_if_ignoring_hostile_terrain.reset();
+            planes.exact = exact;
+            planes.ignore_danger = ignore_danger;
+            planes.try_fallback = try_fallback;
             for (rectangle_iterator ri(1); ri; ++ri)
             {
-                const coord_def p(*ri);
-                cell_travel_safety &ts(safegrid(p));
-                ts.safe = _is_travelsafe_square(p, false);
-                ts.safe_if_ignoring_hostile_terrain =
-                    _is_travelsafe_square(p, true);
+                // Equivalent to _is_travelsafe_square(c, false) and
+                // _is_travelsafe_square(c, true), sharing the checks that
+                // do not depend on ignore_hostile.
+                const coord_def c(*ri);
+                const map_cell &cell(env.map_knowledge(c));
+                if (!cell.known())
+                    continue;
+
+                const bool fallback = try_fallback
+                    && (!you.see_cell(c) || _feat_is_blocking_door(cell.feat()));
+                const int i = c.x * GYM + c.y;
+                if (_is_travelsafe_terrain(c, fallback))
+                {
+                    planes.safe_if_ignoring_hostile_terrain.set(i);
+                    planes.safe.set(i, ignore_danger
+                        || !_monster_blocks_travel(cell.monsterinfo())
+                           && (!is_excluded(c) || is_stair_exclusion(c)));
+                }
+                else if (_is_reseedable(c, true))
+                    planes.safe_if_ignoring_hostile_terrain.set(i);
             }
-            _travel_safe_grid = move(tsgrid);
+            _travel_safe_grid = &planes;
         }
     }
     ~precompute_travel_safety_grid()
     {
         if (did_compute)
-            _travel_safe_grid.reset(nullptr);
+            _travel_safe_grid = nullptr;
     }
 };
 
@@ -465,11 +509,10 @@ static bool _is_travelsafe_square(const coord_def& c, bool ignore_hostile,
     if (!in_bounds(c))
         return false;
 
-    if (_travel_safe_grid)
+    if (_travel_safe_grid && _travel_safe_grid->covers(ignore_danger,
+                                                       try_fallback))
     {
-        const cell_travel_safety &cell((*_travel_safe_grid)(c));
-        return ignore_hostile? cell.safe_if_ignoring_hostile_terrain
-               : cell.safe;
+        return _travel_safe_grid->get(c, ignore_hostile);
     }
 
     if (!env.map_knowledge(c).known())
@@ -507,6 +550,17 @@ static bool _is_travelsafe_square(const coord_def& c, bool ignore_hostile,
         return false;
     }
 
+    return _is_travelsafe_terrain(c, try_fallback);
+}
+
+// The part of _is_travelsafe_square() that doesn't depend on ignore_hostile
+// or ignore_danger. try_fallback should already be adjusted for whether the
+// player can see c.
+static bool _is_travelsafe_terrain(const coord_def& c, bool try_fallback)
+{
+    const map_cell& levelmap_cell = env.map_knowledge(c);
+    const dungeon_feature_type grid = levelmap_cell.feat();
+
     if (g_Slime_Wall_Check && slime_wall_neighbour(c)
         && !actor_slime_wall_immune(&you))
     {
@@ -926,6 +980,173 @@ void explore_pickup_event(int did_pickup, int tried_pickup)
     }
 }
 
+// A record of the travel flood last run back from you.running.pos, so that
+// later travel steps along the same route can reuse it instead of flooding
+// again. The flood is a deterministic function of the safety and traversal
+// cost of each cell it tests, and of the level's transporters. For every cell
+// reached, we remember the first cell it was reached from and how many cells
+// had been tested before then: if those cells all still test the same, a new
+// flood towards that cell would stop in exactly the same place.
+struct travel_flood_cell
+{
+    coord_def pos;
+    bool safe;
+    int cost;
+    bool landing;
+
+    void test(bool try_fallback)
+    {
+        safe = _is_travelsafe_square(pos, false, false, try_fallback);
+        cost = _feature_traverse_cost(env.map_knowledge(pos).feat());
+        landing = env.grid(pos) == DNGN_TRANSPORTER_LANDING;
+    }
+
+    bool operator == (const travel_flood_cell &other) const
+    {
+        return pos == other.pos && safe == other.safe && cost == other.cost
+               && landing == other.landing;
+    }
+};
+
+struct travel_flood_reach
+{
+    coord_def from;
+    int tested;     // Number of cells tested before this one was reached.
+};
+
+struct travel_flood_cache
+{
+    bool valid = false;
+    level_id level;
+    coord_def target;
+    vector<travel_flood_cell> tested;
+    FixedArray<travel_flood_reach, GXM, GYM> reached;
+    vector<pair<coord_def, coord_def>> transporters;
+
+    void reset(const coord_def &_target, bool try_fallback);
+    bool matches(const coord_def &youpos, bool try_fallback) const;
+};
+
+// One for each of normal and fallback travel, by try_fallback.
+static travel_flood_cache _travel_floods[2];
+
+static vector<pair<coord_def, coord_def>> _transporter_signature()
+{
+    vector<pair<coord_def, coord_def>> sig;
+    LevelInfo &li = travel_cache.get_level_info(level_id::current());
+    for (const transporter_info &ti : li.get_transporters())
+        sig.emplace_back(ti.position, ti.destination);
+    return sig;
+}
+
+void travel_flood_cache::reset(const coord_def &_target, bool try_fallback)
+{
+    valid = true;
+    level = level_id::current();
+    target = _target;
+    reached.init({coord_def(), -1});
+    transporters = _transporter_signature();
+
+    tested.clear();
+    travel_flood_cell start;
+    start.pos = target;
+    start.test(try_fallback);
+    tested.push_back(start);
+}
+
+bool travel_flood_cache::matches(const coord_def &youpos,
+                                 bool try_fallback) const
+{
+    if (!valid || level != level_id::current() || target != you.running.pos)
+        return false;
+
+    const int n = reached(youpos).tested;
+    if (n < 0 || transporters != _transporter_signature())
+        return false;
+
+    for (int i = 0; i < n; ++i)
+    {
+        travel_flood_cell now;
+        now.pos = tested[i].pos;
+        now.test(try_fallback);
+        if (!(now == tested[i]))
+            return false;
+    }
+    return true;
+}
+
+// A travel flood that fills in a travel_flood_cache as it goes.
+class travel_flood_recorder : public travel_pathfind
+{
+public:
+    travel_flood_recorder(travel_flood_cache &_cache) : cache(_cache) { }
+
+protected:
+    bool path_flood(const coord_def &c, const coord_def &dc) override
+    {
+        if (in_bounds(dc) && cache.reached(dc).tested < 0
+            // Mirrors the transporter check at the top of path_flood().
+            && !(is_excluded(c)
+                 && env.map_knowledge(c).feat() == DNGN_TRANSPORTER
+                 && !adjacent(c, dc)))
+        {
+            cache.reached(dc) = {c, (int)cache.tested.size()};
+            if (dc != start)
+            {
+                travel_flood_cell cell;
+                cell.pos = dc;
+                cell.test(try_fallback);
+                cache.tested.push_back(cell);
+            }
+        }
+        return travel_pathfind::path_flood(c, dc);
+    }
+
+private:
+    travel_flood_cache &cache;
+};
+
+/**
+ * Find the next travel move from youpos towards you.running.pos, reusing the
+ * last flood if nothing it depended on has changed.
+ *
+ * @param youpos       The starting position.
+ * @param try_fallback Whether to path through remembered obstructions.
+ * @return The square to move to, youpos if already there, or the origin if
+ *         there is no safe move.
+ */
+static coord_def _travel_move(const coord_def &youpos, bool try_fallback)
+{
+    const coord_def target = you.running.pos;
+    travel_flood_cache &cache = _travel_floods[try_fallback];
+
+    // The same early exits as travel_pathfind::pathfind().
+    if (!in_bounds(target)
+        || !_is_travelsafe_square(target, false, false, true)
+           && !is_trap(target))
+    {
+        return coord_def();
+    }
+    if (target == youpos)
+        return target;
+
+    {
+        unwind_bool slime_wall_check(g_Slime_Wall_Check,
+                                     !actor_slime_wall_immune(&you));
+        unwind_slime_wall_precomputer slime_neighbours(g_Slime_Wall_Check);
+        if (cache.matches(youpos, try_fallback))
+        {
+            const coord_def from = cache.reached(youpos).from;
+            return _is_safe_move(from) ? from : coord_def();
+        }
+    }
+
+    cache.reset(target, try_fallback);
+    travel_flood_recorder tp(cache);
+    tp.set_src_dst(youpos, target);
+    return tp.pathfind(RMODE_TRAVEL, try_fallback);
+}
+
 /**
  * Run the travel_pathfind algorithm with a destination with the aim of
  * determining the next travel move. Try to avoid to let travel (including
@@ -944,13 +1165,9 @@ void explore_pickup_event(int did_pickup, int tried_pickup)
  */
 static void _find_travel_pos(const coord_def& youpos, int *move_x, int *move_y)
 {
-    travel_pathfind tp;
-
-    tp.set_src_dst(youpos, you.running.pos);
-
-    coord_def dest = tp.pathfind(RMODE_TRAVEL, false);
+    coord_def dest = _travel_move(youpos, false);
     if (dest.origin())
-        dest = tp.pathfind(RMODE_TRAVEL, true);
+        dest = _travel_move(youpos, true);
     coord_def new_dest = dest;
 
     // We'd either have to travel through a runed door, in which case we'll be
@@ -1351,6 +1568,12 @@ coord_def travel_pathfind::pathfind(run_mode_type rmode, bool fallback_explore)
         }
     }
 
+    // Greedy explore asks whether each stash it reaches wants picking up,
+    // which names its items.
+    unique_ptr<item_name_memo> names;
+    if (need_for_greed)
+        names.reset(new item_name_memo);
+
     if (!ls && (annotate_map || need_for_greed))
         ls = StashTrack.find_current_level();
 
@@ -1404,6 +1627,17 @@ coord_def travel_pathfind::pathfind(run_mode_type rmode, bool fallback_explore)
                                  !actor_slime_wall_immune(&you));
     unwind_slime_wall_precomputer slime_neighbours(g_Slime_Wall_Check);
 
+    // Explore floods the whole known level, testing each square once from
+    // every neighbour; test them all once up front instead.
+    unique_ptr<precompute_travel_safety_grid> safety_grid;
+    if (floodout
+        && (runmode == RMODE_EXPLORE || runmode == RMODE_EXPLORE_GREEDY))
+    {
+        safety_grid.reset(new precompute_travel_safety_grid(true,
+                                                            ignore_danger,
+                                                            try_fallback));
+    }
+
     // How many points we'll consider next iteration.
     next_iter_points = 0;
 
@@ -3494,18 +3728,143 @@ void LevelInfo::set_distance_between_stairs(int a, int b, int dist)
     stair_distances[b * stairs.size() + a] = dist;
 }
 
+// The stair distances last computed for the current level, with what each
+// stair's flood depended on. A flood from a stair is a deterministic function
+// of the state (below) of each cell it tested and of the level's
+// transporters, so it need only be rerun if one of those cells has changed.
+struct stair_flood_cell
+{
+    bool safe;
+    int cost;
+    bool transporter;
+    bool excluded_transporter;
+
+    stair_flood_cell()
+        : safe(false), cost(0), transporter(false), excluded_transporter(false)
+    {
+    }
+
+    explicit stair_flood_cell(const coord_def &c)
+        : safe(_is_travelsafe_square(c, false, false, true)),
+          cost(_feature_traverse_cost(env.map_knowledge(c).feat())),
+          transporter(env.grid(c) == DNGN_TRANSPORTER),
+          excluded_transporter(is_excluded(c)
+              && env.map_knowledge(c).feat() == DNGN_TRANSPORTER)
+    {
+    }
+
+    bool operator == (const stair_flood_cell &other) const
+    {
+        return safe == other.safe && cost == other.cost
+               && transporter == other.transporter
+               && excluded_transporter == other.excluded_transporter;
+    }
+};
+
+typedef FixedBitVector<GXM * GYM> travel_cell_mask;
+
+static inline int _cell_mask_index(const coord_def &c)
+{
+    return c.x * GYM + c.y;
+}
+
+struct stair_distance_cache
+{
+    level_id level;
+    vector<coord_def> stairs;
+    vector<pair<coord_def, coord_def>> transporters;
+    vector<short> distances;
+    FixedArray<stair_flood_cell, GXM, GYM> cells;
+    vector<travel_cell_mask> touched;   // The cells each stair's flood tested.
+};
+
+static stair_distance_cache _stair_distance_cache;
+
+// A fill_travel_point_distance() flood that notes every cell it tests.
+class stair_flood_recorder : public travel_pathfind
+{
+public:
+    stair_flood_recorder(travel_cell_mask &_touched) : touched(_touched) { }
+
+protected:
+    bool path_flood(const coord_def &c, const coord_def &dc) override
+    {
+        if (in_bounds(dc))
+            touched.set(_cell_mask_index(dc));
+        return travel_pathfind::path_flood(c, dc);
+    }
+
+private:
+    travel_cell_mask &touched;
+};
+
 void LevelInfo::update_stair_distances()
 {
     const int nstairs = stairs.size();
+    stair_distance_cache &cache = _stair_distance_cache;
+
+    vector<coord_def> positions;
+    for (const stair_info &si : stairs)
+        positions.push_back(si.position);
+    vector<pair<coord_def, coord_def>> transporter_sig;
+    for (const transporter_info &ti : transporters)
+        transporter_sig.emplace_back(ti.position, ti.destination);
+
+    const bool reuse = cache.level == id && cache.stairs == positions
+                       && cache.transporters == transporter_sig
+                       && (int)cache.distances.size() == nstairs * nstairs;
+
+    // Find the cells whose state has changed since the last update, with
+    // the same slime wall handling as travel_pathfind::pathfind().
+    travel_cell_mask changed;
+    {
+        unwind_bool slime_wall_check(g_Slime_Wall_Check,
+                                     !actor_slime_wall_immune(&you));
+        unwind_slime_wall_precomputer slime_neighbours(g_Slime_Wall_Check);
+        for (rectangle_iterator ri(1); ri; ++ri)
+        {
+            const stair_flood_cell now(*ri);
+            if (!(now == cache.cells(*ri)))
+            {
+                changed.set(_cell_mask_index(*ri));
+                cache.cells(*ri) = now;
+            }
+        }
+    }
+
+    if (reuse)
+        stair_distances = cache.distances;
+    else
+    {
+        cache.level = id;
+        cache.stairs = positions;
+        cache.transporters = transporter_sig;
+        cache.touched.assign(nstairs, travel_cell_mask());
+    }
+
     // Now we update distances for all the stairs, relative to all other
     // stairs.
     for (int s = 0; s < nstairs - 1; ++s)
     {
         set_distance_between_stairs(s, s, 0);
 
+        travel_cell_mask &touched = cache.touched[s];
+        if (reuse)
+        {
+            travel_cell_mask hit = touched;
+            hit &= changed;
+            if (!hit.any())
+                continue;
+        }
+
         // For each stair, we need to ask travel to populate the distance
-        // array.
-        fill_travel_point_distance(stairs[s].position);
+        // array. This is fill_travel_point_distance(), noting which cells
+        // the flood depended on.
+        touched.reset();
+        touched.set(_cell_mask_index(stairs[s].position));
+        stair_flood_recorder tp(touched);
+        tp.set_floodseed(stairs[s].position);
+        tp.pathfind(RMODE_NOT_RUNNING, true);
 
         // Assume movement distance between stairs is commutative,
         // i.e. going from a->b is the same distance as b->a.
@@ -3518,6 +3877,8 @@ void LevelInfo::update_stair_distances()
     }
     if (nstairs)
         set_distance_between_stairs(nstairs - 1, nstairs - 1, 0);
+
+    cache.distances = stair_distances;
 }
 
 void LevelInfo::update_transporter(const coord_def& transpos,
@@ -95,6 +95,18 @@ public:
 
     bool needs_paint;
     bool needs_swap;
+#ifdef USE_TILE_LOCAL
+    unsigned int last_swap_ticks = 0;
+
+    // How long until the next frame may be painted, if one is waiting.
+    unsigned int paint_wait() const
+    {
+        if (!needs_paint)
+            return 0;
+        const unsigned int since = wm->get_ticks() - last_swap_ticks;
+        return since < wm->frame_ms() ? wm->frame_ms() - since : 0;
+    }
+#endif
 
 #ifdef DEBUG
     bool debug_draw = false;
@@ -263,6 +275,8 @@ SizeReq Widget::get_preferred_size(Direction dim, int prosp_width)
     if (cached_sr_valid[dim] && (!dim || cached_sr_pw == prosp_width))
         return cached_sr[dim];
 
+    // the cache is keyed on the width asked for, before margins come off
+    const int asked_width = prosp_width;
     prosp_width = dim ? prosp_width - margin.right - margin.left : prosp_width;
     SizeReq ret = _get_preferred_size(dim, prosp_width);
     ASSERT(ret.min <= ret.nat);
@@ -296,7 +310,7 @@ SizeReq Widget::get_preferred_size(Direction dim, int prosp_width)
     cached_sr_valid[dim] = true;
     cached_sr[dim] = ret;
     if (dim)
-        cached_sr_pw = prosp_width;
+        cached_sr_pw = asked_width;
 
     return ret;
 }
@@ -615,15 +629,22 @@ void Text::set_text(const formatted_string &fs)
     m_text += fs;
     _invalidate_sizereq();
     _expose();
-    m_wrapped_size = Size(-1);
+    _invalidate_wrapping();
     _queue_allocation();
 }
 
+void Text::_invalidate_wrapping()
+{
+    m_wrapped_size = Size(-1);
+    m_height_for_width.clear();
+}
+
 #ifdef USE_TILE_LOCAL
 void Text::set_font(FontWrapper *font)
 {
     ASSERT(font);
     m_font = font;
+    _invalidate_wrapping();
     _queue_allocation();
 }
 #endif
@@ -994,8 +1015,7 @@ SizeReq Text::_get_preferred_size(Direction dim, int prosp_width)
     }
     else
     {
-        wrap_text_to_size(prosp_width, 0);
-        int height = m_font->string_height(m_text_wrapped);
+        const int height = _height_for_width(prosp_width);
         return { ellipsize ? (int)m_font->char_height() : height, height };
     }
 #else
@@ -1016,13 +1036,38 @@ SizeReq Text::_get_preferred_size(Direction dim, int prosp_width)
     }
     else
     {
-        wrap_text_to_size(prosp_width, 0);
-        int height = m_wrapped_lines.size();
+        const int height = _height_for_width(prosp_width);
         return { ellipsize ? 1 : height, height };
     }
 #endif
 }
 
+/**
+ * The height of the text wrapped to the given width.
+ *
+ * Containers ask for heights at several widths before settling on one, and
+ * then render at the allocated width; remembering the heights means asking
+ * again (as every relayout does) doesn't rewrap the text for each width.
+ */
+int Text::_height_for_width(int width)
+{
+    for (const auto &hw : m_height_for_width)
+        if (hw.first == width)
+            return hw.second;
+
+    wrap_text_to_size(width, 0);
+#ifdef USE_TILE_LOCAL
+    const int height = m_font->string_height(m_text_wrapped);
+#else
+    const int height = m_wrapped_lines.size();
+#endif
+    // only a handful of widths are ever asked about
+    if (m_height_for_width.size() >= 8)
+        m_height_for_width.clear();
+    m_height_for_width.emplace_back(width, height);
+    return height;
+}
+
 void Text::_allocate_region()
 {
     wrap_text_to_size(m_region.width, m_region.height);
@@ -2634,6 +2679,7 @@ void UIRoot::swap_buffers()
     needs_swap = false;
 #ifdef USE_TILE_LOCAL
     wm->swap_buffers();
+    last_swap_ticks = wm->get_ticks();
 #else
     update_screen();
 #endif
@@ -3197,11 +3243,15 @@ void pump_events(int wait_event_timeout)
     int macro_key = macro_buf_get();
 
 #ifdef USE_TILE_LOCAL
+    // Paint at most once a frame. Until the next one is due, carry on
+    // handling events; if none come by then, paint while waiting.
+    unsigned int paint_wait = macro_key == -1 ? ui_root.paint_wait() : 0;
+
     // Don't render while there are unhandled mousewheel events,
     // since these can come in faster than crawl can redraw.
     // unlike mousemotion events, we don't drop all but the last event
     // ...but if there are macro keys, we do need to layout (for menu UI)
-    if (!wm->next_event_is(WME_MOUSEWHEEL) || macro_key != -1)
+    if (!paint_wait && (!wm->next_event_is(WME_MOUSEWHEEL) || macro_key != -1))
 #endif
     {
         ui_root.layout();
@@ -3237,8 +3287,16 @@ void pump_events(int wait_event_timeout)
             break;
         }
 
-        if (!wm->wait_event(&event, wait_event_timeout))
+        const int timeout = paint_wait
+            ? min(wait_event_timeout, (int)paint_wait) : wait_event_timeout;
+        if (!wm->wait_event(&event, timeout))
         {
+            if (paint_wait)
+            {
+                paint_wait = 0;
+                render();
+                continue;
+            }
             if (wait_event_timeout == INT_MAX)
                 continue;
             else
@@ -772,6 +772,7 @@ public:
         if (wrap_text == _wrap_text)
             return;
         wrap_text = _wrap_text;
+        _invalidate_wrapping();
         _invalidate_sizereq();
     }
 
@@ -780,11 +781,14 @@ public:
         if (ellipsize == _ellipsize)
             return;
         ellipsize = _ellipsize;
+        _invalidate_wrapping();
         _invalidate_sizereq();
     }
 
 protected:
     void wrap_text_to_size(int width, int height);
+    void _invalidate_wrapping();
+    int _height_for_width(int width);
 
     bool wrap_text = false;
     bool ellipsize = false;
@@ -802,6 +806,7 @@ protected:
 #endif
     Size m_wrapped_size = Size{-1};
     Size m_wrapped_sizereq = Size{-1};
+    vector<pair<int, int>> m_height_for_width;
     string hl_pat;
     bool hl_line;
 };
@@ -471,14 +471,36 @@ string UTF8FileLineInput::get_line()
     return utf8_validate(out.c_str());
 }
 
+// Whether the eight bytes at s are all printable ASCII, each a column wide.
+// Most UI text is, and this is much quicker than decoding it and asking
+// wcwidth() about each character.
+static bool _printable_ascii_word(const char *s)
+{
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = ones * 0x80;
+    uint64_t w;
+    memcpy(&w, s, sizeof(w));
+    const uint64_t del = w ^ (ones * 0x7f);
+    return !(w & highs)                            // not ASCII
+           && !((w - ones * ' ') & ~w & highs)     // control characters
+           && !((del - ones) & ~del & highs);      // DEL
+}
+
 int strwidth(const char *s)
 {
     char32_t c;
     int w = 0;
+    const char *end = s + strlen(s);
 
-    while (int l = utf8towc(&c, s))
+    while (*s)
     {
-        s += l;
+        if (end - s >= 8 && _printable_ascii_word(s))
+        {
+            s += 8;
+            w += 8;
+            continue;
+        }
+        s += utf8towc(&c, s);
         int cw = wcwidth(c);
         if (cw != -1) // shouldn't ever happen
             w += cw;
@@ -534,10 +556,20 @@ char *next_glyph(char *s)
 string chop_string(const char *s, int width, bool spaces)
 {
     const char *s0 = s;
+    const char *end = s + strlen(s);
     char32_t c;
 
-    while (int clen = utf8towc(&c, s))
+    while (true)
     {
+        if (width >= 8 && end - s >= 8 && _printable_ascii_word(s))
+        {
+            s += 8;
+            width -= 8;
+            continue;
+        }
+        const int clen = utf8towc(&c, s);
+        if (!clen)
+            break;
         int cw = wcwidth(c);
         // Due to combining chars, we can't stop at merely reaching the
         // target width, the next character needs to exceed it.
@@ -22,6 +22,7 @@
 #include "coord.h"
 #include "coordit.h"
 #include "database.h"
+#include "dbg-prof.h"
 #include "delay.h"
 #include "dgn-overview.h"
 #include "directn.h"
@@ -100,6 +101,15 @@ bool handle_seen_interrupt(monster* mons, vector<string>* msgs_buf)
     else
         aid.context = SC_NEWLY_SEEN;
 
+    // Unless something is being interrupted, only a monster coming into
+    // view matters (see interrupt_activity()). Don't ask whether the rest
+    // are safe: that builds a monster_info and asks the user's Lua.
+    if (aid.context != SC_NEWLY_SEEN && !you_are_delayed()
+        && !crawl_state.is_repeating_cmd())
+    {
+        return false;
+    }
+
     if (!mons_is_safe(mons))
     {
         return interrupt_activity(activity_interrupt::see_monster,
@@ -1012,6 +1022,9 @@ void flash_view_delay(use_animation_type a, colour_t colour, int flash_delay,
 {
     if (crawl_state.need_save && Options.use_animations & a)
     {
+#ifdef USE_TILE_WEB
+        tiles_animation batch;
+#endif
         flash_view(a, colour, where);
         scaled_delay(flash_delay);
         flash_view(a, 0);
@@ -1356,7 +1369,12 @@ static bool _view_is_updating = false;
 
 crawl_view_buffer view_dungeon(animation *a, bool anim_updates, view_renderer *renderer);
 
-static bool _viewwindow_should_render()
+/**
+ * Whether viewwindow() draws the map right now. It doesn't while asleep,
+ * nor while resting or travelling with a delay of -1, when only the end
+ * result is of interest.
+ */
+bool viewwindow_should_render()
 {
     if (you.asleep())
         return false;
@@ -1399,6 +1417,7 @@ void viewwindow(bool show_updates, bool tiles_only, animation *a, view_renderer
 
     {
         unwind_bool updating(_view_is_updating, true);
+        PROFILE_SCOPE(PROF_VIEWWINDOW);
 
 #ifndef USE_TILE_LOCAL
         save_cursor_pos save;
@@ -1450,7 +1469,7 @@ void viewwindow(bool show_updates, bool tiles_only, animation *a, view_renderer
         if (show_updates)
             player_view_update();
 
-        if (_viewwindow_should_render())
+        if (viewwindow_should_render())
         {
             const auto vbuf = view_dungeon(a, anim_updates, renderer);
 
@@ -1588,6 +1607,130 @@ static void add_overlays(const coord_def& gc, screen_cell_t* cell)
 #endif
 }
 
+#ifndef USE_TILE
+// The cells of the last frame that were outside the player's sight, kept so
+// that a redraw can reuse the ones whose knowledge hasn't changed: most of a
+// console redraw is remembered terrain that looks just as it did.
+//
+// Only cells with nothing but terrain are kept, since the monster, item and
+// cloud info a map_cell points to can't be cheaply compared, and only those
+// whose colours aren't elemental (which vary between redraws). Tiles builds
+// don't do this, as their cells also depend on tile_env.
+struct view_cell_memo
+{
+    bool valid = false;
+    coord_def gc;
+    map_cell knowledge;
+    uint8_t travel = 0;
+    screen_cell_t cell;
+};
+
+enum view_memo_travel_flags
+{
+    VMT_TRAIL        = 1 << 0,
+    VMT_EXCLUDED     = 1 << 1,
+    VMT_EXCLUDE_ROOT = 1 << 2,
+    VMT_OVERRIDE     = 1 << 3,
+};
+
+static vector<view_cell_memo> _view_memo;
+static struct
+{
+    coord_def size;
+    layers_type layers = LAYERS_ALL;
+    unsigned int options = 0;
+    level_id level;
+    bool on_level = false;
+} _view_memo_key;
+
+/// Reset the memo if anything every cell depends on has changed.
+static void _check_view_memo(const coord_def &size)
+{
+    if (_view_memo.size() == (size_t) (size.x * size.y)
+        && _view_memo_key.size == size
+        && _view_memo_key.layers == _layers
+        && _view_memo_key.options == Options.lines_read
+        && _view_memo_key.level == level_id::current()
+        && _view_memo_key.on_level == you.on_current_level)
+    {
+        return;
+    }
+
+    _view_memo.clear();
+    _view_memo.resize(size.x * size.y);
+    _view_memo_key.size = size;
+    _view_memo_key.layers = _layers;
+    _view_memo_key.options = Options.lines_read;
+    _view_memo_key.level = level_id::current();
+    _view_memo_key.on_level = you.on_current_level;
+}
+
+static uint8_t _view_memo_travel(const coord_def &gc)
+{
+    uint8_t flags = 0;
+    if (Options.show_travel_trail && travel_trail_index(gc) >= 0)
+        flags |= VMT_TRAIL;
+    if (is_excluded(gc))
+        flags |= VMT_EXCLUDED;
+    if (is_exclude_root(gc))
+        flags |= VMT_EXCLUDE_ROOT;
+    if ((flags & (VMT_EXCLUDED | VMT_EXCLUDE_ROOT))
+        && travel_colour_override(gc))
+    {
+        flags |= VMT_OVERRIDE;
+    }
+    return flags;
+}
+
+static bool _view_memo_terrain_only(const map_cell &knowledge)
+{
+    return knowledge.cloud() == CLOUD_NONE
+           && !knowledge.item()
+           && !knowledge.monsterinfo()
+           && !(knowledge.flags & MAP_WITHHELD);
+}
+
+/**
+ * Draw a cell of a plain (unanimated, unflashed, overlay-free) view, reusing
+ * what it looked like last time if nothing it's drawn from has changed.
+ */
+static void _draw_cell_memo(screen_cell_t *cell, view_cell_memo &memo,
+                            const coord_def &gc, bool anim_updates)
+{
+    const bool remembered = map_bounds(gc)
+                            && (!you.see_cell(gc) || !you.on_current_level)
+                            && gc != you.pos();
+    if (!remembered)
+    {
+        memo.valid = false;
+        draw_cell(cell, gc, anim_updates, 0);
+        return;
+    }
+
+    const map_cell &knowledge = env.map_knowledge(gc);
+    const uint8_t travel = _view_memo_travel(gc);
+    if (memo.valid && memo.gc == gc && memo.travel == travel
+        && memo.knowledge == knowledge)
+    {
+        *cell = memo.cell;
+        return;
+    }
+
+    const unsigned int elements = element_colour_evaluations();
+    draw_cell(cell, gc, anim_updates, 0);
+
+    memo.valid = _view_memo_terrain_only(knowledge)
+                 && element_colour_evaluations() == elements;
+    if (memo.valid)
+    {
+        memo.gc = gc;
+        memo.knowledge = knowledge;
+        memo.travel = travel;
+        memo.cell = *cell;
+    }
+}
+#endif
+
 /**
  * Constructs the main dungeon view, rendering it into a new crawl_view_buffer.
  *
@@ -1610,6 +1753,24 @@ crawl_view_buffer view_dungeon(animation *a, bool anim_updates, view_renderer *r
 
     const coord_def tl = coord_def(1, 1);
     const coord_def br = vbuf.size();
+
+#ifndef USE_TILE
+    // Anything that draws over the view turns the memo off for the frame.
+    if (!a && !you.flash_where && flash_colour == BLACK
+        && !crawl_state.darken_range && !crawl_state.flash_monsters
+        && glyph_overlays.empty())
+    {
+        _check_view_memo(br);
+        view_cell_memo *memo = _view_memo.data();
+        for (rectangle_iterator ri(tl, br); ri; ++ri)
+            _draw_cell_memo(cell++, *memo++, view2grid(*ri), anim_updates);
+
+        if (renderer)
+            renderer->render(vbuf);
+        return vbuf;
+    }
+#endif
+
     for (rectangle_iterator ri(tl, br); ri; ++ri)
     {
         // in grid coords
@@ -91,6 +91,7 @@ void run_animation(animation_type anim, use_animation_type type,
                    bool cleanup = true);
 void viewwindow(bool show_updates = true, bool tiles_only = false,
                 animation *a = nullptr, view_renderer *renderer = nullptr);
+bool viewwindow_should_render();
 void draw_cell(screen_cell_t *cell, const coord_def &gc,
                bool anim_updates, int flash_colour);
 
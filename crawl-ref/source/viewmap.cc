@@ -273,82 +273,112 @@ static int _get_number_of_lines_levelmap()
     return get_number_of_lines() - 1;
 }
 
-static void _draw_level_map(int start_x, int start_y, bool travel_mode,
-        bool on_level, ui::Region region)
+struct map_glyph
 {
-    region.width = min(region.width, GXM);
-    region.height = min(region.height, GYM);
+    char32_t glyph;
+    unsigned short colour;
+};
 
-    const coord_def extents(region.width, region.height);
-    crawl_view_buffer vbuf(extents);
-    screen_cell_t *cell = vbuf;
+typedef FixedArray<map_glyph, GXM, GYM> map_glyph_grid;
 
-    cursor_control cs(false);
+// Work out what the whole level map looks like. Moving the cursor or
+// scrolling doesn't change any of it, so the result is kept until a map
+// command changes the level or what's known about it.
+static void _fill_level_map(map_glyph_grid &cells, bool travel_mode,
+                            bool on_level)
+{
+    for (rectangle_iterator ri(0); ri; ++ri)
+    {
+        const coord_def c = *ri;
+        map_glyph *cell = &cells(c);
 
-    for (int screen_y = 0; screen_y < region.height; screen_y++)
-        for (int screen_x = 0; screen_x < region.width; screen_x++)
+        if (!map_bounds(c))
+        {
+            cell->colour = DARKGREY;
+            cell->glyph  = 0;
+        }
+        else
         {
-            coord_def c(start_x + screen_x, start_y + screen_y);
+            cglyph_t g = get_cell_glyph(c, false, -1);
+            cell->glyph = g.ch;
+            cell->colour = g.col;
 
-            if (!map_bounds(c))
+            const show_class show = get_cell_show_class(env.map_knowledge(c));
+
+            if (show == SH_NOTHING && is_explore_horizon(c))
             {
-                cell->colour = DARKGREY;
-                cell->glyph  = 0;
+                const feature_def& fd = get_feature_def(DNGN_EXPLORE_HORIZON);
+                cell->glyph = fd.symbol();
+                cell->colour = fd.colour();
             }
-            else
+
+            if (travel_mode && travel_colour_override(c))
+                cell->colour = _get_travel_colour(c);
+
+            if (c == you.pos() && !crawl_state.arena_suspended && on_level)
             {
-                cglyph_t g = get_cell_glyph(c, false, -1);
-                cell->glyph = g.ch;
-                cell->colour = g.col;
+                // [dshaligram] Draw the @ symbol on the
+                // level-map. It's no longer saved into the
+                // env.map_knowledge, so we need to draw it
+                // directly.
+                cell->colour = WHITE;
+                cell->glyph  = mons_char(you.symbol);
+            }
 
-                const show_class show = get_cell_show_class(env.map_knowledge(c));
+            // If we've a waypoint on the current square, *and* the
+            // square is a normal floor square with nothing on it,
+            // show the waypoint number.
+            // XXX: This is a horrible hack.
+            char32_t bc   = cell->glyph;
+            uint8_t ch = is_waypoint(c);
+            if (ch && (bc == _get_sightmap_char(DNGN_FLOOR)
+                       || bc == _get_magicmap_char(DNGN_FLOOR)))
+            {
+                cell->glyph = ch;
+            }
 
-                if (show == SH_NOTHING && is_explore_horizon(c))
-                {
-                    const feature_def& fd = get_feature_def(DNGN_EXPLORE_HORIZON);
+            if (Options.show_travel_trail && travel_trail_index(c) >= 0)
+            {
+                const feature_def& fd = get_feature_def(DNGN_TRAVEL_TRAIL);
+
+                // Don't overwrite the player's symbol
+                if (fd.symbol() && c != you.pos())
                     cell->glyph = fd.symbol();
+                if (fd.colour() != COLOUR_UNDEF)
                     cell->colour = fd.colour();
-                }
 
-                if (travel_mode && travel_colour_override(c))
-                    cell->colour = _get_travel_colour(c);
-
-                if (c == you.pos() && !crawl_state.arena_suspended && on_level)
-                {
-                    // [dshaligram] Draw the @ symbol on the
-                    // level-map. It's no longer saved into the
-                    // env.map_knowledge, so we need to draw it
-                    // directly.
-                    cell->colour = WHITE;
-                    cell->glyph  = mons_char(you.symbol);
-                }
+                cell->colour |= COLFLAG_REVERSE;
+            }
+        }
+    }
+}
 
-                // If we've a waypoint on the current square, *and* the
-                // square is a normal floor square with nothing on it,
-                // show the waypoint number.
-                // XXX: This is a horrible hack.
-                char32_t bc   = cell->glyph;
-                uint8_t ch = is_waypoint(c);
-                if (ch && (bc == _get_sightmap_char(DNGN_FLOOR)
-                           || bc == _get_magicmap_char(DNGN_FLOOR)))
-                {
-                    cell->glyph = ch;
-                }
+static void _draw_level_map(int start_x, int start_y,
+                            const map_glyph_grid &cells, ui::Region region)
+{
+    region.width = min(region.width, GXM);
+    region.height = min(region.height, GYM);
 
-                if (Options.show_travel_trail && travel_trail_index(c) >= 0)
-                {
-                    const feature_def& fd = get_feature_def(DNGN_TRAVEL_TRAIL);
+    const coord_def extents(region.width, region.height);
+    crawl_view_buffer vbuf(extents);
+    screen_cell_t *cell = vbuf;
 
-                    // Don't overwrite the player's symbol
-                    if (fd.symbol() && c != you.pos())
-                        cell->glyph = fd.symbol();
-                    if (fd.colour() != COLOUR_UNDEF)
-                        cell->colour = fd.colour();
+    cursor_control cs(false);
 
-                    cell->colour |= COLFLAG_REVERSE;
-                }
+    for (int screen_y = 0; screen_y < region.height; screen_y++)
+        for (int screen_x = 0; screen_x < region.width; screen_x++)
+        {
+            const coord_def c(start_x + screen_x, start_y + screen_y);
+            if (map_bounds(c))
+            {
+                cell->glyph = cells(c).glyph;
+                cell->colour = cells(c).colour;
+            }
+            else
+            {
+                cell->colour = DARKGREY;
+                cell->glyph  = 0;
             }
-
             cell++;
         }
 
@@ -662,6 +692,49 @@ static map_view_state _init_view_state(const map_control_state& state)
 }
 #endif
 
+#ifndef USE_TILE_LOCAL
+// Does this map command only move the cursor (and so perhaps the view),
+// leaving the map itself as it was?
+static bool _cmd_only_moves_cursor(command_type cmd)
+{
+    switch (cmd)
+    {
+    case CMD_NO_CMD:
+    case CMD_MAP_MOVE_DOWN_LEFT:
+    case CMD_MAP_MOVE_DOWN:
+    case CMD_MAP_MOVE_UP_RIGHT:
+    case CMD_MAP_MOVE_UP:
+    case CMD_MAP_MOVE_UP_LEFT:
+    case CMD_MAP_MOVE_LEFT:
+    case CMD_MAP_MOVE_DOWN_RIGHT:
+    case CMD_MAP_MOVE_RIGHT:
+    case CMD_MAP_JUMP_DOWN_LEFT:
+    case CMD_MAP_JUMP_DOWN:
+    case CMD_MAP_JUMP_UP_RIGHT:
+    case CMD_MAP_JUMP_UP:
+    case CMD_MAP_JUMP_UP_LEFT:
+    case CMD_MAP_JUMP_LEFT:
+    case CMD_MAP_JUMP_DOWN_RIGHT:
+    case CMD_MAP_JUMP_RIGHT:
+    case CMD_MAP_SCROLL_DOWN:
+    case CMD_MAP_SCROLL_UP:
+    case CMD_MAP_FIND_YOU:
+    case CMD_MAP_FIND_UPSTAIR:
+    case CMD_MAP_FIND_DOWNSTAIR:
+    case CMD_MAP_FIND_PORTAL:
+    case CMD_MAP_FIND_TRAP:
+    case CMD_MAP_FIND_ALTAR:
+    case CMD_MAP_FIND_EXCLUDED:
+    case CMD_MAP_FIND_WAYPOINT:
+    case CMD_MAP_FIND_STASH:
+    case CMD_MAP_FIND_STASH_REVERSE:
+        return true;
+    default:
+        return false;
+    }
+}
+#endif
+
 class UIMapView : public ui::Widget
 {
 public:
@@ -702,9 +775,13 @@ public:
         const auto view = _get_view_state(view_ul, m_state);
         view_ul = view.start;
         _draw_title(m_state.lpos.pos, *m_state.feats, m_region.width);
+        if (!m_cells_valid)
+        {
+            _fill_level_map(m_cells, m_state.travel_mode, m_state.on_level);
+            m_cells_valid = true;
+        }
         const ui::Region map_region = {0, 1, m_region.width, m_region.height - 1};
-        _draw_level_map(view_ul.x, view_ul.y, m_state.travel_mode,
-                        m_state.on_level, map_region);
+        _draw_level_map(view_ul.x, view_ul.y, m_cells, map_region);
         // the `+ 1` here is for the map overview line
         ui::show_cursor_at(view.cursor.x, view.cursor.y + 1);
 #endif
@@ -775,6 +852,12 @@ public:
 
     void process_command(command_type cmd)
     {
+#ifndef USE_TILE_LOCAL
+        // Anything but moving the cursor might change the map: waypoints,
+        // exclusions, forgetting the level, describing things...
+        if (!_cmd_only_moves_cursor(cmd))
+            m_cells_valid = false;
+#endif
         auto ret = process_map_command(cmd, m_state);
         // reentry happens if during the process, something else called in to
         // set_lpos. E.g. this can happen via a describe popup. If this
@@ -807,6 +890,9 @@ public:
 
         state.lpos = dest;
         m_state = state;
+#ifndef USE_TILE_LOCAL
+        m_cells_valid = false;
+#endif
 
         if (m_state.lpos.id != level_id::current())
             goto_level();
@@ -819,6 +905,9 @@ public:
     {
         if (m_state.lpos.id != level_id::current())
             m_state.excursion->go_to(m_state.lpos.id);
+#ifndef USE_TILE_LOCAL
+        m_cells_valid = false;
+#endif
 
         m_state.on_level = (level_id::current() == m_state.original);
 
@@ -879,6 +968,9 @@ private:
 
 #ifndef USE_TILE_LOCAL
     coord_def view_ul;
+    // The level map as drawn, and whether it's still right.
+    map_glyph_grid m_cells;
+    bool m_cells_valid = false;
 #endif
 
 #ifdef USE_TILE_LOCAL
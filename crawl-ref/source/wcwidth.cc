@@ -209,6 +209,9 @@ int wcwidth(char32_t ucs)
         return 0;
     if (ucs < 32 || (ucs >= 0x7f && ucs < 0xa0))
         return -1;
+    /* nothing below the first combining character is anything but narrow */
+    if (ucs < 0x300)
+        return 1;
 
     /* binary search in table of non-spacing characters */
     if (bisearch(ucs, combining, ARRAYSZ(combining) - 1))
@@ -63,6 +63,11 @@ game_data_no_cache = True
 # Watch socket dirs for games not started by the server
 # watch_socket_dirs = False
 
+# Ask games to send their output through shared memory rather than the
+# socket, which is cheaper for busy games and many spectators. The ring files
+# are created next to the game's socket. Games that predate this ignore it.
+# shm_transport = False
+
 # use_game_yaml = True
 
 # Game configs
@@ -99,6 +104,7 @@ games = collections.OrderedDict([
         # milestone_path = "./rcs/milestones",
         send_json_options = True,
         # env = {"LANG": "en_US.UTF8"},
+        # zygote_socket = "./rcs/crawl-zygote.sock",
         )),
 ])
 
@@ -21,10 +21,31 @@ define(["jquery", "comm"], function ($, comm) {
         return area.children("span").eq(line);
     }
 
+    // A line is "" if it's blank, and otherwise [text, colour, length,
+    // colour, length, ...], where each colour (fg + 16 * bg, or -1 for
+    // none) covers the next length characters of the text.
     function set_text_area_line(name, line, content)
     {
         var span = get_text_area_line(name, line);
-        span.html(content);
+        span.empty();
+        if (content === "")
+            return;
+
+        var text = content[0];
+        var pos = 0;
+        for (var i = 1; i < content.length; i += 2)
+        {
+            var col = content[i];
+            var part = text.substr(pos, content[i + 1]);
+            pos += content[i + 1];
+            if (col < 0)
+                span.append(document.createTextNode(part));
+            else
+            {
+                span.append($("<span>").addClass("fg" + (col & 15) + " bg"
+                                                 + (col >> 4)).text(part));
+            }
+        }
     }
 
     function handle_text_update(data)
@@ -39,19 +60,32 @@ define(["jquery", "comm"], function ($, comm) {
                     lines.eq(i).empty();
             }
         }
+
+        // Lines copied from where they were before this update.
+        var copies = {};
+        var last_copy = -1;
+        for (var line in data.copy || {})
+        {
+            copies[line] = get_text_area_line(data.id, data.copy[line])
+                               .contents().clone();
+            last_copy = Math.max(last_copy, +line);
+        }
+
         if (area.hasClass("menu_crt_shrink"))
         {
             var klist = Object.keys(data.lines)
             while (klist.length > 0)
             {
                 var i = klist.pop();
-                if (data.lines[i] !== "")
+                if (data.lines[i] !== "" || +i < last_copy)
                     break;
                 delete data.lines[i];
             }
         }
         for (var line in data.lines)
             set_text_area_line(data.id, line, data.lines[line]);
+        for (var line in copies)
+            get_text_area_line(data.id, line).empty().append(copies[line]);
         area.trigger("text_update");
     }
 
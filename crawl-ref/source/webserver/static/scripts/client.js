@@ -1,7 +1,7 @@
-define(["exports", "jquery", "key_conversion", "chat", "comm",
+define(["exports", "jquery", "key_conversion", "chat", "comm", "map_codec",
         "contrib/jquery.cookie", "contrib/jquery.tablesorter",
         "contrib/jquery.waitforimages", "contrib/inflate"],
-function (exports, $, key_conversion, chat, comm) {
+function (exports, $, key_conversion, chat, comm, map_codec) {
 
     // Need to keep this global for backwards compatibility :(
     window.current_layer = "crt";
@@ -72,13 +72,7 @@ function (exports, $, key_conversion, chat, comm) {
             var msgs = msgobj.msgs;
             if (msgs == null)
                 msgs = [ msgobj ];
-            for (var i in msgs)
-            {
-                if (window.log_messages && window.log_messages !== 2)
-                    console.log("Message: " + msgs[i].msg, msgs[i]);
-                if (!comm.handle_message_immediately(msgs[i]))
-                    message_queue.push(msgs[i]);
-            }
+            queue_message_objects(msgs);
         }
         else
         {
@@ -88,6 +82,35 @@ function (exports, $, key_conversion, chat, comm) {
         handle_message_backlog();
     }
 
+    function queue_message_objects(msgs)
+    {
+        for (var i in msgs)
+        {
+            if (window.log_messages && window.log_messages !== 2)
+                console.log("Message: " + msgs[i].msg, msgs[i]);
+            if (!comm.handle_message_immediately(msgs[i]))
+                message_queue.push(msgs[i]);
+        }
+    }
+
+    function enqueue_map_frame(bytes)
+    {
+        var msg;
+        try
+        {
+            msg = map_codec.decode_map_frame(bytes, text_decoder);
+        }
+        catch (e)
+        {
+            console.error("Map frame decoding error:", e);
+            return;
+        }
+        if (window.log_message_size)
+            console.log("Map frame size: " + bytes.length);
+        queue_message_objects([ msg ]);
+        handle_message_backlog();
+    }
+
     function handle_message_backlog()
     {
         while (message_queue.length
@@ -1364,9 +1387,12 @@ function (exports, $, key_conversion, chat, comm) {
         if (watch)
         {
             var watch_user = watch[1];
-            send_message("watch", {
-                username: watch_user
-            });
+            var msg = { username: watch_user };
+            // ?quality=reduced leaves out animations, for slow links.
+            var quality = location.search.match(/[?&]quality=(\w+)/);
+            if (quality)
+                msg.tier = quality[1];
+            send_message("watch", msg);
         }
         else if (play)
         {
@@ -1653,8 +1679,15 @@ function (exports, $, key_conversion, chat, comm) {
 
         if ("WebSocket" in window)
         {
+            // Map frames are decoded synchronously, so this needs the
+            // TextDecoder as well as the inflater for the other messages.
+            var binary_maps = inflater && text_decoder
+                              && !$.cookie("no-binary-map");
+
             // socket_server is set in the client.html template
-            if (inflater)
+            if (binary_maps)
+                socket = new WebSocket(socket_server, "binary-map");
+            else if (inflater)
                 socket = new WebSocket(socket_server);
             else
                 socket = new WebSocket(socket_server, "no-compression");
@@ -1674,9 +1707,19 @@ function (exports, $, key_conversion, chat, comm) {
             {
                 if (inflater && msg.data instanceof ArrayBuffer)
                 {
-                    var data = new Uint8Array(msg.data.byteLength + 4);
-                    data.set(new Uint8Array(msg.data), 0);
-                    data.set([0, 0, 255, 255], msg.data.byteLength);
+                    var bytes = new Uint8Array(msg.data);
+                    if (binary_maps)
+                    {
+                        if (bytes[0] == map_codec.MAP_FRAME)
+                        {
+                            enqueue_map_frame(bytes);
+                            return;
+                        }
+                        bytes = bytes.subarray(1);
+                    }
+                    var data = new Uint8Array(bytes.length + 4);
+                    data.set(bytes, 0);
+                    data.set([0, 0, 255, 255], bytes.length);
                     var decompressed = inflater.append(data);
                     if (decompressed === -1)
                     {
@@ -0,0 +1,152 @@
+define(["jquery"], function ($) {
+    // Decoder for the "binary-map" subprotocol's frames; the format is
+    // described in webtiles/map_codec.py.
+    var JSON_FRAME = 0;
+    var MAP_FRAME = 1;
+
+    var CELL_POS = 1 << 0;
+    var CELL_REPEAT = 1 << 1;
+    var CELL_F = 1 << 2;
+    var CELL_G = 1 << 3;
+    var CELL_COL = 1 << 4;
+    var CELL_BG = 1 << 5;
+    var CELL_FLV = 1 << 6;
+    var CELL_FG = 1 << 7;
+    var CELL_MF = 1 << 8;
+    var CELL_EXTRA = 1 << 9;
+    var CELL_CLOUD = 1 << 10;
+    var CELL_FG_HI = 1 << 11;
+    var CELL_BG_HI = 1 << 12;
+    var CELL_CLOUD_HI = 1 << 13;
+    var CELL_FLV_S = 1 << 14;
+
+    var tile_fields = [
+        ["fg", CELL_FG, CELL_FG_HI],
+        ["bg", CELL_BG, CELL_BG_HI],
+        ["cloud", CELL_CLOUD, CELL_CLOUD_HI]
+    ];
+
+    function reader(bytes, text_decoder)
+    {
+        var pos = 0;
+        return {
+            varint: function ()
+            {
+                // Multiply rather than shift: tile indices can exceed 2^31.
+                var value = 0, scale = 1, b;
+                do
+                {
+                    b = bytes[pos++];
+                    value += (b & 0x7f) * scale;
+                    scale *= 128;
+                }
+                while (b & 0x80);
+                return value;
+            },
+            zigzag: function ()
+            {
+                var v = this.varint();
+                return v % 2 ? -(v + 1) / 2 : v / 2;
+            },
+            json: function ()
+            {
+                var size = this.varint();
+                var text = text_decoder.decode(bytes.subarray(pos, pos + size));
+                pos += size;
+                return JSON.parse(text);
+            },
+            done: function ()
+            {
+                return pos >= bytes.length;
+            }
+        };
+    }
+
+    function read_cell(r, mask)
+    {
+        var cell = {};
+        if (mask & CELL_F)
+            cell.f = r.varint();
+        if (mask & CELL_MF)
+            cell.mf = r.varint();
+        if (mask & CELL_G)
+            cell.g = String.fromCodePoint(r.varint());
+        if (mask & CELL_COL)
+            cell.col = r.varint();
+
+        var t = {}, has_t = false;
+        for (var i = 0; i < tile_fields.length; ++i)
+        {
+            var field = tile_fields[i];
+            if (!(mask & field[1]))
+                continue;
+            var lo = r.varint();
+            t[field[0]] = (mask & field[2]) ? [lo, r.varint()] : lo;
+            has_t = true;
+        }
+        if (mask & CELL_FLV)
+        {
+            t.flv = { f: r.varint() };
+            if (mask & CELL_FLV_S)
+                t.flv.s = r.varint();
+            has_t = true;
+        }
+        if (mask & CELL_EXTRA)
+        {
+            var extra = r.json();
+            if (extra.t)
+            {
+                $.extend(t, extra.t);
+                delete extra.t;
+                has_t = true;
+            }
+            $.extend(cell, extra);
+        }
+        if (has_t)
+            cell.t = t;
+        return cell;
+    }
+
+    // Turn a map frame back into the "map" message the game sent.
+    function decode_map_frame(bytes, text_decoder)
+    {
+        var r = reader(bytes, text_decoder);
+        if (r.varint() != MAP_FRAME)
+            throw new Error("Not a map frame");
+        var msg = r.json();
+        var cells = [];
+        while (!r.done())
+        {
+            var mask = r.varint();
+            var x, y;
+            if (mask & CELL_POS)
+            {
+                x = r.zigzag();
+                y = r.zigzag();
+            }
+            var repeat = (mask & CELL_REPEAT) ? r.varint() : 0;
+            var cell = read_cell(r, mask);
+            // Cells are handed on to code that modifies them, so each copy
+            // in a run needs to be its own object.
+            for (var i = 0; i <= repeat; ++i)
+            {
+                var c = i < repeat ? $.extend(true, {}, cell) : cell;
+                if (i == 0 && (mask & CELL_POS))
+                {
+                    c.x = x;
+                    c.y = y;
+                }
+                cells.push(c);
+            }
+        }
+        if (cells.length)
+            msg.cells = cells;
+        return msg;
+    }
+
+    return {
+        JSON_FRAME: JSON_FRAME,
+        MAP_FRAME: MAP_FRAME,
+        decode_map_frame: decode_map_frame
+    };
+});
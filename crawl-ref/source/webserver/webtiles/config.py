@@ -85,6 +85,7 @@ defaults = {
     },
     'server_socket_path': None,
     'watch_socket_dirs': False,
+    'shm_transport': False,
     'use_game_yaml': True,
     'milestone_file': [],
     'status_file_update_rate': 5,
@@ -1,13 +1,21 @@
 import fcntl
+import json
+import mmap
 import os
 import os.path
 import socket
+import struct
 import tempfile
 import time
 import warnings
 from datetime import datetime
 from datetime import timedelta
 
+try:
+    from typing import Optional
+except ImportError:
+    pass
+
 from tornado.escape import json_encode
 from tornado.escape import to_unicode
 from tornado.escape import utf8
@@ -15,6 +23,53 @@ from tornado.ioloop import IOLoop
 
 from webtiles import config
 
+# Layout of the game's shared memory ring; see webtiles_ring in tileweb.cc.
+RING_MAGIC = 0x52575243
+RING_VERSION = 1
+RING_WRITE_POS = 64
+RING_READ_POS = 128
+RING_DATA = 192
+RING_MESSAGE_PREFIX = b'*{"msg":"ring"'
+
+
+class MessageRing(object):
+    """The reading end of a ring of messages in memory shared with crawl.
+
+    Crawl writes whole messages into the ring and then sends a doorbell over
+    the socket; read() returns everything written since the last call.
+    """
+
+    def __init__(self, path, size):  # type: (str, int) -> None
+        fd = os.open(path, os.O_RDWR)
+        try:
+            self.map = mmap.mmap(fd, RING_DATA + size)
+        finally:
+            os.close(fd)
+        # Nothing else needs to find it now.
+        os.remove(path)
+        magic, version, capacity = struct.unpack_from("=IIQ", self.map, 0)
+        if magic != RING_MAGIC or version != RING_VERSION or capacity != size:
+            self.close()
+            raise ValueError("bad message ring " + path)
+        self.capacity = capacity
+
+    def read(self):  # type: () -> bytes
+        write_pos = struct.unpack_from("=Q", self.map, RING_WRITE_POS)[0]
+        read_pos = struct.unpack_from("=Q", self.map, RING_READ_POS)[0]
+        if write_pos == read_pos:
+            return b""
+        start = RING_DATA + read_pos % self.capacity
+        end = RING_DATA + write_pos % self.capacity
+        if end > start:
+            data = self.map[start:end]
+        else:
+            data = self.map[start:] + self.map[RING_DATA:end]
+        struct.pack_into("=Q", self.map, RING_READ_POS, write_pos)
+        return data
+
+    def close(self):  # type: () -> None
+        self.map.close()
+
 
 class WebtilesSocketConnection(object):
     def __init__(self, socketpath, logger):
@@ -27,6 +82,7 @@ class WebtilesSocketConnection(object):
         self.close_callback = None
 
         self.msg_buffer = None
+        self.ring = None  # type: Optional[MessageRing]
 
     def connect(self, primary = True):
         if not os.path.exists(self.crawl_socketpath):
@@ -69,10 +125,14 @@ class WebtilesSocketConnection(object):
                                      self._handle_read,
                                      IOLoop.ERROR | IOLoop.READ)
 
-        msg = json_encode({
+        attach = {
                 "msg": "attach",
                 "primary": primary
-                })
+                }
+        if config.get("shm_transport"):
+            # Games that don't know about this just ignore it.
+            attach["shm"] = True
+        msg = json_encode(attach)
 
         self.open = True
 
@@ -100,9 +160,34 @@ class WebtilesSocketConnection(object):
         else:
             self.msg_buffer = None
 
-            if self.message_callback:
+            if data.startswith(RING_MESSAGE_PREFIX):
+                self._handle_ring_message(data)
+            elif self.message_callback:
                 self.message_callback(to_unicode(data))
 
+    def _handle_ring_message(self, data): # type: (bytes) -> None
+        msg = json.loads(to_unicode(data[1:]))
+        if "path" in msg:
+            # The game has set up a ring for us.
+            if self.ring:
+                self.ring.close()
+            try:
+                self.ring = MessageRing(msg["path"], msg["size"])
+            except (EnvironmentError, ValueError):
+                # The game doesn't fall back to the socket by itself, so
+                # there's no recovering from this.
+                self.logger.error("Can't open message ring", exc_info=True)
+                self.close()
+            return
+
+        # A doorbell: there are messages in the ring.
+        if not self.ring:
+            return
+        # Every message ends with \n, so the last piece is always empty.
+        for line in self.ring.read().split(b"\n")[:-1]:
+            if self.message_callback:
+                self.message_callback(to_unicode(line + b"\n"))
+
     def send_message(self, data): # type: (str) -> None
         start = datetime.now()
         try:
@@ -121,5 +206,8 @@ class WebtilesSocketConnection(object):
             self.socket.close()
             os.remove(self.socketpath)
             self.socket = None
+        if self.ring:
+            self.ring.close()
+            self.ring = None
         if self.close_callback:
             self.close_callback()
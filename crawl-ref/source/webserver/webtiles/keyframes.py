@@ -0,0 +1,81 @@
+"""Server side cache of a game's state, for serving new spectators.
+
+Whenever crawl sends everything it has (its _send_everything()), it brackets
+the messages with "*keyframe_start" and "*keyframe_end". We keep the last
+such keyframe and every update that followed it; replaying those to a new
+spectator brings them up to date without the game having to rebuild its
+state again.
+
+Once the updates since the keyframe pass a size limit, the game is asked for
+a fresh keyframe for us alone.
+
+Games that predate this never send a keyframe, so the cache stays empty and
+spectators are served by "spectator_joined" as before.
+"""
+
+try:
+    from typing import List, Optional
+except ImportError:
+    pass
+
+# Updates kept after the keyframe before asking for a new one, in bytes.
+DELTA_LIMIT = 1024 * 1024
+
+# Messages that are nothing but a pause for animation: replaying these would
+# only hold up the new spectator.
+_SKIPPED_PREFIXES = ('{"msg":"delay"',)
+
+
+class KeyframeCache(object):
+    def __init__(self, delta_limit=DELTA_LIMIT):  # type: (int) -> None
+        self.delta_limit = delta_limit
+        self._keyframe = None  # type: Optional[List[str]]
+        self._deltas = []  # type: List[str]
+        self._delta_bytes = 0
+        self._capture = None  # type: Optional[List[str]]
+        self._capture_shared = False
+        self._requested = False
+
+    def handle_server_message(self, msgobj):  # type: (dict) -> bool
+        """Handle a keyframe marker from the game; False if it isn't one."""
+        if msgobj["msg"] == "keyframe_start":
+            self._capture = []
+            # A keyframe sent to everyone is also an update for everyone.
+            self._capture_shared = bool(msgobj.get("shared"))
+            return True
+        if msgobj["msg"] == "keyframe_end":
+            if self._capture is not None:
+                self._keyframe = self._capture
+                self._deltas = []
+                self._delta_bytes = 0
+            self._capture = None
+            self._requested = False
+            return True
+        return False
+
+    def add(self, msg):  # type: (str) -> bool
+        """Record a message from the game.
+
+        Returns whether it should also go on to the receivers.
+        """
+        if self._capture is not None:
+            self._capture.append(msg)
+            return self._capture_shared
+        if self._keyframe is not None and not msg.startswith(_SKIPPED_PREFIXES):
+            self._deltas.append(msg)
+            self._delta_bytes += len(msg)
+        return True
+
+    def replay(self):  # type: () -> Optional[List[str]]
+        """Everything a new spectator needs, or None if we can't say."""
+        if self._keyframe is None or self._capture is not None:
+            return None
+        return self._keyframe + self._deltas
+
+    def wants_keyframe(self):  # type: () -> bool
+        """True, once, when it's time to ask the game for a new keyframe."""
+        if (self._requested or self._keyframe is None
+                or self._delta_bytes < self.delta_limit):
+            return False
+        self._requested = True
+        return True
@@ -0,0 +1,55 @@
+from webtiles import keyframes
+
+
+def _keyframe(cache, messages, shared=False):
+    start = {"msg": "keyframe_start"}
+    if shared:
+        start["shared"] = True
+    assert cache.handle_server_message(start)
+    forwarded = [m for m in messages if cache.add(m)]
+    assert cache.handle_server_message({"msg": "keyframe_end"})
+    return forwarded
+
+
+class Test_KeyframeCache:
+    def test_nothing_without_keyframe(self):
+        cache = keyframes.KeyframeCache()
+        assert cache.add('{"msg":"player"}')
+        assert cache.replay() is None
+        assert not cache.wants_keyframe()
+
+    def test_replays_keyframe_and_deltas(self):
+        cache = keyframes.KeyframeCache()
+        assert _keyframe(cache, ["a", "b"], shared=True) == ["a", "b"]
+        assert cache.add("c")
+        assert cache.add('{"msg":"delay","t":50}')
+        assert cache.replay() == ["a", "b", "c"]
+
+    def test_private_keyframe_replaces_cache(self):
+        cache = keyframes.KeyframeCache()
+        _keyframe(cache, ["a"], shared=True)
+        cache.add("b")
+        assert _keyframe(cache, ["c"]) == []
+        cache.add("d")
+        assert cache.replay() == ["c", "d"]
+
+    def test_no_replay_mid_keyframe(self):
+        cache = keyframes.KeyframeCache()
+        _keyframe(cache, ["a"])
+        cache.handle_server_message({"msg": "keyframe_start"})
+        cache.add("b")
+        assert cache.replay() is None
+
+    def test_asks_once_for_keyframe(self):
+        cache = keyframes.KeyframeCache(delta_limit=10)
+        _keyframe(cache, ["a"])
+        cache.add("x" * 10)
+        assert cache.wants_keyframe()
+        assert not cache.wants_keyframe()
+        _keyframe(cache, ["b"])
+        cache.add("x" * 10)
+        assert cache.wants_keyframe()
+
+    def test_other_server_messages(self):
+        cache = keyframes.KeyframeCache()
+        assert not cache.handle_server_message({"msg": "flush_messages"})
@@ -0,0 +1,338 @@
+"""Compact binary encoding of the game's "map" messages.
+
+Crawl sends map updates as JSON, with field names repeated for every cell.
+Sockets that negotiate the "binary-map" subprotocol get those messages
+re-encoded as binary websocket frames instead; everything else is still sent
+as (deflated) JSON. Each binary frame starts with a tag byte, one of
+JSON_FRAME or MAP_FRAME.
+
+A map frame is laid out as:
+
+    MAP_FRAME
+    varint length, header JSON   -- the message without "cells"
+    cell records, to the end of the frame
+
+and each cell record as:
+
+    varint mask                  -- CELL_* bits below
+    zigzag x, zigzag y           -- if CELL_POS
+    varint count                 -- if CELL_REPEAT: this many more identical
+                                    cells follow, at successive x
+    varint f, mf, glyph code point, col
+    varint fg [, hi], bg [, hi], cloud [, hi]
+    varint flavour floor [, special]
+    varint length, JSON          -- if CELL_EXTRA: every other field
+
+All values are unsigned LEB128 varints. Fields are present only if their bit
+is set. A tile with a *_HI bit was sent as [lo, hi] by the game, and is
+rebuilt that way.
+
+static/scripts/map_codec.js decodes these frames; decode_map_frame() here
+mirrors it for testing.
+"""
+
+import json
+import numbers
+
+try:
+    from typing import Any, Dict, List, Optional, Tuple
+except ImportError:
+    pass
+
+try:
+    unichr
+except NameError:
+    unichr = chr
+
+JSON_FRAME = 0
+MAP_FRAME = 1
+
+# Ordered so that the usual floor and wall cells need a one byte mask.
+CELL_POS = 1 << 0
+CELL_REPEAT = 1 << 1
+CELL_F = 1 << 2
+CELL_G = 1 << 3
+CELL_COL = 1 << 4
+CELL_BG = 1 << 5
+CELL_FLV = 1 << 6
+CELL_FG = 1 << 7
+CELL_MF = 1 << 8
+CELL_EXTRA = 1 << 9
+CELL_CLOUD = 1 << 10
+CELL_FG_HI = 1 << 11
+CELL_BG_HI = 1 << 12
+CELL_CLOUD_HI = 1 << 13
+CELL_FLV_S = 1 << 14
+
+_TILE_FIELDS = (
+    ("fg", CELL_FG, CELL_FG_HI),
+    ("bg", CELL_BG, CELL_BG_HI),
+    ("cloud", CELL_CLOUD, CELL_CLOUD_HI),
+)
+
+# How the game starts every map message (see TilesFramework::_send_map).
+MAP_MESSAGE_PREFIX = '{"msg":"map"'
+
+
+class MapFrame(object):
+    """An encoded map message waiting in a socket's queue."""
+
+    __slots__ = ("data", "json_size")
+
+    def __init__(self, data, json_size):  # type: (bytes, int) -> None
+        self.data = data
+        self.json_size = json_size
+
+
+def _write_varint(out, value):  # type: (bytearray, int) -> None
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+
+
+def _zigzag(value):  # type: (int) -> int
+    return value * 2 if value >= 0 else -value * 2 - 1
+
+
+def _unzigzag(value):  # type: (int) -> int
+    return value >> 1 if not value & 1 else -((value + 1) >> 1)
+
+
+def _is_uint(value):  # type: (Any) -> bool
+    return (isinstance(value, numbers.Integral)
+            and not isinstance(value, bool) and value >= 0)
+
+
+def _is_int(value):  # type: (Any) -> bool
+    return isinstance(value, numbers.Integral) and not isinstance(value, bool)
+
+
+def _json_bytes(obj):  # type: (Any) -> bytes
+    text = json.dumps(obj, separators=(",", ":"))
+    if not isinstance(text, bytes):
+        text = text.encode("ascii")
+    return text
+
+
+def _encode_tile(out, value, bit, hi_bit):
+    # type: (bytearray, Any, int, int) -> int
+    if _is_uint(value):
+        _write_varint(out, value)
+        return bit
+    if (isinstance(value, list) and len(value) == 2
+            and _is_uint(value[0]) and _is_uint(value[1])):
+        _write_varint(out, value[0])
+        _write_varint(out, value[1])
+        return bit | hi_bit
+    return 0
+
+
+def _encode_cell(cell):  # type: (Dict[str, Any]) -> Tuple[int, bytes]
+    """Encode a cell's contents (not its position).
+
+    Anything without a compact form goes into the CELL_EXTRA JSON, so every
+    cell can be encoded.
+    """
+    mask = 0
+    out = bytearray()
+    extra = {}  # type: Dict[str, Any]
+
+    for key, value in cell.items():
+        if key == "x" or key == "y":
+            continue
+
+        if key == "f" and _is_uint(value):
+            mask |= CELL_F
+        elif key == "mf" and _is_uint(value):
+            mask |= CELL_MF
+        elif (key == "g" and isinstance(value, type(u""))
+              and len(value) == 1):
+            mask |= CELL_G
+        elif key == "col" and _is_uint(value):
+            mask |= CELL_COL
+        elif key != "t" or not isinstance(value, dict):
+            extra[key] = value
+
+    for key, bit in (("f", CELL_F), ("mf", CELL_MF), ("g", CELL_G),
+                     ("col", CELL_COL)):
+        if mask & bit:
+            value = cell[key]
+            _write_varint(out, ord(value) if bit == CELL_G else value)
+
+    tile = cell.get("t")
+    if isinstance(tile, dict):
+        rest = dict(tile)
+        for key, bit, hi_bit in _TILE_FIELDS:
+            if key in tile:
+                written = _encode_tile(out, tile[key], bit, hi_bit)
+                if written:
+                    mask |= written
+                    del rest[key]
+        flv = tile.get("flv")
+        if (isinstance(flv, dict) and _is_uint(flv.get("f"))
+                and set(flv) <= {"f", "s"}
+                and ("s" not in flv or _is_uint(flv["s"]))):
+            mask |= CELL_FLV
+            _write_varint(out, flv["f"])
+            if "s" in flv:
+                mask |= CELL_FLV_S
+                _write_varint(out, flv["s"])
+            del rest["flv"]
+        if rest:
+            extra["t"] = rest
+
+    if extra:
+        mask |= CELL_EXTRA
+        blob = _json_bytes(extra)
+        _write_varint(out, len(blob))
+        out += blob
+
+    return mask, bytes(out)
+
+
+def _has_pos(cell):  # type: (Dict[str, Any]) -> bool
+    return _is_int(cell.get("x")) and _is_int(cell.get("y"))
+
+
+# The game's messages are handed to each of its receivers in turn, so the
+# last encoding is usually what the next socket asks for.
+_last_encoded = (None, None)  # type: Tuple[Optional[str], Optional[MapFrame]]
+
+
+def encode_map_message(text):  # type: (str) -> Optional[MapFrame]
+    """Encode one map message from the game, or None if it isn't one."""
+    global _last_encoded
+    if not text.startswith(MAP_MESSAGE_PREFIX):
+        return None
+    if _last_encoded[0] is text:
+        return _last_encoded[1]
+    frame = _encode_map_message(text)
+    _last_encoded = (text, frame)
+    return frame
+
+
+def _encode_map_message(text):  # type: (str) -> Optional[MapFrame]
+    try:
+        msg = json.loads(text)
+    except ValueError:
+        return None
+    cells = msg.pop("cells", [])
+    if not isinstance(cells, list) or not all(isinstance(c, dict)
+                                              for c in cells):
+        return None
+    # A lone x or y would otherwise be dropped as a position.
+    if any(("x" in c or "y" in c) and not _has_pos(c) for c in cells):
+        return None
+
+    out = bytearray([MAP_FRAME])
+    header = _json_bytes(msg)
+    _write_varint(out, len(header))
+    out += header
+
+    pending = None  # type: Optional[List[Any]]
+
+    def flush(pending):  # type: (List[Any]) -> None
+        mask, body, pos, repeat = pending
+        if pos is not None:
+            mask |= CELL_POS
+        if repeat:
+            mask |= CELL_REPEAT
+        _write_varint(out, mask)
+        if pos is not None:
+            _write_varint(out, _zigzag(pos[0]))
+            _write_varint(out, _zigzag(pos[1]))
+        if repeat:
+            _write_varint(out, repeat)
+        out.extend(body)
+
+    for cell in cells:
+        mask, body = _encode_cell(cell)
+        pos = (cell["x"], cell["y"]) if _has_pos(cell) else None
+        # The game only omits the position for the cell right after the
+        # previous one, so an unplaced copy of the last record is a run.
+        if (pending is not None and pos is None
+                and pending[0] == mask and pending[1] == body):
+            pending[3] += 1
+            continue
+        if pending is not None:
+            flush(pending)
+        pending = [mask, body, pos, 0]
+    if pending is not None:
+        flush(pending)
+
+    return MapFrame(bytes(out), len(text))
+
+
+class _Reader(object):
+    def __init__(self, data):  # type: (bytes) -> None
+        self.data = bytearray(data)
+        self.pos = 0
+
+    def varint(self):  # type: () -> int
+        value = 0
+        shift = 0
+        while True:
+            byte = self.data[self.pos]
+            self.pos += 1
+            value |= (byte & 0x7F) << shift
+            if byte < 0x80:
+                return value
+            shift += 7
+
+    def json(self):  # type: () -> Any
+        size = self.varint()
+        blob = bytes(self.data[self.pos:self.pos + size])
+        self.pos += size
+        return json.loads(blob.decode("utf-8"))
+
+    def done(self):  # type: () -> bool
+        return self.pos >= len(self.data)
+
+
+def decode_map_frame(data):  # type: (bytes) -> Dict[str, Any]
+    """Rebuild the JSON map message from a map frame."""
+    reader = _Reader(data)
+    if reader.varint() != MAP_FRAME:
+        raise ValueError("not a map frame")
+    msg = reader.json()
+    cells = []
+    while not reader.done():
+        mask = reader.varint()
+        cell = {}  # type: Dict[str, Any]
+        if mask & CELL_POS:
+            cell["x"] = _unzigzag(reader.varint())
+            cell["y"] = _unzigzag(reader.varint())
+        repeat = reader.varint() if mask & CELL_REPEAT else 0
+        if mask & CELL_F:
+            cell["f"] = reader.varint()
+        if mask & CELL_MF:
+            cell["mf"] = reader.varint()
+        if mask & CELL_G:
+            cell["g"] = unichr(reader.varint())
+        if mask & CELL_COL:
+            cell["col"] = reader.varint()
+        tile = {}  # type: Dict[str, Any]
+        for key, bit, hi_bit in _TILE_FIELDS:
+            if mask & bit:
+                lo = reader.varint()
+                tile[key] = [lo, reader.varint()] if mask & hi_bit else lo
+        if mask & CELL_FLV:
+            tile["flv"] = {"f": reader.varint()}
+            if mask & CELL_FLV_S:
+                tile["flv"]["s"] = reader.varint()
+        if mask & CELL_EXTRA:
+            extra = reader.json()
+            tile.update(extra.pop("t", {}))
+            cell.update(extra)
+        if tile:
+            cell["t"] = tile
+        cells.append(cell)
+        for _ in range(repeat):
+            copy = json.loads(json.dumps(cell))
+            copy.pop("x", None)
+            copy.pop("y", None)
+            cells.append(copy)
+    if cells:
+        msg["cells"] = cells
+    return msg
@@ -0,0 +1,54 @@
+import json
+
+import pytest
+
+from webtiles import map_codec
+
+
+def _map_message(cells, **fields):
+    msg = {"msg": "map"}
+    msg.update(fields)
+    if cells:
+        msg["cells"] = cells
+    # match the game: "msg" comes first, no whitespace
+    body = json.dumps(msg, separators=(",", ":"))[len('{"msg":"map"'):]
+    return '{"msg":"map"' + body
+
+
+class Test_encode_map_message:
+    @pytest.mark.parametrize("cells, fields", [
+        ([], {"clear": True}),
+        ([{"x": -3, "y": 7, "f": 12, "mf": 2, "g": "#", "col": 7,
+           "t": {"fg": 5, "bg": [1048576, 2]}}],
+         {"vgrdc": {"x": 0, "y": 0}}),
+        ([{"x": 0, "y": 0, "t": {"bg": 2}}, {"t": {"bg": 2}},
+          {"t": {"bg": 2}}, {"x": 0, "y": 1, "t": {"bg": 2}}], {}),
+        ([{"x": 1, "y": 1, "mon": {"id": 3, "name": "rat"},
+           "t": {"fg": 9, "cloud": 4, "flv": {"f": 1}, "ov": [3, 4]}}], {}),
+        ([{"x": 2, "y": 2, "g": u"\u2663", "mon": None}], {}),
+        ([{"x": 0, "y": 5, "t": {"bg": 3, "flv": {"f": 2, "s": 8}}},
+          {"t": {"flv": {"f": 1, "x": 4}}}], {}),
+        ([{"x": 2, "y": 2, "g": u"\U0001F40D", "t": {"fg": [0, 0]}}], {}),
+    ])
+    def test_round_trip(self, cells, fields):
+        text = _map_message(cells, **fields)
+        frame = map_codec.encode_map_message(text)
+        assert frame is not None
+        assert map_codec.decode_map_frame(frame.data) == json.loads(text)
+
+    def test_runs_are_collapsed(self):
+        row = [{"x": 0, "y": 0, "t": {"bg": 2147483648}}]
+        row += [{"t": {"bg": 2147483648}} for _ in range(79)]
+        text = _map_message(row, clear=True)
+        frame = map_codec.encode_map_message(text)
+        assert len(frame.data) < 40
+        assert map_codec.decode_map_frame(frame.data) == json.loads(text)
+
+    @pytest.mark.parametrize("text", [
+        '{"msg":"player","hp":10}',
+        '{"msg":"map_view"}',
+        '{"msg":"map","cells":[{"x":1}]}',
+        '{"msg":"map","cells":[{"x":1,',
+    ])
+    def test_not_encoded(self, text):
+        assert map_codec.encode_map_message(text) is None
@@ -17,16 +17,18 @@ from tornado.escape import xhtml_escape
 from tornado.ioloop import IOLoop
 from tornado.ioloop import PeriodicCallback
 
-from webtiles import config, connection, game_data_handler, inotify, terminal, util, ws_handler
+from webtiles import config, connection, game_data_handler, inotify, quality, terminal, util, ws_handler
 from webtiles.connection import WebtilesSocketConnection
 from webtiles.game_data_handler import GameDataHandler
 from webtiles.inotify import DirectoryWatcher
+from webtiles.keyframes import KeyframeCache
+from webtiles.quality import AnimationFilter
 from webtiles.terminal import TerminalRecorder
 from webtiles.util import DynamicTemplateLoader, dgl_format_str, parse_where_data
 from webtiles.ws_handler import CrawlWebSocket, remove_in_lobbys, update_all_lobbys
 
 try:
-    from typing import Dict, Set, Tuple, Any
+    from typing import Any, Dict, Optional, Set, Tuple
 except:
     pass
 
@@ -140,6 +142,8 @@ class CrawlProcessHandlerBase(object):
         self._was_idle = False
         self.last_watcher_join = 0
         self.receiving_direct_milestones = False
+        # The game's last report of its memory use, by subsystem.
+        self.memory_stats = None # type: Optional[Dict[str, Any]]
 
         global last_game_id
         self.id = last_game_id + 1
@@ -181,10 +185,18 @@ class CrawlProcessHandlerBase(object):
         for receiver in self._receivers:
             receiver.flush_messages()
 
-    def write_to_all(self, msg, send): # type: (str, bool) -> None
+    def write_to_all(self, msg, send, skip_tier=None):
+        # type: (str, bool, Optional[str]) -> None
         for receiver in self._receivers:
+            if skip_tier is not None and self.quality_of(receiver) == skip_tier:
+                if send:
+                    receiver.flush_messages()
+                continue
             receiver.append_message(msg, send)
 
+    def quality_of(self, receiver): # type: (Any) -> str
+        return receiver.quality
+
     def send_to_all(self, msg, **data): # type: (str, Any) -> None
         for receiver in self._receivers:
             receiver.send_message(msg, **data)
@@ -632,6 +644,12 @@ class CrawlProcessHandler(CrawlProcessHandlerBase):
         self._purging_timer = None
         self._process_hup_timeout = None
 
+        self.keyframes = KeyframeCache()
+        self.animations = AnimationFilter()
+        # Spectators who joined partway through an animation, and so can't
+        # pick its frames up from the middle.
+        self._joined_mid_animation = set() # type: Set[Any]
+
     def start(self):
         self._purge_locks_and_start(True)
 
@@ -790,12 +808,25 @@ class CrawlProcessHandler(CrawlProcessHandlerBase):
                                             self.logger,
                                             config.get('recording_term_size'),
                                             env_vars = game.get("env", {}),
-                                            game_cwd = game.get("cwd", None),)
+                                            game_cwd = game.get("cwd", None),
+                                            zygote_socket = game.get("zygote_socket", None),)
             self.process.end_callback = self._on_process_end
             self.process.output_callback = self._on_process_output
             self.process.activity_callback = self.note_activity
             self.process.error_callback = self._on_process_error
 
+            self.process.start(self._on_process_started)
+        except Exception:
+            self.logger.warning("Error while starting the Crawl process!", exc_info=True)
+            self._on_process_start_failed()
+
+    def _on_process_started(self, started):
+        if not started:
+            self.process = None
+            self._on_process_start_failed()
+            return
+
+        try:
             self.gen_inprogress_lock()
 
             self.connect(self.socketpath, True)
@@ -809,18 +840,25 @@ class CrawlProcessHandler(CrawlProcessHandlerBase):
             self.check_where()
         except Exception:
             self.logger.warning("Error while starting the Crawl process!", exc_info=True)
-            self.exit_reason = "error"
-            self.exit_message = "Error while starting the Crawl process!\nSomething has gone very wrong; please let a server admin know."
-            self.exit_dump_url = None
+            self._on_process_start_failed()
 
-            if self.process:
-                self.stop()
-            else:
-                self._on_process_end()
+    def _on_process_start_failed(self):
+        self.exit_reason = "error"
+        self.exit_message = "Error while starting the Crawl process!\nSomething has gone very wrong; please let a server admin know."
+        self.exit_dump_url = None
+
+        if self.process and self.process.pid is not None:
+            self.stop()
+        else:
+            self.process = None
+            self._on_process_end()
 
     def connect(self, socketpath, primary = False):
         self.socketpath = socketpath
         self.conn = WebtilesSocketConnection(self.socketpath, self.logger)
+        self.keyframes = KeyframeCache()
+        self.animations = AnimationFilter()
+        self._joined_mid_animation = set()
         self.conn.message_callback = self._on_socket_message
         self.conn.close_callback = self._on_socket_close
         self.conn.connect(primary)
@@ -889,11 +927,34 @@ class CrawlProcessHandler(CrawlProcessHandlerBase):
 
 
     def add_watcher(self, watcher):
+        if self.animations.in_animation():
+            self._joined_mid_animation.add(watcher)
         super(CrawlProcessHandler, self).add_watcher(watcher)
 
-        if self.conn and self.conn.open:
+        # New spectators are caught up from the cache if we can, by
+        # catch_up(), rather than have the game send everything again.
+        if self.keyframes.replay() is None and self.conn and self.conn.open:
             self.conn.send_message('{"msg":"spectator_joined"}')
 
+    def remove_watcher(self, watcher):
+        self._joined_mid_animation.discard(watcher)
+        super(CrawlProcessHandler, self).remove_watcher(watcher)
+
+    def quality_of(self, receiver): # type: (Any) -> str
+        if receiver in self._joined_mid_animation:
+            return quality.REDUCED
+        return receiver.quality
+
+    def catch_up(self, watcher):
+        """Replay the cached game state to a watcher added without asking
+        the game for it."""
+        replay = self.keyframes.replay()
+        if replay is None:
+            return
+        for msg in replay:
+            watcher.append_message(msg, False)
+        watcher.flush_messages()
+
     def handle_input(self, msg): # type: (str) -> None
         obj = json_decode(msg)
 
@@ -981,7 +1042,12 @@ class CrawlProcessHandler(CrawlProcessHandlerBase):
             # Special message to the server
             msg = msg[1:]
             msgobj = json_decode(msg)
-            if msgobj["msg"] == "client_path":
+            if msgobj["msg"] in ("keyframe_start", "keyframe_end"):
+                self.keyframes.handle_server_message(msgobj)
+            elif self.animations.handle_server_message(msgobj):
+                if not self.animations.in_animation():
+                    self._joined_mid_animation.clear()
+            elif msgobj["msg"] == "client_path":
                 if self.client_path == None:
                     self.client_path = self.format_path(msgobj["path"])
                     if "version" in msgobj:
@@ -1010,12 +1076,23 @@ class CrawlProcessHandler(CrawlProcessHandlerBase):
                 # message
                 self.receiving_direct_milestones = True # no need for .where files
                 self.set_where_info(msgobj)
+            elif msgobj["msg"] == "memory":
+                self.memory_stats = msgobj
+                self.logger.debug("Memory use at turn %s: %d KB resident.",
+                                  msgobj.get("turn"),
+                                  msgobj.get("rss", 0) // 1024)
             else:
                 self.logger.warning("Unknown message from the crawl process: %s",
                                     msgobj["msg"])
         else:
             self.check_where()
-            if time.time() > self.last_watcher_join + 2:
+            # The cache follows the reduced tier, which skips animations.
+            # A private keyframe is only for the cache.
+            skip_tier = self.animations.skipped_by(msg)
+            forward = True
+            if skip_tier != quality.REDUCED:
+                forward = self.keyframes.add(msg)
+            if forward and time.time() > self.last_watcher_join + 2:
                 # Treat socket messages as activity, since it's otherwise
                 # hard to determine activity for games found via
                 # watch_socket_dirs.
@@ -1023,7 +1100,11 @@ class CrawlProcessHandler(CrawlProcessHandlerBase):
                 # want that to reset idle time.
                 self.note_activity()
 
-            self.write_to_all(msg, not self.queue_messages)
+            if forward:
+                self.write_to_all(msg, not self.queue_messages, skip_tier)
+            if (self.keyframes.wants_keyframe()
+                    and self.conn and self.conn.open):
+                self.conn.send_message('{"msg":"keyframe"}')
 
 
 
@@ -0,0 +1,51 @@
+"""Quality tiers for spectators, so that those on slow links get less.
+
+Crawl sends the frames of an animation between "*anim_start" and
+"*anim_summary", and then, up to "*anim_end", the animation's net effect on
+the map and player as one update against what was sent before the frames.
+Spectators on the full tier get the frames and not the summary; those on the
+reduced tier get the summary instead of the frames' map and player updates
+and delays. Anything else sent during the frames (messages, menus) goes to
+everyone.
+"""
+
+try:
+    from typing import Optional
+except ImportError:
+    pass
+
+FULL = "full"
+REDUCED = "reduced"
+TIERS = (FULL, REDUCED)
+
+# The parts of an animation frame that the summary makes up for.
+_FRAME_PREFIXES = ('{"msg":"map"', '{"msg":"player"', '{"msg":"flash"',
+                   '{"msg":"delay"')
+
+
+class AnimationFilter(object):
+    def __init__(self):  # type: () -> None
+        self._section = None  # type: Optional[str]
+
+    def handle_server_message(self, msgobj):  # type: (dict) -> bool
+        """Handle an animation marker from the game; False if it isn't one."""
+        if msgobj["msg"] == "anim_start":
+            self._section = "frames"
+        elif msgobj["msg"] == "anim_summary":
+            self._section = "summary"
+        elif msgobj["msg"] == "anim_end":
+            self._section = None
+        else:
+            return False
+        return True
+
+    def in_animation(self):  # type: () -> bool
+        return self._section is not None
+
+    def skipped_by(self, msg):  # type: (str) -> Optional[str]
+        """The tier that shouldn't get msg, if any."""
+        if self._section == "summary":
+            return FULL
+        if self._section == "frames" and msg.startswith(_FRAME_PREFIXES):
+            return REDUCED
+        return None
@@ -0,0 +1,31 @@
+from webtiles import quality
+
+
+class Test_AnimationFilter:
+    def test_nothing_skipped_outside_animations(self):
+        f = quality.AnimationFilter()
+        assert not f.in_animation()
+        assert f.skipped_by('{"msg":"map"}') is None
+        assert f.skipped_by('{"msg":"delay","t":50}') is None
+
+    def test_frames_and_summary(self):
+        f = quality.AnimationFilter()
+        assert f.handle_server_message({"msg": "anim_start"})
+        assert f.in_animation()
+        assert f.skipped_by('{"msg":"map","cells":[]}') == quality.REDUCED
+        assert f.skipped_by('{"msg":"player","hp":3}') == quality.REDUCED
+        assert f.skipped_by('{"msg":"delay","t":50}') == quality.REDUCED
+        assert f.skipped_by('{"msg":"msgs","messages":[]}') is None
+
+        assert f.handle_server_message({"msg": "anim_summary"})
+        assert f.skipped_by('{"msg":"map","cells":[]}') == quality.FULL
+        assert f.skipped_by('{"msg":"player","hp":3}') == quality.FULL
+
+        assert f.handle_server_message({"msg": "anim_end"})
+        assert not f.in_animation()
+        assert f.skipped_by('{"msg":"map"}') is None
+
+    def test_other_markers_ignored(self):
+        f = quality.AnimationFilter()
+        assert not f.handle_server_message({"msg": "keyframe_start"})
+        assert not f.in_animation()
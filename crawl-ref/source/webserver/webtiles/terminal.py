@@ -1,8 +1,12 @@
+import array
+import errno
 import fcntl
+import json
 import os
 import pty
 import resource
 import signal
+import socket
 import struct
 import sys
 import termios
@@ -13,6 +17,8 @@ from tornado.escape import to_unicode
 from tornado.ioloop import IOLoop
 
 BUFSIZ = 2048
+# How long a zygote has to answer before the game is run directly instead.
+ZYGOTE_TIMEOUT = 2
 
 class TerminalRecorder(object):
     def __init__(self,
@@ -23,12 +29,19 @@ class TerminalRecorder(object):
                  termsize,
                  env_vars, # type: Dict[str, str]
                  game_cwd, # type: Optional[str]
+                 zygote_socket=None, # type: Optional[str]
                  ):
         """
         Args:
             command: argv of command to run, eg [cmd, args, ...]
             env_vars: dictionary of environment variables to set. The variables
                 COLUMNS, LINES, and TERM cannot be overriden.
+            zygote_socket: socket of a `crawl -zygote` process to ask for the
+                game, instead of starting `command` ourselves. If the zygote
+                can't be reached, or doesn't answer in time, the command is
+                run as usual.
+
+        The game isn't started until start() is called.
         """
         self.command = command
         if filename:
@@ -41,6 +54,7 @@ class TerminalRecorder(object):
         self.termsize = termsize
         self.env_vars = env_vars
         self.game_cwd = game_cwd
+        self.zygote_socket = zygote_socket
 
         self.pid = None
         self.child_fd = None
@@ -53,14 +67,155 @@ class TerminalRecorder(object):
         self.errpipe_read = None
         self.error_buffer = b""
 
+        self.zygote_conn = None # type: Optional[socket.socket]
+        self.zygote_buffer = b""
+        self.zygote_timeout = None
+
+        self.start_callback = None
+        self.pending_signal = None
+
         self.logger = logger
 
         if id_header:
             self.write_ttyrec_chunk(id_header)
 
-        self._spawn()
+    def _game_env(self):
+        cols, lines = self.get_terminal_size()
+        env            = dict(os.environ)
+        env.update(self.env_vars)
+        env["COLUMNS"] = str(cols)
+        env["LINES"]   = str(lines)
+        env["TERM"]    = "linux"
+        return env
+
+    def start(self, callback):
+        """Start the game, and then call callback(True), or callback(False)
+        if it couldn't be started. That can happen before this returns. A
+        zygote is asked for the game without blocking the IOLoop, so one that
+        is slow or stuck doesn't hold up everybody else."""
+        self.start_callback = callback
+        if not (self.zygote_socket and self._ask_zygote()):
+            self._start_directly()
+
+    def _start_directly(self):
+        try:
+            self._spawn_process()
+        except Exception:
+            self.logger.warning("Error while starting the Crawl process!",
+                                exc_info=True)
+            self.start_callback(False)
+            return
+        self._spawned()
+
+    def _spawned(self):
+        IOLoop.current().add_handler(self.child_fd,
+                                     self._handle_read,
+                                     IOLoop.ERROR | IOLoop.READ)
 
-    def _spawn(self):
+        IOLoop.current().add_handler(self.errpipe_read,
+                                     self._handle_err_read,
+                                     IOLoop.READ)
+
+        if self.zygote_conn:
+            IOLoop.current().add_handler(self.zygote_conn.fileno(),
+                                         self._handle_zygote_read,
+                                         IOLoop.ERROR | IOLoop.READ)
+
+        if self.pending_signal is not None:
+            self.send_signal(self.pending_signal)
+        self.start_callback(True)
+
+    def _ask_zygote(self):
+        # Sends the request, and returns whether the reply should be waited
+        # for; it is read by _handle_zygote_reply.
+        # Passing the tty needs socket.sendmsg, which is python 3 only.
+        if not hasattr(socket.socket, "sendmsg"):
+            return False
+
+        cols, lines = self.get_terminal_size()
+        master, slave = os.openpty()
+        s = struct.pack("HHHH", lines, cols, 0, 0)
+        fcntl.ioctl(slave, termios.TIOCSWINSZ, s)
+        errpipe_read, errpipe_write = os.pipe()
+
+        request = json.dumps({
+            "argv": self.command,
+            "env": self._game_env(),
+            "cwd": os.path.abspath(self.game_cwd or "."),
+        }) + "\n"
+        conn = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        conn.setblocking(False)
+        try:
+            # A local socket connects at once, or fails with EAGAIN if the
+            # zygote has fallen that far behind.
+            conn.connect(self.zygote_socket)
+            fds = array.array("i", [slave, errpipe_write])
+            conn.sendmsg([request.encode("utf-8")],
+                         [(socket.SOL_SOCKET, socket.SCM_RIGHTS, fds)])
+        except socket.error as e:
+            self.logger.warning("Couldn't start game from zygote %s (%s), "
+                                "running it directly.", self.zygote_socket, e)
+            conn.close()
+            os.close(master)
+            os.close(errpipe_read)
+            return False
+        finally:
+            # The game has its own copies of these, if it gets them at all.
+            os.close(slave)
+            os.close(errpipe_write)
+
+        self.zygote_conn = conn
+        self.child_fd = master
+        self.errpipe_read = errpipe_read
+        IOLoop.current().add_handler(conn.fileno(), self._handle_zygote_reply,
+                                     IOLoop.ERROR | IOLoop.READ)
+        self.zygote_timeout = IOLoop.current().add_timeout(
+            time.time() + ZYGOTE_TIMEOUT,
+            lambda: self._zygote_failed("no answer"))
+        return True
+
+    def _handle_zygote_reply(self, fd, events):
+        try:
+            data = self.zygote_conn.recv(BUFSIZ)
+        except socket.error as e:
+            if e.errno in (errno.EAGAIN, errno.EWOULDBLOCK):
+                return
+            data = b""
+        self.zygote_buffer += data
+        if b"\n" not in self.zygote_buffer:
+            if not data:
+                self._zygote_failed("connection closed")
+            return
+
+        line, self.zygote_buffer = self.zygote_buffer.split(b"\n", 1)
+        try:
+            reply = json.loads(to_unicode(line))
+            if "pid" not in reply:
+                raise ValueError(reply.get("error", "no pid"))
+        except ValueError as e:
+            self._zygote_failed(e)
+            return
+
+        IOLoop.current().remove_timeout(self.zygote_timeout)
+        IOLoop.current().remove_handler(fd)
+        self.pid = reply["pid"]
+        self._spawned()
+
+    def _zygote_failed(self, reason):
+        self.logger.warning("Couldn't start game from zygote %s (%s), "
+                            "running it directly.", self.zygote_socket, reason)
+        IOLoop.current().remove_timeout(self.zygote_timeout)
+        IOLoop.current().remove_handler(self.zygote_conn.fileno())
+        self.zygote_conn.close()
+        self.zygote_conn = None
+        self.zygote_buffer = b""
+        os.close(self.child_fd)
+        os.close(self.errpipe_read)
+        self.child_fd = None
+        self.errpipe_read = None
+        self._start_directly()
+
+    def _spawn_process(self):
         self.errpipe_read, errpipe_write = os.pipe()
 
         self.pid, self.child_fd = pty.fork()
@@ -88,11 +243,7 @@ class TerminalRecorder(object):
                     pass
 
             # And exec
-            env            = dict(os.environ)
-            env.update(self.env_vars)
-            env["COLUMNS"] = str(cols)
-            env["LINES"]   = str(lines)
-            env["TERM"]    = "linux"
+            env = self._game_env()
             if self.game_cwd:
                 os.chdir(self.game_cwd)
             try:
@@ -103,14 +254,6 @@ class TerminalRecorder(object):
         # We're the parent
         os.close(errpipe_write)
 
-        IOLoop.current().add_handler(self.child_fd,
-                                     self._handle_read,
-                                     IOLoop.ERROR | IOLoop.READ)
-
-        IOLoop.current().add_handler(self.errpipe_read,
-                                     self._handle_err_read,
-                                     IOLoop.READ)
-
     def _handle_read(self, fd, events):
         if events & IOLoop.READ:
             buf = os.read(fd, BUFSIZ)
@@ -139,6 +282,9 @@ class TerminalRecorder(object):
 
             self.poll()
 
+    def _handle_zygote_read(self, fd, events):
+        self.poll()
+
     def write_ttyrec_header(self, sec, usec, l):
         if self.ttyrec is None: return
         s = struct.pack("<iii", sec, usec, l)
@@ -181,12 +327,50 @@ class TerminalRecorder(object):
 
 
     def send_signal(self, signal):
+        # Still waiting for the zygote: pass it on once the game is running.
+        if self.pid is None:
+            self.pending_signal = signal
+            return
         os.kill(self.pid, signal)
 
+    def _zygote_status(self):
+        # The zygote is the game's parent, so it does the waiting for us, and
+        # sends the status once the game has exited.
+        try:
+            data = self.zygote_conn.recv(BUFSIZ)
+        except socket.error as e:
+            if e.errno in (errno.EAGAIN, errno.EWOULDBLOCK):
+                return None
+            data = b""
+        self.zygote_buffer += data
+        if b"\n" in self.zygote_buffer:
+            line = self.zygote_buffer.split(b"\n", 1)[0]
+            return json.loads(to_unicode(line))["status"]
+        if data:
+            return None
+
+        # We lost the zygote; all we can tell is whether the game is still
+        # around.
+        try:
+            os.kill(self.pid, 0)
+        except OSError as e:
+            if e.errno == errno.ESRCH:
+                self.logger.warning("Lost the zygote's exit status for the "
+                                    "game, pid %d.", self.pid)
+                return 0
+        return None
+
     def poll(self):
+        if self.pid is None:
+            return None
         if self.returncode is None:
-            pid, status = os.waitpid(self.pid, os.WNOHANG)
-            if pid == self.pid:
+            if self.zygote_conn:
+                status = self._zygote_status()
+            else:
+                pid, status = os.waitpid(self.pid, os.WNOHANG)
+                if pid != self.pid:
+                    status = None
+            if status is not None:
                 if os.WIFSIGNALED(status):
                     self.returncode = -os.WTERMSIG(status)
                 elif os.WIFEXITED(status):
@@ -202,6 +386,10 @@ class TerminalRecorder(object):
                 os.close(self.child_fd)
                 os.close(self.errpipe_read)
 
+                if self.zygote_conn:
+                    IOLoop.current().remove_handler(self.zygote_conn.fileno())
+                    self.zygote_conn.close()
+
                 if self.ttyrec:
                     self.ttyrec.close()
 
@@ -214,7 +402,7 @@ class TerminalRecorder(object):
         return self.termsize
 
     def write_input(self, data):
-        if self.poll() is not None: return
+        if self.pid is None or self.poll() is not None: return
 
         while len(data) > 0:
             written = os.write(self.child_fd, data)
@@ -20,6 +20,7 @@ from tornado.escape import utf8
 from tornado.ioloop import IOLoop
 
 from webtiles import auth, checkoutput, config, userdb, util, load_games
+from webtiles import map_codec, quality
 
 try:
     from typing import Dict, Set, Tuple, Any, Union, Optional
@@ -215,7 +216,11 @@ class CrawlWebSocket(tornado.websocket.WebSocketHandler):
         self.total_message_bytes = 0
         self.compressed_bytes_sent = 0
         self.uncompressed_bytes_sent = 0
-        self.message_queue = []  # type: List[str]
+        self.message_queue = []  # type: List[Union[str, map_codec.MapFrame]]
+        # Send map messages as map_codec frames; see select_subprotocol.
+        self.binary_maps = False
+        # Which of the game's messages a spectator gets; see quality.py.
+        self.quality = quality.FULL
         self.failed_messages = 0
 
         self.subprotocol = None
@@ -233,6 +238,7 @@ class CrawlWebSocket(tornado.websocket.WebSocketHandler):
             "play": self.start_crawl,
             "pong": self.pong,
             "watch": self.watch,
+            "set_quality": self.set_quality,
             "chat_msg": self.post_chat_message,
             "register": self.register,
             "start_change_email": self.start_change_email,
@@ -292,6 +298,9 @@ class CrawlWebSocket(tornado.websocket.WebSocketHandler):
         return True
 
     def select_subprotocol(self, subprotocols):
+        if "binary-map" in subprotocols:
+            self.subprotocol = "binary-map"
+            return "binary-map"
         if "no-compression" in subprotocols:
             self.deflate = False
             self.subprotocol = "no-compression"
@@ -306,6 +315,9 @@ class CrawlWebSocket(tornado.websocket.WebSocketHandler):
             compression = "off, old websockets"
         elif self.subprotocol == "no-compression":
             compression = "off, client request"
+        elif self.subprotocol == "binary-map":
+            self.binary_maps = True
+            compression = "on, binary maps"
         if hasattr(self, "get_extensions"):
             if any(s.endswith("deflate-frame") for s in self.get_extensions()):
                 self.deflate = False
@@ -826,7 +838,10 @@ class CrawlWebSocket(tornado.websocket.WebSocketHandler):
 
         checkoutput.check_output(call, do_send)
 
-    def watch(self, username):
+    def watch(self, username, tier=None):
+        if tier is not None:
+            self.set_quality(tier)
+
         if self.is_running():
             self.process.stop()
 
@@ -860,11 +875,19 @@ class CrawlWebSocket(tornado.websocket.WebSocketHandler):
             self.watched_game = process
             process.add_watcher(self)
             self.send_message("watching_started", username = process.username)
+            process.catch_up(self)
         else:
             if self.watched_game:
                 self.stop_watching()
             self.go_lobby()
 
+    def set_quality(self, tier):
+        # type: (str) -> None
+        if tier not in quality.TIERS:
+            self.logger.warning("Unknown quality tier: %s", tier)
+            return
+        self.quality = tier
+
     def post_chat_message(self, text):
         receiver = None
         if self.process:
@@ -1087,26 +1110,52 @@ class CrawlWebSocket(tornado.websocket.WebSocketHandler):
         # type: () -> bool
         if self.client_closed or len(self.message_queue) == 0:
             return False
+        queue = self.message_queue
+        self.message_queue = []
+
+        # Keep the order: JSON messages between map frames are batched.
+        batch = []  # type: List[str]
+        for msg in queue:
+            if isinstance(msg, map_codec.MapFrame):
+                if batch and not self._send_json_batch(batch):
+                    return False
+                batch = []
+                self.total_message_bytes += msg.json_size
+                self.compressed_bytes_sent += len(msg.data)
+                if not self._write_frame(msg.data, True):
+                    return False
+            else:
+                batch.append(msg)
+        if batch:
+            return self._send_json_batch(batch)
+        return True
+
+    def _send_json_batch(self, batch):
+        # type: (List[str]) -> bool
         msg = ("{\"msgs\":["
-                + ",".join(self.message_queue)
+                + ",".join(batch)
                 + "]}")
-        self.message_queue = []
+        binmsg = utf8(msg)
+        self.total_message_bytes += len(binmsg)
+        if self.deflate:
+            # Compress like in deflate-frame extension:
+            # Apply deflate, flush, then remove the 00 00 FF FF
+            # at the end
+            compressed = self._compressobj.compress(binmsg)
+            compressed += self._compressobj.flush(zlib.Z_SYNC_FLUSH)
+            compressed = compressed[:-4]
+            if self.binary_maps:
+                compressed = bytes(bytearray([map_codec.JSON_FRAME])) + compressed
+            self.compressed_bytes_sent += len(compressed)
+            return self._write_frame(compressed, True)
+        else:
+            self.uncompressed_bytes_sent += len(binmsg)
+            return self._write_frame(binmsg, False)
 
+    def _write_frame(self, data, binary):
+        # type: (bytes, bool) -> bool
         try:
-            binmsg = utf8(msg)
-            self.total_message_bytes += len(binmsg)
-            if self.deflate:
-                # Compress like in deflate-frame extension:
-                # Apply deflate, flush, then remove the 00 00 FF FF
-                # at the end
-                compressed = self._compressobj.compress(binmsg)
-                compressed += self._compressobj.flush(zlib.Z_SYNC_FLUSH)
-                compressed = compressed[:-4]
-                self.compressed_bytes_sent += len(compressed)
-                f = self.write_message(compressed, binary=True)
-            else:
-                self.uncompressed_bytes_sent += len(binmsg)
-                f = self.write_message(binmsg)
+            f = self.write_message(data, binary=binary)
 
             import traceback
             cur_stack = traceback.format_stack()
@@ -1164,6 +1213,10 @@ class CrawlWebSocket(tornado.websocket.WebSocketHandler):
         # type: (...) -> bool
         if self.client_closed:
             return False
+        if self.binary_maps:
+            frame = map_codec.encode_map_message(msg)
+            if frame is not None:
+                msg = frame
         self.message_queue.append(msg)
         if send:
             return self.flush_messages()
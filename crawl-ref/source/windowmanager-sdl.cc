@@ -332,13 +332,16 @@ static void _translate_wheel_event(const SDL_MouseWheelEvent &sdl_event,
 }
 
 SDLWrapper::SDLWrapper():
-    m_window(nullptr), m_context(nullptr), prev_keycode(0)
+    m_window(nullptr), m_context(nullptr), _frame_ms(1000 / 60),
+    prev_keycode(0)
 {
     m_cursors.fill(nullptr);
 }
 
 SDLWrapper::~SDLWrapper()
 {
+    for (const auto &image : m_preloaded)
+        SDL_FreeSurface(image.second);
     for (const auto& cursor : m_cursors)
         if (cursor)
             SDL_FreeCursor(cursor);
@@ -389,6 +392,9 @@ int SDLWrapper::init(coord_def *m_windowsz)
 
     _desktop_width = display_mode.w;
     _desktop_height = display_mode.h;
+    // 0 if SDL doesn't know; then assume 60Hz.
+    if (display_mode.refresh_rate > 0)
+        _frame_ms = max(1000 / display_mode.refresh_rate, 1);
 
 #ifdef __ANDROID__
     // Request OpenGL ES 1.0 context
@@ -540,6 +546,11 @@ int SDLWrapper::desktop_height() const
     return _desktop_height;
 }
 
+unsigned int SDLWrapper::frame_ms() const
+{
+    return _frame_ms;
+}
+
 void SDLWrapper::set_window_title(const char *title)
 {
     SDL_SetWindowTitle(m_window, title);
@@ -1051,7 +1062,15 @@ bool SDLWrapper::load_texture(GenericTexture *tex, const char *filename,
         return false;
     }
 
-    SDL_Surface *img = load_image(tex_path.c_str());
+    SDL_Surface *img;
+    auto preloaded = m_preloaded.find(tex_path);
+    if (preloaded != m_preloaded.end())
+    {
+        img = preloaded->second;
+        m_preloaded.erase(preloaded);
+    }
+    else
+        img = load_image(tex_path.c_str());
 
     if (!img)
     {
@@ -1221,7 +1240,66 @@ bool SDLWrapper::load_texture(GenericTexture *tex, const char *filename,
     return success;
 }
 
+struct image_decode
+{
+    string path;
+    SDL_Surface *surf;
+};
+
+static SDL_Surface *_load_image_file(const char *file);
+
+static int _decode_image(void *data)
+{
+    image_decode *job = static_cast<image_decode *>(data);
+    job->surf = _load_image_file(job->path.c_str());
+    return 0;
+}
+
+/**
+ * Decode the given image files, each in a thread of its own, and keep the
+ * results for load_texture(). PNG decoding is most of the time that tiles
+ * takes to start, and the sheets don't depend on each other; uploading
+ * them has to wait for the main thread, which owns the GL context.
+ */
+void SDLWrapper::preload_images(const vector<string> &filenames)
+{
+    // SDL_image sets up its decoders the first time it's used, which isn't
+    // safe to do from several threads at once.
+    IMG_Init(IMG_INIT_PNG);
+
+    vector<image_decode> jobs;
+    for (const string &filename : filenames)
+    {
+        const string path = datafile_path(filename);
+        if (!path.empty() && !m_preloaded.count(path))
+            jobs.push_back({path, nullptr});
+    }
+
+    vector<SDL_Thread *> threads;
+    for (image_decode &job : jobs)
+    {
+        SDL_Thread *thread = SDL_CreateThread(_decode_image, "decode", &job);
+        if (!thread)
+            _decode_image(&job);
+        threads.push_back(thread);
+    }
+
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        if (threads[i])
+            SDL_WaitThread(threads[i], nullptr);
+        // A file that wouldn't decode is left to load_texture() to report.
+        if (jobs[i].surf)
+            m_preloaded[jobs[i].path] = jobs[i].surf;
+    }
+}
+
 SDL_Surface *SDLWrapper::load_image(const char *file) const
+{
+    return _load_image_file(file);
+}
+
+static SDL_Surface *_load_image_file(const char *file)
 {
     SDL_Surface *surf = nullptr;
     FILE *imgfile = fopen_u(file, "rb");
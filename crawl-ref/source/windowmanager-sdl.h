@@ -4,6 +4,7 @@
 #ifdef USE_SDL
 
 #include <array>
+#include <map>
 
 #include "windowmanager.h"
 
@@ -55,6 +56,7 @@ public:
     virtual int screen_height() const override;
     virtual int desktop_width() const override;
     virtual int desktop_height() const override;
+    virtual unsigned int frame_ms() const override;
 
     // Texture loading
     virtual bool load_texture(GenericTexture *tex, const char *filename,
@@ -62,6 +64,7 @@ public:
                               unsigned int &orig_height,
                               tex_proc_func proc = nullptr,
                               bool force_power_of_two = true) override;
+    virtual void preload_images(const vector<string> &filenames) override;
 
 protected:
     // Helper functions
@@ -72,6 +75,7 @@ protected:
     SDL_GLContext m_context;
     int _desktop_width;
     int _desktop_height;
+    unsigned int _frame_ms;
 
 private:
     void glDebug(const char *msg);
@@ -79,6 +83,8 @@ private:
     int prev_keycode;
     string m_textinput_queue;
     array<SDL_Cursor*, NUM_MOUSE_CURSORS> m_cursors;
+    // Images decoded by preload_images(), by path, until load_texture().
+    map<string, SDL_Surface*> m_preloaded;
 };
 
 #endif // USE_SDL
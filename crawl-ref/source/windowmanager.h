@@ -177,6 +177,9 @@ public:
     virtual int screen_height() const = 0;
     virtual int desktop_width() const = 0;
     virtual int desktop_height() const = 0;
+    // How long the display shows each frame, in ms; redrawing more often
+    // than this is wasted.
+    virtual unsigned int frame_ms() const = 0;
 
     // Texture loading
     virtual bool load_texture(GenericTexture *tex, const char *filename,
@@ -184,6 +187,9 @@ public:
                               unsigned int &orig_height,
                               tex_proc_func proc = nullptr,
                               bool force_power_of_two = true) = 0;
+    // Decode image files ahead of load_texture(), all at once, so that it
+    // only has to upload them.
+    virtual void preload_images(const vector<string> &filenames) = 0;
 };
 
 // Main interface for UI functions
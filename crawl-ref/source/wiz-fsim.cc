@@ -9,19 +9,28 @@
 
 #include <cerrno>
 
+#ifdef UNIX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #include "beam.h"
 #include "bitary.h"
 #include "coordit.h"
 #include "dbg-util.h"
 #include "directn.h"
+#include "dungeon.h"
 #include "env.h"
 #include "fight.h"
+#include "files.h"
+#include "initfile.h"
 #include "item-prop.h"
 #include "items.h"
 #include "item-use.h"
 #include "jobs.h"
 #include "libutil.h"
 #include "makeitem.h"
+#include "maps.h"
 #include "message.h"
 #include "mgen-data.h"
 #include "mon-clone.h"
@@ -29,6 +38,8 @@
 #include "mon-place.h"
 #include "monster.h"
 #include "mon-util.h"
+#include "newgame-def.h"
+#include "ng-setup.h"
 #include "options.h"
 #include "output.h"
 #include "player-equip.h"
@@ -38,6 +49,7 @@
 #include "species.h"
 #include "state.h"
 #include "stringutil.h"
+#include "syscalls.h"
 #include "throw.h"
 #include "unwind.h"
 #include "version.h"
@@ -259,8 +271,12 @@ static bool _fsim_kit_equip(const string &kit, string &error)
         }
     }
 
-    redraw_screen();
-    update_screen();
+    // There's no screen in an -fsim sweep.
+    if (crawl_state.io_inited)
+    {
+        redraw_screen();
+        update_screen();
+    }
     return true;
 }
 
@@ -339,8 +355,11 @@ static monster* _init_fsim()
     mon->hit_points = mon->max_hit_points = MAX_MONSTER_HP;
     mon->behaviour = BEH_SEEK;
 
-    redraw_screen();
-    update_screen();
+    if (crawl_state.io_inited)
+    {
+        redraw_screen();
+        update_screen();
+    }
 
     return mon;
 }
@@ -794,4 +813,282 @@ void wizard_fight_sim(bool double_scale)
     mpr("Done.");
 }
 
+// The -fsim sweep: fight_sim's skill scale for every character, kit and
+// monster asked for, run without a screen and written to fsim.tsv.
+
+struct fsim_matchup
+{
+    string combo;
+    string kit;     // empty for whatever the character starts with
+    string monster;
+};
+
+static vector<fsim_matchup> _parse_fsim_sweep(const string &spec)
+{
+    const vector<string> sides = split_string(" v ", spec);
+    if (sides.size() != 2)
+        end(1, false, "Bad -fsim matchups: '%s'\n", spec.c_str());
+
+    const vector<string> combos = split_string(",", sides[0]);
+    const vector<string> monsters = split_string(",", sides[1]);
+    for (const string &combo : combos)
+    {
+        if (combo.size() != 4
+            || species::from_abbrev(combo.substr(0, 2).c_str()) == SP_UNKNOWN
+            || get_job_by_abbrev(combo.substr(2, 2).c_str()) == JOB_UNKNOWN)
+        {
+            end(1, false, "Unknown character for -fsim: '%s'\n",
+                combo.c_str());
+        }
+    }
+    for (const string &mons : monsters)
+        if (get_monster_by_name(mons, true) == MONS_PROGRAM_BUG)
+            end(1, false, "Unknown monster for -fsim: '%s'\n", mons.c_str());
+
+    vector<string> kits = Options.fsim_kit;
+    if (kits.empty())
+        kits.emplace_back();
+
+    vector<fsim_matchup> matchups;
+    for (const string &combo : combos)
+        for (const string &kit : kits)
+            for (const string &mons : monsters)
+                matchups.push_back({ combo, kit, mons });
+    return matchups;
+}
+
+/// Start a new character standing on D:1, much as -script's you.init does.
+static void _fsim_sweep_setup(const string &combo)
+{
+    newgame_def ng;
+    ng.type = GAME_TYPE_NORMAL;
+    ng.name = "fsim";
+    ng.species = species::from_abbrev(combo.substr(0, 2).c_str());
+    ng.job = get_job_by_abbrev(combo.substr(2, 2).c_str());
+    // Jobs that get a choice of weapon start unarmed; fsim_kit is the way
+    // to hand them one.
+    ng.weapon = WPN_UNARMED;
+
+    delete you.save;
+    you.save = nullptr;
+    dgn_reset_level();
+    dgn_flush_map_memory();
+    setup_game(ng);
+    you.wizard = true;
+
+    init_level_connectivity();
+    you.where_are_you = BRANCH_DUNGEON;
+    you.depth = 1;
+    load_level(DNGN_STONE_STAIRS_DOWN_I, LOAD_START_GAME, level_id());
+}
+
+/**
+ * Run one matchup's skill scale, as _fsim_simple_scale does, writing both
+ * sides of each row.
+ *
+ * Each matchup starts from a fresh character and draws from its own
+ * sub-generator, so its rows are the same however the sweep is split up.
+ */
+static bool _fsim_sweep_matchup(FILE *o, const fsim_matchup &m, int index,
+                                bool defense)
+{
+    _fsim_sweep_setup(m.combo);
+    rng::subgenerator fight_rng(Options.seed, index);
+
+    string error;
+    if (!m.kit.empty() && !_fsim_kit_equip(m.kit, error))
+    {
+        fprintf(stderr, "%s: can't equip %s: %s\n", m.combo.c_str(),
+                m.kit.c_str(), error.c_str());
+        return false;
+    }
+
+    unwind_var<string> fsim_mons(Options.fsim_mons, m.monster);
+    monster *mon = _init_fsim();
+    if (!mon)
+    {
+        fprintf(stderr, "%s: can't place %s\n", m.combo.c_str(),
+                m.monster.c_str());
+        return false;
+    }
+
+    skill_map scale;
+    bool xl_mode = false;
+    if (Options.fsim_scale.empty())
+        scale[defense ? SK_ARMOUR : _equipped_skill()] = 1;
+    else
+        _init_scale(scale, xl_mode);
+
+    const string kit = m.kit.empty() ? "-" : m.kit;
+    for (int i = xl_mode ? 1 : 0; i <= 27; i++)
+    {
+        if (xl_mode)
+            set_xl(i, true);
+        else
+        {
+            for (const auto &entry : scale)
+                set_skill_level(entry.first, i / entry.second);
+        }
+
+        fight_data fdata = _get_fight_data(*mon, Options.fsim_rounds, defense);
+        const string prefix = make_stringf("%s\t%s\t%s\t%d\t",
+                                           m.combo.c_str(), kit.c_str(),
+                                           m.monster.c_str(), i);
+        fprintf(o, "%s\n", fdata.summary(prefix, true).c_str());
+    }
+
+    _uninit_fsim(mon);
+    return true;
+}
+
+static bool _fsim_sweep_matchups(FILE *o, const vector<fsim_matchup> &matchups,
+                                 int first, int count, bool defense,
+                                 bool progress)
+{
+    bool ok = true;
+    for (int i = first; i < first + count; ++i)
+    {
+        if (progress)
+        {
+            printf("%d..", i + 1);
+            fflush(stdout);
+        }
+        if (!_fsim_sweep_matchup(o, matchups[i], i, defense))
+            ok = false;
+        fflush(o);
+    }
+    return ok;
+}
+
+#ifdef UNIX
+static string _worker_fsim_file(int worker)
+{
+    return make_stringf("fsim-worker-%d.tmp", worker);
+}
+
+static bool _append_fsim_file(FILE *out, const string &file)
+{
+    FILE *in = fopen_u(file.c_str(), "rb");
+    if (!in)
+        return false;
+    char buf[4096];
+    size_t len;
+    while ((len = fread(buf, 1, sizeof(buf), in)) > 0)
+        fwrite(buf, 1, len, out);
+    fclose(in);
+    return true;
+}
+
+/**
+ * Split the matchups into one consecutive run per forked worker, and put
+ * their rows together in matchup order.
+ */
+static bool _fsim_sweep_in_workers(FILE *out,
+                                   const vector<fsim_matchup> &matchups,
+                                   bool defense, int jobs)
+{
+    const int count = matchups.size();
+    printf("Splitting %d matchup(s) between %d workers...", count, jobs);
+    fflush(stdout);
+    fflush(stderr);
+
+    vector<pid_t> workers;
+    int start = 0;
+    for (int i = 0; i < jobs; ++i)
+    {
+        const int share = count / jobs + (i < count % jobs);
+        const pid_t pid = fork();
+        if (pid < 0)
+            end(1, true, "Can't fork fsim worker");
+        if (pid == 0)
+        {
+            crawl_state.forked_worker = true;
+            FILE *fp = fopen_u(_worker_fsim_file(i).c_str(), "wb");
+            if (!fp)
+                _exit(1);
+            const bool ok = _fsim_sweep_matchups(fp, matchups, start, share,
+                                                 defense, false);
+            fclose(fp);
+            _exit(ok ? 0 : 1);
+        }
+        workers.push_back(pid);
+        start += share;
+    }
+
+    bool ok = true;
+    for (int i = 0; i < jobs; ++i)
+    {
+        int status;
+        while (waitpid(workers[i], &status, 0) < 0 && errno == EINTR)
+            ;
+        const string file = _worker_fsim_file(i);
+        if (!WIFEXITED(status) || WEXITSTATUS(status)
+            || !_append_fsim_file(out, file))
+        {
+            fprintf(stderr, "\nWorker %d failed.\n", i);
+            ok = false;
+        }
+        unlink_u(file.c_str());
+    }
+    printf("Finished.\n");
+    fflush(stdout);
+    return ok;
+}
+#endif
+
+void fsim_run_sweep()
+{
+    const vector<fsim_matchup> matchups
+        = _parse_fsim_sweep(crawl_state.fsim_sweep);
+    const bool defense = Options.fsim_mode.find("defen") != string::npos;
+
+    // Every matchup builds its own D:1, so there's nothing to save, and no
+    // point generating any more of the dungeon than that.
+    Options.no_save = true;
+    Options.pregen_dungeon = level_gen_type::classic;
+    // Settle on one seed, so that every matchup starts from the same level.
+    rng::reset();
+    Options.seed = crawl_state.seed;
+
+    run_map_global_preludes();
+    run_map_local_preludes();
+
+    const char *out_file = "fsim.tsv";
+    FILE *o = fopen_u(out_file, "w");
+    if (!o)
+        end(1, true, "Can't write %s", out_file);
+    fprintf(o, "# " CRAWL " version %s, seed %" PRIu64 ", %s, %d rounds\n",
+            Version::Long, Options.seed, defense ? "defense" : "attack",
+            Options.fsim_rounds);
+    fprintf(o, "Combo\tKit\tMonster\t%s\t%s\n",
+            find(Options.fsim_scale.begin(), Options.fsim_scale.end(), "xl")
+                != Options.fsim_scale.end() ? "XL" : "Skill",
+            fight_data::header(true).c_str());
+
+    printf("Simulating %d matchup(s) into %s.\n", (int) matchups.size(),
+           out_file);
+    fflush(stdout);
+
+    msg::suppress quiet;
+    bool ok = true;
+#ifdef UNIX
+    int jobs = SysEnv.map_gen_jobs;
+    if (jobs == 0)
+        jobs = max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+    jobs = min(jobs, (int) matchups.size());
+    if (jobs > 1)
+        ok = _fsim_sweep_in_workers(o, matchups, defense, jobs);
+    else
+#endif
+    {
+        printf("Matchup: ");
+        ok = _fsim_sweep_matchups(o, matchups, 0, matchups.size(), defense,
+                                  true);
+        printf("Finished.\n");
+    }
+    fclose(o);
+    printf(ok ? "Fight simulation complete.\n"
+              : "Fight simulation incomplete.\n");
+}
+
 #endif
@@ -1632,8 +1632,8 @@ void wizard_identify_all_items()
     for (auto &item : env.item)
         if (item.defined())
             set_ident_flags(item, ISFLAG_IDENT_MASK);
-    for (auto& entry : env.shop)
-        for (auto &item : entry.second.stock)
+    for (auto& shop : env.shop)
+        for (auto &item : shop.stock)
             set_ident_flags(item, ISFLAG_IDENT_MASK);
     for (int ii = 0; ii < NUM_OBJECT_CLASSES; ii++)
     {
@@ -1651,8 +1651,8 @@ void wizard_unidentify_all_items()
     for (auto &item : env.item)
         if (item.defined())
             _forget_item(item);
-    for (auto& entry : env.shop)
-        for (auto &item : entry.second.stock)
+    for (auto& shop : env.shop)
+        for (auto &item : shop.stock)
             _forget_item(item);
     for (int ii = 0; ii < NUM_OBJECT_CLASSES; ii++)
     {
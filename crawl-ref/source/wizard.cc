@@ -14,6 +14,8 @@
 #include "cio.h" // cursor_control
 #include "clua.h"
 #include "command.h" // show_keyhelp_menu
+#include "dbg-mem.h"
+#include "dbg-prof.h"
 #include "dbg-util.h"
 #include "dgn-shoals.h" // wizard_mod_tide
 #include "files.h" // save_game
@@ -124,11 +126,15 @@ static void _do_wizard_command(int wiz_command)
 
     case 'n': wizard_set_zot_clock(); break;
     // case 'N': break;
+#ifdef DEBUG_PROFILE
+    case CONTROL('N'): wizard_profile_report(); break;
+#else
     // case CONTROL('N'): break;
+#endif
 
     case 'o': wizard_create_spec_object(); break;
     case 'O': debug_test_explore(); break;
-    // case CONTROL('O'): break;
+    case CONTROL('O'): wizard_memory_report(); break;
 
     case 'p': wizard_transform(); break;
     case 'P': debug_place_map(true); break;
@@ -512,11 +518,15 @@ int list_wizard_commands(bool do_redraw_screen)
                        "<w>Ctrl-F</w> double scale fsim\n"
                        "<w>Ctrl-I</w> item generation stats\n"
                        "<w>O</w>      measure exploration time\n"
+                       "<w>Ctrl-O</w> memory use by subsystem\n"
                        "<w>Ctrl-T</w> dungeon (D)Lua interpreter\n"
                        "<w>Ctrl-U</w> client (C)Lua interpreter\n"
                        "<w>Ctrl-X</w> Xom effect stats\n"
 #ifdef DEBUG_DIAGNOSTICS
                        "<w>Ctrl-Q</w> make some debug messages quiet\n"
+#endif
+#ifdef DEBUG_PROFILE
+                       "<w>Ctrl-N</w> subsystem turn profile\n"
 #endif
                        "<w>Ctrl-Y</w> temporarily suppress wizmode\n"
                        "<w>Ctrl-C</w> force a crash\n"
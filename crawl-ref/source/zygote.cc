@@ -0,0 +1,325 @@
+/**
+ * @file
+ * @brief A warmed up process that forks webtiles games on request.
+ *
+ * Started with -zygote <socket>, crawl does everything at startup that
+ * doesn't depend on the player (see init_static_game_data()), and then
+ * forks a game for each request from the webtiles server. The games skip
+ * that work, and share the zygote's pages for the maps and tables until
+ * they write to them.
+ *
+ * The protocol, over a unix stream socket with one connection per game:
+ *
+ *   -> {"argv":[...],"env":{...},"cwd":"..."}\n
+ *      sent with two fds (SCM_RIGHTS): the tty for stdin and stdout, and
+ *      one for stderr.
+ *   <- {"pid":N}\n once the game has been forked, or {"error":"..."}\n
+ *   <- {"status":N}\n with its raw wait() status, when the game exits.
+ *
+ * webserver/webtiles/terminal.py is the other end.
+**/
+
+#include "AppHdr.h"
+
+#include "zygote.h"
+
+#ifdef USE_TILE_WEB
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <map>
+
+#include <sys/ioctl.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "json.h"
+#include "json-wrapper.h"
+#include "startup.h"
+#include "stringutil.h"
+
+// Requests are small; this is only a sanity limit.
+static const size_t MAX_REQUEST_SIZE = 256 * 1024;
+
+struct zygote_request
+{
+    vector<string> args;
+    vector<pair<string, string>> env;
+    string cwd;
+    int tty = -1;
+    int err = -1;
+};
+
+static volatile sig_atomic_t _child_exited = 0;
+
+static void _handle_sigchld(int)
+{
+    _child_exited = 1;
+}
+
+static void _close_request_fds(zygote_request &req)
+{
+    if (req.tty >= 0)
+        close(req.tty);
+    if (req.err >= 0)
+        close(req.err);
+    req.tty = req.err = -1;
+}
+
+static void _reply(int conn, const string &msg)
+{
+    const string line = msg + "\n";
+    // The server may already have gone; nothing to be done about that.
+    if (write(conn, line.data(), line.size()) < 0)
+        return;
+}
+
+static bool _parse_request(const string &text, zygote_request &req)
+{
+    JsonWrapper obj = json_decode(text.c_str());
+    if (!obj.node || obj->tag != JSON_OBJECT)
+        return false;
+
+    JsonNode *args = json_find_member(obj.node, "argv");
+    if (!args || args->tag != JSON_ARRAY)
+        return false;
+    JsonNode *arg;
+    json_foreach(arg, args)
+    {
+        if (arg->tag != JSON_STRING)
+            return false;
+        req.args.emplace_back(arg->string_);
+    }
+    if (req.args.empty())
+        return false;
+
+    JsonNode *env = json_find_member(obj.node, "env");
+    if (env && env->tag == JSON_OBJECT)
+    {
+        JsonNode *var;
+        json_foreach(var, env)
+            if (var->tag == JSON_STRING)
+                req.env.emplace_back(var->key, var->string_);
+    }
+
+    JsonNode *cwd = json_find_member(obj.node, "cwd");
+    if (cwd && cwd->tag == JSON_STRING)
+        req.cwd = cwd->string_;
+    return true;
+}
+
+/// Read one request, and the fds that come with it.
+static bool _read_request(int conn, zygote_request &req)
+{
+    // Don't let a stalled client hold up everyone else.
+    timeval timeout = { 5, 0 };
+    setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    string text;
+    char buf[4096];
+    while (text.empty() || text.back() != '\n')
+    {
+        iovec iov = { buf, sizeof(buf) };
+        char control[CMSG_SPACE(2 * sizeof(int))];
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        const ssize_t len = recvmsg(conn, &msg, 0);
+        if (len < 0 && errno == EINTR)
+            continue;
+        if (len <= 0)
+            return false;
+
+        for (cmsghdr *c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c))
+        {
+            if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS)
+                continue;
+            const int nfds = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (int i = 0; i < nfds; ++i)
+            {
+                int fd;
+                memcpy(&fd, CMSG_DATA(c) + i * sizeof(int), sizeof(int));
+                if (req.tty < 0)
+                    req.tty = fd;
+                else if (req.err < 0)
+                    req.err = fd;
+                else
+                    close(fd);
+            }
+        }
+
+        text.append(buf, len);
+        if (text.size() > MAX_REQUEST_SIZE)
+            return false;
+    }
+
+    return req.tty >= 0 && req.err >= 0 && _parse_request(text, req);
+}
+
+/// In the forked child: take over the request's tty and environment.
+static void _become_game(zygote_request &req)
+{
+    setsid();
+    if (ioctl(req.tty, TIOCSCTTY, 0) < 0)
+        fprintf(stderr, "zygote: can't set controlling tty: %s\n",
+                strerror(errno));
+    dup2(req.tty, STDIN_FILENO);
+    dup2(req.tty, STDOUT_FILENO);
+    dup2(req.err, STDERR_FILENO);
+    if (req.tty > STDERR_FILENO)
+        close(req.tty);
+    if (req.err > STDERR_FILENO)
+        close(req.err);
+
+    clearenv();
+    for (const auto &var : req.env)
+        setenv(var.first.c_str(), var.second.c_str(), 1);
+
+    if (!req.cwd.empty() && chdir(req.cwd.c_str()) < 0)
+    {
+        fprintf(stderr, "zygote: can't chdir to %s: %s\n", req.cwd.c_str(),
+                strerror(errno));
+        _exit(1);
+    }
+}
+
+static int _listen(const string &socket_path)
+{
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path))
+        die("Zygote socket path too long: %s", socket_path.c_str());
+    strcpy(addr.sun_path, socket_path.c_str());
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        die("Can't create zygote socket: %s", strerror(errno));
+    // Left behind by an earlier zygote.
+    unlink(socket_path.c_str());
+    if (::bind(fd, (sockaddr *) &addr, sizeof(addr)) < 0)
+        die("Can't bind zygote socket %s: %s", socket_path.c_str(),
+            strerror(errno));
+    chmod(socket_path.c_str(), 0700);
+    if (listen(fd, 32) < 0)
+        die("Can't listen on zygote socket: %s", strerror(errno));
+    return fd;
+}
+
+void zygote_serve(const string &socket_path, int &argc, char **&argv)
+{
+    init_static_game_data();
+
+    const int listen_fd = _listen(socket_path);
+    map<pid_t, int> games; // the connection to report each game's exit on
+
+    // SIGCHLD is only let through while waiting in pselect(), so that an
+    // exit can't slip in between reaping and waiting.
+    sigset_t blocked, waiting;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &blocked, &waiting);
+    sigdelset(&waiting, SIGCHLD);
+
+    struct sigaction chld, old_chld, pipe_ign, old_pipe;
+    memset(&chld, 0, sizeof(chld));
+    chld.sa_handler = _handle_sigchld;
+    sigemptyset(&chld.sa_mask);
+    sigaction(SIGCHLD, &chld, &old_chld);
+    memset(&pipe_ign, 0, sizeof(pipe_ign));
+    pipe_ign.sa_handler = SIG_IGN;
+    sigemptyset(&pipe_ign.sa_mask);
+    sigaction(SIGPIPE, &pipe_ign, &old_pipe);
+
+    fprintf(stderr, "Zygote ready on %s\n", socket_path.c_str());
+
+    while (true)
+    {
+        if (_child_exited)
+        {
+            _child_exited = 0;
+            int status;
+            pid_t pid;
+            while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+            {
+                auto game = games.find(pid);
+                if (game == games.end())
+                    continue;
+                _reply(game->second, make_stringf("{\"status\":%d}", status));
+                close(game->second);
+                games.erase(game);
+            }
+        }
+
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(listen_fd, &fds);
+        if (pselect(listen_fd + 1, &fds, nullptr, nullptr, nullptr,
+                    &waiting) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            die("Zygote select error: %s", strerror(errno));
+        }
+
+        const int conn = accept(listen_fd, nullptr, nullptr);
+        if (conn < 0)
+            continue;
+
+        zygote_request req;
+        if (!_read_request(conn, req))
+        {
+            _reply(conn, "{\"error\":\"bad request\"}");
+            _close_request_fds(req);
+            close(conn);
+            continue;
+        }
+
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(listen_fd);
+            close(conn);
+            for (const auto &game : games)
+                close(game.second);
+            sigaction(SIGCHLD, &old_chld, nullptr);
+            sigaction(SIGPIPE, &old_pipe, nullptr);
+            sigprocmask(SIG_UNBLOCK, &blocked, nullptr);
+
+            _become_game(req);
+
+            // These have to outlive parse_args() and everything after it.
+            static vector<string> args;
+            static vector<char *> arg_ptrs;
+            args = move(req.args);
+            for (string &arg : args)
+                arg_ptrs.push_back(&arg[0]);
+            arg_ptrs.push_back(nullptr);
+            argc = args.size();
+            argv = arg_ptrs.data();
+            return;
+        }
+
+        _close_request_fds(req);
+        if (pid < 0)
+        {
+            _reply(conn, make_stringf("{\"error\":\"fork: %s\"}",
+                                      strerror(errno)));
+            close(conn);
+            continue;
+        }
+        _reply(conn, make_stringf("{\"pid\":%d}", (int) pid));
+        games[pid] = conn;
+    }
+}
+
+#endif
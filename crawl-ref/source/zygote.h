@@ -0,0 +1,12 @@
+/**
+ * @file
+ * @brief A warmed up process that forks webtiles games on request.
+**/
+
+#pragma once
+
+#ifdef USE_TILE_WEB
+// Serve fork requests on socket_path. Only returns in a forked game, with
+// argc and argv replaced by that game's command line.
+void zygote_serve(const string &socket_path, int &argc, char **&argv);
+#endif